@@ -25,6 +25,8 @@
 #include <QtCore/QJsonDocument>
 #include <QtCore/QSaveFile>
 #include <QtCore/QString>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
 #include <QtGui/QImageReader>
 #include <QtCore/QVector>
 #include <QtCore/QUrlQuery>
@@ -37,6 +39,7 @@
 
 #include "AssetServerLogging.h"
 #include "BakeAssetTask.h"
+#include "ChunkManifestTask.h"
 #include "SendAssetTask.h"
 #include "UploadAssetTask.h"
 
@@ -113,22 +116,91 @@ QString getBakeMapping(const AssetUtils::AssetHash& hash, const QString& relativ
 
 const QString ASSET_SERVER_LOGGING_TARGET_NAME = "asset-server";
 
-void AssetServer::bakeAsset(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath, const QString& filePath) {
+// what an oven is assumed to need to bake an asset, to keep the bakes running at once within their memory budget
+static const qint64 BAKE_MEMORY_OVERHEAD = 256 * 1024 * 1024;
+static const qint64 BAKE_MEMORY_PER_ASSET_BYTE = 16;
+
+void AssetServer::startNextBakes() {
+    while (!_isBakingStopped && _pendingBakes.size() < _maxConcurrentBakes) {
+        auto entry = _bakeQueue.peek();
+        if (!entry) {
+            return;
+        }
+        auto hash = entry->hash;
+        auto path = entry->path;
+
+        // the asset might have been changed or deleted since it was queued
+        if (!_fileMappings.isMapped(hash) || !needsToBeBaked(path, hash)) {
+            _bakeQueue.remove(hash);
+            continue;
+        }
+
+        auto filePath = getPathToAssetHash(hash);
+        qint64 bakeMemory = BAKE_MEMORY_OVERHEAD + BAKE_MEMORY_PER_ASSET_BYTE * QFileInfo(filePath).size();
+        if (_bakeMemoryBudget > 0 && !_pendingBakes.empty() && _bakeMemoryInUse + bakeMemory > _bakeMemoryBudget) {
+            // the next in line waits for the running bakes to make room, one that is over the budget bakes alone
+            return;
+        }
+        bakeAsset(hash, path, filePath, bakeMemory);
+    }
+}
+
+void AssetServer::bakeAsset(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath,
+                            const QString& filePath, qint64 bakeMemory) {
     qDebug() << "Starting bake for: " << assetPath << assetHash;
-    auto it = _pendingBakes.find(assetHash);
-    if (it == _pendingBakes.end()) {
-        auto task = std::make_shared<BakeAssetTask>(assetHash, assetPath, filePath);
-        task->setAutoDelete(false);
-        _pendingBakes[assetHash] = task;
 
-        connect(task.get(), &BakeAssetTask::bakeComplete, this, &AssetServer::handleCompletedBake);
-        connect(task.get(), &BakeAssetTask::bakeFailed, this, &AssetServer::handleFailedBake);
-        connect(task.get(), &BakeAssetTask::bakeAborted, this, &AssetServer::handleAbortedBake);
+    // an oven that is already up if there's one
+    OvenProcess* oven;
+    if (_idleOvens.empty()) {
+        _ovens.emplace_back(new OvenProcess());
+        oven = _ovens.back().get();
+    } else {
+        oven = _idleOvens.back();
+        _idleOvens.pop_back();
+    }
+
+    auto task = std::make_shared<BakeAssetTask>(assetHash, assetPath, filePath, oven);
+    task->setAutoDelete(false);
+    _pendingBakes[assetHash] = task;
+    _pendingBakeMemory[assetHash] = bakeMemory;
+    _bakeMemoryInUse += bakeMemory;
+    _bakeQueue.start(assetHash);
+
+    // queued, since the task finishes on our thread and is released by the handlers
+    connect(task.get(), &BakeAssetTask::bakeComplete, this, &AssetServer::handleCompletedBake, Qt::QueuedConnection);
+    connect(task.get(), &BakeAssetTask::bakeFailed, this, &AssetServer::handleFailedBake, Qt::QueuedConnection);
+    connect(task.get(), &BakeAssetTask::bakeAborted, this, &AssetServer::handleAbortedBake, Qt::QueuedConnection);
+
+    _bakingTaskPool.start(task.get());
+}
+
+void AssetServer::finishBake(const AssetUtils::AssetHash& assetHash, bool succeeded, bool wasAborted) {
+    auto task = _pendingBakes.take(assetHash);
+    if (!task) {
+        return;
+    }
+
+    _idleOvens.push_back(task->getOven());
+    _bakeMemoryInUse -= _pendingBakeMemory.take(assetHash);
 
-        _bakingTaskPool.start(task.get());
+    if (wasAborted && _isBakingStopped) {
+        // baked again when the asset server restarts
+        _bakeQueue.stop(assetHash);
     } else {
-        qDebug() << "Already in queue";
+        _bakeQueue.remove(assetHash);
+    }
+
+    if (!wasAborted) {
+        if (succeeded) {
+            ++_numBakesSucceeded;
+        } else {
+            ++_numBakesFailed;
+        }
+        _bakeUsecs += usecTimestampNow() - task->getStartTime();
+        ++_numBakesSinceLastStats;
     }
+
+    startNextBakes();
 }
 
 QString AssetServer::getPathToAssetHash(const AssetUtils::AssetHash& assetHash) {
@@ -189,10 +261,11 @@ void AssetServer::bakeAssets() {
     }
 }
 
-void AssetServer::maybeBake(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash) {
+void AssetServer::maybeBake(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash, bool isRequested) {
     if (needsToBeBaked(path, hash)) {
         qDebug() << "Queuing bake of: " << path;
-        bakeAsset(hash, path, getPathToAssetHash(hash));
+        _bakeQueue.push(hash, path, isRequested);
+        startNextBakes();
     }
 }
 
@@ -330,24 +403,33 @@ void AssetServer::aboutToFinish() {
     // remove pending transfer tasks
     _transferTaskPool.clear();
 
+    // the bakes that are still queued or get aborted are picked up again when the asset server restarts
+    _isBakingStopped = true;
+
     // abort each of our still running bake tasks, remove pending bakes that were never put on the thread pool
-    auto it = _pendingBakes.begin();
-    while (it != _pendingBakes.end()) {
-        auto pendingRunnable =  _bakingTaskPool.tryTake(it->get());
+    std::vector<AssetUtils::AssetHash> unstartedBakes;
+    for (auto it = _pendingBakes.begin(); it != _pendingBakes.end(); ++it) {
+        auto pendingRunnable = _bakingTaskPool.tryTake(it->get());
 
         if (pendingRunnable) {
-            it = _pendingBakes.erase(it);
+            unstartedBakes.push_back(it.key());
         } else {
             qDebug() << "Aborting bake for" << it.key();
             it.value()->abort();
-            ++it;
         }
     }
+    for (const auto& hash : unstartedBakes) {
+        finishBake(hash, false, true);
+    }
 
     // make sure all bakers are finished or aborted
     while (_pendingBakes.size() > 0) {
         QCoreApplication::processEvents();
     }
+
+    _bakeQueue.save();
+    _idleOvens.clear();
+    _ovens.clear();
 }
 
 void AssetServer::run() {
@@ -424,6 +506,42 @@ void AssetServer::completeSetup() {
         return;
     }
 
+    // remove what's left of uploads that were interrupted by the last shutdown
+    auto interruptedUploads = _filesDirectory.entryList({ UploadAssetTask::TEMP_UPLOAD_PREFIX + "*" },
+                                                        QDir::Files | QDir::Hidden);
+    for (const auto& interruptedUpload : interruptedUploads) {
+        _filesDirectory.remove(interruptedUpload);
+    }
+
+    // get how many assets can be baked at once, and how much memory their bakes can take
+    static const QString MAX_CONCURRENT_BAKES_OPTION = "max_concurrent_bakes";
+    static const QString BAKE_MEMORY_BUDGET_OPTION = "bake_memory_budget";
+    static const int DEFAULT_BAKE_MEMORY_BUDGET_MB = 2048;
+    const qint64 BYTES_PER_MEGABYTE = 1024 * 1024;
+    _maxConcurrentBakes = assetServerObject[MAX_CONCURRENT_BAKES_OPTION].toInt(0);
+    if (_maxConcurrentBakes <= 0) {
+        // each oven bakes on a few threads of its own
+        _maxConcurrentBakes = std::max(QThread::idealThreadCount() / 2, 1);
+    }
+    _bakingTaskPool.setMaxThreadCount(_maxConcurrentBakes);
+    auto bakeMemoryBudget = (qint64)assetServerObject[BAKE_MEMORY_BUDGET_OPTION].toInt(DEFAULT_BAKE_MEMORY_BUDGET_MB);
+    _bakeMemoryBudget = bakeMemoryBudget * BYTES_PER_MEGABYTE;
+    qCInfo(asset_server) << "Baking up to" << _maxConcurrentBakes << "assets at once with"
+                         << (bakeMemoryBudget > 0 ? QString::number(bakeMemoryBudget) + " MB" : "no memory budget");
+
+    // pick up the bakes that were queued when the asset server last stopped, those clients asked for first
+    static const QString BAKE_QUEUE_FILE_NAME = "bake-queue.json";
+    static const int BAKE_QUEUE_SAVE_INTERVAL_MSECS = 5000;
+    _bakeQueue.load(_resourcesDirectory.absoluteFilePath(BAKE_QUEUE_FILE_NAME));
+    if (_bakeQueue.size() > 0) {
+        qCInfo(asset_server) << "Resuming" << _bakeQueue.size() << "queued bakes.";
+    }
+    auto bakeQueueSaveTimer = new QTimer(this);
+    connect(bakeQueueSaveTimer, &QTimer::timeout, this, [this] {
+        _bakeQueue.save();
+    });
+    bakeQueueSaveTimer->start(BAKE_QUEUE_SAVE_INTERVAL_MSECS);
+
     // load whatever mappings we currently have from the local file
     if (loadMappingsFromFile()) {
         qCInfo(asset_server) << "Serving files from: " << _filesDirectory.path();
@@ -458,6 +576,14 @@ void AssetServer::completeSetup() {
         _filesizeLimit = assetsFilesizeLimit * BITS_PER_MEGABITS;
     }
 
+    // get the size of the in memory cache of hot assets
+    static const QString ASSETS_HOT_CACHE_SIZE_OPTION = "assets_hot_cache_size";
+    auto assetsHotCacheSize = (qint64)assetServerObject[ASSETS_HOT_CACHE_SIZE_OPTION].toInt(AssetCache::DEFAULT_CAPACITY / BYTES_PER_MEGABYTE);
+    if (assetsHotCacheSize > 0) {
+        _assetCache = std::make_shared<AssetCache>(assetsHotCacheSize * BYTES_PER_MEGABYTE);
+        qCInfo(asset_server) << "Keeping up to" << assetsHotCacheSize << "MB of hot assets in memory.";
+    }
+
     PathUtils::removeTemporaryApplicationDirs();
     PathUtils::removeTemporaryApplicationDirs("Oven");
 
@@ -527,19 +653,13 @@ void AssetServer::cleanupUnmappedFiles() {
     for (const auto& fileInfo : files) {
         auto filename = fileInfo.fileName();
         if (hashFileRegex.exactMatch(filename)) {
-            bool matched { false };
-            for (auto& pair : _fileMappings) {
-                if (pair.second == filename) {
-                    matched = true;
-                    break;
-                }
-            }
-            if (!matched) {
+            if (!_fileMappings.isMapped(filename)) {
                 // remove the unmapped file
                 QFile removeableFile { fileInfo.absoluteFilePath() };
 
                 if (removeableFile.remove()) {
                     qCDebug(asset_server) << "\tDeleted" << filename << "from asset files directory since it is unmapped.";
+                    QFile::remove(removeableFile.fileName() + AssetUtils::CHUNK_MANIFEST_EXTENSION);
 
                     removeBakedPathsForDeletedAsset(filename);
                 } else {
@@ -570,12 +690,7 @@ void AssetServer::cleanupBakedFilesForDeletedAssets() {
     // enumerate the hashes for which we have baked content
     for (const auto& hash : bakedHashes) {
         // check if we have a mapping that points to this hash
-        auto matchingMapping = std::find_if(std::begin(_fileMappings), std::end(_fileMappings),
-                                            [&hash](const std::pair<AssetUtils::AssetPath, AssetUtils::AssetHash> mappingPair) {
-            return mappingPair.second == hash;
-        });
-
-        if (matchingMapping == std::end(_fileMappings)) {
+        if (!_fileMappings.isMapped(hash)) {
             // we didn't find a mapping for this hash, remove any baked content we still have for it
             removeBakedPathsForDeletedAsset(hash);
         }
@@ -684,6 +799,9 @@ void AssetServer::handleGetMappingOperation(ReceivedMessage& message, NLPacketLi
             replyPacket.write(QByteArray::fromHex(originalAssetHash.toUtf8()));
             replyPacket.writePrimitive(wasRedirected);
 
+            // a client wants it now, bake it before the assets nobody is asking for
+            _bakeQueue.request(originalAssetHash);
+
             auto query = QUrlQuery(url.query());
             bool isSkybox = query.hasQueryItem("skybox");
             if (isSkybox && !loaded) {
@@ -692,7 +810,7 @@ void AssetServer::handleGetMappingOperation(ReceivedMessage& message, NLPacketLi
 
                 writeMetaFile(originalAssetHash, needsBakingMeta);
                 if (!bakingDisabled) {
-                    maybeBake(assetPath, originalAssetHash);
+                    maybeBake(assetPath, originalAssetHash, true);
                 }
             }
         }
@@ -833,28 +951,44 @@ void AssetServer::handleAssetGetInfo(QSharedPointer<ReceivedMessage> message, Sh
     message->readPrimitive(&messageID);
     assetHash = message->readWithoutCopy(AssetUtils::SHA256_HASH_LENGTH);
 
-    auto size = qint64(sizeof(MessageID) + AssetUtils::SHA256_HASH_LENGTH + sizeof(AssetUtils::AssetServerError) + sizeof(qint64));
-    auto replyPacket = NLPacket::create(PacketType::AssetGetInfoReply, size, true);
+    // the chunk manifest of a large asset doesn't fit in a single packet
+    auto replyPacketList = NLPacketList::create(PacketType::AssetGetInfoReply, QByteArray(), true, true);
 
     QByteArray hexHash = assetHash.toHex();
 
-    replyPacket->writePrimitive(messageID);
-    replyPacket->write(assetHash);
+    replyPacketList->writePrimitive(messageID);
+    replyPacketList->write(assetHash);
 
     QString fileName = QString(hexHash);
     QFileInfo fileInfo { _filesDirectory.filePath(fileName) };
 
     if (fileInfo.exists() && fileInfo.isReadable()) {
         qCDebug(asset_server) << "Opening file: " << fileInfo.filePath();
-        replyPacket->writePrimitive(AssetUtils::AssetServerError::NoError);
-        replyPacket->writePrimitive(fileInfo.size());
+        replyPacketList->writePrimitive(AssetUtils::AssetServerError::NoError);
+        replyPacketList->writePrimitive(fileInfo.size());
+
+        // the hashes of the chunks of the asset, for clients to find the chunks that went bad
+        QByteArray chunkHashes;
+        if (fileInfo.size() > AssetUtils::ASSET_CHUNK_SIZE) {
+            QFile manifestFile { fileInfo.filePath() + AssetUtils::CHUNK_MANIFEST_EXTENSION };
+            if (manifestFile.open(QIODevice::ReadOnly)) {
+                chunkHashes = manifestFile.readAll();
+            }
+            if (chunkHashes.size() != AssetUtils::numChunks(fileInfo.size()) * (qint64)AssetUtils::SHA256_HASH_LENGTH) {
+                // the next ones to ask for it get it
+                chunkHashes.clear();
+                ChunkManifestTask::start(_transferTaskPool, fileInfo.filePath());
+            }
+        }
+        replyPacketList->writePrimitive((quint32)(chunkHashes.size() / AssetUtils::SHA256_HASH_LENGTH));
+        replyPacketList->write(chunkHashes);
     } else {
         qCDebug(asset_server) << "Asset not found: " << QString(hexHash);
-        replyPacket->writePrimitive(AssetUtils::AssetServerError::AssetNotFound);
+        replyPacketList->writePrimitive(AssetUtils::AssetServerError::AssetNotFound);
     }
 
     auto nodeList = DependencyManager::get<NodeList>();
-    nodeList->sendPacket(std::move(replyPacket), *senderNode);
+    nodeList->sendPacketList(std::move(replyPacketList), *senderNode);
 }
 
 void AssetServer::handleAssetGet(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
@@ -867,7 +1001,7 @@ void AssetServer::handleAssetGet(QSharedPointer<ReceivedMessage> message, Shared
     }
 
     // Queue task
-    auto task = new SendAssetTask(message, senderNode, _filesDirectory);
+    auto task = new SendAssetTask(message, senderNode, _filesDirectory, _assetCache);
     _transferTaskPool.start(task);
 }
 
@@ -912,7 +1046,7 @@ void AssetServer::sendStatsPacket() {
 
     auto nodeList = DependencyManager::get<NodeList>();
     nodeList->eachNode([&](auto& node) {
-        auto& stats = node->getConnectionStats();
+        auto stats = node->getConnectionStats();
 
         QJsonObject nodeStats;
         auto endTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(stats.endTime);
@@ -957,97 +1091,148 @@ void AssetServer::sendStatsPacket() {
         serverStats[uuid] = nodeStats;
     });
 
+    static const float BYTES_PER_MEGABYTE = 1024.0f * 1024.0f;
+
+    QJsonObject uploadStats;
+    auto uploadSecs = (float)UploadAssetTask::getUploadUsecs() / (float)USECS_PER_SECOND;
+    auto megabytesUploaded = (float)UploadAssetTask::getBytesUploaded() / BYTES_PER_MEGABYTE;
+    uploadStats["1. Uploads"] = (double)UploadAssetTask::getNumUploads();
+    uploadStats["2. Duplicates"] = (double)UploadAssetTask::getNumDuplicateUploads();
+    uploadStats["3. Uploaded (MB)"] = megabytesUploaded;
+    uploadStats["4. Throughput (MB/s)"] = uploadSecs > 0.0f ? megabytesUploaded / uploadSecs : 0.0f;
+    serverStats["Uploads"] = uploadStats;
+
+    static const float SECS_PER_MINUTE = 60.0f;
+    auto now = usecTimestampNow();
+    auto statsIntervalSecs = _lastBakeStatsTime > 0 ? (float)(now - _lastBakeStatsTime) / (float)USECS_PER_SECOND : 0.0f;
+    auto numBakesFinished = _numBakesSucceeded + _numBakesFailed;
+    int numOvenStarts = 0;
+    for (const auto& oven : _ovens) {
+        numOvenStarts += oven->getNumStarts();
+    }
+
+    QJsonObject bakeStats;
+    bakeStats["1. Queued"] = _bakeQueue.getNumWaiting();
+    bakeStats["2. Baking"] = _pendingBakes.size();
+    bakeStats["3. Baked"] = (double)_numBakesSucceeded;
+    bakeStats["4. Failed"] = (double)_numBakesFailed;
+    bakeStats["5. Throughput (bakes/min)"] = statsIntervalSecs > 0.0f ?
+        (float)_numBakesSinceLastStats * SECS_PER_MINUTE / statsIntervalSecs : 0.0f;
+    bakeStats["6. Avg Bake Time (s)"] = numBakesFinished > 0 ?
+        (float)_bakeUsecs / (float)USECS_PER_SECOND / (float)numBakesFinished : 0.0f;
+    bakeStats["7. Ovens"] = (int)_ovens.size();
+    bakeStats["8. Oven Starts"] = numOvenStarts;
+    bakeStats["9. Reserved Memory (MB)"] = (float)_bakeMemoryInUse / BYTES_PER_MEGABYTE;
+    serverStats["Baking"] = bakeStats;
+    _numBakesSinceLastStats = 0;
+    _lastBakeStatsTime = now;
+
+    if (_assetCache) {
+        auto numRequests = _assetCache->getNumRequests();
+        auto numServedFromMemory = _assetCache->getNumHits() + _assetCache->getNumCoalescedRequests();
+
+        QJsonObject cacheStats;
+        cacheStats["1. Hit Rate (%)"] = numRequests > 0 ? 100.0f * (float)numServedFromMemory / (float)numRequests : 0.0f;
+        cacheStats["2. Served From Cache (MB)"] = (float)_assetCache->getBytesServedFromCache() / BYTES_PER_MEGABYTE;
+        cacheStats["3. Requests"] = (double)numRequests;
+        cacheStats["4. Hits"] = (double)_assetCache->getNumHits();
+        cacheStats["5. Coalesced"] = (double)_assetCache->getNumCoalescedRequests();
+        cacheStats["6. Not Admitted"] = (double)_assetCache->getNumRejected();
+        cacheStats["7. Size (MB)"] = (float)_assetCache->getSize() / BYTES_PER_MEGABYTE;
+        cacheStats["8. Ranges"] = _assetCache->getNumRanges();
+        serverStats["Hot Asset Cache"] = cacheStats;
+    }
+
     // send off the stats packets
     ThreadedAssignment::addPacketStatsAndSendStatsPacket(serverStats);
 }
 
 static const QString MAP_FILE_NAME = "map.json";
+static const QString MAP_LOG_FILE_NAME = "map.log";
 
 bool AssetServer::loadMappingsFromFile() {
 
+    auto mapLogFilePath = _resourcesDirectory.absoluteFilePath(MAP_LOG_FILE_NAME);
+    if (QFile::exists(mapLogFilePath)) {
+        if (!_fileMappings.load(mapLogFilePath)) {
+            qCCritical(asset_server) << "Failed to read mapping log at" << mapLogFilePath;
+            return false;
+        }
+
+        qCInfo(asset_server) << "Loaded" << _fileMappings.size() << "mappings from map log at" << mapLogFilePath;
+        return true;
+    }
+
+    // older versions kept the mappings in a JSON file, move them to the log
+    AssetUtils::Mappings mappings;
     auto mapFilePath = _resourcesDirectory.absoluteFilePath(MAP_FILE_NAME);
 
     QFile mapFile { mapFilePath };
     if (mapFile.exists()) {
-        if (mapFile.open(QIODevice::ReadOnly)) {
-            QJsonParseError error;
-
-            auto jsonDocument = QJsonDocument::fromJson(mapFile.readAll(), &error);
-
-            if (error.error == QJsonParseError::NoError) {
-                if (!jsonDocument.isObject()) {
-                    qCWarning(asset_server) << "Failed to read mapping file, root value in" << mapFilePath << "is not an object";
-                    return false;
-                }
+        if (!mapFile.open(QIODevice::ReadOnly)) {
+            qCCritical(asset_server) << "Failed to read mapping file at" << mapFilePath;
+            return false;
+        }
 
-                //_fileMappings = jsonDocument.object().toVariantHash();
-                auto root = jsonDocument.object();
-                for (auto it = root.begin(); it != root.end(); ++it) {
-                    auto key = it.key();
-                    auto value = it.value();
+        QJsonParseError error;
+        auto jsonDocument = QJsonDocument::fromJson(mapFile.readAll(), &error);
+        mapFile.close();
 
-                    if (!value.isString()) {
-                        qCWarning(asset_server) << "Skipping" << key << ":" << value << "because it is not a string";
-                        continue;
-                    }
+        if (error.error != QJsonParseError::NoError) {
+            qCCritical(asset_server) << "Failed to read mapping file at" << mapFilePath;
+            return false;
+        }
 
-                    if (!AssetUtils::isValidFilePath(key)) {
-                        qCWarning(asset_server) << "Will not keep mapping for" << key << "since it is not a valid path.";
-                        continue;
-                    }
+        if (!jsonDocument.isObject()) {
+            qCWarning(asset_server) << "Failed to read mapping file, root value in" << mapFilePath << "is not an object";
+            return false;
+        }
 
-                    if (!AssetUtils::isValidHash(value.toString())) {
-                        qCWarning(asset_server) << "Will not keep mapping for" << key << "since it does not have a valid hash.";
-                        continue;
-                    }
+        auto root = jsonDocument.object();
+        for (auto it = root.begin(); it != root.end(); ++it) {
+            auto key = it.key();
+            auto value = it.value();
 
+            if (!value.isString()) {
+                qCWarning(asset_server) << "Skipping" << key << ":" << value << "because it is not a string";
+                continue;
+            }
 
-                    qDebug() << "Added " << key << value.toString();
-                    _fileMappings[key] = value.toString();
-                }
+            if (!AssetUtils::isValidFilePath(key)) {
+                qCWarning(asset_server) << "Will not keep mapping for" << key << "since it is not a valid path.";
+                continue;
+            }
 
-                qCInfo(asset_server) << "Loaded" << _fileMappings.size() << "mappings from map file at" << mapFilePath;
-                return true;
+            if (!AssetUtils::isValidHash(value.toString())) {
+                qCWarning(asset_server) << "Will not keep mapping for" << key << "since it does not have a valid hash.";
+                continue;
             }
+
+            mappings[key] = value.toString();
         }
 
-        qCCritical(asset_server) << "Failed to read mapping file at" << mapFilePath;
-        return false;
+        qCInfo(asset_server) << "Loaded" << mappings.size() << "mappings from map file at" << mapFilePath;
     } else {
         qCInfo(asset_server) << "No existing mappings loaded from file since no file was found at" << mapFilePath;
     }
 
-    return true;
-}
-
-bool AssetServer::writeMappingsToFile() {
-    auto mapFilePath = _resourcesDirectory.absoluteFilePath(MAP_FILE_NAME);
-
-    QSaveFile mapFile { mapFilePath };
-    if (mapFile.open(QIODevice::WriteOnly)) {
-        QJsonObject root;
-
-        for (auto it : _fileMappings) {
-            root[it.first] = it.second;
-        }
-
-        QJsonDocument jsonDocument { root };
+    if (!_fileMappings.reset(mapLogFilePath, mappings)) {
+        qCCritical(asset_server) << "Failed to write mapping log at" << mapLogFilePath;
+        return false;
+    }
 
-        if (mapFile.write(jsonDocument.toJson()) != -1) {
-            if (mapFile.commit()) {
-                qCDebug(asset_server) << "Wrote JSON mappings to file at" << mapFilePath;
-                return true;
-            } else {
-                qCWarning(asset_server) << "Failed to commit JSON mappings to file at" << mapFilePath;
-            }
+    if (mapFile.exists()) {
+        // keep the JSON around for older versions, under a name that makes it clear it isn't used anymore
+        static const QString MIGRATED_MAP_FILE_SUFFIX = ".migrated";
+        QFile::remove(mapFilePath + MIGRATED_MAP_FILE_SUFFIX);
+        if (mapFile.rename(mapFilePath + MIGRATED_MAP_FILE_SUFFIX)) {
+            qCInfo(asset_server) << "Migrated mappings from" << mapFilePath << "to" << mapLogFilePath;
         } else {
-            qCWarning(asset_server) << "Failed to write JSON mappings to file at" << mapFilePath;
+            qCWarning(asset_server) << "Migrated mappings to" << mapLogFilePath << "but failed to rename" << mapFilePath;
         }
-    } else {
-        qCWarning(asset_server) << "Failed to open map file at" << mapFilePath;
     }
 
-    return false;
+    return true;
 }
 
 bool AssetServer::setMapping(AssetUtils::AssetPath path, AssetUtils::AssetHash hash) {
@@ -1063,27 +1248,12 @@ bool AssetServer::setMapping(AssetUtils::AssetPath path, AssetUtils::AssetHash h
         return false;
     }
 
-    // remember what the old mapping was in case persistence fails
-    auto it = _fileMappings.find(path);
-    auto oldMapping = it != _fileMappings.end() ? it->second : "";
-
-    // update the in memory QHash
-    _fileMappings[path] = hash;
-
-    // attempt to write to file
-    if (writeMappingsToFile()) {
+    if (_fileMappings.set(path, hash)) {
         // persistence succeeded, we are good to go
         qCDebug(asset_server) << "Set mapping:" << path << "=>" << hash;
         maybeBake(path, hash);
         return true;
     } else {
-        // failed to persist this mapping to file - put back the old one in our in-memory representation
-        if (oldMapping.isEmpty()) {
-            _fileMappings.erase(_fileMappings.find(path));
-        } else {
-            _fileMappings[path] = oldMapping;
-        }
-
         qCWarning(asset_server) << "Failed to persist mapping:" << path << "=>" << hash;
 
         return false;
@@ -1107,89 +1277,46 @@ void AssetServer::removeBakedPathsForDeletedAsset(AssetUtils::AssetHash hash) {
 }
 
 bool AssetServer::deleteMappings(const AssetUtils::AssetPathList& paths) {
-    // take a copy of the current mappings in case persistence of these deletes fails
-    auto oldMappings = _fileMappings;
-
-    QSet<QString> hashesToCheckForDeletion;
-
-    // enumerate the paths to delete and remove them all
+    AssetUtils::AssetPathList trimmedPaths;
     for (const auto& rawPath : paths) {
-        auto path = rawPath.trimmed();
-
-        // figure out if this path will delete a file or folder
-        if (pathIsFolder(path)) {
-            // enumerate the in memory file mappings and remove anything that matches
-            auto it = _fileMappings.begin();
-            auto sizeBefore = _fileMappings.size();
+        trimmedPaths << rawPath.trimmed();
+    }
 
-            while (it != _fileMappings.end()) {
-                if (it->first.startsWith(path)) {
-                    // add this hash to the list we need to check for asset removal from the server
-                    hashesToCheckForDeletion << it->second;
+    AssetUtils::Mappings removedMappings;
+    if (!_fileMappings.remove(trimmedPaths, removedMappings)) {
+        qCWarning(asset_server) << "Failed to persist deleted mappings, rolling back";
 
-                    it = _fileMappings.erase(it);
-                } else {
-                    ++it;
-                }
-            }
+        return false;
+    }
 
-            auto sizeNow = _fileMappings.size();
-            if (sizeBefore != sizeNow) {
-                qCDebug(asset_server) << "Deleted" << sizeBefore - sizeNow << "mappings in folder: " << path;
-            } else {
-                qCDebug(asset_server) << "Did not find any mappings to delete in folder:" << path;
-            }
+    QSet<QString> hashesToCheckForDeletion;
+    for (const auto& mapping : removedMappings) {
+        qCDebug(asset_server) << "Deleted a mapping:" << mapping.first << "=>" << mapping.second;
 
-        } else {
-            auto it = _fileMappings.find(path);
-            if (it != _fileMappings.end()) {
-                // add this hash to the list we need to check for asset removal from server
-                hashesToCheckForDeletion << it->second;
-
-                qCDebug(asset_server) << "Deleted a mapping:" << path << "=>" << it->second;
-                
-                _fileMappings.erase(it);
-            } else {
-                qCDebug(asset_server) << "Unable to delete a mapping that was not found:" << path;
-            }
-        }
+        // add this hash to the list we need to check for asset removal from server
+        hashesToCheckForDeletion << mapping.second;
     }
 
-    // deleted the old mappings, attempt to persist to file
-    if (writeMappingsToFile()) {
-        // persistence succeeded we are good to go
-
-        // TODO iterate through hashesToCheckForDeletion instead
-        for (auto& pair : _fileMappings) {
-            auto it = hashesToCheckForDeletion.find(pair.second);
-            if (it != hashesToCheckForDeletion.end()) {
-                hashesToCheckForDeletion.erase(it);
-            }
+    // the files of the hashes that are now unmapped can go
+    for (auto& hash : hashesToCheckForDeletion) {
+        if (_fileMappings.isMapped(hash)) {
+            continue;
         }
 
-        // we now have a set of hashes that are unmapped - we will delete those asset files
-        for (auto& hash : hashesToCheckForDeletion) {
-            // remove the unmapped file
-            QFile removeableFile { _filesDirectory.absoluteFilePath(hash) };
+        // remove the unmapped file
+        QFile removeableFile { _filesDirectory.absoluteFilePath(hash) };
 
-            if (removeableFile.remove()) {
-                qCDebug(asset_server) << "\tDeleted" << hash << "from asset files directory since it is now unmapped.";
+        if (removeableFile.remove()) {
+            qCDebug(asset_server) << "\tDeleted" << hash << "from asset files directory since it is now unmapped.";
+            QFile::remove(removeableFile.fileName() + AssetUtils::CHUNK_MANIFEST_EXTENSION);
 
-                removeBakedPathsForDeletedAsset(hash);
-            } else {
-                qCDebug(asset_server) << "\tAttempt to delete unmapped file" << hash << "failed";
-            }
+            removeBakedPathsForDeletedAsset(hash);
+        } else {
+            qCDebug(asset_server) << "\tAttempt to delete unmapped file" << hash << "failed";
         }
-
-        return true;
-    } else {
-        qCWarning(asset_server) << "Failed to persist deleted mappings, rolling back";
-
-        // we didn't delete the previous mapping, put it back in our in-memory representation
-        _fileMappings = oldMappings;
-
-        return false;
     }
+
+    return true;
 }
 
 bool AssetServer::renameMapping(AssetUtils::AssetPath oldPath, AssetUtils::AssetPath newPath) {
@@ -1212,35 +1339,12 @@ bool AssetServer::renameMapping(AssetUtils::AssetPath oldPath, AssetUtils::Asset
             return false;
         }
 
-        // take a copy of the old mappings
-        auto oldMappings = _fileMappings;
-
-        // iterate the current mappings and adjust any that matches the renamed folder
-        auto it = oldMappings.begin();
-
-        while (it != oldMappings.end()) {
-            auto& oldKey = it->first;
-            if (oldKey.startsWith(oldPath)) {
-                auto newKey = oldKey;
-                newKey.replace(0, oldPath.size(), newPath);
-
-                // remove the old version from the in memory file mappings
-                _fileMappings.erase(_fileMappings.find(oldKey));
-                _fileMappings[newKey] = it->second;
-            }
-
-            ++it;
-        }
-
-        if (writeMappingsToFile()) {
+        if (_fileMappings.rename(oldPath, newPath)) {
             // persisted the changed mappings, return success
             qCDebug(asset_server) << "Renamed folder mapping:" << oldPath << "=>" << newPath;
 
             return true;
         } else {
-            // couldn't persist the renamed paths, rollback and return failure
-            _fileMappings = oldMappings;
-
             qCWarning(asset_server) << "Failed to persist renamed folder mapping:" << oldPath << "=>" << newPath;
 
             return false;
@@ -1253,40 +1357,19 @@ bool AssetServer::renameMapping(AssetUtils::AssetPath oldPath, AssetUtils::Asset
             return false;
         }
 
-        // take the old hash to remove the old mapping
-        auto it = _fileMappings.find(oldPath);
-        auto oldSourceMapping = it->second;
-        _fileMappings.erase(it);
-
-        // in case we're overwriting, keep the current destination mapping for potential rollback
-        auto oldDestinationIt = _fileMappings.find(newPath);
-
-        if (!oldSourceMapping.isEmpty()) {
-            _fileMappings[newPath] = oldSourceMapping;
-
-            if (writeMappingsToFile()) {
-                // persisted the renamed mapping, return success
-                qCDebug(asset_server) << "Renamed mapping:" << oldPath << "=>" << newPath;
-
-                return true;
-            } else {
-                // we couldn't persist the renamed mapping, rollback and return failure
-                _fileMappings[oldPath] = oldSourceMapping;
-
-                if (oldDestinationIt != _fileMappings.end()) {
-                    // put back the overwritten mapping for the destination path
-                    _fileMappings[newPath] = oldDestinationIt->second;
-                } else {
-                    // clear the new mapping
-                    _fileMappings.erase(_fileMappings.find(newPath));
-                }
+        if (_fileMappings.find(oldPath) == _fileMappings.end()) {
+            // failed to find a mapping that was to be renamed, return failure
+            return false;
+        }
 
-                qCDebug(asset_server) << "Failed to persist renamed mapping:" << oldPath << "=>" << newPath;
+        if (_fileMappings.rename(oldPath, newPath)) {
+            // persisted the renamed mapping, return success
+            qCDebug(asset_server) << "Renamed mapping:" << oldPath << "=>" << newPath;
 
-                return false;
-            }
+            return true;
         } else {
-            // failed to find a mapping that was to be renamed, return failure
+            qCDebug(asset_server) << "Failed to persist renamed mapping:" << oldPath << "=>" << newPath;
+
             return false;
         }
     }
@@ -1309,7 +1392,7 @@ void AssetServer::handleFailedBake(QString originalAssetHash, QString assetPath,
 
     writeMetaFile(originalAssetHash, meta);
 
-    _pendingBakes.remove(originalAssetHash);
+    finishBake(originalAssetHash, false);
 }
 
 void AssetServer::handleCompletedBake(QString originalAssetHash, QString originalAssetPath,
@@ -1332,7 +1415,7 @@ void AssetServer::handleCompletedBake(QString originalAssetHash, QString origina
 
         writeMetaFile(originalAssetHash, meta);
 
-        _pendingBakes.remove(originalAssetHash);
+        finishBake(originalAssetHash, !errorCompletingBake);
     };
 
     bool errorCompletingBake { false };
@@ -1465,7 +1548,7 @@ void AssetServer::handleAbortedBake(QString originalAssetHash, QString assetPath
     qDebug() << "Aborted bake:" << originalAssetHash;
 
     // for an aborted bake we don't do anything but remove the BakeAssetTask from our pending bakes
-    _pendingBakes.remove(originalAssetHash);
+    finishBake(originalAssetHash, false, true);
 }
 
 static const QString BAKE_VERSION_KEY = "bake_version";
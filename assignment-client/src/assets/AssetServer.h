@@ -18,7 +18,11 @@
 
 #include <ThreadedAssignment.h>
 
+#include "AssetBakeQueue.h"
+#include "AssetCache.h"
+#include "AssetMappingStore.h"
 #include "AssetUtils.h"
+#include "OvenProcess.h"
 #include "ReceivedMessage.h"
 
 #include "RegisteredMetaTypes.h"
@@ -106,7 +110,6 @@ private:
 
     // Mapping file operations must be called from main assignment thread only
     bool loadMappingsFromFile();
-    bool writeMappingsToFile();
 
     /// Set the mapping for path to hash
     bool setMapping(AssetUtils::AssetPath path, AssetUtils::AssetHash hash);
@@ -130,11 +133,16 @@ private:
     std::pair<AssetUtils::BakingStatus, QString> getAssetStatus(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash);
 
     void bakeAssets();
-    void maybeBake(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash);
+    /// Queues the bake of the asset if it needs one, ahead of the others if a client is asking for it
+    void maybeBake(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash, bool isRequested = false);
     void createEmptyMetaFile(const AssetUtils::AssetHash& hash);
     bool hasMetaFile(const AssetUtils::AssetHash& hash);
     bool needsToBeBaked(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& assetHash);
-    void bakeAsset(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath, const QString& filePath);
+    /// Starts the next queued bakes, as many as the bakers and their memory budget allow
+    void startNextBakes();
+    void bakeAsset(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath, const QString& filePath,
+                   qint64 bakeMemory);
+    void finishBake(const AssetUtils::AssetHash& assetHash, bool succeeded, bool wasAborted = false);
 
     /// Move baked content for asset to baked directory and update baked status
     void handleCompletedBake(QString originalAssetHash, QString assetPath, QString bakedTempOutputDir);
@@ -148,7 +156,7 @@ private:
     /// Remove baked paths when the original asset is deleteds
     void removeBakedPathsForDeletedAsset(AssetUtils::AssetHash originalAssetHash);
 
-    AssetUtils::Mappings _fileMappings;
+    AssetMappingStore _fileMappings;
 
     QDir _resourcesDirectory;
     QDir _filesDirectory;
@@ -156,9 +164,30 @@ private:
     /// Task pool for handling uploads and downloads of assets
     QThreadPool _transferTaskPool;
 
+    /// Hot asset ranges shared by the download tasks, none if disabled in the settings
+    AssetCachePointer _assetCache;
+
+    /// Assets to bake, saved so that baking picks up where it left off after a restart
+    AssetBakeQueue _bakeQueue;
+    /// Bakes in progress
     QHash<AssetUtils::AssetHash, std::shared_ptr<BakeAssetTask>> _pendingBakes;
+    QHash<AssetUtils::AssetHash, qint64> _pendingBakeMemory;
+    /// Task pool getting the assets ready for the ovens
     QThreadPool _bakingTaskPool;
 
+    std::vector<std::unique_ptr<OvenProcess>> _ovens;
+    std::vector<OvenProcess*> _idleOvens;
+    int _maxConcurrentBakes { 1 };
+    qint64 _bakeMemoryBudget { 0 };
+    qint64 _bakeMemoryInUse { 0 };
+    bool _isBakingStopped { false };
+
+    uint64_t _numBakesSucceeded { 0 };
+    uint64_t _numBakesFailed { 0 };
+    uint64_t _bakeUsecs { 0 };
+    uint64_t _numBakesSinceLastStats { 0 };
+    quint64 _lastBakeStatsTime { 0 };
+
     QMutex _queuedRequestsMutex;
     bool _isQueueingRequests { true };
     using RequestQueue = QVector<QPair<QSharedPointer<ReceivedMessage>, SharedNodePointer>>;
@@ -11,29 +11,22 @@
 
 #include "BakeAssetTask.h"
 
-#include <mutex>
-
+#include <QtCore/QFile>
 #include <QtCore/QThread>
-#include <QCoreApplication>
 
 #include <PathUtils.h>
+#include <SharedUtil.h>
 
-static const int OVEN_STATUS_CODE_SUCCESS { 0 };
-static const int OVEN_STATUS_CODE_FAIL { 1 };
-static const int OVEN_STATUS_CODE_ABORT { 2 };
-
-std::once_flag registerMetaTypesFlag;
+#include "OvenProcess.h"
 
-BakeAssetTask::BakeAssetTask(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath, const QString& filePath) :
+BakeAssetTask::BakeAssetTask(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath,
+                             const QString& filePath, OvenProcess* oven) :
     _assetHash(assetHash),
     _assetPath(assetPath),
-    _filePath(filePath)
+    _filePath(filePath),
+    _oven(oven),
+    _startTime(usecTimestampNow())
 {
-
-    std::call_once(registerMetaTypesFlag, []() {
-        qRegisterMetaType<QProcess::ProcessError>("QProcess::ProcessError");
-        qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
-    });
 }
 
 void BakeAssetTask::run() {
@@ -63,71 +56,73 @@ void BakeAssetTask::run() {
         return;
     }
 
-    auto base = QFileInfo(QCoreApplication::applicationFilePath()).absoluteDir();
-    QString path = base.absolutePath() + "/oven";
-    QString extension = _assetPath.mid(_assetPath.lastIndexOf('.') + 1);
-    QStringList args {
-        "-i", tempAssetPath,
-        "-o", tempOutputDir,
-        "-t", extension,
-    };
-
-    _ovenProcess.reset(new QProcess());
+    _tempOutputDir = tempOutputDir;
+    _tempAssetPath = tempAssetPath;
 
-    QEventLoop loop;
+    // the oven lives on our thread
+    QMetaObject::invokeMethod(this, "startOven", Qt::QueuedConnection);
+}
 
-    connect(_ovenProcess.get(), static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
-            this, [&loop, this, tempOutputDir, tempAssetPath, tempOutputDirName](int exitCode, QProcess::ExitStatus exitStatus) {
-        qDebug() << "Baking process finished: " << exitCode << exitStatus;
+void BakeAssetTask::startOven() {
+    QString tempOutputDirName = QDir(_tempOutputDir).dirName();
+    if (_wasAborted) {
+        PathUtils::deleteMyTemporaryDir(tempOutputDirName);
+        emit bakeAborted(_assetHash, _assetPath);
+        return;
+    }
 
-        if (exitStatus == QProcess::CrashExit) {
-            PathUtils::deleteMyTemporaryDir(tempOutputDirName);
-            if (_wasAborted) {
-                emit bakeAborted(_assetHash, _assetPath);
-            } else {
-                QString errors = "Fatal error occurred while baking";
-                emit bakeFailed(_assetHash, _assetPath, errors);
-            }
-        } else if (exitCode == OVEN_STATUS_CODE_SUCCESS) {
-            emit bakeComplete(_assetHash, _assetPath, tempOutputDir);
-        } else if (exitStatus == QProcess::NormalExit && exitCode == OVEN_STATUS_CODE_ABORT) {
-            _wasAborted.store(true);
-            PathUtils::deleteMyTemporaryDir(tempOutputDirName);
-            emit bakeAborted(_assetHash, _assetPath);
-        } else {
-            QString errors;
-            if (exitCode == OVEN_STATUS_CODE_FAIL) {
-                QDir outputDir = tempOutputDir;
-                auto errorFilePath = outputDir.absoluteFilePath("errors.txt");
-                QFile errorFile { errorFilePath };
-                if (errorFile.open(QIODevice::ReadOnly)) {
-                    errors = errorFile.readAll();
-                    errorFile.close();
-                } else {
-                    errors = "Unknown error occurred while baking";
-                }
-            }
-            PathUtils::deleteMyTemporaryDir(tempOutputDirName);
-            emit bakeFailed(_assetHash, _assetPath, errors);
-        }
+    QString extension = _assetPath.mid(_assetPath.lastIndexOf('.') + 1);
 
-        loop.quit();
-    });
+    connect(_oven, &OvenProcess::bakeFinished, this, &BakeAssetTask::handleOvenFinished);
 
     qDebug() << "Starting oven for " << _assetPath;
-    _ovenProcess->start(path, args, QIODevice::ReadOnly);
-    qDebug() << "Running:" << path << args;
-    if (!_ovenProcess->waitForStarted()) {
+    if (!_oven->bake(_tempAssetPath, _tempOutputDir, extension)) {
+        disconnect(_oven, nullptr, this, nullptr);
         PathUtils::deleteMyTemporaryDir(tempOutputDirName);
 
         QString errors = "Oven process failed to start";
         emit bakeFailed(_assetHash, _assetPath, errors);
         return;
     }
+    _isOvenStarted = true;
+}
 
-    _isBaking = true;
+void BakeAssetTask::handleOvenFinished(int statusCode) {
+    qDebug() << "Baking finished: " << statusCode << _assetPath;
+    disconnect(_oven, nullptr, this, nullptr);
+    _isOvenStarted = false;
 
-    loop.exec();
+    QString tempOutputDirName = QDir(_tempOutputDir).dirName();
+    if (statusCode == OVEN_STATUS_CODE_CRASH) {
+        PathUtils::deleteMyTemporaryDir(tempOutputDirName);
+        if (_wasAborted) {
+            emit bakeAborted(_assetHash, _assetPath);
+        } else {
+            QString errors = "Fatal error occurred while baking";
+            emit bakeFailed(_assetHash, _assetPath, errors);
+        }
+    } else if (statusCode == OVEN_STATUS_CODE_SUCCESS) {
+        emit bakeComplete(_assetHash, _assetPath, _tempOutputDir);
+    } else if (statusCode == OVEN_STATUS_CODE_ABORT) {
+        _wasAborted.store(true);
+        PathUtils::deleteMyTemporaryDir(tempOutputDirName);
+        emit bakeAborted(_assetHash, _assetPath);
+    } else {
+        QString errors;
+        if (statusCode == OVEN_STATUS_CODE_FAIL) {
+            QDir outputDir = _tempOutputDir;
+            auto errorFilePath = outputDir.absoluteFilePath("errors.txt");
+            QFile errorFile { errorFilePath };
+            if (errorFile.open(QIODevice::ReadOnly)) {
+                errors = errorFile.readAll();
+                errorFile.close();
+            } else {
+                errors = "Unknown error occurred while baking";
+            }
+        }
+        PathUtils::deleteMyTemporaryDir(tempOutputDirName);
+        emit bakeFailed(_assetHash, _assetPath, errors);
+    }
 }
 
 void BakeAssetTask::abort() {
@@ -136,9 +131,9 @@ void BakeAssetTask::abort() {
         return;
     }
     qDebug() << "Aborting BakeAssetTask for" << _assetHash;
-    if (_ovenProcess->state() != QProcess::NotRunning) {
+    _wasAborted = true;
+    if (_isOvenStarted) {
         qDebug() << "Teminating oven process for" << _assetHash;
-        _wasAborted = true;
-        _ovenProcess->terminate();
+        _oven->abort();
     }
 }
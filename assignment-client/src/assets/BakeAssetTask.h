@@ -18,19 +18,26 @@
 #include <QtCore/QObject>
 #include <QtCore/QRunnable>
 #include <QDir>
-#include <QProcess>
 
 #include <AssetUtils.h>
 
+class OvenProcess;
+
+/// The bake of an asset by one of the asset server's ovens. Running it on a task pool gets the asset ready for the oven,
+/// which then bakes it back on the thread of the task.
 class BakeAssetTask : public QObject, public QRunnable {
     Q_OBJECT
 public:
-    BakeAssetTask(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath, const QString& filePath);
+    BakeAssetTask(const AssetUtils::AssetHash& assetHash, const AssetUtils::AssetPath& assetPath, const QString& filePath,
+                  OvenProcess* oven);
 
     // Thread-safe inspection methods
     bool isBaking() { return _isBaking.load(); }
     bool wasAborted() const { return _wasAborted.load(); }
 
+    OvenProcess* getOven() const { return _oven; }
+    quint64 getStartTime() const { return _startTime; }
+
     void run() override;
 
 public slots:
@@ -40,13 +47,21 @@ signals:
     void bakeComplete(QString assetHash, QString assetPath, QString tempOutputDir);
     void bakeFailed(QString assetHash, QString assetPath, QString errors);
     void bakeAborted(QString assetHash, QString assetPath);
-    
+
+private slots:
+    void startOven();
+    void handleOvenFinished(int statusCode);
+
 private:
     std::atomic<bool> _isBaking { false };
     AssetUtils::AssetHash _assetHash;
     AssetUtils::AssetPath _assetPath;
     QString _filePath;
-    std::unique_ptr<QProcess> _ovenProcess { nullptr };
+    QString _tempOutputDir;
+    QString _tempAssetPath;
+    OvenProcess* _oven;
+    bool _isOvenStarted { false };
+    quint64 _startTime { 0 };
     std::atomic<bool> _wasAborted { false };
 };
 
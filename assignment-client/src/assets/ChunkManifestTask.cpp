@@ -0,0 +1,65 @@
+//
+//  ChunkManifestTask.cpp
+//  assignment-client/src/assets
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ChunkManifestTask.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThreadPool>
+
+#include <AssetUtils.h>
+
+#include "AssetServerLogging.h"
+
+std::mutex ChunkManifestTask::_filesInProgressMutex;
+QSet<QString> ChunkManifestTask::_filesInProgress;
+
+void ChunkManifestTask::start(QThreadPool& pool, const QString& filePath) {
+    {
+        std::lock_guard<std::mutex> lock(_filesInProgressMutex);
+        if (_filesInProgress.contains(filePath)) {
+            return;
+        }
+        _filesInProgress.insert(filePath);
+    }
+    pool.start(new ChunkManifestTask(filePath));
+}
+
+ChunkManifestTask::ChunkManifestTask(const QString& filePath) :
+    _filePath(filePath)
+{
+}
+
+void ChunkManifestTask::run() {
+    QFile file { _filePath };
+    if (file.open(QIODevice::ReadOnly)) {
+        qint64 numChunks = AssetUtils::numChunks(file.size());
+        QByteArray chunkHashes;
+        chunkHashes.reserve((int)(numChunks * AssetUtils::SHA256_HASH_LENGTH));
+        for (qint64 chunk = 0; chunk < numChunks; ++chunk) {
+            QByteArray data = file.read(AssetUtils::ASSET_CHUNK_SIZE);
+            if (data.isEmpty()) {
+                break;
+            }
+            chunkHashes.append(AssetUtils::hashData(data));
+        }
+
+        QSaveFile manifestFile { _filePath + AssetUtils::CHUNK_MANIFEST_EXTENSION };
+        if (chunkHashes.size() != numChunks * (qint64)AssetUtils::SHA256_HASH_LENGTH ||
+            !manifestFile.open(QIODevice::WriteOnly) || manifestFile.write(chunkHashes) != chunkHashes.size() ||
+            !manifestFile.commit()) {
+            // clients can still check the asset as a whole
+            qCWarning(asset_server) << "Failed to write chunk manifest for" << _filePath;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_filesInProgressMutex);
+    _filesInProgress.remove(_filePath);
+}
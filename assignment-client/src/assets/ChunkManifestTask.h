@@ -0,0 +1,43 @@
+//
+//  ChunkManifestTask.h
+//  assignment-client/src/assets
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ChunkManifestTask_h
+#define hifi_ChunkManifestTask_h
+
+#include <mutex>
+
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+class QThreadPool;
+
+/// Writes the chunk manifest of a large asset: the hashes of its chunks, which clients fetching it a chunk at a time
+/// use to find the chunks that went bad when the asset doesn't match its hash.
+///
+/// It is written the first time the asset is asked for rather than when it's uploaded, so that the upload only hashes
+/// the asset once.
+class ChunkManifestTask : public QRunnable {
+public:
+    /// Starts writing the manifest of the asset file on the pool, unless it is already being written
+    static void start(QThreadPool& pool, const QString& filePath);
+
+    void run() override;
+
+private:
+    ChunkManifestTask(const QString& filePath);
+
+    static std::mutex _filesInProgressMutex;
+    static QSet<QString> _filesInProgress;
+
+    QString _filePath;
+};
+
+#endif // hifi_ChunkManifestTask_h
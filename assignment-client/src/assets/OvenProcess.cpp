@@ -0,0 +1,152 @@
+//
+//  OvenProcess.cpp
+//  assignment-client/src/assets
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OvenProcess.h"
+
+#include <mutex>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+
+#include "AssetServerLogging.h"
+
+static const QByteArray OVEN_STATUS_PREFIX = "OVEN_STATUS ";
+static const int MAX_BAKES_PER_PROCESS = 50;
+static const int OVEN_EXIT_TIMEOUT_MSECS = 1000;
+
+static std::once_flag registerMetaTypesFlag;
+
+OvenProcess::OvenProcess(QObject* parent) :
+    QObject(parent)
+{
+    std::call_once(registerMetaTypesFlag, []() {
+        qRegisterMetaType<QProcess::ProcessError>("QProcess::ProcessError");
+        qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+    });
+}
+
+OvenProcess::~OvenProcess() {
+    if (_process) {
+        _process->disconnect(this);
+        _process->closeWriteChannel();
+        _process->waitForFinished(OVEN_EXIT_TIMEOUT_MSECS);
+    }
+}
+
+bool OvenProcess::bake(const QString& inputPath, const QString& outputDir, const QString& type) {
+    if (_isBaking) {
+        qCWarning(asset_server) << "Tried to start a bake on an oven that is already baking";
+        return false;
+    }
+
+    if (_numBakesInProcess >= MAX_BAKES_PER_PROCESS) {
+        stopProcess();
+    }
+    if (!_process && !startProcess()) {
+        return false;
+    }
+
+    QString job = QDir::toNativeSeparators(inputPath) + '\t' + QDir::toNativeSeparators(outputDir) + '\t' + type + '\n';
+    if (_process->write(job.toUtf8()) == -1) {
+        stopProcess();
+        return false;
+    }
+
+    _isBaking = true;
+    ++_numBakesInProcess;
+    return true;
+}
+
+void OvenProcess::abort() {
+    if (_isBaking && _process) {
+        qCDebug(asset_server) << "Terminating oven process";
+        _process->terminate();
+    }
+}
+
+void OvenProcess::readStatus() {
+    if (_process) {
+        readStatusLines(*_process);
+    }
+}
+
+void OvenProcess::readStatusLines(QProcess& process) {
+    while (process.canReadLine()) {
+        // anything else is the oven's log
+        QByteArray line = process.readLine().trimmed();
+        if (line.startsWith(OVEN_STATUS_PREFIX) && _isBaking) {
+            bool ok;
+            int statusCode = line.mid(OVEN_STATUS_PREFIX.size()).toInt(&ok);
+            finishBake(ok ? statusCode : OVEN_STATUS_CODE_FAIL);
+        }
+    }
+}
+
+void OvenProcess::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+    qCDebug(asset_server) << "Oven process finished:" << exitCode << exitStatus;
+
+    // the next bake starts a new one
+    auto process = _process.release();
+    process->disconnect(this);
+    process->deleteLater();
+    _numBakesInProcess = 0;
+
+    // it might have finished its bake right before exiting
+    readStatusLines(*process);
+    if (_isBaking) {
+        finishBake(OVEN_STATUS_CODE_CRASH);
+    }
+}
+
+bool OvenProcess::startProcess() {
+    auto base = QFileInfo(QCoreApplication::applicationFilePath()).absoluteDir();
+    QString path = base.absolutePath() + "/oven";
+
+    _process.reset(new QProcess());
+    // the oven's errors go to our log instead of piling up in the pipe
+    _process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    connect(_process.get(), &QProcess::readyReadStandardOutput, this, &OvenProcess::readStatus);
+    connect(_process.get(), static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, &OvenProcess::handleProcessFinished);
+
+    qCDebug(asset_server) << "Starting oven:" << path;
+    _process->start(path, { "--serve" }, QIODevice::ReadWrite);
+    if (!_process->waitForStarted()) {
+        qCWarning(asset_server) << "Oven process failed to start:" << _process->errorString();
+        _process->disconnect(this);
+        _process.reset();
+        return false;
+    }
+
+    _numBakesInProcess = 0;
+    ++_numStarts;
+    return true;
+}
+
+void OvenProcess::stopProcess() {
+    if (!_process) {
+        return;
+    }
+
+    // the oven exits once its input is closed, it is killed if it is still around when we are destroyed
+    auto process = _process.release();
+    process->disconnect(this);
+    process->setParent(this);
+    connect(process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            process, &QObject::deleteLater);
+    process->closeWriteChannel();
+    _numBakesInProcess = 0;
+}
+
+void OvenProcess::finishBake(int statusCode) {
+    _isBaking = false;
+    emit bakeFinished(statusCode);
+}
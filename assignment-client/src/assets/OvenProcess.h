@@ -0,0 +1,62 @@
+//
+//  OvenProcess.h
+//  assignment-client/src/assets
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OvenProcess_h
+#define hifi_OvenProcess_h
+
+#include <memory>
+
+#include <QtCore/QObject>
+#include <QtCore/QProcess>
+
+static const int OVEN_STATUS_CODE_SUCCESS { 0 };
+static const int OVEN_STATUS_CODE_FAIL { 1 };
+static const int OVEN_STATUS_CODE_ABORT { 2 };
+// the oven exited or was killed in the middle of a bake
+static const int OVEN_STATUS_CODE_CRASH { -1 };
+
+/// An oven that stays up to bake one asset after the other, rather than one oven started for each asset.
+///
+/// It is started again after a number of bakes, so that whatever a bake leaks doesn't add up.
+class OvenProcess : public QObject {
+    Q_OBJECT
+public:
+    OvenProcess(QObject* parent = nullptr);
+    ~OvenProcess();
+
+    /// Starts baking the file into the output directory, starting the oven first if needed.
+    /// False if the oven couldn't be started.
+    bool bake(const QString& inputPath, const QString& outputDir, const QString& type);
+    /// Kills the oven in the middle of its bake
+    void abort();
+
+    bool isBaking() const { return _isBaking; }
+    int getNumStarts() const { return _numStarts; }
+
+signals:
+    void bakeFinished(int statusCode);
+
+private slots:
+    void readStatus();
+    void handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    void readStatusLines(QProcess& process);
+    bool startProcess();
+    void stopProcess();
+    void finishBake(int statusCode);
+
+    std::unique_ptr<QProcess> _process;
+    bool _isBaking { false };
+    int _numBakesInProcess { 0 };
+    int _numStarts { 0 };
+};
+
+#endif // hifi_OvenProcess_h
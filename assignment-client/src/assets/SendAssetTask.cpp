@@ -11,6 +11,7 @@
 
 #include "SendAssetTask.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QFile>
@@ -26,15 +27,63 @@
 #include "ByteRange.h"
 #include "ClientServerUtils.h"
 
-SendAssetTask::SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir) :
+SendAssetTask::SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir,
+                             AssetCachePointer assetCache) :
     QRunnable(),
     _message(message),
     _senderNode(sendToNode),
-    _resourcesDir(resourcesDir)
+    _resourcesDir(resourcesDir),
+    _assetCache(assetCache)
 {
     
 }
 
+void SendAssetTask::streamRange(udt::PacketList& packetList, std::shared_ptr<QFile> file, qint64 offset, qint64 size) {
+    // rather than reading the whole range up front, the send queue pulls it a packet at a time as the flow window
+    // lets it, so a transfer only ever has about a window worth of the asset in memory however big the asset is
+    const uchar* mappedData = file->map(offset, size);
+    if (!mappedData) {
+        // fall back to reading from the file as the packets get written
+        file->seek(offset);
+    }
+
+    qint64 bytesWritten = 0;
+    packetList.setSource([file, mappedData, size, bytesWritten](udt::PacketList& packetList, qint64 maxSize) mutable {
+        qint64 bytesToWrite = std::min(maxSize, size - bytesWritten);
+        if (bytesToWrite <= 0) {
+            return (qint64)0;
+        }
+
+        if (mappedData) {
+            bytesToWrite = packetList.write(reinterpret_cast<const char*>(mappedData) + bytesWritten, bytesToWrite);
+        } else {
+            bytesToWrite = packetList.write(file->read(bytesToWrite));
+        }
+
+        if (bytesToWrite > 0) {
+            bytesWritten += bytesToWrite;
+        }
+        return bytesToWrite;
+    });
+}
+
+void SendAssetTask::streamData(udt::PacketList& packetList, QByteArray data) {
+    // the list shares the data with the cache, it isn't copied until it's written to the packets
+    qint64 bytesWritten = 0;
+    packetList.setSource([data, bytesWritten](udt::PacketList& packetList, qint64 maxSize) mutable {
+        qint64 bytesToWrite = std::min(maxSize, (qint64)data.size() - bytesWritten);
+        if (bytesToWrite <= 0) {
+            return (qint64)0;
+        }
+
+        bytesToWrite = packetList.write(data.constData() + bytesWritten, bytesToWrite);
+        if (bytesToWrite > 0) {
+            bytesWritten += bytesToWrite;
+        }
+        return bytesToWrite;
+    });
+}
+
 void SendAssetTask::run() {
     MessageID messageID;
     ByteRange byteRange;
@@ -65,16 +114,17 @@ void SendAssetTask::run() {
     } else {
         QString filePath = _resourcesDir.filePath(QString(hexHash));
         
-        QFile file { filePath };
+        // the reply holds on to the file until it's done streaming it
+        auto file = std::make_shared<QFile>(filePath);
 
-        if (file.open(QIODevice::ReadOnly)) {
+        if (file->open(QIODevice::ReadOnly)) {
 
             // first fixup the range based on the now known file size
-            byteRange.fixupRange(file.size());
+            byteRange.fixupRange(file->size());
 
             // check if we're being asked to read data that we just don't have
             // because of the file size
-            if (file.size() < byteRange.fromInclusive || file.size() < byteRange.toExclusive) {
+            if (file->size() < byteRange.fromInclusive || file->size() < byteRange.toExclusive) {
                 replyPacketList->writePrimitive(AssetUtils::AssetServerError::InvalidByteRange);
                 qCDebug(networking) << "Bad byte range: " << hexHash << " "
                     << byteRange.fromInclusive << ":" << byteRange.toExclusive;
@@ -82,29 +132,30 @@ void SendAssetTask::run() {
                 // we have a valid byte range, handle it and send the asset
                 auto size = byteRange.size();
 
-                if (byteRange.fromInclusive >= 0) {
+                // a negative range is read back from the end of the file
+                qint64 offset = byteRange.fromInclusive >= 0 ? byteRange.fromInclusive
+                                                             : file->size() + byteRange.fromInclusive;
 
-                    // this range is positive, meaning we just need to seek into the file and then read from there
-                    file.seek(byteRange.fromInclusive);
-                    replyPacketList->writePrimitive(AssetUtils::AssetServerError::NoError);
-                    replyPacketList->writePrimitive(size);
-                    replyPacketList->write(file.read(size));
-                } else {
-                    // this range is negative, at least the first part of the read will be back into the end of the file
+                replyPacketList->writePrimitive(AssetUtils::AssetServerError::NoError);
+                replyPacketList->writePrimitive(size);
 
-                    // seek to the part of the file where the negative range begins
-                    file.seek(file.size() + byteRange.fromInclusive);
-
-                    replyPacketList->writePrimitive(AssetUtils::AssetServerError::NoError);
-                    replyPacketList->writePrimitive(size);
+                QByteArray cachedData;
+                if (_assetCache && size > 0 && size <= _assetCache->getMaxRangeSize()) {
+                    // hot ranges are read once for everyone asking for them at about the same time and then kept around
+                    cachedData = _assetCache->get(assetHash, offset, size, [&] {
+                        file->seek(offset);
+                        return file->read(size);
+                    });
+                }
 
-                    // first write everything from the negative range to the end of the file
-                    replyPacketList->write(file.read(size));
+                if (size > 0 && cachedData.size() == size) {
+                    streamData(*replyPacketList, cachedData);
+                } else if (size > 0) {
+                    streamRange(*replyPacketList, file, offset, size);
                 }
 
                 qCDebug(networking) << "Sending asset: " << hexHash;
             }
-            file.close();
         } else {
             qCDebug(networking) << "Asset not found: " << filePath << "(" << hexHash << ")";
             replyPacketList->writePrimitive(AssetUtils::AssetServerError::AssetNotFound);
@@ -12,27 +12,42 @@
 #ifndef hifi_SendAssetTask_h
 #define hifi_SendAssetTask_h
 
+#include <memory>
+
 #include <QtCore/QByteArray>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QString>
 #include <QtCore/QRunnable>
 
+#include "AssetCache.h"
 #include "AssetUtils.h"
 #include "AssetServer.h"
 #include "Node.h"
 
 class NLPacket;
+class QFile;
+
+namespace udt {
+    class PacketList;
+}
 
 class SendAssetTask : public QRunnable {
 public:
-    SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir);
+    SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir,
+                  AssetCachePointer assetCache = AssetCachePointer());
 
     void run() override;
 
 private:
+    // streams size bytes of the file from offset to the end of the packet list
+    static void streamRange(udt::PacketList& packetList, std::shared_ptr<QFile> file, qint64 offset, qint64 size);
+    // streams data already in memory to the end of the packet list
+    static void streamData(udt::PacketList& packetList, QByteArray data);
+
     QSharedPointer<ReceivedMessage> _message;
     SharedNodePointer _senderNode;
     QDir _resourcesDir;
+    AssetCachePointer _assetCache;
 };
 
 #endif
@@ -11,15 +11,24 @@
 
 #include "UploadAssetTask.h"
 
-#include <QtCore/QBuffer>
+#include <algorithm>
+#include <future>
+
 #include <QtCore/QFile>
+#include <QtCore/QUuid>
 
 #include <AssetUtils.h>
 #include <NodeList.h>
 #include <NLPacketList.h>
+#include <SharedUtil.h>
+#include <shared/FileUtils.h>
 
 #include "ClientServerUtils.h"
 
+const QString UploadAssetTask::TEMP_UPLOAD_PREFIX = ".upload-";
+
+static const qint64 WRITE_CHUNK_SIZE = 1024 * 1024;
+
 UploadAssetTask::UploadAssetTask(QSharedPointer<ReceivedMessage> receivedMessage, SharedNodePointer senderNode,
                                  const QDir& resourcesDir, uint64_t filesizeLimit) :
     _receivedMessage(receivedMessage),
@@ -30,17 +39,18 @@ UploadAssetTask::UploadAssetTask(QSharedPointer<ReceivedMessage> receivedMessage
     
 }
 
+std::atomic<uint64_t> UploadAssetTask::_numUploads { 0 };
+std::atomic<uint64_t> UploadAssetTask::_numDuplicateUploads { 0 };
+std::atomic<uint64_t> UploadAssetTask::_bytesUploaded { 0 };
+std::atomic<uint64_t> UploadAssetTask::_uploadUsecs { 0 };
+
 void UploadAssetTask::run() {
-    auto data = _receivedMessage->getMessage();
-    
-    QBuffer buffer { &data };
-    buffer.open(QIODevice::ReadOnly);
-    
+    // the upload is read straight out of the received message, it's never copied
     MessageID messageID;
-    buffer.read(reinterpret_cast<char*>(&messageID), sizeof(messageID));
+    _receivedMessage->readPrimitive(&messageID);
     
     uint64_t fileSize;
-    buffer.read(reinterpret_cast<char*>(&fileSize), sizeof(fileSize));
+    _receivedMessage->readPrimitive(&fileSize);
 
     if (_senderNode) {
         qDebug() << "UploadAssetTask reading a file of " << fileSize << "bytes from" << uuidStringWithoutCurlyBraces(_senderNode->getUUID());
@@ -53,12 +63,38 @@ void UploadAssetTask::run() {
     
     if (fileSize > _filesizeLimit) {
         replyPacket->writePrimitive(AssetUtils::AssetServerError::AssetTooLarge);
+    } else if ((uint64_t)_receivedMessage->getBytesLeftToRead() < fileSize) {
+        qWarning() << "Upload is shorter than its announced size of" << fileSize << "bytes - upload failed.";
+        replyPacket->writePrimitive(AssetUtils::AssetServerError::FileOperationFailed);
     } else {
-        QByteArray fileData = buffer.read(fileSize);
-        
-        auto hash = AssetUtils::hashData(fileData);
+        auto startTime = usecTimestampNow();
+        const char* fileData = _receivedMessage->getRawMessage() + _receivedMessage->getPosition();
+
+        // the name of the file is its hash, which we only know once we've seen all of it: write it to a temporary file
+        // on another thread while we hash it, then give it its name
+        QFile tempFile { _resourcesDir.filePath(TEMP_UPLOAD_PREFIX + uuidStringWithoutCurlyBraces(QUuid::createUuid())) };
+        auto tempFileWritten = std::async(std::launch::async, [&] {
+            if (!tempFile.open(QIODevice::WriteOnly)) {
+                return false;
+            }
+            for (qint64 offset = 0; offset < (qint64)fileSize; offset += WRITE_CHUNK_SIZE) {
+                qint64 chunkSize = std::min(WRITE_CHUNK_SIZE, (qint64)fileSize - offset);
+                if (tempFile.write(fileData + offset, chunkSize) != chunkSize) {
+                    return false;
+                }
+            }
+            tempFile.close();
+            return true;
+        });
+
+        // the chunk manifest of a large asset is left for the first time it's asked for, so this is its only hash
+        AssetUtils::Hasher hasher;
+        hasher.addData(fileData, fileSize);
+        auto hash = hasher.result();
         auto hexHash = hash.toHex();
 
+        bool wasWritten = tempFileWritten.get();
+
         if (_senderNode) {
             qDebug() << "Hash for uploaded file from" << uuidStringWithoutCurlyBraces(_senderNode->getUUID()) << "is: (" << hexHash << ")";
         } else {
@@ -67,45 +103,49 @@ void UploadAssetTask::run() {
         
         QFile file { _resourcesDir.filePath(QString(hexHash)) };
 
-        bool existingCorrectFile = false;
-        
-        if (file.exists()) {
-            // check if the local file has the correct contents, otherwise we overwrite
-            if (file.open(QIODevice::ReadOnly) && AssetUtils::hashData(file.readAll()) == hash) {
-                qDebug() << "Not overwriting existing verified file: " << hexHash;
-
-                existingCorrectFile = true;
-
-                replyPacket->writePrimitive(AssetUtils::AssetServerError::NoError);
-                replyPacket->write(hash);
-            } else {
-                qDebug() << "Overwriting an existing file whose contents did not match the expected hash: " << hexHash;
-                file.close();
+        // files are named after their hash, so one of the right size has the right contents
+        // (a different size is what's left of a write that didn't complete)
+        auto hasCompleteFile = [&] {
+            return file.exists() && (uint64_t)file.size() == fileSize;
+        };
+
+        bool isDuplicate = hasCompleteFile();
+        bool isStored = isDuplicate;
+        if (!isStored && wasWritten) {
+            // over what's left of a write that didn't complete, if anything, so the hash is never missing meanwhile
+            isStored = FileUtils::replaceFile(tempFile.fileName(), file.fileName());
+
+            if (!isStored && hasCompleteFile()) {
+                // someone uploading the same file got there first
+                isDuplicate = isStored = true;
             }
         }
 
-        if (!existingCorrectFile) {
-            if (file.open(QIODevice::WriteOnly) && file.write(fileData) == qint64(fileSize)) {
-                qDebug() << "Wrote file" << hexHash << "to disk. Upload complete";
-                file.close();
-
-                replyPacket->writePrimitive(AssetUtils::AssetServerError::NoError);
-                replyPacket->write(hash);
+        if (isStored) {
+            if (isDuplicate) {
+                qDebug() << "Not overwriting existing file: " << hexHash;
+                tempFile.remove();
+                ++_numDuplicateUploads;
             } else {
-                qWarning() << "Failed to upload or write to file" << hexHash << " - upload failed.";
+                qDebug() << "Wrote file" << hexHash << "to disk. Upload complete";
+            }
 
-                // upload has failed - remove the file and return an error
-                auto removed = file.remove();
+            replyPacket->writePrimitive(AssetUtils::AssetServerError::NoError);
+            replyPacket->write(hash);
+        } else {
+            qWarning() << "Failed to upload or write to file" << hexHash << " - upload failed.";
 
-                if (!removed) {
-                    qWarning() << "Removal of failed upload file" << hexHash << "failed.";
-                }
-                
-                replyPacket->writePrimitive(AssetUtils::AssetServerError::FileOperationFailed);
+            // upload has failed - remove the temporary file and return an error
+            if (tempFile.exists() && !tempFile.remove()) {
+                qWarning() << "Removal of failed upload file" << tempFile.fileName() << "failed.";
             }
+            
+            replyPacket->writePrimitive(AssetUtils::AssetServerError::FileOperationFailed);
         }
 
-
+        ++_numUploads;
+        _bytesUploaded += fileSize;
+        _uploadUsecs += usecTimestampNow() - startTime;
     }
     
     auto nodeList = DependencyManager::get<NodeList>();
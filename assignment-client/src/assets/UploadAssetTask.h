@@ -14,6 +14,8 @@
 #ifndef hifi_UploadAssetTask_h
 #define hifi_UploadAssetTask_h
 
+#include <atomic>
+
 #include <QtCore/QDir>
 #include <QtCore/QObject>
 #include <QtCore/QRunnable>
@@ -31,7 +33,21 @@ public:
 
     void run() override;
 
+    /// Uploads are written under this prefix until they are complete and named after their hash
+    static const QString TEMP_UPLOAD_PREFIX;
+
+    static uint64_t getNumUploads() { return _numUploads; }
+    static uint64_t getNumDuplicateUploads() { return _numDuplicateUploads; }
+    static uint64_t getBytesUploaded() { return _bytesUploaded; }
+    /// Time spent hashing and storing uploads
+    static uint64_t getUploadUsecs() { return _uploadUsecs; }
+
 private:
+    static std::atomic<uint64_t> _numUploads;
+    static std::atomic<uint64_t> _numDuplicateUploads;
+    static std::atomic<uint64_t> _bytesUploaded;
+    static std::atomic<uint64_t> _uploadUsecs;
+
     QSharedPointer<ReceivedMessage> _receivedMessage;
     QSharedPointer<Node> _senderNode;
     QDir _resourcesDir;
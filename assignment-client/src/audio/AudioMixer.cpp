@@ -83,9 +83,11 @@ AudioMixer::AudioMixer(ReceivedMessage& message) :
         });
 
     auto nodeList = DependencyManager::get<NodeList>();
+    nodeList->linkedDataCreateCallback = [this](Node* node) { createClientData(node); };
     auto& packetReceiver = nodeList->getPacketReceiver();
 
-    // packets whose consequences are limited to their own node can be parallelized
+    // packets whose consequences are limited to their own node can be parallelized - they go straight from
+    // the NodeList thread to the client's lock-free packet queue, which keeps them in the order they arrived
     packetReceiver.registerListenerForTypes({
             PacketType::MicrophoneAudioNoEcho,
             PacketType::MicrophoneAudioWithEcho,
@@ -101,7 +103,9 @@ AudioMixer::AudioMixer(ReceivedMessage& message) :
             PacketType::InjectorGainSet,
             PacketType::AudioSoloRequest,
             PacketType::StopInjector },
-            this, "queueAudioPacket");
+            this, [this](QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
+                queueAudioPacket(message, node);
+            }, PacketReceiver::ListenerDelivery::Direct);
 
     // packets whose consequences are global should be processed on the main thread
     packetReceiver.registerListener(PacketType::MuteEnvironment, this, "handleMuteEnvironmentPacket");
@@ -121,6 +125,8 @@ AudioMixer::AudioMixer(ReceivedMessage& message) :
 }
 
 void AudioMixer::aboutToFinish() {
+    DependencyManager::get<NodeList>()->linkedDataCreateCallback = nullptr;
+
     DependencyManager::destroy<PluginManager>();
 }
 
@@ -129,7 +135,7 @@ void AudioMixer::queueAudioPacket(QSharedPointer<ReceivedMessage> message, Share
         _numSilentPackets++;
     }
 
-    getOrCreateClientData(node.data())->queuePacket(message, node);
+    getOrCreateClientData(node)->queuePacket(message, node);
 }
 
 void AudioMixer::queueReplicatedAudioPacket(QSharedPointer<ReceivedMessage> message) {
@@ -157,7 +163,7 @@ void AudioMixer::queueReplicatedAudioPacket(QSharedPointer<ReceivedMessage> mess
                                                                      versionForPacketType(rewrittenType),
                                                                      message->getSenderSockAddr(), Node::NULL_LOCAL_ID);
 
-    getOrCreateClientData(replicatedNode.data())->queuePacket(replicatedMessage, replicatedNode);
+    getOrCreateClientData(replicatedNode)->queuePacket(replicatedMessage, replicatedNode);
 }
 
 void AudioMixer::handleMuteEnvironmentPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
@@ -384,16 +390,18 @@ void AudioMixer::run() {
     ThreadedAssignment::commonInit(AUDIO_MIXER_LOGGING_TARGET_NAME, NodeType::AudioMixer);
 }
 
-AudioMixerClientData* AudioMixer::getOrCreateClientData(Node* node) {
-    auto clientData = dynamic_cast<AudioMixerClientData*>(node->getLinkedData());
-
-    if (!clientData) {
-        node->setLinkedData(unique_ptr<NodeData> { new AudioMixerClientData(node->getUUID(), node->getLocalID()) });
-        clientData = dynamic_cast<AudioMixerClientData*>(node->getLinkedData());
-        connect(clientData, &AudioMixerClientData::injectorStreamFinished, this, &AudioMixer::removeHRTFsForFinishedInjector);
-    }
+AudioMixerClientData* AudioMixer::getOrCreateClientData(SharedNodePointer node) {
+    // packets are queued from the node list's thread, so the client data is only ever created under the node's mutex
+    auto nodeList = DependencyManager::get<NodeList>();
+    return dynamic_cast<AudioMixerClientData*>(nodeList->getOrCreateLinkedData(node));
+}
 
-    return clientData;
+void AudioMixer::createClientData(Node* node) {
+    auto clientData = new AudioMixerClientData(node->getUUID(), node->getLocalID());
+    // it can be created on the node list's thread, but it belongs with the mixer
+    clientData->moveToThread(thread());
+    connect(clientData, &AudioMixerClientData::injectorStreamFinished, this, &AudioMixer::removeHRTFsForFinishedInjector);
+    node->setLinkedData(unique_ptr<NodeData> { clientData });
 }
 
 void AudioMixer::start() {
@@ -404,7 +412,9 @@ void AudioMixer::start() {
         NodeType::Agent, NodeType::EntityScriptServer,
         NodeType::UpstreamAudioMixer, NodeType::DownstreamAudioMixer
     });
-    nodeList->linkedDataCreateCallback = [&](Node* node) { getOrCreateClientData(node); };
+
+    // silent frames and stream stats to each listener go out together
+    nodeList->setPacketCoalescingEnabled(true);
 
     // parse out any AudioMixer settings
     {
@@ -464,6 +474,9 @@ void AudioMixer::start() {
             _slavePool.mix(cbegin, cend, frame, numToRetain);
         });
 
+        // send whatever this frame coalesced rather than waiting on the socket's flush timer
+        nodeList->flushCoalescedPackets();
+
         // gather stats
         _slavePool.each([&](AudioMixerSlave& slave) {
             _stats.accumulate(slave.stats);
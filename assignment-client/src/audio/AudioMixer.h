@@ -12,6 +12,8 @@
 #ifndef hifi_AudioMixer_h
 #define hifi_AudioMixer_h
 
+#include <atomic>
+
 #include <AABox.h>
 #include <AudioHRTF.h>
 #include <AudioRingBuffer.h>
@@ -87,7 +89,9 @@ private:
     std::chrono::microseconds timeFrame();
     void throttle(std::chrono::microseconds frameDuration, int frame);
 
-    AudioMixerClientData* getOrCreateClientData(Node* node);
+    AudioMixerClientData* getOrCreateClientData(SharedNodePointer node);
+    // the node list's linked data create callback, called under the node's mutex
+    void createClientData(Node* node);
 
     QString percentageForMixStats(int counter);
 
@@ -100,7 +104,7 @@ private:
     float _trailingMixRatio { 0.0f };
     float _throttlingRatio { 0.0f };
 
-    int _numSilentPackets { 0 };
+    std::atomic<int> _numSilentPackets { 0 };
 
     int _numStatFrames { 0 };
     AudioMixerStats _stats;
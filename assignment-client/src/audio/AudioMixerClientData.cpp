@@ -51,19 +51,19 @@ AudioMixerClientData::~AudioMixerClientData() {
 }
 
 void AudioMixerClientData::queuePacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
-    if (!_packetQueue.node) {
-        _packetQueue.node = node;
-    }
-    _packetQueue.push(message);
+    _packetQueue.push({ message, node });
 }
 
 int AudioMixerClientData::processPackets(ConcurrentAddedStreams& addedStreams) {
-    SharedNodePointer node = _packetQueue.node;
-    assert(_packetQueue.empty() || node);
-    _packetQueue.node.clear();
-
-    while (!_packetQueue.empty()) {
-        auto& packet = _packetQueue.front();
+    QueuedPacket queuedPacket;
+
+    while (_packetQueue.try_pop(queuedPacket)) {
+        auto& packet = queuedPacket.message;
+        SharedNodePointer node = queuedPacket.node;
+        if (!node) {
+            // the sender went away after this packet was queued
+            continue;
+        }
 
         switch (packet->getType()) {
             case PacketType::MicrophoneAudioNoEcho:
@@ -110,10 +110,7 @@ int AudioMixerClientData::processPackets(ConcurrentAddedStreams& addedStreams) {
             default:
                 Q_UNREACHABLE();
         }
-
-        _packetQueue.pop();
     }
-    assert(_packetQueue.empty());
 
     // now that we have processed all packets for this frame
     // we can prepare the sources from this client to be ready for mixing
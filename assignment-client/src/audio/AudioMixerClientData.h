@@ -12,8 +12,7 @@
 #ifndef hifi_AudioMixerClientData_h
 #define hifi_AudioMixerClientData_h
 
-#include <queue>
-
+#include <tbb/concurrent_queue.h>
 #include <tbb/concurrent_vector.h>
 
 #include <QtCore/QJsonObject>
@@ -169,10 +168,12 @@ public slots:
     void sendSelectAudioFormat(SharedNodePointer node, const QString& selectedCodecName);
 
 private:
-    struct PacketQueue : public std::queue<QSharedPointer<ReceivedMessage>> {
+    // filled from the NodeList thread and drained by a slave thread, without locking
+    struct QueuedPacket {
+        QSharedPointer<ReceivedMessage> message;
         QWeakPointer<Node> node;
     };
-    PacketQueue _packetQueue;
+    tbb::concurrent_queue<QueuedPacket> _packetQueue;
 
     AudioStreamVector _audioStreams; // microphone stream from avatar has a null stream ID
 
@@ -71,7 +71,13 @@ AvatarMixer::AvatarMixer(ReceivedMessage& message) :
     connect(DependencyManager::get<NodeList>().data(), &NodeList::nodeKilled, this, &AvatarMixer::handleAvatarKilled);
 
     auto& packetReceiver = DependencyManager::get<NodeList>()->getPacketReceiver();
-    packetReceiver.registerListener(PacketType::AvatarData, this, "queueIncomingPacket");
+    // per-node packets go straight from the NodeList thread to the client's lock-free packet queue
+    auto queueIncomingPacketCallback = [this](QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
+        queueIncomingPacket(message, node);
+    };
+    packetReceiver.registerListenerForTypes({ PacketType::AvatarData, PacketType::SetAvatarTraits,
+                                              PacketType::BulkAvatarTraitsAck, PacketType::ChallengeOwnership },
+                                            this, queueIncomingPacketCallback, PacketReceiver::ListenerDelivery::Direct);
     packetReceiver.registerListener(PacketType::AdjustAvatarSorting, this, "handleAdjustAvatarSorting");
     packetReceiver.registerListener(PacketType::AvatarQuery, this, "handleAvatarQueryPacket");
     packetReceiver.registerListener(PacketType::AvatarIdentity, this, "handleAvatarIdentityPacket");
@@ -79,11 +85,8 @@ AvatarMixer::AvatarMixer(ReceivedMessage& message) :
     packetReceiver.registerListener(PacketType::NodeIgnoreRequest, this, "handleNodeIgnoreRequestPacket");
     packetReceiver.registerListener(PacketType::RadiusIgnoreRequest, this, "handleRadiusIgnoreRequestPacket");
     packetReceiver.registerListener(PacketType::RequestsDomainListData, this, "handleRequestsDomainListDataPacket");
-    packetReceiver.registerListener(PacketType::SetAvatarTraits, this, "queueIncomingPacket");
-    packetReceiver.registerListener(PacketType::BulkAvatarTraitsAck, this, "queueIncomingPacket");
     packetReceiver.registerListenerForTypes({ PacketType::OctreeStats, PacketType::EntityData, PacketType::EntityErase },
         this, "handleOctreePacket");
-    packetReceiver.registerListener(PacketType::ChallengeOwnership, this, "queueIncomingPacket");
 
     packetReceiver.registerListenerForTypes({
         PacketType::ReplicatedAvatarIdentity,
@@ -93,6 +96,7 @@ AvatarMixer::AvatarMixer(ReceivedMessage& message) :
     packetReceiver.registerListener(PacketType::ReplicatedBulkAvatarData, this, "handleReplicatedBulkAvatarPacket");
 
     auto nodeList = DependencyManager::get<NodeList>();
+    nodeList->linkedDataCreateCallback = [this](Node* node) { createClientData(node); };
     connect(nodeList.data(), &NodeList::packetVersionMismatch, this, &AvatarMixer::handlePacketVersionMismatch);
     connect(nodeList.data(), &NodeList::nodeAdded, this, [this](const SharedNodePointer& node) {
         if (node->getType() == NodeType::DownstreamAvatarMixer) {
@@ -205,7 +209,15 @@ void AvatarMixer::optionallyReplicatePacket(ReceivedMessage& message, const Node
 
 void AvatarMixer::queueIncomingPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
     auto start = usecTimestampNow();
-    getOrCreateClientData(node)->queuePacket(message, node);
+    {
+        // this runs on the node list's thread, the node's mutex keeps the mixer thread from creating or
+        // dropping the client data while we queue the packet on it
+        QMutexLocker nodeLocker(&node->getMutex());
+        if (!node->getLinkedData()) {
+            createClientData(node.data());
+        }
+        static_cast<AvatarMixerClientData*>(node->getLinkedData())->queuePacket(message, node);
+    }
     auto end = usecTimestampNow();
     _queueIncomingPacketElapsedTime += (end - start);
 }
@@ -672,7 +684,10 @@ void AvatarMixer::handleKillAvatarPacket(QSharedPointer<ReceivedMessage> message
     auto start = usecTimestampNow();
     handleAvatarKilled(node);
 
-    node->setLinkedData(nullptr);
+    {
+        QMutexLocker nodeLocker(&node->getMutex());
+        node->setLinkedData(nullptr);
+    }
     auto end = usecTimestampNow();
     _handleKillAvatarPacketElapsedTime += (end - start);
 
@@ -773,7 +788,9 @@ void AvatarMixer::sendStatsPacket() {
 
     QJsonObject singleCoreTasks;
     singleCoreTasks["processEvents"] = TIGHT_LOOP_STAT_UINT64(_processEventsElapsedTime);
-    singleCoreTasks["queueIncomingPacket"] = TIGHT_LOOP_STAT_UINT64(_queueIncomingPacketElapsedTime);
+    // added to by the node list's thread
+    quint64 queueIncomingPacketElapsedTime = _queueIncomingPacketElapsedTime.exchange(0);
+    singleCoreTasks["queueIncomingPacket"] = TIGHT_LOOP_STAT_UINT64(queueIncomingPacketElapsedTime);
 
     QJsonObject incomingPacketStats;
     incomingPacketStats["handleAvatarIdentityPacket"] = TIGHT_LOOP_STAT_UINT64(_handleAvatarIdentityPacketElapsedTime);
@@ -855,7 +872,6 @@ void AvatarMixer::sendStatsPacket() {
     _handleRadiusIgnoreRequestPacketElapsedTime = 0;
     _handleRequestsDomainListDataPacketElapsedTime = 0;
     _processEventsElapsedTime = 0;
-    _queueIncomingPacketElapsedTime = 0;
     _processQueuedAvatarDataPacketsElapsedTime = 0;
     _processQueuedAvatarDataPacketsLockWaitElapsedTime = 0;
 
@@ -935,17 +951,17 @@ void AvatarMixer::run() {
 }
 
 AvatarMixerClientData* AvatarMixer::getOrCreateClientData(SharedNodePointer node) {
-    auto clientData = dynamic_cast<AvatarMixerClientData*>(node->getLinkedData());
-
-    if (!clientData) {
-        node->setLinkedData(std::unique_ptr<NodeData> { new AvatarMixerClientData(node->getUUID(), node->getLocalID()) });
-        clientData = dynamic_cast<AvatarMixerClientData*>(node->getLinkedData());
-        auto& avatar = clientData->getAvatar();
-        avatar.setDomainMinimumHeight(_domainMinimumHeight);
-        avatar.setDomainMaximumHeight(_domainMaximumHeight);
-    }
+    // packets are queued from the node list's thread, so the client data is only ever created under the node's mutex
+    auto nodeList = DependencyManager::get<NodeList>();
+    return dynamic_cast<AvatarMixerClientData*>(nodeList->getOrCreateLinkedData(node));
+}
 
-    return clientData;
+void AvatarMixer::createClientData(Node* node) {
+    auto clientData = new AvatarMixerClientData(node->getUUID(), node->getLocalID());
+    auto& avatar = clientData->getAvatar();
+    avatar.setDomainMinimumHeight(_domainMinimumHeight);
+    avatar.setDomainMaximumHeight(_domainMaximumHeight);
+    node->setLinkedData(std::unique_ptr<NodeData> { clientData });
 }
 
 void AvatarMixer::domainSettingsRequestComplete() {
@@ -1145,6 +1161,8 @@ void AvatarMixer::entityChange() {
 }
 
 void AvatarMixer::aboutToFinish() {
+    DependencyManager::get<NodeList>()->linkedDataCreateCallback = nullptr;
+
     DependencyManager::destroy<ResourceManager>();
     DependencyManager::destroy<ResourceCacheSharedItems>();
     DependencyManager::destroy<ModelCache>();
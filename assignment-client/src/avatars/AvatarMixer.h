@@ -15,6 +15,7 @@
 #ifndef hifi_AvatarMixer_h
 #define hifi_AvatarMixer_h
 
+#include <atomic>
 #include <set>
 #include <shared/RateCounter.h>
 #include <PortableHighResolutionClock.h>
@@ -69,6 +70,7 @@ private slots:
 
 private:
     AvatarMixerClientData* getOrCreateClientData(SharedNodePointer node);
+    void createClientData(Node* node);
     std::chrono::microseconds timeFrame(p_high_resolution_clock::time_point& timestamp);
     void throttle(std::chrono::microseconds duration, int frame);
 
@@ -145,7 +147,7 @@ private:
 
     quint64 _processEventsElapsedTime { 0 };
     quint64 _sendStatsElapsedTime { 0 };
-    quint64 _queueIncomingPacketElapsedTime { 0 };
+    std::atomic<quint64> _queueIncomingPacketElapsedTime { 0 };
     quint64 _lastStatsTime { usecTimestampNow() };
 
     RateCounter<> _loopRate; // this is the rate that the main thread tight loop runs
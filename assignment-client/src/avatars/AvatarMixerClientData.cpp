@@ -46,20 +46,20 @@ void AvatarMixerClientData::setLastOtherAvatarEncodeTime(NLPacket::LocalID other
 }
 
 void AvatarMixerClientData::queuePacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
-    if (!_packetQueue.node) {
-        _packetQueue.node = node;
-    }
-    _packetQueue.push(message);
+    _packetQueue.push({ message, node });
 }
 
 int AvatarMixerClientData::processPackets(const SlaveSharedData& slaveSharedData) {
     int packetsProcessed = 0;
-    SharedNodePointer node = _packetQueue.node;
-    assert(_packetQueue.empty() || node);
-    _packetQueue.node.clear();
-
-    while (!_packetQueue.empty()) {
-        auto& packet = _packetQueue.front();
+    QueuedPacket queuedPacket;
+
+    while (_packetQueue.try_pop(queuedPacket)) {
+        auto& packet = queuedPacket.message;
+        SharedNodePointer node = queuedPacket.node;
+        if (!node) {
+            // the sender went away after this packet was queued
+            continue;
+        }
 
         packetsProcessed++;
 
@@ -79,9 +79,7 @@ int AvatarMixerClientData::processPackets(const SlaveSharedData& slaveSharedData
             default:
                 Q_UNREACHABLE();
         }
-        _packetQueue.pop();
     }
-    assert(_packetQueue.empty());
 
     if (_avatar) {
         _avatar->processCertifyEvents();
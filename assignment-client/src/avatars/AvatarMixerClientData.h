@@ -16,7 +16,8 @@
 #include <cfloat>
 #include <unordered_map>
 #include <vector>
-#include <queue>
+
+#include <tbb/concurrent_queue.h>
 
 #include <QtCore/QJsonObject>
 #include <QtCore/QUrl>
@@ -159,10 +160,12 @@ public:
     void resetSentTraitData(Node::LocalID nodeID);
 
 private:
-    struct PacketQueue : public std::queue<QSharedPointer<ReceivedMessage>> {
+    // filled from the NodeList thread and drained by a slave thread, without locking
+    struct QueuedPacket {
+        QSharedPointer<ReceivedMessage> message;
         QWeakPointer<Node> node;
     };
-    PacketQueue _packetQueue;
+    tbb::concurrent_queue<QueuedPacket> _packetQueue;
 
     MixerAvatarSharedPointer _avatar { new MixerAvatar() };
 
@@ -49,6 +49,7 @@ EntityServer::EntityServer(ReceivedMessage& message) :
     DependencyManager::set<ModelFormatRegistry>(); // ModelFormatRegistry must be defined before ModelCache. See the ModelCache ctor
     DependencyManager::set<ModelCache>();
 
+    // edits are handed straight from the NodeList thread to the inbound packet processor's queue
     auto& packetReceiver = DependencyManager::get<NodeList>()->getPacketReceiver();
     packetReceiver.registerListenerForTypes({ PacketType::EntityAdd,
         PacketType::EntityClone,
@@ -59,7 +60,10 @@ EntityServer::EntityServer(ReceivedMessage& message) :
         PacketType::ChallengeOwnershipRequest,
         PacketType::ChallengeOwnershipReply },
         this,
-        "handleEntityPacket");
+        [this](QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
+            handleEntityPacket(message, senderNode);
+        },
+        PacketReceiver::ListenerDelivery::Direct);
 
     connect(&_dynamicDomainVerificationTimer, &QTimer::timeout, this, &EntityServer::startDynamicDomainVerification);
     _dynamicDomainVerificationTimer.setSingleShot(true);
@@ -76,6 +80,9 @@ EntityServer::~EntityServer() {
 }
 
 void EntityServer::aboutToFinish() {
+    // the edit listener runs on the node list's thread, this waits for it to be done with us
+    DependencyManager::get<NodeList>()->getPacketReceiver().unregisterListener(this);
+
     DependencyManager::get<ResourceManager>()->cleanup();
 
     DependencyManager::destroy<AssignmentDynamicFactory>();
@@ -84,9 +91,7 @@ void EntityServer::aboutToFinish() {
 }
 
 void EntityServer::handleEntityPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
-    if (_octreeInboundPacketProcessor) {
-        _octreeInboundPacketProcessor->queueReceivedPacket(message, senderNode);
-    }
+    queueInboundPacket(message, senderNode);
 }
 
 std::unique_ptr<OctreeQueryNode> EntityServer::createOctreeQueryNode() {
@@ -339,6 +344,20 @@ void EntityServer::readAdditionalConfiguration(const QJsonObject& settingsSectio
     tree->setWantEditLogging(wantEditLogging);
     tree->setWantTerseEditLogging(wantTerseEditLogging);
 
+    bool useAABBTreeIndex = false;
+    readOptionBool(QString("useAABBTreeIndex"), settingsSectionObject, useAABBTreeIndex);
+    qDebug("useAABBTreeIndex=%s", debug::valueOf(useAABBTreeIndex));
+    tree->setUseAABBTree(useAABBTreeIndex);
+
+    bool useSharedInterestSets = false;
+    readOptionBool(QString("useSharedInterestSets"), settingsSectionObject, useSharedInterestSets);
+    qDebug("useSharedInterestSets=%s", debug::valueOf(useSharedInterestSets));
+    if (useSharedInterestSets) {
+        _interestManager = std::make_shared<EntityInterestManager>();
+    } else {
+        _interestManager.reset();
+    }
+
     QString entityScriptSourceWhitelist;
     if (readOptionString("entityScriptSourceWhitelist", settingsSectionObject, entityScriptSourceWhitelist)) {
         tree->setEntityScriptSourceWhitelist(entityScriptSourceWhitelist);
@@ -414,6 +433,17 @@ QString EntityServer::serverSubclassStats() {
     statsString += QString().sprintf("       EntityItem size... %ld bytes\r\n", sizeof(EntityItem));
     statsString += "\r\n\r\n";
 
+    if (_interestManager) {
+        statsString += "<b>Entity Server Shared Interest Sets</b>\r\n";
+        statsString += QString("     View buckets of current snapshot: %1\r\n")
+            .arg(locale.toString(_interestManager->getNumBuckets()).rightJustified(12, ' '));
+        statsString += QString("                  Traversals started: %1\r\n")
+            .arg(locale.toString((qulonglong)_interestManager->getNumRequests()).rightJustified(12, ' '));
+        statsString += QString(" Traversals that shared their bucket: %1\r\n")
+            .arg(locale.toString((qulonglong)_interestManager->getNumSharedRequests()).rightJustified(12, ' '));
+        statsString += "\r\n\r\n";
+    }
+
     statsString += "<b>Entity Server Sending to Viewer Statistics</b>\r\n";
     statsString += "----- Viewer Node ID -----------------    ----- Entity ID ----------------------    "
                    "---------- Last Sent To ----------    ---------- Last Edited -----------\r\n";
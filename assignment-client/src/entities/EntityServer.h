@@ -16,6 +16,7 @@
 
 #include <memory>
 
+#include <EntityInterestSets.h>
 #include <EntityItem.h>
 #include <EntityTree.h>
 #include <SimpleEntitySimulation.h>
@@ -59,6 +60,9 @@ public:
 
     virtual void aboutToFinish() override;
 
+    // null unless the send threads share their interest sets
+    const EntityInterestManagerPointer& getInterestManager() const { return _interestManager; }
+
 public slots:
     virtual void nodeAdded(SharedNodePointer node) override;
     virtual void nodeKilled(SharedNodePointer node) override;
@@ -76,6 +80,7 @@ private slots:
 private:
     SimpleEntitySimulationPointer _entitySimulation;
     QTimer* _pruneDeletedEntitiesTimer = nullptr;
+    EntityInterestManagerPointer _interestManager;
 
     QReadWriteLock _viewerSendingStatsLock;
     QMap<QUuid, QMap<QUuid, ViewerSendingStats>> _viewerSendingStats;
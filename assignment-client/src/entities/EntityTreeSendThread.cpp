@@ -20,19 +20,65 @@
 EntityTreeSendThread::EntityTreeSendThread(OctreeServer* myServer, const SharedNodePointer& node) :
     OctreeSendThread(myServer, node)
 {
-    connect(std::static_pointer_cast<EntityTree>(myServer->getOctree()).get(), &EntityTree::editingEntityPointer, this, &EntityTreeSendThread::editingEntityPointer, Qt::QueuedConnection);
-    connect(std::static_pointer_cast<EntityTree>(myServer->getOctree()).get(), &EntityTree::deletingEntityPointer, this, &EntityTreeSendThread::deletingEntityPointer, Qt::QueuedConnection);
+    // we run on the shared send workers, so these only queue the changes for our next pass (see processPendingChanges)
+    connect(std::static_pointer_cast<EntityTree>(myServer->getOctree()).get(), &EntityTree::editingEntityPointer, this, &EntityTreeSendThread::editingEntityPointer, Qt::DirectConnection);
+    connect(std::static_pointer_cast<EntityTree>(myServer->getOctree()).get(), &EntityTree::deletingEntityPointer, this, &EntityTreeSendThread::deletingEntityPointer, Qt::DirectConnection);
+
+    // viewers in the same place looking the same way share the culling and prioritization of their traversals
+    _traversal.setInterestManager(static_cast<EntityServer*>(myServer)->getInterestManager());
 
     // connect to connection ID change on EntityNodeData so we can clear state for this receiver
     auto nodeData = static_cast<EntityNodeData*>(node->getLinkedData());
-    connect(nodeData, &EntityNodeData::incomingConnectionIDChanged, this, &EntityTreeSendThread::resetState);
+    connect(nodeData, &EntityNodeData::incomingConnectionIDChanged, this, &EntityTreeSendThread::resetState, Qt::DirectConnection);
+}
+
+EntityTreeSendThread::~EntityTreeSendThread() {
+    // the tree calls our slots directly from whichever thread edits it, while holding its write lock,
+    // so once we have the lock no call is underway and none can start after we disconnect
+    auto tree = _myServer ? std::static_pointer_cast<EntityTree>(_myServer->getOctree()) : EntityTreePointer();
+    if (tree) {
+        tree->withWriteLock([&] {
+            disconnect(tree.get(), nullptr, this, nullptr);
+        });
+    }
 }
 
 void EntityTreeSendThread::resetState() {
-    qCDebug(entities) << "Clearing known EntityTreeSendThread state for" << _nodeUuid;
+    _resetStatePending = true;
+}
+
+void EntityTreeSendThread::processPendingChanges() {
+    if (_resetStatePending.exchange(false)) {
+        qCDebug(entities) << "Clearing known EntityTreeSendThread state for" << _nodeUuid;
+
+        _knownState.clear();
+        _traversal.reset();
+    }
 
-    _knownState.clear();
-    _traversal.reset();
+    std::vector<PendingEntityChange> pendingChanges;
+    {
+        std::lock_guard<std::mutex> lock(_pendingChangesMutex);
+        pendingChanges.swap(_pendingChanges);
+    }
+
+    for (const auto& change : pendingChanges) {
+        if (change.deletedEntity) {
+            _knownState.erase(change.deletedEntity);
+        } else if (change.editedEntity) {
+            auto& entity = change.editedEntity;
+            if (!_sendQueue.contains(entity.get()) && _knownState.find(entity.get()) != _knownState.end()) {
+                const auto& view = _traversal.getCurrentView();
+                float priority = view.computePriority(entity);
+
+                // We can force a removal from _knownState if the current view is used and entity is out of view
+                if (priority == PrioritizedEntity::DO_NOT_SEND) {
+                    _sendQueue.emplace(entity, PrioritizedEntity::FORCE_REMOVE, true);
+                } else if (priority == PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY) {
+                    _sendQueue.emplace(entity, PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY, true);
+                }
+            }
+        }
+    }
 }
 
 void EntityTreeSendThread::preDistributionProcessing() {
@@ -102,7 +148,8 @@ void EntityTreeSendThread::preDistributionProcessing() {
 bool EntityTreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, OctreeQueryNode* nodeData,
             bool viewFrustumChanged, bool isFullScene) {
     if (viewFrustumChanged || _traversal.finished()) {
-        EntityTreeElementPointer root = std::dynamic_pointer_cast<EntityTreeElement>(_myServer->getOctree()->getRoot());
+        auto entityTree = std::static_pointer_cast<EntityTree>(_myServer->getOctree());
+        auto snapshot = entityTree->getSnapshot(OCTREE_SEND_INTERVAL_USECS);
 
 
         DiffTraversal::View newView;
@@ -111,7 +158,7 @@ bool EntityTreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, O
         int32_t lodLevelOffset = nodeData->getBoundaryLevelAdjust() + (viewFrustumChanged ? LOW_RES_MOVING_ADJUST : NO_BOUNDARY_ADJUST);
         newView.lodScaleFactor = powf(2.0f, lodLevelOffset);
         
-        startNewTraversal(newView, root, isFullScene);
+        startNewTraversal(newView, snapshot, isFullScene);
 
         // When the viewFrustum changed the sort order may be incorrect, so we re-sort
         // and also use the opportunity to cull anything no longer in view
@@ -225,10 +272,10 @@ bool EntityTreeSendThread::addDescendantsToExtraFlaggedEntities(const QUuid& fil
     return hasNewChild || hasNewDescendants;
 }
 
-void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, EntityTreeElementPointer root,
+void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, EntityTreeSnapshotPointer snapshot,
                                              bool forceFirstPass) {
 
-    DiffTraversal::Type type = _traversal.prepareNewTraversal(view, root, forceFirstPass);
+    DiffTraversal::Type type = _traversal.prepareNewTraversal(view, snapshot, forceFirstPass);
     // there are three types of traversal:
     //
     //      (1) FirstTime = at login --> find everything in view
@@ -242,13 +289,18 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
             // When we get to a First traversal, clear the _knownState
             _knownState.clear();
             _traversal.setScanCallback([this](DiffTraversal::VisibleElement& next) {
-                next.element->forEachEntity([&](EntityItemPointer entity) {
+                _traversal.getSnapshot().forEachEntity(*next.element, [&](const EntityTreeSnapshot::Entity& snapshotEntity) {
+                    // Skip entities deleted since the snapshot was taken
+                    EntityItemPointer entity = snapshotEntity.entity.lock();
+                    if (!entity || entity->isDead()) {
+                        return;
+                    }
                     // Bail early if we've already checked this entity this frame
                     if (_sendQueue.contains(entity.get())) {
                         return;
                     }
                     const auto& view = _traversal.getCurrentView();
-                    float priority = view.computePriority(entity);
+                    float priority = view.computePriority(_traversal.getSnapshot(), snapshotEntity);
 
                     if (priority != PrioritizedEntity::DO_NOT_SEND) {
                         _sendQueue.emplace(entity, priority);
@@ -259,8 +311,13 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
         case DiffTraversal::Repeat:
             _traversal.setScanCallback([this](DiffTraversal::VisibleElement& next) {
                 uint64_t startOfCompletedTraversal = _traversal.getStartOfCompletedTraversal();
-                if (next.element->getLastChangedContent() > startOfCompletedTraversal) {
-                    next.element->forEachEntity([&](EntityItemPointer entity) {
+                if (next.element->lastChangedContent > startOfCompletedTraversal) {
+                    _traversal.getSnapshot().forEachEntity(*next.element, [&](const EntityTreeSnapshot::Entity& snapshotEntity) {
+                        // Skip entities deleted since the snapshot was taken
+                        EntityItemPointer entity = snapshotEntity.entity.lock();
+                        if (!entity || entity->isDead()) {
+                            return;
+                        }
                         // Bail early if we've already checked this entity this frame
                         if (_sendQueue.contains(entity.get())) {
                             return;
@@ -270,7 +327,7 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
                         auto knownTimestamp = _knownState.find(entity.get());
                         if (knownTimestamp == _knownState.end()) {
                             const auto& view = _traversal.getCurrentView();
-                            priority = view.computePriority(entity);
+                            priority = view.computePriority(_traversal.getSnapshot(), snapshotEntity);
 
                         } else if (entity->getLastEdited() > knownTimestamp->second ||
                                    entity->getLastChangedOnServer() > knownTimestamp->second) {
@@ -289,7 +346,12 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
         case DiffTraversal::Differential:
             assert(view.usesViewFrustums());
             _traversal.setScanCallback([this] (DiffTraversal::VisibleElement& next) {
-                next.element->forEachEntity([&](EntityItemPointer entity) {
+                _traversal.getSnapshot().forEachEntity(*next.element, [&](const EntityTreeSnapshot::Entity& snapshotEntity) {
+                    // Skip entities deleted since the snapshot was taken
+                    EntityItemPointer entity = snapshotEntity.entity.lock();
+                    if (!entity || entity->isDead()) {
+                        return;
+                    }
                     // Bail early if we've already checked this entity this frame
                     if (_sendQueue.contains(entity.get())) {
                         return;
@@ -299,7 +361,7 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
                     auto knownTimestamp = _knownState.find(entity.get());
                     if (knownTimestamp == _knownState.end()) {
                         const auto& view = _traversal.getCurrentView();
-                        priority = view.computePriority(entity);
+                        priority = view.computePriority(_traversal.getSnapshot(), snapshotEntity);
 
                     } else if (entity->getLastEdited() > knownTimestamp->second ||
                                entity->getLastChangedOnServer() > knownTimestamp->second) {
@@ -338,9 +400,12 @@ bool EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload(EncodeBitstream
         _packetData.appendValue(zeroByte); // colors
         if (params.includeExistsBits) {
             uint8_t childrenExistBits = 0;
-            EntityTreeElementPointer root = std::dynamic_pointer_cast<EntityTreeElement>(_myServer->getOctree()->getRoot());
+            // we don't hold the tree lock, so look at the root children in the latest snapshot
+            auto entityTree = std::static_pointer_cast<EntityTree>(_myServer->getOctree());
+            auto snapshot = entityTree->getSnapshot(OCTREE_SEND_INTERVAL_USECS);
+            const auto& root = snapshot->getElement(snapshot->getRootIndex());
             for (int32_t i = 0; i < NUMBER_OF_CHILDREN; ++i) {
-                if (root->getChildAtIndex(i)) {
+                if (root.children[i] != EntityTreeSnapshot::INVALID_INDEX) {
                     childrenExistBits += (1 << i);
                 }
             }
@@ -362,44 +427,48 @@ bool EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload(EncodeBitstream
     nodeData->stats.encodeStarted();
     auto entityNode = _node.toStrongRef();
     auto entityNodeData = static_cast<EntityNodeData*>(entityNode->getLinkedData());
-    while(!_sendQueue.empty()) {
-        PrioritizedEntity queuedItem = _sendQueue.top();
-        EntityItemPointer entity = queuedItem.getEntity();
-        if (entity) {
-            const QUuid& entityID = entity->getID();
-            // Only send entities that match the jsonFilters, but keep track of everything we've tried to send so we don't try to send it again;
-            // also send if we previously matched since this represents change to a matched item.
-            bool entityMatchesFilters = entity->matchesJSONFilters(jsonFilters);
-            bool entityPreviouslyMatchedFilter = entityNodeData->sentFilteredEntity(entityID);
-
-            if (entityMatchesFilters || entityNodeData->isEntityFlaggedAsExtra(entityID) || entityPreviouslyMatchedFilter) {
-                if (!jsonFilters.isEmpty() && entityMatchesFilters) {
-                    // Record explicitly filtered-in entity so that extra entities can be flagged.
-                    entityNodeData->insertSentFilteredEntity(entityID);
-                }
-                OctreeElement::AppendState appendEntityState = entity->appendEntityData(&_packetData, params, _extraEncodeData, entityNode->getCanGetAndSetPrivateUserData());
+    // the traversal ran over a snapshot, but the entities themselves are live and are edited under the tree's lock
+    auto entityTree = std::static_pointer_cast<EntityTree>(_myServer->getOctree());
+    entityTree->withReadLock([&] {
+        while(!_sendQueue.empty()) {
+            PrioritizedEntity queuedItem = _sendQueue.top();
+            EntityItemPointer entity = queuedItem.getEntity();
+            if (entity) {
+                const QUuid& entityID = entity->getID();
+                // Only send entities that match the jsonFilters, but keep track of everything we've tried to send so we don't try to send it again;
+                // also send if we previously matched since this represents change to a matched item.
+                bool entityMatchesFilters = entity->matchesJSONFilters(jsonFilters);
+                bool entityPreviouslyMatchedFilter = entityNodeData->sentFilteredEntity(entityID);
+
+                if (entityMatchesFilters || entityNodeData->isEntityFlaggedAsExtra(entityID) || entityPreviouslyMatchedFilter) {
+                    if (!jsonFilters.isEmpty() && entityMatchesFilters) {
+                        // Record explicitly filtered-in entity so that extra entities can be flagged.
+                        entityNodeData->insertSentFilteredEntity(entityID);
+                    }
+                    OctreeElement::AppendState appendEntityState = entity->appendEntityData(&_packetData, params, _extraEncodeData, entityNode->getCanGetAndSetPrivateUserData());
 
-                if (appendEntityState != OctreeElement::COMPLETED) {
-                    if (appendEntityState == OctreeElement::PARTIAL) {
-                        ++_numEntities;
+                    if (appendEntityState != OctreeElement::COMPLETED) {
+                        if (appendEntityState == OctreeElement::PARTIAL) {
+                            ++_numEntities;
+                        }
+                        params.stopReason = EncodeBitstreamParams::DIDNT_FIT;
+                        break;
                     }
-                    params.stopReason = EncodeBitstreamParams::DIDNT_FIT;
-                    break;
-                }
 
-                if (entityPreviouslyMatchedFilter && !entityMatchesFilters) {
-                    entityNodeData->removeSentFilteredEntity(entityID);
+                    if (entityPreviouslyMatchedFilter && !entityMatchesFilters) {
+                        entityNodeData->removeSentFilteredEntity(entityID);
+                    }
+                    ++_numEntities;
+                }
+                if (queuedItem.shouldForceRemove()) {
+                    _knownState.erase(entity.get());
+                } else {
+                    _knownState[entity.get()] = sendTime;
                 }
-                ++_numEntities;
-            }
-            if (queuedItem.shouldForceRemove()) {
-                _knownState.erase(entity.get());
-            } else {
-                _knownState[entity.get()] = sendTime;
             }
+            _sendQueue.pop();
         }
-        _sendQueue.pop();
-    }
+    });
     nodeData->stats.encodeStopped();
     if (_sendQueue.empty()) {
         assert(_sendQueue.empty());
@@ -420,20 +489,12 @@ bool EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload(EncodeBitstream
 
 void EntityTreeSendThread::editingEntityPointer(const EntityItemPointer& entity) {
     if (entity) {
-        if (!_sendQueue.contains(entity.get()) && _knownState.find(entity.get()) != _knownState.end()) {
-            const auto& view = _traversal.getCurrentView();
-            float priority = view.computePriority(entity);
-
-            // We can force a removal from _knownState if the current view is used and entity is out of view
-            if (priority == PrioritizedEntity::DO_NOT_SEND) {
-                _sendQueue.emplace(entity, PrioritizedEntity::FORCE_REMOVE, true);
-            } else if (priority == PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY) {
-                _sendQueue.emplace(entity, PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY, true);
-            }
-        }
+        std::lock_guard<std::mutex> lock(_pendingChangesMutex);
+        _pendingChanges.push_back({ entity, nullptr });
     }
 }
 
 void EntityTreeSendThread::deletingEntityPointer(EntityItem* entity) {
-    _knownState.erase(entity);
+    std::lock_guard<std::mutex> lock(_pendingChangesMutex);
+    _pendingChanges.push_back({ EntityItemPointer(), entity });
 }
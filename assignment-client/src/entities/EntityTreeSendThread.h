@@ -12,7 +12,9 @@
 #ifndef hifi_EntityTreeSendThread_h
 #define hifi_EntityTreeSendThread_h
 
+#include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include "../octree/OctreeSendThread.h"
 
@@ -29,8 +31,10 @@ class EntityTreeSendThread : public OctreeSendThread {
 
 public:
     EntityTreeSendThread(OctreeServer* myServer, const SharedNodePointer& node);
+    ~EntityTreeSendThread();
 
 protected:
+    bool traversesTreeSnapshot() const override { return true; }
     bool traverseTreeAndSendContents(SharedNodePointer node, OctreeQueryNode* nodeData,
             bool viewFrustumChanged, bool isFullScene) override;
 
@@ -42,10 +46,11 @@ private:
     bool addAncestorsToExtraFlaggedEntities(const QUuid& filteredEntityID, EntityItem& entityItem, EntityNodeData& nodeData);
     bool addDescendantsToExtraFlaggedEntities(const QUuid& filteredEntityID, EntityItem& entityItem, EntityNodeData& nodeData);
 
-    void startNewTraversal(const DiffTraversal::View& viewFrustum, EntityTreeElementPointer root, bool forceFirstPass = false);
+    void startNewTraversal(const DiffTraversal::View& viewFrustum, EntityTreeSnapshotPointer snapshot, bool forceFirstPass = false);
     bool traverseTreeAndBuildNextPacketPayload(EncodeBitstreamParams& params, const QJsonObject& jsonFilters) override;
 
     void preDistributionProcessing() override;
+    void processPendingChanges() override;
     bool hasSomethingToSend(OctreeQueryNode* nodeData) override { return !_sendQueue.empty(); }
     bool shouldStartNewTraversal(OctreeQueryNode* nodeData, bool viewFrustumChanged) override { return viewFrustumChanged || _traversal.finished(); }
 
@@ -58,6 +63,15 @@ private:
     int32_t _numEntitiesOffset { 0 };
     uint16_t _numEntities { 0 };
 
+    // tree changes are queued from the editing threads and applied by the worker at the start of each send pass
+    struct PendingEntityChange {
+        EntityItemPointer editedEntity;
+        EntityItem* deletedEntity { nullptr };
+    };
+    std::mutex _pendingChangesMutex;
+    std::vector<PendingEntityChange> _pendingChanges;
+    std::atomic<bool> _resetStatePending { false };
+
 private slots:
     void editingEntityPointer(const EntityItemPointer& entity);
     void deletingEntityPointer(EntityItem* entity);
@@ -22,6 +22,8 @@
 
 static QUuid DEFAULT_NODE_ID_REF;
 const quint64 TOO_LONG_SINCE_LAST_NACK = 1 * USECS_PER_SECOND;
+// pending edits get applied early once there are this many, to bound how long the tree stays write locked
+const int MAX_EDITS_PER_BATCH = 1000;
 
 OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServer) :
     _myServer(myServer),
@@ -32,7 +34,8 @@ OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServe
     _totalElementsInPacket(0),
     _totalPackets(0),
     _lastNackTime(usecTimestampNow()),
-    _shuttingDown(false)
+    _shuttingDown(false),
+    _lastEditWindowAt(usecTimestampNow())
 {
 }
 
@@ -44,6 +47,11 @@ void OctreeInboundPacketProcessor::resetStats() {
     _totalPackets = 0;
     _lastNackTime = usecTimestampNow();
 
+    _totalEditBatches = 0;
+    _totalBatchedEdits = 0;
+    _totalBatchLockHoldTime = 0;
+    _maxBatchLockHoldTime = 0;
+
     QWriteLocker locker(&_senderStatsLock);
     _singleSenderStats.clear();
 }
@@ -65,6 +73,14 @@ void OctreeInboundPacketProcessor::preProcess() {
         _lastNackTime = now;
         sendNackPackets();
     }
+
+    quint64 sinceLastEditWindow = now - _lastEditWindowAt;
+    if (sinceLastEditWindow > USECS_PER_SECOND) {
+        float secondsSinceLastEditWindow = (float)sinceLastEditWindow / USECS_PER_SECOND;
+        _editsPerSecond.updateAverage((float)_lastWindowEdits / secondsSinceLastEditWindow);
+        _lastEditWindowAt = now;
+        _lastWindowEdits = 0;
+    }
 }
 
 void OctreeInboundPacketProcessor::midProcess() {
@@ -76,6 +92,10 @@ void OctreeInboundPacketProcessor::midProcess() {
     }
 }
 
+void OctreeInboundPacketProcessor::postProcess() {
+    applyPendingEdits();
+}
+
 void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
     if (_shuttingDown) {
         qDebug() << "OctreeInboundPacketProcessor::processPacket() while shutting down... ignoring incoming packet";
@@ -125,9 +145,6 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
         }
 
         quint64 transitTime = arrivedAt - sentAt;
-        int editsInPacket = 0;
-        quint64 processTime = 0;
-        quint64 lockWaitTime = 0;
 
         if (debugProcessPacket || _myServer->wantsDebugReceiving()) {
             qDebug() << "PROCESSING THREAD: got '" << packetType << "' packet - " << _receivedPacketCount << " command from client";
@@ -152,77 +169,148 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
                 qDebug() << "    ----- UNEXPECTED ---- got a packet without any edit details!!!! --------";
             }
         }
-        
-        const unsigned char* editData = nullptr;
-        
-        while (message->getBytesLeftToRead() > 0) {
-
-            editData = reinterpret_cast<const unsigned char*>(message->getRawMessage() + message->getPosition());
 
-            int maxSize = message->getBytesLeftToRead();
-
-            if (debugProcessPacket) {
-                qDebug() << " --- inside while loop ---";
-                qDebug() << "    maxSize=" << maxSize;
-                qDebug("OctreeInboundPacketProcessor::processPacket() %hhu "
-                       "payload=%p payloadLength=%lld editData=%p payloadPosition=%lld maxSize=%d",
-                       (unsigned char)packetType, message->getRawMessage(), message->getSize(), editData,
-                        message->getPosition(), maxSize);
+        PendingEditPacket pending;
+        pending.message = message;
+        pending.sendingNode = sendingNode;
+        pending.sequence = sequence;
+        pending.transitTime = transitTime;
+
+        auto octree = _myServer->getOctree();
+        if (octree->preparesEditPacketType(packetType)) {
+            // decode and filter the edits now, under the read lock only, they get applied in applyPendingEdits()
+            quint64 startPrepare = usecTimestampNow();
+            const unsigned char* editData = nullptr;
+
+            while (message->getBytesLeftToRead() > 0) {
+
+                editData = reinterpret_cast<const unsigned char*>(message->getRawMessage() + message->getPosition());
+
+                int maxSize = message->getBytesLeftToRead();
+
+                if (debugProcessPacket) {
+                    qDebug() << " --- inside while loop ---";
+                    qDebug() << "    maxSize=" << maxSize;
+                    qDebug("OctreeInboundPacketProcessor::processPacket() %hhu "
+                           "payload=%p payloadLength=%lld editData=%p payloadPosition=%lld maxSize=%d",
+                           (unsigned char)packetType, message->getRawMessage(), message->getSize(), editData,
+                            message->getPosition(), maxSize);
+                }
+
+                int editDataBytesRead = 0;
+                auto edit = octree->prepareEditPacketData(*message, editData, maxSize, sendingNode, editDataBytesRead);
+                if (edit) {
+                    pending.edits.push_back(std::move(edit));
+                }
+
+                if (debugProcessPacket) {
+                    qDebug() << "OctreeInboundPacketProcessor::processPacket() after prepareEditPacketData()..."
+                        << "editDataBytesRead=" << editDataBytesRead;
+                }
+
+                if (editDataBytesRead <= 0) {
+                    break;
+                }
+
+                // skip to next edit record in the packet
+                message->seek(message->getPosition() + editDataBytesRead);
             }
 
-            quint64 startProcess, startLock = usecTimestampNow();
-            int editDataBytesRead;
-            _myServer->getOctree()->withWriteLock([&] {
-                startProcess = usecTimestampNow();
-                editDataBytesRead =
-                    _myServer->getOctree()->processEditPacketData(*message, editData, maxSize, sendingNode);
-            });
-            quint64 endProcess = usecTimestampNow();
-
-            if (debugProcessPacket) {
-                qDebug() << "OctreeInboundPacketProcessor::processPacket() after processEditPacketData()..."
-                    << "editDataBytesRead=" << editDataBytesRead;
-            }
+            pending.processTime = usecTimestampNow() - startPrepare;
+            _numPendingEdits += (int)pending.edits.size();
+        } else {
+            pending.editDataPosition = message->getPosition();
+            _numPendingEdits++;
+        }
 
-            editsInPacket++;
-            quint64 thisProcessTime = endProcess - startProcess;
-            quint64 thisLockWaitTime = startProcess - startLock;
-            processTime += thisProcessTime;
-            lockWaitTime += thisLockWaitTime;
+        _pendingEditPackets.push_back(std::move(pending));
+        if (_numPendingEdits >= MAX_EDITS_PER_BATCH) {
+            applyPendingEdits();
+        }
+    } else {
+        qDebug("unknown packet ignored... packetType=%hhu", (unsigned char)packetType);
+    }
+}
 
-            // skip to next edit record in the packet
-            message->seek(message->getPosition() + editDataBytesRead);
+void OctreeInboundPacketProcessor::applyPendingEdits() {
+    if (_pendingEditPackets.empty()) {
+        return;
+    }
+    if (_shuttingDown) {
+        _pendingEditPackets.clear();
+        _numPendingEdits = 0;
+        return;
+    }
 
-            if (debugProcessPacket) {
-                qDebug() << "    editDataBytesRead=" << editDataBytesRead;
-                qDebug() << "    AFTER processEditPacketData payload position=" << message->getPosition();
-                qDebug() << "    AFTER processEditPacketData payload size=" << message->getSize();
+    bool debugProcessPacket = _myServer->wantsVerboseDebug();
+    auto octree = _myServer->getOctree();
+    int editsInBatch = 0;
+
+    quint64 startProcess = 0, startLock = usecTimestampNow();
+    octree->withWriteLock([&] {
+        startProcess = usecTimestampNow();
+        for (auto& pending : _pendingEditPackets) {
+            quint64 startPacket = usecTimestampNow();
+            if (pending.editDataPosition < 0) {
+                for (auto& edit : pending.edits) {
+                    octree->applyPreparedEdit(*edit, pending.sendingNode);
+                }
+                pending.editsInPacket = (int)pending.edits.size();
+            } else {
+                ReceivedMessage& message = *pending.message;
+                message.seek(pending.editDataPosition);
+                while (message.getBytesLeftToRead() > 0) {
+                    auto editData = reinterpret_cast<const unsigned char*>(message.getRawMessage() + message.getPosition());
+                    int maxSize = message.getBytesLeftToRead();
+                    int editDataBytesRead = octree->processEditPacketData(message, editData, maxSize, pending.sendingNode);
+
+                    if (debugProcessPacket) {
+                        qDebug() << "OctreeInboundPacketProcessor::applyPendingEdits() after processEditPacketData()..."
+                            << "editDataBytesRead=" << editDataBytesRead;
+                    }
+
+                    pending.editsInPacket++;
+
+                    // skip to next edit record in the packet
+                    message.seek(message.getPosition() + editDataBytesRead);
+                }
             }
-
+            pending.processTime += usecTimestampNow() - startPacket;
+            editsInBatch += pending.editsInPacket;
         }
+    });
+    quint64 endProcess = usecTimestampNow();
 
-        if (debugProcessPacket) {
-            qDebug("OctreeInboundPacketProcessor::processPacket() DONE LOOPING FOR %hhu "
-                   "payload=%p payloadLength=%lld editData=%p payloadPosition=%lld",
-                   (unsigned char)packetType, message->getRawMessage(), message->getSize(), editData, message->getPosition());
-        }
+    // the lock was waited on once for all the packets of the batch
+    quint64 lockWaitTime = startProcess - startLock;
+    quint64 lockWaitTimePerPacket = lockWaitTime / _pendingEditPackets.size();
+    quint64 lockHoldTime = endProcess - startProcess;
+
+    if (debugProcessPacket) {
+        qDebug() << "OctreeInboundPacketProcessor::applyPendingEdits() applied" << editsInBatch << "edits from"
+            << _pendingEditPackets.size() << "packets, lockWaitTime=" << lockWaitTime << "lockHoldTime=" << lockHoldTime;
+    }
 
+    for (auto& pending : _pendingEditPackets) {
         // Make sure our Node and NodeList knows we've heard from this node.
         QUuid& nodeUUID = DEFAULT_NODE_ID_REF;
-        if (sendingNode) {
-            nodeUUID = sendingNode->getUUID();
-            if (debugProcessPacket) {
-                qDebug() << "sender has uuid=" << nodeUUID;
-            }
-        } else {
-            if (debugProcessPacket) {
-                qDebug() << "sender has no known nodeUUID.";
-            }
+        if (pending.sendingNode) {
+            nodeUUID = pending.sendingNode->getUUID();
         }
-        trackInboundPacket(nodeUUID, sequence, transitTime, editsInPacket, processTime, lockWaitTime);
-    } else {
-        qDebug("unknown packet ignored... packetType=%hhu", (unsigned char)packetType);
+        trackInboundPacket(nodeUUID, pending.sequence, pending.transitTime, pending.editsInPacket, pending.processTime,
+                           lockWaitTimePerPacket);
+    }
+
+    _totalEditBatches++;
+    _totalBatchedEdits += editsInBatch;
+    _totalBatchLockHoldTime += lockHoldTime;
+    if (lockHoldTime > _maxBatchLockHoldTime) {
+        _maxBatchLockHoldTime = lockHoldTime;
     }
+    _lastWindowEdits += editsInBatch;
+
+    _pendingEditPackets.clear();
+    _numPendingEdits = 0;
 }
 
 void OctreeInboundPacketProcessor::trackInboundPacket(const QUuid& nodeUUID, unsigned short int sequence, quint64 transitTime,
@@ -14,7 +14,11 @@
 #ifndef hifi_OctreeInboundPacketProcessor_h
 #define hifi_OctreeInboundPacketProcessor_h
 
+#include <vector>
+
+#include <Octree.h>
 #include <ReceivedPacketProcessor.h>
+#include <SimpleMovingAverage.h>
 
 #include "SequenceNumberStats.h"
 
@@ -70,6 +74,13 @@ public:
     quint64 getAverageLockWaitTimePerElement() const
                 { return _totalElementsInPacket == 0 ? 0 : _totalLockWaitTime / _totalElementsInPacket; }
 
+    quint64 getTotalEditBatches() const { return _totalEditBatches; }
+    quint64 getAverageEditsPerBatch() const { return _totalEditBatches == 0 ? 0 : _totalBatchedEdits / _totalEditBatches; }
+    quint64 getAverageLockHoldTimePerBatch() const
+                { return _totalEditBatches == 0 ? 0 : _totalBatchLockHoldTime / _totalEditBatches; }
+    quint64 getMaxLockHoldTimePerBatch() const { return _maxBatchLockHoldTime; }
+    float getEditsPerSecond() const { return _editsPerSecond.getAverage(); }
+
     void resetStats();
 
     NodeToSenderStatsMap getSingleSenderStats() { QReadLocker locker(&_senderStatsLock); return _singleSenderStats; }
@@ -83,10 +94,25 @@ protected:
     virtual uint32_t getMaxWait() const override;
     virtual void preProcess() override;
     virtual void midProcess() override;
+    virtual void postProcess() override;
 
 private:
     int sendNackPackets();
 
+    // Edit packets are decoded (and filtered, for the tree types that prepare their edits) as they get processed,
+    // but only applied to the tree after the whole tick's worth of packets, under a single write lock.
+    struct PendingEditPacket {
+        QSharedPointer<ReceivedMessage> message;
+        SharedNodePointer sendingNode;
+        unsigned short int sequence { 0 };
+        quint64 transitTime { 0 };
+        quint64 processTime { 0 };
+        int editsInPacket { 0 };
+        std::vector<PreparedOctreeEditPointer> edits;
+        qint64 editDataPosition { -1 }; // edits that weren't prepared start here in the message
+    };
+    void applyPendingEdits();
+
 private:
     void trackInboundPacket(const QUuid& nodeUUID, unsigned short int sequence, quint64 transitTime,
             int elementsInPacket, quint64 processTime, quint64 lockWaitTime);
@@ -105,5 +131,17 @@ private:
 
     std::atomic<uint64_t> _lastNackTime;
     bool _shuttingDown;
+
+    std::vector<PendingEditPacket> _pendingEditPackets;
+    int _numPendingEdits { 0 };
+
+    std::atomic<uint64_t> _totalEditBatches { 0 };
+    std::atomic<uint64_t> _totalBatchedEdits { 0 };
+    std::atomic<uint64_t> _totalBatchLockHoldTime { 0 };
+    std::atomic<uint64_t> _maxBatchLockHoldTime { 0 };
+
+    quint64 _lastEditWindowAt { 0 };
+    int _lastWindowEdits { 0 };
+    SimpleMovingAverage _editsPerSecond;
 };
 #endif // hifi_OctreeInboundPacketProcessor_h
@@ -11,9 +11,6 @@
 
 #include "OctreeSendThread.h"
 
-#include <chrono>
-#include <thread>
-
 #include <NodeList.h>
 #include <NumericalConstants.h>
 #include <udt/PacketHeaders.h>
@@ -73,7 +70,7 @@ bool OctreeSendThread::process() {
 
     OctreeServer::didProcess(this);
 
-    quint64  start = usecTimestampNow();
+    processPendingChanges();
 
     // we'd better have a server at this point, or we're in trouble
     assert(_myServer);
@@ -97,33 +94,18 @@ bool OctreeSendThread::process() {
         }
     }
 
-    if (_isShuttingDown) {
-        return false; // exit early if we're shutting down
-    }
-
-    // Only sleep if we're still running and we got the lock last time we tried, otherwise try to get the lock asap
-    if (isStillRunning()) {
-        // dynamically sleep until we need to fire off the next set of octree elements
-        int elapsed = (usecTimestampNow() - start);
-        int usecToSleep =  OCTREE_SEND_INTERVAL_USECS - elapsed;
-
-        if (usecToSleep <= 0) {
-            const int MIN_USEC_TO_SLEEP = 1;
-            usecToSleep = MIN_USEC_TO_SLEEP;
-        }
-
-        {
-            PerformanceWarning warn(false,"OctreeSendThread... usleep()",false,&_usleepTime,&_usleepCalls);
-            std::this_thread::sleep_for(std::chrono::microseconds(usecToSleep));
-        }
+    return !_isShuttingDown && isStillRunning();
+}
 
+bool OctreeSendThread::runScheduledPass() {
+    bool keepRunning = process();
+    if (!keepRunning) {
+        // let the server know it can remove us, the pool keeps this job marked as running until we return
+        emit finished();
     }
-
-    return isStillRunning();  // keep running till they terminate us
+    return keepRunning;
 }
 
-AtomicUIntStat OctreeSendThread::_usleepTime { 0 };
-AtomicUIntStat OctreeSendThread::_usleepCalls { 0 };
 AtomicUIntStat OctreeSendThread::_totalBytes { 0 };
 AtomicUIntStat OctreeSendThread::_totalWastedBytes { 0 };
 AtomicUIntStat OctreeSendThread::_totalPackets { 0 };
@@ -321,6 +303,11 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
     _trueBytesSent = 0;
     _packetsSentThisInterval = 0;
 
+    // calculate max number of packets that can be sent during this interval, from what the client's link carries
+    int maxPacketsPerSecond = std::min(nodeData->getMaxQueryPacketsPerSecond(), _myServer->getPacketsPerClientPerSecond());
+    _maxPacketsPerInterval = _sendBudget.startInterval(maxPacketsPerSecond, node->getConnectionStats(), node->getPingMs(),
+                                                       nodeData->takeNumNackedPackets(), usecTimestampNow());
+
     bool isFullScene = nodeData->shouldForceFullScene();
     if (isFullScene) {
         // we're forcing a full scene, clear the force in OctreeQueryNode so we don't force it next time again
@@ -363,9 +350,18 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
 
     quint64 start = usecTimestampNow();
 
-    _myServer->getOctree()->withReadLock([&]{
+    if (traversesTreeSnapshot()) {
+        // the traversal works on a snapshot of the tree, so it doesn't block the inbound edits (or get blocked by them)
+        OctreeServer::trackTreeWaitTime(OctreeServer::SKIP_TIME);
         traverseTreeAndSendContents(node, nodeData, viewFrustumChanged, isFullScene);
-    });
+    } else {
+        // other send jobs only share the read lock, so any wait here is on the inbound edits holding the write lock
+        quint64 lockWaitStart = usecTimestampNow();
+        _myServer->getOctree()->withReadLock([&]{
+            OctreeServer::trackTreeWaitTime((float)(usecTimestampNow() - lockWaitStart));
+            traverseTreeAndSendContents(node, nodeData, viewFrustumChanged, isFullScene);
+        });
+    }
 
     // Here's where we can/should allow the server to send other data...
     // send the environment packet
@@ -385,12 +381,8 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
         _totalSpecialBytes += specialBytesSent;
     }
 
-    // calculate max number of packets that can be sent during this interval
-    int clientMaxPacketsPerInterval = std::max(1, (nodeData->getMaxQueryPacketsPerSecond() / INTERVALS_PER_SECOND));
-    int maxPacketsPerInterval = std::min(clientMaxPacketsPerInterval, _myServer->getPacketsPerClientPerInterval());
-
     // Re-send packets that were nacked by the client
-    while (nodeData->hasNextNackedPacket() && _packetsSentThisInterval < maxPacketsPerInterval) {
+    while (nodeData->hasNextNackedPacket() && _packetsSentThisInterval < _maxPacketsPerInterval) {
         const NLPacket* packet = nodeData->getNextNackedPacket();
         if (packet) {
             DependencyManager::get<NodeList>()->sendUnreliablePacket(*packet, *node);
@@ -409,9 +401,12 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
     int elapsedmsec = (end - start) / USECS_PER_MSEC;
     OctreeServer::trackLoopTime(elapsedmsec);
 
+    _sendBudget.endInterval(_packetsSentThisInterval, _trueBytesSent);
+
     // if we've sent everything, then we want to remember that we've sent all
     // the octree elements from the current view frustum
-    if (!hasSomethingToSend(nodeData)) {
+    _hasPendingData = hasSomethingToSend(nodeData);
+    if (!_hasPendingData) {
         nodeData->setViewSent(true);
 
         // If this was a full scene then make sure we really send out a stats packet at this point so that
@@ -426,14 +421,12 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
 }
 
 bool OctreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, OctreeQueryNode* nodeData, bool viewFrustumChanged, bool isFullScene) {
-    // calculate max number of packets that can be sent during this interval
-    int clientMaxPacketsPerInterval = std::max(1, (nodeData->getMaxQueryPacketsPerSecond() / INTERVALS_PER_SECOND));
-    int maxPacketsPerInterval = std::min(clientMaxPacketsPerInterval, _myServer->getPacketsPerClientPerInterval());
-
     int extraPackingAttempts = 0;
 
     // init params once outside the while loop
     EncodeBitstreamParams params(WANT_EXISTS_BITS, nodeData);
+    // every viewer gets the same bytes for an unchanged item, so let items reuse their last complete encode
+    params.useEncodedDataCache = true;
     // Our trackSend() function is implemented by the server subclass, and will be called back as new entities/data elements are sent
     params.trackSend = [this](const QUuid& dataID, quint64 dataEdited) {
         _myServer->trackSend(dataID, dataEdited, _nodeUuid);
@@ -441,7 +434,7 @@ bool OctreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, Octre
 
     bool somethingToSend = true; // assume we have something
     bool hadSomething = hasSomethingToSend(nodeData);
-    while (somethingToSend && _packetsSentThisInterval < maxPacketsPerInterval && !nodeData->isShuttingDown()) {
+    while (somethingToSend && _packetsSentThisInterval < _maxPacketsPerInterval && !nodeData->isShuttingDown()) {
         float compressAndWriteElapsedUsec = OctreeServer::SKIP_TIME;
         float packetSendingElapsedUsec = OctreeServer::SKIP_TIME;
 
@@ -505,8 +498,8 @@ bool OctreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, Octre
 
     if (somethingToSend && _myServer->wantsVerboseDebug()) {
         qCDebug(octree) << "Hit PPS Limit, packetsSentThisInterval =" << _packetsSentThisInterval
-                        << "  maxPacketsPerInterval = " << maxPacketsPerInterval
-                        << "  clientMaxPacketsPerInterval = " << clientMaxPacketsPerInterval;
+                        << "  maxPacketsPerInterval = " << _maxPacketsPerInterval
+                        << "  sendBudgetPacketsPerSecond = " << _sendBudget.getPacketsPerSecond();
     }
 
     return params.stopReason == EncodeBitstreamParams::FINISHED;
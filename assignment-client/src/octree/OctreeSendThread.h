@@ -5,7 +5,7 @@
 //  Created by Brad Hefta-Gaub on 8/21/13.
 //  Copyright 2013 High Fidelity, Inc.
 //
-//  Threaded or non-threaded object for sending octree data packets to a client
+//  Non-threaded object for sending octree data packets to a client, run by the OctreeSendWorkerPool
 //
 //  Distributed under the Apache License, Version 2.0.
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
@@ -19,14 +19,16 @@
 #include <GenericThread.h>
 #include <Node.h>
 #include <OctreePacketData.h>
+#include <OctreeSendBudget.h>
 #include "OctreeQueryNode.h"
+#include "OctreeServerConsts.h"
 
 class OctreeQueryNode;
 class OctreeServer;
 
 using AtomicUIntStat = std::atomic<uintmax_t>;
 
-/// Threaded processor for sending octree packets to a single client
+/// Processor for sending octree packets to a single client, run once per send interval by the OctreeSendWorkerPool
 class OctreeSendThread : public GenericThread {
     Q_OBJECT
 public:
@@ -38,6 +40,14 @@ public:
 
     QUuid getNodeUuid() const { return _nodeUuid; }
 
+    /// Called by the OctreeSendWorkerPool once per send interval, emits finished() and returns false once done sending
+    bool runScheduledPass();
+
+    /// Clients that still have scene data to send are scheduled ahead of idle ones with the same deadline
+    int getSendPriority() const { return _hasPendingData ? 1 : 0; }
+
+    const OctreeSendBudget& getSendBudget() const { return _sendBudget; }
+
     static AtomicUIntStat _totalBytes;
     static AtomicUIntStat _totalWastedBytes;
     static AtomicUIntStat _totalPackets;
@@ -45,13 +55,12 @@ public:
     static AtomicUIntStat _totalSpecialBytes;
     static AtomicUIntStat _totalSpecialPackets;
 
-    static AtomicUIntStat _usleepTime;
-    static AtomicUIntStat _usleepCalls;
-
 protected:
-    /// Implements generic processing behavior for this thread.
+    /// Runs a single send pass for this client, returns false when the client is gone or we're shutting down
     virtual bool process() override;
 
+    /// Subclasses that traverse an immutable snapshot of the tree don't need the tree read lock during the traversal
+    virtual bool traversesTreeSnapshot() const { return false; }
     virtual bool traverseTreeAndSendContents(SharedNodePointer node, OctreeQueryNode* nodeData,
             bool viewFrustumChanged, bool isFullScene);
     virtual bool traverseTreeAndBuildNextPacketPayload(EncodeBitstreamParams& params, const QJsonObject& jsonFilters) = 0;
@@ -64,6 +73,8 @@ protected:
 private:
     /// Called before a packetDistributor pass to allow for pre-distribution processing
     virtual void preDistributionProcessing() = 0;
+    /// Called at the start of every pass to apply changes queued from other threads since the last one
+    virtual void processPendingChanges() { }
     int handlePacketSend(SharedNodePointer node, OctreeQueryNode* nodeData, bool dontSuppressDuplicate = false);
     int packetDistributor(SharedNodePointer node, OctreeQueryNode* nodeData, bool viewFrustumChanged);
 
@@ -73,7 +84,10 @@ private:
     int _truePacketsSent { 0 }; // available for debug stats
     int _trueBytesSent { 0 }; // available for debug stats
     int _packetsSentThisInterval { 0 }; // used for bandwidth throttle condition
-    bool _isShuttingDown { false };
+    int _maxPacketsPerInterval { 1 }; // from the send budget, for the current interval
+    OctreeSendBudget _sendBudget { INTERVALS_PER_SECOND };
+    std::atomic<bool> _isShuttingDown { false };
+    std::atomic<bool> _hasPendingData { false };
 };
 
 #endif // hifi_OctreeSendThread_h
@@ -0,0 +1,165 @@
+//
+//  OctreeSendWorkerPool.cpp
+//  assignment-client/src/octree
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeSendWorkerPool.h"
+
+#include <algorithm>
+
+#include "OctreeSendThread.h"
+#include "OctreeServerConsts.h"
+
+static const int JOB_STATS_SAMPLE_COUNT = 1000;
+
+bool OctreeSendWorkerPool::ScheduledJob::operator<(const ScheduledJob& other) const {
+    if (deadline != other.deadline) {
+        return deadline < other.deadline;
+    }
+    if (priority != other.priority) {
+        return priority > other.priority;
+    }
+    return sequence < other.sequence;
+}
+
+OctreeSendWorkerPool::OctreeSendWorkerPool(int numWorkers) :
+    _averageJobLatency(JOB_STATS_SAMPLE_COUNT),
+    _averageJobRunTime(JOB_STATS_SAMPLE_COUNT)
+{
+    numWorkers = std::max(1, numWorkers);
+    _workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        _workers.emplace_back(&OctreeSendWorkerPool::workerLoop, this);
+    }
+}
+
+OctreeSendWorkerPool::~OctreeSendWorkerPool() {
+    stop();
+}
+
+void OctreeSendWorkerPool::addJob(OctreeSendThread* job) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_jobs.insert(job).second) {
+        schedule(job, Clock::now());
+        _scheduleChanged.notify_one();
+    }
+}
+
+void OctreeSendWorkerPool::removeJob(OctreeSendThread* job) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_jobs.erase(job) > 0) {
+        auto it = std::find_if(_schedule.begin(), _schedule.end(), [job](const ScheduledJob& scheduled) {
+            return scheduled.job == job;
+        });
+        if (it != _schedule.end()) {
+            _schedule.erase(it);
+        }
+    }
+
+    // the caller is about to destroy the job, so wait for any worker still running it
+    _scheduleChanged.wait(lock, [this, job] {
+        return _runningJobs.find(job) == _runningJobs.end();
+    });
+}
+
+void OctreeSendWorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_isStopping) {
+            return;
+        }
+        _isStopping = true;
+        _schedule.clear();
+        _jobs.clear();
+    }
+    _scheduleChanged.notify_all();
+
+    for (auto& worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+int OctreeSendWorkerPool::getJobCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (int)_jobs.size();
+}
+
+float OctreeSendWorkerPool::getAverageJobLatency() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _averageJobLatency.getAverage();
+}
+
+float OctreeSendWorkerPool::getAverageJobRunTime() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _averageJobRunTime.getAverage();
+}
+
+void OctreeSendWorkerPool::resetStats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _averageJobLatency.reset();
+    _averageJobRunTime.reset();
+    _totalJobsRun = 0;
+    _totalJobsOverdue = 0;
+}
+
+void OctreeSendWorkerPool::schedule(OctreeSendThread* job, Clock::time_point deadline) {
+    _schedule.insert({ deadline, job->getSendPriority(), _nextSequence++, job });
+}
+
+void OctreeSendWorkerPool::workerLoop() {
+    const std::chrono::microseconds SEND_INTERVAL { OCTREE_SEND_INTERVAL_USECS };
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_isStopping) {
+        if (_schedule.empty()) {
+            _scheduleChanged.wait(lock);
+            continue;
+        }
+
+        auto next = _schedule.begin();
+        if (next->deadline > Clock::now()) {
+            // another job may get scheduled ahead of this one while we wait, so go back to the top when woken up
+            _scheduleChanged.wait_until(lock, next->deadline);
+            continue;
+        }
+
+        ScheduledJob scheduled = *next;
+        _schedule.erase(next);
+        _runningJobs.insert(scheduled.job);
+        lock.unlock();
+
+        auto start = Clock::now();
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(start - scheduled.deadline);
+        if (latency > SEND_INTERVAL) {
+            ++_totalJobsOverdue;
+        }
+
+        bool keepRunning = scheduled.job->runScheduledPass();
+
+        auto runTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        ++_totalJobsRun;
+
+        lock.lock();
+        // the averages are shared by all the workers
+        _averageJobLatency.updateAverage((float)latency.count());
+        _averageJobRunTime.updateAverage((float)runTime.count());
+        _runningJobs.erase(scheduled.job);
+        if (_jobs.find(scheduled.job) != _jobs.end()) {
+            if (keepRunning && !_isStopping) {
+                // the next pass is due one send interval after this one started, which is
+                // right away if this pass took longer than the interval
+                schedule(scheduled.job, start + SEND_INTERVAL);
+            } else {
+                _jobs.erase(scheduled.job);
+            }
+        }
+        _scheduleChanged.notify_all();
+    }
+}
@@ -0,0 +1,90 @@
+//
+//  OctreeSendWorkerPool.h
+//  assignment-client/src/octree
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Fixed pool of worker threads that run the per-client octree send jobs
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeSendWorkerPool_h
+#define hifi_OctreeSendWorkerPool_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <QtCore/QtGlobal>
+
+#include <SimpleMovingAverage.h>
+
+class OctreeSendThread;
+
+/// Runs every client's OctreeSendThread on a fixed set of worker threads instead of one thread per client.
+/// Each job is run once per send interval; jobs are picked by earliest deadline, then by highest priority.
+class OctreeSendWorkerPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    OctreeSendWorkerPool(int numWorkers);
+    ~OctreeSendWorkerPool();
+
+    /// Schedules a job to run as soon as a worker is available, and then once every send interval
+    void addJob(OctreeSendThread* job);
+
+    /// Unschedules a job, blocking until it is no longer running on a worker
+    void removeJob(OctreeSendThread* job);
+
+    /// Stops and joins all the workers, jobs still scheduled will not run again
+    void stop();
+
+    int getWorkerCount() const { return (int)_workers.size(); }
+    int getJobCount() const;
+
+    // how late (in usecs) jobs start compared to their deadline
+    float getAverageJobLatency() const;
+    // how long (in usecs) a job takes to run once
+    float getAverageJobRunTime() const;
+    quint64 getTotalJobsRun() const { return _totalJobsRun; }
+    quint64 getTotalJobsOverdue() const { return _totalJobsOverdue; }
+
+    void resetStats();
+
+private:
+    struct ScheduledJob {
+        Clock::time_point deadline;
+        int priority;
+        quint64 sequence; // keeps FIFO order between jobs of the same deadline and priority
+        OctreeSendThread* job;
+
+        bool operator<(const ScheduledJob& other) const;
+    };
+
+    void workerLoop();
+    void schedule(OctreeSendThread* job, Clock::time_point deadline);
+
+    mutable std::mutex _mutex;
+    std::condition_variable _scheduleChanged;
+    std::set<ScheduledJob> _schedule;
+    std::unordered_set<OctreeSendThread*> _jobs;
+    std::unordered_set<OctreeSendThread*> _runningJobs;
+    quint64 _nextSequence { 0 };
+    bool _isStopping { false };
+
+    std::vector<std::thread> _workers;
+
+    SimpleMovingAverage _averageJobLatency;
+    SimpleMovingAverage _averageJobRunTime;
+    std::atomic<quint64> _totalJobsRun { 0 };
+    std::atomic<quint64> _totalJobsOverdue { 0 };
+};
+
+#endif // hifi_OctreeSendWorkerPool_h
@@ -15,6 +15,7 @@
 #include <QJsonObject>
 #include <QTimer>
 
+#include <thread>
 #include <time.h>
 
 #include <AccountManager.h>
@@ -137,6 +138,10 @@ void OctreeServer::resetSendingStats() {
     _longProcessWait = 0;
     _shortProcessWait = 0;
     _noProcessWait = 0;
+
+    if (_sendWorkerPool) {
+        _sendWorkerPool->resetStats();
+    }
 }
 
 void OctreeServer::trackEncodeTime(float time) {
@@ -260,10 +265,16 @@ OctreeServer::~OctreeServer() {
         delete[] _parsedArgV;
     }
 
-    if (_octreeInboundPacketProcessor) {
-        _octreeInboundPacketProcessor->terminating();
-        _octreeInboundPacketProcessor->terminate();
-        _octreeInboundPacketProcessor->deleteLater();
+    OctreeInboundPacketProcessor* inboundPacketProcessor;
+    {
+        std::lock_guard<std::mutex> lock(_octreeInboundPacketProcessorMutex);
+        inboundPacketProcessor = _octreeInboundPacketProcessor;
+        _octreeInboundPacketProcessor = nullptr;
+    }
+    if (inboundPacketProcessor) {
+        inboundPacketProcessor->terminating();
+        inboundPacketProcessor->terminate();
+        inboundPacketProcessor->deleteLater();
     }
 
     qDebug() << "Waiting for persist thread to come down";
@@ -439,6 +450,19 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("      writeDatagram() last second: %1 clients\r\n\r\n")
             .arg(locale.toString((uint)howManyThreadsDidCallWriteDatagram(oneSecondAgo)).rightJustified(COLUMN_WIDTH, ' '));
 
+        if (_sendWorkerPool) {
+            statsString += QString("                     Send Workers: %1 threads\r\n")
+                .arg(locale.toString(_sendWorkerPool->getWorkerCount()).rightJustified(COLUMN_WIDTH, ' '));
+            statsString += QString().sprintf("        Average send job latency:    %9.2f usecs"
+                                             "                 samples: %12llu \r\n",
+                                             (double)_sendWorkerPool->getAverageJobLatency(),
+                                             (unsigned long long)_sendWorkerPool->getTotalJobsRun());
+            statsString += QString().sprintf("       Average send job run time:    %9.2f usecs\r\n",
+                                             (double)_sendWorkerPool->getAverageJobRunTime());
+            statsString += QString("                Overdue send jobs: %1 jobs\r\n\r\n")
+                .arg(locale.toString((qulonglong)_sendWorkerPool->getTotalJobsOverdue()).rightJustified(COLUMN_WIDTH, ' '));
+        }
+
         float averageLoopTime = getAverageLoopTime();
         statsString += QString().sprintf("           Average packetLoop() time:      %7.2f msecs"
                                          "                 samples: %12d \r\n",
@@ -642,6 +666,26 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += "\r\n";
         statsString += "\r\n";
 
+        // display the send budget of each client
+        statsString += QString("<b>%1 Client Send Rates...</b>\r\n").arg(getMyServerName());
+        statsString += "                                 Client       Budget     Link Est.    Effective"
+                       "      Effective      RTT      NACKs\r\n";
+        statsString += "                                          packets/s    packets/s    packets/s"
+                       "        bytes/s     msecs  packets/s\r\n";
+        for (const auto& sendThread : _sendThreads) {
+            const OctreeSendBudget& budget = sendThread.second->getSendBudget();
+            statsString += QString().sprintf("%39s %12s %12s %12s %14s %9d %10d\r\n",
+                sendThread.first.toString().toLocal8Bit().constData(),
+                locale.toString(budget.getPacketsPerSecond()).toLocal8Bit().constData(),
+                locale.toString(budget.getLinkPacketsPerSecond()).toLocal8Bit().constData(),
+                locale.toString(budget.getEffectivePacketsPerSecond()).toLocal8Bit().constData(),
+                locale.toString(budget.getEffectiveBytesPerSecond()).toLocal8Bit().constData(),
+                budget.getRTTMsecs(), budget.getNackedPacketsPerSecond());
+        }
+
+        statsString += "\r\n";
+        statsString += "\r\n";
+
         // display inbound packet stats
         statsString += QString().sprintf("<b>%s Edit Statistics... <a href='/resetStats'>[RESET]</a></b>\r\n",
                                          getMyServerName());
@@ -655,6 +699,11 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         quint64 averageLockWaitTimePerElement = _octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
         quint64 totalElementsProcessed = _octreeInboundPacketProcessor->getTotalElementsProcessed();
         quint64 totalPacketsProcessed = _octreeInboundPacketProcessor->getTotalPacketsProcessed();
+        float editsPerSecond = _octreeInboundPacketProcessor->getEditsPerSecond();
+        quint64 totalEditBatches = _octreeInboundPacketProcessor->getTotalEditBatches();
+        quint64 averageEditsPerBatch = _octreeInboundPacketProcessor->getAverageEditsPerBatch();
+        quint64 averageLockHoldTimePerBatch = _octreeInboundPacketProcessor->getAverageLockHoldTimePerBatch();
+        quint64 maxLockHoldTimePerBatch = _octreeInboundPacketProcessor->getMaxLockHoldTimePerBatch();
 
         quint64 averageDecodeTime = _tree->getAverageDecodeTime();
         quint64 averageLookupTime = _tree->getAverageLookupTime();
@@ -691,6 +740,17 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("  Average Wait Lock Time/Element: %1 usecs\r\n")
             .arg(locale.toString((uint)averageLockWaitTimePerElement).rightJustified(COLUMN_WIDTH, ' '));
 
+        statsString += QString("            Edits Applied/Second: %1 edits/sec\r\n")
+            .arg(locale.toString(editsPerSecond, 'f', FLOAT_PRECISION).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("              Total Edit Batches: %1 batches\r\n")
+            .arg(locale.toString((uint)totalEditBatches).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("             Average Edits/Batch: %1 edits\r\n")
+            .arg(locale.toString((uint)averageEditsPerBatch).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("    Average Lock Hold Time/Batch: %1 usecs\r\n")
+            .arg(locale.toString((uint)averageLockHoldTimePerBatch).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("        Max Lock Hold Time/Batch: %1 usecs\r\n")
+            .arg(locale.toString((uint)maxLockHoldTimePerBatch).rightJustified(COLUMN_WIDTH, ' '));
+
         statsString += QString("             Average Decode Time: %1 usecs\r\n")
             .arg(locale.toString((uint)averageDecodeTime).rightJustified(COLUMN_WIDTH, ' '));
         statsString += QString("             Average Lookup Time: %1 usecs\r\n")
@@ -876,9 +936,10 @@ void OctreeServer::parsePayload() {
 OctreeServer::UniqueSendThread OctreeServer::createSendThread(const SharedNodePointer& node) {
     auto sendThread = newSendThread(node);
 
-    // we want to be notified when the thread finishes
+    // we want to be notified when the send job finishes
     connect(sendThread.get(), &GenericThread::finished, this, &OctreeServer::removeSendThread);
-    sendThread->initialize(true);
+    sendThread->initialize(false);
+    _sendWorkerPool->addJob(sendThread.get());
 
     return sendThread;
 }
@@ -886,6 +947,11 @@ OctreeServer::UniqueSendThread OctreeServer::createSendThread(const SharedNodePo
 void OctreeServer::removeSendThread() {
     // If the object has been deleted since the event was queued, sender() will return nullptr
     if (auto sendThread = qobject_cast<OctreeSendThread*>(sender())) {
+        // make sure no worker is still running it before we destruct it
+        if (_sendWorkerPool) {
+            _sendWorkerPool->removeJob(sendThread);
+        }
+
         // This deletes the unique_ptr, so sendThread is destructed after that line
         _sendThreads.erase(sendThread->getNodeUuid());
     }
@@ -902,6 +968,7 @@ void OctreeServer::handleOctreeQueryPacket(QSharedPointer<ReceivedMessage> messa
         if (it == _sendThreads.end()) {
             _sendThreads.emplace(senderNode->getUUID(), createSendThread(senderNode));
         } else if (it->second->isShuttingDown()) {
+            _sendWorkerPool->removeJob(it->second.get());
             _sendThreads.erase(it); // Remove right away and wait on thread to be
 
             _sendThreads.emplace(senderNode->getUUID(), createSendThread(senderNode));
@@ -1058,6 +1125,15 @@ void OctreeServer::readConfiguration() {
 
         qDebug() << "persistInterval=" << _persistInterval.count();
 
+        _persistCompactionInterval = OctreePersistThread::DEFAULT_COMPACTION_INTERVAL;
+        result = -1;
+        readOptionInt(QString("persistCompactionInterval"), settingsSectionObject, result);
+        if (result != -1) {
+            _persistCompactionInterval = std::chrono::milliseconds(result);
+        }
+
+        qDebug() << "persistCompactionInterval=" << _persistCompactionInterval.count();
+
         readOptionBool(QString("persistFileDownload"), settingsSectionObject, _persistFileDownload);
         qDebug() << "persistFileDownload=" << _persistFileDownload;
 
@@ -1096,6 +1172,10 @@ void OctreeServer::readConfiguration() {
     qDebug("packetsPerSecondTotalMax=%d _packetsTotalPerInterval=%d",
                     packetsPerSecondTotalMax, _packetsTotalPerInterval);
 
+    // Check to see if the user wants a specific number of workers for the send jobs
+    readOptionInt(QString("sendWorkerThreads"), settingsSectionObject, _sendWorkerThreads);
+    qDebug("sendWorkerThreads=%d", _sendWorkerThreads);
+
 
     readAdditionalConfiguration(settingsSectionObject);
 }
@@ -1185,8 +1265,8 @@ void OctreeServer::domainSettingsRequestComplete() {
         auto persistFileDirectory = QFileInfo(_persistAbsoluteFilePath).absolutePath();
 
         // now set up PersistThread
-        _persistManager = new OctreePersistThread(_tree, _persistAbsoluteFilePath, _persistInterval, _debugTimestampNow,
-                                                 _persistAsFileType);
+        _persistManager = new OctreePersistThread(_tree, _persistAbsoluteFilePath, _persistInterval,
+                                                  _persistCompactionInterval, _debugTimestampNow, _persistAsFileType);
         _persistManager->moveToThread(&_persistThread);
         connect(&_persistThread, &QThread::finished, _persistManager, &QObject::deleteLater);
         connect(&_persistThread, &QThread::started, _persistManager, &OctreePersistThread::start);
@@ -1219,9 +1299,18 @@ void OctreeServer::beginRunning() {
 
     srand((unsigned)time(0));
 
+    // all the per-client send jobs share a fixed pool of workers
+    int numSendWorkers = _sendWorkerThreads > 0 ? _sendWorkerThreads : (int)std::thread::hardware_concurrency();
+    _sendWorkerPool = std::make_unique<OctreeSendWorkerPool>(numSendWorkers);
+    qDebug() << qPrintable(_safeServerName) << "server using" << _sendWorkerPool->getWorkerCount() << "send workers";
+
     // set up our OctreeServerPacketProcessor
-    _octreeInboundPacketProcessor = new OctreeInboundPacketProcessor(this);
-    _octreeInboundPacketProcessor->initialize(true);
+    auto inboundPacketProcessor = new OctreeInboundPacketProcessor(this);
+    inboundPacketProcessor->initialize(true);
+    {
+        std::lock_guard<std::mutex> lock(_octreeInboundPacketProcessorMutex);
+        _octreeInboundPacketProcessor = inboundPacketProcessor;
+    }
 
     // Convert now to tm struct for local timezone
     tm* localtm = localtime(&_started);
@@ -1238,6 +1327,14 @@ void OctreeServer::beginRunning() {
     qDebug() << "Now running... started at: " << localBuffer << utcBuffer;
 }
 
+void OctreeServer::queueInboundPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
+    // packets that come in before the processor is started or after it is gone are dropped
+    std::lock_guard<std::mutex> lock(_octreeInboundPacketProcessorMutex);
+    if (_octreeInboundPacketProcessor) {
+        _octreeInboundPacketProcessor->queueReceivedPacket(message, senderNode);
+    }
+}
+
 void OctreeServer::nodeAdded(SharedNodePointer node) {
     // we might choose to use this notifier to track clients in a pending state
     qDebug() << qPrintable(_safeServerName) << "server added node:" << *node;
@@ -1295,8 +1392,12 @@ void OctreeServer::aboutToFinish() {
         sendThread.terminate();
     }
 
-    // Clear will destruct all the unique_ptr to OctreeSendThreads which will call the GenericThread's dtor
-    // which waits on the thread to be done before returning
+    // Stopping the pool waits on the workers to be done with their current send jobs before returning
+    if (_sendWorkerPool) {
+        _sendWorkerPool->stop();
+    }
+
+    // Clear will destruct all the unique_ptr to OctreeSendThreads, none of them can be running anymore
     _sendThreads.clear(); // Cleans up all the send threads.
 
     if (_persistManager) {
@@ -1413,6 +1514,13 @@ void OctreeServer::sendStatsPacket() {
     threadsStats["2. packetDistributor"] = (double)howManyThreadsDidPacketDistributor(oneSecondAgo);
     threadsStats["3. handlePacektSend"] = (double)howManyThreadsDidHandlePacketSend(oneSecondAgo);
     threadsStats["4. writeDatagram"] = (double)howManyThreadsDidCallWriteDatagram(oneSecondAgo);
+    if (_sendWorkerPool) {
+        threadsStats["5. sendWorkers"] = _sendWorkerPool->getWorkerCount();
+        threadsStats["6. sendJobs"] = _sendWorkerPool->getJobCount();
+        threadsStats["7. avgSendJobLatencyUsecs"] = (double)_sendWorkerPool->getAverageJobLatency();
+        threadsStats["8. avgSendJobRunTimeUsecs"] = (double)_sendWorkerPool->getAverageJobRunTime();
+        threadsStats["9. overdueSendJobs"] = (double)_sendWorkerPool->getTotalJobsOverdue();
+    }
 
     QJsonObject statsArray1;
     statsArray1["1. configuration"] = getConfiguration();
@@ -1437,6 +1545,20 @@ void OctreeServer::sendStatsPacket() {
     dataObject1["5. totalBytesBitMasks"] = (double)OctreePacketData::getTotalBytesOfBitMasks();
     dataObject1["6. totalBytesBitMasks"] = (double)OctreePacketData::getTotalBytesOfColor();
 
+    QJsonObject clientSendRates;
+    for (const auto& sendThread : _sendThreads) {
+        const OctreeSendBudget& budget = sendThread.second->getSendBudget();
+        QJsonObject clientSendRate;
+        clientSendRate["1. budgetPPS"] = budget.getPacketsPerSecond();
+        clientSendRate["2. linkEstimatePPS"] = budget.getLinkPacketsPerSecond();
+        clientSendRate["3. effectivePPS"] = budget.getEffectivePacketsPerSecond();
+        clientSendRate["4. effectiveBytesPerSecond"] = budget.getEffectiveBytesPerSecond();
+        clientSendRate["5. rttMsecs"] = budget.getRTTMsecs();
+        clientSendRate["6. nackedPPS"] = budget.getNackedPacketsPerSecond();
+        clientSendRates[uuidStringWithoutCurlyBraces(sendThread.first)] = clientSendRate;
+    }
+    dataObject1["7. clientSendRates"] = clientSendRates;
+
     QJsonObject timingArray1;
     timingArray1["1. avgLoopTime"] = getAverageLoopTime();
     timingArray1["2. avgInsideTime"] = getAverageInsideTime();
@@ -1445,6 +1567,7 @@ void OctreeServer::sendStatsPacket() {
     timingArray1["5. avgCompressAndWriteTime"] = getAverageCompressAndWriteTime();
     timingArray1["6. avgSendTime"] = getAveragePacketSendingTime();
     timingArray1["7. nodeWaitTime"] = getAverageNodeWaitTime();
+    timingArray1["8. avgTreeLockWaitTime"] = getAverageTreeWaitTime();
 
     QJsonObject statsObject2;
     statsObject2["data"] = dataObject1;
@@ -1458,12 +1581,16 @@ void OctreeServer::sendStatsPacket() {
         dataArray2["1. packetQueue"] = (double)_octreeInboundPacketProcessor->packetsToProcessCount();
         dataArray2["2. totalPackets"] = (double)_octreeInboundPacketProcessor->getTotalPacketsProcessed();
         dataArray2["3. totalElements"] = (double)_octreeInboundPacketProcessor->getTotalElementsProcessed();
+        dataArray2["4. editsPerSecond"] = (double)_octreeInboundPacketProcessor->getEditsPerSecond();
+        dataArray2["5. editBatches"] = (double)_octreeInboundPacketProcessor->getTotalEditBatches();
 
         timingArray2["1. avgTransitTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageTransitTimePerPacket();
         timingArray2["2. avgProcessTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageProcessTimePerPacket();
         timingArray2["3. avgLockWaitTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerPacket();
         timingArray2["4. avgProcessTimePerElement"] = (double)_octreeInboundPacketProcessor->getAverageProcessTimePerElement();
         timingArray2["5. avgLockWaitTimePerElement"] = (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
+        timingArray2["6. avgLockHoldTimePerBatch"] = (double)_octreeInboundPacketProcessor->getAverageLockHoldTimePerBatch();
+        timingArray2["7. maxLockHoldTimePerBatch"] = (double)_octreeInboundPacketProcessor->getMaxLockHoldTimePerBatch();
     }
 
     QJsonObject statsObject3;
@@ -13,6 +13,7 @@
 #define hifi_OctreeServer_h
 
 #include <memory>
+#include <mutex>
 
 #include <QStringList>
 #include <QDateTime>
@@ -24,6 +25,7 @@
 
 #include "OctreePersistThread.h"
 #include "OctreeSendThread.h"
+#include "OctreeSendWorkerPool.h"
 #include "OctreeServerConsts.h"
 #include "OctreeInboundPacketProcessor.h"
 
@@ -163,6 +165,9 @@ protected:
     QString getStatusLink();
 
     void beginRunning();
+
+    // Hands an edit packet to the inbound packet processor, for listeners that run on the node list's thread
+    void queueInboundPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
     
     UniqueSendThread createSendThread(const SharedNodePointer& node);
     virtual UniqueSendThread newSendThread(const SharedNodePointer& node) = 0;
@@ -190,10 +195,13 @@ protected:
     bool _debugTimestampNow;
     bool _verboseDebug;
     OctreeInboundPacketProcessor* _octreeInboundPacketProcessor;
+    // guards setting and resetting _octreeInboundPacketProcessor against queueInboundPacket
+    std::mutex _octreeInboundPacketProcessorMutex;
     OctreePersistThread* _persistManager;
     QThread _persistThread;
 
     std::chrono::milliseconds _persistInterval;
+    std::chrono::milliseconds _persistCompactionInterval;
     bool _persistFileDownload;
     int _maxBackupVersions;
 
@@ -202,6 +210,8 @@ protected:
     QString _safeServerName;
     
     SendThreads _sendThreads;
+    std::unique_ptr<OctreeSendWorkerPool> _sendWorkerPool;
+    int _sendWorkerThreads { 0 }; // 0 means one worker per hardware thread
 
     static int _clientCount;
     static SimpleMovingAverage _averageLoopTime;
@@ -580,7 +580,7 @@ void EntityScriptServer::sendStatsPacket() {
         QJsonObject clientStats;
         const QString uuidString(uuidStringWithoutCurlyBraces(node->getUUID()));
         clientStats["node_type"] = NodeType::getNodeTypeName(node->getType());
-        auto& nodeStats = node->getConnectionStats();
+        auto nodeStats = node->getConnectionStats();
 
         static const QString NODE_OUTBOUND_KBPS_STAT_KEY("outbound_kbit/s");
         static const QString NODE_INBOUND_KBPS_STAT_KEY("inbound_kbit/s");
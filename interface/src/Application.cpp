@@ -131,6 +131,7 @@
 #include <render/EngineStats.h>
 #include <SecondaryCamera.h>
 #include <ResourceCache.h>
+#include <ResourceProcessingPool.h>
 #include <ResourceRequest.h>
 #include <SandboxUtils.h>
 #include <SceneScriptingInterface.h>
@@ -236,6 +237,7 @@
 #include <raypick/PickScriptingInterface.h>
 #include <raypick/PointerScriptingInterface.h>
 #include <raypick/RayPick.h>
+#include <raypick/ParabolaPick.h>
 #include <raypick/MouseTransformNode.h>
 
 #include <FadeEffect.h>
@@ -1167,6 +1169,7 @@ Application::Application(int& argc, char** argv, QElapsedTimer& startupTimer, bo
     auto nodeList = DependencyManager::get<NodeList>();
     nodeList->startThread();
     nodeList->setFlagTimeForConnectionStep(true);
+    nodeList->setPacketCoalescingEnabled(true);
 
     // move the AddressManager to the NodeList thread so that domain resets due to domain changes always occur
     // before we tell MyAvatar to go to a new location in the new domain
@@ -2403,6 +2406,8 @@ Application::Application(int& argc, char** argv, QElapsedTimer& startupTimer, bo
     connect(&_myCamera, &Camera::modeUpdated, this, &Application::cameraModeChanged);
 
     DependencyManager::get<PickManager>()->setShouldPickHUDOperator([]() { return DependencyManager::get<HMDScriptingInterface>()->isHMDMode(); });
+    DependencyManager::get<PickManager>()->setRayEntityIntersectionsOperator(&RayPick::getEntityIntersections);
+    DependencyManager::get<PickManager>()->setParabolaEntityIntersectionsOperator(&ParabolaPick::getEntityIntersections);
     DependencyManager::get<PickManager>()->setCalculatePos2DFromHUDOperator([this](const glm::vec3& intersection) {
         const glm::vec2 MARGIN(25.0f);
         glm::vec2 maxPos = _controllerScriptingInterface->getViewportDimensions() - MARGIN;
@@ -2784,6 +2789,7 @@ void Application::cleanupBeforeQuit() {
     getEntities()->shutdown(); // tell the entities system we're shutting down, so it will stop running scripts
 
     // Clear any queued processing (I/O, FBX/OBJ/Texture parsing)
+    ResourceProcessingPool::getInstance().clear();
     QThreadPool::globalInstance()->clear();
     QThreadPool::globalInstance()->waitForDone();
 
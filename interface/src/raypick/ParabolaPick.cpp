@@ -55,32 +55,75 @@ PickParabola ParabolaPick::getMathematicalPick() const {
     return PickParabola(position, velocity, acceleration);
 }
 
-PickResultPointer ParabolaPick::getEntityIntersection(const PickParabola& pick) {
-    if (glm::length2(pick.acceleration) > EPSILON && glm::length2(pick.velocity) > EPSILON) {
-        PickFilter searchFilter = getFilter();
-        if (DependencyManager::get<PickManager>()->getForceCoarsePicking()) {
-            searchFilter.setFlag(PickFilter::COARSE, true);
-            searchFilter.setFlag(PickFilter::PRECISE, false);
+static bool isValidParabola(const PickParabola& pick) {
+    return glm::length2(pick.acceleration) > EPSILON && glm::length2(pick.velocity) > EPSILON;
+}
+
+static PickFilter getEntitySearchFilter(PickFilter searchFilter) {
+    if (DependencyManager::get<PickManager>()->getForceCoarsePicking()) {
+        searchFilter.setFlag(PickFilter::COARSE, true);
+        searchFilter.setFlag(PickFilter::PRECISE, false);
+    }
+    return searchFilter;
+}
+
+static PickResultPointer toEntityPickResult(const ParabolaToEntityIntersectionResult& entityRes, const PickParabola& pick,
+                                            const PickFilter& filter) {
+    if (entityRes.intersects) {
+        IntersectionType type = IntersectionType::ENTITY;
+        if (filter.doesPickLocalEntities()) {
+            EntityPropertyFlags desiredProperties;
+            desiredProperties += PROP_ENTITY_HOST_TYPE;
+            if (DependencyManager::get<EntityScriptingInterface>()->getEntityProperties(entityRes.entityID, desiredProperties).getEntityHostType() == entity::HostType::LOCAL) {
+                type = IntersectionType::LOCAL_ENTITY;
+            }
         }
+        return std::make_shared<ParabolaPickResult>(type, entityRes.entityID, entityRes.distance, entityRes.parabolicDistance, entityRes.intersection, pick, entityRes.surfaceNormal, entityRes.extraInfo);
+    }
+    return std::make_shared<ParabolaPickResult>(pick.toVariantMap());
+}
 
+PickResultPointer ParabolaPick::getEntityIntersection(const PickParabola& pick) {
+    if (isValidParabola(pick)) {
         ParabolaToEntityIntersectionResult entityRes =
-            DependencyManager::get<EntityScriptingInterface>()->evalParabolaIntersectionVector(pick, searchFilter,
+            DependencyManager::get<EntityScriptingInterface>()->evalParabolaIntersectionVector(pick, getEntitySearchFilter(getFilter()),
                 getIncludeItemsAs<EntityItemID>(), getIgnoreItemsAs<EntityItemID>());
-        if (entityRes.intersects) {
-            IntersectionType type = IntersectionType::ENTITY;
-            if (getFilter().doesPickLocalEntities()) {
-                EntityPropertyFlags desiredProperties;
-                desiredProperties += PROP_ENTITY_HOST_TYPE;
-                if (DependencyManager::get<EntityScriptingInterface>()->getEntityProperties(entityRes.entityID, desiredProperties).getEntityHostType() == entity::HostType::LOCAL) {
-                    type = IntersectionType::LOCAL_ENTITY;
-                }
-            }
-            return std::make_shared<ParabolaPickResult>(type, entityRes.entityID, entityRes.distance, entityRes.parabolicDistance, entityRes.intersection, pick, entityRes.surfaceNormal, entityRes.extraInfo);
-        }
+        return toEntityPickResult(entityRes, pick, getFilter());
     }
     return std::make_shared<ParabolaPickResult>(pick.toVariantMap());
 }
 
+std::vector<PickResultPointer> ParabolaPick::getEntityIntersections(const std::vector<std::shared_ptr<Pick<PickParabola>>>& picks,
+                                                                    const std::vector<PickParabola>& mathPicks) {
+    QVector<EntityParabolaQuery> queries;
+    std::vector<int> queryIndices(picks.size(), -1);
+    for (size_t i = 0; i < picks.size(); ++i) {
+        if (!isValidParabola(mathPicks[i])) {
+            continue;
+        }
+        EntityParabolaQuery query;
+        query.parabola = mathPicks[i];
+        query.searchFilter = getEntitySearchFilter(picks[i]->getFilter());
+        query.entityIdsToInclude = picks[i]->getIncludeItemsAs<EntityItemID>();
+        query.entityIdsToDiscard = picks[i]->getIgnoreItemsAs<EntityItemID>();
+        queryIndices[i] = queries.size();
+        queries.push_back(query);
+    }
+
+    auto entityResults = DependencyManager::get<EntityScriptingInterface>()->evalParabolaIntersectionVectors(queries);
+
+    std::vector<PickResultPointer> results;
+    results.reserve(picks.size());
+    for (size_t i = 0; i < picks.size(); ++i) {
+        if (queryIndices[i] < 0) {
+            results.push_back(std::make_shared<ParabolaPickResult>(mathPicks[i].toVariantMap()));
+        } else {
+            results.push_back(toEntityPickResult(entityResults[queryIndices[i]], mathPicks[i], picks[i]->getFilter()));
+        }
+    }
+    return results;
+}
+
 PickResultPointer ParabolaPick::getAvatarIntersection(const PickParabola& pick) {
     if (glm::length2(pick.acceleration) > EPSILON && glm::length2(pick.velocity) > EPSILON) {
         ParabolaToAvatarIntersectionResult avatarRes = DependencyManager::get<AvatarManager>()->findParabolaIntersectionVector(pick, getIncludeItemsAs<EntityItemID>(), getIgnoreItemsAs<EntityItemID>());
@@ -98,6 +98,9 @@ public:
 
     PickResultPointer getDefaultResult(const QVariantMap& pickVariant) const override { return std::make_shared<ParabolaPickResult>(pickVariant); }
     PickResultPointer getEntityIntersection(const PickParabola& pick) override;
+    // the entity intersections of many parabola picks at once, see PickManager::setParabolaEntityIntersectionsOperator
+    static std::vector<PickResultPointer> getEntityIntersections(const std::vector<std::shared_ptr<Pick<PickParabola>>>& picks,
+                                                                 const std::vector<PickParabola>& mathPicks);
     PickResultPointer getAvatarIntersection(const PickParabola& pick) override;
     PickResultPointer getHUDIntersection(const PickParabola& pick) override;
     Transform getResultTransform() const override;
@@ -25,19 +25,19 @@ PickRay RayPick::getMathematicalPick() const {
     return PickRay(origin, direction);
 }
 
-PickResultPointer RayPick::getEntityIntersection(const PickRay& pick) {
-    PickFilter searchFilter = getFilter();
+static PickFilter getEntitySearchFilter(PickFilter searchFilter) {
     if (DependencyManager::get<PickManager>()->getForceCoarsePicking()) {
         searchFilter.setFlag(PickFilter::COARSE, true);
         searchFilter.setFlag(PickFilter::PRECISE, false);
     }
+    return searchFilter;
+}
 
-    RayToEntityIntersectionResult entityRes =
-        DependencyManager::get<EntityScriptingInterface>()->evalRayIntersectionVector(pick, searchFilter,
-            getIncludeItemsAs<EntityItemID>(), getIgnoreItemsAs<EntityItemID>());
+static PickResultPointer toEntityPickResult(const RayToEntityIntersectionResult& entityRes, const PickRay& pick,
+                                            const PickFilter& filter) {
     if (entityRes.intersects) {
         IntersectionType type = IntersectionType::ENTITY;
-        if (getFilter().doesPickLocalEntities()) {
+        if (filter.doesPickLocalEntities()) {
             EntityPropertyFlags desiredProperties;
             desiredProperties += PROP_ENTITY_HOST_TYPE;
             if (DependencyManager::get<EntityScriptingInterface>()->getEntityProperties(entityRes.entityID, desiredProperties).getEntityHostType() == entity::HostType::LOCAL) {
@@ -50,6 +50,36 @@ PickResultPointer RayPick::getEntityIntersection(const PickRay& pick) {
     }
 }
 
+PickResultPointer RayPick::getEntityIntersection(const PickRay& pick) {
+    RayToEntityIntersectionResult entityRes =
+        DependencyManager::get<EntityScriptingInterface>()->evalRayIntersectionVector(pick, getEntitySearchFilter(getFilter()),
+            getIncludeItemsAs<EntityItemID>(), getIgnoreItemsAs<EntityItemID>());
+    return toEntityPickResult(entityRes, pick, getFilter());
+}
+
+std::vector<PickResultPointer> RayPick::getEntityIntersections(const std::vector<std::shared_ptr<Pick<PickRay>>>& picks,
+                                                               const std::vector<PickRay>& mathPicks) {
+    QVector<EntityRayQuery> queries;
+    queries.reserve((int)picks.size());
+    for (size_t i = 0; i < picks.size(); ++i) {
+        EntityRayQuery query;
+        query.ray = mathPicks[i];
+        query.searchFilter = getEntitySearchFilter(picks[i]->getFilter());
+        query.entityIdsToInclude = picks[i]->getIncludeItemsAs<EntityItemID>();
+        query.entityIdsToDiscard = picks[i]->getIgnoreItemsAs<EntityItemID>();
+        queries.push_back(query);
+    }
+
+    auto entityResults = DependencyManager::get<EntityScriptingInterface>()->evalRayIntersectionVectors(queries);
+
+    std::vector<PickResultPointer> results;
+    results.reserve(picks.size());
+    for (size_t i = 0; i < picks.size(); ++i) {
+        results.push_back(toEntityPickResult(entityResults[(int)i], mathPicks[i], picks[i]->getFilter()));
+    }
+    return results;
+}
+
 PickResultPointer RayPick::getAvatarIntersection(const PickRay& pick) {
     bool precisionPicking = !(getFilter().isCoarse() || DependencyManager::get<PickManager>()->getForceCoarsePicking());
     RayToAvatarIntersectionResult avatarRes = DependencyManager::get<AvatarManager>()->findRayIntersectionVector(pick, getIncludeItemsAs<EntityItemID>(), getIgnoreItemsAs<EntityItemID>(), precisionPicking);
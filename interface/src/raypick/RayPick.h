@@ -94,6 +94,9 @@ public:
 
     PickResultPointer getDefaultResult(const QVariantMap& pickVariant) const override { return std::make_shared<RayPickResult>(pickVariant); }
     PickResultPointer getEntityIntersection(const PickRay& pick) override;
+    // the entity intersections of many ray picks at once, see PickManager::setRayEntityIntersectionsOperator
+    static std::vector<PickResultPointer> getEntityIntersections(const std::vector<std::shared_ptr<Pick<PickRay>>>& picks,
+                                                                 const std::vector<PickRay>& mathPicks);
     PickResultPointer getAvatarIntersection(const PickRay& pick) override;
     PickResultPointer getHUDIntersection(const PickRay& pick) override;
     Transform getResultTransform() const override;
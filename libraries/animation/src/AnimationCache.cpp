@@ -12,8 +12,8 @@
 #include "AnimationCache.h"
 
 #include <QRunnable>
-#include <QThreadPool>
 
+#include <ResourceProcessingPool.h>
 #include <shared/QtHelpers.h>
 #include <Trace.h>
 #include <StatTracker.h>
@@ -24,6 +24,9 @@
 
 int animationPointerMetaTypeId = qRegisterMetaType<AnimationPointer>();
 
+// Parsing an animation holds a few times the size of its file, FBX files deflate their arrays
+static const int ANIMATION_PROCESSING_SIZE_FACTOR = 5;
+
 AnimationCache::AnimationCache(QObject* parent) :
     ResourceCache(parent)
 {
@@ -132,7 +135,17 @@ void Animation::downloadFinished(const QByteArray& data) {
     AnimationReader* animationReader = new AnimationReader(_url, data);
     connect(animationReader, SIGNAL(onSuccess(HFMModel::Pointer)), SLOT(animationParseSuccess(HFMModel::Pointer)));
     connect(animationReader, SIGNAL(onError(int, QString)), SLOT(animationParseError(int, QString)));
-    QThreadPool::globalInstance()->start(animationReader);
+    ResourceProcessingPool::getInstance().start(getType(), animationReader,
+        ANIMATION_PROCESSING_SIZE_FACTOR * (qint64)data.size());
+}
+
+bool Animation::adoptContent(const Resource& original) {
+    auto& originalAnimation = static_cast<const Animation&>(original);
+    if (!originalAnimation._hfmModel) {
+        return false;
+    }
+    animationParseSuccess(originalAnimation._hfmModel);
+    return true;
 }
 
 void Animation::animationParseSuccess(HFMModel::Pointer hfmModel) {
@@ -68,6 +68,8 @@ public:
     
 protected:
     virtual void downloadFinished(const QByteArray& data) override;
+    bool canShareContent() const override { return true; }
+    bool adoptContent(const Resource& original) override;
 
 protected slots:
     void animationParseSuccess(HFMModel::Pointer hfmModel);
@@ -16,7 +16,6 @@
 #include <glm/glm.hpp>
 
 #include <QRunnable>
-#include <QThreadPool>
 #include <QDataStream>
 #include <QtCore/QDebug>
 #include <QtNetwork/QNetworkRequest>
@@ -25,6 +24,8 @@
 
 #include <LimitedNodeList.h>
 #include <NetworkAccessManager.h>
+#include <NumericalConstants.h>
+#include <ResourceProcessingPool.h>
 #include <SharedUtil.h>
 
 #include "AudioRingBuffer.h"
@@ -79,7 +80,17 @@ void Sound::downloadFinished(const QByteArray& data) {
     auto soundProcessor = new SoundProcessor(_self, data);
     connect(soundProcessor, &SoundProcessor::onSuccess, this, &Sound::soundProcessSuccess);
     connect(soundProcessor, &SoundProcessor::onError, this, &Sound::soundProcessError);
-    QThreadPool::globalInstance()->start(soundProcessor);
+    ResourceProcessingPool::getInstance().start(getType(), soundProcessor,
+        SoundProcessor::estimateDecodedSize(_url.fileName().toLower(), data));
+}
+
+bool Sound::adoptContent(const Resource& original) {
+    auto& originalSound = static_cast<const Sound&>(original);
+    if (!originalSound._audioData) {
+        return false;
+    }
+    soundProcessSuccess(originalSound._audioData);
+    return true;
 }
 
 void Sound::soundProcessSuccess(AudioDataPointer audioData) {
@@ -98,6 +109,53 @@ void Sound::soundProcessError(int error, QString str) {
 }
 
 
+static const QString WAV_EXTENSION = ".wav";
+static const QString MP3_EXTENSION = ".mp3";
+static const QString RAW_EXTENSION = ".raw";
+static const QString STEREO_RAW_EXTENSION = ".stereo.raw";
+
+// the size of the samples of an MP3 file, from the bit rate and sample rate of its first frame
+static qint64 estimateDecodedMP3Size(const QByteArray& data) {
+    using namespace flump3dec;
+
+    qint64 numBytes = data.size();
+    Bit_stream_struc* bitstream = bs_new();
+    if (bitstream == nullptr) {
+        return numBytes;
+    }
+    mp3tl* decoder = mp3tl_new(bitstream, MP3TL_MODE_16BIT);
+    if (decoder == nullptr) {
+        bs_free(bitstream);
+        return numBytes;
+    }
+
+    bs_set_data(bitstream, (uint8_t*)data.data(), data.size());
+    Mp3TlRetcode result = mp3tl_skip_id3(decoder);
+    if (!(result == MP3TL_ERR_NO_SYNC || result == MP3TL_ERR_NEED_DATA)) {
+        mp3tl_sync(decoder);
+        const fr_header* header = nullptr;
+        if (mp3tl_decode_header(decoder, &header) == MP3TL_ERR_OK && header->bitrate > 0) {
+            // variable bit rate files come out close enough
+            const qint64 BITS_PER_SECOND_PER_KBPS = 1000;
+            qint64 numBits = (qint64)data.size() * BITS_IN_BYTE;
+            qint64 numSamples = numBits * header->sample_rate / (header->bitrate * BITS_PER_SECOND_PER_KBPS);
+            numBytes = numSamples * header->channels * sizeof(int16_t);
+        }
+    }
+
+    mp3tl_free(decoder);
+    bs_free(bitstream);
+    return numBytes;
+}
+
+qint64 SoundProcessor::estimateDecodedSize(const QString& fileName, const QByteArray& data) {
+    // WAV and RAW files hold 16 bit samples already
+    qint64 numSampleBytes = fileName.endsWith(MP3_EXTENSION) ? estimateDecodedMP3Size(data) : data.size();
+    // the file, its samples, their resampled copy and the audio data made of them
+    const int NUM_SAMPLE_COPIES = 3;
+    return data.size() + NUM_SAMPLE_COPIES * numSampleBytes;
+}
+
 SoundProcessor::SoundProcessor(QWeakPointer<Resource> sound, QByteArray data) :
     _sound(sound),
     _data(data)
@@ -115,10 +173,6 @@ void SoundProcessor::run() {
     QString fileName = url.fileName().toLower();
     qCDebug(audio) << "Processing sound file" << fileName;
 
-    static const QString WAV_EXTENSION = ".wav";
-    static const QString MP3_EXTENSION = ".mp3";
-    static const QString RAW_EXTENSION = ".raw";
-    static const QString STEREO_RAW_EXTENSION = ".stereo.raw";
     QString fileType;
 
     QByteArray outputAudioByteArray;
@@ -63,6 +63,8 @@ public:
     Sound(const QUrl& url, bool isStereo = false, bool isAmbisonic = false);
     Sound(const Sound& other) : Resource(other), _audioData(other._audioData), _numChannels(other._numChannels) {}
 
+    QString getType() const override { return "Sound"; }
+
     bool isReady() const { return (bool)_audioData; }
 
     bool isStereo() const { return _audioData ? _audioData->isStereo() : false; }
@@ -82,6 +84,8 @@ protected slots:
     
 private:
     virtual void downloadFinished(const QByteArray& data) override;
+    bool canShareContent() const override { return true; }
+    bool adoptContent(const Resource& original) override;
 
     AudioDataPointer _audioData;
 
@@ -100,6 +104,9 @@ public:
 
     SoundProcessor(QWeakPointer<Resource> sound, QByteArray data);
 
+    // Memory processing the sound file holds, mostly decoded samples
+    static qint64 estimateDecodedSize(const QString& fileName, const QByteArray& data);
+
     virtual void run() override;
 
     QByteArray downSample(const QByteArray& rawAudioByteArray,
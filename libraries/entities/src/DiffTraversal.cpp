@@ -13,15 +13,20 @@
 
 #include <OctreeUtils.h>
 
+#include "EntityInterestSets.h"
 #include "EntityPriorityQueue.h"
 
-DiffTraversal::Waypoint::Waypoint(EntityTreeElementPointer& element) : _nextIndex(0) {
-    assert(element);
-    _weakElement = element;
+DiffTraversal::Waypoint::Waypoint(int32_t elementIndex) : _elementIndex(elementIndex), _nextIndex(0) {
+    assert(elementIndex != EntityTreeSnapshot::INVALID_INDEX);
+}
+
+static void setVisibleElement(DiffTraversal::VisibleElement& next, const EntityTreeSnapshot& snapshot, int32_t index) {
+    next.index = index;
+    next.element = (index != EntityTreeSnapshot::INVALID_INDEX) ? &snapshot.getElement(index) : nullptr;
 }
 
 void DiffTraversal::Waypoint::getNextVisibleElementFirstTime(DiffTraversal::VisibleElement& next,
-        const DiffTraversal::View& view) {
+        const EntityTreeSnapshot& snapshot, const DiffTraversal::View& view) {
     // NOTE: no need to set next.intersection in the "FirstTime" context
     if (_nextIndex == -1) {
         // root case is special:
@@ -29,76 +34,70 @@ void DiffTraversal::Waypoint::getNextVisibleElementFirstTime(DiffTraversal::Visi
         // we never bother checking for LOD culling, and
         // we can skip it if the content hasn't changed
         ++_nextIndex;
-        next.element = _weakElement.lock();
+        setVisibleElement(next, snapshot, _elementIndex);
         return;
     } else if (_nextIndex < NUMBER_OF_CHILDREN) {
-        EntityTreeElementPointer element = _weakElement.lock();
-        if (element) {
-            while (_nextIndex < NUMBER_OF_CHILDREN) {
-                EntityTreeElementPointer nextElement = element->getChildAtIndex(_nextIndex);
-                ++_nextIndex;
-                if (nextElement && view.shouldTraverseElement(*nextElement)) {
-                    next.element = nextElement;
-                    return;
-                }
+        const auto& element = snapshot.getElement(_elementIndex);
+        while (_nextIndex < NUMBER_OF_CHILDREN) {
+            int32_t nextElementIndex = element.children[_nextIndex];
+            ++_nextIndex;
+            if (nextElementIndex != EntityTreeSnapshot::INVALID_INDEX &&
+                view.shouldTraverseElement(snapshot, nextElementIndex)) {
+                setVisibleElement(next, snapshot, nextElementIndex);
+                return;
             }
         }
     }
-    next.element.reset();
+    setVisibleElement(next, snapshot, EntityTreeSnapshot::INVALID_INDEX);
 }
 
-void DiffTraversal::Waypoint::getNextVisibleElementRepeat(
-        DiffTraversal::VisibleElement& next, const DiffTraversal::View& view, uint64_t lastTime) {
+void DiffTraversal::Waypoint::getNextVisibleElementRepeat(DiffTraversal::VisibleElement& next,
+        const EntityTreeSnapshot& snapshot, const DiffTraversal::View& view, uint64_t lastTime) {
     if (_nextIndex == -1) {
         // root case is special
         ++_nextIndex;
-        EntityTreeElementPointer element = _weakElement.lock();
-        if (element->getLastChangedContent() > lastTime) {
-            next.element = element;
+        if (snapshot.getElement(_elementIndex).lastChangedContent > lastTime) {
+            setVisibleElement(next, snapshot, _elementIndex);
             return;
         }
     }
     if (_nextIndex < NUMBER_OF_CHILDREN) {
-        EntityTreeElementPointer element = _weakElement.lock();
-        if (element) {
-            while (_nextIndex < NUMBER_OF_CHILDREN) {
-                EntityTreeElementPointer nextElement = element->getChildAtIndex(_nextIndex);
-                ++_nextIndex;
-                if (nextElement &&
-                    nextElement->getLastChanged() > lastTime &&
-                    view.shouldTraverseElement(*nextElement)) {
-
-                    next.element = nextElement;
+        const auto& element = snapshot.getElement(_elementIndex);
+        while (_nextIndex < NUMBER_OF_CHILDREN) {
+            int32_t nextElementIndex = element.children[_nextIndex];
+            ++_nextIndex;
+            if (nextElementIndex != EntityTreeSnapshot::INVALID_INDEX) {
+                const auto& nextElement = snapshot.getElement(nextElementIndex);
+                if (nextElement.lastChanged > lastTime && view.shouldTraverseElement(snapshot, nextElementIndex)) {
+                    setVisibleElement(next, snapshot, nextElementIndex);
                     return;
                 }
             }
         }
     }
-    next.element.reset();
+    setVisibleElement(next, snapshot, EntityTreeSnapshot::INVALID_INDEX);
 }
 
 void DiffTraversal::Waypoint::getNextVisibleElementDifferential(DiffTraversal::VisibleElement& next,
-        const DiffTraversal::View& view, const DiffTraversal::View& lastView) {
+        const EntityTreeSnapshot& snapshot, const DiffTraversal::View& view, const DiffTraversal::View& lastView) {
     if (_nextIndex == -1) {
         // root case is special
         ++_nextIndex;
-        EntityTreeElementPointer element = _weakElement.lock();
-        next.element = element;
+        setVisibleElement(next, snapshot, _elementIndex);
         return;
     } else if (_nextIndex < NUMBER_OF_CHILDREN) {
-        EntityTreeElementPointer element = _weakElement.lock();
-        if (element) {
-            while (_nextIndex < NUMBER_OF_CHILDREN) {
-                EntityTreeElementPointer nextElement = element->getChildAtIndex(_nextIndex);
-                ++_nextIndex;
-                if (nextElement && view.shouldTraverseElement(*nextElement)) {
-                    next.element = nextElement;
-                    return;
-                }
+        const auto& element = snapshot.getElement(_elementIndex);
+        while (_nextIndex < NUMBER_OF_CHILDREN) {
+            int32_t nextElementIndex = element.children[_nextIndex];
+            ++_nextIndex;
+            if (nextElementIndex != EntityTreeSnapshot::INVALID_INDEX &&
+                view.shouldTraverseElement(snapshot, nextElementIndex)) {
+                setVisibleElement(next, snapshot, nextElementIndex);
+                return;
             }
         }
     }
-    next.element.reset();
+    setVisibleElement(next, snapshot, EntityTreeSnapshot::INVALID_INDEX);
 }
 
 bool DiffTraversal::View::usesViewFrustums() const {
@@ -138,7 +137,30 @@ float DiffTraversal::View::computePriority(const EntityItemPointer& entity) cons
 
     auto center = cube.calcCenter(); // center of bounding sphere
     auto radius = 0.5f * SQRT_THREE * cube.getScale(); // radius of bounding sphere
+    if (interestSets) {
+        return interestSets->computePriority(center, radius);
+    }
+    return computePriority(center, radius);
+}
+
+float DiffTraversal::View::computePriority(const EntityTreeSnapshot& snapshot,
+                                           const EntityTreeSnapshot::Entity& entity) const {
+    if (!usesViewFrustums()) {
+        return PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
+    }
+
+    if (interestSets && interestSets->isFor(snapshot)) {
+        return interestSets->computePriority(snapshot, entity);
+    }
 
+    if (!entity.hasBounds) {
+        return PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
+    }
+
+    return computePriority(entity.center, entity.radius);
+}
+
+float DiffTraversal::View::computePriority(const glm::vec3& center, float radius) const {
     auto priority = PrioritizedEntity::DO_NOT_SEND;
 
     for (const auto& frustum : viewFrustums) {
@@ -162,16 +184,20 @@ float DiffTraversal::View::computePriority(const EntityItemPointer& entity) cons
     return priority;
 }
 
-bool DiffTraversal::View::shouldTraverseElement(const EntityTreeElement& element) const {
+bool DiffTraversal::View::shouldTraverseElement(const EntityTreeSnapshot& snapshot, int32_t elementIndex) const {
+    if (interestSets && interestSets->isFor(snapshot)) {
+        return interestSets->shouldTraverseElement(snapshot, elementIndex);
+    }
+    return shouldTraverseElement(snapshot.getElement(elementIndex));
+}
+
+bool DiffTraversal::View::shouldTraverseElement(const EntityTreeSnapshot::Element& element) const {
     if (!usesViewFrustums()) {
         return true;
     }
 
-    const auto& cube = element.getAACube();
-
-    auto center = cube.calcCenter(); // center of bounding sphere
-    auto radius = 0.5f * SQRT_THREE * cube.getScale(); // radius of bounding sphere
-
+    const auto& center = element.center; // center of bounding sphere
+    auto radius = element.radius; // radius of bounding sphere
 
     return any_of(begin(viewFrustums), end(viewFrustums), [&](const ConicalViewFrustum& frustum) {
         auto position = center - frustum.getPosition(); // position of bounding sphere in view-frame
@@ -193,9 +219,9 @@ DiffTraversal::DiffTraversal() {
     _path.reserve(MIN_PATH_DEPTH);
 }
 
-DiffTraversal::Type DiffTraversal::prepareNewTraversal(const DiffTraversal::View& view, EntityTreeElementPointer root,
+DiffTraversal::Type DiffTraversal::prepareNewTraversal(const DiffTraversal::View& view, EntityTreeSnapshotPointer snapshot,
                                                        bool forceFirstPass) {
-    assert(root);
+    assert(snapshot && snapshot->getRootIndex() != EntityTreeSnapshot::INVALID_INDEX);
     // there are three types of traversal:
     //
     //   (1) First = fresh view --> find all elements in view
@@ -218,42 +244,57 @@ DiffTraversal::Type DiffTraversal::prepareNewTraversal(const DiffTraversal::View
         _currentView.viewFrustums = view.viewFrustums;
         _currentView.lodScaleFactor = view.lodScaleFactor;
         _getNextVisibleElementCallback = [this](DiffTraversal::VisibleElement& next) {
-            _path.back().getNextVisibleElementFirstTime(next, _currentView);
+            _path.back().getNextVisibleElementFirstTime(next, *_snapshot, _currentView);
         };
     } else if (!_currentView.usesViewFrustums() || _completedView.isVerySimilar(view)) {
         type = Type::Repeat;
         _getNextVisibleElementCallback = [this](DiffTraversal::VisibleElement& next) {
-            _path.back().getNextVisibleElementRepeat(next, _completedView, _completedView.startTime);
+            _path.back().getNextVisibleElementRepeat(next, *_snapshot, _completedView, _completedView.startTime);
         };
     } else {
         type = Type::Differential;
         _currentView.viewFrustums = view.viewFrustums;
         _currentView.lodScaleFactor = view.lodScaleFactor;
         _getNextVisibleElementCallback = [this](DiffTraversal::VisibleElement& next) {
-            _path.back().getNextVisibleElementDifferential(next, _currentView, _completedView);
+            _path.back().getNextVisibleElementDifferential(next, *_snapshot, _currentView, _completedView);
         };
     }
 
+    _snapshot = snapshot;
+    if (_interestManager) {
+        // the priorities and the culling of this traversal come from the sets of the bucket of its view
+        _currentView.interestSets = _interestManager->getInterestSets(_snapshot, _currentView);
+        if (type == Type::Repeat) {
+            // which is also the view repeat traversals cull with
+            _completedView.interestSets = _currentView.interestSets;
+        }
+    } else {
+        _currentView.interestSets.reset();
+        _completedView.interestSets.reset();
+    }
     _path.clear();
-    _path.push_back(DiffTraversal::Waypoint(root));
+    _path.push_back(DiffTraversal::Waypoint(_snapshot->getRootIndex()));
     // set root fork's index such that root element returned at getNextElement()
     _path.back().initRootNextIndex();
 
-    _currentView.startTime = usecTimestampNow();
+    // the next Repeat traversal looks for what changed after this snapshot was taken, not after now,
+    // otherwise the edits made in between would be missed
+    _currentView.startTime = _snapshot->getTimestamp();
 
     return type;
 }
 
 void DiffTraversal::getNextVisibleElement(DiffTraversal::VisibleElement& next) {
     if (_path.empty()) {
-        next.element.reset();
+        next.element = nullptr;
+        next.index = EntityTreeSnapshot::INVALID_INDEX;
         return;
     }
     _getNextVisibleElementCallback(next);
     if (next.element) {
         int8_t nextIndex = _path.back().getNextIndex();
         if (nextIndex > 0) {
-            _path.push_back(DiffTraversal::Waypoint(next.element));
+            _path.push_back(DiffTraversal::Waypoint(next.index));
         }
     } else {
         // we're done at this level
@@ -263,13 +304,14 @@ void DiffTraversal::getNextVisibleElement(DiffTraversal::VisibleElement& next) {
             if (_path.empty()) {
                 // we've traversed the entire tree
                 _completedView = _currentView;
+                _snapshot.reset();
                 return;
             }
             // keep looking for next
             _getNextVisibleElementCallback(next);
             if (next.element) {
                 // we've descended one level so add it to the path
-                _path.push_back(DiffTraversal::Waypoint(next.element));
+                _path.push_back(DiffTraversal::Waypoint(next.index));
             }
         }
     }
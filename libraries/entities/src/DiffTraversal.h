@@ -15,15 +15,19 @@
 #include <shared/ConicalViewFrustum.h>
 
 #include "EntityTreeElement.h"
+#include "EntityTreeSnapshot.h"
 
-// DiffTraversal traverses the tree and applies _scanElementCallback on elements it finds
+class EntityInterestManager;
+class EntityInterestSets;
+
+// DiffTraversal traverses an EntityTreeSnapshot and applies _scanElementCallback on elements it finds
 class DiffTraversal {
 public:
-    // VisibleElement is a struct identifying an element and how it intersected the view.
-    // The intersection is used to optimize culling entities from the sendQueue.
+    // VisibleElement is a struct identifying an element of the snapshot being traversed.
     class VisibleElement {
     public:
-        EntityTreeElementPointer element;
+        const EntityTreeSnapshot::Element* element { nullptr };
+        int32_t index { EntityTreeSnapshot::INVALID_INDEX };
     };
 
     // View is a struct with a ViewFrustum and LOD parameters
@@ -32,28 +36,38 @@ public:
         bool usesViewFrustums() const;
         bool isVerySimilar(const View& view) const;
 
-        bool shouldTraverseElement(const EntityTreeElement& element) const;
+        bool shouldTraverseElement(const EntityTreeSnapshot::Element& element) const;
+        bool shouldTraverseElement(const EntityTreeSnapshot& snapshot, int32_t elementIndex) const;
         float computePriority(const EntityItemPointer& entity) const;
+        float computePriority(const EntityTreeSnapshot& snapshot, const EntityTreeSnapshot::Entity& entity) const;
 
         ConicalViewFrustums viewFrustums;
         uint64_t startTime { 0 };
         float lodScaleFactor { 1.0f };
+
+        // when set, the view answers with the sets shared by the views of its bucket (see EntityInterestSets)
+        std::shared_ptr<EntityInterestSets> interestSets;
+
+    private:
+        float computePriority(const glm::vec3& center, float radius) const;
     };
 
     // Waypoint is an bookmark in a "path" of waypoints during a traversal.
     class Waypoint {
     public:
-        Waypoint(EntityTreeElementPointer& element);
+        Waypoint(int32_t elementIndex);
 
-        void getNextVisibleElementFirstTime(VisibleElement& next, const View& view);
-        void getNextVisibleElementRepeat(VisibleElement& next, const View& view, uint64_t lastTime);
-        void getNextVisibleElementDifferential(VisibleElement& next, const View& view, const View& lastView);
+        void getNextVisibleElementFirstTime(VisibleElement& next, const EntityTreeSnapshot& snapshot, const View& view);
+        void getNextVisibleElementRepeat(VisibleElement& next, const EntityTreeSnapshot& snapshot, const View& view,
+                                         uint64_t lastTime);
+        void getNextVisibleElementDifferential(VisibleElement& next, const EntityTreeSnapshot& snapshot, const View& view,
+                                               const View& lastView);
 
         int8_t getNextIndex() const { return _nextIndex; }
         void initRootNextIndex() { _nextIndex = -1; }
 
     protected:
-        EntityTreeElementWeakPointer _weakElement;
+        int32_t _elementIndex;
         int8_t _nextIndex;
     };
 
@@ -61,24 +75,31 @@ public:
 
     DiffTraversal();
 
-    Type prepareNewTraversal(const DiffTraversal::View& view, EntityTreeElementPointer root, bool forceFirstPass = false);
+    // the whole traversal runs on the given snapshot, so it sees the tree as it was when the snapshot was taken
+    Type prepareNewTraversal(const DiffTraversal::View& view, EntityTreeSnapshotPointer snapshot, bool forceFirstPass = false);
 
     const View& getCurrentView() const { return _currentView; }
+    const EntityTreeSnapshot& getSnapshot() const { return *_snapshot; }
 
     uint64_t getStartOfCompletedTraversal() const { return _completedView.startTime; }
     bool finished() const { return _path.empty(); }
 
     void setScanCallback(std::function<void (VisibleElement&)> cb);
+
+    // traversals share their visibility work with the other viewers in the same bucket when given a manager
+    void setInterestManager(const std::shared_ptr<EntityInterestManager>& interestManager) { _interestManager = interestManager; }
     void traverse(uint64_t timeBudget);
 
-    void reset() { _path.clear(); _completedView.startTime = 0; } // resets our state to force a new "First" traversal
+    void reset() { _path.clear(); _snapshot.reset(); _completedView.startTime = 0; } // resets our state to force a new "First" traversal
 
 private:
     void getNextVisibleElement(VisibleElement& next);
 
     View _currentView;
     View _completedView;
+    EntityTreeSnapshotPointer _snapshot;
     std::vector<Waypoint> _path;
+    std::shared_ptr<EntityInterestManager> _interestManager;
     std::function<void (VisibleElement&)> _getNextVisibleElementCallback { nullptr };
     std::function<void (VisibleElement&)> _scanElementCallback { [](VisibleElement& e){} };
 };
@@ -0,0 +1,363 @@
+//
+//  EntityAABBTree.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityAABBTree.h"
+
+#include <queue>
+
+const float EntityAABBTree::FAT_MARGIN_SCALE = 0.1f;
+const float EntityAABBTree::MIN_FAT_MARGIN = 0.1f;
+
+static AABox combine(const AABox& a, const AABox& b) {
+    glm::vec3 minimum = glm::min(a.getMinimumPoint(), b.getMinimumPoint());
+    glm::vec3 maximum = glm::max(a.getMaximumPoint(), b.getMaximumPoint());
+    return AABox(minimum, maximum - minimum);
+}
+
+static float surfaceArea(const AABox& box) {
+    const glm::vec3& dimensions = box.getDimensions();
+    return 2.0f * (dimensions.x * dimensions.y + dimensions.y * dimensions.z + dimensions.z * dimensions.x);
+}
+
+static AABox fatten(const AABox& bounds) {
+    float margin = glm::max(EntityAABBTree::MIN_FAT_MARGIN, EntityAABBTree::FAT_MARGIN_SCALE * bounds.getLargestDimension());
+    return AABox(bounds.getCorner() - glm::vec3(margin), bounds.getDimensions() + glm::vec3(2.0f * margin));
+}
+
+int EntityAABBTree::getHeight() const {
+    return _root == NULL_NODE ? 0 : _nodes[_root].height;
+}
+
+void EntityAABBTree::insert(const EntityItemPointer& entity, const AABox& bounds) {
+    if (contains(entity.get())) {
+        update(entity, bounds);
+        return;
+    }
+
+    int leaf = allocateNode();
+    Node& node = _nodes[leaf];
+    node.box = fatten(bounds);
+    node.height = 0;
+    node.entity = entity;
+    node.key = entity.get();
+    _leaves.insert(entity.get(), leaf);
+    insertLeaf(leaf);
+}
+
+void EntityAABBTree::remove(const EntityItem* entity) {
+    int leaf = _leaves.value(entity, NULL_NODE);
+    if (leaf == NULL_NODE) {
+        return;
+    }
+    removeLeaf(leaf);
+    freeNode(leaf);
+    _leaves.remove(entity);
+}
+
+bool EntityAABBTree::update(const EntityItemPointer& entity, const AABox& bounds) {
+    int leaf = _leaves.value(entity.get(), NULL_NODE);
+    if (leaf == NULL_NODE) {
+        insert(entity, bounds);
+        return true;
+    }
+    // the entity can be a new one allocated where a deleted one was, before the deleted one got removed
+    _nodes[leaf].entity = entity;
+    if (_nodes[leaf].box.contains(bounds)) {
+        return false;
+    }
+
+    removeLeaf(leaf);
+    _nodes[leaf].box = fatten(bounds);
+    insertLeaf(leaf);
+    return true;
+}
+
+void EntityAABBTree::clear() {
+    _nodes.clear();
+    _root = NULL_NODE;
+    _freeList = NULL_NODE;
+    _leaves.clear();
+}
+
+void EntityAABBTree::findEntities(const BoxTest& test, const EntityVisitor& visitor) const {
+    if (_root == NULL_NODE) {
+        return;
+    }
+
+    std::vector<int> stack;
+    stack.push_back(_root);
+    while (!stack.empty()) {
+        const Node& node = _nodes[stack.back()];
+        stack.pop_back();
+        if (!test(node.box)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            EntityItemPointer entity = node.entity.lock();
+            if (entity) {
+                visitor(entity);
+            }
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void EntityAABBTree::findEntitiesByDistance(const BoxDistance& boxDistance, float maxDistance,
+                                            const DistanceVisitor& visitor) const {
+    if (_root == NULL_NODE) {
+        return;
+    }
+
+    using Candidate = std::pair<float, int>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+
+    float distance = 0.0f;
+    if (boxDistance(_nodes[_root].box, distance) && distance <= maxDistance) {
+        candidates.push({ distance, _root });
+    }
+
+    while (!candidates.empty()) {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+        // everything left starts further than the closest hit so far
+        if (candidate.first > maxDistance) {
+            break;
+        }
+
+        const Node& node = _nodes[candidate.second];
+        if (node.isLeaf()) {
+            EntityItemPointer entity = node.entity.lock();
+            if (entity) {
+                visitor(entity, maxDistance);
+            }
+            continue;
+        }
+
+        for (int child : { node.child1, node.child2 }) {
+            if (boxDistance(_nodes[child].box, distance) && distance <= maxDistance) {
+                candidates.push({ distance, child });
+            }
+        }
+    }
+}
+
+int EntityAABBTree::allocateNode() {
+    if (_freeList == NULL_NODE) {
+        _nodes.emplace_back();
+        return (int)_nodes.size() - 1;
+    }
+    int index = _freeList;
+    _freeList = _nodes[index].parent;
+    _nodes[index] = Node();
+    return index;
+}
+
+void EntityAABBTree::freeNode(int index) {
+    _nodes[index] = Node();
+    _nodes[index].parent = _freeList;
+    _freeList = index;
+}
+
+void EntityAABBTree::insertLeaf(int leaf) {
+    if (_root == NULL_NODE) {
+        _root = leaf;
+        _nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // walk down to the sibling that makes the tree grow the least, by surface area
+    AABox leafBox = _nodes[leaf].box;
+    int index = _root;
+    while (!_nodes[index].isLeaf()) {
+        const Node& node = _nodes[index];
+        float area = surfaceArea(node.box);
+        float combinedArea = surfaceArea(combine(node.box, leafBox));
+
+        // cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+        // cost of pushing the leaf further down, which grows this node's box
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child) {
+            const Node& childNode = _nodes[child];
+            float childCombinedArea = surfaceArea(combine(childNode.box, leafBox));
+            if (childNode.isLeaf()) {
+                return childCombinedArea + inheritanceCost;
+            }
+            return childCombinedArea - surfaceArea(childNode.box) + inheritanceCost;
+        };
+        float cost1 = descendCost(node.child1);
+        float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    int sibling = index;
+    int oldParent = _nodes[sibling].parent;
+    int newParent = allocateNode(); // can grow _nodes, don't hold references across it
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].box = combine(leafBox, _nodes[sibling].box);
+    _nodes[newParent].height = _nodes[sibling].height + 1;
+    _nodes[newParent].child1 = sibling;
+    _nodes[newParent].child2 = leaf;
+
+    if (oldParent != NULL_NODE) {
+        if (_nodes[oldParent].child1 == sibling) {
+            _nodes[oldParent].child1 = newParent;
+        } else {
+            _nodes[oldParent].child2 = newParent;
+        }
+    } else {
+        _root = newParent;
+    }
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    refit(_nodes[leaf].parent);
+}
+
+void EntityAABBTree::removeLeaf(int leaf) {
+    if (leaf == _root) {
+        _root = NULL_NODE;
+        return;
+    }
+
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    if (grandParent != NULL_NODE) {
+        // the sibling takes the place of the parent
+        if (_nodes[grandParent].child1 == parent) {
+            _nodes[grandParent].child1 = sibling;
+        } else {
+            _nodes[grandParent].child2 = sibling;
+        }
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refit(grandParent);
+    } else {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+    _nodes[leaf].parent = NULL_NODE;
+}
+
+void EntityAABBTree::refit(int index) {
+    while (index != NULL_NODE) {
+        index = balance(index);
+
+        Node& node = _nodes[index];
+        const Node& child1 = _nodes[node.child1];
+        const Node& child2 = _nodes[node.child2];
+        node.height = 1 + glm::max(child1.height, child2.height);
+        node.box = combine(child1.box, child2.box);
+
+        index = node.parent;
+    }
+}
+
+// Rotates the taller child of the node up if the heights of its children differ by more than one, returns the index
+// of the node that is now at its place
+int EntityAABBTree::balance(int indexA) {
+    Node& a = _nodes[indexA];
+    if (a.isLeaf() || a.height < 2) {
+        return indexA;
+    }
+
+    int indexB = a.child1;
+    int indexC = a.child2;
+    Node& b = _nodes[indexB];
+    Node& c = _nodes[indexC];
+
+    auto replaceInParent = [&](int oldChild, int newChild) {
+        int parent = _nodes[newChild].parent;
+        if (parent == NULL_NODE) {
+            _root = newChild;
+        } else if (_nodes[parent].child1 == oldChild) {
+            _nodes[parent].child1 = newChild;
+        } else {
+            _nodes[parent].child2 = newChild;
+        }
+    };
+
+    int heightDifference = c.height - b.height;
+    if (heightDifference > 1) {
+        // rotate C up
+        int indexF = c.child1;
+        int indexG = c.child2;
+        Node& f = _nodes[indexF];
+        Node& g = _nodes[indexG];
+
+        c.child1 = indexA;
+        c.parent = a.parent;
+        a.parent = indexC;
+        replaceInParent(indexA, indexC);
+
+        if (f.height > g.height) {
+            c.child2 = indexF;
+            a.child2 = indexG;
+            g.parent = indexA;
+            a.box = combine(b.box, g.box);
+            c.box = combine(a.box, f.box);
+            a.height = 1 + glm::max(b.height, g.height);
+            c.height = 1 + glm::max(a.height, f.height);
+        } else {
+            c.child2 = indexG;
+            a.child2 = indexF;
+            f.parent = indexA;
+            a.box = combine(b.box, f.box);
+            c.box = combine(a.box, g.box);
+            a.height = 1 + glm::max(b.height, f.height);
+            c.height = 1 + glm::max(a.height, g.height);
+        }
+        return indexC;
+    }
+
+    if (heightDifference < -1) {
+        // rotate B up
+        int indexD = b.child1;
+        int indexE = b.child2;
+        Node& d = _nodes[indexD];
+        Node& e = _nodes[indexE];
+
+        b.child1 = indexA;
+        b.parent = a.parent;
+        a.parent = indexB;
+        replaceInParent(indexA, indexB);
+
+        if (d.height > e.height) {
+            b.child2 = indexD;
+            a.child1 = indexE;
+            e.parent = indexA;
+            a.box = combine(c.box, e.box);
+            b.box = combine(a.box, d.box);
+            a.height = 1 + glm::max(c.height, e.height);
+            b.height = 1 + glm::max(a.height, d.height);
+        } else {
+            b.child2 = indexE;
+            a.child1 = indexD;
+            d.parent = indexA;
+            a.box = combine(c.box, d.box);
+            b.box = combine(a.box, e.box);
+            a.height = 1 + glm::max(c.height, d.height);
+            b.height = 1 + glm::max(a.height, e.height);
+        }
+        return indexB;
+    }
+
+    return indexA;
+}
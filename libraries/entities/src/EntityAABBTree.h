@@ -0,0 +1,92 @@
+//
+//  EntityAABBTree.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityAABBTree_h
+#define hifi_EntityAABBTree_h
+
+#include <functional>
+#include <vector>
+
+#include <QtCore/QHash>
+
+#include <AABox.h>
+
+#include "EntityTypes.h"
+
+/// Dynamic bounding volume hierarchy of entities, an alternative to walking the octree elements for spatial queries.
+///
+/// Each entity is a leaf whose box is its bounds grown by a margin, so an entity that moves a little (or only rotates,
+/// since the bounds are rotation invariant) doesn't change the tree at all, and one that moves further is removed and
+/// re-inserted where it fits best, without walking down from the root of the octree. Inner nodes are kept balanced
+/// with tree rotations.
+///
+/// EntityTree keeps it on top of the octree, which sending and persistence still walk: with it, moving an entity costs
+/// the octree move plus the update of its leaf. It pays off when there are more queries than moves to answer.
+///
+/// The tree isn't thread safe, EntityTree guards it with its own lock.
+class EntityAABBTree {
+public:
+    static const float FAT_MARGIN_SCALE; // fraction of the largest dimension of the bounds added on each side
+    static const float MIN_FAT_MARGIN; // meters
+
+    using BoxTest = std::function<bool(const AABox& box)>;
+    using EntityVisitor = std::function<void(const EntityItemPointer& entity)>;
+    // returns the distance along the query at which it enters the box, if it does
+    using BoxDistance = std::function<bool(const AABox& box, float& distance)>;
+    // lowers maxDistance when it finds a hit closer than it
+    using DistanceVisitor = std::function<void(const EntityItemPointer& entity, float& maxDistance)>;
+
+    bool contains(const EntityItem* entity) const { return _leaves.contains(entity); }
+    int getNumEntities() const { return _leaves.size(); }
+    int getHeight() const;
+
+    void insert(const EntityItemPointer& entity, const AABox& bounds);
+    void remove(const EntityItem* entity);
+    /// Returns false if the bounds still fit in the leaf of the entity, in which case nothing changed
+    bool update(const EntityItemPointer& entity, const AABox& bounds);
+    void clear();
+
+    /// Visits the entities whose leaf passes the test, skipping the subtrees whose box doesn't
+    void findEntities(const BoxTest& test, const EntityVisitor& visitor) const;
+
+    /// Visits the entities whose leaf the query enters before maxDistance, the nearest leaves first, so that the
+    /// visitor can lower maxDistance to prune the rest of the search (rays, parabolas)
+    void findEntitiesByDistance(const BoxDistance& boxDistance, float maxDistance, const DistanceVisitor& visitor) const;
+
+private:
+    static const int NULL_NODE = -1;
+
+    class Node {
+    public:
+        bool isLeaf() const { return child1 == NULL_NODE; }
+
+        AABox box;
+        int parent { NULL_NODE }; // next free node when the node is unused
+        int child1 { NULL_NODE };
+        int child2 { NULL_NODE };
+        int height { -1 }; // leaves are 0, unused nodes -1
+        EntityItemWeakPointer entity;
+        const EntityItem* key { nullptr };
+    };
+
+    int allocateNode();
+    void freeNode(int index);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    void refit(int index);
+    int balance(int index);
+
+    std::vector<Node> _nodes;
+    int _root { NULL_NODE };
+    int _freeList { NULL_NODE };
+    QHash<const EntityItem*, int> _leaves;
+};
+
+#endif // hifi_EntityAABBTree_h
@@ -0,0 +1,359 @@
+//
+//  EntityBinarySnapshot.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityBinarySnapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include <OctreePacketData.h>
+#include <udt/PacketHeaders.h>
+
+#include "EntitiesLogging.h"
+#include "EntityItem.h"
+#include "EntityTree.h"
+#include "EntityTreeElement.h"
+
+const QString EntityBinarySnapshot::FILE_EXTENSION { "snapshot" };
+const int EntityBinarySnapshot::DEFAULT_ENTITIES_PER_CHUNK = 512;
+
+static const QByteArray SNAPSHOT_MAGIC { "HFES" };
+static const quint32 SNAPSHOT_FORMAT_VERSION = 1;
+
+// magic, format version, entity data version, number of chunks, persist data version, persist id, index offset
+static const int HEADER_SIZE = 4 + 4 + 4 + 4 + 8 + 16 + 8;
+// offset, size and number of entities of a chunk
+static const int INDEX_ENTRY_SIZE = 8 + 4 + 4;
+// size of the encoded entity, the flags follow it
+static const int RECORD_HEADER_SIZE = 4;
+static const int RECORD_FLAGS_SIZE = 1;
+
+// the wire encoding leaves out the properties that clients never get, the ones that matter to the server follow each entity
+enum RecordFlags : quint8 {
+    VISIBLE_IN_SECONDARY_CAMERA = 1 << 0
+};
+
+static const int MIN_ENCODE_BUFFER_SIZE = 16 * 1024;
+static const int MAX_ENCODE_BUFFER_SIZE = 64 * 1024 * 1024;
+
+namespace {
+
+class Chunk {
+public:
+    quint64 offset { 0 };
+    quint32 size { 0 };
+    quint32 numEntities { 0 };
+};
+
+template <typename T>
+void appendValue(QByteArray& data, T value) {
+    T littleEndian = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char*>(&littleEndian), sizeof(T));
+}
+
+template <typename T>
+T readValue(const uchar* data) {
+    return qFromLittleEndian<T>(data);
+}
+
+// calls work(i) for every i in [0, count) on up to numThreads threads, the calling thread being one of them
+template <typename F>
+void parallelFor(int count, int numThreads, F work) {
+    if (numThreads <= 0) {
+        numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    numThreads = std::min(numThreads, count);
+
+    std::atomic<int> next { 0 };
+    auto worker = [&] {
+        for (int i = next++; i < count; i = next++) {
+            work(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void collectEntities(const EntityTreeElementPointer& element, QVector<EntityItemPointer>& entities) {
+    element->forEachEntity([&](const EntityItemPointer& entity) {
+        entities.push_back(entity);
+    });
+    for (int i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+        EntityTreeElementPointer child = element->getChildAtIndex(i);
+        if (child) {
+            collectEntities(child, entities);
+        }
+    }
+}
+
+QByteArray encodeEntity(const EntityItemPointer& entity) {
+    for (int bufferSize = MIN_ENCODE_BUFFER_SIZE; bufferSize <= MAX_ENCODE_BUFFER_SIZE; bufferSize *= 4) {
+        OctreePacketData packetData(false, bufferSize);
+        EncodeBitstreamParams params;
+        // a partial encode leaves the properties it couldn't fit in the extra data, so every attempt starts from a new one
+        auto extraEncodeData = std::make_shared<EntityTreeElementExtraEncodeData>();
+        if (entity->appendEntityData(&packetData, params, extraEncodeData, true) == OctreeElement::COMPLETED) {
+            return QByteArray(reinterpret_cast<const char*>(packetData.getUncompressedData()), packetData.getUncompressedSize());
+        }
+    }
+    return QByteArray();
+}
+
+bool readHeader(const uchar* data, qint64 size, QUuid& id, qint64& dataVersion, quint32& numChunks, quint64& indexOffset) {
+    if (size < HEADER_SIZE || memcmp(data, SNAPSHOT_MAGIC.constData(), SNAPSHOT_MAGIC.size()) != 0) {
+        qCWarning(entities) << "Not an entity snapshot";
+        return false;
+    }
+
+    quint32 formatVersion = readValue<quint32>(data + 4);
+    quint32 entityDataVersion = readValue<quint32>(data + 8);
+    if (formatVersion != SNAPSHOT_FORMAT_VERSION || entityDataVersion != (quint32)versionForPacketType(PacketType::EntityData)) {
+        qCWarning(entities) << "Entity snapshot was written with format version" << formatVersion << "and entity data version"
+            << entityDataVersion << "which are not the current ones";
+        return false;
+    }
+
+    numChunks = readValue<quint32>(data + 12);
+    dataVersion = readValue<qint64>(data + 16);
+    id = QUuid::fromRfc4122(QByteArray::fromRawData(reinterpret_cast<const char*>(data + 24), 16));
+    indexOffset = readValue<quint64>(data + 40);
+
+    if (indexOffset < (quint64)HEADER_SIZE || indexOffset + (quint64)numChunks * INDEX_ENTRY_SIZE > (quint64)size) {
+        qCWarning(entities) << "Entity snapshot is truncated";
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool EntityBinarySnapshot::encode(const EntityTreePointer& tree, EncodedEntities& encoded, int numThreads,
+                                  int entitiesPerChunk) {
+    entitiesPerChunk = std::max(1, entitiesPerChunk);
+    std::atomic<bool> success { true };
+
+    encoded.id = tree->getPersistID();
+    encoded.dataVersion = tree->getPersistDataVersion();
+
+    QVector<EntityItemPointer> treeEntities;
+    collectEntities(tree->getRoot(), treeEntities);
+
+    int numChunks = (treeEntities.size() + entitiesPerChunk - 1) / entitiesPerChunk;
+    encoded.chunkData.clear();
+    encoded.chunkData.resize(numChunks);
+    encoded.chunkEntities.clear();
+    encoded.chunkEntities.resize(numChunks);
+
+    parallelFor(numChunks, numThreads, [&](int chunk) {
+        int begin = chunk * entitiesPerChunk;
+        int end = std::min(begin + entitiesPerChunk, treeEntities.size());
+        QByteArray& data = encoded.chunkData[chunk];
+        for (int i = begin; i < end; ++i) {
+            const auto& entity = treeEntities[i];
+            QByteArray entityData = encodeEntity(entity);
+            if (entityData.isEmpty()) {
+                qCWarning(entities) << "Could not encode" << entity->getEntityItemID() << "for the entity snapshot";
+                success = false;
+                return;
+            }
+            appendValue<quint32>(data, entityData.size());
+            data.append(entityData);
+            appendValue<quint8>(data, entity->isVisibleInSecondaryCamera() ? VISIBLE_IN_SECONDARY_CAMERA : 0);
+        }
+        encoded.chunkEntities[chunk] = end - begin;
+    });
+
+    return success;
+}
+
+bool EntityBinarySnapshot::write(const EntityTreePointer& tree, const QString& filename, int numThreads, int entitiesPerChunk) {
+    EncodedEntities encoded;
+    bool success = false;
+    tree->withReadLock([&] {
+        success = encode(tree, encoded, numThreads, entitiesPerChunk);
+    });
+    return success && write(encoded, filename);
+}
+
+bool EntityBinarySnapshot::write(const EncodedEntities& encoded, const QString& filename) {
+    const auto& chunkData = encoded.chunkData;
+    const auto& chunkEntities = encoded.chunkEntities;
+
+    QByteArray index;
+    quint64 offset = HEADER_SIZE;
+    for (int chunk = 0; chunk < chunkData.size(); ++chunk) {
+        appendValue<quint64>(index, offset);
+        appendValue<quint32>(index, chunkData[chunk].size());
+        appendValue<quint32>(index, chunkEntities[chunk]);
+        offset += chunkData[chunk].size();
+    }
+
+    QByteArray header = SNAPSHOT_MAGIC;
+    appendValue<quint32>(header, SNAPSHOT_FORMAT_VERSION);
+    appendValue<quint32>(header, versionForPacketType(PacketType::EntityData));
+    appendValue<quint32>(header, chunkData.size());
+    appendValue<qint64>(header, encoded.dataVersion);
+    header.append(encoded.id.toRfc4122());
+    appendValue<quint64>(header, offset);
+
+    // the previous snapshot is only replaced once the new one is complete
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(entities) << "Could not write entity snapshot" << filename << file.errorString();
+        return false;
+    }
+    file.write(header);
+    for (const auto& data : chunkData) {
+        file.write(data);
+    }
+    file.write(index);
+    if (!file.commit()) {
+        qCWarning(entities) << "Could not write entity snapshot" << filename << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool EntityBinarySnapshot::readInfo(const QString& filename, QUuid& id, qint64& dataVersion) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray header = file.read(HEADER_SIZE);
+    quint32 numChunks;
+    quint64 indexOffset;
+    return readHeader(reinterpret_cast<const uchar*>(header.constData()), std::min((qint64)header.size(), file.size()),
+                      id, dataVersion, numChunks, indexOffset) &&
+        indexOffset + (quint64)numChunks * INDEX_ENTRY_SIZE <= (quint64)file.size();
+}
+
+bool EntityBinarySnapshot::read(const EntityTreePointer& tree, const QString& filename, int numThreads) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(entities) << "Could not open entity snapshot" << filename << file.errorString();
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    const uchar* data = file.map(0, fileSize);
+    if (!data) {
+        qCWarning(entities) << "Could not map entity snapshot" << filename << file.errorString();
+        return false;
+    }
+
+    QUuid id;
+    qint64 dataVersion;
+    quint32 numChunks;
+    quint64 indexOffset;
+    if (!readHeader(data, fileSize, id, dataVersion, numChunks, indexOffset)) {
+        return false;
+    }
+
+    QVector<Chunk> chunks(numChunks);
+    for (quint32 i = 0; i < numChunks; ++i) {
+        const uchar* entry = data + indexOffset + i * INDEX_ENTRY_SIZE;
+        Chunk& chunk = chunks[i];
+        chunk.offset = readValue<quint64>(entry);
+        chunk.size = readValue<quint32>(entry + 8);
+        chunk.numEntities = readValue<quint32>(entry + 12);
+        if (chunk.offset < (quint64)HEADER_SIZE || chunk.offset + chunk.size > indexOffset) {
+            qCWarning(entities) << "Entity snapshot" << filename << "has an invalid index";
+            return false;
+        }
+    }
+
+    // decoding is what takes time and it only touches the new entities, so the chunks get decoded side by side
+    QVector<QVector<EntityItemPointer>> decodedChunks(numChunks);
+    std::atomic<bool> success { true };
+    parallelFor(numChunks, numThreads, [&](int i) {
+        const Chunk& chunk = chunks[i];
+        const uchar* record = data + chunk.offset;
+        const uchar* end = record + chunk.size;
+        QVector<EntityItemPointer>& decoded = decodedChunks[i];
+        decoded.reserve(chunk.numEntities);
+
+        while (record < end && success) {
+            if (end - record < RECORD_HEADER_SIZE) {
+                success = false;
+                break;
+            }
+            int size = (int)readValue<quint32>(record);
+            record += RECORD_HEADER_SIZE;
+            if (size <= 0 || end - record < size + RECORD_FLAGS_SIZE) {
+                success = false;
+                break;
+            }
+
+            EntityItemPointer entity = EntityTypes::constructEntityItem(record, size);
+            ReadBitstreamToTreeParams args;
+            if (!entity || entity->readEntityDataFromBuffer(record, size, args) != size) {
+                success = false;
+                break;
+            }
+            record += size;
+
+            quint8 flags = *record;
+            entity->setIsVisibleInSecondaryCamera(flags & VISIBLE_IN_SECONDARY_CAMERA);
+            record += RECORD_FLAGS_SIZE;
+
+            decoded.push_back(entity);
+        }
+
+        if (decoded.size() != (int)chunk.numEntities) {
+            success = false;
+        }
+    });
+
+    if (!success) {
+        qCWarning(entities) << "Entity snapshot" << filename << "could not be decoded";
+        return false;
+    }
+
+    tree->withWriteLock([&] {
+        QMap<QUuid, QVector<QUuid>> cloneIDs;
+        for (const auto& decoded : decodedChunks) {
+            for (const auto& entity : decoded) {
+                if (!tree->addDecodedEntity(entity)) {
+                    qCDebug(entities) << "adding Entity failed:" << entity->getEntityItemID() << entity->getType();
+                    continue;
+                }
+                const QUuid& cloneOriginID = entity->getCloneOriginID();
+                if (!cloneOriginID.isNull()) {
+                    cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
+                }
+            }
+        }
+
+        for (const auto& entityID : cloneIDs.keys()) {
+            auto entity = tree->findEntityByID(entityID);
+            if (entity) {
+                entity->setCloneIDs(cloneIDs.value(entityID));
+            }
+        }
+    });
+
+    tree->setOctreeVersionInfo(id, dataVersion);
+    return true;
+}
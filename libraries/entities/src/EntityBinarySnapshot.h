@@ -0,0 +1,65 @@
+//
+//  EntityBinarySnapshot.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityBinarySnapshot_h
+#define hifi_EntityBinarySnapshot_h
+
+#include <QtCore/QString>
+#include <QtCore/QUuid>
+#include <QtCore/QVector>
+
+#include "EntityTypes.h"
+
+class EntityTree;
+using EntityTreePointer = std::shared_ptr<EntityTree>;
+
+/// Binary copy of all the entities of a tree, which loads a lot faster than the JSON persist file.
+///
+/// Entities are stored with the same encoding the entity server sends them to clients in (EntityItem::appendEntityData),
+/// grouped in chunks that are listed in an index at the end of the file. Loading maps the file in memory and decodes
+/// the chunks on several threads, only adding the decoded entities to the tree is done on the calling thread.
+///
+/// The encoding depends on the EntityData packet version, snapshots written with another version are rejected and the
+/// caller is expected to fall back to the JSON file.
+class EntityBinarySnapshot {
+public:
+    static const QString FILE_EXTENSION;
+    static const int DEFAULT_ENTITIES_PER_CHUNK;
+
+    /// The encoded chunks of a snapshot, before they get written
+    class EncodedEntities {
+    public:
+        QUuid id;
+        qint64 dataVersion { 0 };
+        QVector<QByteArray> chunkData;
+        QVector<quint32> chunkEntities;
+    };
+
+    /// Encodes every entity in the tree, on numThreads threads (0 for one per core). The caller holds the tree's read
+    /// lock, EntityPersistSnapshot encodes them while it copies the tree for the JSON persist file.
+    static bool encode(const EntityTreePointer& tree, EncodedEntities& encoded, int numThreads = 0,
+                       int entitiesPerChunk = DEFAULT_ENTITIES_PER_CHUNK);
+    /// Writes the encoded entities to filename (atomically)
+    static bool write(const EncodedEntities& encoded, const QString& filename);
+
+    /// Encodes every entity in the tree and writes them to filename. The tree is read locked while they get encoded.
+    static bool write(const EntityTreePointer& tree, const QString& filename, int numThreads = 0,
+                      int entitiesPerChunk = DEFAULT_ENTITIES_PER_CHUNK);
+
+    /// Reads the persist id and data version of a snapshot without loading it
+    static bool readInfo(const QString& filename, QUuid& id, qint64& dataVersion);
+
+    /// Adds the entities of the snapshot to the tree, decoding them on numThreads threads (0 for one per core).
+    /// Nothing is added unless the whole snapshot decodes. The tree is only write locked while the decoded entities
+    /// get added, so the caller must not hold its lock.
+    static bool read(const EntityTreePointer& tree, const QString& filename, int numThreads = 0);
+};
+
+#endif // hifi_EntityBinarySnapshot_h
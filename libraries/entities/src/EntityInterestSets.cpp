@@ -0,0 +1,216 @@
+//
+//  EntityInterestSets.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityInterestSets.h"
+
+#include <cstring>
+
+#include <GLMHelpers.h>
+#include <NumericalConstants.h>
+#include <OctreeUtils.h>
+
+#include "EntityPriorityQueue.h"
+
+const float EntityInterestSets::POSITION_CELL_SIZE = 2.0f;
+const int EntityInterestSets::DIRECTION_CELLS_PER_FACE = 8;
+const float EntityInterestSets::ANGLE_STEP = 0.05f;
+const float EntityInterestSets::FAR_CLIP_STEP = 16.0f;
+const float EntityInterestSets::RADIUS_STEP = 0.5f;
+
+static const int KEY_INTS_PER_FRUSTUM = 9;
+
+// the cube map face of a direction, and the cell of the direction in the face
+static void computeDirectionCell(const glm::vec3& direction, int& face, int& u, int& v) {
+    glm::vec3 absDirection = glm::abs(direction);
+    int axis = 0;
+    if (absDirection.y > absDirection[axis]) {
+        axis = 1;
+    }
+    if (absDirection.z > absDirection[axis]) {
+        axis = 2;
+    }
+    face = 2 * axis + (direction[axis] < 0.0f ? 1 : 0);
+
+    float major = std::max(absDirection[axis], EPSILON);
+    auto toCell = [](float coordinate) {
+        int cell = (int)floorf((coordinate + 1.0f) * 0.5f * EntityInterestSets::DIRECTION_CELLS_PER_FACE);
+        return glm::clamp(cell, 0, EntityInterestSets::DIRECTION_CELLS_PER_FACE - 1);
+    };
+    u = toCell(direction[(axis + 1) % 3] / major);
+    v = toCell(direction[(axis + 2) % 3] / major);
+}
+
+static glm::vec3 directionOfCellPoint(int face, float u, float v) {
+    int axis = face / 2;
+    glm::vec3 direction;
+    direction[axis] = (face % 2) ? -1.0f : 1.0f;
+    direction[(axis + 1) % 3] = u * 2.0f / EntityInterestSets::DIRECTION_CELLS_PER_FACE - 1.0f;
+    direction[(axis + 2) % 3] = v * 2.0f / EntityInterestSets::DIRECTION_CELLS_PER_FACE - 1.0f;
+    return glm::normalize(direction);
+}
+
+EntityInterestSets::Key EntityInterestSets::computeKey(const DiffTraversal::View& view) {
+    Key key;
+    key.reserve(KEY_INTS_PER_FRUSTUM * view.viewFrustums.size() + 1);
+    for (const auto& frustum : view.viewFrustums) {
+        glm::vec3 cell = glm::floor(frustum.getPosition() / POSITION_CELL_SIZE);
+        int face, u, v;
+        computeDirectionCell(frustum.getDirection(), face, u, v);
+        key.push_back((int32_t)cell.x);
+        key.push_back((int32_t)cell.y);
+        key.push_back((int32_t)cell.z);
+        key.push_back(face);
+        key.push_back(u);
+        key.push_back(v);
+        // rounded up, so that the bucket sees at least as much as each of its views
+        key.push_back((int32_t)ceilf(frustum.getAngle() / ANGLE_STEP));
+        key.push_back((int32_t)ceilf(frustum.getFarClip() / FAR_CLIP_STEP));
+        key.push_back((int32_t)ceilf(frustum.getRadius() / RADIUS_STEP));
+    }
+    int32_t lodBits;
+    static_assert(sizeof(lodBits) == sizeof(view.lodScaleFactor), "LOD scale factor doesn't fit the key");
+    memcpy(&lodBits, &view.lodScaleFactor, sizeof(lodBits));
+    key.push_back(lodBits);
+    return key;
+}
+
+EntityInterestSets::EntityInterestSets(const EntityTreeSnapshot& snapshot, const Key& key) :
+    _snapshot(&snapshot),
+    _snapshotTimestamp(snapshot.getTimestamp()),
+    _elementVisibility(snapshot.getNumElements()),
+    _entityPriorities(snapshot.getNumEntities())
+{
+    // everything is derived from the key, so that the sets don't depend on which view of the bucket asked first
+    size_t numFrustums = (key.size() - 1) / KEY_INTS_PER_FRUSTUM;
+    _frustums.resize(numFrustums);
+    for (size_t i = 0; i < numFrustums; ++i) {
+        const int32_t* frustumKey = &key[i * KEY_INTS_PER_FRUSTUM];
+        Frustum& frustum = _frustums[i];
+        frustum.position = (glm::vec3(frustumKey[0], frustumKey[1], frustumKey[2]) + 0.5f) * POSITION_CELL_SIZE;
+
+        int face = frustumKey[3];
+        float u = (float)frustumKey[4];
+        float v = (float)frustumKey[5];
+        frustum.direction = directionOfCellPoint(face, u + 0.5f, v + 0.5f);
+        float directionSlack = 0.0f;
+        for (float cornerU : { u, u + 1.0f }) {
+            for (float cornerV : { v, v + 1.0f }) {
+                directionSlack = std::max(directionSlack, angleBetween(frustum.direction,
+                                                                       directionOfCellPoint(face, cornerU, cornerV)));
+            }
+        }
+
+        float angle = std::min(frustumKey[6] * ANGLE_STEP + directionSlack, PI);
+        frustum.cosAngle = cosf(angle);
+        frustum.sinAngle = sinf(angle);
+        frustum.farClip = frustumKey[7] * FAR_CLIP_STEP;
+        frustum.radius = frustumKey[8] * RADIUS_STEP;
+    }
+    memcpy(&_lodScaleFactor, &key.back(), sizeof(_lodScaleFactor));
+    _positionSlack = 0.5f * SQRT_THREE * POSITION_CELL_SIZE;
+}
+
+bool EntityInterestSets::shouldTraverseElement(const EntityTreeSnapshot& snapshot, int32_t elementIndex) const {
+    assert(isFor(snapshot));
+    auto& visibility = _elementVisibility[elementIndex];
+    int8_t state = visibility.load(std::memory_order_relaxed);
+    if (state == Unknown) {
+        // other viewers might be computing the same thing, they all get the same answer
+        const auto& element = snapshot.getElement(elementIndex);
+        bool isVisible = computeAngularSize(element.center, element.radius, MIN_ELEMENT_ANGULAR_DIAMETER) >= 0.0f;
+        state = isVisible ? Visible : Hidden;
+        visibility.store(state, std::memory_order_relaxed);
+    }
+    return state == Visible;
+}
+
+float EntityInterestSets::computePriority(const EntityTreeSnapshot& snapshot,
+                                          const EntityTreeSnapshot::Entity& entity) const {
+    assert(isFor(snapshot));
+    if (!entity.hasBounds) {
+        return PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
+    }
+
+    auto& cachedPriority = _entityPriorities[snapshot.getEntityIndex(entity)];
+    float priority = cachedPriority.load(std::memory_order_relaxed);
+    if (priority == 0.0f) { // no priority that gets computed is 0
+        priority = computePriority(entity.center, entity.radius);
+        cachedPriority.store(priority, std::memory_order_relaxed);
+    }
+    return priority;
+}
+
+float EntityInterestSets::computePriority(const glm::vec3& center, float radius) const {
+    float angularSize = computeAngularSize(center, radius, MIN_ENTITY_ANGULAR_DIAMETER);
+    return angularSize >= 0.0f ? angularSize : PrioritizedEntity::DO_NOT_SEND;
+}
+
+float EntityInterestSets::computeAngularSize(const glm::vec3& center, float radius, float minAngularDiameter) const {
+    const float AVOID_DIVIDE_BY_ZERO = 0.001f;
+
+    // a sphere seen from somewhere in the position cell is the sphere grown by the slack seen from its center
+    float grownRadius = radius + _positionSlack;
+    float angularSize = -1.0f;
+    for (const auto& frustum : _frustums) {
+        glm::vec3 position = center - frustum.position;
+        float distance = glm::length(position);
+
+        // as close as the views of the bucket can get to it
+        float nearestDistance = std::max(distance - _positionSlack, 0.0f);
+        float frustumAngularSize = radius / (nearestDistance + AVOID_DIVIDE_BY_ZERO);
+        if (frustumAngularSize <= _lodScaleFactor * minAngularDiameter || frustumAngularSize <= angularSize) {
+            continue;
+        }
+
+        // same tests as ConicalViewFrustum::intersects
+        bool intersects = distance < frustum.radius + grownRadius ||
+            (distance <= frustum.farClip + grownRadius &&
+             glm::dot(position, frustum.direction) >
+                 sqrtf(distance * distance - grownRadius * grownRadius) * frustum.cosAngle - grownRadius * frustum.sinAngle);
+        if (intersects) {
+            angularSize = frustumAngularSize;
+        }
+    }
+    return angularSize;
+}
+
+EntityInterestSetsPointer EntityInterestManager::getInterestSets(const EntityTreeSnapshotPointer& snapshot,
+                                                                 const DiffTraversal::View& view) {
+    if (!snapshot || !view.usesViewFrustums()) {
+        return EntityInterestSetsPointer();
+    }
+
+    auto key = EntityInterestSets::computeKey(view);
+    ++_numRequests;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (snapshot->getTimestamp() < _snapshotTimestamp) {
+        // a viewer that's behind, the others have moved on to a newer snapshot
+        return std::make_shared<EntityInterestSets>(*snapshot, key);
+    }
+    if (snapshot.get() != _snapshot || snapshot->getTimestamp() != _snapshotTimestamp) {
+        _interestSets.clear();
+        _snapshot = snapshot.get();
+        _snapshotTimestamp = snapshot->getTimestamp();
+    }
+
+    auto& interestSets = _interestSets[key];
+    if (interestSets) {
+        ++_numSharedRequests;
+    } else {
+        interestSets = std::make_shared<EntityInterestSets>(*snapshot, key);
+    }
+    return interestSets;
+}
+
+int EntityInterestManager::getNumBuckets() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (int)_interestSets.size();
+}
@@ -0,0 +1,115 @@
+//
+//  EntityInterestSets.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityInterestSets_h
+#define hifi_EntityInterestSets_h
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "DiffTraversal.h"
+#include "EntityTreeSnapshot.h"
+
+/// What the viewers whose views fall in the same bucket can see of a snapshot, worked out once for all of them.
+///
+/// A bucket groups the views whose position is in the same POSITION_CELL_SIZE cell and whose direction is in the same
+/// cell of a cube map, with the same LOD and with their view angle, far clip and keyhole radius rounded up to the same
+/// step. The tests are made conservative for the whole bucket: bounding spheres are grown by the distance from the
+/// center of the position cell to its corners and the view angle by the angle from the center of the direction cell to
+/// its corners. Every viewer in the bucket gets what its own view would have sent it, plus a few entities just outside
+/// of it, prioritized by the largest angular size they can have from anywhere in the bucket.
+///
+/// The visibility of the elements and the priorities of the entities are computed lazily, the first viewer to need one
+/// computes it for the others. Viewers can use the same sets concurrently.
+class EntityInterestSets {
+public:
+    static const float POSITION_CELL_SIZE; // meters
+    static const int DIRECTION_CELLS_PER_FACE; // along each side of a face of the cube map
+    static const float ANGLE_STEP; // radians
+    static const float FAR_CLIP_STEP; // meters
+    static const float RADIUS_STEP; // meters
+
+    using Key = std::vector<int32_t>;
+
+    /// Returns the bucket of a view, which must use view frustums
+    static Key computeKey(const DiffTraversal::View& view);
+
+    EntityInterestSets(const EntityTreeSnapshot& snapshot, const Key& key);
+
+    /// True if the sets were made for the snapshot. They keep no reference to it: the caller holds the snapshot
+    /// for as long as it uses them with it. A later snapshot can be allocated where an earlier one was, so the
+    /// timestamp is compared as well.
+    bool isFor(const EntityTreeSnapshot& snapshot) const {
+        return &snapshot == _snapshot && snapshot.getTimestamp() == _snapshotTimestamp;
+    }
+
+    bool shouldTraverseElement(const EntityTreeSnapshot& snapshot, int32_t elementIndex) const;
+    /// Priority of one of the entities of the snapshot the sets were made for, cached
+    float computePriority(const EntityTreeSnapshot& snapshot, const EntityTreeSnapshot::Entity& entity) const;
+    /// Priority of a bounding sphere, for the entities that changed since the snapshot was taken
+    float computePriority(const glm::vec3& center, float radius) const;
+
+private:
+    class Frustum {
+    public:
+        glm::vec3 position;
+        glm::vec3 direction;
+        float cosAngle { 0.0f };
+        float sinAngle { 1.0f };
+        float radius { 0.0f };
+        float farClip { 0.0f };
+    };
+
+    // largest angular size the sphere has from a view in the bucket that sees it, or -1 if none does
+    float computeAngularSize(const glm::vec3& center, float radius, float minAngularDiameter) const;
+
+    const EntityTreeSnapshot* _snapshot;
+    uint64_t _snapshotTimestamp;
+    std::vector<Frustum> _frustums;
+    float _lodScaleFactor { 1.0f };
+    float _positionSlack { 0.0f }; // distance from the center of the position cell to its corners
+
+    // 0 until computed
+    enum ElementVisibility : int8_t { Unknown = 0, Visible, Hidden };
+    mutable std::vector<std::atomic<int8_t>> _elementVisibility;
+    mutable std::vector<std::atomic<float>> _entityPriorities;
+};
+
+using EntityInterestSetsPointer = std::shared_ptr<EntityInterestSets>;
+
+/// Hands out the interest sets of the latest snapshot, one per view bucket, so that the send threads of the viewers in
+/// a bucket share them.
+class EntityInterestManager {
+public:
+    /// Returns the sets of the bucket of the view for the snapshot, or nullptr if the view doesn't use view frustums
+    EntityInterestSetsPointer getInterestSets(const EntityTreeSnapshotPointer& snapshot, const DiffTraversal::View& view);
+
+    int getNumBuckets() const;
+    uint64_t getNumRequests() const { return _numRequests; }
+    uint64_t getNumSharedRequests() const { return _numSharedRequests; }
+
+private:
+    mutable std::mutex _mutex;
+    const EntityTreeSnapshot* _snapshot { nullptr };
+    uint64_t _snapshotTimestamp { 0 };
+    std::map<EntityInterestSets::Key, EntityInterestSetsPointer> _interestSets;
+
+    std::atomic<uint64_t> _numRequests { 0 };
+    std::atomic<uint64_t> _numSharedRequests { 0 };
+};
+
+using EntityInterestManagerPointer = std::shared_ptr<EntityInterestManager>;
+
+#endif // hifi_EntityInterestSets_h
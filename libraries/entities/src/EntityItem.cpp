@@ -205,9 +205,31 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
         privateUserData = getPrivateUserData();
     }
 
+    // only a complete encode of all our properties can be cached or served from the cache,
+    // the bytes only differ between viewers by the private user data
+    bool isCompleteEncode = !(entityTreeElementExtraEncodeData && entityTreeElementExtraEncodeData->entities.contains(getEntityItemID()));
+    bool useEncodedDataCache = params.useEncodedDataCache && isCompleteEncode;
+    bool includesPrivateUserData = !privateUserData.isEmpty();
+    EncodedDataCacheKey encodedDataCacheKey;
+    if (useEncodedDataCache) {
+        encodedDataCacheKey = getEncodedDataCacheKey();
+        QByteArray cachedData = getCachedEncodedData(includesPrivateUserData, encodedDataCacheKey);
+        if (!cachedData.isEmpty()) {
+            LevelDetails cachedLevel = packetData->startLevel();
+            if (packetData->appendRawData(cachedData)) {
+                packetData->endLevel(cachedLevel);
+                params.trackSend(getID(), getLastEdited());
+                return OctreeElement::COMPLETED;
+            }
+            // it doesn't all fit, fall through to the regular encode that knows how to send part of the properties
+            packetData->discardLevel(cachedLevel);
+        }
+    }
+
     EntityPropertyFlags propertiesDidntFit = requestedProperties;
 
     LevelDetails entityLevel = packetData->startLevel();
+    int entityDataOffset = packetData->getUncompressedByteOffset();
 
     quint64 lastEdited = getLastEdited();
 
@@ -379,6 +401,12 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
         }
 
         packetData->endLevel(entityLevel);
+
+        if (useEncodedDataCache && appendState == OctreeElement::COMPLETED) {
+            int entityDataLength = packetData->getUncompressedByteOffset() - entityDataOffset;
+            setCachedEncodedData(includesPrivateUserData, encodedDataCacheKey,
+                QByteArray((const char*)packetData->getUncompressedData(entityDataOffset), entityDataLength));
+        }
     } else {
         packetData->discardLevel(entityLevel);
         appendState = OctreeElement::NONE; // if we got here, then we didn't include the item
@@ -1587,6 +1615,10 @@ bool EntityItem::setProperties(const EntityItemProperties& properties) {
         _created = timestamp;
     }
 
+    // not every property change moves our edit timestamps, so never serve the old bytes after an edit.
+    // This comes after the writes, an encode that raced with them can't be cached under the new generation.
+    invalidateEncodedDataCache();
+
     return somethingChanged;
 }
 
@@ -2599,9 +2631,12 @@ QList<EntityDynamicPointer> EntityItem::getActionsOfType(EntityDynamicType typeT
 
 void EntityItem::locationChanged(bool tellPhysics, bool tellChildren) {
     requiresRecalcBoxes();
+    EntityTreePointer tree = getTree();
+    if (tree) {
+        tree->entityBoundsChanged(getThisPointer());
+    }
     if (tellPhysics) {
         _flags |= Simulation::DIRTY_TRANSFORM;
-        EntityTreePointer tree = getTree();
         if (tree) {
             tree->entityChanged(getThisPointer());
         }
@@ -2614,6 +2649,10 @@ void EntityItem::locationChanged(bool tellPhysics, bool tellChildren) {
 
 void EntityItem::dimensionsChanged() {
     requiresRecalcBoxes();
+    EntityTreePointer tree = getTree();
+    if (tree) {
+        tree->entityBoundsChanged(getThisPointer());
+    }
     SpatiallyNestable::dimensionsChanged(); // Do what you have to do
     _boundingRadius = 0.5f * glm::length(getScaledDimensions());
     std::pair<int32_t, glm::vec4> data(_spaceIndex, glm::vec4(getWorldPosition(), _boundingRadius));
@@ -2729,6 +2768,41 @@ quint64 EntityItem::getLastChangedOnServer() const {
     return result;
 }
 
+bool EntityItem::EncodedDataCacheKey::operator==(const EncodedDataCacheKey& other) const {
+    return lastEdited == other.lastEdited && lastChangedOnServer == other.lastChangedOnServer &&
+        lastUpdated == other.lastUpdated && lastSimulated == other.lastSimulated && generation == other.generation;
+}
+
+EntityItem::EncodedDataCacheKey EntityItem::getEncodedDataCacheKey() const {
+    EncodedDataCacheKey key;
+    key.generation = _encodedDataGeneration;
+    withReadLock([&] {
+        key.lastEdited = _lastEdited;
+        key.lastChangedOnServer = _changedOnServer;
+        key.lastUpdated = _lastUpdated;
+        key.lastSimulated = _lastSimulated;
+    });
+    return key;
+}
+
+QByteArray EntityItem::getCachedEncodedData(bool includesPrivateUserData, const EncodedDataCacheKey& key) const {
+    std::lock_guard<std::mutex> lock(_encodedDataCacheMutex);
+    if (_encodedDataCacheKey[includesPrivateUserData] == key) {
+        return _encodedDataCache[includesPrivateUserData];
+    }
+    return QByteArray();
+}
+
+void EntityItem::setCachedEncodedData(bool includesPrivateUserData, const EncodedDataCacheKey& key, QByteArray data) const {
+    std::lock_guard<std::mutex> lock(_encodedDataCacheMutex);
+    if (key.generation != _encodedDataGeneration) {
+        // we were edited while encoding, the bytes may be part old and part new
+        return;
+    }
+    _encodedDataCacheKey[includesPrivateUserData] = key;
+    _encodedDataCache[includesPrivateUserData] = data;
+}
+
 void EntityItem::update(const quint64& now) {
     withWriteLock([&] {
         _lastUpdated = now;
@@ -13,6 +13,7 @@
 #define hifi_EntityItem_h
 
 #include <memory>
+#include <mutex>
 #include <stdint.h>
 
 #include <glm/glm.hpp>
@@ -133,6 +134,9 @@ public:
     void markAsChangedOnServer();
     quint64 getLastChangedOnServer() const;
 
+    /// forces the next appendEntityData() to re-encode all properties instead of using the cached bytes
+    void invalidateEncodedDataCache() { ++_encodedDataGeneration; }
+
     virtual EntityPropertyFlags getEntityProperties(EncodeBitstreamParams& params) const;
 
     virtual OctreeElement::AppendState appendEntityData(OctreePacketData* packetData, EncodeBitstreamParams& params,
@@ -769,6 +773,28 @@ protected:
 
     mutable bool _needsRenderUpdate { false };
 
+    // The entity server encodes the same entity for every viewer, so we keep the bytes of the last complete encode
+    // and reuse them as long as the edit timestamps and the generation are unchanged.
+    struct EncodedDataCacheKey {
+        quint64 lastEdited { 0 };
+        quint64 lastChangedOnServer { 0 };
+        quint64 lastUpdated { 0 };
+        quint64 lastSimulated { 0 };
+        uint32_t generation { 0 };
+
+        bool operator==(const EncodedDataCacheKey& other) const;
+    };
+    EncodedDataCacheKey getEncodedDataCacheKey() const;
+    QByteArray getCachedEncodedData(bool includesPrivateUserData, const EncodedDataCacheKey& key) const;
+    void setCachedEncodedData(bool includesPrivateUserData, const EncodedDataCacheKey& key, QByteArray data) const;
+
+    mutable std::mutex _encodedDataCacheMutex;
+    mutable QByteArray _encodedDataCache[2]; // indexed by whether private user data is included
+    mutable EncodedDataCacheKey _encodedDataCacheKey[2];
+    std::atomic<uint32_t> _encodedDataGeneration { 0 };
+
+    friend class EntityEncodedDataCacheTests;
+
 private:
     static std::function<glm::quat(const glm::vec3&, const glm::quat&, BillboardMode, const glm::vec3&)> _getBillboardRotationOperator;
     static std::function<glm::vec3()> _getPrimaryViewFrustumPositionOperator;
@@ -0,0 +1,68 @@
+//
+//  EntityPersistSnapshot.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPersistSnapshot.h"
+
+#include <QtScript/QScriptEngine>
+
+#include <Gzip.h>
+#include <udt/PacketHeaders.h>
+
+#include "EntitiesLogging.h"
+#include "EntityTree.h"
+#include "EntityTreeElement.h"
+#include "RecurseOctreeToJSONOperator.h"
+
+std::shared_ptr<EntityPersistSnapshot> EntityPersistSnapshot::take(const EntityTreePointer& tree, bool withBinarySnapshot) {
+    auto snapshot = std::make_shared<EntityPersistSnapshot>();
+    if (withBinarySnapshot) {
+        snapshot->_binarySnapshot.reset(new EntityBinarySnapshot::EncodedEntities());
+    }
+    tree->withReadLock([&] {
+        snapshot->_id = tree->getPersistID();
+        snapshot->_dataVersion = tree->getPersistDataVersion();
+        tree->recurseTreeWithOperation([&](const OctreeElementPointer& element, void*) {
+            std::static_pointer_cast<EntityTreeElement>(element)->forEachEntity([&](const EntityItemPointer& entity) {
+                snapshot->_entities.push_back(entity->getProperties());
+            });
+            return true;
+        });
+        if (snapshot->_binarySnapshot && !EntityBinarySnapshot::encode(tree, *snapshot->_binarySnapshot)) {
+            snapshot->_binarySnapshot.reset();
+        }
+    });
+    return snapshot;
+}
+
+bool EntityPersistSnapshot::toJSON(QByteArray* data, bool doGzip) const {
+    // the same document Octree::toJSONString makes of the tree
+    QString jsonString = Octree::jsonDocumentStart(_dataVersion, _id, versionForPacketType(PacketType::EntityData));
+
+    QScriptEngine scriptEngine;
+    RecurseOctreeToJSONOperator theOperator(nullptr, &scriptEngine, jsonString);
+    for (const auto& properties : _entities) {
+        theOperator.appendProperties(properties);
+    }
+    jsonString = theOperator.getJson() + Octree::jsonDocumentEnd();
+
+    if (doGzip) {
+        if (!gzip(jsonString.toUtf8(), *data, -1)) {
+            qCCritical(entities) << "Unable to gzip entity snapshot";
+            return false;
+        }
+    } else {
+        *data = jsonString.toUtf8();
+    }
+    return true;
+}
+
+bool EntityPersistSnapshot::writeBinarySnapshot(const QString& filename) const {
+    return _binarySnapshot && EntityBinarySnapshot::write(*_binarySnapshot, filename);
+}
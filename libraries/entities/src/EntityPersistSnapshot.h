@@ -0,0 +1,50 @@
+//
+//  EntityPersistSnapshot.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPersistSnapshot_h
+#define hifi_EntityPersistSnapshot_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QUuid>
+
+#include <Octree.h>
+
+#include "EntityBinarySnapshot.h"
+#include "EntityItemProperties.h"
+
+class EntityTree;
+using EntityTreePointer = std::shared_ptr<EntityTree>;
+
+/// The properties of every entity in a tree, as they were when the snapshot was taken, and optionally the entities
+/// encoded for the binary snapshot at the same time.
+///
+/// Copying and encoding them is all that happens under the tree's read lock, converting the properties to the JSON
+/// persist document and writing the files is left to whichever thread saves them. Both files get the persist data
+/// version of the tree when the snapshot was taken, which is how OctreePersistThread tells which one is newer.
+class EntityPersistSnapshot : public OctreePersistSnapshot {
+public:
+    /// Read locks the tree while copying it
+    static std::shared_ptr<EntityPersistSnapshot> take(const EntityTreePointer& tree, bool withBinarySnapshot = false);
+
+    virtual bool toJSON(QByteArray* data, bool doGzip = false) const override;
+    virtual bool writeBinarySnapshot(const QString& filename) const override;
+
+    size_t getNumEntities() const { return _entities.size(); }
+
+private:
+    QUuid _id;
+    int64_t _dataVersion { 0 };
+    std::vector<EntityItemProperties> _entities;
+    std::unique_ptr<EntityBinarySnapshot::EncodedEntities> _binarySnapshot;
+};
+
+#endif // hifi_EntityPersistSnapshot_h
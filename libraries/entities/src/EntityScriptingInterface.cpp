@@ -1302,6 +1302,51 @@ ParabolaToEntityIntersectionResult EntityScriptingInterface::evalParabolaInterse
     return result;
 }
 
+QVector<RayToEntityIntersectionResult> EntityScriptingInterface::evalRayIntersectionVectors(QVector<EntityRayQuery>& queries) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+
+    QVector<RayToEntityIntersectionResult> results(queries.size());
+    if (_entityTree && _entityTree->evalRayIntersections(queries, Octree::Lock)) {
+        for (int i = 0; i < queries.size(); ++i) {
+            const auto& query = queries[i];
+            auto& result = results[i];
+            result.entityID = query.entityID;
+            result.intersects = !query.entityID.isNull();
+            if (result.intersects) {
+                result.distance = query.distance;
+                result.face = query.face;
+                result.surfaceNormal = query.surfaceNormal;
+                result.extraInfo = query.extraInfo;
+                result.intersection = query.ray.origin + (query.ray.direction * query.distance);
+            }
+        }
+    }
+    return results;
+}
+
+QVector<ParabolaToEntityIntersectionResult> EntityScriptingInterface::evalParabolaIntersectionVectors(QVector<EntityParabolaQuery>& queries) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+
+    QVector<ParabolaToEntityIntersectionResult> results(queries.size());
+    if (_entityTree && _entityTree->evalParabolaIntersections(queries, Octree::Lock)) {
+        for (int i = 0; i < queries.size(); ++i) {
+            const auto& query = queries[i];
+            auto& result = results[i];
+            result.entityID = query.entityID;
+            result.intersects = !query.entityID.isNull();
+            if (result.intersects) {
+                result.distance = query.distance;
+                result.parabolicDistance = query.parabolicDistance;
+                result.face = query.face;
+                result.intersection = query.intersection;
+                result.surfaceNormal = query.surfaceNormal;
+                result.extraInfo = query.extraInfo;
+            }
+        }
+    }
+    return results;
+}
+
 bool EntityScriptingInterface::reloadServerScripts(const QUuid& entityID) {
     auto client = DependencyManager::get<EntityScriptClient>();
     return client->reloadServerScript(entityID);
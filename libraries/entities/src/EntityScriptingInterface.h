@@ -183,6 +183,9 @@ public:
         const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard);
     ParabolaToEntityIntersectionResult evalParabolaIntersectionVector(const PickParabola& parabola, PickFilter searchFilter,
         const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard);
+    // the same for a batch of picks at once, see EntityTree::evalRayIntersections
+    QVector<RayToEntityIntersectionResult> evalRayIntersectionVectors(QVector<EntityRayQuery>& queries);
+    QVector<ParabolaToEntityIntersectionResult> evalParabolaIntersectionVectors(QVector<EntityParabolaQuery>& queries);
 
     /**jsdoc
      * Gets the properties of multiple entities.
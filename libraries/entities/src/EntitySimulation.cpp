@@ -133,6 +133,8 @@ void EntitySimulation::sortEntitiesThatMoved() {
             prepareEntityForDelete(entity);
         } else {
             moveOperator.addEntityToMoveList(entity, newCube);
+            // the server saves where its simulation moved the entity to
+            _entityTree->trackPersistChange(entity->getEntityItemID());
             ++itemItr;
         }
     }
@@ -12,6 +12,7 @@
 #include "EntityTree.h"
 #include <QtCore/QDateTime>
 #include <QtCore/QQueue>
+#include <QtConcurrent/QtConcurrentMap>
 #include <openssl/err.h>
 #include <openssl/pem.h>
 #include <openssl/x509.h>
@@ -24,6 +25,7 @@
 #include <QtScript/QScriptEngine>
 
 #include <Extents.h>
+#include <OctreePersistLog.h>
 #include <PerfStat.h>
 #include <Profile.h>
 #include <AddressManager.h>
@@ -32,6 +34,8 @@
 #include "VariantMapToScriptValue.h"
 
 #include "AddEntityOperator.h"
+#include "EntityBinarySnapshot.h"
+#include "EntityPersistSnapshot.h"
 #include "UpdateEntityOperator.h"
 #include "QVariantGLM.h"
 #include "EntitiesLogging.h"
@@ -45,6 +49,60 @@ static const quint64 DELETED_ENTITIES_EXTRA_USECS_TO_CONSIDER = USECS_PER_MSEC *
 const float EntityTree::DEFAULT_MAX_TMP_ENTITY_LIFETIME = 60 * 60; // 1 hour
 static const QString DOMAIN_UNLIMITED = "domainUnlimited";
 
+// entities read from a document are added this many at a time, each batch under one write lock
+const int STREAMED_READ_BATCH_SIZE = 256;
+
+class EntityTree::StreamedRead {
+public:
+    int contentVersion { 0 };
+    QScriptEngine scriptEngine;
+    QVector<QPair<EntityItemID, EntityItemProperties>> batch;
+    QMap<QUuid, QVector<QUuid>> cloneIDs;
+    std::vector<EntityItemID> addedIDs;
+    int numEntities { 0 };
+    bool success { true };
+};
+
+class EntityTree::PreparedEdit : public PreparedOctreeEdit {
+public:
+    ~PreparedEdit() {
+        auto entityTree = tree.lock();
+        if (entityTree) {
+            entityTree->releasePreparedEdit(*this);
+        }
+    }
+
+    PacketType type { PacketType::Unknown };
+    bool isAdd { false };
+    bool isClone { false };
+    bool isPhysics { false };
+    bool decoded { false };
+    bool validated { false };
+    bool valid { false };
+    bool allowed { false };
+    bool suppressDisallowedClientScript { false };
+    bool suppressDisallowedServerScript { false };
+    bool suppressDisallowedPrivateUserData { false };
+
+    // an add the sender needs to hear was rejected, so that it doesn't keep an entity no one else sees
+    bool rejectedAdd { false };
+
+    EntityItemID entityItemID;
+    EntityItemID entityIDToClone;
+    EntityItemPointer existingEntity;
+    EntityItemPointer entityToClone;
+    // as they were decoded, every validation starts over from them
+    EntityItemProperties decodedProperties;
+    EntityItemProperties properties;
+
+    // set while the entities of the edit count as having an edit pending, see prepareEditPacketData
+    std::weak_ptr<EntityTree> tree;
+
+    quint64 decodeTime { 0 };
+    quint64 lookupTime { 0 };
+    quint64 filterTime { 0 };
+};
+
 EntityTree::EntityTree(bool shouldReaverage) :
     Octree(shouldReaverage)
 {
@@ -141,6 +199,7 @@ void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
     localMap.swap(_entityMap);
     this->withWriteLock([&] {
         foreach(EntityItemPointer entity, localMap) {
+            trackPersistChange(entity->getEntityItemID());
             EntityTreeElementPointer element = entity->getElement();
             if (element) {
                 element->cleanupEntities();
@@ -155,6 +214,14 @@ void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
         }
     });
     localMap.clear();
+    {
+        std::lock_guard<std::mutex> lock(_entitiesWithChangedBoundsMutex);
+        _entitiesWithChangedBounds.clear();
+    }
+    {
+        QWriteLocker locker(&_aabbTreeLock);
+        _aabbTree.clear();
+    }
     Octree::eraseAllOctreeElements(createNewRoot);
 
     resetClientEditStats();
@@ -303,6 +370,7 @@ void EntityTree::postAddEntity(EntityItemPointer entity) {
     }
 
     _isDirty = true;
+    trackPersistChange(entity->getEntityItemID());
 
     // find and hook up any entities with this entity as a (previously) missing parent
     fixupNeedsParentFixups();
@@ -365,10 +433,14 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
                 }
                 UpdateEntityOperator theOperator(getThisPointer(), containingElement, entity, queryCube);
                 recurseTreeWithOperator(&theOperator);
-                if (entity->setProperties(tempProperties)) {
+                bool changed = entity->setProperties(tempProperties);
+                // subclasses write their properties after EntityItem::setProperties bumped the generation
+                entity->invalidateEncodedDataCache();
+                if (changed) {
                     emit editingEntityPointer(entity);
                 }
                 _isDirty = true;
+                trackPersistChange(entity->getEntityItemID());
             }
         }
     } else {
@@ -462,7 +534,10 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
         }
         UpdateEntityOperator theOperator(getThisPointer(), containingElement, entity, newQueryAACube);
         recurseTreeWithOperator(&theOperator);
-        if (entity->setProperties(properties)) {
+        bool changed = entity->setProperties(properties);
+        // subclasses write their properties after EntityItem::setProperties bumped the generation
+        entity->invalidateEncodedDataCache();
+        if (changed) {
             emit editingEntityPointer(entity);
         }
 
@@ -504,6 +579,7 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
         }
 
         _isDirty = true;
+        trackPersistChange(entity->getEntityItemID());
 
         uint32_t newFlags = entity->getDirtyFlags() & ~preFlags;
         if (newFlags) {
@@ -582,6 +658,21 @@ EntityItemPointer EntityTree::addEntity(const EntityItemID& entityID, const Enti
     return result;
 }
 
+bool EntityTree::addDecodedEntity(const EntityItemPointer& entity) {
+    // NOTE: assume tree already write-locked
+    EntityTreeElementPointer containingElement = getContainingElement(entity->getEntityItemID());
+    if (containingElement) {
+        qCWarning(entities) << "EntityTree::addDecodedEntity() on existing entity item with entityID=" << entity->getEntityItemID()
+                          << "containingElement=" << containingElement.get();
+        return false;
+    }
+
+    AddEntityOperator theOperator(getThisPointer(), entity);
+    recurseTreeWithOperator(&theOperator);
+    postAddEntity(entity);
+    return true;
+}
+
 void EntityTree::emitEntityScriptChanging(const EntityItemID& entityItemID, bool reload) {
     emit entityScriptChanging(entityItemID, reload);
 }
@@ -634,6 +725,7 @@ void EntityTree::cleanupCloneIDs(const EntityItemID& entityID) {
             EntityItemPointer cloneOrigin = findEntityByID(cloneOriginID);
             if (cloneOrigin) {
                 cloneOrigin->removeCloneID(entityID);
+                trackPersistChange(cloneOriginID);
             }
         }
         // clear the clone origin ID on any clones that this entity had
@@ -642,6 +734,7 @@ void EntityTree::cleanupCloneIDs(const EntityItemID& entityID) {
             EntityItemPointer cloneChild = findEntityByEntityItemID(cloneChildID);
             if (cloneChild) {
                 cloneChild->setCloneOriginID(QUuid());
+                trackPersistChange(cloneChildID);
             }
         }
     }
@@ -742,6 +835,7 @@ void EntityTree::deleteEntitiesByPointer(const std::vector<EntityItemPointer>& e
     for (auto entity : entities) {
         if (entity->getElement()) {
             theOperator.addEntityToDeleteList(entity);
+            trackPersistChange(entity->getEntityItemID());
             emit deletingEntity(entity->getID());
             emit deletingEntityPointer(entity.get());
         }
@@ -754,6 +848,145 @@ void EntityTree::deleteEntitiesByPointer(const std::vector<EntityItemPointer>& e
     }
 }
 
+EntityTreeSnapshotPointer EntityTree::getSnapshot(uint64_t minRebuildInterval) {
+    uint64_t now = usecTimestampNow();
+    auto snapshot = std::atomic_load(&_snapshot);
+    if (snapshot && now < _lastSnapshotCheck + minRebuildInterval) {
+        return snapshot;
+    }
+
+    // only one caller rebuilds, the others keep using the current snapshot in the meantime
+    std::unique_lock<std::mutex> buildLock(_snapshotBuildMutex, std::defer_lock);
+    if (snapshot) {
+        if (!buildLock.try_lock()) {
+            return snapshot;
+        }
+    } else {
+        buildLock.lock();
+    }
+
+    // somebody else might have just published a new one
+    snapshot = std::atomic_load(&_snapshot);
+    if (snapshot && now < _lastSnapshotCheck + minRebuildInterval) {
+        return snapshot;
+    }
+
+    withReadLock([&] {
+        EntityTreeElementPointer root = getRoot();
+        // edits mark the whole path up to the root as changed
+        if (!snapshot || root->getLastChanged() >= snapshot->getTimestamp() ||
+            root->getLastChangedContent() >= snapshot->getTimestamp()) {
+            snapshot = EntityTreeSnapshot::build(root, usecTimestampNow());
+        }
+    });
+
+    _lastSnapshotCheck = now;
+    std::atomic_store(&_snapshot, snapshot);
+    return snapshot;
+}
+
+void EntityTree::trackPersistChange(const EntityItemID& entityID) {
+    if (_trackPersistChanges) {
+        std::lock_guard<std::mutex> lock(_persistChangesMutex);
+        _persistChanges.insert(entityID);
+    }
+}
+
+void EntityTree::writePersistChanges(OctreePersistLog& log) {
+    QSet<EntityItemID> changes;
+    {
+        std::lock_guard<std::mutex> lock(_persistChangesMutex);
+        changes.swap(_persistChanges);
+    }
+    if (changes.isEmpty()) {
+        return;
+    }
+
+    // each record holds the entity as it is now, so several edits since the last time only make for one record
+    QScriptEngine scriptEngine;
+    withReadLock([&] {
+        for (const auto& entityID : changes) {
+            OctreePersistLogRecord record;
+            record.id = entityID;
+            EntityItemPointer entity = findEntityByEntityItemID(entityID);
+            if (entity) {
+                record.type = OctreePersistLogRecord::Upsert;
+                QScriptValue properties = EntityItemNonDefaultPropertiesToScriptValue(&scriptEngine, entity->getProperties());
+                record.data = QJsonDocument::fromVariant(properties.toVariant()).toJson(QJsonDocument::Compact);
+            } else {
+                record.type = OctreePersistLogRecord::Delete;
+            }
+            log.append(record);
+        }
+    });
+}
+
+bool EntityTree::replayPersistLogRecord(const OctreePersistLogRecord& record) {
+    // NOTE: assume tree already write-locked, this is only called while loading
+    EntityItemID entityID(record.id);
+    EntityItemPointer existingEntity = findEntityByEntityItemID(entityID);
+
+    if (record.type == OctreePersistLogRecord::Delete) {
+        if (existingEntity) {
+            deleteEntity(entityID, true);
+        }
+        return true;
+    }
+
+    QVariantMap entityMap = QJsonDocument::fromJson(record.data).toVariant().toMap();
+    if (entityMap.isEmpty()) {
+        qCWarning(entities) << "Invalid entity log record for" << entityID;
+        return false;
+    }
+
+    QScriptEngine scriptEngine;
+    EntityItemProperties properties;
+    if (existingEntity) {
+        // the record holds the complete entity, any property it doesn't list is back to its default
+        properties.markAllChanged();
+    }
+    EntityItemPropertiesFromScriptValueIgnoreReadOnly(variantMapToScriptValue(entityMap, scriptEngine), properties);
+
+    if (!existingEntity) {
+        EntityItemPointer entity = addEntity(entityID, properties);
+        if (!entity) {
+            qCDebug(entities) << "adding Entity from log failed:" << entityID << properties.getType();
+        }
+        return (bool)entity;
+    }
+
+    EntityTreeElementPointer containingElement = existingEntity->getElement();
+    AACube newQueryAACube = properties.queryAACubeChanged() ? properties.getQueryAACube() : existingEntity->getQueryAACube();
+    UpdateEntityOperator theOperator(getThisPointer(), containingElement, existingEntity, newQueryAACube);
+    recurseTreeWithOperator(&theOperator);
+    existingEntity->setProperties(properties);
+    // subclasses write their properties after EntityItem::setProperties bumped the generation
+    existingEntity->invalidateEncodedDataCache();
+    _isDirty = true;
+    return true;
+}
+
+OctreePersistSnapshotPointer EntityTree::takePersistSnapshot(bool withBinarySnapshot) {
+    return EntityPersistSnapshot::take(getThisPointer(), withBinarySnapshot);
+}
+
+bool EntityTree::writeBinarySnapshot(const QString& filename) {
+    return EntityBinarySnapshot::write(getThisPointer(), filename);
+}
+
+bool EntityTree::readBinarySnapshotInfo(const QString& filename, QUuid& id, int64_t& dataVersion) const {
+    qint64 version;
+    if (!EntityBinarySnapshot::readInfo(filename, id, version)) {
+        return false;
+    }
+    dataVersion = version;
+    return true;
+}
+
+bool EntityTree::readBinarySnapshot(const QString& filename) {
+    return EntityBinarySnapshot::read(getThisPointer(), filename);
+}
+
 void EntityTree::processRemovedEntities(const DeleteEntityOperator& theOperator) {
     // NOTE: assume tree already write-locked because this method only called in deleteEntitiesByPointer()
     quint64 deletedAt = usecTimestampNow();
@@ -761,6 +994,9 @@ void EntityTree::processRemovedEntities(const DeleteEntityOperator& theOperator)
     foreach(const EntityToDeleteDetails& details, entities) {
         EntityItemPointer theEntity = details.entity;
         if (getIsServer()) {
+            // snapshots taken before the delete may still reference the entity, this lets their readers skip it
+            theEntity->die();
+
             removeCertifiedEntityOnServer(theEntity);
 
             // set up the deleted entities ID
@@ -816,6 +1052,7 @@ bool evalRayIntersectionOp(const OctreeElementPointer& element, void* extraData)
         args->entityIdsToDiscard, args->searchFilter, args->extraInfo);
     if (!entityID.isNull()) {
         args->entityID = entityID;
+        args->element = element;
         // We recurse OctreeElements in order, so if we hit something, we can stop immediately
         keepSearching = false;
     }
@@ -848,6 +1085,26 @@ EntityItemID EntityTree::evalRayIntersection(const glm::vec3& origin, const glm:
                                     PickFilter searchFilter, OctreeElementPointer& element, float& distance,
                                     BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
                                     Octree::lockType lockType, bool* accurateResult) {
+    EntityItemID entityID;
+    distance = FLT_MAX;
+
+    bool requireLock = lockType == Octree::Lock;
+    bool lockResult = withReadLock([&]{
+        entityID = evalRayIntersectionWorker(origin, direction, entityIdsToInclude, entityIdsToDiscard, searchFilter,
+            element, distance, face, surfaceNormal, extraInfo);
+    }, requireLock);
+
+    if (accurateResult) {
+        *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
+    }
+
+    return entityID;
+}
+
+EntityItemID EntityTree::evalRayIntersectionWorker(const glm::vec3& origin, const glm::vec3& direction,
+                                    const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+                                    PickFilter searchFilter, OctreeElementPointer& element, float& distance,
+                                    BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo) {
 
     // calculate dirReciprocal like this rather than with glm's scalar / vec3 template to avoid NaNs.
     vec3 dirReciprocal = glm::vec3(direction.x == 0.0f ? 0.0f : 1.0f / direction.x,
@@ -857,15 +1114,30 @@ EntityItemID EntityTree::evalRayIntersection(const glm::vec3& origin, const glm:
             searchFilter, element, distance, face, surfaceNormal, extraInfo, EntityItemID() };
     distance = FLT_MAX;
 
-    bool requireLock = lockType == Octree::Lock;
-    bool lockResult = withReadLock([&]{
+    if (!_useAABBTree) {
         recurseTreeWithOperationSorted(evalRayIntersectionOp, evalRayIntersectionSortingOp, &args);
-    }, requireLock);
-
-    if (accurateResult) {
-        *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
+        return args.entityID;
     }
 
+    updateAABBTree();
+    QReadLocker locker(&_aabbTreeLock);
+    _aabbTree.findEntitiesByDistance([&](const AABox& box, float& boxDistance) {
+        if (box.contains(origin)) {
+            boxDistance = 0.0f;
+            return true;
+        }
+        BoxFace boxFace;
+        glm::vec3 boxNormal;
+        return box.findRayIntersection(origin, direction, dirReciprocal, boxDistance, boxFace, boxNormal);
+    }, FLT_MAX, [&](const EntityItemPointer& entity, float& maxDistance) {
+        if (EntityTreeElement::evalEntityRayIntersection(entity, origin, direction, element, distance, face,
+                surfaceNormal, entityIdsToInclude, entityIdsToDiscard, searchFilter, extraInfo)) {
+            args.entityID = entity->getEntityItemID();
+            // the element that holds the entity, as the octree search gives
+            element = entity->getElement();
+            maxDistance = distance;
+        }
+    });
     return args.entityID;
 }
 
@@ -897,6 +1169,7 @@ bool evalParabolaIntersectionOp(const OctreeElementPointer& element, void* extra
         args->entityIdsToDiscard, args->searchFilter, args->extraInfo);
     if (!entityID.isNull()) {
         args->entityID = entityID;
+        args->element = element;
         // We recurse OctreeElements in order, so if we hit something, we can stop immediately
         keepSearching = false;
     }
@@ -930,28 +1203,115 @@ EntityItemID EntityTree::evalParabolaIntersection(const PickParabola& parabola,
                                     OctreeElementPointer& element, glm::vec3& intersection, float& distance, float& parabolicDistance,
                                     BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
                                     Octree::lockType lockType, bool* accurateResult) {
-    ParabolaArgs args = { parabola.origin, parabola.velocity, parabola.acceleration, entityIdsToInclude, entityIdsToDiscard,
-        searchFilter, element, parabolicDistance, face, surfaceNormal, extraInfo, EntityItemID() };
+    EntityItemID entityID;
     parabolicDistance = FLT_MAX;
     distance = FLT_MAX;
 
     bool requireLock = lockType == Octree::Lock;
     bool lockResult = withReadLock([&] {
-        recurseTreeWithOperationSorted(evalParabolaIntersectionOp, evalParabolaIntersectionSortingOp, &args);
+        entityID = evalParabolaIntersectionWorker(parabola, entityIdsToInclude, entityIdsToDiscard, searchFilter,
+            element, parabolicDistance, face, surfaceNormal, extraInfo);
     }, requireLock);
 
     if (accurateResult) {
         *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
     }
 
-    if (!args.entityID.isNull()) {
+    if (!entityID.isNull()) {
         intersection = parabola.origin + parabola.velocity * parabolicDistance + 0.5f * parabola.acceleration * parabolicDistance * parabolicDistance;
         distance = glm::distance(intersection, parabola.origin);
     }
 
+    return entityID;
+}
+
+EntityItemID EntityTree::evalParabolaIntersectionWorker(const PickParabola& parabola,
+                                    const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+                                    PickFilter searchFilter, OctreeElementPointer& element, float& parabolicDistance,
+                                    BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo) {
+    ParabolaArgs args = { parabola.origin, parabola.velocity, parabola.acceleration, entityIdsToInclude, entityIdsToDiscard,
+        searchFilter, element, parabolicDistance, face, surfaceNormal, extraInfo, EntityItemID() };
+    parabolicDistance = FLT_MAX;
+
+    if (!_useAABBTree) {
+        recurseTreeWithOperationSorted(evalParabolaIntersectionOp, evalParabolaIntersectionSortingOp, &args);
+        return args.entityID;
+    }
+
+    updateAABBTree();
+    glm::vec3 normal = EntityTreeElement::getParabolaPlaneNormal(parabola.velocity, parabola.acceleration);
+    QReadLocker locker(&_aabbTreeLock);
+    _aabbTree.findEntitiesByDistance([&](const AABox& box, float& boxDistance) {
+        if (box.contains(parabola.origin)) {
+            boxDistance = 0.0f;
+            return true;
+        }
+        BoxFace boxFace;
+        glm::vec3 boxNormal;
+        return box.findParabolaIntersection(parabola.origin, parabola.velocity, parabola.acceleration, boxDistance,
+            boxFace, boxNormal);
+    }, FLT_MAX, [&](const EntityItemPointer& entity, float& maxDistance) {
+        if (EntityTreeElement::evalEntityParabolaIntersection(entity, parabola.origin, parabola.velocity,
+                parabola.acceleration, normal, element, parabolicDistance, face, surfaceNormal, entityIdsToInclude,
+                entityIdsToDiscard, searchFilter, extraInfo)) {
+            args.entityID = entity->getEntityItemID();
+            element = entity->getElement();
+            maxDistance = parabolicDistance;
+        }
+    });
     return args.entityID;
 }
 
+// below this many picks per thread the batch isn't worth splitting
+static const int MIN_PICKS_PER_THREAD = 4;
+
+template <typename Q, typename F>
+static void evalQueries(QVector<Q>& queries, F evalQuery) {
+    if (queries.size() < 2 * MIN_PICKS_PER_THREAD) {
+        for (auto& query : queries) {
+            evalQuery(query);
+        }
+    } else {
+        // the calling thread works on the batch too, so this never waits on a busy pool
+        QtConcurrent::blockingMap(queries, evalQuery);
+    }
+}
+
+bool EntityTree::evalRayIntersections(QVector<EntityRayQuery>& queries, Octree::lockType lockType) {
+    PROFILE_RANGE(picks, "EntityTree::evalRayIntersections");
+    return withReadLock([&] {
+        // bring the index up to date once rather than have every pick of the batch race for it
+        if (_useAABBTree) {
+            updateAABBTree();
+        }
+        evalQueries(queries, [this](EntityRayQuery& query) {
+            query.entityID = evalRayIntersectionWorker(query.ray.origin, query.ray.direction, query.entityIdsToInclude,
+                query.entityIdsToDiscard, query.searchFilter, query.element, query.distance, query.face,
+                query.surfaceNormal, query.extraInfo);
+        });
+    }, lockType == Octree::Lock);
+}
+
+bool EntityTree::evalParabolaIntersections(QVector<EntityParabolaQuery>& queries, Octree::lockType lockType) {
+    PROFILE_RANGE(picks, "EntityTree::evalParabolaIntersections");
+    return withReadLock([&] {
+        if (_useAABBTree) {
+            updateAABBTree();
+        }
+        evalQueries(queries, [this](EntityParabolaQuery& query) {
+            const PickParabola& parabola = query.parabola;
+            query.entityID = evalParabolaIntersectionWorker(parabola, query.entityIdsToInclude, query.entityIdsToDiscard,
+                query.searchFilter, query.element, query.parabolicDistance, query.face, query.surfaceNormal,
+                query.extraInfo);
+            if (!query.entityID.isNull()) {
+                float t = query.parabolicDistance;
+                query.intersection = parabola.origin + parabola.velocity * t + 0.5f * parabola.acceleration * t * t;
+                query.distance = glm::distance(query.intersection, parabola.origin);
+            }
+        });
+    }, lockType == Octree::Lock);
+}
+
 class FindClosestEntityArgs {
 public:
     // Inputs
@@ -1001,6 +1361,26 @@ bool evalClosestEntityOperation(const OctreeElementPointer& element, void* extra
 
 // NOTE: assumes caller has handled locking
 QUuid EntityTree::evalClosestEntity(const glm::vec3& position, float targetRadius, PickFilter searchFilter) {
+    if (_useAABBTree) {
+        QUuid closestEntity;
+        float closestDistanceSquared = FLT_MAX;
+        float targetRadiusSquared = targetRadius * targetRadius;
+        AABox bounds(position - glm::vec3(targetRadius), glm::vec3(2.0f * targetRadius));
+        findEntitiesInAABBTree([&](const AABox& box) {
+            return box.touches(bounds);
+        }, [&](const EntityItemPointer& entity) {
+            if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+                return;
+            }
+            float distanceSquared = glm::distance2(position, entity->getWorldPosition());
+            if (distanceSquared <= targetRadiusSquared && distanceSquared < closestDistanceSquared) {
+                closestEntity = entity->getID();
+                closestDistanceSquared = distanceSquared;
+            }
+        });
+        return closestEntity;
+    }
+
     FindClosestEntityArgs args = { position, targetRadius, searchFilter, QUuid(), FLT_MAX };
     recurseTreeWithOperation(evalClosestEntityOperation, &args);
     return args.closestEntity;
@@ -1035,6 +1415,20 @@ bool evalInSphereOperation(const OctreeElementPointer& element, void* extraData)
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphere(const glm::vec3& center, float radius, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    if (_useAABBTree) {
+        QVector<QUuid> entities;
+        findEntitiesInAABBTree([&](const AABox& box) {
+            return box.touchesSphere(center, radius);
+        }, [&](const EntityItemPointer& entity) {
+            if (EntityTreeElement::checkFilterSettings(entity, searchFilter) &&
+                    EntityTreeElement::checkSphereIntersection(entity, center, radius)) {
+                entities.push_back(entity->getID());
+            }
+        });
+        foundEntities.swap(entities);
+        return;
+    }
+
     FindEntitiesInSphereArgs args = { center, radius, searchFilter, QVector<QUuid>() };
     recurseTreeWithOperation(evalInSphereOperation, &args);
     foundEntities.swap(args.entities);
@@ -1070,6 +1464,20 @@ bool evalInSphereWithTypeOperation(const OctreeElementPointer& element, void* ex
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphereWithType(const glm::vec3& center, float radius, EntityTypes::EntityType type, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    if (_useAABBTree) {
+        QVector<QUuid> entities;
+        findEntitiesInAABBTree([&](const AABox& box) {
+            return box.touchesSphere(center, radius);
+        }, [&](const EntityItemPointer& entity) {
+            if (EntityTreeElement::checkFilterSettings(entity, searchFilter) && type == entity->getType() &&
+                    EntityTreeElement::checkSphereIntersection(entity, center, radius)) {
+                entities.push_back(entity->getID());
+            }
+        });
+        foundEntities.swap(entities);
+        return;
+    }
+
     FindEntitiesInSphereWithTypeArgs args = { center, radius, type, searchFilter, QVector<QUuid>() };
     recurseTreeWithOperation(evalInSphereWithTypeOperation, &args);
     foundEntities.swap(args.entities);
@@ -1106,6 +1514,26 @@ bool evalInSphereWithNameOperation(const OctreeElementPointer& element, void* ex
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphereWithName(const glm::vec3& center, float radius, const QString& name, bool caseSensitive, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    if (_useAABBTree) {
+        QVector<QUuid> entities;
+        findEntitiesInAABBTree([&](const AABox& box) {
+            return box.touchesSphere(center, radius);
+        }, [&](const EntityItemPointer& entity) {
+            if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+                return;
+            }
+            QString entityName = entity->getName();
+            if ((caseSensitive && name != entityName) || (!caseSensitive && name.toLower() != entityName.toLower())) {
+                return;
+            }
+            if (EntityTreeElement::checkSphereIntersection(entity, center, radius)) {
+                entities.push_back(entity->getID());
+            }
+        });
+        foundEntities.swap(entities);
+        return;
+    }
+
     FindEntitiesInSphereWithNameArgs args = { center, radius, name, caseSensitive, searchFilter, QVector<QUuid>() };
     recurseTreeWithOperation(evalInSphereWithNameOperation, &args);
     foundEntities.swap(args.entities);
@@ -1133,6 +1561,11 @@ bool findInCubeOperation(const OctreeElementPointer& element, void* extraData) {
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInCube(const AACube& cube, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    if (_useAABBTree) {
+        evalEntitiesInBox(AABox(cube), searchFilter, foundEntities);
+        return;
+    }
+
     FindEntitiesInCubeArgs args { cube, searchFilter, QVector<QUuid>() };
     recurseTreeWithOperation(findInCubeOperation, &args);
     foundEntities.swap(args.entities);
@@ -1160,6 +1593,24 @@ bool findInBoxOperation(const OctreeElementPointer& element, void* extraData) {
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInBox(const AABox& box, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    if (_useAABBTree) {
+        QVector<QUuid> entities;
+        findEntitiesInAABBTree([&](const AABox& nodeBox) {
+            return nodeBox.touches(box);
+        }, [&](const EntityItemPointer& entity) {
+            if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+                return;
+            }
+            bool success;
+            AABox entityBox = entity->getAABox(success);
+            if (success && entityBox.touches(box)) {
+                entities.push_back(entity->getID());
+            }
+        });
+        foundEntities.swap(entities);
+        return;
+    }
+
     FindEntitiesInBoxArgs args { box, searchFilter, QVector<QUuid>() };
     // NOTE: This should use recursion, since this is a spatial operation
     recurseTreeWithOperation(findInBoxOperation, &args);
@@ -1189,6 +1640,24 @@ bool findInFrustumOperation(const OctreeElementPointer& element, void* extraData
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInFrustum(const ViewFrustum& frustum, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
+    if (_useAABBTree) {
+        QVector<QUuid> entities;
+        findEntitiesInAABBTree([&](const AABox& box) {
+            return frustum.boxIntersectsFrustum(box) || frustum.boxIntersectsKeyhole(box);
+        }, [&](const EntityItemPointer& entity) {
+            if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+                return;
+            }
+            bool success;
+            AABox entityBox = entity->getAABox(success);
+            if (success && (frustum.boxIntersectsFrustum(entityBox) || frustum.boxIntersectsKeyhole(entityBox))) {
+                entities.push_back(entity->getID());
+            }
+        });
+        foundEntities.swap(entities);
+        return;
+    }
+
     FindEntitiesInFrustumArgs args = { frustum, searchFilter, QVector<QUuid>() };
     // NOTE: This should use recursion, since this is a spatial operation
     recurseTreeWithOperation(findInFrustumOperation, &args);
@@ -1196,6 +1665,78 @@ void EntityTree::evalEntitiesInFrustum(const ViewFrustum& frustum, PickFilter se
     foundEntities.swap(args.entities);
 }
 
+void EntityTree::setUseAABBTree(bool useAABBTree) {
+    {
+        QWriteLocker locker(&_aabbTreeLock);
+        _aabbTree.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_entitiesWithChangedBoundsMutex);
+        _entitiesWithChangedBounds.clear();
+    }
+    _useAABBTree = useAABBTree;
+
+    if (useAABBTree) {
+        // the entities already in the tree are inserted by the next query
+        QReadLocker locker(&_entityMapLock);
+        for (const auto& entity : _entityMap) {
+            if (entity->getElement()) {
+                entityBoundsChanged(entity);
+            }
+        }
+    }
+    qCDebug(entities) << "Entity queries use the" << (useAABBTree ? "AABB tree" : "octree");
+}
+
+void EntityTree::entityBoundsChanged(const EntityItemPointer& entity) {
+    if (_useAABBTree && entity) {
+        std::lock_guard<std::mutex> lock(_entitiesWithChangedBoundsMutex);
+        _entitiesWithChangedBounds.insert(entity.get(), entity);
+    }
+}
+
+int EntityTree::getAABBTreeHeight() const {
+    QReadLocker locker(&_aabbTreeLock);
+    return _aabbTree.getHeight();
+}
+
+void EntityTree::updateAABBTree() {
+    QHash<const EntityItem*, EntityItemWeakPointer> entitiesWithChangedBounds;
+    {
+        std::lock_guard<std::mutex> lock(_entitiesWithChangedBoundsMutex);
+        if (_entitiesWithChangedBounds.isEmpty()) {
+            return;
+        }
+        entitiesWithChangedBounds.swap(_entitiesWithChangedBounds);
+    }
+
+    QWriteLocker locker(&_aabbTreeLock);
+    for (auto itr = entitiesWithChangedBounds.cbegin(); itr != entitiesWithChangedBounds.cend(); ++itr) {
+        EntityItemPointer entity = itr.value().lock();
+        // entities that left the tree are only dropped from the index here, so that the octree moving an entity to
+        // another element (removing and adding it) doesn't cost a removal and an insertion
+        if (!entity || !entity->getElement()) {
+            _aabbTree.remove(itr.key());
+            continue;
+        }
+
+        // the maximum cube doesn't change when the entity rotates, so spinning entities don't touch the tree
+        bool success;
+        AACube bounds = entity->getMaximumAACube(success);
+        if (success) {
+            _aabbTree.update(entity, AABox(bounds));
+        } else {
+            _aabbTree.remove(itr.key());
+        }
+    }
+}
+
+void EntityTree::findEntitiesInAABBTree(const EntityAABBTree::BoxTest& test, const EntityAABBTree::EntityVisitor& visitor) {
+    updateAABBTree();
+    QReadLocker locker(&_aabbTreeLock);
+    _aabbTree.findEntities(test, visitor);
+}
+
 EntityItemPointer EntityTree::findEntityByID(const QUuid& id) const {
     EntityItemID entityID(id);
     return findEntityByEntityItemID(entityID);
@@ -1771,6 +2312,18 @@ void EntityTree::processChallengeOwnershipPacket(ReceivedMessage& message, const
 }
 
 // NOTE: Caller must lock the tree before calling this.
+bool EntityTree::preparesEditPacketType(PacketType packetType) const {
+    switch (packetType) {
+        case PacketType::EntityAdd:
+        case PacketType::EntityClone:
+        case PacketType::EntityEdit:
+        case PacketType::EntityPhysics:
+            return true;
+        default:
+            return false;
+    }
+}
+
 int EntityTree::processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                      const SharedNodePointer& senderNode) {
     if (!getIsServer()) {
@@ -1779,8 +2332,6 @@ int EntityTree::processEditPacketData(ReceivedMessage& message, const unsigned c
     }
 
     int processedBytes = 0;
-    bool isAdd = false;
-    bool isClone = false;
     // we handle these types of "edit" packets
     switch (message.getType()) {
         case PacketType::EntityErase: {
@@ -1790,312 +2341,421 @@ int EntityTree::processEditPacketData(ReceivedMessage& message, const unsigned c
         }
 
         case PacketType::EntityClone:
-            isClone = true; // fall through to next case
-            // FALLTHRU
         case PacketType::EntityAdd:
-            isAdd = true;  // fall through to next case
-            // FALLTHRU
         case PacketType::EntityPhysics:
         case PacketType::EntityEdit: {
-            quint64 startDecode = 0, endDecode = 0;
-            quint64 startLookup = 0, endLookup = 0;
-            quint64 startUpdate = 0, endUpdate = 0;
-            quint64 startCreate = 0, endCreate = 0;
-            quint64 startFilter = 0, endFilter = 0;
-            quint64 startLogging = 0, endLogging = 0;
-
-            bool suppressDisallowedClientScript = false;
-            bool suppressDisallowedServerScript = false;
-            bool suppressDisallowedPrivateUserData = false;
-            bool isPhysics = message.getType() == PacketType::EntityPhysics;
-
-            _totalEditMessages++;
-
-            EntityItemID entityItemID;
-            EntityItemProperties properties;
-            startDecode = usecTimestampNow();
-
-            bool validEditPacket = false;
-            EntityItemID entityIDToClone;
-            EntityItemPointer entityToClone;
-            if (isClone) {
-                QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
-                validEditPacket = EntityItemProperties::decodeCloneEntityMessage(buffer, processedBytes, entityIDToClone, entityItemID);
-                if (validEditPacket) {
-                    entityToClone = findEntityByEntityItemID(entityIDToClone);
-                    if (entityToClone) {
-                        properties = entityToClone->getProperties();
-                    }
-                }
-            } else {
-                validEditPacket = EntityItemProperties::decodeEntityEditPacket(editData, maxLength, processedBytes, entityItemID, properties);
+            auto edit = prepareEditPacketData(message, editData, maxLength, senderNode, processedBytes);
+            if (edit) {
+                applyPreparedEdit(*edit, senderNode);
             }
+            break;
+        }
 
-            endDecode = usecTimestampNow();
-
-            EntityItemPointer existingEntity;
-            if (!isAdd) {
-                // search for the entity by EntityItemID
-                startLookup = usecTimestampNow();
-                existingEntity = findEntityByEntityItemID(entityItemID);
-                endLookup = usecTimestampNow();
-                if (!existingEntity) {
-                    // this is not an add-entity operation, and we don't know about the identified entity.
-                    validEditPacket = false;
-                }
-            }
+        default:
+            processedBytes = 0;
+            break;
+    }
+    return processedBytes;
+}
 
-            if (validEditPacket && !_entityScriptSourceWhitelist.isEmpty()) {
+PreparedOctreeEditPointer EntityTree::prepareEditPacketData(ReceivedMessage& message, const unsigned char* editData,
+        int maxLength, const SharedNodePointer& senderNode, int& bytesRead) {
+    bytesRead = 0;
+    if (!getIsServer()) {
+        qCWarning(entities) << "EntityTree::prepareEditPacketData() should only be called on a server tree.";
+        return nullptr;
+    }
+    if (!preparesEditPacketType(message.getType())) {
+        return nullptr;
+    }
 
-                bool wasDeletedBecauseOfClientScript = false;
+    // this runs under the tree's read lock at most, so it may only look entities up and read them
+    auto edit = new PreparedEdit();
+    PreparedOctreeEditPointer result { edit };
 
-                // check the client entity script to make sure its URL is in the whitelist
-                if (!properties.getScript().isEmpty()) {
-                    bool clientScriptPassedWhitelist = isScriptInWhitelist(properties.getScript());
+    edit->type = message.getType();
+    edit->isClone = edit->type == PacketType::EntityClone;
+    edit->isAdd = edit->isClone || edit->type == PacketType::EntityAdd;
+    edit->isPhysics = edit->type == PacketType::EntityPhysics;
 
-                    if (!clientScriptPassedWhitelist) {
-                        if (wantEditLogging()) {
-                            qCDebug(entities) << "User [" << senderNode->getUUID()
-                                << "] attempting to set entity script not on whitelist, edit rejected";
-                        }
+    quint64 startDecode = usecTimestampNow();
+    if (edit->isClone) {
+        QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
+        edit->decoded = EntityItemProperties::decodeCloneEntityMessage(buffer, bytesRead, edit->entityIDToClone,
+                                                                       edit->entityItemID);
+    } else {
+        edit->decoded = EntityItemProperties::decodeEntityEditPacket(editData, maxLength, bytesRead, edit->entityItemID,
+                                                                     edit->decodedProperties);
+    }
+    edit->decodeTime = usecTimestampNow() - startDecode;
 
-                        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
-                        if (isAdd) {
-                            QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                            _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                            validEditPacket = false;
-                            wasDeletedBecauseOfClientScript = true;
-                        } else {
-                            suppressDisallowedClientScript = true;
-                        }
-                    }
-                }
+    if (edit->decoded) {
+        // An edit prepared earlier, and not applied yet, changes what this one gets checked and filtered against.
+        // So this one waits for the tree lock, when the entities are as the edits before it left them.
+        if (!holdPreparedEdit(*edit)) {
+            withReadLock([&] {
+                validatePreparedEdit(*edit, senderNode, true);
+            });
+        }
+    }
+    return result;
+}
 
-                // check all server entity scripts to make sure their URLs are in the whitelist
-                if (!properties.getServerScripts().isEmpty()) {
-                    bool serverScriptPassedWhitelist = isScriptInWhitelist(properties.getServerScripts());
+// Counts the edit as pending for its entities, true if one of them already had an edit pending
+bool EntityTree::holdPreparedEdit(PreparedEdit& edit) {
+    std::lock_guard<std::mutex> lock(_preparedEditsMutex);
+    bool hadPendingEdit = _preparedEditCounts.contains(edit.entityItemID) ||
+        (edit.isClone && _preparedEditCounts.contains(edit.entityIDToClone));
+    ++_preparedEditCounts[edit.entityItemID];
+    if (edit.isClone) {
+        ++_preparedEditCounts[edit.entityIDToClone];
+    }
+    edit.tree = getThisPointer();
+    return hadPendingEdit;
+}
 
-                    if (!serverScriptPassedWhitelist) {
-                        if (wantEditLogging()) {
-                            qCDebug(entities) << "User [" << senderNode->getUUID()
-                                << "] attempting to set server entity script not on whitelist, edit rejected";
-                        }
+void EntityTree::releasePreparedEdit(PreparedEdit& edit) {
+    if (edit.tree.expired()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_preparedEditsMutex);
+    auto release = [&](const EntityItemID& entityID) {
+        auto count = _preparedEditCounts.find(entityID);
+        if (count != _preparedEditCounts.end() && --count.value() <= 0) {
+            _preparedEditCounts.erase(count);
+        }
+    };
+    release(edit.entityItemID);
+    if (edit.isClone) {
+        release(edit.entityIDToClone);
+    }
+    edit.tree.reset();
+}
+
+// Looks up the entities the edit refers to, then runs the permission checks and edit filters on it. With deferIfMissing
+// it gives up, without side effects, when one of those entities isn't in the tree: an edit received just before it
+// could still add it, so it gets validated again with the tree locked.
+bool EntityTree::validatePreparedEdit(PreparedEdit& edit, const SharedNodePointer& senderNode, bool deferIfMissing) {
+    bool isAdd = edit.isAdd;
+    bool isClone = edit.isClone;
+    bool isPhysics = edit.isPhysics;
+    EntityItemID& entityItemID = edit.entityItemID;
+    EntityItemProperties& properties = edit.properties;
+    EntityItemPointer& existingEntity = edit.existingEntity;
+
+    // an edit validated again starts from what was decoded, not from what the last validation left
+    properties = edit.decodedProperties;
+    existingEntity.reset();
+    edit.entityToClone.reset();
+    edit.suppressDisallowedClientScript = false;
+    edit.suppressDisallowedServerScript = false;
+    edit.suppressDisallowedPrivateUserData = false;
+    edit.rejectedAdd = false;
+    edit.allowed = false;
+
+    bool validEditPacket = true;
+    quint64 startLookup = usecTimestampNow();
+    if (isClone) {
+        edit.entityToClone = findEntityByEntityItemID(edit.entityIDToClone);
+        if (edit.entityToClone) {
+            properties = edit.entityToClone->getProperties();
+        } else if (deferIfMissing) {
+            return false;
+        }
+    }
 
-                        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
-                        if (isAdd) {
-                            // Make sure we didn't already need to send back a delete because the client script failed
-                            // the whitelist check
-                            if (!wasDeletedBecauseOfClientScript) {
-                                QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                                _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                                validEditPacket = false;
-                            }
-                        } else {
-                            suppressDisallowedServerScript = true;
-                        }
-                    }
-                }
+    if (!isAdd) {
+        // search for the entity by EntityItemID
+        existingEntity = findEntityByEntityItemID(entityItemID);
+        if (!existingEntity) {
+            if (deferIfMissing) {
+                return false;
             }
+            // this is not an add-entity operation, and we don't know about the identified entity.
+            validEditPacket = false;
+        }
+    }
+    edit.lookupTime = usecTimestampNow() - startLookup;
+
+    if (validEditPacket && !_entityScriptSourceWhitelist.isEmpty()) {
 
-            if (!properties.getPrivateUserData().isEmpty() && validEditPacket && !senderNode->getCanGetAndSetPrivateUserData()) {
+        bool wasDeletedBecauseOfClientScript = false;
+
+        // check the client entity script to make sure its URL is in the whitelist
+        if (!properties.getScript().isEmpty()) {
+            bool clientScriptPassedWhitelist = isScriptInWhitelist(properties.getScript());
+
+            if (!clientScriptPassedWhitelist) {
                 if (wantEditLogging()) {
                     qCDebug(entities) << "User [" << senderNode->getUUID()
-                        << "] is attempting to set private user data but user isn't allowed; edit rejected...";
+                        << "] attempting to set entity script not on whitelist, edit rejected";
                 }
 
                 // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
                 if (isAdd) {
-                    QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                    _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
+                    edit.rejectedAdd = true;
                     validEditPacket = false;
+                    wasDeletedBecauseOfClientScript = true;
                 } else {
-                    suppressDisallowedPrivateUserData = true;
+                    edit.suppressDisallowedClientScript = true;
                 }
             }
+        }
 
-            if (!isClone) {
-                if ((isAdd || properties.lifetimeChanged()) &&
-                    ((!senderNode->getCanRez() && senderNode->getCanRezTmp()) ||
-                    (!senderNode->getCanRezCertified() && senderNode->getCanRezTmpCertified()))) {
-                    // this node is only allowed to rez temporary entities.  if need be, cap the lifetime.
-                    if (properties.getLifetime() == ENTITY_ITEM_IMMORTAL_LIFETIME ||
-                        properties.getLifetime() > _maxTmpEntityLifetime) {
-                        properties.setLifetime(_maxTmpEntityLifetime);
-                        bumpTimestamp(properties);
-                    }
+        // check all server entity scripts to make sure their URLs are in the whitelist
+        if (!properties.getServerScripts().isEmpty()) {
+            bool serverScriptPassedWhitelist = isScriptInWhitelist(properties.getServerScripts());
+
+            if (!serverScriptPassedWhitelist) {
+                if (wantEditLogging()) {
+                    qCDebug(entities) << "User [" << senderNode->getUUID()
+                        << "] attempting to set server entity script not on whitelist, edit rejected";
                 }
 
-                if (isAdd && properties.getLocked() && !senderNode->isAllowedEditor()) {
-                    // if a node can't change locks, don't allow it to create an already-locked entity -- automatically
-                    // clear the locked property and allow the unlocked entity to be created.
-                    properties.setLocked(false);
-                    bumpTimestamp(properties);
+                // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
+                if (isAdd) {
+                    // Make sure we didn't already need to send back a delete because the client script failed
+                    // the whitelist check
+                    if (!wasDeletedBecauseOfClientScript) {
+                        edit.rejectedAdd = true;
+                        validEditPacket = false;
+                    }
+                } else {
+                    edit.suppressDisallowedServerScript = true;
                 }
             }
+        }
+    }
 
-            // If we got a valid edit packet, then it could be a new entity or it could be an update to
-            // an existing entity... handle appropriately
-            if (validEditPacket) {
-                startFilter = usecTimestampNow();
-                bool wasChanged = false;
-                // Having (un)lock rights bypasses the filter, unless it's a physics result.
-                FilterType filterType = isPhysics ? FilterType::Physics : (isAdd ? FilterType::Add : FilterType::Edit);
-                bool allowed = (!isPhysics && senderNode->isAllowedEditor()) || filterProperties(existingEntity, properties, properties, wasChanged, filterType);
-                if (!allowed) {
-                    // the update failed and we need to convey that fact to the sender
-                    // our method is to re-assert the current properties and bump the lastEdited timestamp
-                    auto timestamp = properties.getLastEdited();
-                    properties = EntityItemProperties();
-                    properties.setLastEdited(timestamp);
-                }
-                if (!allowed || wasChanged) {
-                    bumpTimestamp(properties);
-                    // For now, free ownership on any modification.
-                    properties.clearSimulationOwner();
-                }
-                endFilter = usecTimestampNow();
+    if (!properties.getPrivateUserData().isEmpty() && validEditPacket && !senderNode->getCanGetAndSetPrivateUserData()) {
+        if (wantEditLogging()) {
+            qCDebug(entities) << "User [" << senderNode->getUUID()
+                << "] is attempting to set private user data but user isn't allowed; edit rejected...";
+        }
 
-                if (existingEntity && !isAdd) {
+        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
+        if (isAdd) {
+            edit.rejectedAdd = true;
+            validEditPacket = false;
+        } else {
+            edit.suppressDisallowedPrivateUserData = true;
+        }
+    }
 
-                    if (suppressDisallowedClientScript) {
-                        bumpTimestamp(properties);
-                        properties.setScript(existingEntity->getScript());
-                    }
+    if (!isClone) {
+        if ((isAdd || properties.lifetimeChanged()) &&
+            ((!senderNode->getCanRez() && senderNode->getCanRezTmp()) ||
+            (!senderNode->getCanRezCertified() && senderNode->getCanRezTmpCertified()))) {
+            // this node is only allowed to rez temporary entities.  if need be, cap the lifetime.
+            if (properties.getLifetime() == ENTITY_ITEM_IMMORTAL_LIFETIME ||
+                properties.getLifetime() > _maxTmpEntityLifetime) {
+                properties.setLifetime(_maxTmpEntityLifetime);
+                bumpTimestamp(properties);
+            }
+        }
 
-                    if (suppressDisallowedServerScript) {
-                        bumpTimestamp(properties);
-                        properties.setServerScripts(existingEntity->getServerScripts());
-                    }
+        if (isAdd && properties.getLocked() && !senderNode->isAllowedEditor()) {
+            // if a node can't change locks, don't allow it to create an already-locked entity -- automatically
+            // clear the locked property and allow the unlocked entity to be created.
+            properties.setLocked(false);
+            bumpTimestamp(properties);
+        }
+    }
+
+    if (validEditPacket) {
+        quint64 startFilter = usecTimestampNow();
+        bool wasChanged = false;
+        // Having (un)lock rights bypasses the filter, unless it's a physics result.
+        FilterType filterType = isPhysics ? FilterType::Physics : (isAdd ? FilterType::Add : FilterType::Edit);
+        bool allowed = (!isPhysics && senderNode->isAllowedEditor()) || filterProperties(existingEntity, properties, properties, wasChanged, filterType);
+        if (!allowed) {
+            // the update failed and we need to convey that fact to the sender
+            // our method is to re-assert the current properties and bump the lastEdited timestamp
+            auto timestamp = properties.getLastEdited();
+            properties = EntityItemProperties();
+            properties.setLastEdited(timestamp);
+        }
+        if (!allowed || wasChanged) {
+            bumpTimestamp(properties);
+            // For now, free ownership on any modification.
+            properties.clearSimulationOwner();
+        }
+        edit.allowed = allowed;
+        edit.filterTime = usecTimestampNow() - startFilter;
+    }
+
+    edit.valid = validEditPacket;
+    edit.validated = true;
+    return true;
+}
 
-                    if (suppressDisallowedPrivateUserData) {
-                        bumpTimestamp(properties);
-                        properties.setPrivateUserData(existingEntity->getPrivateUserData());
+void EntityTree::applyPreparedEdit(PreparedOctreeEdit& preparedEdit, const SharedNodePointer& senderNode) {
+    PreparedEdit& edit = static_cast<PreparedEdit&>(preparedEdit);
+
+    quint64 startUpdate = 0, endUpdate = 0;
+    quint64 startCreate = 0, endCreate = 0;
+    quint64 startLogging = 0, endLogging = 0;
+
+    bool isAdd = edit.isAdd;
+    bool isClone = edit.isClone;
+    bool isPhysics = edit.isPhysics;
+    bool allowed = edit.allowed;
+    const EntityItemID& entityItemID = edit.entityItemID;
+    const EntityItemID& entityIDToClone = edit.entityIDToClone;
+    const EntityItemPointer& entityToClone = edit.entityToClone;
+    EntityItemProperties& properties = edit.properties;
+
+    if (edit.decoded && (!edit.validated ||
+                         (edit.existingEntity && findEntityByEntityItemID(entityItemID) != edit.existingEntity))) {
+        // it waited for the edits before it, or an entity it refers to was added or deleted since it was prepared
+        validatePreparedEdit(edit, senderNode, false);
+    }
+    releasePreparedEdit(edit);
+    const EntityItemPointer& existingEntity = edit.existingEntity;
+
+    if (edit.rejectedAdd) {
+        QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+        _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
+    }
+
+    _totalEditMessages++;
+
+    // If we got a valid edit packet, then it could be a new entity or it could be an update to
+    // an existing entity... handle appropriately
+    if (edit.valid) {
+        if (existingEntity && !isAdd) {
+
+            if (edit.suppressDisallowedClientScript) {
+                bumpTimestamp(properties);
+                properties.setScript(existingEntity->getScript());
+            }
+
+            if (edit.suppressDisallowedServerScript) {
+                bumpTimestamp(properties);
+                properties.setServerScripts(existingEntity->getServerScripts());
+            }
+
+            if (edit.suppressDisallowedPrivateUserData) {
+                bumpTimestamp(properties);
+                properties.setPrivateUserData(existingEntity->getPrivateUserData());
+            }
+
+            // if the EntityItem exists, then update it
+            startLogging = usecTimestampNow();
+            if (wantEditLogging()) {
+                qCDebug(entities) << "User [" << senderNode->getUUID() << "] editing entity. ID:" << entityItemID;
+                qCDebug(entities) << "   properties:" << properties;
+            }
+            if (wantTerseEditLogging()) {
+                QList<QString> changedProperties = properties.listChangedProperties();
+                fixupTerseEditLogging(properties, changedProperties);
+                qCDebug(entities) << senderNode->getUUID() << "edit" <<
+                    existingEntity->getDebugName() << changedProperties;
+            }
+            endLogging = usecTimestampNow();
+
+            startUpdate = usecTimestampNow();
+            if (!isPhysics) {
+                properties.setLastEditedBy(senderNode->getUUID());
+            }
+            updateEntity(existingEntity, properties, senderNode);
+            existingEntity->markAsChangedOnServer();
+            endUpdate = usecTimestampNow();
+            _totalUpdates++;
+        } else if (isAdd) {
+            bool failedAdd = !allowed;
+            bool isCertified = !properties.getCertificateID().isEmpty();
+            bool isCloneable = properties.getCloneable();
+            int cloneLimit = properties.getCloneLimit();
+            if (!allowed) {
+                qCDebug(entities) << "Filtered entity add. ID:" << entityItemID;
+            } else if (!isClone && !isCertified && !senderNode->getCanRez() && !senderNode->getCanRezTmp()) {
+                failedAdd = true;
+                qCDebug(entities) << "User without 'uncertified rez rights' [" << senderNode->getUUID()
+                    << "] attempted to add an uncertified entity with ID:" << entityItemID;
+            } else if (!isClone && isCertified && !senderNode->getCanRezCertified() && !senderNode->getCanRezTmpCertified()) {
+                failedAdd = true;
+                qCDebug(entities) << "User without 'certified rez rights' [" << senderNode->getUUID()
+                    << "] attempted to add a certified entity with ID:" << entityItemID;
+            } else if (isClone && isCertified && !properties.getCertificateType().contains(DOMAIN_UNLIMITED)) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone certified entity from entity ID:" << entityIDToClone;
+            } else if (isClone && !isCloneable) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone non-cloneable entity from entity ID:" << entityIDToClone;
+            } else if (isClone && entityToClone && entityToClone->getCloneIDs().size() >= cloneLimit && cloneLimit != 0) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone entity ID:" << entityIDToClone << " which reached it's cloneable limit.";
+            } else {
+                if (isClone) {
+                    properties.convertToCloneProperties(entityIDToClone);
+                }
+
+                // this is a new entity... assign a new entityID
+                properties.setLastEditedBy(senderNode->getUUID());
+                startCreate = usecTimestampNow();
+                EntityItemPointer newEntity = addEntity(entityItemID, properties);
+                endCreate = usecTimestampNow();
+                _totalCreates++;
+
+                if (newEntity && isCertified && getIsServer()) {
+                    if (!properties.verifyStaticCertificateProperties()) {
+                        qCDebug(entities) << "User" << senderNode->getUUID()
+                            << "attempted to add a certified entity with ID" << entityItemID << "which failed"
+                            << "static certificate verification.";
+                        // Delete the entity we just added if it doesn't pass static certificate verification
+                        deleteEntity(entityItemID, true);
+                    } else {
+                        validatePop(properties.getCertificateID(), entityItemID, senderNode);
                     }
+                }
 
-                    // if the EntityItem exists, then update it
+                if (newEntity && isClone) {
+                    entityToClone->addCloneID(newEntity->getEntityItemID());
+                    newEntity->setCloneOriginID(entityIDToClone);
+                    trackPersistChange(entityToClone->getEntityItemID());
+                    trackPersistChange(newEntity->getEntityItemID());
+                }
+
+                if (newEntity) {
+                    newEntity->markAsChangedOnServer();
+                    notifyNewlyCreatedEntity(*newEntity, senderNode);
+                    
                     startLogging = usecTimestampNow();
                     if (wantEditLogging()) {
-                        qCDebug(entities) << "User [" << senderNode->getUUID() << "] editing entity. ID:" << entityItemID;
+                        qCDebug(entities) << "User [" << senderNode->getUUID() << "] added entity. ID:"
+                                          << newEntity->getEntityItemID();
                         qCDebug(entities) << "   properties:" << properties;
                     }
                     if (wantTerseEditLogging()) {
                         QList<QString> changedProperties = properties.listChangedProperties();
                         fixupTerseEditLogging(properties, changedProperties);
-                        qCDebug(entities) << senderNode->getUUID() << "edit" <<
-                            existingEntity->getDebugName() << changedProperties;
+                        qCDebug(entities) << senderNode->getUUID() << "add" << entityItemID << changedProperties;
                     }
                     endLogging = usecTimestampNow();
 
-                    startUpdate = usecTimestampNow();
-                    if (!isPhysics) {
-                        properties.setLastEditedBy(senderNode->getUUID());
-                    }
-                    updateEntity(existingEntity, properties, senderNode);
-                    existingEntity->markAsChangedOnServer();
-                    endUpdate = usecTimestampNow();
-                    _totalUpdates++;
-                } else if (isAdd) {
-                    bool failedAdd = !allowed;
-                    bool isCertified = !properties.getCertificateID().isEmpty();
-                    bool isCloneable = properties.getCloneable();
-                    int cloneLimit = properties.getCloneLimit();
-                    if (!allowed) {
-                        qCDebug(entities) << "Filtered entity add. ID:" << entityItemID;
-                    } else if (!isClone && !isCertified && !senderNode->getCanRez() && !senderNode->getCanRezTmp()) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User without 'uncertified rez rights' [" << senderNode->getUUID()
-                            << "] attempted to add an uncertified entity with ID:" << entityItemID;
-                    } else if (!isClone && isCertified && !senderNode->getCanRezCertified() && !senderNode->getCanRezTmpCertified()) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User without 'certified rez rights' [" << senderNode->getUUID()
-                            << "] attempted to add a certified entity with ID:" << entityItemID;
-                    } else if (isClone && isCertified && !properties.getCertificateType().contains(DOMAIN_UNLIMITED)) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone certified entity from entity ID:" << entityIDToClone;
-                    } else if (isClone && !isCloneable) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone non-cloneable entity from entity ID:" << entityIDToClone;
-                    } else if (isClone && entityToClone && entityToClone->getCloneIDs().size() >= cloneLimit && cloneLimit != 0) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone entity ID:" << entityIDToClone << " which reached it's cloneable limit.";
-                    } else {
-                        if (isClone) {
-                            properties.convertToCloneProperties(entityIDToClone);
-                        }
-
-                        // this is a new entity... assign a new entityID
-                        properties.setLastEditedBy(senderNode->getUUID());
-                        startCreate = usecTimestampNow();
-                        EntityItemPointer newEntity = addEntity(entityItemID, properties);
-                        endCreate = usecTimestampNow();
-                        _totalCreates++;
-
-                        if (newEntity && isCertified && getIsServer()) {
-                            if (!properties.verifyStaticCertificateProperties()) {
-                                qCDebug(entities) << "User" << senderNode->getUUID()
-                                    << "attempted to add a certified entity with ID" << entityItemID << "which failed"
-                                    << "static certificate verification.";
-                                // Delete the entity we just added if it doesn't pass static certificate verification
-                                deleteEntity(entityItemID, true);
-                            } else {
-                                validatePop(properties.getCertificateID(), entityItemID, senderNode);
-                            }
-                        }
-
-                        if (newEntity && isClone) {
-                            entityToClone->addCloneID(newEntity->getEntityItemID());
-                            newEntity->setCloneOriginID(entityIDToClone);
-                        }
-
-                        if (newEntity) {
-                            newEntity->markAsChangedOnServer();
-                            notifyNewlyCreatedEntity(*newEntity, senderNode);
-                            
-                            startLogging = usecTimestampNow();
-                            if (wantEditLogging()) {
-                                qCDebug(entities) << "User [" << senderNode->getUUID() << "] added entity. ID:"
-                                                  << newEntity->getEntityItemID();
-                                qCDebug(entities) << "   properties:" << properties;
-                            }
-                            if (wantTerseEditLogging()) {
-                                QList<QString> changedProperties = properties.listChangedProperties();
-                                fixupTerseEditLogging(properties, changedProperties);
-                                qCDebug(entities) << senderNode->getUUID() << "add" << entityItemID << changedProperties;
-                            }
-                            endLogging = usecTimestampNow();
-
-                        } else {
-                            failedAdd = true;
-                            qCDebug(entities) << "Add entity failed ID:" << entityItemID;
-                        }
-                    }
-                    if (failedAdd) { // Let client know it failed, so that they don't have an entity that no one else sees.
-                        QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                        _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                    }
                 } else {
-                    HIFI_FCDEBUG(entities(), "Edit failed. [" << message.getType() <<"] " <<
-                            "entity id:" << entityItemID << 
-                            "existingEntity pointer:" << existingEntity.get());
+                    failedAdd = true;
+                    qCDebug(entities) << "Add entity failed ID:" << entityItemID;
                 }
             }
-
-
-            _totalDecodeTime += endDecode - startDecode;
-            _totalLookupTime += endLookup - startLookup;
-            _totalUpdateTime += endUpdate - startUpdate;
-            _totalCreateTime += endCreate - startCreate;
-            _totalLoggingTime += endLogging - startLogging;
-            _totalFilterTime += endFilter - startFilter;
-
-            break;
+            if (failedAdd) { // Let client know it failed, so that they don't have an entity that no one else sees.
+                QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+                _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
+            }
+        } else {
+            HIFI_FCDEBUG(entities(), "Edit failed. [" << edit.type <<"] " <<
+                    "entity id:" << entityItemID << 
+                    "existingEntity pointer:" << existingEntity.get());
         }
-
-        default:
-            processedBytes = 0;
-            break;
     }
-    return processedBytes;
+
+    _totalDecodeTime += edit.decodeTime;
+    _totalLookupTime += edit.lookupTime;
+    _totalUpdateTime += endUpdate - startUpdate;
+    _totalCreateTime += endCreate - startCreate;
+    _totalLoggingTime += endLogging - startLogging;
+    _totalFilterTime += edit.filterTime;
 }
 
 
@@ -2904,196 +3564,259 @@ void convertGrabUserDataToProperties(EntityItemProperties& properties) {
 
 
 bool EntityTree::readFromMap(QVariantMap& map) {
+    if (!beginStreamedRead(map)) {
+        return false;
+    }
+
+    // map will have a top-level list keyed as "Entities".  This will be extracted
+    // and iterated over.  Each member of this list is converted to a QVariantMap, then
+    // to a QScriptValue, and then to EntityItemProperties.  These properties are used
+    // to add the new entity to the EntityTree.
+    QVariantList entitiesQList = map["Entities"].toList();
+    foreach (QVariant entityVariant, entitiesQList) {
+        QVariantMap entityMap = entityVariant.toMap();
+        readStreamedEntity(entityMap);
+    }
+
+    return endStreamedRead();
+}
+
+bool EntityTree::beginStreamedRead(const QVariantMap& map) {
+    _streamedRead.reset(new StreamedRead());
+
     // These are needed to deal with older content (before adding inheritance modes)
-    int contentVersion = map["Version"].toInt();
+    _streamedRead->contentVersion = map.value("Version").toInt();
 
     if (map.contains("Id")) {
-        _persistID = map["Id"].toUuid();
+        _persistID = map.value("Id").toUuid();
     }
 
     if (map.contains("DataVersion")) {
-        _persistDataVersion = map["DataVersion"].toInt();
+        _persistDataVersion = map.value("DataVersion").toInt();
     }
 
     _namedPaths.clear();
     if (map.contains("Paths")) {
-        QVariantMap namedPathsMap = map["Paths"].toMap();
+        QVariantMap namedPathsMap = map.value("Paths").toMap();
         for(QVariantMap::const_iterator iter = namedPathsMap.begin(); iter != namedPathsMap.end(); ++iter) {
             QString namedPathName = iter.key();
             QString namedPathViewPoint = iter.value().toString();
             _namedPaths[namedPathName] = namedPathViewPoint;
         }
     }
+    return true;
+}
 
-    // map will have a top-level list keyed as "Entities".  This will be extracted
-    // and iterated over.  Each member of this list is converted to a QVariantMap, then
-    // to a QScriptValue, and then to EntityItemProperties.  These properties are used
-    // to add the new entity to the EntityTree.
-    QVariantList entitiesQList = map["Entities"].toList();
-    QScriptEngine scriptEngine;
-
-    if (entitiesQList.length() == 0) {
-        // Empty map or invalidly formed file.
+bool EntityTree::readStreamedEntity(QVariantMap& entityMap) {
+    if (!_streamedRead) {
         return false;
     }
 
-    QMap<QUuid, QVector<QUuid>> cloneIDs;
+    // QVariantMap --> QScriptValue --> EntityItemProperties, the entity gets added with the rest of its batch
 
-    bool success = true;
-    foreach (QVariant entityVariant, entitiesQList) {
-        // QVariantMap --> QScriptValue --> EntityItemProperties --> Entity
-        QVariantMap entityMap = entityVariant.toMap();
+    // handle parentJointName for wearables
+    if (_myAvatar && entityMap.contains("parentJointName") && entityMap.contains("parentID") &&
+        QUuid(entityMap["parentID"].toString()) == AVATAR_SELF_ID) {
 
-        // handle parentJointName for wearables
-        if (_myAvatar && entityMap.contains("parentJointName") && entityMap.contains("parentID") &&
-            QUuid(entityMap["parentID"].toString()) == AVATAR_SELF_ID) {
+        entityMap["parentJointIndex"] = _myAvatar->getJointIndex(entityMap["parentJointName"].toString());
 
-            entityMap["parentJointIndex"] = _myAvatar->getJointIndex(entityMap["parentJointName"].toString());
+        qCDebug(entities) << "Found parentJointName " << entityMap["parentJointName"].toString() <<
+            " mapped it to parentJointIndex " << entityMap["parentJointIndex"].toInt();
+    }
+
+    QScriptValue entityScriptValue = variantMapToScriptValue(entityMap, _streamedRead->scriptEngine);
+    EntityItemProperties properties;
+    EntityItemPropertiesFromScriptValueIgnoreReadOnly(entityScriptValue, properties);
+
+    EntityItemID entityItemID;
+    if (entityMap.contains("id")) {
+        entityItemID = EntityItemID(QUuid(entityMap["id"].toString()));
+    } else {
+        entityItemID = EntityItemID(QUuid::createUuid());
+    }
 
-            qCDebug(entities) << "Found parentJointName " << entityMap["parentJointName"].toString() <<
-                " mapped it to parentJointIndex " << entityMap["parentJointIndex"].toInt();
+    // Convert old clientOnly bool to new entityHostType enum
+    // (must happen before setOwningAvatarID below)
+    if (_streamedRead->contentVersion < (int)EntityVersion::EntityHostTypes) {
+        if (entityMap.contains("clientOnly")) {
+            properties.setEntityHostType(entityMap["clientOnly"].toBool() ? entity::HostType::AVATAR : entity::HostType::DOMAIN);
         }
+    }
 
-        QScriptValue entityScriptValue = variantMapToScriptValue(entityMap, scriptEngine);
-        EntityItemProperties properties;
-        EntityItemPropertiesFromScriptValueIgnoreReadOnly(entityScriptValue, properties);
+    if (properties.getEntityHostType() == entity::HostType::AVATAR) {
+        auto nodeList = DependencyManager::get<NodeList>();
+        const QUuid myNodeID = nodeList->getSessionUUID();
+        properties.setOwningAvatarID(myNodeID);
+    }
 
-        EntityItemID entityItemID;
-        if (entityMap.contains("id")) {
-            entityItemID = EntityItemID(QUuid(entityMap["id"].toString()));
-        } else {
-            entityItemID = EntityItemID(QUuid::createUuid());
+    // Fix for older content not containing mode fields in the zones
+    if (_streamedRead->contentVersion < (int)EntityVersion::ZoneLightInheritModes && (properties.getType() == EntityTypes::EntityType::Zone)) {
+        // The legacy version had no keylight mode - this is set to on
+        properties.setKeyLightMode(COMPONENT_MODE_ENABLED);
+
+        // The ambient URL has been moved from "keyLight" to "ambientLight"
+        if (entityMap.contains("keyLight")) {
+            QVariantMap keyLightObject = entityMap["keyLight"].toMap();
+            properties.getAmbientLight().setAmbientURL(keyLightObject["ambientURL"].toString());
         }
 
-        // Convert old clientOnly bool to new entityHostType enum
-        // (must happen before setOwningAvatarID below)
-        if (contentVersion < (int)EntityVersion::EntityHostTypes) {
-            if (entityMap.contains("clientOnly")) {
-                properties.setEntityHostType(entityMap["clientOnly"].toBool() ? entity::HostType::AVATAR : entity::HostType::DOMAIN);
+        // Copy the skybox URL if the ambient URL is empty, as this is the legacy behaviour
+        // Use skybox value only if it is not empty, else set ambientMode to inherit (to use default URL)
+        properties.setAmbientLightMode(COMPONENT_MODE_ENABLED);
+        if (properties.getAmbientLight().getAmbientURL() == "") {
+            if (properties.getSkybox().getURL() != "") {
+                properties.getAmbientLight().setAmbientURL(properties.getSkybox().getURL());
+            } else {
+                properties.setAmbientLightMode(COMPONENT_MODE_INHERIT);
             }
         }
 
-        if (properties.getEntityHostType() == entity::HostType::AVATAR) {
-            auto nodeList = DependencyManager::get<NodeList>();
-            const QUuid myNodeID = nodeList->getSessionUUID();
-            properties.setOwningAvatarID(myNodeID);
+        // The background should be enabled if the mode is skybox
+        // Note that if the values are default then they are not stored in the JSON file
+        if (entityMap.contains("backgroundMode") && (entityMap["backgroundMode"].toString() == "skybox")) {
+            properties.setSkyboxMode(COMPONENT_MODE_ENABLED);
+        } else {
+            properties.setSkyboxMode(COMPONENT_MODE_INHERIT);
         }
+    }
 
-        // Fix for older content not containing mode fields in the zones
-        if (contentVersion < (int)EntityVersion::ZoneLightInheritModes && (properties.getType() == EntityTypes::EntityType::Zone)) {
-            // The legacy version had no keylight mode - this is set to on
-            properties.setKeyLightMode(COMPONENT_MODE_ENABLED);
+    // Convert old materials so that they use materialData instead of userData
+    if (_streamedRead->contentVersion < (int)EntityVersion::MaterialData && properties.getType() == EntityTypes::EntityType::Material) {
+        if (properties.getMaterialURL().startsWith("userData")) {
+            QString materialURL = properties.getMaterialURL();
+            properties.setMaterialURL(materialURL.replace("userData", "materialData"));
 
-            // The ambient URL has been moved from "keyLight" to "ambientLight"
-            if (entityMap.contains("keyLight")) {
-                QVariantMap keyLightObject = entityMap["keyLight"].toMap();
-                properties.getAmbientLight().setAmbientURL(keyLightObject["ambientURL"].toString());
+            QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
+            QJsonObject materialData;
+            QJsonValue materialVersion = userData["materialVersion"];
+            if (!materialVersion.isNull()) {
+                materialData.insert("materialVersion", materialVersion);
+                userData.remove("materialVersion");
             }
-
-            // Copy the skybox URL if the ambient URL is empty, as this is the legacy behaviour
-            // Use skybox value only if it is not empty, else set ambientMode to inherit (to use default URL)
-            properties.setAmbientLightMode(COMPONENT_MODE_ENABLED);
-            if (properties.getAmbientLight().getAmbientURL() == "") {
-                if (properties.getSkybox().getURL() != "") {
-                    properties.getAmbientLight().setAmbientURL(properties.getSkybox().getURL());
-                } else {
-                    properties.setAmbientLightMode(COMPONENT_MODE_INHERIT);
-                }
+            QJsonValue materials = userData["materials"];
+            if (!materials.isNull()) {
+                materialData.insert("materials", materials);
+                userData.remove("materials");
             }
 
-            // The background should be enabled if the mode is skybox
-            // Note that if the values are default then they are not stored in the JSON file
-            if (entityMap.contains("backgroundMode") && (entityMap["backgroundMode"].toString() == "skybox")) {
-                properties.setSkyboxMode(COMPONENT_MODE_ENABLED);
-            } else {
-                properties.setSkyboxMode(COMPONENT_MODE_INHERIT);
-            }
+            properties.setMaterialData(QJsonDocument(materialData).toJson());
+            properties.setUserData(QJsonDocument(userData).toJson());
         }
+    }
 
-        // Convert old materials so that they use materialData instead of userData
-        if (contentVersion < (int)EntityVersion::MaterialData && properties.getType() == EntityTypes::EntityType::Material) {
-            if (properties.getMaterialURL().startsWith("userData")) {
-                QString materialURL = properties.getMaterialURL();
-                properties.setMaterialURL(materialURL.replace("userData", "materialData"));
+    // Convert old cloneable entities so they use cloneableData instead of userData
+    if (_streamedRead->contentVersion < (int)EntityVersion::CloneableData) {
+        QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
+        QJsonObject grabbableKey = userData["grabbableKey"].toObject();
+        QJsonValue cloneable = grabbableKey["cloneable"];
+        if (cloneable.isBool() && cloneable.toBool()) {
+            QJsonValue cloneLifetime = grabbableKey["cloneLifetime"];
+            QJsonValue cloneLimit = grabbableKey["cloneLimit"];
+            QJsonValue cloneDynamic = grabbableKey["cloneDynamic"];
+            QJsonValue cloneAvatarEntity = grabbableKey["cloneAvatarEntity"];
 
-                QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
-                QJsonObject materialData;
-                QJsonValue materialVersion = userData["materialVersion"];
-                if (!materialVersion.isNull()) {
-                    materialData.insert("materialVersion", materialVersion);
-                    userData.remove("materialVersion");
-                }
-                QJsonValue materials = userData["materials"];
-                if (!materials.isNull()) {
-                    materialData.insert("materials", materials);
-                    userData.remove("materials");
-                }
-
-                properties.setMaterialData(QJsonDocument(materialData).toJson());
-                properties.setUserData(QJsonDocument(userData).toJson());
-            }
+            // This is cloneable, we need to convert the properties
+            properties.setCloneable(true);
+            properties.setCloneLifetime(cloneLifetime.toInt());
+            properties.setCloneLimit(cloneLimit.toInt());
+            properties.setCloneDynamic(cloneDynamic.toBool());
+            properties.setCloneAvatarEntity(cloneAvatarEntity.toBool());
         }
+    }
 
-        // Convert old cloneable entities so they use cloneableData instead of userData
-        if (contentVersion < (int)EntityVersion::CloneableData) {
-            QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
-            QJsonObject grabbableKey = userData["grabbableKey"].toObject();
-            QJsonValue cloneable = grabbableKey["cloneable"];
-            if (cloneable.isBool() && cloneable.toBool()) {
-                QJsonValue cloneLifetime = grabbableKey["cloneLifetime"];
-                QJsonValue cloneLimit = grabbableKey["cloneLimit"];
-                QJsonValue cloneDynamic = grabbableKey["cloneDynamic"];
-                QJsonValue cloneAvatarEntity = grabbableKey["cloneAvatarEntity"];
+    // convert old grab-related userData to new grab properties
+    if (_streamedRead->contentVersion < (int)EntityVersion::GrabProperties) {
+        convertGrabUserDataToProperties(properties);
+    }
 
-                // This is cloneable, we need to convert the properties
-                properties.setCloneable(true);
-                properties.setCloneLifetime(cloneLifetime.toInt());
-                properties.setCloneLimit(cloneLimit.toInt());
-                properties.setCloneDynamic(cloneDynamic.toBool());
-                properties.setCloneAvatarEntity(cloneAvatarEntity.toBool());
-            }
-        }
+    // Zero out the spread values that were fixed in version ParticleEntityFix so they behave the same as before
+    if (_streamedRead->contentVersion < (int)EntityVersion::ParticleEntityFix) {
+        properties.setRadiusSpread(0.0f);
+        properties.setAlphaSpread(0.0f);
+        properties.setColorSpread({0, 0, 0});
+    }
 
-        // convert old grab-related userData to new grab properties
-        if (contentVersion < (int)EntityVersion::GrabProperties) {
-            convertGrabUserDataToProperties(properties);
+    if (_streamedRead->contentVersion < (int)EntityVersion::FixPropertiesFromCleanup) {
+        if (entityMap.contains("created")) {
+            quint64 created = QDateTime::fromString(entityMap["created"].toString().trimmed(), Qt::ISODate).toMSecsSinceEpoch() * 1000;
+            properties.setCreated(created);
         }
+    }
 
-        // Zero out the spread values that were fixed in version ParticleEntityFix so they behave the same as before
-        if (contentVersion < (int)EntityVersion::ParticleEntityFix) {
-            properties.setRadiusSpread(0.0f);
-            properties.setAlphaSpread(0.0f);
-            properties.setColorSpread({0, 0, 0});
-        }
+    _streamedRead->batch.push_back({ entityItemID, properties });
+    ++_streamedRead->numEntities;
+    if (_streamedRead->batch.size() >= STREAMED_READ_BATCH_SIZE) {
+        addStreamedEntities();
+    }
+    return true;
+}
 
-        if (contentVersion < (int)EntityVersion::FixPropertiesFromCleanup) {
-            if (entityMap.contains("created")) {
-                quint64 created = QDateTime::fromString(entityMap["created"].toString().trimmed(), Qt::ISODate).toMSecsSinceEpoch() * 1000;
-                properties.setCreated(created);
+void EntityTree::addStreamedEntities() {
+    // the conversion of the batch happened without the lock, only adding the entities needs it
+    withWriteLock([&] {
+        for (const auto& entry : _streamedRead->batch) {
+            const EntityItemID& entityItemID = entry.first;
+            const EntityItemProperties& properties = entry.second;
+            EntityItemPointer entity = addEntity(entityItemID, properties);
+            if (!entity) {
+                qCDebug(entities) << "adding Entity failed:" << entityItemID << properties.getType();
+                _streamedRead->success = false;
             }
-        }
 
-        EntityItemPointer entity = addEntity(entityItemID, properties);
-        if (!entity) {
-            qCDebug(entities) << "adding Entity failed:" << entityItemID << properties.getType();
-            success = false;
+            if (entity) {
+                _streamedRead->addedIDs.push_back(entityItemID);
+                const QUuid& cloneOriginID = entity->getCloneOriginID();
+                if (!cloneOriginID.isNull()) {
+                    _streamedRead->cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
+                }
+            }
         }
+    });
+    _streamedRead->batch.clear();
+}
 
-        if (entity) {
-            const QUuid& cloneOriginID = entity->getCloneOriginID();
-            if (!cloneOriginID.isNull()) {
-                cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
+void EntityTree::abortStreamedRead() {
+    if (!_streamedRead) {
+        return;
+    }
+
+    if (!_streamedRead->addedIDs.empty()) {
+        qCWarning(entities) << "Removing the" << _streamedRead->addedIDs.size() << "entities read before the document failed";
+        withWriteLock([&] {
+            // straight out of the tree, not through the delete filters or the entity server
+            std::vector<EntityItemPointer> entitiesToDelete;
+            for (const auto& entityID : _streamedRead->addedIDs) {
+                EntityItemPointer entity = findEntityByEntityItemID(entityID);
+                if (entity) {
+                    entitiesToDelete.push_back(entity);
+                }
             }
-        }
+            deleteEntitiesByPointer(entitiesToDelete);
+        });
     }
+    _streamedRead.reset();
+}
 
-    for (const auto& entityID : cloneIDs.keys()) {
-        auto entity = findEntityByID(entityID);
-        if (entity) {
-            entity->setCloneIDs(cloneIDs.value(entityID));
-        }
+bool EntityTree::endStreamedRead() {
+    if (!_streamedRead) {
+        return false;
     }
 
+    addStreamedEntities();
+
+    const auto& cloneIDs = _streamedRead->cloneIDs;
+    withWriteLock([&] {
+        for (const auto& entityID : cloneIDs.keys()) {
+            auto entity = findEntityByID(entityID);
+            if (entity) {
+                entity->setCloneIDs(cloneIDs.value(entityID));
+            }
+        }
+    });
+
+    // an empty or invalidly formed document
+    bool success = _streamedRead->success && _streamedRead->numEntities > 0;
+    _streamedRead.reset();
     return success;
 }
 
@@ -12,6 +12,9 @@
 #ifndef hifi_EntityTree_h
 #define hifi_EntityTree_h
 
+#include <atomic>
+#include <mutex>
+
 #include <QSet>
 #include <QVector>
 
@@ -19,7 +22,9 @@
 #include <SpatialParentFinder.h>
 
 #include "AddEntityOperator.h"
+#include "EntityAABBTree.h"
 #include "EntityTreeElement.h"
+#include "EntityTreeSnapshot.h"
 #include "DeleteEntityOperator.h"
 #include "MovingEntitiesOperator.h"
 
@@ -37,6 +42,44 @@ public:
     virtual void entityCreated(const EntityItem& newEntity, const SharedNodePointer& senderNode) = 0;
 };
 
+// One pick of a batch, see EntityTree::evalRayIntersections
+class EntityRayQuery {
+public:
+    // Inputs
+    PickRay ray;
+    PickFilter searchFilter;
+    QVector<EntityItemID> entityIdsToInclude;
+    QVector<EntityItemID> entityIdsToDiscard;
+
+    // Outputs
+    EntityItemID entityID;
+    OctreeElementPointer element;
+    float distance { FLT_MAX };
+    BoxFace face { UNKNOWN_FACE };
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+};
+
+// One pick of a batch, see EntityTree::evalParabolaIntersections
+class EntityParabolaQuery {
+public:
+    // Inputs
+    PickParabola parabola;
+    PickFilter searchFilter;
+    QVector<EntityItemID> entityIdsToInclude;
+    QVector<EntityItemID> entityIdsToDiscard;
+
+    // Outputs
+    EntityItemID entityID;
+    OctreeElementPointer element;
+    glm::vec3 intersection;
+    float distance { FLT_MAX };
+    float parabolicDistance { FLT_MAX };
+    BoxFace face { UNKNOWN_FACE };
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+};
+
 class SendEntitiesOperationArgs {
 public:
     glm::vec3 root;
@@ -89,6 +132,10 @@ public:
     void fixupTerseEditLogging(EntityItemProperties& properties, QList<QString>& changedProperties);
     virtual int processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                       const SharedNodePointer& senderNode) override;
+    virtual bool preparesEditPacketType(PacketType packetType) const override;
+    virtual PreparedOctreeEditPointer prepareEditPacketData(ReceivedMessage& message, const unsigned char* editData,
+            int maxLength, const SharedNodePointer& senderNode, int& bytesRead) override;
+    virtual void applyPreparedEdit(PreparedOctreeEdit& edit, const SharedNodePointer& senderNode) override;
     virtual void processChallengeOwnershipRequestPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
     virtual void processChallengeOwnershipReplyPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
     virtual void processChallengeOwnershipPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
@@ -105,6 +152,12 @@ public:
         float& distance, float& parabolicDistance, BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
         Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
 
+    // Answer a batch of picks together: the tree is read locked once for all of them and the picks are split between
+    // the calling thread and the global thread pool. Return false if the tree couldn't be locked (TryLock), in which
+    // case none of the picks were answered.
+    bool evalRayIntersections(QVector<EntityRayQuery>& queries, Octree::lockType lockType = Octree::Lock);
+    bool evalParabolaIntersections(QVector<EntityParabolaQuery>& queries, Octree::lockType lockType = Octree::Lock);
+
     virtual bool rootElementHasData() const override { return true; }
 
     virtual void releaseSceneEncodeData(OctreeElementExtraEncodeData* extraEncodeData) const override;
@@ -118,6 +171,8 @@ public:
     void postAddEntity(EntityItemPointer entityItem);
 
     EntityItemPointer addEntity(const EntityItemID& entityID, const EntityItemProperties& properties, bool isClone = false);
+    // adds an entity that was already decoded with all its properties, see EntityBinarySnapshot
+    bool addDecodedEntity(const EntityItemPointer& entity);
 
     // use this method if you only know the entityID
     bool updateEntity(const EntityItemID& entityID, const EntityItemProperties& properties, const SharedNodePointer& senderNode = SharedNodePointer(nullptr));
@@ -144,6 +199,14 @@ public:
     void evalEntitiesInBox(const AABox& box, PickFilter searchFilter, QVector<QUuid>& foundEntities);
     void evalEntitiesInFrustum(const ViewFrustum& frustum, PickFilter searchFilter, QVector<QUuid>& foundEntities);
 
+    // when enabled the queries above (and the ray and parabola picks) walk a dynamic AABB tree of the entities instead
+    // of the octree elements, the octree is still what entities are sent and persisted from
+    void setUseAABBTree(bool useAABBTree);
+    bool getUseAABBTree() const { return _useAABBTree; }
+    // called when an entity moves, resizes, or joins or leaves an element
+    void entityBoundsChanged(const EntityItemPointer& entity);
+    int getAABBTreeHeight() const;
+
     void addNewlyCreatedHook(NewlyCreatedEntityHook* hook);
     void removeNewlyCreatedHook(NewlyCreatedEntityHook* hook);
 
@@ -196,8 +259,26 @@ public:
     virtual bool writeToMap(QVariantMap& entityDescription, OctreeElementPointer element, bool skipDefaultValues,
                             bool skipThoseWithBadParents) override;
     virtual bool readFromMap(QVariantMap& entityDescription) override;
+    virtual bool supportsStreamedRead() const override { return true; }
+    virtual bool beginStreamedRead(const QVariantMap& documentInfo) override;
+    virtual bool readStreamedEntity(QVariantMap& entityMap) override;
+    virtual bool endStreamedRead() override;
+    virtual void abortStreamedRead() override;
     virtual bool writeToJSON(QString& jsonString, const OctreeElementPointer& element) override;
 
+    // incremental persistence: log records hold an entity's non-default properties as JSON, or mark its deletion
+    virtual bool supportsPersistLog() const override { return true; }
+    virtual void setTrackPersistChanges(bool trackPersistChanges) override { _trackPersistChanges = trackPersistChanges; }
+    virtual void writePersistChanges(OctreePersistLog& log) override;
+    virtual bool replayPersistLogRecord(const OctreePersistLogRecord& record) override;
+    virtual OctreePersistSnapshotPointer takePersistSnapshot(bool withBinarySnapshot = false) override;
+    // every change that dirties the tree goes through here, or the log misses it
+    void trackPersistChange(const EntityItemID& entityID);
+
+    virtual bool writeBinarySnapshot(const QString& filename) override;
+    virtual bool readBinarySnapshotInfo(const QString& filename, QUuid& id, int64_t& dataVersion) const override;
+    virtual bool readBinarySnapshot(const QString& filename) override;
+
 
     glm::vec3 getContentsDimensions();
     float getContentsLargestDimension();
@@ -279,6 +360,11 @@ public:
                                  bool force, bool tellServer);
     void startDynamicDomainVerificationOnServer(float minimumAgeToRemove);
 
+    // Returns the latest immutable snapshot of the tree. The tree is copied again (under its read lock) at most once
+    // per minRebuildInterval and only if it changed, so all the edits made in between end up in the next snapshot.
+    // Safe to call from any thread without holding the tree lock.
+    EntityTreeSnapshotPointer getSnapshot(uint64_t minRebuildInterval);
+
 signals:
     void deletingEntity(const EntityItemID& entityID);
     void deletingEntityPointer(EntityItem* entityID);
@@ -302,6 +388,16 @@ protected:
 
     void notifyNewlyCreatedEntity(const EntityItem& newEntity, const SharedNodePointer& senderNode);
 
+    // the picks without the locking, the caller must hold the tree's read lock
+    EntityItemID evalRayIntersectionWorker(const glm::vec3& origin, const glm::vec3& direction,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+        PickFilter searchFilter, OctreeElementPointer& element, float& distance, BoxFace& face, glm::vec3& surfaceNormal,
+        QVariantMap& extraInfo);
+    EntityItemID evalParabolaIntersectionWorker(const PickParabola& parabola,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+        PickFilter searchFilter, OctreeElementPointer& element, float& parabolicDistance, BoxFace& face,
+        glm::vec3& surfaceNormal, QVariantMap& extraInfo);
+
     bool isScriptInWhitelist(const QString& scriptURL);
 
     QReadWriteLock _newlyCreatedHooksLock;
@@ -374,6 +470,16 @@ protected:
     MovingEntitiesOperator _entityMover;
     QHash<EntityItemID, EntityItemPointer> _entitiesToAdd;
 
+    // the entities whose bounds changed are only re-inserted in the AABB tree when the next query needs it, so an
+    // entity that moves several times between two queries only gets updated once
+    void updateAABBTree();
+    void findEntitiesInAABBTree(const EntityAABBTree::BoxTest& test, const EntityAABBTree::EntityVisitor& visitor);
+    std::atomic<bool> _useAABBTree { false };
+    mutable QReadWriteLock _aabbTreeLock;
+    EntityAABBTree _aabbTree;
+    std::mutex _entitiesWithChangedBoundsMutex;
+    QHash<const EntityItem*, EntityItemWeakPointer> _entitiesWithChangedBounds;
+
     Q_INVOKABLE void startChallengeOwnershipTimer(const EntityItemID& entityItemID);
 
 private:
@@ -396,6 +502,28 @@ private:
 
     std::map<QString, QString> _namedPaths;
 
+    EntityTreeSnapshotPointer _snapshot; // only accessed with std::atomic_load/std::atomic_store
+    std::mutex _snapshotBuildMutex;
+    std::atomic<uint64_t> _lastSnapshotCheck { 0 };
+
+    // an add, clone or edit that went through prepareEditPacketData
+    class PreparedEdit;
+    bool validatePreparedEdit(PreparedEdit& edit, const SharedNodePointer& senderNode, bool deferIfMissing);
+    bool holdPreparedEdit(PreparedEdit& edit);
+    void releasePreparedEdit(PreparedEdit& edit);
+    std::mutex _preparedEditsMutex;
+    QHash<EntityItemID, int> _preparedEditCounts; // edits prepared and not applied yet, by entity
+
+    // entities being read from a document, see beginStreamedRead
+    class StreamedRead;
+    std::unique_ptr<StreamedRead> _streamedRead;
+    void addStreamedEntities();
+
+    // entities added, edited or deleted since the last writePersistChanges
+    std::atomic<bool> _trackPersistChanges { false };
+    std::mutex _persistChangesMutex;
+    QSet<EntityItemID> _persistChanges;
+
     void updateEntityQueryAACubeWorker(SpatiallyNestablePointer object, EntityEditPacketSender* packetSender,
                                        MovingEntitiesOperator& moveOperator, bool force, bool tellServer);
 };
@@ -156,6 +156,19 @@ public:
         BoxFace& face, glm::vec3& surfaceNormal, const QVector<EntityItemID>& entityIdsToInclude,
         const QVector<EntityItemID>& entityIdsToDiscard, PickFilter searchFilter, QVariantMap& extraInfo);
 
+    // the tests the element queries run on each of their entities, the first two return true if they found an
+    // intersection closer than the given distance, which they then update
+    static bool evalEntityRayIntersection(const EntityItemPointer& entity, const glm::vec3& origin,
+        const glm::vec3& direction, OctreeElementPointer& element, float& distance, BoxFace& face, glm::vec3& surfaceNormal,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+        PickFilter searchFilter, QVariantMap& extraInfo);
+    static bool evalEntityParabolaIntersection(const EntityItemPointer& entity, const glm::vec3& origin,
+        const glm::vec3& velocity, const glm::vec3& acceleration, const glm::vec3& normal, OctreeElementPointer& element,
+        float& parabolicDistance, BoxFace& face, glm::vec3& surfaceNormal, const QVector<EntityItemID>& entityIdsToInclude,
+        const QVector<EntityItemID>& entityIdsToDiscard, PickFilter searchFilter, QVariantMap& extraInfo);
+    static bool checkSphereIntersection(const EntityItemPointer& entity, const glm::vec3& position, float radius);
+    static glm::vec3 getParabolaPlaneNormal(const glm::vec3& velocity, const glm::vec3& acceleration);
+
     template <typename F>
     void forEachEntity(F f) const {
         withReadLock([&] {
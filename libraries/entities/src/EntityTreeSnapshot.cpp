@@ -0,0 +1,64 @@
+//
+//  EntityTreeSnapshot.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityTreeSnapshot.h"
+
+#include <NumericalConstants.h>
+
+#include "EntityItem.h"
+#include "EntityTreeElement.h"
+
+EntityTreeSnapshotPointer EntityTreeSnapshot::build(const EntityTreeElementPointer& root, uint64_t timestamp) {
+    auto snapshot = std::make_shared<EntityTreeSnapshot>();
+    snapshot->_timestamp = timestamp;
+    if (root) {
+        snapshot->addElement(root);
+    }
+    return snapshot;
+}
+
+int32_t EntityTreeSnapshot::addElement(const EntityTreeElementPointer& element) {
+    // elements are stored depth first, so the root is always at index 0
+    int32_t index = (int32_t)_elements.size();
+    _elements.emplace_back();
+
+    {
+        Element& copy = _elements.back();
+        const auto& cube = element->getAACube();
+        copy.center = cube.calcCenter();
+        copy.radius = 0.5f * SQRT_THREE * cube.getScale();
+        copy.lastChanged = element->getLastChanged();
+        copy.lastChangedContent = element->getLastChangedContent();
+        copy.firstEntity = (uint32_t)_entities.size();
+    }
+
+    element->forEachEntity([&](const EntityItemPointer& entityItem) {
+        Entity entity;
+        entity.entity = entityItem;
+        bool success = false;
+        auto cube = entityItem->getQueryAACube(success);
+        if (success) {
+            entity.center = cube.calcCenter();
+            entity.radius = 0.5f * SQRT_THREE * cube.getScale();
+            entity.hasBounds = true;
+        }
+        _entities.push_back(entity);
+    });
+    _elements[index].numEntities = (uint32_t)_entities.size() - _elements[index].firstEntity;
+
+    // recursing invalidates references into _elements, so only hold on to the index
+    for (int i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+        EntityTreeElementPointer child = element->getChildAtIndex(i);
+        int32_t childIndex = child ? addElement(child) : INVALID_INDEX;
+        _elements[index].children[i] = childIndex;
+    }
+
+    return index;
+}
@@ -0,0 +1,87 @@
+//
+//  EntityTreeSnapshot.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityTreeSnapshot_h
+#define hifi_EntityTreeSnapshot_h
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <OctreeConstants.h>
+
+#include "EntityTypes.h"
+
+class EntityTreeElement;
+using EntityTreeElementPointer = std::shared_ptr<EntityTreeElement>;
+
+class EntityTreeSnapshot;
+using EntityTreeSnapshotPointer = std::shared_ptr<const EntityTreeSnapshot>;
+
+// EntityTreeSnapshot is an immutable, flat copy of the elements of an EntityTree and of the entities they contain.
+// The EntityTree publishes a new one when it changed (see EntityTree::getSnapshot) so that the entity server
+// send threads can traverse it without holding the tree lock while edits are being applied.
+class EntityTreeSnapshot {
+public:
+    static const int32_t INVALID_INDEX = -1;
+
+    class Element {
+    public:
+        glm::vec3 center; // bounding sphere of the element cube
+        float radius { 0.0f };
+        uint64_t lastChanged { 0 };
+        uint64_t lastChangedContent { 0 };
+        int32_t children[NUMBER_OF_CHILDREN];
+        uint32_t firstEntity { 0 };
+        uint32_t numEntities { 0 };
+
+        bool hasContent() const { return numEntities > 0; }
+    };
+
+    class Entity {
+    public:
+        EntityItemWeakPointer entity; // weak so that deleted entities don't live on in older snapshots
+        glm::vec3 center; // bounding sphere of the query cube, used to prioritize the entity
+        float radius { 0.0f };
+        bool hasBounds { false };
+    };
+
+    /// Copies the elements below root, the caller must hold the tree's read lock
+    static EntityTreeSnapshotPointer build(const EntityTreeElementPointer& root, uint64_t timestamp);
+
+    /// Time at which the tree was copied, changes made after it will be in the next snapshot
+    uint64_t getTimestamp() const { return _timestamp; }
+
+    int32_t getRootIndex() const { return _elements.empty() ? INVALID_INDEX : 0; }
+    const Element& getElement(int32_t index) const { return _elements[index]; }
+
+    size_t getNumElements() const { return _elements.size(); }
+    size_t getNumEntities() const { return _entities.size(); }
+    /// Index of one of the entities of this snapshot, as passed to forEachEntity
+    uint32_t getEntityIndex(const Entity& entity) const { return (uint32_t)(&entity - _entities.data()); }
+
+    template <typename F>
+    void forEachEntity(const Element& element, F f) const {
+        uint32_t end = element.firstEntity + element.numEntities;
+        for (uint32_t i = element.firstEntity; i < end; ++i) {
+            f(_entities[i]);
+        }
+    }
+
+private:
+    int32_t addElement(const EntityTreeElementPointer& element);
+
+    uint64_t _timestamp { 0 };
+    std::vector<Element> _elements;
+    std::vector<Entity> _entities;
+};
+
+#endif // hifi_EntityTreeSnapshot_h
@@ -20,6 +20,9 @@ public:
 
     QString getJson() const { return _json; }
 
+    // adds an entity that isn't in the tree any more, such as one copied out of it by EntityPersistSnapshot
+    void appendProperties(const EntityItemProperties& properties);
+
 private:
     void processEntity(const EntityItemPointer& entity);
 
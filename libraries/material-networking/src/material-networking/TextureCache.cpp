@@ -15,6 +15,7 @@
 
 #include <QtConcurrent/QtConcurrentRun>
 
+#include <QBuffer>
 #include <QCryptographicHash>
 #include <QImageReader>
 #include <QRunnable>
@@ -42,6 +43,7 @@
 #include <PathUtils.h>
 #include <Finally.h>
 #include <Profile.h>
+#include <ResourceProcessingPool.h>
 
 #include "NetworkLogging.h"
 #include "MaterialNetworkingLogging.h"
@@ -824,7 +826,7 @@ void NetworkTexture::ktxMipRequestFinished() {
             auto mipLevel = _ktxMipLevelRangeInFlight.first;
             auto texture = _textureSource->getGPUTexture();
             DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
-            QtConcurrent::run(QThreadPool::globalInstance(), [self, data, mipLevel, url, texture] {
+            ResourceProcessingPool::getInstance().start(getType(), [self, data, mipLevel, url, texture] {
                 PROFILE_RANGE_EX(resource_parse_image, "NetworkTexture - Processing Mip Data", 0xffff0000, 0, { { "url", url.toString() } });
                 DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
                 CounterStat counter("Processing");
@@ -858,7 +860,7 @@ void NetworkTexture::ktxMipRequestFinished() {
                     Q_ARG(int, texture->getHeight()));
 
                 QMetaObject::invokeMethod(resource.data(), "startRequestForNextMipLevel");
-            });
+            }, data.size()); // the mip goes into the texture as it is, in its GPU format
         } else {
             qWarning(networking) << "Mip request finished in an unexpected state: " << _ktxResourceState;
             finishedLoading(false);
@@ -876,6 +878,37 @@ void NetworkTexture::ktxMipRequestFinished() {
     _ktxMipRequest = nullptr;
 }
 
+// What processing the header and high mips of a KTX holds: the texture it creates has room for all the mips
+static qint64 estimateKTXProcessingSize(const QByteArray& ktxHeaderData, const QByteArray& ktxHighMipData) {
+    qint64 numBytes = ktxHeaderData.size() + ktxHighMipData.size();
+    if (ktxHeaderData.size() < (int)ktx::KTX_HEADER_SIZE) {
+        return numBytes;
+    }
+    auto header = reinterpret_cast<const ktx::Header*>(ktxHeaderData.data());
+    if (!header->isValid()) {
+        return numBytes;
+    }
+    return numBytes + (qint64)ktx::KTX::evalStorageSize(*header, header->generateImageDescriptors());
+}
+
+// What decoding an image file holds: the full size image, and the texture made of it, scaled down to maxNumPixels
+// and with its mips. A compressed image file is often a tenth of it.
+static qint64 estimateImageProcessingSize(const QByteArray& content, int maxNumPixels) {
+    QBuffer buffer;
+    buffer.setData(content);
+    buffer.open(QIODevice::ReadOnly);
+    QSize imageSize = QImageReader(&buffer).size();
+    if (!imageSize.isValid()) {
+        return content.size();
+    }
+
+    const qint64 BYTES_PER_PIXEL = 4;
+    qint64 numPixels = (qint64)imageSize.width() * imageSize.height();
+    qint64 numTexturePixels = std::min(numPixels, (qint64)maxNumPixels);
+    // the mips add a third
+    return content.size() + BYTES_PER_PIXEL * (numPixels + numTexturePixels + numTexturePixels / 3);
+}
+
 // This is called when the header and top mips have been loaded
 void NetworkTexture::handleFinishedInitialLoad() {
     Q_ASSERT(_ktxResourceState == LOADING_INITIAL_DATA);
@@ -892,7 +925,8 @@ void NetworkTexture::handleFinishedInitialLoad() {
     auto self = _self;
     auto url = _url;
     DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
-    QtConcurrent::run(QThreadPool::globalInstance(), [self, ktxHeaderData, ktxHighMipData, url] {
+    qint64 numBytes = estimateKTXProcessingSize(ktxHeaderData, ktxHighMipData);
+    ResourceProcessingPool::getInstance().start(getType(), [self, ktxHeaderData, ktxHighMipData, url] {
         PROFILE_RANGE_EX(resource_parse_image, "NetworkTexture - Processing Initial Data", 0xffff0000, 0, { { "url", url.toString() } });
         DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
         CounterStat counter("Processing");
@@ -1039,7 +1073,7 @@ void NetworkTexture::handleFinishedInitialLoad() {
             Q_ARG(int, texture->getHeight()));
 
         QMetaObject::invokeMethod(resource.data(), "startRequestForNextMipLevel");
-    });
+    }, numBytes);
 }
 
 void NetworkTexture::downloadFinished(const QByteArray& data) {
@@ -1053,6 +1087,21 @@ void NetworkTexture::downloadFinished(const QByteArray& data) {
     }
 }
 
+bool NetworkTexture::canShareContent() const {
+    // KTX files are loaded a few mips at a time
+    return _currentlyLoadingResourceType == ResourceType::ORIGINAL;
+}
+
+bool NetworkTexture::adoptContent(const Resource& original) {
+    auto& originalTexture = static_cast<const NetworkTexture&>(original);
+    auto texture = originalTexture.getGPUTexture();
+    if (originalTexture._currentlyLoadingResourceType != ResourceType::ORIGINAL || !texture) {
+        return false;
+    }
+    setImage(texture, originalTexture._originalWidth, originalTexture._originalHeight);
+    return true;
+}
+
 void NetworkTexture::loadMetaContent(const QByteArray& content) {
     if (_currentlyLoadingResourceType != ResourceType::META) {
         qWarning() << "Trying to load meta content when current resource type is not META";
@@ -1127,7 +1176,9 @@ void NetworkTexture::loadTextureContent(const QByteArray& content) {
         return;
     }
 
-    QThreadPool::globalInstance()->start(new ImageReader(_self, _url, content, _extraHash, _maxNumPixels, _sourceChannel));
+    ResourceProcessingPool::getInstance().start(getType(),
+        new ImageReader(_self, _url, content, _extraHash, _maxNumPixels, _sourceChannel),
+        estimateImageProcessingSize(content, _maxNumPixels));
 }
 
 void NetworkTexture::refresh() {
@@ -80,6 +80,9 @@ protected:
 
     Q_INVOKABLE virtual void downloadFinished(const QByteArray& data) override;
 
+    bool canShareContent() const override;
+    bool adoptContent(const Resource& original) override;
+
     bool handleFailedRequest(ResourceRequest::Result result) override;
 
     Q_INVOKABLE void loadMetaContent(const QByteArray& content);
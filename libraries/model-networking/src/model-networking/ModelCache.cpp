@@ -10,13 +10,16 @@
 //
 
 #include "ModelCache.h"
+
+#include <QtCore/QtEndian>
+
 #include <Finally.h>
 #include <FSTReader.h>
 
 #include <gpu/Batch.h>
 #include <gpu/Stream.h>
 
-#include <QThreadPool>
+#include <ResourceProcessingPool.h>
 
 #include <Gzip.h>
 
@@ -31,6 +34,21 @@
 
 Q_LOGGING_CATEGORY(trace_resource_parse_geometry, "trace.resource.parse.geometry")
 
+// Parsing a model holds several times the size of its file: FBX files deflate their arrays, and the meshes get normals,
+// tangents and a copy in their GPU format
+static const int MODEL_PROCESSING_SIZE_FACTOR = 8;
+
+static qint64 estimateModelProcessingSize(const QUrl& url, const QByteArray& data) {
+    qint64 modelSize = data.size();
+    const int GZIP_FOOTER_SIZE = 8;
+    if (url.path().toLower().endsWith(".gz") && data.size() >= GZIP_FOOTER_SIZE) {
+        // a gzip file ends with the size of what it holds, modulo 4 GB
+        auto footer = reinterpret_cast<const uchar*>(data.constData()) + data.size() - GZIP_FOOTER_SIZE;
+        modelSize = qFromLittleEndian<quint32>(footer + sizeof(quint32));
+    }
+    return data.size() + MODEL_PROCESSING_SIZE_FACTOR * modelSize;
+}
+
 class GeometryExtra {
 public:
     const GeometryMappingPair& mapping;
@@ -287,7 +305,9 @@ void ModelResource::downloadFinished(const QByteArray& data) {
             _url = _effectiveBaseURL;
             _textureBaseURL = _effectiveBaseURL;
         }
-        QThreadPool::globalInstance()->start(new GeometryReader(_modelLoader, _self, _effectiveBaseURL, _mappingPair, data, _combineParts, _request->getWebMediaType()));
+        ResourceProcessingPool::getInstance().start(getType(), new GeometryReader(_modelLoader, _self, _effectiveBaseURL,
+            _mappingPair, data, _combineParts, _request->getWebMediaType()),
+            estimateModelProcessingSize(_effectiveBaseURL, data));
     }
 }
 
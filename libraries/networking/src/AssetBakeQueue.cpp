@@ -0,0 +1,201 @@
+//
+//  AssetBakeQueue.cpp
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetBakeQueue.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSaveFile>
+
+#include "NetworkLogging.h"
+
+static const int QUEUE_FILE_VERSION = 1;
+static const QString VERSION_KEY = "version";
+static const QString ASSETS_KEY = "assets";
+static const QString HASH_KEY = "hash";
+static const QString PATH_KEY = "path";
+static const QString LAST_REQUESTED_KEY = "last_requested";
+
+bool AssetBakeQueue::Key::operator<(const Key& other) const {
+    // most recently requested first, then first come first served
+    if (lastRequested != other.lastRequested) {
+        return lastRequested > other.lastRequested;
+    }
+    return sequence < other.sequence;
+}
+
+bool AssetBakeQueue::load(const QString& filePath) {
+    _filePath = filePath;
+    _entries.clear();
+    _waiting.clear();
+    _isDirty = false;
+
+    QFile file { filePath };
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(asset_client) << "Could not open the bake queue" << filePath;
+        return false;
+    }
+
+    QJsonParseError error;
+    auto root = QJsonDocument::fromJson(file.readAll(), &error).object();
+    if (error.error != QJsonParseError::NoError || root[VERSION_KEY].toInt() != QUEUE_FILE_VERSION) {
+        // the assets that need it are queued again when the asset server starts, only their order is lost
+        qCWarning(asset_client) << "Ignoring the invalid bake queue" << filePath;
+        _isDirty = true;
+        return true;
+    }
+
+    for (const auto& value : root[ASSETS_KEY].toArray()) {
+        auto asset = value.toObject();
+        auto hash = asset[HASH_KEY].toString();
+        if (!AssetUtils::isValidHash(hash) || _entries.contains(hash)) {
+            continue;
+        }
+
+        Entry entry;
+        entry.hash = hash;
+        entry.path = asset[PATH_KEY].toString();
+        entry.lastRequested = (qint64)asset[LAST_REQUESTED_KEY].toDouble();
+        entry.sequence = _nextSequence++;
+        _lastRequestTime = std::max(_lastRequestTime, entry.lastRequested);
+        _waiting[keyFor(entry)] = hash;
+        _entries.insert(hash, entry);
+    }
+    return true;
+}
+
+bool AssetBakeQueue::save() {
+    if (!_isDirty || _filePath.isEmpty()) {
+        return true;
+    }
+
+    // in the order they were queued, so that it is kept when loading them
+    std::vector<const Entry*> entries;
+    entries.reserve(_entries.size());
+    for (const auto& entry : _entries) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        return a->sequence < b->sequence;
+    });
+
+    QJsonArray assets;
+    for (const auto entry : entries) {
+        QJsonObject asset;
+        asset[HASH_KEY] = entry->hash;
+        asset[PATH_KEY] = entry->path;
+        asset[LAST_REQUESTED_KEY] = (double)entry->lastRequested;
+        assets.append(asset);
+    }
+    QJsonObject root;
+    root[VERSION_KEY] = QUEUE_FILE_VERSION;
+    root[ASSETS_KEY] = assets;
+
+    QSaveFile file { _filePath };
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) == -1 ||
+        !file.commit()) {
+        qCWarning(asset_client) << "Could not save the bake queue" << _filePath;
+        return false;
+    }
+    _isDirty = false;
+    return true;
+}
+
+void AssetBakeQueue::push(const AssetUtils::AssetHash& hash, const AssetUtils::AssetPath& path, bool isRequested) {
+    if (_entries.contains(hash)) {
+        if (isRequested) {
+            request(hash);
+        }
+        return;
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.path = path;
+    entry.lastRequested = isRequested ? nextRequestTime() : 0;
+    entry.sequence = _nextSequence++;
+    _waiting[keyFor(entry)] = hash;
+    _entries.insert(hash, entry);
+    _isDirty = true;
+}
+
+bool AssetBakeQueue::request(const AssetUtils::AssetHash& hash) {
+    auto it = _entries.find(hash);
+    if (it == _entries.end()) {
+        return false;
+    }
+
+    if (!it->isStarted) {
+        _waiting.erase(keyFor(*it));
+    }
+    it->lastRequested = nextRequestTime();
+    if (!it->isStarted) {
+        _waiting[keyFor(*it)] = hash;
+    }
+    _isDirty = true;
+    return true;
+}
+
+const AssetBakeQueue::Entry* AssetBakeQueue::peek() const {
+    if (_waiting.empty()) {
+        return nullptr;
+    }
+    auto it = _entries.find(_waiting.begin()->second);
+    return it != _entries.end() ? &(*it) : nullptr;
+}
+
+void AssetBakeQueue::start(const AssetUtils::AssetHash& hash) {
+    auto it = _entries.find(hash);
+    if (it != _entries.end() && !it->isStarted) {
+        _waiting.erase(keyFor(*it));
+        it->isStarted = true;
+    }
+}
+
+void AssetBakeQueue::stop(const AssetUtils::AssetHash& hash) {
+    auto it = _entries.find(hash);
+    if (it != _entries.end() && it->isStarted) {
+        it->isStarted = false;
+        _waiting[keyFor(*it)] = hash;
+    }
+}
+
+void AssetBakeQueue::remove(const AssetUtils::AssetHash& hash) {
+    auto it = _entries.find(hash);
+    if (it == _entries.end()) {
+        return;
+    }
+
+    if (!it->isStarted) {
+        _waiting.erase(keyFor(*it));
+    }
+    _entries.erase(it);
+    _isDirty = true;
+}
+
+bool AssetBakeQueue::isStarted(const AssetUtils::AssetHash& hash) const {
+    auto it = _entries.find(hash);
+    return it != _entries.end() && it->isStarted;
+}
+
+qint64 AssetBakeQueue::nextRequestTime() {
+    // strictly increasing, so that the last one to be requested comes first even within the same millisecond
+    _lastRequestTime = std::max(QDateTime::currentMSecsSinceEpoch(), _lastRequestTime + 1);
+    return _lastRequestTime;
+}
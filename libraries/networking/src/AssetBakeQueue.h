@@ -0,0 +1,85 @@
+//
+//  AssetBakeQueue.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetBakeQueue_h
+#define hifi_AssetBakeQueue_h
+
+#include <map>
+
+#include <QtCore/QHash>
+
+#include "AssetUtils.h"
+
+/// The assets the asset server has to bake, the ones clients asked for most recently first and the others in the order
+/// they were queued.
+///
+/// An asset stays in the queue until its bake is done, so that bakes that were waiting or interrupted by a shutdown are
+/// picked up again when the queue is loaded. It is saved as a whole, which is cheap next to a bake and allows saving it
+/// at most every so often; losing the last changes only costs the order of the bakes, since the asset server queues
+/// whatever it finds unbaked when it starts.
+class AssetBakeQueue {
+public:
+    class Entry {
+    public:
+        AssetUtils::AssetHash hash;
+        AssetUtils::AssetPath path;
+        qint64 lastRequested { 0 }; // msecs since epoch, 0 if no client asked for it since it was queued
+        quint64 sequence { 0 };
+        bool isStarted { false };
+    };
+
+    /// Loads the queue saved at the path, or starts an empty one if there's none
+    bool load(const QString& filePath);
+    /// Saves the queue if it changed since it was last saved
+    bool save();
+
+    /// Queues the bake of the asset if it isn't queued already, ahead of the others if a client is asking for it
+    void push(const AssetUtils::AssetHash& hash, const AssetUtils::AssetPath& path, bool isRequested = false);
+    /// Moves the asset ahead of the others because a client is asking for it. False if it isn't queued.
+    bool request(const AssetUtils::AssetHash& hash);
+
+    /// The next asset to bake, nullptr if all of them are started
+    const Entry* peek() const;
+    /// Marks the asset as being baked, it isn't returned by peek anymore
+    void start(const AssetUtils::AssetHash& hash);
+    /// Puts an asset that was being baked back in line, at its previous place
+    void stop(const AssetUtils::AssetHash& hash);
+    /// Removes the asset once its bake is done, or doesn't need to be
+    void remove(const AssetUtils::AssetHash& hash);
+
+    bool contains(const AssetUtils::AssetHash& hash) const { return _entries.contains(hash); }
+    bool isStarted(const AssetUtils::AssetHash& hash) const;
+
+    int size() const { return _entries.size(); }
+    int getNumWaiting() const { return (int)_waiting.size(); }
+    bool isDirty() const { return _isDirty; }
+
+private:
+    class Key {
+    public:
+        bool operator<(const Key& other) const;
+
+        qint64 lastRequested;
+        quint64 sequence;
+    };
+
+    static Key keyFor(const Entry& entry) { return { entry.lastRequested, entry.sequence }; }
+    qint64 nextRequestTime();
+
+    QHash<AssetUtils::AssetHash, Entry> _entries;
+    std::map<Key, AssetUtils::AssetHash> _waiting;
+
+    quint64 _nextSequence { 0 };
+    qint64 _lastRequestTime { 0 };
+    QString _filePath;
+    bool _isDirty { false };
+};
+
+#endif // hifi_AssetBakeQueue_h
@@ -0,0 +1,156 @@
+//
+//  AssetCache.cpp
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetCache.h"
+
+#include <algorithm>
+
+const qint64 AssetCache::DEFAULT_CAPACITY = 256 * 1024 * 1024;
+
+static const int SKETCH_DEPTH = 4;
+static const int SKETCH_WIDTH = 4096; // power of two
+static const uint8_t MAX_FREQUENCY = 15;
+// about ten times the number of ranges that can be tracked, as in the TinyLFU paper
+static const int SKETCH_SAMPLE_SIZE = 10 * SKETCH_WIDTH;
+
+AssetCache::FrequencySketch::FrequencySketch() :
+    _counters(SKETCH_DEPTH * SKETCH_WIDTH, 0)
+{
+}
+
+int AssetCache::FrequencySketch::getIndex(uint hash, int row) const {
+    static const uint SEEDS[SKETCH_DEPTH] = { 0x97cb3127, 0xb3125c6b, 0x9e3779b9, 0x85ebca6b };
+    uint mixed = (hash ^ SEEDS[row]) * 0x9e3779b1;
+    mixed ^= mixed >> 15;
+    return row * SKETCH_WIDTH + (int)(mixed & (SKETCH_WIDTH - 1));
+}
+
+void AssetCache::FrequencySketch::increment(uint hash) {
+    for (int row = 0; row < SKETCH_DEPTH; ++row) {
+        auto& counter = _counters[getIndex(hash, row)];
+        if (counter < MAX_FREQUENCY) {
+            ++counter;
+        }
+    }
+
+    if (++_numIncrements >= SKETCH_SAMPLE_SIZE) {
+        // age everything, so that what was popular a while ago doesn't keep the ranges popular now out
+        for (auto& counter : _counters) {
+            counter /= 2;
+        }
+        _numIncrements /= 2;
+    }
+}
+
+int AssetCache::FrequencySketch::getFrequency(uint hash) const {
+    int frequency = MAX_FREQUENCY;
+    for (int row = 0; row < SKETCH_DEPTH; ++row) {
+        frequency = std::min(frequency, (int)_counters[getIndex(hash, row)]);
+    }
+    return frequency;
+}
+
+AssetCache::AssetCache(qint64 capacity) :
+    _capacity(capacity)
+{
+}
+
+QByteArray AssetCache::computeKey(const QByteArray& assetHash, qint64 offset, qint64 size) {
+    QByteArray key = assetHash;
+    key.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    return key;
+}
+
+QByteArray AssetCache::get(const QByteArray& assetHash, qint64 offset, qint64 size, const Loader& loader) {
+    QByteArray key = computeKey(assetHash, offset, size);
+    uint keyHash = qHash(key);
+    ++_numRequests;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _sketch.increment(keyHash);
+
+    auto it = _rangesByKey.find(key);
+    if (it != _rangesByKey.end()) {
+        // move it to the front, it's the most recently used now
+        _ranges.splice(_ranges.begin(), _ranges, it.value());
+        QByteArray data = it.value()->data;
+        lock.unlock();
+
+        ++_numHits;
+        _bytesServedFromCache += data.size();
+        return data;
+    }
+
+    auto pendingIt = _pendingLoads.find(key);
+    if (pendingIt != _pendingLoads.end()) {
+        // someone is already reading it, wait for them
+        auto pendingLoad = pendingIt.value();
+        lock.unlock();
+
+        ++_numCoalescedRequests;
+        QByteArray data = pendingLoad.get();
+        _bytesServedFromCache += data.size();
+        return data;
+    }
+
+    std::promise<QByteArray> load;
+    _pendingLoads.insert(key, load.get_future().share());
+    lock.unlock();
+
+    QByteArray data = loader();
+
+    lock.lock();
+    _pendingLoads.remove(key);
+    // a short read, of a file that got truncated or failed to read, is only ever handed to those asking for it now
+    if (data.size() == size && size <= getMaxRangeSize()) {
+        admit(key, keyHash, data);
+    }
+    lock.unlock();
+
+    load.set_value(data);
+    return data;
+}
+
+void AssetCache::admit(const QByteArray& key, uint keyHash, const QByteArray& data) {
+    // find what would have to go to make room for it, starting from the least recently used
+    int candidateFrequency = _sketch.getFrequency(keyHash);
+    qint64 sizeToFree = _size + data.size() - _capacity;
+    auto firstVictim = _ranges.end();
+    while (sizeToFree > 0 && firstVictim != _ranges.begin()) {
+        --firstVictim;
+        if (_sketch.getFrequency(qHash(firstVictim->key)) >= candidateFrequency) {
+            // it's been asked for at least as often as the new one, keep it and leave the new one out
+            ++_numRejected;
+            return;
+        }
+        sizeToFree -= firstVictim->data.size();
+    }
+
+    for (auto it = firstVictim; it != _ranges.end(); ++it) {
+        _size -= it->data.size();
+        _rangesByKey.remove(it->key);
+    }
+    _ranges.erase(firstVictim, _ranges.end());
+
+    _ranges.push_front({ key, data });
+    _rangesByKey.insert(key, _ranges.begin());
+    _size += data.size();
+}
+
+qint64 AssetCache::getSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+int AssetCache::getNumRanges() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (int)_ranges.size();
+}
@@ -0,0 +1,103 @@
+//
+//  AssetCache.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetCache_h
+#define hifi_AssetCache_h
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+
+/// Ranges of hot assets kept in memory for the transfer tasks, up to a size budget.
+///
+/// Admission is TinyLFU: a count-min sketch keeps track of how often each range was asked for recently, and a range that
+/// would need to evict others only makes it in if it was asked for more often than the least recently used ranges it
+/// would evict. Concurrent requests for a range that isn't in memory share a single read of the file.
+class AssetCache {
+public:
+    static const qint64 DEFAULT_CAPACITY; // bytes
+
+    using Loader = std::function<QByteArray()>;
+
+    explicit AssetCache(qint64 capacity = DEFAULT_CAPACITY);
+
+    /// Ranges larger than this are never cached, they are streamed from the file
+    qint64 getMaxRangeSize() const { return _capacity / MIN_RANGES_PER_CAPACITY; }
+
+    /// Returns the range of the asset, from memory or from the loader. Only one of the concurrent callers for the same
+    /// range runs the loader, the others wait for its result. A result from the loader that isn't size bytes long,
+    /// a null one included, is never cached.
+    QByteArray get(const QByteArray& assetHash, qint64 offset, qint64 size, const Loader& loader);
+
+    qint64 getCapacity() const { return _capacity; }
+    qint64 getSize() const;
+    int getNumRanges() const;
+
+    uint64_t getNumRequests() const { return _numRequests; }
+    uint64_t getNumHits() const { return _numHits; }
+    uint64_t getNumCoalescedRequests() const { return _numCoalescedRequests; }
+    uint64_t getNumRejected() const { return _numRejected; }
+    uint64_t getBytesServedFromCache() const { return _bytesServedFromCache; }
+
+private:
+    static const qint64 MIN_RANGES_PER_CAPACITY = 8;
+
+    // Approximate recent request counts, 4 bit counters halved every so many increments so that old popularity fades
+    class FrequencySketch {
+    public:
+        FrequencySketch();
+
+        void increment(uint hash);
+        int getFrequency(uint hash) const;
+
+    private:
+        int getIndex(uint hash, int row) const;
+
+        std::vector<uint8_t> _counters;
+        int _numIncrements { 0 };
+    };
+
+    struct Range {
+        QByteArray key;
+        QByteArray data;
+    };
+    using Ranges = std::list<Range>;
+
+    static QByteArray computeKey(const QByteArray& assetHash, qint64 offset, qint64 size);
+
+    // keeps the range if it's worth what it would evict, lock held
+    void admit(const QByteArray& key, uint keyHash, const QByteArray& data);
+
+    const qint64 _capacity;
+
+    mutable std::mutex _mutex;
+    Ranges _ranges; // most recently used first
+    QHash<QByteArray, Ranges::iterator> _rangesByKey;
+    QHash<QByteArray, std::shared_future<QByteArray>> _pendingLoads;
+    FrequencySketch _sketch;
+    qint64 _size { 0 };
+
+    std::atomic<uint64_t> _numRequests { 0 };
+    std::atomic<uint64_t> _numHits { 0 };
+    std::atomic<uint64_t> _numCoalescedRequests { 0 };
+    std::atomic<uint64_t> _numRejected { 0 };
+    std::atomic<uint64_t> _bytesServedFromCache { 0 };
+};
+
+using AssetCachePointer = std::shared_ptr<AssetCache>;
+
+#endif // hifi_AssetCache_h
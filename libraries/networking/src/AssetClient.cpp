@@ -14,6 +14,7 @@
 #include <cstdint>
 
 #include <QtCore/QBuffer>
+#include <QtCore/QDir>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QThread>
 #include <QtScript/QScriptEngine>
@@ -56,29 +57,51 @@ AssetClient::AssetClient() {
 void AssetClient::initCaching() {
     Q_ASSERT(QThread::currentThread() == thread());
 
-    // Setup disk cache if not already
-    auto& networkAccessManager = NetworkAccessManager::getInstance();
-    if (!networkAccessManager.cache()) {
-        if (_cacheDir.isEmpty()) {
+    if (_cacheDir.isEmpty()) {
 #ifdef Q_OS_ANDROID
-            QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
 #else
-            QString cachePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+        QString cachePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
 #endif
-            _cacheDir = !cachePath.isEmpty() ? cachePath : "interfaceCache";
-        }
+        _cacheDir = !cachePath.isEmpty() ? cachePath : "interfaceCache";
+    }
+
+    // the two disk caches share the one budget, most of it goes to assets since they are what most of the content is
+    static const qint64 ASSET_CACHE_SIZE = MAXIMUM_CACHE_SIZE / 4 * 3;
+    static const qint64 HTTP_CACHE_SIZE = MAXIMUM_CACHE_SIZE - ASSET_CACHE_SIZE;
+
+    // Setup disk cache if not already
+    //
+    // HTTP responses stay in a QNetworkDiskCache rather than going through the asset FileCache: the network access
+    // manager reads and writes its cache synchronously on its own thread and needs the headers and expiry of each
+    // response, so a QAbstractNetworkCache on top of the FileCache would neither take that I/O off the thread nor
+    // keep its semantics. What sharing it would get us, one budget for both, is done by splitting the budget here.
+    auto& networkAccessManager = NetworkAccessManager::getInstance();
+    if (!networkAccessManager.cache()) {
         QNetworkDiskCache* cache = new QNetworkDiskCache();
-        cache->setMaximumCacheSize(MAXIMUM_CACHE_SIZE);
+        cache->setMaximumCacheSize(HTTP_CACHE_SIZE);
         cache->setCacheDirectory(_cacheDir);
         networkAccessManager.setCache(cache);
         qInfo() << "ResourceManager disk cache setup at" << _cacheDir
-                 << "(size:" << MAXIMUM_CACHE_SIZE / BYTES_PER_GIGABYTES << "GB)";
+                 << "(size:" << (double)HTTP_CACHE_SIZE / BYTES_PER_GIGABYTES << "GB)";
     } else {
         auto cache = qobject_cast<QNetworkDiskCache*>(networkAccessManager.cache());
         qInfo() << "ResourceManager disk cache already setup at" << cache->cacheDirectory()
                 << "(size:" << cache->maximumCacheSize() / BYTES_PER_GIGABYTES << "GB)";
     }
 
+    // whole assets have a cache of their own, by hash: they never go stale and are read and written off this thread
+    if (!_fileCache) {
+        static const QString ASSET_CACHE_DIRECTORY = "assets";
+        static const std::string ASSET_CACHE_EXTENSION = "atp";
+        _fileCache = std::make_shared<cache::FileCache>(QDir(_cacheDir).filePath(ASSET_CACHE_DIRECTORY).toStdString(),
+                                                        ASSET_CACHE_EXTENSION);
+        _fileCache->initialize();
+        _fileCache->setMaxSize(ASSET_CACHE_SIZE);
+        qInfo() << "Asset disk cache setup at" << QDir(_cacheDir).filePath(ASSET_CACHE_DIRECTORY) << "with"
+                << _fileCache->getNumTotalFiles() << "assets (size:" << (double)ASSET_CACHE_SIZE / BYTES_PER_GIGABYTES
+                << "GB)";
+    }
 }
 
 namespace {
@@ -314,6 +337,10 @@ void AssetClient::clearCache() {
     } else {
         qCWarning(asset_client) << "No disk cache to clear.";
     }
+
+    if (_fileCache) {
+        _fileCache->wipe();
+    }
 }
 
 void AssetClient::handleAssetMappingOperationReply(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
@@ -510,6 +537,12 @@ void AssetClient::handleAssetGetInfoReply(QSharedPointer<ReceivedMessage> messag
 
     if (error == AssetUtils::AssetServerError::NoError) {
         message->readPrimitive(&info.size);
+
+        quint32 numChunkHashes = 0;
+        if (message->getBytesLeftToRead() >= (qint64)sizeof(numChunkHashes)) {
+            message->readPrimitive(&numChunkHashes);
+            info.chunkHashes = message->read(numChunkHashes * AssetUtils::SHA256_HASH_LENGTH);
+        }
     }
 
     // Check if we have any pending requests for this node
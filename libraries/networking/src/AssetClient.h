@@ -19,6 +19,7 @@
 #include <map>
 
 #include <DependencyManager.h>
+#include <shared/FileCache.h>
 #include <shared/MiniPromises.h>
 
 #include "AssetUtils.h"
@@ -40,6 +41,7 @@ class AssetUpload;
 struct AssetInfo {
     QString hash;
     int64_t size;
+    QByteArray chunkHashes; // of each chunk of a large asset, if the asset server has them
 };
 
 using MappingOperationCallback = std::function<void(bool responseReceived, AssetUtils::AssetServerError serverError, QSharedPointer<ReceivedMessage> message)>;
@@ -118,6 +120,8 @@ private:
     std::unordered_map<SharedNodePointer, std::unordered_map<MessageID, UploadResultCallback>> _pendingUploads;
 
     QString _cacheDir;
+    // whole assets, by hash
+    cache::FileCachePointer _fileCache;
 
     friend class AssetRequest;
     friend class AssetUpload;
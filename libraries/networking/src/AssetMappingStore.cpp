@@ -0,0 +1,383 @@
+//
+//  AssetMappingStore.cpp
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetMappingStore.h"
+
+#include <algorithm>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "NetworkLogging.h"
+
+static const QByteArray LOG_MAGIC = "HFAM";
+static const quint32 LOG_VERSION = 1;
+static const int LOG_HEADER_SIZE = 4 + sizeof(quint32);
+// payload size and checksum
+static const int RECORD_HEADER_SIZE = sizeof(quint32) + sizeof(quint16);
+
+static const int SNAPSHOT_OPERATIONS_PER_RECORD = 1000;
+static const int MIN_OPERATIONS_BEFORE_COMPACTION = 1000;
+static const int COMPACTION_FACTOR = 4;
+
+static bool isFolder(const AssetUtils::AssetPath& path) {
+    return path.endsWith('/');
+}
+
+static QByteArray createHeader() {
+    QByteArray header = LOG_MAGIC;
+    quint32 version = qToBigEndian(LOG_VERSION);
+    header.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    return header;
+}
+
+static QByteArray createRecord(const QByteArray& payload) {
+    quint32 size = qToBigEndian((quint32)payload.size());
+    quint16 checksum = qToBigEndian(qChecksum(payload.constData(), payload.size()));
+
+    QByteArray record;
+    record.reserve(RECORD_HEADER_SIZE + payload.size());
+    record.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    record.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    record.append(payload);
+    return record;
+}
+
+static bool syncToDisk(QFile& file) {
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return fsync(file.handle()) == 0;
+#endif
+}
+
+QByteArray AssetMappingStore::serialize(const Operations& operations) {
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << (quint32)operations.size();
+    for (const auto& operation : operations) {
+        stream << (quint8)operation.type << operation.first << operation.second;
+    }
+    return payload;
+}
+
+bool AssetMappingStore::deserialize(const QByteArray& payload, Operations& operations) {
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 numOperations;
+    stream >> numOperations;
+    for (quint32 i = 0; i < numOperations && stream.status() == QDataStream::Ok; ++i) {
+        quint8 type;
+        Operation operation;
+        stream >> type >> operation.first >> operation.second;
+        if (type > Operation::RenameFolder) {
+            return false;
+        }
+        operation.type = (Operation::Type)type;
+        operations.push_back(operation);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool AssetMappingStore::load(const QString& logFilePath) {
+    QFile file { logFilePath };
+    if (!file.exists()) {
+        return reset(logFilePath, Mappings());
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(networking) << "Failed to open asset mapping log at" << logFilePath;
+        return false;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    if (data.size() < LOG_HEADER_SIZE || !data.startsWith(LOG_MAGIC) ||
+        qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data.constData()) + LOG_MAGIC.size()) > LOG_VERSION) {
+        qCWarning(networking) << "Asset mapping log at" << logFilePath << "is not one we can read";
+        return false;
+    }
+
+    _logFilePath = logFilePath;
+    _mappings.clear();
+    _hashReferenceCounts.clear();
+    _numLoggedOperations = 0;
+
+    int offset = LOG_HEADER_SIZE;
+    while (offset < data.size()) {
+        if (data.size() - offset < RECORD_HEADER_SIZE) {
+            break;
+        }
+        auto recordHeader = reinterpret_cast<const uchar*>(data.constData()) + offset;
+        quint32 payloadSize = qFromBigEndian<quint32>(recordHeader);
+        quint16 checksum = qFromBigEndian<quint16>(recordHeader + sizeof(quint32));
+        if ((quint32)(data.size() - offset - RECORD_HEADER_SIZE) < payloadSize) {
+            break;
+        }
+
+        QByteArray payload = QByteArray::fromRawData(data.constData() + offset + RECORD_HEADER_SIZE, payloadSize);
+        Operations operations;
+        if (qChecksum(payload.constData(), payload.size()) != checksum || !deserialize(payload, operations)) {
+            break;
+        }
+
+        for (const auto& operation : operations) {
+            apply(operation, nullptr, nullptr);
+        }
+        _numLoggedOperations += (int)operations.size();
+        offset += RECORD_HEADER_SIZE + payloadSize;
+    }
+
+    if (offset < data.size()) {
+        // the last change didn't make it to disk in full, so it never happened
+        qCWarning(networking) << "Dropping" << data.size() - offset << "bytes of an incomplete record at the end of"
+                              << logFilePath;
+        if (!QFile::resize(logFilePath, offset)) {
+            qCWarning(networking) << "Failed to truncate asset mapping log at" << logFilePath;
+            return false;
+        }
+    }
+
+    qCDebug(networking) << "Loaded" << _mappings.size() << "mappings from" << _numLoggedOperations
+                        << "logged operations at" << logFilePath;
+    return openLog();
+}
+
+bool AssetMappingStore::reset(const QString& logFilePath, const Mappings& mappings) {
+    _logFilePath = logFilePath;
+    _mappings.clear();
+    _hashReferenceCounts.clear();
+    for (const auto& mapping : mappings) {
+        assign(mapping.first, mapping.second, nullptr);
+    }
+    return compact();
+}
+
+bool AssetMappingStore::set(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash) {
+    Operation operation { Operation::Set, path, hash };
+    Undo undo;
+    apply(operation, &undo, nullptr);
+
+    if (!append({ operation })) {
+        rollback(undo);
+        return false;
+    }
+    return true;
+}
+
+bool AssetMappingStore::remove(const AssetUtils::AssetPathList& paths, Mappings& removedMappings) {
+    Operations operations;
+    Undo undo;
+    for (const auto& path : paths) {
+        Operation operation { isFolder(path) ? Operation::RemoveFolder : Operation::Remove, path, QString() };
+        if (apply(operation, &undo, &removedMappings)) {
+            operations.push_back(operation);
+        }
+    }
+
+    if (!operations.empty() && !append(operations)) {
+        rollback(undo);
+        removedMappings.clear();
+        return false;
+    }
+    return true;
+}
+
+bool AssetMappingStore::rename(const AssetUtils::AssetPath& oldPath, const AssetUtils::AssetPath& newPath) {
+    Operation operation { isFolder(oldPath) ? Operation::RenameFolder : Operation::Rename, oldPath, newPath };
+    Undo undo;
+    if (!apply(operation, &undo, nullptr)) {
+        // an empty folder renames fine, a file that isn't there doesn't
+        return operation.type == Operation::RenameFolder;
+    }
+
+    if (!append({ operation })) {
+        rollback(undo);
+        return false;
+    }
+    return true;
+}
+
+bool AssetMappingStore::apply(const Operation& operation, Undo* undo, Mappings* removedMappings) {
+    switch (operation.type) {
+        case Operation::Set:
+            assign(operation.first, operation.second, undo);
+            return true;
+
+        case Operation::Remove: {
+            auto it = _mappings.find(operation.first);
+            if (it == _mappings.end()) {
+                return false;
+            }
+            erase(it, undo, removedMappings);
+            return true;
+        }
+
+        case Operation::RemoveFolder: {
+            // everything in the folder sorts right after it
+            auto it = _mappings.lower_bound(operation.first);
+            bool removedAny = false;
+            while (it != _mappings.end() && it->first.startsWith(operation.first)) {
+                it = erase(it, undo, removedMappings);
+                removedAny = true;
+            }
+            return removedAny;
+        }
+
+        case Operation::Rename: {
+            auto it = _mappings.find(operation.first);
+            if (it == _mappings.end()) {
+                return false;
+            }
+            auto hash = it->second;
+            erase(it, undo, nullptr);
+            assign(operation.second, hash, undo);
+            return true;
+        }
+
+        case Operation::RenameFolder: {
+            // take everything out first, the new folder could be inside the old one
+            std::vector<std::pair<AssetUtils::AssetPath, AssetUtils::AssetHash>> renamedMappings;
+            auto it = _mappings.lower_bound(operation.first);
+            while (it != _mappings.end() && it->first.startsWith(operation.first)) {
+                auto newPath = it->first;
+                newPath.replace(0, operation.first.size(), operation.second);
+                renamedMappings.emplace_back(newPath, it->second);
+                it = erase(it, undo, nullptr);
+            }
+            for (const auto& mapping : renamedMappings) {
+                assign(mapping.first, mapping.second, undo);
+            }
+            return !renamedMappings.empty();
+        }
+    }
+    return false;
+}
+
+void AssetMappingStore::assign(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash, Undo* undo) {
+    auto it = _mappings.find(path);
+    if (it != _mappings.end()) {
+        if (undo) {
+            undo->emplace_back(path, it->second);
+        }
+        auto count = _hashReferenceCounts.find(it->second);
+        if (--count.value() == 0) {
+            _hashReferenceCounts.erase(count);
+        }
+        it->second = hash;
+    } else {
+        if (undo) {
+            undo->emplace_back(path, AssetUtils::AssetHash());
+        }
+        _mappings.emplace(path, hash);
+    }
+    ++_hashReferenceCounts[hash];
+}
+
+AssetMappingStore::Mappings::iterator AssetMappingStore::erase(Mappings::iterator it, Undo* undo,
+                                                               Mappings* removedMappings) {
+    if (undo) {
+        undo->emplace_back(it->first, it->second);
+    }
+    if (removedMappings) {
+        (*removedMappings)[it->first] = it->second;
+    }
+    auto count = _hashReferenceCounts.find(it->second);
+    if (--count.value() == 0) {
+        _hashReferenceCounts.erase(count);
+    }
+    return _mappings.erase(it);
+}
+
+void AssetMappingStore::rollback(const Undo& undo) {
+    for (auto it = undo.rbegin(); it != undo.rend(); ++it) {
+        if (it->second.isEmpty()) {
+            auto mapping = _mappings.find(it->first);
+            if (mapping != _mappings.end()) {
+                erase(mapping, nullptr, nullptr);
+            }
+        } else {
+            assign(it->first, it->second, nullptr);
+        }
+    }
+}
+
+bool AssetMappingStore::append(const Operations& operations) {
+    QByteArray record = createRecord(serialize(operations));
+
+    auto sizeBefore = _logFile.size();
+    if (!_logFile.isOpen() || _logFile.write(record) != record.size() || !syncToDisk(_logFile)) {
+        qCWarning(networking) << "Failed to write to asset mapping log at" << _logFilePath;
+        // don't leave part of the record behind for the next one to be appended to
+        _logFile.resize(sizeBefore);
+        return false;
+    }
+
+    _numLoggedOperations += (int)operations.size();
+    if (_numLoggedOperations > std::max(MIN_OPERATIONS_BEFORE_COMPACTION, COMPACTION_FACTOR * (int)_mappings.size())) {
+        // the log is still good if this fails, it'll be tried again on the next change
+        compact();
+    }
+    return true;
+}
+
+bool AssetMappingStore::compact() {
+    QSaveFile snapshot { _logFilePath };
+    if (!snapshot.open(QIODevice::WriteOnly)) {
+        qCWarning(networking) << "Failed to open asset mapping log at" << _logFilePath << "to compact it";
+        return false;
+    }
+
+    snapshot.write(createHeader());
+    Operations operations;
+    operations.reserve(SNAPSHOT_OPERATIONS_PER_RECORD);
+    for (const auto& mapping : _mappings) {
+        operations.push_back({ Operation::Set, mapping.first, mapping.second });
+        if ((int)operations.size() == SNAPSHOT_OPERATIONS_PER_RECORD) {
+            snapshot.write(createRecord(serialize(operations)));
+            operations.clear();
+        }
+    }
+    if (!operations.empty()) {
+        snapshot.write(createRecord(serialize(operations)));
+    }
+
+    // the old log can't be replaced while it's open on some platforms
+    _logFile.close();
+    bool isCompacted = snapshot.commit();
+    if (isCompacted) {
+        _numLoggedOperations = (int)_mappings.size();
+    } else {
+        qCWarning(networking) << "Failed to write compacted asset mapping log at" << _logFilePath;
+    }
+
+    return openLog() && isCompacted;
+}
+
+bool AssetMappingStore::openLog() {
+    _logFile.close();
+    _logFile.setFileName(_logFilePath);
+    if (!_logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCWarning(networking) << "Failed to open asset mapping log at" << _logFilePath;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+//
+//  AssetMappingStore.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetMappingStore_h
+#define hifi_AssetMappingStore_h
+
+#include <vector>
+
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+
+#include "AssetUtils.h"
+
+/// The asset server's path to hash mappings, ordered in memory and persisted to an append-only log of the operations
+/// made on them.
+///
+/// Each change appends one record to the log rather than rewriting every mapping, and changes to a folder are a single
+/// record however many mappings are in it. Once the log has grown to a few times the number of mappings it is compacted
+/// into a snapshot of them. A record that didn't make it to disk in full is dropped when the log is loaded.
+class AssetMappingStore {
+public:
+    using Mappings = AssetUtils::Mappings;
+    using const_iterator = Mappings::const_iterator;
+
+    /// Loads the mappings from the log at the path, or starts an empty one if there's none
+    bool load(const QString& logFilePath);
+    /// Starts a new log at the path with the mappings, for the mappings of older versions of the asset server
+    bool reset(const QString& logFilePath, const Mappings& mappings);
+
+    const_iterator begin() const { return _mappings.cbegin(); }
+    const_iterator end() const { return _mappings.cend(); }
+    const_iterator cbegin() const { return _mappings.cbegin(); }
+    const_iterator cend() const { return _mappings.cend(); }
+    const_iterator find(const AssetUtils::AssetPath& path) const { return _mappings.find(path); }
+    size_t size() const { return _mappings.size(); }
+
+    /// True if some path is mapped to the hash
+    bool isMapped(const AssetUtils::AssetHash& hash) const { return _hashReferenceCounts.contains(hash); }
+
+    // Changes are persisted before they return. If they can't be, they are undone and false is returned.
+
+    bool set(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash);
+    /// Removes the mappings of the files and of everything in the folders (paths ending with a slash), returning what
+    /// was removed in removedMappings
+    bool remove(const AssetUtils::AssetPathList& paths, Mappings& removedMappings);
+    /// Renames a file, or a folder and everything in it. False if there's nothing to rename.
+    bool rename(const AssetUtils::AssetPath& oldPath, const AssetUtils::AssetPath& newPath);
+
+    /// Number of operations in the log, for tests
+    int getNumLoggedOperations() const { return _numLoggedOperations; }
+
+private:
+    class Operation {
+    public:
+        enum Type : uint8_t {
+            Set = 0,
+            Remove,
+            RemoveFolder,
+            Rename,
+            RenameFolder
+        };
+
+        Type type;
+        QString first;
+        QString second;
+    };
+    using Operations = std::vector<Operation>;
+
+    // what to put back if an operation can't be persisted, an empty hash for mappings that didn't exist
+    using Undo = std::vector<std::pair<AssetUtils::AssetPath, AssetUtils::AssetHash>>;
+
+    static QByteArray serialize(const Operations& operations);
+    static bool deserialize(const QByteArray& record, Operations& operations);
+
+    // Returns false if the operation had nothing to apply to
+    bool apply(const Operation& operation, Undo* undo, Mappings* removedMappings);
+    void assign(const AssetUtils::AssetPath& path, const AssetUtils::AssetHash& hash, Undo* undo);
+    Mappings::iterator erase(Mappings::iterator it, Undo* undo, Mappings* removedMappings);
+    void rollback(const Undo& undo);
+
+    bool append(const Operations& operations);
+    bool compact();
+    bool openLog();
+
+    Mappings _mappings;
+    QHash<AssetUtils::AssetHash, int> _hashReferenceCounts;
+
+    QString _logFilePath;
+    QFile _logFile;
+    int _numLoggedOperations { 0 };
+};
+
+#endif // hifi_AssetMappingStore_h
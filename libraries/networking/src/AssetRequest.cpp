@@ -14,6 +14,7 @@
 #include <algorithm>
 
 #include <QtCore/QThread>
+#include <QtCore/QTimer>
 
 #include <StatTracker.h>
 #include <Trace.h>
@@ -34,12 +35,15 @@ AssetRequest::AssetRequest(const QString& hash, const ByteRange& byteRange) :
 }
 
 AssetRequest::~AssetRequest() {
-    auto assetClient = DependencyManager::get<AssetClient>();
-    if (_assetRequestID) {
-        assetClient->cancelGetAssetRequest(_assetRequestID);
-    }
+    cancelPendingRequests();
 }
 
+static const int MAX_CONCURRENT_CHUNK_REQUESTS = 4;
+// consecutive times the asset server can't be reached before a download is given up on
+static const int MAX_RETRIES = 10;
+static const int RETRY_DELAY_MSECS = 1000;
+static const int MAX_CHUNK_VERIFICATION_FAILURES = 3;
+
 void AssetRequest::start() {
     if (QThread::currentThread() != thread()) {
         QMetaObject::invokeMethod(this, "start", Qt::AutoConnection);
@@ -60,21 +64,73 @@ void AssetRequest::start() {
         return;
     }
     
-    // Try to load from cache
-    _data = AssetUtils::loadFromCache(getUrl());
-    if (!_data.isNull()) {
-        _error = NoError;
+    _state = WaitingForData;
 
-        _loadedFromCache = true;
+    // Try to load from cache, which is read off this thread
+    auto assetClient = DependencyManager::get<AssetClient>();
+    if (auto fileCache = assetClient->_fileCache) {
+        auto that = QPointer<AssetRequest>(this); // Used to track the request's lifetime
+        fileCache->readFileAsync(_hash.toStdString(), [assetClient, that](const QByteArray& data) {
+            QMetaObject::invokeMethod(assetClient.data(), [that, data] {
+                if (that) {
+                    that->handleCachedData(data);
+                }
+            });
+        });
+    } else {
+        requestData();
+    }
+}
 
-        _state = Finished;
-        emit finished(this);
+void AssetRequest::handleCachedData(const QByteArray& data) {
+    if (_state != WaitingForData) {
+        return;
+    }
 
+    if (data.isNull()) {
+        requestData();
         return;
     }
 
-    _state = WaitingForData;
+    // the cache has all of the asset
+    ByteRange range = _byteRange;
+    range.fixupRange(data.size());
+    auto offset = range.fromInclusive >= 0 ? range.fromInclusive : data.size() + range.fromInclusive;
+    if (offset + range.size() > data.size()) {
+        fail(InvalidByteRange);
+        return;
+    }
+
+    _loadedFromCache = true;
+    _data = data.mid(offset, range.size());
+    _totalReceived = _data.size();
+    _error = NoError;
+    _state = Finished;
+    emit finished(this);
+}
+
+void AssetRequest::requestData() {
+    if (_byteRange.isSet()) {
+        requestRange();
+    } else {
+        requestAsset();
+    }
+}
+
+AssetRequest::Error AssetRequest::toError(AssetUtils::AssetServerError serverError) {
+    switch (serverError) {
+        case AssetUtils::AssetServerError::NoError:
+            return NoError;
+        case AssetUtils::AssetServerError::AssetNotFound:
+            return NotFound;
+        case AssetUtils::AssetServerError::InvalidByteRange:
+            return InvalidByteRange;
+        default:
+            return UnknownError;
+    }
+}
 
+void AssetRequest::requestRange() {
     auto assetClient = DependencyManager::get<AssetClient>();
     auto that = QPointer<AssetRequest>(this); // Used to track the request's lifetime
     auto hash = _hash;
@@ -90,42 +146,12 @@ void AssetRequest::start() {
         _assetRequestID = INVALID_MESSAGE_ID;
 
         if (!responseReceived) {
-            _error = NetworkError;
+            fail(NetworkError);
         } else if (serverError != AssetUtils::AssetServerError::NoError) {
-            switch (serverError) {
-                case AssetUtils::AssetServerError::AssetNotFound:
-                    _error = NotFound;
-                    break;
-                case AssetUtils::AssetServerError::InvalidByteRange:
-                    _error = InvalidByteRange;
-                    break;
-                default:
-                    _error = UnknownError;
-                    break;
-            }
+            fail(toError(serverError));
         } else {
-            if (!_byteRange.isSet() && AssetUtils::hashData(data).toHex() != _hash) {
-                // the hash of the received data does not match what we expect, so we return an error
-                _error = HashVerificationFailed;
-            }
-
-            if (_error == NoError) {
-                _data = data;
-                _totalReceived += data.size();
-                emit progress(_totalReceived, data.size());
-
-                if (!_byteRange.isSet()) {
-                    AssetUtils::saveToCache(getUrl(), data);
-                }
-            }
-        }
-        
-        if (_error != NoError) {
-            qCWarning(asset_client) << "Got error retrieving asset" << _hash << "- error code" << _error;
+            finish(data);
         }
-        
-        _state = Finished;
-        emit finished(this);
     }, [this, that](qint64 totalReceived, qint64 total) {
         if (!that) {
             // If the request is dead, return
@@ -135,6 +161,229 @@ void AssetRequest::start() {
     });
 }
 
+void AssetRequest::requestAsset() {
+    auto assetClient = DependencyManager::get<AssetClient>();
+    auto that = QPointer<AssetRequest>(this); // Used to track the request's lifetime
+
+    _assetInfoRequestID = assetClient->getAssetInfo(_hash,
+        [this, that](bool responseReceived, AssetUtils::AssetServerError serverError, AssetInfo info) {
+        if (that) {
+            _assetInfoRequestID = INVALID_MESSAGE_ID;
+            handleAssetInfo(responseReceived, serverError, info);
+        }
+    });
+    if (_state != WaitingForData) {
+        return;
+    }
+
+    // a negative range past the start of the asset is all of it
+    _assetRequestID = assetClient->getAsset(_hash, -AssetUtils::ASSET_CHUNK_SIZE, 0,
+        [this, that](bool responseReceived, AssetUtils::AssetServerError serverError, const QByteArray& data) {
+        if (that) {
+            _assetRequestID = INVALID_MESSAGE_ID;
+            handleAssetEnd(responseReceived, serverError, data);
+        }
+    }, [this, that](qint64 totalReceived, qint64 total) {
+        // until the chunks take over
+        if (that && (!_hasAssetInfo || _assetInfo.size <= AssetUtils::ASSET_CHUNK_SIZE)) {
+            emit progress(totalReceived, total);
+        }
+    });
+}
+
+void AssetRequest::handleAssetInfo(bool responseReceived, AssetUtils::AssetServerError serverError,
+                                   const AssetInfo& info) {
+    if (_state != WaitingForData) {
+        return;
+    }
+
+    if (!responseReceived) {
+        fail(NetworkError);
+    } else if (serverError != AssetUtils::AssetServerError::NoError) {
+        fail(toError(serverError));
+    } else {
+        _hasAssetInfo = true;
+        _assetInfo = info;
+        maybeStartChunks();
+    }
+}
+
+void AssetRequest::handleAssetEnd(bool responseReceived, AssetUtils::AssetServerError serverError,
+                                  const QByteArray& data) {
+    if (_state != WaitingForData) {
+        return;
+    }
+
+    if (!responseReceived) {
+        fail(NetworkError);
+    } else if (serverError != AssetUtils::AssetServerError::NoError) {
+        fail(toError(serverError));
+    } else {
+        _hasAssetEnd = true;
+        _assetEnd = data;
+        maybeStartChunks();
+    }
+}
+
+void AssetRequest::maybeStartChunks() {
+    if (!_hasAssetInfo || !_hasAssetEnd) {
+        return;
+    }
+
+    if (_assetEnd.size() == _assetInfo.size) {
+        // that was all of it
+        if (AssetUtils::hashData(_assetEnd).toHex() != _hash) {
+            // the hash of the received data does not match what we expect, so we return an error
+            fail(HashVerificationFailed);
+        } else {
+            finish(_assetEnd);
+        }
+        return;
+    }
+
+    // the size comes from the asset server, make sure it's one we can hold before setting aside room for it
+    if (_assetInfo.size < _assetEnd.size() || _assetInfo.size > ChunkedAssetDownload::MAX_SIZE) {
+        qCWarning(asset_client) << "Can't fetch" << _assetInfo.size << "bytes of" << _hash << "having got the last"
+                                << _assetEnd.size();
+        fail(SizeVerificationFailed);
+        return;
+    }
+
+    qCDebug(asset_client) << "Fetching" << _assetInfo.size << "bytes of" << _hash << "in chunks,"
+                          << (_assetInfo.chunkHashes.isEmpty() ? "without" : "with") << "chunk hashes";
+    _download.reset(new ChunkedAssetDownload(QByteArray::fromHex(_hash.toLatin1()), _assetInfo.size,
+                                             _assetInfo.chunkHashes));
+    _download->addEnd(_assetEnd);
+    _assetEnd.clear();
+    requestChunks();
+}
+
+void AssetRequest::requestChunks() {
+    if (_state != WaitingForData) {
+        return;
+    }
+
+    auto assetClient = DependencyManager::get<AssetClient>();
+    auto that = QPointer<AssetRequest>(this); // Used to track the request's lifetime
+
+    ByteRange range;
+    while (!_isWaitingToRetry && (int)_chunkRequestIDs.size() < MAX_CONCURRENT_CHUNK_REQUESTS &&
+           _download->takeRangeToRequest(range)) {
+        auto messageID = assetClient->getAsset(_hash, range.fromInclusive, range.toExclusive,
+            [this, that, range](bool responseReceived, AssetUtils::AssetServerError serverError, const QByteArray& data) {
+            if (that) {
+                handleChunk(range, responseReceived, serverError, data);
+            }
+        }, [](qint64, qint64) {});
+
+        // it fails right away if there's no asset server
+        if (messageID != INVALID_MESSAGE_ID) {
+            _chunkRequestIDs[range.fromInclusive] = messageID;
+        }
+        if (_state != WaitingForData) {
+            return;
+        }
+    }
+
+    if (_download->isComplete() && _chunkRequestIDs.empty()) {
+        auto verification = _download->verify();
+        if (verification == ChunkedAssetDownload::Verified) {
+            finish(_download->takeData());
+        } else if (verification == ChunkedAssetDownload::Failed ||
+                   _download->getNumVerificationFailures() > MAX_CHUNK_VERIFICATION_FAILURES) {
+            fail(HashVerificationFailed);
+        } else {
+            // only the chunks that went bad
+            requestChunks();
+        }
+    }
+}
+
+void AssetRequest::handleChunk(const ByteRange& range, bool responseReceived, AssetUtils::AssetServerError serverError,
+                               const QByteArray& data) {
+    _chunkRequestIDs.erase(range.fromInclusive);
+    if (_state != WaitingForData) {
+        return;
+    }
+
+    if (!responseReceived) {
+        // keep what we have and pick up from there once the asset server is back
+        _download->returnRange(range);
+        if (!_isWaitingToRetry) {
+            if (++_numRetries > MAX_RETRIES) {
+                fail(NetworkError);
+                return;
+            }
+            _isWaitingToRetry = true;
+            QTimer::singleShot(RETRY_DELAY_MSECS, this, [this] {
+                _isWaitingToRetry = false;
+                requestChunks();
+            });
+        }
+        return;
+    }
+
+    if (serverError != AssetUtils::AssetServerError::NoError) {
+        fail(toError(serverError));
+        return;
+    }
+
+    if (_download->addChunk(range.fromInclusive, data)) {
+        _numRetries = 0;
+        _totalReceived = _download->getBytesReceived();
+        emit progress(_download->getBytesReceived(), _download->getSize());
+    } else if (_download->getNumVerificationFailures() > MAX_CHUNK_VERIFICATION_FAILURES) {
+        fail(HashVerificationFailed);
+        return;
+    }
+
+    requestChunks();
+}
+
+void AssetRequest::finish(const QByteArray& data) {
+    _data = data;
+    _download.reset();
+    if (_totalReceived == 0) {
+        _totalReceived += data.size();
+        emit progress(_totalReceived, data.size());
+    }
+
+    auto fileCache = DependencyManager::get<AssetClient>()->_fileCache;
+    if (fileCache && !_byteRange.isSet() && !_data.isEmpty()) {
+        fileCache->writeFileAsync(_data, cache::FileCache::Metadata(_hash.toStdString(), _data.size()));
+    }
+
+    _error = NoError;
+    _state = Finished;
+    emit finished(this);
+}
+
+void AssetRequest::fail(Error error) {
+    qCWarning(asset_client) << "Got error retrieving asset" << _hash << "- error code" << error;
+
+    cancelPendingRequests();
+    _download.reset();
+
+    _error = error;
+    _state = Finished;
+    emit finished(this);
+}
+
+void AssetRequest::cancelPendingRequests() {
+    auto assetClient = DependencyManager::get<AssetClient>();
+    if (_assetRequestID) {
+        assetClient->cancelGetAssetRequest(_assetRequestID);
+        _assetRequestID = INVALID_MESSAGE_ID;
+    }
+    if (_assetInfoRequestID) {
+        assetClient->cancelGetAssetInfoRequest(_assetInfoRequestID);
+        _assetInfoRequestID = INVALID_MESSAGE_ID;
+    }
+    for (const auto& chunkRequest : _chunkRequestIDs) {
+        assetClient->cancelGetAssetRequest(chunkRequest.second);
+    }
+    _chunkRequestIDs.clear();
+}
 
 const QString AssetRequest::getErrorString() const {
     QString result;
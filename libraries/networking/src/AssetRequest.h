@@ -12,6 +12,9 @@
 #ifndef hifi_AssetRequest_h
 #define hifi_AssetRequest_h
 
+#include <map>
+#include <memory>
+
 #include <QByteArray>
 #include <QObject>
 #include <QString>
@@ -20,6 +23,7 @@
 #include "AssetUtils.h"
 
 #include "ByteRange.h"
+#include "ChunkedAssetDownload.h"
 
 const QString ATP_SCHEME { "atp:" };
 
@@ -62,6 +66,26 @@ signals:
     void progress(qint64 totalReceived, qint64 total);
 
 private:
+    static Error toError(AssetUtils::AssetServerError serverError);
+
+    void handleCachedData(const QByteArray& data);
+    void requestData();
+    void requestRange();
+
+    // A whole asset is asked for along with its size and chunk hashes, from the end of it. That's all of it if it's no
+    // larger than a chunk, otherwise the rest is fetched a few chunks at a time.
+    void requestAsset();
+    void handleAssetEnd(bool responseReceived, AssetUtils::AssetServerError serverError, const QByteArray& data);
+    void handleAssetInfo(bool responseReceived, AssetUtils::AssetServerError serverError, const AssetInfo& info);
+    void maybeStartChunks();
+    void requestChunks();
+    void handleChunk(const ByteRange& range, bool responseReceived, AssetUtils::AssetServerError serverError,
+                     const QByteArray& data);
+
+    void finish(const QByteArray& data);
+    void fail(Error error);
+    void cancelPendingRequests();
+
     int _requestID;
     State _state = NotStarted;
     Error _error = NoError;
@@ -72,6 +96,17 @@ private:
     MessageID _assetRequestID { INVALID_MESSAGE_ID };
     const ByteRange _byteRange;
     bool _loadedFromCache { false };
+
+    MessageID _assetInfoRequestID { INVALID_MESSAGE_ID };
+    bool _hasAssetInfo { false };
+    bool _hasAssetEnd { false };
+    AssetInfo _assetInfo;
+    QByteArray _assetEnd;
+
+    std::unique_ptr<ChunkedAssetDownload> _download;
+    std::map<AssetUtils::DataOffset, MessageID> _chunkRequestIDs;
+    int _numRetries { 0 };
+    bool _isWaitingToRetry { false };
 };
 
 #endif
@@ -159,6 +159,10 @@ void AssetResourceRequest::requestHash(const AssetUtils::AssetHash& hash) {
             case AssetRequest::Error::NoError:
                 _data = req->getData();
                 _result = Success;
+                if (!_byteRange.isSet()) {
+                    _isWholeContent = true;
+                    _contentHash = req->getHash();
+                }
                 recordBytesDownloadedInStats(STAT_ATP_RESOURCE_TOTAL_BYTES, _data.size());
                 break;
             case AssetRequest::InvalidHash:
@@ -104,8 +104,9 @@ void AssetUpload::start() {
             }
         }
         
-        if (_error == NoError && hash == AssetUtils::hashData(_data).toHex()) {
-            AssetUtils::saveToCache(AssetUtils::getATPUrl(hash), _data);
+        auto fileCache = DependencyManager::get<AssetClient>()->_fileCache;
+        if (fileCache && _error == NoError && !_data.isEmpty() && hash == AssetUtils::hashData(_data).toHex()) {
+            fileCache->writeFileAsync(_data, cache::FileCache::Metadata(hash.toStdString(), _data.size()));
         }
         
         emit finished(this, hash);
@@ -11,14 +11,14 @@
 
 #include "AssetUtils.h"
 
+#include <algorithm>
 #include <memory>
 
-#include <QtCore/QCryptographicHash>
-#include <QtCore/QDateTime>
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
+
 #include <QtCore/QFileInfo> // for baseName
-#include <QtNetwork/QAbstractNetworkCache>
 
-#include "NetworkAccessManager.h"
 #include "NetworkLogging.h"
 #include "NetworkingConstants.h"
 
@@ -59,41 +59,46 @@ QUrl getATPUrl(const QString& input) {
 }
 
 QByteArray hashData(const QByteArray& data) {
-    return QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    Hasher hasher;
+    hasher.addData(data);
+    return hasher.result();
 }
 
-QByteArray loadFromCache(const QUrl& url) {
-    if (auto cache = NetworkAccessManager::getInstance().cache()) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000
+Hasher::Hasher() : _context(EVP_MD_CTX_new()) {
+    EVP_DigestInit_ex(_context, EVP_sha256(), nullptr);
+}
 
-        // caller is responsible for the deletion of the ioDevice, hence the unique_ptr
-        if (auto ioDevice = std::unique_ptr<QIODevice>(cache->data(url))) {
-            return ioDevice->readAll();
-        }
+Hasher::~Hasher() {
+    EVP_MD_CTX_free(_context);
+}
+#else
+Hasher::Hasher() : _context(EVP_MD_CTX_create()) {
+    EVP_DigestInit_ex(_context, EVP_sha256(), nullptr);
+}
 
+Hasher::~Hasher() {
+    EVP_MD_CTX_destroy(_context);
+}
+#endif
+
+void Hasher::addData(const char* data, qint64 size) {
+    // in pieces, EVP_DigestUpdate takes a size_t but let's not rely on it being 64 bits
+    static const qint64 MAX_UPDATE_SIZE = 1 << 30;
+    while (size > 0) {
+        qint64 updateSize = std::min(size, MAX_UPDATE_SIZE);
+        EVP_DigestUpdate(_context, data, (size_t)updateSize);
+        data += updateSize;
+        size -= updateSize;
     }
-
-    return QByteArray();
 }
 
-bool saveToCache(const QUrl& url, const QByteArray& file) {
-    if (auto cache = NetworkAccessManager::getInstance().cache()) {
-        if (!cache->metaData(url).isValid()) {
-            QNetworkCacheMetaData metaData;
-            metaData.setUrl(url);
-            metaData.setSaveToDisk(true);
-            metaData.setLastModified(QDateTime::currentDateTime());
-            metaData.setExpirationDate(QDateTime()); // Never expires
-
-            // ioDevice is managed by the cache and should either be passed back to insert or remove!
-            if (auto ioDevice = cache->prepare(metaData)) {
-                ioDevice->write(file);
-                cache->insert(ioDevice);
-                return true;
-            }
-        }
-    }
-    
-    return false;
+QByteArray Hasher::result() {
+    QByteArray hash(EVP_MAX_MD_SIZE, 0);
+    unsigned int hashLength = 0;
+    EVP_DigestFinal_ex(_context, reinterpret_cast<unsigned char*>(hash.data()), &hashLength);
+    hash.resize(hashLength);
+    return hash;
 }
 
 bool isValidFilePath(const AssetPath& filePath) {
@@ -19,6 +19,8 @@
 #include <QtCore/QByteArray>
 #include <QtCore/QUrl>
 
+struct evp_md_ctx_st;
+
 namespace AssetUtils {
 
 using DataOffset = int64_t;
@@ -31,6 +33,11 @@ const size_t SHA256_HASH_LENGTH = 32;
 const size_t SHA256_HASH_HEX_LENGTH = 64;
 const uint64_t MAX_UPLOAD_SIZE = 1000 * 1000 * 1000; // 1GB
 
+// larger assets are fetched a chunk at a time, several at once, and the asset server keeps the hash of each chunk in a
+// manifest next to the asset so that clients can tell which chunks went bad when the asset doesn't match its hash
+const DataOffset ASSET_CHUNK_SIZE = 1024 * 1024;
+const QString CHUNK_MANIFEST_EXTENSION = ".chunks";
+
 const QString ASSET_FILE_PATH_REGEX_STRING = "^(\\/[^\\/\\0]+)+$";
 const QString ASSET_PATH_REGEX_STRING = "^\\/([^\\/\\0]+(\\/)?)+$";
 const QString ASSET_HASH_REGEX_STRING = QString("^[a-fA-F0-9]{%1}$").arg(SHA256_HASH_HEX_LENGTH);
@@ -81,8 +88,27 @@ AssetHash extractAssetHash(const QString& input);
 
 QByteArray hashData(const QByteArray& data);
 
-QByteArray loadFromCache(const QUrl& url);
-bool saveToCache(const QUrl& url, const QByteArray& file);
+inline qint64 numChunks(qint64 size) { return (size + ASSET_CHUNK_SIZE - 1) / ASSET_CHUNK_SIZE; }
+
+/// SHA-256 of data added a piece at a time. Backed by OpenSSL, which picks the SHA extensions or the widest vector
+/// implementation the CPU supports at runtime.
+class Hasher {
+public:
+    Hasher();
+    ~Hasher();
+
+    void addData(const char* data, qint64 size);
+    void addData(const QByteArray& data) { addData(data.constData(), data.size()); }
+
+    /// The hash of everything added so far. The hasher is done after this.
+    QByteArray result();
+
+private:
+    Hasher(const Hasher& other) = delete;
+    Hasher& operator=(const Hasher& other) = delete;
+
+    struct evp_md_ctx_st* _context;
+};
 
 bool isValidFilePath(const AssetPath& path);
 bool isValidPath(const AssetPath& path);
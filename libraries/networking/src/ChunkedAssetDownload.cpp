@@ -0,0 +1,162 @@
+//
+//  ChunkedAssetDownload.cpp
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ChunkedAssetDownload.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "NetworkLogging.h"
+
+const AssetUtils::DataOffset ChunkedAssetDownload::MAX_SIZE = 1024 * 1024 * 1024;
+
+ChunkedAssetDownload::ChunkedAssetDownload(const QByteArray& assetHash, AssetUtils::DataOffset size,
+                                           const QByteArray& chunkHashes) :
+    _assetHash(assetHash),
+    _hasher(new AssetUtils::Hasher())
+{
+    Q_ASSERT(size >= 0 && size <= MAX_SIZE);
+    size = std::max((AssetUtils::DataOffset)0, std::min(size, MAX_SIZE));
+    _data = QByteArray((int)size, Qt::Uninitialized);
+    _chunkStates.resize(AssetUtils::numChunks(size), ToRequest);
+
+    int numChunks = (int)_chunkStates.size();
+    if (chunkHashes.size() == numChunks * (int)AssetUtils::SHA256_HASH_LENGTH) {
+        _chunkHashes = chunkHashes;
+    } else if (!chunkHashes.isEmpty()) {
+        qCWarning(asset_client) << "Ignoring a chunk manifest of" << chunkHashes.size() << "bytes for an asset of"
+                                << numChunks << "chunks";
+    }
+
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+        _chunksToRequest.push_back(chunk);
+    }
+}
+
+bool ChunkedAssetDownload::takeRangeToRequest(ByteRange& range) {
+    while (!_chunksToRequest.empty()) {
+        int chunk = _chunksToRequest.front();
+        _chunksToRequest.pop_front();
+
+        // it might have come in some other way since it was queued
+        if (_chunkStates[chunk] == ToRequest) {
+            _chunkStates[chunk] = Requested;
+            range = getChunkRange(chunk);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ChunkedAssetDownload::returnRange(const ByteRange& range) {
+    int chunk = (int)(range.fromInclusive / AssetUtils::ASSET_CHUNK_SIZE);
+    if (chunk < (int)_chunkStates.size() && _chunkStates[chunk] == Requested) {
+        _chunkStates[chunk] = ToRequest;
+        _chunksToRequest.push_back(chunk);
+    }
+}
+
+bool ChunkedAssetDownload::addChunk(AssetUtils::DataOffset offset, const QByteArray& data) {
+    int chunk = (int)(offset / AssetUtils::ASSET_CHUNK_SIZE);
+    if (offset % AssetUtils::ASSET_CHUNK_SIZE != 0 || chunk >= (int)_chunkStates.size()) {
+        qCWarning(asset_client) << "Got data at" << offset << "which isn't the start of a chunk";
+        return false;
+    }
+    if (_chunkStates[chunk] == Received) {
+        return true;
+    }
+
+    if (data.size() != getChunkRange(chunk).size()) {
+        ++_numVerificationFailures;
+        qCWarning(asset_client) << "Chunk" << chunk << "is" << data.size() << "bytes, asking for it again";
+        _chunkStates[chunk] = ToRequest;
+        _chunksToRequest.push_back(chunk);
+        return false;
+    }
+
+    memcpy(_data.data() + offset, data.constData(), data.size());
+    _chunkStates[chunk] = Received;
+    _bytesReceived += data.size();
+    hashReceivedChunks();
+    return true;
+}
+
+void ChunkedAssetDownload::addEnd(const QByteArray& data) {
+    if (_chunkStates.empty()) {
+        return;
+    }
+
+    // the last chunk, if all of it is there
+    auto range = getChunkRange((int)_chunkStates.size() - 1);
+    if (data.size() >= range.size()) {
+        addChunk(range.fromInclusive, data.right(range.size()));
+    }
+}
+
+ChunkedAssetDownload::Verification ChunkedAssetDownload::verify() {
+    if (!isComplete()) {
+        return Failed;
+    }
+    if (_hasher->result() == _assetHash) {
+        return Verified;
+    }
+
+    // find the chunks that went bad, there's no telling without a manifest
+    int numBadChunks = 0;
+    if (!_chunkHashes.isEmpty()) {
+        for (int chunk = 0; chunk < (int)_chunkStates.size(); ++chunk) {
+            if (!matchesChunkHash(chunk)) {
+                qCWarning(asset_client) << "Chunk" << chunk << "doesn't match its hash, asking for it again";
+                _chunkStates[chunk] = ToRequest;
+                _chunksToRequest.push_back(chunk);
+                _bytesReceived -= getChunkRange(chunk).size();
+                ++numBadChunks;
+            }
+        }
+    }
+    if (numBadChunks == 0) {
+        return Failed;
+    }
+    _numVerificationFailures += numBadChunks;
+
+    // the asset is hashed again from the start, up to the first bad chunk for now
+    _hasher.reset(new AssetUtils::Hasher());
+    _numHashedChunks = 0;
+    hashReceivedChunks();
+    return Refetching;
+}
+
+QByteArray ChunkedAssetDownload::takeData() {
+    QByteArray data;
+    std::swap(data, _data);
+    return data;
+}
+
+ByteRange ChunkedAssetDownload::getChunkRange(int chunk) const {
+    ByteRange range;
+    range.fromInclusive = chunk * AssetUtils::ASSET_CHUNK_SIZE;
+    range.toExclusive = std::min(range.fromInclusive + AssetUtils::ASSET_CHUNK_SIZE, (AssetUtils::DataOffset)_data.size());
+    return range;
+}
+
+bool ChunkedAssetDownload::matchesChunkHash(int chunk) const {
+    auto range = getChunkRange(chunk);
+    auto chunkHash = QByteArray::fromRawData(_chunkHashes.constData() + chunk * AssetUtils::SHA256_HASH_LENGTH,
+                                             AssetUtils::SHA256_HASH_LENGTH);
+    return AssetUtils::hashData(QByteArray::fromRawData(_data.constData() + range.fromInclusive, range.size())) == chunkHash;
+}
+
+void ChunkedAssetDownload::hashReceivedChunks() {
+    while (_numHashedChunks < (int)_chunkStates.size() && _chunkStates[_numHashedChunks] == Received) {
+        auto range = getChunkRange(_numHashedChunks);
+        _hasher->addData(_data.constData() + range.fromInclusive, range.size());
+        ++_numHashedChunks;
+    }
+}
@@ -0,0 +1,88 @@
+//
+//  ChunkedAssetDownload.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ChunkedAssetDownload_h
+#define hifi_ChunkedAssetDownload_h
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+
+#include "AssetUtils.h"
+#include "ByteRange.h"
+
+/// The bookkeeping of an asset fetched as several chunks at once: which chunks are left to ask for and putting the ones
+/// that arrive in place.
+///
+/// Each byte is hashed once: the hash of the whole asset is worked out as the chunks at its start come in. Only when it
+/// doesn't match are the chunks checked against the asset server's manifest of chunk hashes, to ask again for the ones
+/// that went bad without losing the others. Chunks that can't be fetched go back to be asked for again as well.
+class ChunkedAssetDownload {
+public:
+    /// The data of a download is held in a single QByteArray
+    static const AssetUtils::DataOffset MAX_SIZE;
+
+    enum Verification {
+        Verified,
+        Refetching, // the chunks that don't match the manifest are to be asked for again
+        Failed
+    };
+
+    /// assetHash is the expected hash of the whole asset. chunkHashes are the hashes of each chunk one after the other,
+    /// or empty if the asset server has none. The size must be no more than MAX_SIZE.
+    ChunkedAssetDownload(const QByteArray& assetHash, AssetUtils::DataOffset size, const QByteArray& chunkHashes);
+
+    AssetUtils::DataOffset getSize() const { return _data.size(); }
+    AssetUtils::DataOffset getBytesReceived() const { return _bytesReceived; }
+    bool hasChunkHashes() const { return !_chunkHashes.isEmpty(); }
+    int getNumVerificationFailures() const { return _numVerificationFailures; }
+
+    /// The range of the next chunk to ask for. False if they've all been asked for.
+    bool takeRangeToRequest(ByteRange& range);
+    /// Puts a range that couldn't be fetched back to be asked for again
+    void returnRange(const ByteRange& range);
+
+    /// The data of a chunk that was asked for. False if it isn't the size of the chunk, it's asked for again then.
+    bool addChunk(AssetUtils::DataOffset offset, const QByteArray& data);
+    /// The end of the asset, of which the whole chunks are kept
+    void addEnd(const QByteArray& data);
+
+    bool isComplete() const { return _bytesReceived == getSize(); }
+    /// Checks the complete asset against its hash
+    Verification verify();
+    QByteArray takeData();
+
+private:
+    enum ChunkState : uint8_t {
+        ToRequest,
+        Requested,
+        Received
+    };
+
+    ByteRange getChunkRange(int chunk) const;
+    bool matchesChunkHash(int chunk) const;
+    void hashReceivedChunks();
+
+    QByteArray _assetHash;
+    QByteArray _data;
+    QByteArray _chunkHashes;
+    std::vector<ChunkState> _chunkStates;
+    std::deque<int> _chunksToRequest;
+    AssetUtils::DataOffset _bytesReceived { 0 };
+    int _numVerificationFailures { 0 };
+
+    // the received chunks at the start are hashed as they complete
+    std::unique_ptr<AssetUtils::Hasher> _hasher;
+    int _numHashedChunks { 0 };
+};
+
+#endif // hifi_ChunkedAssetDownload_h
@@ -82,6 +82,9 @@ void FileResourceRequest::doSend() {
             _result = ResourceRequest::NotFound;
         }
     }
+
+    // the byte range was fixed up to the size of the file
+    _isWholeContent = _result == ResourceRequest::Success && _data.size() == fileSize;
     
     _state = Finished;
     emit finished();
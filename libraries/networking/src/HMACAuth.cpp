@@ -17,6 +17,36 @@
 #include <QUuid>
 #include "NetworkLogging.h"
 #include <cassert>
+#include <cstring>
+
+namespace {
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t readLittleEndian64(const unsigned char* bytes) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+inline void writeLittleEndian64(unsigned char* bytes, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+inline void sipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotateLeft(v1, 13); v1 ^= v0; v0 = rotateLeft(v0, 32);
+    v2 += v3; v3 = rotateLeft(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotateLeft(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotateLeft(v1, 17); v1 ^= v2; v2 = rotateLeft(v2, 32);
+}
+
+}
 
 #if OPENSSL_VERSION_NUMBER >= 0x10100000
 HMACAuth::HMACAuth(AuthMethod authMethod)
@@ -43,6 +73,17 @@ HMACAuth::~HMACAuth() {
 #endif
 
 bool HMACAuth::setKey(const char* keyValue, int keyLen) {
+    if (_authMethod == SIPHASH_2_4) {
+        // SipHash takes exactly 128 bits of key - fold longer keys down, zero-pad shorter ones
+        unsigned char keyBytes[SIPHASH_2_4_HASH_SIZE] = { 0 };
+        for (int i = 0; i < keyLen; ++i) {
+            keyBytes[i % SIPHASH_2_4_HASH_SIZE] ^= (unsigned char)keyValue[i];
+        }
+        _sipKey0.store(readLittleEndian64(keyBytes), std::memory_order_relaxed);
+        _sipKey1.store(readLittleEndian64(keyBytes + 8), std::memory_order_relaxed);
+        return true;
+    }
+
     const EVP_MD* sslStruct = nullptr;
 
     switch (_authMethod) {
@@ -81,10 +122,22 @@ bool HMACAuth::setKey(const QUuid& uidKey) {
 
 bool HMACAuth::addData(const char* data, int dataLen) {
     QMutexLocker lock(&_lock);
+    if (_authMethod == SIPHASH_2_4) {
+        _sipPendingData.append(data, dataLen);
+        return true;
+    }
     return (bool) HMAC_Update(_hmacContext, reinterpret_cast<const unsigned char*>(data), dataLen);
 }
 
 HMACAuth::HMACHash HMACAuth::result() {
+    if (_authMethod == SIPHASH_2_4) {
+        HMACHash hashValue(SIPHASH_2_4_HASH_SIZE);
+        QMutexLocker lock(&_lock);
+        sipHash(&hashValue[0], _sipPendingData.constData(), _sipPendingData.size());
+        _sipPendingData.clear();
+        return hashValue;
+    }
+
     HMACHash hashValue(EVP_MAX_MD_SIZE);
     unsigned int hashLen;
     QMutexLocker lock(&_lock);
@@ -105,6 +158,12 @@ HMACAuth::HMACHash HMACAuth::result() {
 }
 
 bool HMACAuth::calculateHash(HMACHash& hashResult, const char* data, int dataLen) {
+    if (_authMethod == SIPHASH_2_4) {
+        hashResult.resize(SIPHASH_2_4_HASH_SIZE);
+        sipHash(&hashResult[0], data, dataLen);
+        return true;
+    }
+
     QMutexLocker lock(&_lock);
     if (!addData(data, dataLen)) {
         qCWarning(networking) << "Error occured calling HMACAuth::addData()";
@@ -115,3 +174,67 @@ bool HMACAuth::calculateHash(HMACHash& hashResult, const char* data, int dataLen
     hashResult = result();
     return true;
 }
+
+int HMACAuth::calculateHash(unsigned char* hashResult, int hashResultLen, const char* data, int dataLen) {
+    if (_authMethod == SIPHASH_2_4) {
+        // no shared state is touched here, so there is nothing to lock
+        if (hashResultLen < SIPHASH_2_4_HASH_SIZE) {
+            return 0;
+        }
+        sipHash(hashResult, data, dataLen);
+        return SIPHASH_2_4_HASH_SIZE;
+    }
+
+    HMACHash hashValue;
+    if (!calculateHash(hashValue, data, dataLen) || (int)hashValue.size() > hashResultLen) {
+        return 0;
+    }
+    memcpy(hashResult, hashValue.data(), hashValue.size());
+    return (int)hashValue.size();
+}
+
+// SipHash-2-4 with 128-bit output, as described in the reference implementation by Aumasson and Bernstein.
+void HMACAuth::sipHash(unsigned char* hashResult, const char* data, int dataLen) const {
+    const uint64_t key0 = _sipKey0.load(std::memory_order_relaxed);
+    const uint64_t key1 = _sipKey1.load(std::memory_order_relaxed);
+
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key0;
+    uint64_t v3 = 0x7465646279746573ULL ^ key1;
+    v1 ^= 0xee;
+
+    auto bytes = reinterpret_cast<const unsigned char*>(data);
+    const size_t length = (size_t)dataLen;
+    const unsigned char* blocksEnd = bytes + (length - (length % 8));
+
+    for (; bytes != blocksEnd; bytes += 8) {
+        uint64_t block = readLittleEndian64(bytes);
+        v3 ^= block;
+        sipRound(v0, v1, v2, v3);
+        sipRound(v0, v1, v2, v3);
+        v0 ^= block;
+    }
+
+    uint64_t lastBlock = ((uint64_t)length) << 56;
+    for (int i = (int)(length % 8) - 1; i >= 0; --i) {
+        lastBlock |= ((uint64_t)bytes[i]) << (8 * i);
+    }
+
+    v3 ^= lastBlock;
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    v0 ^= lastBlock;
+
+    v2 ^= 0xee;
+    for (int i = 0; i < 4; ++i) {
+        sipRound(v0, v1, v2, v3);
+    }
+    writeLittleEndian64(hashResult, v0 ^ v1 ^ v2 ^ v3);
+
+    v1 ^= 0xdd;
+    for (int i = 0; i < 4; ++i) {
+        sipRound(v0, v1, v2, v3);
+    }
+    writeLittleEndian64(hashResult + 8, v0 ^ v1 ^ v2 ^ v3);
+}
@@ -12,24 +12,35 @@
 #ifndef hifi_HMACAuth_h
 #define hifi_HMACAuth_h
 
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <QtCore/QByteArray>
 #include <QtCore/QMutex>
 
 class QUuid;
 
 class HMACAuth {
 public:
-    enum AuthMethod { MD5, SHA1, SHA224, SHA256, RIPEMD160 };
+    // SIPHASH_2_4 is a keyed 128-bit SipHash-2-4 MAC. Unlike the OpenSSL HMAC methods it
+    // keeps no per-call context, so calculateHash() for it is lock-free and allocation-free.
+    enum AuthMethod { MD5, SHA1, SHA224, SHA256, RIPEMD160, SIPHASH_2_4 };
     using HMACHash = std::vector<unsigned char>;
+
+    static const int SIPHASH_2_4_HASH_SIZE = 16;
     
     explicit HMACAuth(AuthMethod authMethod = MD5);
     ~HMACAuth();
 
+    AuthMethod getAuthMethod() const { return _authMethod; }
+
     bool setKey(const char* keyValue, int keyLen);
     bool setKey(const QUuid& uidKey);
     // Calculate complete hash in one.
     bool calculateHash(HMACHash& hashResult, const char* data, int dataLen);
+    // Calculate complete hash in one, writing at most hashResultLen bytes to hashResult.
+    // Returns the number of bytes written, or 0 on failure.
+    int calculateHash(unsigned char* hashResult, int hashResultLen, const char* data, int dataLen);
 
     // Append to data to be hashed.
     bool addData(const char* data, int dataLen);
@@ -39,9 +50,16 @@ public:
     HMACHash result();
 
 private:
+    void sipHash(unsigned char* hashResult, const char* data, int dataLen) const;
+
     QMutex _lock { QMutex::Recursive };
     struct hmac_ctx_st* _hmacContext;
     AuthMethod _authMethod;
+
+    // SipHash key, and data accumulated through addData() for the incremental interface
+    std::atomic<uint64_t> _sipKey0 { 0 };
+    std::atomic<uint64_t> _sipKey1 { 0 };
+    QByteArray _sipPendingData;
 };
 
 #endif  // hifi_HMACAuth_h
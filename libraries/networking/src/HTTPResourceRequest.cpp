@@ -129,6 +129,7 @@ void HTTPResourceRequest::onRequestFinished() {
             _data = _reply->readAll();
             _loadedFromCache = _reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
             _result = Success;
+            _isWholeContent = !_byteRange.isSet();
 
             if (_byteRange.isSet()) {
                 auto statusCode = _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
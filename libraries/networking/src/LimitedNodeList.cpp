@@ -347,18 +347,18 @@ bool LimitedNodeList::packetSourceAndHashMatchAndTrackBandwidth(const udt::Packe
 
             if (verifiedPacket && verificationEnabled) {
 
-                QByteArray packetHeaderHash = NLPacket::verificationHashInHeader(packet);
-                QByteArray expectedHash;
                 auto sourceNodeHMACAuth = sourceNode->getAuthenticateHash();
-                if (sourceNode->getAuthenticateHash()) {
-                    expectedHash = NLPacket::hashForPacketAndHMAC(packet, *sourceNodeHMACAuth);
-                }
 
-                // check if the HMAC-md5 hash in the header matches the hash we would expect
-                if (!sourceNodeHMACAuth || packetHeaderHash != expectedHash) {
+                // check if the hash in the header matches the hash we would expect
+                if (!sourceNodeHMACAuth || !NLPacket::verificationHashMatches(packet, *sourceNodeHMACAuth)) {
                     static QMultiMap<QUuid, PacketType> hashDebugSuppressMap;
 
                     if (!hashDebugSuppressMap.contains(sourceID, headerType)) {
+                        QByteArray packetHeaderHash = NLPacket::verificationHashInHeader(packet);
+                        QByteArray expectedHash;
+                        if (sourceNodeHMACAuth) {
+                            expectedHash = NLPacket::hashForPacketAndHMAC(packet, *sourceNodeHMACAuth);
+                        }
                         qCDebug(networking) << "Packet hash mismatch on" << headerType << "- Sender" << sourceID;
                         qCDebug(networking) << "Packet len:" << packet.getDataSize() << "Expected hash:" <<
                             expectedHash.toHex() << "Actual:" << packetHeaderHash.toHex();
@@ -386,6 +386,9 @@ bool LimitedNodeList::packetSourceAndHashMatchAndTrackBandwidth(const udt::Packe
 }
 
 void LimitedNodeList::fillPacketHeader(const NLPacket& packet, HMACAuth* hmacAuth) {
+    // every NL packet we send comes through here exactly once, so account for it by type
+    _packetReceiver->getPacketTypeStats().recordOutbound(packet.getType(), packet.getDataSize());
+
     if (!PacketTypeEnum::getNonSourcedPackets().contains(packet.getType())) {
         packet.writeSourceID(getSessionLocalID());
     }
@@ -398,6 +401,7 @@ void LimitedNodeList::fillPacketHeader(const NLPacket& packet, HMACAuth* hmacAut
 }
 
 static const qint64 ERROR_SENDING_PACKET_BYTES = -1;
+static const qint64 MAX_COALESCED_PACKET_SIZE = 512;
 
 qint64 LimitedNodeList::sendUnreliablePacket(const NLPacket& packet, const Node& destinationNode) {
     Q_ASSERT(!packet.isPartOfMessage());
@@ -427,6 +431,11 @@ qint64 LimitedNodeList::sendUnreliablePacket(const NLPacket& packet, const HifiS
 
     fillPacketHeader(packet, hmacAuth);
 
+    if (_packetCoalescingEnabled && packet.getDataSize() <= MAX_COALESCED_PACKET_SIZE
+        && PacketTypeEnum::getCoalescablePackets().contains(packet.getType())) {
+        return _nodeSocket.writeCoalescedPacket(packet, sockAddr);
+    }
+
     return _nodeSocket.writePacket(packet, sockAddr);
 }
 
@@ -508,6 +517,14 @@ qint64 LimitedNodeList::sendUnreliableUnorderedPacketList(NLPacketList& packetLi
 }
 
 qint64 LimitedNodeList::sendPacketList(std::unique_ptr<NLPacketList> packetList, const HifiSockAddr& sockAddr) {
+    if (packetList->isStreamed()) {
+        // its packets are written as they get sent, fill their headers then
+        packetList->setPacketFinalizer([this](udt::Packet& packet) {
+            fillPacketHeader(static_cast<NLPacket&>(packet));
+        });
+        return _nodeSocket.writePacketList(std::move(packetList), sockAddr);
+    }
+
     // close the last packet in the list
     packetList->closeCurrentPacket();
 
@@ -521,7 +538,20 @@ qint64 LimitedNodeList::sendPacketList(std::unique_ptr<NLPacketList> packetList,
 
 qint64 LimitedNodeList::sendPacketList(std::unique_ptr<NLPacketList> packetList, const Node& destinationNode) {
     auto activeSocket = destinationNode.getActiveSocket();
-    if (activeSocket) {
+    if (activeSocket && packetList->isStreamed()) {
+        // its packets are written as they get sent, fill their headers then. Hold on to the node for its
+        // authentication hash until the list is done with.
+        SharedNodePointer node = nodeWithLocalID(destinationNode.getLocalID());
+        if (!node) {
+            qCDebug(networking) << "LimitedNodeList::sendPacketList called for a node that is gone"
+                                << destinationNode.getUUID() << ". Not sending.";
+            return ERROR_SENDING_PACKET_BYTES;
+        }
+        packetList->setPacketFinalizer([this, node](udt::Packet& packet) {
+            fillPacketHeader(static_cast<NLPacket&>(packet), node->getAuthenticateHash());
+        });
+        return _nodeSocket.writePacketList(std::move(packetList), *activeSocket);
+    } else if (activeSocket) {
         // close the last packet in the list
         packetList->closeCurrentPacket();
 
@@ -338,6 +338,13 @@ public:
 
     void setDropOutgoingNodeTraffic(bool squelchOutgoingNodeTraffic) { _dropOutgoingNodeTraffic = squelchOutgoingNodeTraffic; }
 
+    // When enabled, small unreliable packets of the types in PacketTypeEnum::getCoalescablePackets() are
+    // batched per destination and sent in one datagram per tick. Call flushCoalescedPackets() at the end
+    // of a frame to send them without waiting for the socket's flush timer.
+    void setPacketCoalescingEnabled(bool enabled) { _packetCoalescingEnabled = enabled; }
+    bool isPacketCoalescingEnabled() const { return _packetCoalescingEnabled; }
+    void flushCoalescedPackets() { _nodeSocket.flushCoalescedPackets(); }
+
     const std::set<NodeType_t> SOLO_NODE_TYPES = {
         NodeType::AvatarMixer,
         NodeType::AudioMixer,
@@ -445,6 +452,7 @@ protected:
     HifiSockAddr _stunSockAddr { STUN_SERVER_HOSTNAME, STUN_SERVER_PORT };
     bool _hasTCPCheckedLocalSocket { false };
     bool _useAuthentication { true };
+    bool _packetCoalescingEnabled { false };
 
     PacketReceiver* _packetReceiver;
 
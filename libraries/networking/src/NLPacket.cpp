@@ -164,6 +164,18 @@ QByteArray NLPacket::hashForPacketAndHMAC(const udt::Packet& packet, HMACAuth& h
     return QByteArray((const char*) hashResult.data(), (int) hashResult.size());
 }
 
+bool NLPacket::verificationHashMatches(const udt::Packet& packet, HMACAuth& hash) {
+    int hashOffset = Packet::totalHeaderSize(packet.isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion)
+        + NUM_BYTES_LOCALID;
+    int payloadOffset = hashOffset + NUM_BYTES_MD5_HASH;
+
+    unsigned char expectedHash[NUM_BYTES_MD5_HASH];
+    int hashSize = hash.calculateHash(expectedHash, NUM_BYTES_MD5_HASH,
+                                      packet.getData() + payloadOffset, packet.getDataSize() - payloadOffset);
+
+    return hashSize == NUM_BYTES_MD5_HASH && memcmp(packet.getData() + hashOffset, expectedHash, NUM_BYTES_MD5_HASH) == 0;
+}
+
 void NLPacket::writeTypeAndVersion() {
     auto headerOffset = Packet::totalHeaderSize(isPartOfMessage());
     
@@ -222,8 +234,9 @@ void NLPacket::writeVerificationHash(HMACAuth& hmacAuth) const {
     
     auto offset = Packet::totalHeaderSize(isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion)
                 + NUM_BYTES_LOCALID;
+    auto payloadOffset = offset + NUM_BYTES_MD5_HASH;
 
-    QByteArray verificationHash = hashForPacketAndHMAC(*this, hmacAuth);
-    
-    memcpy(_packet.get() + offset, verificationHash.data(), verificationHash.size());
+    // hash straight into the header, no intermediate buffers
+    hmacAuth.calculateHash(reinterpret_cast<unsigned char*>(_packet.get() + offset), NUM_BYTES_MD5_HASH,
+                           _packet.get() + payloadOffset, getDataSize() - payloadOffset);
 }
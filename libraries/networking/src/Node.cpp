@@ -213,7 +213,10 @@ void Node::setConnectionSecret(const QUuid& connectionSecret) {
     }
 
     if (!_authenticateHash) {
-        _authenticateHash.reset(new HMACAuth());
+        // Sourced packets are authenticated with SipHash-2-4 keyed by the connection secret since
+        // DomainListVersion::SipHashPacketAuthentication. Peers on older versions are turned away by the
+        // protocol signature check, so both ends of every connection always agree on the method.
+        _authenticateHash.reset(new HMACAuth(HMACAuth::SIPHASH_2_4));
     }
 
     _connectionSecret = connectionSecret;
@@ -221,35 +224,41 @@ void Node::setConnectionSecret(const QUuid& connectionSecret) {
 }
 
 void Node::updateStats(Stats stats) {
+    QWriteLocker lock { &_statsLock };
     _stats = stats;
 }
 
-const Node::Stats& Node::getConnectionStats() const {
+Node::Stats Node::getConnectionStats() const {
+    QReadLocker lock { &_statsLock };
     return _stats;
 }
 
 float Node::getInboundKbps() const {
-    float bitsReceived = (_stats.receivedBytes + _stats.receivedUnreliableBytes) * BITS_IN_BYTE;
-    auto elapsed = _stats.endTime - _stats.startTime;
+    auto stats = getConnectionStats();
+    float bitsReceived = (stats.receivedBytes + stats.receivedUnreliableBytes) * BITS_IN_BYTE;
+    auto elapsed = stats.endTime - stats.startTime;
     auto bps = (bitsReceived * USECS_PER_SECOND) / elapsed.count();
     return bps / BYTES_PER_KILOBYTE;
 }
 
 float Node::getOutboundKbps() const {
-    float bitsSent = (_stats.sentBytes + _stats.sentUnreliableBytes) * BITS_IN_BYTE;
-    auto elapsed = _stats.endTime - _stats.startTime;
+    auto stats = getConnectionStats();
+    float bitsSent = (stats.sentBytes + stats.sentUnreliableBytes) * BITS_IN_BYTE;
+    auto elapsed = stats.endTime - stats.startTime;
     auto bps = (bitsSent * USECS_PER_SECOND) / elapsed.count();
     return bps / BYTES_PER_KILOBYTE;
 }
 
 int Node::getInboundPPS() const {
-    float packetsReceived = _stats.receivedPackets + _stats.receivedUnreliablePackets;
-    auto elapsed = _stats.endTime - _stats.startTime;
+    auto stats = getConnectionStats();
+    float packetsReceived = stats.receivedPackets + stats.receivedUnreliablePackets;
+    auto elapsed = stats.endTime - stats.startTime;
     return (packetsReceived * USECS_PER_SECOND) / elapsed.count();
 }
 
 int Node::getOutboundPPS() const {
-    float packetsSent = _stats.sentPackets + _stats.sentUnreliablePackets;
-    auto elapsed = _stats.endTime - _stats.startTime;
+    auto stats = getConnectionStats();
+    float packetsSent = stats.sentPackets + stats.sentUnreliablePackets;
+    auto elapsed = stats.endTime - stats.startTime;
     return (packetsSent * USECS_PER_SECOND) / elapsed.count();
 }
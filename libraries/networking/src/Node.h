@@ -99,7 +99,7 @@ public:
     friend QDataStream& operator>>(QDataStream& in, Node& node);
 
     void updateStats(Stats stats);
-    const Stats& getConnectionStats() const;
+    Stats getConnectionStats() const; // the NodeList thread updates them, this returns a copy
 
     int getInboundPPS() const;
     int getOutboundPPS() const;
@@ -129,6 +129,7 @@ private:
     std::vector<QString> _replicatedUsernames { };
 
     Stats _stats;
+    mutable QReadWriteLock _statsLock;
 };
 
 Q_DECLARE_METATYPE(Node*)
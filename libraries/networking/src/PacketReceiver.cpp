@@ -14,6 +14,8 @@
 
 #include <QMutexLocker>
 
+#include <PortableHighResolutionClock.h>
+
 #include "DependencyManager.h"
 #include "NetworkLogging.h"
 #include "NodeList.h"
@@ -165,8 +167,38 @@ QMetaMethod PacketReceiver::matchingMethodForListener(PacketType type, QObject*
     }
 }
 
+bool PacketReceiver::registerListener(PacketType type, QObject* context, ListenerCallback callback,
+                                      ListenerDelivery delivery, bool deliverPending) {
+    Q_ASSERT_X(context, "PacketReceiver::registerListener", "No context to register");
+    Q_ASSERT_X(callback, "PacketReceiver::registerListener", "No callback to register");
+
+    if (!context || !callback) {
+        qCWarning(networking) << "FAILED to Register a packet listener for packet list type" << type;
+        return false;
+    }
+
+    qCDebug(networking) << "Registering a typed packet listener for packet list type" << type;
+    registerVerifiedListener(type, { QPointer<QObject>(context), QMetaMethod(), deliverPending, callback, delivery });
+    return true;
+}
+
+bool PacketReceiver::registerListenerForTypes(PacketTypeList types, QObject* context, ListenerCallback callback,
+                                              ListenerDelivery delivery) {
+    Q_ASSERT_X(!types.empty(), "PacketReceiver::registerListenerForTypes", "No types to register");
+
+    bool success = true;
+    for (auto type : types) {
+        success &= registerListener(type, context, callback, delivery);
+    }
+    return success;
+}
+
 void PacketReceiver::registerVerifiedListener(PacketType type, QObject* object, const QMetaMethod& slot, bool deliverPending) {
     Q_ASSERT_X(object, "PacketReceiver::registerVerifiedListener", "No object to register");
+    registerVerifiedListener(type, { QPointer<QObject>(object), slot, deliverPending, nullptr, ListenerDelivery::Queued });
+}
+
+void PacketReceiver::registerVerifiedListener(PacketType type, const Listener& listener) {
     QMutexLocker locker(&_packetListenerLock);
 
     if (_messageListenerMap.contains(type)) {
@@ -175,7 +207,7 @@ void PacketReceiver::registerVerifiedListener(PacketType type, QObject* object,
     }
     
     // add the mapping
-    _messageListenerMap[type] = { QPointer<QObject>(object), slot, deliverPending };
+    _messageListenerMap[type] = listener;
 }
 
 void PacketReceiver::unregisterListener(QObject* listener) {
@@ -210,6 +242,8 @@ void PacketReceiver::handleVerifiedPacket(std::unique_ptr<udt::Packet> packet) {
     
     // setup an NLPacket from the packet we were passed
     auto nlPacket = NLPacket::fromBase(std::move(packet));
+    _packetTypeStats.recordInbound(nlPacket->getType(), nlPacket->getDataSize());
+
     auto receivedMessage = QSharedPointer<ReceivedMessage>::create(*nlPacket);
 
     handleVerifiedMessage(receivedMessage, true);
@@ -217,6 +251,7 @@ void PacketReceiver::handleVerifiedPacket(std::unique_ptr<udt::Packet> packet) {
 
 void PacketReceiver::handleVerifiedMessagePacket(std::unique_ptr<udt::Packet> packet) {
     auto nlPacket = NLPacket::fromBase(std::move(packet));
+    _packetTypeStats.recordInbound(nlPacket->getType(), nlPacket->getDataSize());
 
     auto key = std::pair<HifiSockAddr, udt::Packet::MessageNumber>(nlPacket->getSenderSockAddr(), nlPacket->getMessageNumber());
     auto it = _pendingMessages.find(key);
@@ -261,7 +296,7 @@ void PacketReceiver::handleVerifiedMessage(QSharedPointer<ReceivedMessage> recei
     QMutexLocker packetListenerLocker(&_packetListenerLock);
     
     auto it = _messageListenerMap.find(receivedMessage->getType());
-    if (it != _messageListenerMap.end() && it->method.isValid()) {
+    if (it != _messageListenerMap.end() && (it->method.isValid() || it->callback)) {
          
         auto listener = it.value();
 
@@ -271,37 +306,9 @@ void PacketReceiver::handleVerifiedMessage(QSharedPointer<ReceivedMessage> recei
             
         bool success = false;
 
-        Qt::ConnectionType connectionType;
-        // check if this is a directly connected listener
-        {
-            QMutexLocker directConnectLocker(&_directConnectSetMutex);
-            connectionType = _directlyConnectedObjects.contains(listener.object) ? Qt::DirectConnection : Qt::AutoConnection;
-        }
-
-        QMetaMethod metaMethod = listener.method;
-
-        static const QByteArray QSHAREDPOINTER_NODE_NORMALIZED = QMetaObject::normalizedType("QSharedPointer<Node>");
-        static const QByteArray SHARED_NODE_NORMALIZED = QMetaObject::normalizedType("SharedNodePointer");
-
         // one final check on the QPointer before we go to invoke
         if (listener.object) {
-            if (metaMethod.parameterTypes().contains(SHARED_NODE_NORMALIZED)) {
-                success = metaMethod.invoke(listener.object,
-                                            connectionType,
-                                            Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage),
-                                            Q_ARG(SharedNodePointer, matchingNode));
-
-            } else if (metaMethod.parameterTypes().contains(QSHAREDPOINTER_NODE_NORMALIZED)) {
-                success = metaMethod.invoke(listener.object,
-                                            connectionType,
-                                            Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage),
-                                            Q_ARG(QSharedPointer<Node>, matchingNode));
-
-            } else {
-                success = metaMethod.invoke(listener.object,
-                                            connectionType,
-                                            Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage));
-            }
+            success = invokeListener(listener, receivedMessage, matchingNode);
         } else {
             qCDebug(networking).nospace() << "Listener for packet " << receivedMessage->getType()
                 << " has been destroyed. Removing from listener map.";
@@ -323,6 +330,97 @@ void PacketReceiver::handleVerifiedMessage(QSharedPointer<ReceivedMessage> recei
         qCWarning(networking) << "No listener found for packet type" << receivedMessage->getType();
         
         // insert a dummy listener so we don't print this again
-        _messageListenerMap.insert(receivedMessage->getType(), { nullptr, QMetaMethod(), false });
+        _messageListenerMap.insert(receivedMessage->getType(), { nullptr, QMetaMethod(), false, nullptr, ListenerDelivery::Queued });
+    }
+}
+
+bool PacketReceiver::invokeListener(const Listener& listener, const QSharedPointer<ReceivedMessage>& receivedMessage,
+                                    const QSharedPointer<Node>& matchingNode) {
+    // the handler time is measured around the call of the listener on its own thread, not around handing it off
+    QPointer<PacketReceiver> receiver { this };
+    PacketType type = receivedMessage->getType();
+    auto timed = [receiver, type](const std::function<bool()>& call) {
+        auto callStart = p_high_resolution_clock::now();
+        bool success = call();
+        auto callUsecs = std::chrono::duration_cast<std::chrono::microseconds>(p_high_resolution_clock::now() - callStart);
+        if (receiver) {
+            receiver->_packetTypeStats.recordHandlerTime(type, callUsecs.count());
+        }
+        return success;
+    };
+
+    std::function<bool()> call;
+    bool isDirect;
+
+    if (listener.callback) {
+        auto callback = listener.callback;
+        call = [callback, receivedMessage, matchingNode] {
+            callback(receivedMessage, matchingNode);
+            return true;
+        };
+        isDirect = listener.delivery == ListenerDelivery::Direct;
+    } else {
+        // check if this is a directly connected listener
+        {
+            QMutexLocker directConnectLocker(&_directConnectSetMutex);
+            isDirect = _directlyConnectedObjects.contains(listener.object);
+        }
+
+        QObject* object = listener.object;
+        QMetaMethod metaMethod = listener.method;
+
+        static const QByteArray QSHAREDPOINTER_NODE_NORMALIZED = QMetaObject::normalizedType("QSharedPointer<Node>");
+        static const QByteArray SHARED_NODE_NORMALIZED = QMetaObject::normalizedType("SharedNodePointer");
+
+        if (metaMethod.parameterTypes().contains(SHARED_NODE_NORMALIZED)) {
+            call = [object, metaMethod, receivedMessage, matchingNode] {
+                return metaMethod.invoke(object,
+                                         Qt::DirectConnection,
+                                         Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage),
+                                         Q_ARG(SharedNodePointer, matchingNode));
+            };
+        } else if (metaMethod.parameterTypes().contains(QSHAREDPOINTER_NODE_NORMALIZED)) {
+            call = [object, metaMethod, receivedMessage, matchingNode] {
+                return metaMethod.invoke(object,
+                                         Qt::DirectConnection,
+                                         Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage),
+                                         Q_ARG(QSharedPointer<Node>, matchingNode));
+            };
+        } else {
+            call = [object, metaMethod, receivedMessage] {
+                return metaMethod.invoke(object,
+                                         Qt::DirectConnection,
+                                         Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage));
+            };
+        }
+    }
+
+    if (isDirect) {
+        return timed(call);
     }
+
+    // slot listeners on our own thread are still called right away, as with the AutoConnection they used to get
+    auto connectionType = listener.callback ? Qt::QueuedConnection : Qt::AutoConnection;
+    return QMetaObject::invokeMethod(listener.object, [timed, call, type] {
+        if (!timed(call)) {
+            qCDebug(networking).nospace() << "Error delivering packet " << type << " to its listener";
+        }
+    }, connectionType);
+}
+
+QJsonObject PacketReceiver::takePacketTypeStats() {
+    QHash<PacketType, QString> listenerNames;
+    {
+        QMutexLocker packetListenerLocker(&_packetListenerLock);
+        for (auto it = _messageListenerMap.cbegin(); it != _messageListenerMap.cend(); ++it) {
+            if (it->object && it->callback) {
+                listenerNames[it.key()] = QString("%1 (callback)").arg(it->object->metaObject()->className());
+            } else if (it->object && it->method.isValid()) {
+                listenerNames[it.key()] = QString("%1::%2").arg(it->object->metaObject()->className(),
+                                                                QString(it->method.name()));
+            }
+        }
+    }
+
+    return _packetTypeStats.takeStats(listenerNames);
 }
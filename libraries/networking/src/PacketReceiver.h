@@ -13,6 +13,7 @@
 #ifndef hifi_PacketReceiver_h
 #define hifi_PacketReceiver_h
 
+#include <functional>
 #include <vector>
 #include <unordered_map>
 
@@ -25,10 +26,12 @@
 
 #include "NLPacket.h"
 #include "NLPacketList.h"
+#include "PacketTypeStats.h"
 #include "ReceivedMessage.h"
 #include "udt/PacketHeaders.h"
 
 class EntityEditPacketSender;
+class Node;
 class OctreePacketProcessor;
 
 namespace std {
@@ -44,6 +47,16 @@ class PacketReceiver : public QObject {
     Q_OBJECT
 public:
     using PacketTypeList = std::vector<PacketType>;
+    using ListenerCallback = std::function<void(QSharedPointer<ReceivedMessage>, QSharedPointer<Node>)>;
+
+    // How a typed listener registered with a ListenerCallback is called
+    enum class ListenerDelivery {
+        // on the thread that received the packet (the NodeList thread) - the callback must be thread-safe,
+        // typically it hands the message off to a lock-free queue owned by the listener
+        Direct,
+        // on the thread of the context object, through its event loop
+        Queued
+    };
     
     PacketReceiver(QObject* parent = 0);
     PacketReceiver(const PacketReceiver&) = delete;
@@ -57,17 +70,30 @@ public:
     // for the message is received.
     bool registerListener(PacketType type, QObject* listener, const char* slot, bool deliverPending = false);
     bool registerListenerForTypes(PacketTypeList types, QObject* listener, const char* slot);
+
+    // Typed registration that skips the QMetaMethod lookup and invoke of the slot based API above.
+    // The listener is dropped once context is destroyed.
+    bool registerListener(PacketType type, QObject* context, ListenerCallback callback,
+                          ListenerDelivery delivery = ListenerDelivery::Queued, bool deliverPending = false);
+    bool registerListenerForTypes(PacketTypeList types, QObject* context, ListenerCallback callback,
+                                  ListenerDelivery delivery = ListenerDelivery::Queued);
     void unregisterListener(QObject* listener);
     
     void handleVerifiedPacket(std::unique_ptr<udt::Packet> packet);
     void handleVerifiedMessagePacket(std::unique_ptr<udt::Packet> message);
     void handleMessageFailure(HifiSockAddr from, udt::Packet::MessageNumber messageNumber);
+
+    PacketTypeStats& getPacketTypeStats() { return _packetTypeStats; }
+    // per-type packet counts, bytes and listener handling times since the last call
+    QJsonObject takePacketTypeStats();
     
 private:
     struct Listener {
         QPointer<QObject> object;
         QMetaMethod method;
         bool deliverPending;
+        ListenerCallback callback;
+        ListenerDelivery delivery;
     };
 
     void handleVerifiedMessage(QSharedPointer<ReceivedMessage> message, bool justReceived);
@@ -79,6 +105,9 @@ private:
 
     QMetaMethod matchingMethodForListener(PacketType type, QObject* object, const char* slot) const;
     void registerVerifiedListener(PacketType type, QObject* listener, const QMetaMethod& slot, bool deliverPending = false);
+    void registerVerifiedListener(PacketType type, const Listener& listener);
+    bool invokeListener(const Listener& listener, const QSharedPointer<ReceivedMessage>& receivedMessage,
+                        const QSharedPointer<Node>& matchingNode);
 
     QMutex _packetListenerLock;
     QHash<PacketType, Listener> _messageListenerMap;
@@ -88,6 +117,8 @@ private:
     QSet<QObject*> _directlyConnectedObjects;
 
     std::unordered_map<std::pair<HifiSockAddr, udt::Packet::MessageNumber>, QSharedPointer<ReceivedMessage>> _pendingMessages;
+
+    PacketTypeStats _packetTypeStats;
     
     friend class EntityEditPacketSender;
     friend class OctreePacketProcessor;
@@ -0,0 +1,99 @@
+//
+//  PacketTypeStats.cpp
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketTypeStats.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QMetaEnum>
+
+static_assert(sizeof(PacketType) == 1, "PacketTypeStats expects one slot per possible PacketType value");
+
+void PacketTypeStats::recordInbound(PacketType type, qint64 bytes) {
+    auto& stats = _stats[(uint8_t)type];
+    stats.inboundPackets.fetch_add(1, std::memory_order_relaxed);
+    stats.inboundBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void PacketTypeStats::recordOutbound(PacketType type, qint64 bytes) {
+    auto& stats = _stats[(uint8_t)type];
+    stats.outboundPackets.fetch_add(1, std::memory_order_relaxed);
+    stats.outboundBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void PacketTypeStats::recordHandlerTime(PacketType type, quint64 usecs) {
+    auto& stats = _stats[(uint8_t)type];
+    stats.handlerCalls.fetch_add(1, std::memory_order_relaxed);
+    stats.handlerUsecs.fetch_add(usecs, std::memory_order_relaxed);
+
+    quint64 previousMax = stats.maxHandlerUsecs.load(std::memory_order_relaxed);
+    while (usecs > previousMax &&
+           !stats.maxHandlerUsecs.compare_exchange_weak(previousMax, usecs, std::memory_order_relaxed)) {
+    }
+
+    int bucket = 0;
+    while (bucket < NUM_HANDLER_TIME_BUCKETS - 1 && usecs >= (quint64(1) << bucket)) {
+        ++bucket;
+    }
+    stats.handlerTimeHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+QJsonObject PacketTypeStats::takeStats(const QHash<PacketType, QString>& listenerNames) {
+    QMetaEnum metaEnum = PacketTypeEnum::staticMetaObject.enumerator(PacketTypeEnum::staticMetaObject.enumeratorOffset());
+
+    QJsonObject statsObject;
+
+    for (int i = 0; i < NUM_PACKET_TYPES; ++i) {
+        auto& stats = _stats[i];
+
+        quint64 inboundPackets = stats.inboundPackets.exchange(0, std::memory_order_relaxed);
+        quint64 outboundPackets = stats.outboundPackets.exchange(0, std::memory_order_relaxed);
+        quint64 handlerCalls = stats.handlerCalls.exchange(0, std::memory_order_relaxed);
+
+        if (inboundPackets == 0 && outboundPackets == 0 && handlerCalls == 0) {
+            continue;
+        }
+
+        PacketType type = (PacketType)i;
+        QJsonObject typeObject;
+        typeObject["in_packets"] = (double)inboundPackets;
+        typeObject["in_bytes"] = (double)stats.inboundBytes.exchange(0, std::memory_order_relaxed);
+        typeObject["out_packets"] = (double)outboundPackets;
+        typeObject["out_bytes"] = (double)stats.outboundBytes.exchange(0, std::memory_order_relaxed);
+
+        if (listenerNames.contains(type)) {
+            typeObject["listener"] = listenerNames[type];
+        }
+
+        if (handlerCalls > 0) {
+            quint64 handlerUsecs = stats.handlerUsecs.exchange(0, std::memory_order_relaxed);
+            typeObject["handler_calls"] = (double)handlerCalls;
+            typeObject["handler_usecs_total"] = (double)handlerUsecs;
+            typeObject["handler_usecs_avg"] = (double)handlerUsecs / handlerCalls;
+            typeObject["handler_usecs_max"] = (double)stats.maxHandlerUsecs.exchange(0, std::memory_order_relaxed);
+
+            // keyed by the bucket's upper bound in usecs
+            QJsonObject histogramObject;
+            for (int bucket = 0; bucket < NUM_HANDLER_TIME_BUCKETS; ++bucket) {
+                quint32 count = stats.handlerTimeHistogram[bucket].exchange(0, std::memory_order_relaxed);
+                if (count > 0) {
+                    QString bucketName = (bucket == NUM_HANDLER_TIME_BUCKETS - 1) ?
+                        QString(">=%1").arg(quint64(1) << (bucket - 1)) : QString("<%1").arg(quint64(1) << bucket);
+                    histogramObject[bucketName] = (double)count;
+                }
+            }
+            typeObject["handler_usecs_histogram"] = histogramObject;
+        }
+
+        const char* typeName = metaEnum.valueToKey(i);
+        statsObject[typeName ? QString(typeName) : QString::number(i)] = typeObject;
+    }
+
+    return statsObject;
+}
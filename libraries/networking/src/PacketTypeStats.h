@@ -0,0 +1,53 @@
+//
+//  PacketTypeStats.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketTypeStats_h
+#define hifi_PacketTypeStats_h
+
+#include <array>
+#include <atomic>
+
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+
+#include "udt/PacketHeaders.h"
+
+// Lock-free per-PacketType counters of packets and bytes in each direction, plus a log2 histogram of the time
+// each type's listener spends handling it, on its own thread. Counters are cumulative until taken with takeStats().
+class PacketTypeStats {
+public:
+    // bucket i counts handler calls that took less than 2^i usecs, the last bucket everything longer
+    static const int NUM_HANDLER_TIME_BUCKETS = 16;
+
+    void recordInbound(PacketType type, qint64 bytes);
+    void recordOutbound(PacketType type, qint64 bytes);
+    void recordHandlerTime(PacketType type, quint64 usecs);
+
+    // Returns the stats gathered since the last call, keyed by packet type name, and resets the counters.
+    // listenerNames optionally maps a type to the listener slot it is delivered to.
+    QJsonObject takeStats(const QHash<PacketType, QString>& listenerNames = QHash<PacketType, QString>());
+
+private:
+    struct TypeStats {
+        std::atomic<quint64> inboundPackets { 0 };
+        std::atomic<quint64> inboundBytes { 0 };
+        std::atomic<quint64> outboundPackets { 0 };
+        std::atomic<quint64> outboundBytes { 0 };
+        std::atomic<quint64> handlerCalls { 0 };
+        std::atomic<quint64> handlerUsecs { 0 };
+        std::atomic<quint64> maxHandlerUsecs { 0 };
+        std::array<std::atomic<quint32>, NUM_HANDLER_TIME_BUCKETS> handlerTimeHistogram {};
+    };
+
+    static const int NUM_PACKET_TYPES = 256;
+    std::array<TypeStats, NUM_PACKET_TYPES> _stats;
+};
+
+#endif // hifi_PacketTypeStats_h
@@ -16,6 +16,7 @@
 #include <cmath>
 #include <assert.h>
 
+#include <QFileInfo>
 #include <QThread>
 #include <QTimer>
 
@@ -24,18 +25,134 @@
 #include <Trace.h>
 #include <Profile.h>
 
+#include "AssetUtils.h"
 #include "NetworkAccessManager.h"
 #include "NetworkLogging.h"
 #include "NodeList.h"
+#include "ResourceProcessingPool.h"
+
+// textures are the bulk of most scenes, keep some requests for everything else
+static const QString TEXTURE_RESOURCE_TYPE = "NetworkTexture";
+static const float DEFAULT_TEXTURE_REQUEST_BUDGET = 0.75f;
+
+// load priorities range from about -10 for texture mips to 10 for animation graphs, with entities in [0, PI / 2]
+static const float DEFAULT_PRIORITY_AGING_PER_SECOND = 0.1f;
+
+ResourceCacheSharedItems::ResourceCacheSharedItems() :
+    _priorityAging(DEFAULT_PRIORITY_AGING_PER_SECOND)
+{
+    _requestsByType[TEXTURE_RESOURCE_TYPE].budget = DEFAULT_TEXTURE_REQUEST_BUDGET;
+}
+
+bool ResourceCacheSharedItems::PendingKey::operator<(const PendingKey& other) const {
+    if (isFile != other.isFile) {
+        return isFile;
+    }
+    if (priority != other.priority) {
+        return priority > other.priority;
+    }
+    return sequence < other.sequence;
+}
+
+bool ResourceCacheSharedItems::PendingKey::operator==(const PendingKey& other) const {
+    return isFile == other.isFile && priority == other.priority && sequence == other.sequence;
+}
+
+ResourceCacheSharedItems::PendingKey ResourceCacheSharedItems::computeKey(Resource& resource, double queuedSeconds,
+                                                                          uint64_t sequence) const {
+    // every pending request ages at the same rate, so the order of their aged priorities at any later time is the
+    // order of their priorities less what they had aged by when they were queued
+    PendingKey key;
+    key.isFile = resource.getURL().scheme() == HIFI_URL_SCHEME_FILE;
+    key.priority = resource.getLoadPriority() - _priorityAging * queuedSeconds;
+    key.sequence = sequence;
+    return key;
+}
+
+bool ResourceCacheSharedItems::isUnderTypeLimit(const TypeRequests& requests) const {
+    uint32_t typeLimit = std::max((uint32_t)(requests.budget * _requestLimit), (uint32_t)1);
+    return requests.numLoading < typeLimit;
+}
+
+bool ResourceCacheSharedItems::isWithinBudget(const TypeRequests& requests) const {
+    if ((uint32_t)_loadingRequests.size() >= _requestLimit) {
+        return false;
+    }
+    if (isUnderTypeLimit(requests)) {
+        return true;
+    }
+
+    // a type can go over its budget while no other type is waiting for the requests it would leave unused: it gives
+    // them back as they finish, once another type has something to load
+    for (const auto& other : _requestsByType) {
+        if (&other != &requests && !other.pending.empty() && isUnderTypeLimit(other)) {
+            return false;
+        }
+    }
+    return true;
+}
 
 bool ResourceCacheSharedItems::appendRequest(QWeakPointer<Resource> resource) {
+    auto locked = resource.lock();
+    if (!locked) {
+        return false;
+    }
+
     Lock lock(_mutex);
-    if ((uint32_t)_loadingRequests.size() < _requestLimit) {
-        _loadingRequests.append(resource);
+    auto pendingIt = _pendingRequests.find(locked.data());
+    if (pendingIt != _pendingRequests.end()) {
+        if (pendingIt->resource.lock() == locked) {
+            // already waiting, keep its place
+            updatePendingRequest(resource);
+            return false;
+        }
+        // a freed resource that was at the same address
+        removePendingRequest(locked.data());
+    }
+
+    QString type = locked->getType();
+    auto& requests = _requestsByType[type];
+    if (isWithinBudget(requests)) {
+        _loadingRequests.push_back({ resource, type });
+        ++requests.numLoading;
         return true;
-    } else {
-        _pendingRequests.append(resource);
-        return false;
+    }
+
+    PendingRequest pending;
+    pending.resource = resource;
+    pending.type = type;
+    pending.queuedSeconds = (double)usecTimestampNow() / USECS_PER_SECOND;
+    pending.key = computeKey(*locked, pending.queuedSeconds, _nextSequence++);
+    requests.pending.emplace(pending.key, locked.data());
+    _pendingRequests.insert(locked.data(), pending);
+    return false;
+}
+
+void ResourceCacheSharedItems::updatePendingRequest(QWeakPointer<Resource> resource) {
+    auto locked = resource.lock();
+    if (!locked) {
+        return;
+    }
+
+    Lock lock(_mutex);
+    auto pendingIt = _pendingRequests.find(locked.data());
+    if (pendingIt == _pendingRequests.end() || pendingIt->resource.lock() != locked) {
+        return;
+    }
+    PendingKey key = computeKey(*locked, pendingIt->queuedSeconds, pendingIt->key.sequence);
+    if (!(key == pendingIt->key)) {
+        auto& queue = _requestsByType[pendingIt->type].pending;
+        queue.erase(pendingIt->key);
+        queue.emplace(key, locked.data());
+        pendingIt->key = key;
+    }
+}
+
+void ResourceCacheSharedItems::removePendingRequest(Resource* resource) {
+    auto pendingIt = _pendingRequests.find(resource);
+    if (pendingIt != _pendingRequests.end()) {
+        _requestsByType[pendingIt->type].pending.erase(pendingIt->key);
+        _pendingRequests.erase(pendingIt);
     }
 }
 
@@ -49,12 +166,28 @@ uint32_t ResourceCacheSharedItems::getRequestLimit() const {
     return _requestLimit;
 }
 
+void ResourceCacheSharedItems::setRequestBudget(const QString& type, float fraction) {
+    Lock lock(_mutex);
+    _requestsByType[type].budget = glm::clamp(fraction, 0.0f, 1.0f);
+}
+
+float ResourceCacheSharedItems::getRequestBudget(const QString& type) const {
+    Lock lock(_mutex);
+    auto it = _requestsByType.find(type);
+    return it != _requestsByType.end() ? it->budget : 1.0f;
+}
+
+void ResourceCacheSharedItems::setPriorityAging(float priorityPerSecond) {
+    Lock lock(_mutex);
+    _priorityAging = priorityPerSecond;
+}
+
 QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getPendingRequests() const {
     QList<QSharedPointer<Resource>> result;
     Lock lock(_mutex);
 
-    foreach (QWeakPointer<Resource> resource, _pendingRequests) {
-        auto locked = resource.lock();
+    for (const auto& pending : _pendingRequests) {
+        auto locked = pending.resource.lock();
         if (locked) {
             result.append(locked);
         }
@@ -72,8 +205,8 @@ QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getLoadingRequests() c
     QList<QSharedPointer<Resource>> result;
     Lock lock(_mutex);
 
-    foreach(QWeakPointer<Resource> resource, _loadingRequests) {
-        auto locked = resource.lock();
+    for (const auto& request : _loadingRequests) {
+        auto locked = request.resource.lock();
         if (locked) {
             result.append(locked);
         }
@@ -84,7 +217,7 @@ QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getLoadingRequests() c
 
 uint32_t ResourceCacheSharedItems::getLoadingRequestsCount() const {
     Lock lock(_mutex);
-    return _loadingRequests.size();
+    return (uint32_t)_loadingRequests.size();
 }
 
 void ResourceCacheSharedItems::removeRequest(QWeakPointer<Resource> resource) {
@@ -93,55 +226,72 @@ void ResourceCacheSharedItems::removeRequest(QWeakPointer<Resource> resource) {
     // resource can only be removed if it still has a ref-count, as
     // QWeakPointer has no operator== implementation for two weak ptrs, so
     // manually loop in case resource has been freed.
-    for (int i = 0; i < _loadingRequests.size();) {
-        auto request = _loadingRequests.at(i);
+    for (auto it = _loadingRequests.begin(); it != _loadingRequests.end();) {
         // Clear our resource and any freed resources
-        if (!request || request.data() == resource.data()) {
-            _loadingRequests.removeAt(i);
+        if (!it->resource || it->resource.data() == resource.data()) {
+            --_requestsByType[it->type].numLoading;
+            it = _loadingRequests.erase(it);
             continue;
         }
-        i++;
+        ++it;
     }
 }
 
-QSharedPointer<Resource> ResourceCacheSharedItems::getHighestPendingRequest() {
-    // look for the highest priority pending request
-    int highestIndex = -1;
-    float highestPriority = -FLT_MAX;
-    QSharedPointer<Resource> highestResource;
-    Lock lock(_mutex);
-
-    bool currentHighestIsFile = false;
-
-    for (int i = 0; i < _pendingRequests.size();) {
-        // Clear any freed resources
-        auto resource = _pendingRequests.at(i).lock();
+ResourceCacheSharedItems::PendingQueue::iterator ResourceCacheSharedItems::getTopPendingRequest(PendingQueue& queue) {
+    while (!queue.empty()) {
+        auto top = queue.begin();
+        auto& pending = _pendingRequests[top->second];
+        auto resource = pending.resource.lock();
         if (!resource) {
-            _pendingRequests.removeAt(i);
+            // Clear any freed resources
+            _pendingRequests.remove(top->second);
+            queue.erase(top);
             continue;
         }
 
-        // Check load priority
-        float priority = resource->getLoadPriority();
-        bool isFile = resource->getURL().scheme() == HIFI_URL_SCHEME_FILE;
-        if (priority >= highestPriority && (isFile || !currentHighestIsFile)) {
-            highestPriority = priority;
-            highestIndex = i;
-            highestResource = resource;
-            currentHighestIsFile = isFile;
+        // priorities drop without notice when their owners go away
+        PendingKey key = computeKey(*resource, pending.queuedSeconds, top->first.sequence);
+        if (key == top->first) {
+            return top;
         }
-        i++;
+        queue.erase(top);
+        queue.emplace(key, resource.data());
+        pending.key = key;
     }
+    return queue.end();
+}
+
+QSharedPointer<Resource> ResourceCacheSharedItems::getHighestPendingRequest() {
+    Lock lock(_mutex);
 
-    if (highestIndex >= 0) {
-        _pendingRequests.takeAt(highestIndex);
+    // the few types each have their queue, look at the top of those within their budget
+    PendingQueue* highestQueue = nullptr;
+    PendingQueue::iterator highestIt;
+    for (auto& requests : _requestsByType) {
+        if (requests.pending.empty() || !isWithinBudget(requests)) {
+            continue;
+        }
+        auto top = getTopPendingRequest(requests.pending);
+        if (top != requests.pending.end() && (!highestQueue || top->first < highestIt->first)) {
+            highestQueue = &requests.pending;
+            highestIt = top;
+        }
     }
 
+    if (!highestQueue) {
+        return QSharedPointer<Resource>();
+    }
+    auto highestResource = _pendingRequests.take(highestIt->second).resource.lock();
+    highestQueue->erase(highestIt);
     return highestResource;
 }
 
 void ResourceCacheSharedItems::clear() {
     Lock lock(_mutex);
+    for (auto& requests : _requestsByType) {
+        requests.pending.clear();
+        requests.numLoading = 0;
+    }
     _pendingRequests.clear();
     _loadingRequests.clear();
 }
@@ -343,10 +493,8 @@ void ResourceCache::setRequestLimit(uint32_t limit) {
     auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
     sharedItems->setRequestLimit(limit);
 
-    // Now go fill any new request spots
-    while (sharedItems->getLoadingRequestsCount() < limit && sharedItems->getPendingRequestsCount() > 0) {
-        attemptHighestPriorityRequest();
-    }
+    // Now go fill any new request spots, as far as the budgets of the pending types allow
+    while (sharedItems->getLoadingRequestsCount() < limit && attemptHighestPriorityRequest()) {}
 }
 
 QSharedPointer<Resource> ResourceCache::getResource(const QUrl& url, const QUrl& fallback, void* extra, size_t extraHash) {
@@ -402,6 +550,46 @@ QSharedPointer<Resource> ResourceCache::getResource(const QUrl& url, const QUrl&
     return resource;
 }
 
+QSharedPointer<Resource> ResourceCache::findResourceWithContent(const QSharedPointer<Resource>& resource) {
+    QWriteLocker locker(&_resourcesLock);
+    auto& resourcesWithExtraHash = _resourcesWithContent[resource->_contentKey];
+    auto original = resourcesWithExtraHash.value(resource->getExtraHash()).lock();
+    if (original && original != resource && original->isLoaded() && !original->isFailed()) {
+        return original;
+    }
+    // keep one that's still loading, others with the same content may come after it's done
+    if (!original || original->isFailed()) {
+        resourcesWithExtraHash.insert(resource->getExtraHash(), resource);
+    }
+    return QSharedPointer<Resource>();
+}
+
+void ResourceCache::removeResourceWithContent(const QString& contentKey, size_t extraHash) {
+    QWriteLocker locker(&_resourcesLock);
+    auto it = _resourcesWithContent.find(contentKey);
+    if (it != _resourcesWithContent.end()) {
+        auto resourceIt = it->find(extraHash);
+        if (resourceIt != it->end() && !resourceIt->lock()) {
+            it->erase(resourceIt);
+            if (it->isEmpty()) {
+                _resourcesWithContent.erase(it);
+            }
+        }
+    }
+}
+
+void ResourceCache::addSharedContent(qint64 size) {
+    ++_numSharedResources;
+    _sharedResourcesSize += size;
+    emit dirty();
+}
+
+void ResourceCache::removeSharedContent(qint64 size) {
+    --_numSharedResources;
+    _sharedResourcesSize -= size;
+    emit dirty();
+}
+
 void ResourceCache::setUnusedResourceCacheSize(qint64 unusedResourcesMaxSize) {
     _unusedResourcesMaxSize = glm::clamp(unusedResourcesMaxSize, MIN_UNUSED_MAX_SIZE, MAX_UNUSED_MAX_SIZE);
     reserveUnusedResource(0);
@@ -545,10 +733,8 @@ void ResourceCache::requestCompleted(QWeakPointer<Resource> resource) {
 
     sharedItems->removeRequest(resource);
 
-    // Now go fill any new request spots
-    while (sharedItems->getLoadingRequestsCount() < sharedItems->getRequestLimit() && sharedItems->getPendingRequestsCount() > 0) {
-        attemptHighestPriorityRequest();
-    }
+    // Now go fill any new request spots, as far as the budgets of the pending types allow
+    while (sharedItems->getLoadingRequestsCount() < sharedItems->getRequestLimit() && attemptHighestPriorityRequest()) {}
 }
 
 bool ResourceCache::attemptHighestPriorityRequest() {
@@ -557,6 +743,12 @@ bool ResourceCache::attemptHighestPriorityRequest() {
     return (resource && attemptRequest(resource));
 }
 
+void ResourceCache::updatePendingRequest(QWeakPointer<Resource> resource) {
+    if (resource) {
+        DependencyManager::get<ResourceCacheSharedItems>()->updatePendingRequest(resource);
+    }
+}
+
 static int requestID = 0;
 
 Resource::Resource(const Resource& other) :
@@ -595,6 +787,18 @@ Resource::~Resource() {
         _request = nullptr;
         ResourceCache::requestCompleted(_self);
     }
+    unshareContent();
+    if (_cache && !_contentKey.isEmpty()) {
+        _cache->removeResourceWithContent(_contentKey, _extraHash);
+    }
+}
+
+void Resource::setCache(ResourceCache* cache) {
+    if (cache != _cache) {
+        // shared content is counted by the cache
+        unshareContent();
+    }
+    _cache = cache;
 }
 
 void Resource::ensureLoading() {
@@ -606,6 +810,7 @@ void Resource::ensureLoading() {
 void Resource::setLoadPriority(const QPointer<QObject>& owner, float priority) {
     if (!_failedToLoad) {
         _loadPriorities.insert(owner, priority);
+        ResourceCache::updatePendingRequest(_self);
     }
 }
 
@@ -617,11 +822,13 @@ void Resource::setLoadPriorities(const QHash<QPointer<QObject>, float>& prioriti
             it != priorities.constEnd(); it++) {
         _loadPriorities.insert(it.key(), it.value());
     }
+    ResourceCache::updatePendingRequest(_self);
 }
 
 void Resource::clearLoadPriority(const QPointer<QObject>& owner) {
     if (!_failedToLoad) {
         _loadPriorities.remove(owner);
+        ResourceCache::updatePendingRequest(_self);
     }
 }
 
@@ -690,6 +897,7 @@ void Resource::init(bool resetLoaded) {
     _failedToLoad = false;
     if (resetLoaded) {
         _loaded = false;
+        unshareContent();
     }
     _attempts = 0;
     
@@ -733,6 +941,57 @@ void Resource::setSize(const qint64& bytes) {
 void Resource::reinsert() {
     QWriteLocker locker(&_cache->_resourcesLock);
     _cache->_resources[_url].insert(_extraHash, _self);
+
+    // unused resources can still share their content
+    if (!_contentKey.isEmpty()) {
+        auto& resourcesWithExtraHash = _cache->_resourcesWithContent[_contentKey];
+        if (!resourcesWithExtraHash.value(_extraHash).lock()) {
+            resourcesWithExtraHash.insert(_extraHash, _self);
+        }
+    }
+}
+
+void Resource::hashContent(const QByteArray& data) {
+    // it takes about as long as reading the data, which keeps it off the thread of the requests
+    auto self = _self;
+    auto numRequestsMade = _numRequestsMade;
+    ResourceProcessingPool::getInstance().start(getType(), [self, data, numRequestsMade] {
+        QString contentHash = AssetUtils::hashData(data).toHex();
+        auto resource = self.lock();
+        if (!resource) {
+            return;
+        }
+        QMetaObject::invokeMethod(resource.data(), [resource, data, numRequestsMade, contentHash] {
+            if (resource->_numRequestsMade == numRequestsMade && !resource->shareContent(contentHash)) {
+                resource->downloadFinished(data);
+            }
+        });
+    }, data.size());
+}
+
+bool Resource::shareContent(const QString& contentHash) {
+    auto self = _self.lock();
+    if (contentHash.isEmpty() || !_cache || !self || !canShareContent()) {
+        return false;
+    }
+
+    // the same data is parsed the same way if it's the same kind of file
+    _contentKey = contentHash + "." + QFileInfo(_url.path()).completeSuffix().toLower();
+    auto original = _cache->findResourceWithContent(self);
+    if (!original || !adoptContent(*original)) {
+        return false;
+    }
+
+    _sharedContentSize = original->getBytes();
+    _cache->addSharedContent(_sharedContentSize);
+    return true;
+}
+
+void Resource::unshareContent() {
+    if (_sharedContentSize > 0 && _cache) {
+        _cache->removeSharedContent(_sharedContentSize);
+    }
+    _sharedContentSize = 0;
 }
 
 
@@ -747,6 +1006,7 @@ void Resource::makeRequest() {
 
     _request = DependencyManager::get<ResourceManager>()->createResourceRequest(
         this, _activeUrl, true, -1, "Resource::makeRequest");
+    ++_numRequestsMade;
 
     if (!_request) {
         ResourceCache::requestCompleted(_self);
@@ -809,7 +1069,12 @@ void Resource::handleReplyFinished() {
 
         auto data = _request->getData();
         emit loaded(data);
-        downloadFinished(data);
+        auto contentHash = _request->getContentHash();
+        if (contentHash.isEmpty() && _request->isWholeContent() && _cache && canShareContent()) {
+            hashContent(data);
+        } else if (!shareContent(contentHash)) {
+            downloadFinished(data);
+        }
     } else {
         handleFailedRequest(result);
     }
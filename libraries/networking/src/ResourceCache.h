@@ -13,7 +13,9 @@
 #define hifi_ResourceCache_h
 
 #include <atomic>
+#include <map>
 #include <mutex>
+#include <vector>
 
 #include <QtCore/QHash>
 #include <QtCore/QList>
@@ -68,9 +70,19 @@ class ResourceCacheSharedItems : public Dependency  {
 public:
     bool appendRequest(QWeakPointer<Resource> newRequest);
     void removeRequest(QWeakPointer<Resource> doneRequest);
+    /// Moves a pending request to where its current load priority puts it in the queue
+    void updatePendingRequest(QWeakPointer<Resource> request);
     void setRequestLimit(uint32_t limit);
     uint32_t getRequestLimit() const;
+    /// Limits the loading requests of a type of resource (see Resource::getType) to a fraction of the request limit, so
+    /// that other types don't wait behind a flood of them. Types without a budget can use all of the requests, and a
+    /// type can use more than its budget while no other type is waiting for the rest.
+    void setRequestBudget(const QString& type, float fraction);
+    float getRequestBudget(const QString& type) const;
+    /// Sets how much load priority a pending request gains for each second it waits
+    void setPriorityAging(float priorityPerSecond);
     QList<QSharedPointer<Resource>> getPendingRequests() const;
+    /// Takes the highest priority pending request of a type that is within its budget
     QSharedPointer<Resource> getHighestPendingRequest();
     uint32_t getPendingRequestsCount() const;
     QList<QSharedPointer<Resource>> getLoadingRequests() const;
@@ -78,13 +90,58 @@ public:
     void clear();
 
 private:
-    ResourceCacheSharedItems() = default;
+    ResourceCacheSharedItems();
+
+    // file requests go first, then the highest aged priority, then the oldest
+    class PendingKey {
+    public:
+        bool operator<(const PendingKey& other) const;
+        bool operator==(const PendingKey& other) const;
+
+        bool isFile;
+        double priority;
+        uint64_t sequence;
+    };
+
+    class PendingRequest {
+    public:
+        QWeakPointer<Resource> resource;
+        QString type;
+        PendingKey key;
+        double queuedSeconds;
+    };
+
+    class LoadingRequest {
+    public:
+        QWeakPointer<Resource> resource;
+        QString type;
+    };
+
+    // indexed by _pendingRequests, which holds the resources
+    using PendingQueue = std::map<PendingKey, Resource*>;
+
+    class TypeRequests {
+    public:
+        PendingQueue pending;
+        uint32_t numLoading { 0 };
+        float budget { 1.0f };
+    };
+
+    PendingKey computeKey(Resource& resource, double queuedSeconds, uint64_t sequence) const;
+    bool isUnderTypeLimit(const TypeRequests& requests) const;
+    bool isWithinBudget(const TypeRequests& requests) const;
+    void removePendingRequest(Resource* resource);
+    // the top of the queue with its key up to date, or the end if it is empty
+    PendingQueue::iterator getTopPendingRequest(PendingQueue& queue);
 
     mutable Mutex _mutex;
-    QList<QWeakPointer<Resource>> _pendingRequests;
-    QList<QWeakPointer<Resource>> _loadingRequests;
+    QHash<QString, TypeRequests> _requestsByType;
+    QHash<Resource*, PendingRequest> _pendingRequests;
+    std::vector<LoadingRequest> _loadingRequests;
     const uint32_t DEFAULT_REQUEST_LIMIT = 10;
     uint32_t _requestLimit { DEFAULT_REQUEST_LIMIT };
+    float _priorityAging;
+    uint64_t _nextSequence { 0 };
 };
 
 /// Wrapper to expose resources to JS/QML
@@ -199,6 +256,8 @@ class ResourceCache : public QObject {
     Q_PROPERTY(size_t numCached READ getNumCachedResources NOTIFY dirty)
     Q_PROPERTY(size_t sizeTotal READ getSizeTotalResources NOTIFY dirty)
     Q_PROPERTY(size_t sizeCached READ getSizeCachedResources NOTIFY dirty)
+    Q_PROPERTY(size_t numShared READ getNumSharedResources NOTIFY dirty)
+    Q_PROPERTY(size_t sizeShared READ getSizeSharedResources NOTIFY dirty)
 
 public:
 
@@ -206,6 +265,8 @@ public:
     size_t getSizeTotalResources() const { return _totalResourcesSize; }
     size_t getNumCachedResources() const { return _numUnusedResources; }
     size_t getSizeCachedResources() const { return _unusedResourcesSize; }
+    size_t getNumSharedResources() const { return _numSharedResources; }
+    size_t getSizeSharedResources() const { return _sharedResourcesSize; }
 
     Q_INVOKABLE QVariantList getResourceList();
 
@@ -270,6 +331,7 @@ protected:
     static bool attemptRequest(QSharedPointer<Resource> resource);
     static void requestCompleted(QWeakPointer<Resource> resource);
     static bool attemptHighestPriorityRequest();
+    static void updatePendingRequest(QWeakPointer<Resource> resource);
 
 private:
     friend class Resource;
@@ -278,6 +340,12 @@ private:
     void reserveUnusedResource(qint64 resourceSize);
     void removeResource(const QUrl& url, size_t extraHash, qint64 size = 0);
 
+    // The loaded resource with the same content as this one, which becomes the resource with its content if there's none
+    QSharedPointer<Resource> findResourceWithContent(const QSharedPointer<Resource>& resource);
+    void removeResourceWithContent(const QString& contentKey, size_t extraHash);
+    void addSharedContent(qint64 size);
+    void removeSharedContent(qint64 size);
+
     void resetTotalResourceCounter();
     void resetUnusedResourceCounter();
     void resetResourceCounters();
@@ -297,6 +365,13 @@ private:
 
     std::atomic<size_t> _numUnusedResources { 0 };
     std::atomic<qint64> _unusedResourcesSize { 0 };
+
+    // Resources by the hash of their content, under _resourcesLock
+    QHash<QString, QHash<size_t, QWeakPointer<Resource>>> _resourcesWithContent;
+
+    // Resources that use the content of another instead of loading their own
+    std::atomic<size_t> _numSharedResources { 0 };
+    std::atomic<qint64> _sharedResourcesSize { 0 };
 };
 
 /// Wrapper to expose resource caches to JS/QML
@@ -311,11 +386,17 @@ class ScriptableResourceCache : public QObject {
      * @property {number} numCached - Total number of cached resource. <em>Read-only.</em>
      * @property {number} sizeTotal - Size in bytes of all resources. <em>Read-only.</em>
      * @property {number} sizeCached - Size in bytes of all cached resources. <em>Read-only.</em>
+     * @property {number} numShared - Total number of resources that use the content of another resource with identical
+     *     data, loaded from a different URL. <em>Read-only.</em>
+     * @property {number} sizeShared - Size in bytes of the content that was shared rather than loaded again.
+     *     <em>Read-only.</em>
      */
     Q_PROPERTY(size_t numTotal READ getNumTotalResources NOTIFY dirty)
     Q_PROPERTY(size_t numCached READ getNumCachedResources NOTIFY dirty)
     Q_PROPERTY(size_t sizeTotal READ getSizeTotalResources NOTIFY dirty)
     Q_PROPERTY(size_t sizeCached READ getSizeCachedResources NOTIFY dirty)
+    Q_PROPERTY(size_t numShared READ getNumSharedResources NOTIFY dirty)
+    Q_PROPERTY(size_t sizeShared READ getSizeSharedResources NOTIFY dirty)
 
     /**jsdoc
      * @property {number} numGlobalQueriesPending - Total number of global queries pending (across all resource cache managers).
@@ -399,6 +480,8 @@ private:
     size_t getSizeTotalResources() const { return _resourceCache->getSizeTotalResources(); }
     size_t getNumCachedResources() const { return _resourceCache->getNumCachedResources(); }
     size_t getSizeCachedResources() const { return _resourceCache->getSizeCachedResources(); }
+    size_t getNumSharedResources() const { return _resourceCache->getNumSharedResources(); }
+    size_t getSizeSharedResources() const { return _resourceCache->getSizeSharedResources(); }
 
     size_t getNumGlobalQueriesPending() const { return ResourceCache::getPendingRequestCount(); }
     size_t getNumGlobalQueriesLoading() const { return ResourceCache::getLoadingRequestCount(); }
@@ -457,7 +540,7 @@ public:
 
     void setSelf(const QWeakPointer<Resource>& self) { _self = self; }
 
-    void setCache(ResourceCache* cache) { _cache = cache; }
+    void setCache(ResourceCache* cache);
 
     virtual void deleter() { allReferencesCleared(); }
     
@@ -511,6 +594,15 @@ protected:
     /// This should be overridden by subclasses that need to process the data once it is downloaded.
     virtual void downloadFinished(const QByteArray& data) { finishedLoading(true); }
 
+    /// Checks whether the resource can use the content of another resource with the same data instead of processing
+    /// its own, see adoptContent. What its requests download is then hashed, with the processing of the other resources
+    /// of its type, if they don't already know its hash.
+    virtual bool canShareContent() const { return false; }
+
+    /// Called instead of downloadFinished when a loaded resource of the same cache, with the same extra hash, downloaded
+    /// the same data. Returns true if the resource took the content of the other and finished loading.
+    virtual bool adoptContent(const Resource& original) { return false; }
+
     /// Called when the download is finished and processed, sets the number of actual bytes.
     void setSize(const qint64& bytes);
 
@@ -562,6 +654,12 @@ private:
     void retry();
     void reinsert();
 
+    // Hashes the content of requests that don't know its hash on the processing pool, then shares it or processes it
+    void hashContent(const QByteArray& data);
+    // Returns true if the resource adopted the content of another with the same hash
+    bool shareContent(const QString& contentHash);
+    void unshareContent();
+
     bool isInScript() const { return _isInScript; }
     void setInScript(bool isInScript) { _isInScript = isInScript; }
     
@@ -571,6 +669,12 @@ private:
     static const int MAX_ATTEMPTS = 8;
     unsigned int _attemptsRemaining { MAX_ATTEMPTS };
     bool _isInScript{ false };
+
+    // the content hash and the kind of file, which decides how the content is parsed
+    QString _contentKey;
+    qint64 _sharedContentSize { 0 };
+    // so that the hash of the content of a request that was since replaced is dropped
+    uint32_t _numRequestsMade { 0 };
 };
 
 uint qHash(const QPointer<QObject>& value, uint seed = 0);
@@ -0,0 +1,181 @@
+//
+//  ResourceProcessingPool.cpp
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ResourceProcessingPool.h"
+
+#include <QtCore/QThread>
+
+#include <Profile.h>
+
+// leave some cores to the main, render and audio threads
+static const int RESERVED_THREADS = 2;
+static const int MIN_THREADS = 1;
+static const qint64 DEFAULT_MEMORY_BUDGET = 512 * 1024 * 1024;
+
+namespace {
+
+class FunctionRunnable : public QRunnable {
+public:
+    FunctionRunnable(std::function<void()> function) : _function(std::move(function)) {}
+
+    void run() override { _function(); }
+
+private:
+    std::function<void()> _function;
+};
+
+class TaskRunner : public QRunnable {
+public:
+    TaskRunner(const QString& type, QRunnable* runnable, std::function<void()> finished) :
+        _name("ResourceProcessingPool:" + type), _runnable(runnable), _finished(std::move(finished)) {}
+
+    void run() override {
+        {
+            PROFILE_RANGE(resource_parse, _name);
+            _runnable->run();
+        }
+        if (_runnable->autoDelete()) {
+            delete _runnable;
+        }
+        _finished();
+    }
+
+private:
+    QString _name;
+    QRunnable* _runnable;
+    std::function<void()> _finished;
+};
+
+}
+
+ResourceProcessingPool& ResourceProcessingPool::getInstance() {
+    // never destroyed, resources can still be queueing work while statics are being destroyed at exit
+    static ResourceProcessingPool* instance = new ResourceProcessingPool();
+    return *instance;
+}
+
+ResourceProcessingPool::ResourceProcessingPool() :
+    _memoryBudget(DEFAULT_MEMORY_BUDGET)
+{
+    _threadPool.setMaxThreadCount(std::max(QThread::idealThreadCount() - RESERVED_THREADS, MIN_THREADS));
+}
+
+void ResourceProcessingPool::start(const QString& type, QRunnable* runnable, qint64 numBytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& queue = _queues[type];
+    if (!_types.contains(type)) {
+        _types.append(type);
+    }
+    Task task { runnable, numBytes, _nextTaskID++ };
+    queue.push_back(task);
+    ++_numQueuedTasks;
+
+    PROFILE_ASYNC_BEGIN(resource_parse, "Queued:" + type, QString::number(task.id), { { "bytes", numBytes } });
+    PROFILE_COUNTER(resource_parse, "ResourceProcessingPool", { { "queued", _numQueuedTasks } });
+    startTasks();
+}
+
+void ResourceProcessingPool::start(const QString& type, std::function<void()> task, qint64 numBytes) {
+    start(type, new FunctionRunnable(std::move(task)), numBytes);
+}
+
+void ResourceProcessingPool::startTasks() {
+    while (_numQueuedTasks > 0 && _numRunningTasks < _threadPool.maxThreadCount()) {
+        // the next type in turn with something to do
+        std::deque<Task>* queue = nullptr;
+        QString type;
+        for (int i = 0; i < _types.size() && !queue; ++i) {
+            int index = (_nextTypeIndex + i) % _types.size();
+            auto& typeQueue = _queues[_types[index]];
+            if (!typeQueue.empty()) {
+                queue = &typeQueue;
+                type = _types[index];
+                _nextTypeIndex = index + 1;
+            }
+        }
+        if (!queue) {
+            break;
+        }
+
+        // anything can run alone, however large
+        Task task = queue->front();
+        if (_numRunningTasks > 0 && _numBytesInFlight + task.numBytes > _memoryBudget) {
+            break;
+        }
+        queue->pop_front();
+        --_numQueuedTasks;
+        ++_numRunningTasks;
+        _numBytesInFlight += task.numBytes;
+
+        PROFILE_ASYNC_END(resource_parse, "Queued:" + type, QString::number(task.id));
+        PROFILE_COUNTER(resource_parse, "ResourceProcessingPool", { { "queued", _numQueuedTasks },
+                                                                    { "running", _numRunningTasks },
+                                                                    { "bytesInFlight", _numBytesInFlight } });
+
+        qint64 numBytes = task.numBytes;
+        _threadPool.start(new TaskRunner(type, task.runnable, [this, numBytes] {
+            finishTask(numBytes);
+        }));
+    }
+}
+
+void ResourceProcessingPool::finishTask(qint64 numBytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    --_numRunningTasks;
+    _numBytesInFlight -= numBytes;
+    startTasks();
+}
+
+void ResourceProcessingPool::setMaxThreadCount(int maxThreadCount) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _threadPool.setMaxThreadCount(std::max(maxThreadCount, MIN_THREADS));
+    startTasks();
+}
+
+int ResourceProcessingPool::getMaxThreadCount() const {
+    return _threadPool.maxThreadCount();
+}
+
+void ResourceProcessingPool::setMemoryBudget(qint64 numBytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _memoryBudget = numBytes;
+    startTasks();
+}
+
+qint64 ResourceProcessingPool::getMemoryBudget() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _memoryBudget;
+}
+
+int ResourceProcessingPool::getNumQueuedTasks() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _numQueuedTasks;
+}
+
+qint64 ResourceProcessingPool::getNumBytesInFlight() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _numBytesInFlight;
+}
+
+void ResourceProcessingPool::clear() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& queue : _queues) {
+            for (auto& task : queue) {
+                if (task.runnable->autoDelete()) {
+                    delete task.runnable;
+                }
+            }
+            queue.clear();
+        }
+        _numQueuedTasks = 0;
+    }
+    _threadPool.waitForDone();
+}
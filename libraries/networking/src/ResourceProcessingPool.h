@@ -0,0 +1,75 @@
+//
+//  ResourceProcessingPool.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ResourceProcessingPool_h
+#define hifi_ResourceProcessingPool_h
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include <QtCore/QHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+
+/// The threads that parse and decode downloaded resources, apart from the global thread pool so that they don't take
+/// all of it from the rest of the application.
+///
+/// Each type of resource has its queue, and the types take turns so that a flood of textures doesn't hold up models
+/// and sounds. Tasks only start while the data held by the running ones fits in a memory budget, so that decoded
+/// data doesn't pile up faster than it is used.
+class ResourceProcessingPool {
+public:
+    static ResourceProcessingPool& getInstance();
+
+    /// Queues the processing of a resource of a type, which holds about numBytes of memory while it runs. That is mostly
+    /// the decoded data, which can be many times the size of the downloaded file. The runnable is deleted once it has
+    /// run if it is auto-deleted.
+    void start(const QString& type, QRunnable* runnable, qint64 numBytes);
+    void start(const QString& type, std::function<void()> task, qint64 numBytes);
+
+    void setMaxThreadCount(int maxThreadCount);
+    int getMaxThreadCount() const;
+    void setMemoryBudget(qint64 numBytes);
+    qint64 getMemoryBudget() const;
+
+    int getNumQueuedTasks() const;
+    qint64 getNumBytesInFlight() const;
+
+    /// Drops the queued tasks and waits for the running ones to finish
+    void clear();
+
+private:
+    ResourceProcessingPool();
+
+    class Task {
+    public:
+        QRunnable* runnable;
+        qint64 numBytes;
+        uint64_t id;
+    };
+
+    void startTasks();
+    void finishTask(qint64 numBytes);
+
+    mutable std::mutex _mutex;
+    QThreadPool _threadPool;
+    QHash<QString, std::deque<Task>> _queues;
+    QStringList _types;
+    int _nextTypeIndex { 0 };
+    int _numQueuedTasks { 0 };
+    int _numRunningTasks { 0 };
+    qint64 _memoryBudget;
+    qint64 _numBytesInFlight { 0 };
+    uint64_t _nextTaskID { 0 };
+};
+
+#endif // hifi_ResourceProcessingPool_h
@@ -85,6 +85,10 @@ public:
     bool getRangeRequestSuccessful() const { return _rangeRequestSuccessful; }
     bool getTotalSizeOfResource() const { return _totalSizeOfResource; }
     QString getWebMediaType() const { return _webMediaType; }
+    /// The SHA-256 hash of the whole resource in hex, as ATP hashes are, if the request knows it. Empty for ranges.
+    QString getContentHash() const { return _contentHash; }
+    /// Whether the data is the whole resource, which can be hashed to compare it with other resources
+    bool isWholeContent() const { return _isWholeContent; }
     void setFailOnRedirect(bool failOnRedirect) { _failOnRedirect = failOnRedirect; }
 
     void setCacheEnabled(bool value) { _cacheEnabled = value; }
@@ -113,6 +117,8 @@ protected:
     bool _rangeRequestSuccessful { false };
     uint64_t _totalSizeOfResource { 0 };
     QString _webMediaType;
+    bool _isWholeContent { false };
+    QString _contentHash;
     int64_t _lastRecordedBytesDownloaded { 0 };
     bool _isObservable;
     qint64 _callerId;
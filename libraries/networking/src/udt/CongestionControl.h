@@ -49,6 +49,9 @@ public:
 
     virtual int estimatedTimeout() const = 0;
 
+    // smoothed round trip time in microseconds, -1 until measured
+    virtual int estimatedRTT() const { return -1; }
+
 protected:
     void setMSS(int mss) { _mss = mss; }
     virtual void setInitialSendSequenceNumber(SequenceNumber seqNum) = 0;
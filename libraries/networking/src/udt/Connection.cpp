@@ -11,6 +11,7 @@
 
 #include "Connection.h"
 
+#include <limits>
 #include <random>
 
 #include <QtCore/QThread>
@@ -443,6 +444,21 @@ void Connection::updateCongestionControlAndSendQueue(std::function<void ()> cong
     // record connection stats
     _stats.recordPacketSendPeriod(_congestionControl->_packetSendPeriod);
     _stats.recordCongestionWindowSize(_congestionControl->_congestionWindowSize);
+
+    int rtt = _congestionControl->estimatedRTT();
+    if (rtt > 0) {
+        _stats.recordRTT(std::max(1, (int)(rtt / USECS_PER_MSEC)));
+
+        // A full congestion window can go out every round trip, but the window only grows while our reliable traffic
+        // fills it. Below that it says how little we send reliably rather than what the link carries, so the sample
+        // is left without an estimate.
+        static const int MIN_SATURATED_WINDOW_DIVISOR = 2;
+        int packetsInFlight = seqoff(_lastReceivedACK, sendQueue.getCurrentSequenceNumber());
+        if (packetsInFlight * MIN_SATURATED_WINDOW_DIVISOR >= _congestionControl->_congestionWindowSize) {
+            qint64 packetsPerSecond = (qint64)_congestionControl->_congestionWindowSize * USECS_PER_SECOND / rtt;
+            _stats.recordEstimatedBandwidth((int)std::min(packetsPerSecond, (qint64)std::numeric_limits<int>::max()));
+        }
+    }
 }
 
 void PendingReceivedMessage::enqueuePacket(std::unique_ptr<Packet> packet) {
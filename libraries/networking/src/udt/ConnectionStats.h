@@ -93,6 +93,8 @@ public:
 
     void recordCongestionWindowSize(int sample);
     void recordPacketSendPeriod(int sample);
+    void recordRTT(int sample); // milliseconds
+    void recordEstimatedBandwidth(int sample); // packets per second, only recorded while the congestion window is in use
     
 private:
     Stats _currentSample;
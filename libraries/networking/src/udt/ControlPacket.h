@@ -30,7 +30,11 @@ public:
         ACK,
         Handshake,
         HandshakeACK,
-        HandshakeRequest
+        HandshakeRequest,
+        CoalescedPackets,
+
+        // keep up to date with the last of the types, received types are checked against it
+        LastType = CoalescedPackets
     };
     
     static std::unique_ptr<ControlPacket> create(Type type, qint64 size = -1);
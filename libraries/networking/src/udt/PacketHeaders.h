@@ -191,6 +191,16 @@ public:
         return NON_SOURCED_PACKETS;
     }
 
+    // small, frequent, unreliable packets that may share a datagram with others for the same destination
+    const static QSet<PacketTypeEnum::Value> getCoalescablePackets() {
+        const static QSet<PacketTypeEnum::Value> COALESCABLE_PACKETS = QSet<PacketTypeEnum::Value>()
+            << PacketTypeEnum::Value::AvatarQuery
+            << PacketTypeEnum::Value::SilentAudioFrame
+            << PacketTypeEnum::Value::AudioStreamStats
+            << PacketTypeEnum::Value::EntityQuery;
+        return COALESCABLE_PACKETS;
+    }
+
     const static QSet<PacketTypeEnum::Value> getDomainSourcedPackets() {
         const static QSet<PacketTypeEnum::Value> DOMAIN_SOURCED_PACKETS = QSet<PacketTypeEnum::Value>()
             << PacketTypeEnum::Value::AssetMappingOperation
@@ -302,7 +312,8 @@ enum class AssetServerPacketVersion: PacketVersion {
     VegasCongestionControl = 19,
     RangeRequestSupport,
     RedirectedMappings,
-    BakingTextureMeta
+    BakingTextureMeta,
+    ChunkManifests
 };
 
 enum class AvatarMixerPacketVersion : PacketVersion {
@@ -356,7 +367,8 @@ enum class DomainConnectRequestVersion : PacketVersion {
     HasTimestamp,
     HasReason,
     HasSystemInfo,
-    HasCompressedSystemInfo
+    HasCompressedSystemInfo,
+    SupportsCoalescedPackets
 };
 
 enum class DomainConnectionDeniedVersion : PacketVersion {
@@ -377,7 +389,8 @@ enum class DomainListVersion : PacketVersion {
     GetMachineFingerprintFromUUIDSupport,
     AuthenticationOptional,
     HasTimestamp,
-    HasConnectReason
+    HasConnectReason,
+    SipHashPacketAuthentication
 };
 
 enum class AudioVersion : PacketVersion {
@@ -159,6 +159,48 @@ void PacketList::preparePackets(MessageNumber messageNumber) {
     }
 }
 
+void PacketList::setSource(Source source) {
+    Q_ASSERT_X(_isReliable && _isOrdered, "PacketList::setSource", "Only reliable ordered PacketLists can be streamed");
+    _source = std::move(source);
+    _isStreamed = true;
+}
+
+std::unique_ptr<Packet> PacketList::takeStreamedPacket() {
+    Q_ASSERT(_isStreamed);
+
+    // stay a packet ahead of the send queue, the last packet of the message has to be known to be marked as such
+    while (_source && _packets.size() < 2) {
+        if (_source(*this, getMaxSegmentSize()) <= 0) {
+            // we're done with the source, let go of whatever it was holding on to
+            _source = nullptr;
+            closeCurrentPacket();
+        }
+    }
+
+    if (_packets.empty()) {
+        return PacketPointer();
+    }
+
+    auto packet = std::move(_packets.front());
+    _packets.pop_front();
+
+    if (_packetFinalizer) {
+        _packetFinalizer(*packet);
+    }
+
+    bool isFirst = _nextMessagePartNumber == 0;
+    bool isLast = !hasStreamedPackets();
+    Packet::PacketPosition position;
+    if (isFirst) {
+        position = isLast ? Packet::PacketPosition::ONLY : Packet::PacketPosition::FIRST;
+    } else {
+        position = isLast ? Packet::PacketPosition::LAST : Packet::PacketPosition::MIDDLE;
+    }
+    packet->writeMessageNumber(_messageNumber, position, _nextMessagePartNumber++);
+
+    return packet;
+}
+
 const qint64 PACKET_LIST_WRITE_ERROR = -1;
 
 qint64 PacketList::writeString(const QString& string) {
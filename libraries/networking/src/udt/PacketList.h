@@ -12,6 +12,7 @@
 #ifndef hifi_PacketList_h
 #define hifi_PacketList_h
 
+#include <functional>
 #include <memory>
 
 #include "../ExtendedIODevice.h"
@@ -29,6 +30,12 @@ class PacketList : public ExtendedIODevice {
 public:
     using MessageNumber = uint32_t;
     using PacketPointer = std::unique_ptr<Packet>;
+
+    // Writes up to maxSize more bytes of a streamed message to the packet list and returns how many it wrote,
+    // 0 once there is nothing left to write
+    using Source = std::function<qint64(PacketList& packetList, qint64 maxSize)>;
+    // Called on each packet of a streamed list right before it gets sent, to fill in what the sender would have
+    using PacketFinalizer = std::function<void(Packet& packet)>;
     
     static std::unique_ptr<PacketList> create(PacketType packetType, QByteArray extendedHeader = QByteArray(),
                                               bool isReliable = false, bool isOrdered = false);
@@ -54,6 +61,11 @@ public:
     
     void closeCurrentPacket(bool shouldSendEmpty = false);
 
+    // Streams the rest of the message from the source. Instead of all being written up front, the packets get written
+    // as the send queue gets to them, so only about a flow window of them is ever in memory. Reliable ordered lists only.
+    void setSource(Source source);
+    bool isStreamed() const { return _isStreamed; }
+
     // QIODevice virtual functions
     virtual bool isSequential() const override { return false; }
     virtual qint64 size() const override { return getDataSize(); }
@@ -93,6 +105,12 @@ private:
     // Creates a new packet, can be overriden to change return underlying type
     virtual std::unique_ptr<Packet> createPacket();
     std::unique_ptr<Packet> createPacketWithExtendedHeader();
+
+    void setPacketFinalizer(PacketFinalizer finalizer) { _packetFinalizer = std::move(finalizer); }
+
+    bool hasStreamedPackets() const { return _source || !_packets.empty() || _currentPacket; }
+    // Takes the next packet of a streamed list, writing it from the source first if need be
+    std::unique_ptr<Packet> takeStreamedPacket();
     
     Packet::MessageNumber _messageNumber;
     bool _isReliable = false;
@@ -102,6 +120,11 @@ private:
     int _segmentStartIndex = -1;
     
     QByteArray _extendedHeader;
+
+    bool _isStreamed { false };
+    Source _source;
+    PacketFinalizer _packetFinalizer;
+    Packet::MessagePartNumber _nextMessagePartNumber { 0 };
 };
 
 template<typename T> std::unique_ptr<T> PacketList::takeFront() {
@@ -16,7 +16,7 @@
 using namespace udt;
 
 PacketQueue::PacketQueue(MessageNumber messageNumber) : _currentMessageNumber(messageNumber) {
-    _channels.emplace_front(new std::list<PacketPointer>());
+    _channels.emplace_front(new ChannelData());
     _currentChannel = _channels.begin();
 }
 
@@ -30,35 +30,64 @@ bool PacketQueue::isEmpty() const {
     LockGuard locker(_packetsLock);
 
     // Only the main channel and it is empty
-    return _channels.size() == 1 && _channels.front()->empty();
+    return _channels.size() == 1 && _channels.front()->isEmpty();
 }
 
 PacketQueue::PacketPointer PacketQueue::takePacket() {
-    LockGuard locker(_packetsLock);
+    ChannelData* channel;
+    {
+        LockGuard locker(_packetsLock);
 
-    if (isEmpty()) {
-        return PacketPointer();
-    }
+        if (isEmpty()) {
+            return PacketPointer();
+        }
 
-    // handle the case where we are looking at the first channel and it is empty
-    if (_currentChannel == _channels.begin() && (*_currentChannel)->empty()) {
-        ++_currentChannel;
-    }
+        // handle the case where we are looking at the first channel and it is empty
+        if (_currentChannel == _channels.begin() && (*_currentChannel)->isEmpty()) {
+            ++_currentChannel;
+        }
+
+        // at this point the current channel should always not be at the end and should also not be empty
+        Q_ASSERT(_currentChannel != _channels.end());
 
-    // at this point the current channel should always not be at the end and should also not be empty
-    Q_ASSERT(_currentChannel != _channels.end());
+        channel = _currentChannel->get();
 
-    auto& channel = *_currentChannel;
+        Q_ASSERT(!channel->isEmpty());
 
-    Q_ASSERT(!channel->empty());
+        if (!channel->packets.empty()) {
+            // Take front packet
+            auto packet = std::move(channel->packets.front());
+            channel->packets.pop_front();
+            nextChannel();
+            return packet;
+        }
+    }
+
+    // A streamed list. We are the only ones taking packets, so the channel and our position in the channels stay put
+    // while its next packet gets written, and its list is only looked at again once we're done with it.
+    auto packet = channel->stream->takeStreamedPacket();
+    bool isStreamDone = !channel->stream->hasStreamedPackets();
+
+    Channel finishedChannel;
+    {
+        LockGuard locker(_packetsLock);
+        Q_ASSERT(_currentChannel->get() == channel);
+        channel->isStreamDone = isStreamDone;
+        finishedChannel = nextChannel();
+    }
+    // whatever the stream's source still held on to gets released outside of the lock as well
+    finishedChannel.reset();
 
-    // Take front packet
-    auto packet = std::move(channel->front());
-    channel->pop_front();
+    return packet;
+}
+
+PacketQueue::Channel PacketQueue::nextChannel() {
+    Channel finishedChannel;
 
     // Remove now empty channel (Don't remove the main channel)
-    if (channel->empty() && _currentChannel != _channels.begin()) {
+    if ((*_currentChannel)->isEmpty() && _currentChannel != _channels.begin()) {
         // erase the current channel and slide the iterator to the next channel
+        finishedChannel = std::move(*_currentChannel);
         _currentChannel = _channels.erase(_currentChannel);
     } else {
         ++_currentChannel;
@@ -76,20 +105,32 @@ PacketQueue::PacketPointer PacketQueue::takePacket() {
         _currentChannel = _channels.begin();
     }
 
-    return packet;
+    return finishedChannel;
 }
 
 void PacketQueue::queuePacket(PacketPointer packet) {
     LockGuard locker(_packetsLock);
-    _channels.front()->push_back(std::move(packet));
+    _channels.front()->packets.push_back(std::move(packet));
 }
 
 void PacketQueue::queuePacketList(PacketListPointer packetList) {
+    LockGuard locker(_packetsLock);
+    _channels.emplace_back(new ChannelData());
+
+    if (packetList->isStreamed()) {
+        // its packets get their message number and position as they're taken
+        packetList->_messageNumber = getNextMessageNumber();
+        _channels.back()->stream = std::move(packetList);
+        return;
+    }
+
     if (packetList->isOrdered()) {
         packetList->preparePackets(getNextMessageNumber());
     }
 
-    LockGuard locker(_packetsLock);
-    _channels.emplace_back(new std::list<PacketPointer>());
-    _channels.back()->swap(packetList->_packets);
+    _channels.back()->packets.swap(packetList->_packets);
+}
+
+bool PacketQueue::ChannelData::isEmpty() const {
+    return packets.empty() && !(stream && !isStreamDone);
 }
@@ -31,7 +31,18 @@ class PacketQueue {
     using PacketPointer = std::unique_ptr<Packet>;
     using PacketListPointer = std::unique_ptr<PacketList>;
     using RawChannel = std::list<PacketPointer>;
-    using Channel = std::unique_ptr<RawChannel>;
+
+    // The packets of a packet list, or of the main channel. Streamed packet lists keep writing theirs as they're taken.
+    class ChannelData {
+    public:
+        RawChannel packets;
+        PacketListPointer stream;
+        bool isStreamDone { false }; // set under the lock once the stream has handed out its last packet
+
+        bool isEmpty() const;
+    };
+
+    using Channel = std::unique_ptr<ChannelData>;
     using Channels = std::list<Channel>;
     
 public:
@@ -40,6 +51,8 @@ public:
     void queuePacketList(PacketListPointer packetList);
     
     bool isEmpty() const;
+    // Only the send queue's thread takes packets. The next packet of a streamed list gets written from its source
+    // without holding the lock, so that queueing more packets doesn't wait on the source reading files or signing.
     PacketPointer takePacket();
     
     Mutex& getLock() { return _packetsLock; }
@@ -48,6 +61,8 @@ public:
     
 private:
     MessageNumber getNextMessageNumber();
+    // Moves on from the current channel once a packet was taken from it, returns the channel if it was done with
+    Channel nextChannel();
 
     MessageNumber _currentMessageNumber { 0 };
     
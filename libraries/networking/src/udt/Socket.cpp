@@ -39,10 +39,16 @@ using namespace udt;
 #endif
 
 
+static const int COALESCED_PACKETS_FLUSH_INTERVAL_MSECS = 5;
+
+// each packet in a CoalescedPackets datagram is prefixed with its size
+using CoalescedPacketSize = uint16_t;
+
 Socket::Socket(QObject* parent, bool shouldChangeSocketOptions) :
     QObject(parent),
     _udpSocket(parent),
     _readyReadBackupTimer(new QTimer(this)),
+    _coalescedPacketsFlushTimer(new QTimer(this)),
     _shouldChangeSocketOptions(shouldChangeSocketOptions)
 {
     connect(&_udpSocket, &QUdpSocket::readyRead, this, &Socket::readPendingDatagrams);
@@ -56,6 +62,12 @@ Socket::Socket(QObject* parent, bool shouldChangeSocketOptions) :
     const int READY_READ_BACKUP_CHECK_MSECS = 2 * 1000;
     connect(_readyReadBackupTimer, &QTimer::timeout, this, &Socket::checkForReadyReadBackup);
     _readyReadBackupTimer->start(READY_READ_BACKUP_CHECK_MSECS);
+
+    // whatever packets have been coalesced by the end of a tick go out, even if their datagram isn't full.
+    // It is only started once there is something to flush.
+    _coalescedPacketsFlushTimer->setSingleShot(true);
+    _coalescedPacketsFlushTimer->setInterval(COALESCED_PACKETS_FLUSH_INTERVAL_MSECS);
+    connect(_coalescedPacketsFlushTimer, &QTimer::timeout, this, &Socket::flushCoalescedPackets);
 }
 
 void Socket::bind(const QHostAddress& address, quint16 port) {
@@ -154,6 +166,114 @@ qint64 Socket::writePacket(const Packet& packet, const HifiSockAddr& sockAddr) {
     return writeDatagram(packet.getData(), packet.getDataSize(), sockAddr);
 }
 
+qint64 Socket::writeCoalescedPacket(const Packet& packet, const HifiSockAddr& sockAddr) {
+    Q_ASSERT_X(!packet.isReliable(), "Socket::writeCoalescedPacket", "Cannot coalesce a reliable packet");
+
+    const qint64 coalescedSize = sizeof(CoalescedPacketSize) + packet.getDataSize();
+    if (coalescedSize > ControlPacket::maxPayloadSize()) {
+        // too big to share a datagram with anything else
+        return writePacket(packet, sockAddr);
+    }
+
+    SequenceNumber sequenceNumber;
+    {
+        Lock lock(_unreliableSequenceNumbersMutex);
+        sequenceNumber = ++_unreliableSequenceNumbers[sockAddr];
+    }
+
+    auto connection = findOrCreateConnection(sockAddr, true);
+    if (connection) {
+        connection->recordSentUnreliablePackets(packet.getWireSize(),
+                                                packet.getPayloadSize());
+    }
+
+    packet.writeSequenceNumber(sequenceNumber);
+
+    Lock lock(_coalescedPacketsMutex);
+    bool hadPendingPackets = !_coalescedPackets.empty();
+    auto& coalescedPacket = _coalescedPackets[sockAddr];
+
+    if (coalescedPacket && !coalescePacket(*coalescedPacket, packet)) {
+        writeDatagram(coalescedPacket->getData(), coalescedPacket->getDataSize(), sockAddr);
+        coalescedPacket.reset();
+    }
+
+    if (!coalescedPacket) {
+        coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+        coalescePacket(*coalescedPacket, packet);
+    }
+
+    if (!hadPendingPackets) {
+        // we may be on any thread, the timer lives on ours
+        QMetaObject::invokeMethod(_coalescedPacketsFlushTimer, "start", Qt::QueuedConnection);
+    }
+
+    return packet.getDataSize();
+}
+
+bool Socket::coalescePacket(ControlPacket& coalescedPacket, const Packet& packet) {
+    const qint64 coalescedSize = sizeof(CoalescedPacketSize) + packet.getDataSize();
+    if (coalescedPacket.bytesAvailableForWrite() < coalescedSize) {
+        return false;
+    }
+
+    coalescedPacket.writePrimitive((CoalescedPacketSize)packet.getDataSize());
+    coalescedPacket.write(packet.getData(), packet.getDataSize());
+    return true;
+}
+
+bool Socket::splitCoalescedPackets(const ControlPacket& coalescedPacket, std::vector<std::unique_ptr<Packet>>& packets) {
+    const char* data = coalescedPacket.getPayload();
+    const char* end = data + coalescedPacket.getPayloadSize();
+
+    // the whole datagram is dropped if any of it is wrong, it didn't come from writeCoalescedPacket
+    std::vector<std::unique_ptr<Packet>> splitPackets;
+    while (data < end) {
+        if (end - data < (qint64)sizeof(CoalescedPacketSize)) {
+            return false;
+        }
+        CoalescedPacketSize packetSize;
+        memcpy(&packetSize, data, sizeof(CoalescedPacketSize));
+        data += sizeof(CoalescedPacketSize);
+
+        if (packetSize < Packet::totalHeaderSize() || packetSize > end - data) {
+            return false;
+        }
+
+        // only unreliable data packets are ever coalesced
+        uint32_t bitField;
+        memcpy(&bitField, data, sizeof(bitField));
+        if (bitField & (CONTROL_BIT_MASK | RELIABILITY_BIT_MASK | MESSAGE_BIT_MASK)) {
+            return false;
+        }
+
+        auto buffer = std::unique_ptr<char[]>(new char[packetSize]);
+        memcpy(buffer.get(), data, packetSize);
+        data += packetSize;
+
+        auto packet = Packet::fromReceivedPacket(std::move(buffer), packetSize, coalescedPacket.getSenderSockAddr());
+        packet->setReceiveTime(coalescedPacket.getReceiveTime());
+        splitPackets.push_back(std::move(packet));
+    }
+
+    for (auto& packet : splitPackets) {
+        packets.push_back(std::move(packet));
+    }
+    return true;
+}
+
+void Socket::flushCoalescedPackets() {
+    Lock lock(_coalescedPacketsMutex);
+
+    for (auto& pair : _coalescedPackets) {
+        if (pair.second) {
+            writeDatagram(pair.second->getData(), pair.second->getDataSize(), pair.first);
+        }
+    }
+
+    _coalescedPackets.clear();
+}
+
 qint64 Socket::writePacket(std::unique_ptr<Packet> packet, const HifiSockAddr& sockAddr) {
 
     if (packet->isReliable()) {
@@ -176,7 +296,7 @@ qint64 Socket::writePacket(std::unique_ptr<Packet> packet, const HifiSockAddr& s
 
 qint64 Socket::writePacketList(std::unique_ptr<PacketList> packetList, const HifiSockAddr& sockAddr) {
 
-    if (packetList->getNumPackets() == 0) {
+    if (packetList->getNumPackets() == 0 && !packetList->isStreamed()) {
         qCWarning(networking) << "Trying to send packet list with 0 packets, bailing.";
         return 0;
     }
@@ -431,6 +551,12 @@ void Socket::readPendingDatagrams() {
             auto controlPacket = ControlPacket::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
             controlPacket->setReceiveTime(receiveTime);
 
+            if (controlPacket->getType() == ControlPacket::CoalescedPackets) {
+                // split this datagram back into the packets it carries
+                processCoalescedPackets(*controlPacket);
+                continue;
+            }
+
             // move this control packet to the matching connection, if there is one
             auto connection = findOrCreateConnection(senderSockAddr, true);
 
@@ -443,42 +569,57 @@ void Socket::readPendingDatagrams() {
             auto packet = Packet::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
             packet->setReceiveTime(receiveTime);
 
-            // save the sequence number in case this is the packet that sticks readyRead
-            _lastReceivedSequenceNumber = packet->getSequenceNumber();
+            processReceivedPacket(std::move(packet));
+        }
+    }
+}
+
+void Socket::processReceivedPacket(std::unique_ptr<Packet> packet) {
+    // save the sequence number in case this is the packet that sticks readyRead
+    _lastReceivedSequenceNumber = packet->getSequenceNumber();
 
-            // call our verification operator to see if this packet is verified
-            if (!_packetFilterOperator || _packetFilterOperator(*packet)) {
-                auto connection = findOrCreateConnection(senderSockAddr, true);
+    // call our verification operator to see if this packet is verified
+    if (!_packetFilterOperator || _packetFilterOperator(*packet)) {
+        auto connection = findOrCreateConnection(packet->getSenderSockAddr(), true);
 
-                if (packet->isReliable()) {
-                    // if this was a reliable packet then signal the matching connection with the sequence number
+        if (packet->isReliable()) {
+            // if this was a reliable packet then signal the matching connection with the sequence number
 
-                    if (!connection || !connection->processReceivedSequenceNumber(packet->getSequenceNumber(),
-                                                                                  packet->getDataSize(),
-                                                                                  packet->getPayloadSize())) {
-                        // the connection could not be created or indicated that we should not continue processing this packet
+            if (!connection || !connection->processReceivedSequenceNumber(packet->getSequenceNumber(),
+                                                                          packet->getDataSize(),
+                                                                          packet->getPayloadSize())) {
+                // the connection could not be created or indicated that we should not continue processing this packet
 #ifdef UDT_CONNECTION_DEBUG
-                        qCDebug(networking) << "Can't process packet: version" << (unsigned int)NLPacket::versionInHeader(*packet)
-                            << ", type" << NLPacket::typeInHeader(*packet);
+                qCDebug(networking) << "Can't process packet: version" << (unsigned int)NLPacket::versionInHeader(*packet)
+                    << ", type" << NLPacket::typeInHeader(*packet);
 #endif
-                        continue;
-                    }
-                } else if (connection) {
-                    connection->recordReceivedUnreliablePackets(packet->getWireSize(),
-                                                                packet->getPayloadSize());
-                }
-
-                if (packet->isPartOfMessage()) {
-                    auto connection = findOrCreateConnection(senderSockAddr, true);
-                    if (connection) {
-                        connection->queueReceivedMessagePacket(std::move(packet));
-                    }
-                } else if (_packetHandler) {
-                    // call the verified packet callback to let it handle this packet
-                    _packetHandler(std::move(packet));
-                }
+                return;
             }
+        } else if (connection) {
+            connection->recordReceivedUnreliablePackets(packet->getWireSize(),
+                                                        packet->getPayloadSize());
         }
+
+        if (packet->isPartOfMessage()) {
+            if (connection) {
+                connection->queueReceivedMessagePacket(std::move(packet));
+            }
+        } else if (_packetHandler) {
+            // call the verified packet callback to let it handle this packet
+            _packetHandler(std::move(packet));
+        }
+    }
+}
+
+void Socket::processCoalescedPackets(const ControlPacket& coalescedPacket) {
+    std::vector<std::unique_ptr<Packet>> packets;
+    if (!splitCoalescedPackets(coalescedPacket, packets)) {
+        qCDebug(networking) << "Dropping malformed CoalescedPackets datagram from" << coalescedPacket.getSenderSockAddr();
+        return;
+    }
+
+    for (auto& packet : packets) {
+        processReceivedPacket(std::move(packet));
     }
 }
 
@@ -18,6 +18,8 @@
 #include <unordered_map>
 #include <mutex>
 #include <list>
+#include <memory>
+#include <vector>
 
 #include <QtCore/QObject>
 #include <QtCore/QTimer>
@@ -34,6 +36,7 @@ class UDTTest;
 namespace udt {
 
 class BasePacket;
+class ControlPacket;
 class Packet;
 class PacketList;
 class SequenceNumber;
@@ -66,6 +69,16 @@ public:
     qint64 writePacketList(std::unique_ptr<PacketList> packetList, const HifiSockAddr& sockAddr);
     qint64 writeDatagram(const char* data, qint64 size, const HifiSockAddr& sockAddr);
     qint64 writeDatagram(const QByteArray& datagram, const HifiSockAddr& sockAddr);
+
+    // Queues a small unreliable packet to be sent along with others for the same destination in a single
+    // CoalescedPackets datagram, on the next flush or as soon as the datagram for that destination is full
+    qint64 writeCoalescedPacket(const Packet& packet, const HifiSockAddr& sockAddr);
+
+    // Adds the packet to a CoalescedPackets datagram, false if the datagram doesn't have room for it
+    static bool coalescePacket(ControlPacket& coalescedPacket, const Packet& packet);
+    // Splits a received CoalescedPackets datagram back into the packets it carries, appending them to packets.
+    // False, with nothing appended, if the datagram is malformed.
+    static bool splitCoalescedPackets(const ControlPacket& coalescedPacket, std::vector<std::unique_ptr<Packet>>& packets);
     
     void bind(const QHostAddress& address, quint16 port = 0);
     void rebind(quint16 port);
@@ -97,6 +110,7 @@ signals:
     void clientHandshakeRequestComplete(const HifiSockAddr& sockAddr);
 
 public slots:
+    void flushCoalescedPackets();
     void cleanupConnection(HifiSockAddr sockAddr);
     void clearConnections();
     void handleRemoteAddressChange(HifiSockAddr previousAddress, HifiSockAddr currentAddress);
@@ -110,6 +124,8 @@ private slots:
 
 private:
     void setSystemBufferSizes();
+    void processReceivedPacket(std::unique_ptr<Packet> packet);
+    void processCoalescedPackets(const ControlPacket& coalescedPacket);
     Connection* findOrCreateConnection(const HifiSockAddr& sockAddr, bool filterCreation = false);
    
     // privatized methods used by UDTTest - they are private since they must be called on the Socket thread
@@ -130,12 +146,15 @@ private:
 
     Mutex _unreliableSequenceNumbersMutex;
     Mutex _connectionsHashMutex;
+    Mutex _coalescedPacketsMutex;
 
     std::unordered_map<HifiSockAddr, BasePacketHandler> _unfilteredHandlers;
     std::unordered_map<HifiSockAddr, SequenceNumber> _unreliableSequenceNumbers;
     std::unordered_map<HifiSockAddr, std::unique_ptr<Connection>> _connectionsHash;
+    std::unordered_map<HifiSockAddr, std::unique_ptr<ControlPacket>> _coalescedPackets;
 
     QTimer* _readyReadBackupTimer { nullptr };
+    QTimer* _coalescedPacketsFlushTimer { nullptr };
 
     int _maxBandwidth { -1 };
 
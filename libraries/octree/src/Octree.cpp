@@ -16,6 +16,7 @@
 #include <cmath>
 #include <fstream> // to load voxels from file
 
+#include <QBuffer>
 #include <QDataStream>
 #include <QDebug>
 #include <QEventLoop>
@@ -37,6 +38,7 @@
 
 #include <GeometryUtil.h>
 #include <Gzip.h>
+#include <GunzipDevice.h>
 #include <LogHandler.h>
 #include <NetworkAccessManager.h>
 #include <OctalCode.h>
@@ -699,16 +701,13 @@ bool Octree::readJSONFromGzippedFile(QString qFileName) {
         qCritical() << "Cannot open gzipped json file for reading: " << qFileName;
         return false;
     }
-    QByteArray compressedJsonData = file.readAll();
-    QByteArray jsonData;
 
-    if (!gunzip(compressedJsonData, jsonData)) {
+    if (!GunzipDevice::isGzipped(file.peek(2))) {
         qCritical() << "json File not in gzip format: " << qFileName;
         return false;
     }
 
-    QDataStream jsonStream(jsonData);
-    return readJSONFromStream(-1, jsonStream);
+    return readJSONFromDevice(file);
 }
 
 // hack to get the marketplace id into the entities.  We will create a way to get this from a hash of
@@ -758,12 +757,11 @@ bool Octree::readFromURL(
 
     auto data = request->getData();
 
-    QByteArray uncompressedJsonData;
-    bool wasCompressed = gunzip(data, uncompressedJsonData);
-
-    if (wasCompressed) {
-        QDataStream inputStream(uncompressedJsonData);
-        return readFromStream(uncompressedJsonData.size(), inputStream, marketplaceID);
+    // compressed content gets decompressed as it is parsed
+    if (GunzipDevice::isGzipped(data)) {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        return readJSONFromDevice(buffer, marketplaceID);
     }
 
     QDataStream inputStream(data);
@@ -812,8 +810,6 @@ QVariantMap addMarketplaceIDToDocumentEntities(QVariantMap& doc, const QString&
 }
 
 }  // Unnamed namepsace
-const int READ_JSON_BUFFER_SIZE = 2048;
-
 bool Octree::readJSONFromStream(
     uint64_t streamLength,
     QDataStream& inputStream,
@@ -821,37 +817,88 @@ bool Octree::readJSONFromStream(
 ) {
     // if the data is gzipped we may not have a useful bytesAvailable() result, so just keep reading until
     // we get an eof.  Leave streamLength parameter for consistency.
+    return readJSONFromDevice(*inputStream.device(), marketplaceID);
+}
+
+bool Octree::readJSONFromDevice(QIODevice& device, const QString& marketplaceID) {
+    // decompression happens on its own thread while the parsed entities get added
+    GunzipDevice gunzipDevice(&device);
+    QIODevice* source = &device;
+    if (GunzipDevice::isGzipped(device.peek(2))) {
+        if (!gunzipDevice.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        source = &gunzipDevice;
+    }
+
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesDevice(source);
+    auto parse = [&](QVariantMap& parsedEntities) {
+        if (!parser.parseEntities(parsedEntities)) {
+            qCritical() << "Couldn't parse Entities JSON:" << parser.getErrorString().c_str();
+            return false;
+        }
+        // a truncated file can end on a complete entity, only the decompression knows the document is incomplete
+        if (source == &gunzipDevice && gunzipDevice.hasError()) {
+            qCritical() << "Couldn't decompress Entities JSON";
+            return false;
+        }
+        return true;
+    };
 
-    QByteArray jsonBuffer;
-    char* rawData = new char[READ_JSON_BUFFER_SIZE];
-    while (!inputStream.atEnd()) {
-        int got = inputStream.readRawData(rawData, READ_JSON_BUFFER_SIZE - 1);
-        if (got < 0) {
-            qCritical() << "error while reading from json stream";
-            delete[] rawData;
+    if (!supportsStreamedRead()) {
+        QVariantMap asMap;
+        if (!parse(asMap)) {
             return false;
         }
-        if (got == 0) {
-            break;
+        if (!marketplaceID.isEmpty()) {
+            addMarketplaceIDToDocumentEntities(asMap, marketplaceID);
         }
-        jsonBuffer += QByteArray(rawData, got);
+        return readFromMap(asMap);
     }
 
-    OctreeEntitiesFileParser octreeParser;
-    octreeParser.setEntitiesString(jsonBuffer);
-    QVariantMap asMap;
-    if (!octreeParser.parseEntities(asMap)) {
-        qCritical() << "Couldn't parse Entities JSON:" << octreeParser.getErrorString().c_str();
+    // The entities can't be converted without the version of the document. toJSONString writes it before them, so
+    // they get converted as they are parsed. Documents that list it after them have their entities kept until the end.
+    bool isStreaming = false;
+    QVariantList pendingEntities;
+    parser.setEntitiesStartHandler([&](const QVariantMap& documentInfo) {
+        if (!documentInfo.contains("Version")) {
+            return true;
+        }
+        isStreaming = beginStreamedRead(documentInfo);
+        return isStreaming;
+    });
+    parser.setEntityHandler([&](QVariantMap& entityMap) {
+        if (!marketplaceID.isEmpty()) {
+            entityMap["marketplaceID"] = marketplaceID;
+        }
+        if (isStreaming) {
+            readStreamedEntity(entityMap);
+        } else {
+            pendingEntities.push_back(entityMap);
+        }
+        return true;
+    });
+
+    QVariantMap documentInfo;
+    if (!parse(documentInfo)) {
+        if (isStreaming) {
+            abortStreamedRead();
+        }
         return false;
     }
 
-    if (!marketplaceID.isEmpty()) {
-        addMarketplaceIDToDocumentEntities(asMap, marketplaceID);
+    if (!isStreaming) {
+        if (!beginStreamedRead(documentInfo)) {
+            return false;
+        }
+        for (auto& pendingEntity : pendingEntities) {
+            QVariantMap entityMap = pendingEntity.toMap();
+            readStreamedEntity(entityMap);
+        }
+        pendingEntities.clear();
     }
-
-    bool success = readFromMap(asMap);
-    delete[] rawData;
-    return success;
+    return endStreamedRead();
 }
 
 bool Octree::writeToFile(const char* fileName, const OctreeElementPointer& element, QString persistAsFileType) {
@@ -915,19 +962,27 @@ bool Octree::toJSONString(QString& jsonString, const OctreeElementPointer& eleme
         top = _rootElement;
     }
 
-    jsonString += QString("{\n  \"DataVersion\": %1,\n  \"Entities\": [").arg(_persistDataVersion);
-
-    writeToJSON(jsonString, top);
-
     // include the "bitstream" version
     PacketType expectedType = expectedDataPacketType();
     PacketVersion expectedVersion = versionForPacketType(expectedType);
 
-    jsonString += QString("\n    ],\n  \"Id\": \"%1\",\n  \"Version\": %2\n}\n").arg(_persistID.toString()).arg((int)expectedVersion);
+    jsonString += jsonDocumentStart(_persistDataVersion, _persistID, expectedVersion);
+    writeToJSON(jsonString, top);
+    jsonString += jsonDocumentEnd();
 
     return true;
 }
 
+QString Octree::jsonDocumentStart(int64_t dataVersion, const QUuid& id, PacketVersion version) {
+    // the top-level values come first, so that they can be read without going through the entities
+    return QString("{\n  \"DataVersion\": %1,\n  \"Id\": \"%2\",\n  \"Version\": %3,\n  \"Entities\": [")
+        .arg(dataVersion).arg(id.toString()).arg((int)version);
+}
+
+QString Octree::jsonDocumentEnd() {
+    return "\n    ]\n}\n";
+}
+
 bool Octree::toJSON(QByteArray* data, const OctreeElementPointer& element, bool doGzip) {
     QString jsonString;
     toJSONString(jsonString);
@@ -30,8 +30,11 @@
 #include "OctreeSceneStats.h"
 #include "OctreeUtils.h"
 
+class QIODevice;
 class ReadBitstreamToTreeParams;
 class Octree;
+class OctreePersistLog;
+class OctreePersistLogRecord;
 class OctreeElement;
 class OctreePacketData;
 class Shape;
@@ -73,6 +76,10 @@ public:
     } reason;
     reason stopReason;
 
+    // lets items reuse the bytes of their last complete encode when nothing changed since,
+    // used by the servers that send the same items to many viewers
+    bool useEncodedDataCache { false };
+
     EncodeBitstreamParams(bool includeExistsBits = WANT_EXISTS_BITS,
                           NodeData* nodeData = nullptr) :
             includeExistsBits(includeExistsBits),
@@ -122,6 +129,27 @@ public:
     {}
 };
 
+/// The part of an edit that a tree decoded and validated before taking its write lock, see
+/// Octree::prepareEditPacketData(). Each tree type derives its own.
+class PreparedOctreeEdit {
+public:
+    virtual ~PreparedOctreeEdit() {}
+};
+using PreparedOctreeEditPointer = std::unique_ptr<PreparedOctreeEdit>;
+
+/// What saving a tree needs, copied out of it under a short read lock so that the conversion doesn't keep the tree
+/// locked, see Octree::takePersistSnapshot(). Each tree type derives its own.
+class OctreePersistSnapshot {
+public:
+    virtual ~OctreePersistSnapshot() {}
+
+    /// Same document as Octree::toJSON() would have made of the tree when the snapshot was taken
+    virtual bool toJSON(QByteArray* data, bool doGzip = false) const = 0;
+    /// Same file as Octree::writeBinarySnapshot() would have written, when the snapshot was taken with one
+    virtual bool writeBinarySnapshot(const QString& filename) const { return false; }
+};
+using OctreePersistSnapshotPointer = std::shared_ptr<OctreePersistSnapshot>;
+
 class Octree : public QObject, public std::enable_shared_from_this<Octree>, public ReadWriteLockable {
     Q_OBJECT
 public:
@@ -138,6 +166,15 @@ public:
     virtual bool handlesEditPacketType(PacketType packetType) const { return false; }
     virtual int processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                       const SharedNodePointer& sourceNode) { return 0; }
+
+    // Trees can split the handling of some of their edit packet types in two: prepareEditPacketData() decodes, checks
+    // and filters one edit with the tree read locked at most and returns the number of bytes it used,
+    // applyPreparedEdit() is then called with the tree write locked, in the order the edits were prepared in.
+    // Everything else goes through processEditPacketData().
+    virtual bool preparesEditPacketType(PacketType packetType) const { return false; }
+    virtual PreparedOctreeEditPointer prepareEditPacketData(ReceivedMessage& message, const unsigned char* editData,
+            int maxLength, const SharedNodePointer& sourceNode, int& bytesRead) { bytesRead = 0; return nullptr; }
+    virtual void applyPreparedEdit(PreparedOctreeEdit& edit, const SharedNodePointer& sourceNode) { }
     virtual void processChallengeOwnershipRequestPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
     virtual void processChallengeOwnershipReplyPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
     virtual void processChallengeOwnershipPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
@@ -210,6 +247,9 @@ public:
     bool toJSON(QByteArray* data, const OctreeElementPointer& element = nullptr, bool doGzip = false);
     bool writeToFile(const char* filename, const OctreeElementPointer& element = nullptr, QString persistAsFileType = "json.gz");
     bool writeToJSONFile(const char* filename, const OctreeElementPointer& element = nullptr, bool doGzip = false);
+    // what toJSONString writes before and after the entities
+    static QString jsonDocumentStart(int64_t dataVersion, const QUuid& id, PacketVersion version);
+    static QString jsonDocumentEnd();
     virtual bool writeToMap(QVariantMap& entityDescription, OctreeElementPointer element, bool skipDefaultValues,
                             bool skipThoseWithBadParents) = 0;
     virtual bool writeToJSON(QString& jsonString, const OctreeElementPointer& element) = 0;
@@ -221,8 +261,19 @@ public:
     bool readSVOFromStream(uint64_t streamLength, QDataStream& inputStream);
     bool readJSONFromStream(uint64_t streamLength, QDataStream& inputStream, const QString& marketplaceID="");
     bool readJSONFromGzippedFile(QString qFileName);
+    bool readJSONFromDevice(QIODevice& device, const QString& marketplaceID = "");
     virtual bool readFromMap(QVariantMap& entityDescription) = 0;
 
+    // Streamed counterpart of readFromMap, used by readJSONFromDevice so that the entities never all have to be in
+    // memory: beginStreamedRead gets the top-level values of the document, readStreamedEntity then gets each entity
+    // as soon as it is parsed and endStreamedRead is called once they all were.
+    virtual bool supportsStreamedRead() const { return false; }
+    virtual bool beginStreamedRead(const QVariantMap& documentInfo) { return false; }
+    virtual bool readStreamedEntity(QVariantMap& entityMap) { return false; }
+    virtual bool endStreamedRead() { return false; }
+    // Removes what the read added so far, for documents that turn out to be invalid partway through
+    virtual void abortStreamedRead() { }
+
     uint64_t getOctreeElementsCount();
 
     bool getShouldReaverage() const { return _shouldReaverage; }
@@ -250,6 +301,8 @@ public:
         _persistID = id;
         _persistDataVersion = dataVersion;
     }
+    QUuid getPersistID() const { return _persistID; }
+    int64_t getPersistDataVersion() const { return _persistDataVersion; }
 
     virtual void resetEditStats() { }
     virtual quint64 getAverageDecodeTime() const { return 0; }
@@ -261,6 +314,23 @@ public:
 
     void incrementPersistDataVersion() { _persistDataVersion++; }
 
+    // Incremental persistence, see OctreePersistLog. Trees that support it keep track of the items that
+    // changed since the last call to writePersistChanges and can apply the records written for them.
+    virtual bool supportsPersistLog() const { return false; }
+    virtual void setTrackPersistChanges(bool trackPersistChanges) { }
+    virtual void writePersistChanges(OctreePersistLog& log) { }
+    virtual bool replayPersistLogRecord(const OctreePersistLogRecord& record) { return false; }
+
+    // Trees that return nullptr get saved with toJSON, which keeps them read locked for the whole conversion.
+    // withBinarySnapshot also encodes what writeBinarySnapshot needs, in the same read-locked pass.
+    virtual OctreePersistSnapshotPointer takePersistSnapshot(bool withBinarySnapshot = false) { return nullptr; }
+
+    // Binary snapshot of the whole tree, saved next to the persist file because it loads a lot faster.
+    // Trees that can't write one return false and always get loaded from the persist file.
+    virtual bool writeBinarySnapshot(const QString& filename) { return false; }
+    virtual bool readBinarySnapshotInfo(const QString& filename, QUuid& id, int64_t& dataVersion) const { return false; }
+    virtual bool readBinarySnapshot(const QString& filename) { return false; }
+
 
 protected:
     void deleteOctalCodeFromTreeRecursion(const OctreeElementPointer& element, void* extraData);
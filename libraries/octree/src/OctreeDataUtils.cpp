@@ -12,6 +12,7 @@
 #include "OctreeEntitiesFileParser.h"
 
 #include <Gzip.h>
+#include <GunzipDevice.h>
 #include <udt/PacketHeaders.h>
 
 #include <QDebug>
@@ -37,6 +38,7 @@ bool OctreeUtils::RawOctreeData::readOctreeDataInfoFromData(QByteArray data) {
 
     OctreeEntitiesFileParser jsonParser;
     jsonParser.setEntitiesString(data);
+    jsonParser.setSkipEntities(!readsEntities());
     QVariantMap entitiesMap;
     if (!jsonParser.parseEntities(entitiesMap)) {
         qCritical() << "Can't parse Entities JSON: " << jsonParser.getErrorString().c_str();
@@ -55,9 +57,31 @@ bool OctreeUtils::RawOctreeData::readOctreeDataInfoFromFile(QString path) {
         return false;
     }
 
-    QByteArray data = file.readAll();
+    if (readsEntities()) {
+        QByteArray data = file.readAll();
+        return readOctreeDataInfoFromData(data);
+    }
+
+    // only the top-level values are needed, so the file gets parsed as it is read and decompressed
+    GunzipDevice gunzipDevice(&file);
+    OctreeEntitiesFileParser jsonParser;
+    if (GunzipDevice::isGzipped(file.peek(2))) {
+        if (!gunzipDevice.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        jsonParser.setEntitiesDevice(&gunzipDevice);
+    } else {
+        jsonParser.setEntitiesDevice(&file);
+    }
+    jsonParser.setSkipEntities(true);
+
+    QVariantMap entitiesMap;
+    if (!jsonParser.parseEntities(entitiesMap)) {
+        qCritical() << "Can't parse Entities JSON: " << jsonParser.getErrorString().c_str();
+        return false;
+    }
 
-    return readOctreeDataInfoFromData(data);
+    return readOctreeDataInfoFromMap(entitiesMap);
 }
 
 QByteArray OctreeUtils::RawOctreeData::toByteArray() {
@@ -35,6 +35,8 @@ public:
 
     virtual void readSubclassData(const QVariantMap& root) { }
     virtual void writeSubclassData(QByteArray& root) const { }
+    // the entities are skipped over when reading unless the subclass keeps them
+    virtual bool readsEntities() const { return false; }
 
     void resetIdAndVersion();
     QByteArray toByteArray();
@@ -50,6 +52,7 @@ public:
     PacketType dataPacketType() const override;
     void readSubclassData(const QVariantMap& root) override;
     void writeSubclassData(QByteArray& root) const override;
+    bool readsEntities() const override { return true; }
 
     QVariantList variantEntityData;
 };
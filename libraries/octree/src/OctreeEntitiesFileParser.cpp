@@ -14,6 +14,7 @@
 #include <sstream>
 #include <cctype>
 
+#include <QIODevice>
 #include <QUuid>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -21,10 +22,14 @@
 
 using std::string;
 
+// how much is read from the device at a time, parsed contents are discarded once there is more than this
+const int READ_BLOCK_SIZE = 256 * 1024;
+const int MAX_INTEGER_LENGTH = 32;
+
 std::string OctreeEntitiesFileParser::getErrorString() const {
     std::ostringstream err;
     if (_errorString.size() != 0) {
-        err << "Error: Line " << _line << ", byte position " << _position << ": " << _errorString;
+        err << "Error: Line " << _line << ", byte position " << _discardedLength + _position << ": " << _errorString;
     };
 
     return err.str();
@@ -33,8 +38,43 @@ std::string OctreeEntitiesFileParser::getErrorString() const {
 void OctreeEntitiesFileParser::setEntitiesString(const QByteArray& entitiesContents) {
     _entitiesContents = entitiesContents;
     _entitiesLength = _entitiesContents.length();
+    _device = nullptr;
     _position = 0;
     _line = 1;
+    _discardedLength = 0;
+}
+
+void OctreeEntitiesFileParser::setEntitiesDevice(QIODevice* device) {
+    _entitiesContents.clear();
+    _entitiesLength = 0;
+    _device = device;
+    _position = 0;
+    _line = 1;
+    _discardedLength = 0;
+}
+
+// Makes sure the byte at index has been read, returns false if the document ends before it.
+bool OctreeEntitiesFileParser::fill(int index) {
+    while (index >= _entitiesLength && _device) {
+        QByteArray block = _device->read(READ_BLOCK_SIZE);
+        if (block.isEmpty()) {
+            _device = nullptr;
+            break;
+        }
+        _entitiesContents.append(block);
+        _entitiesLength = _entitiesContents.length();
+    }
+    return index < _entitiesLength;
+}
+
+// Forgets the contents before the current position, they won't be looked at again.
+void OctreeEntitiesFileParser::discardParsedContents() {
+    if (_device && _position > READ_BLOCK_SIZE) {
+        _entitiesContents.remove(0, _position);
+        _entitiesLength = _entitiesContents.length();
+        _discardedLength += _position;
+        _position = 0;
+    }
 }
 
 bool OctreeEntitiesFileParser::parseEntities(QVariantMap& parsedEntities) {
@@ -80,6 +120,13 @@ bool OctreeEntitiesFileParser::parseEntities(QVariantMap& parsedEntities) {
             parsedEntities["DataVersion"] = dataVersionValue;
             gotDataVersion = true;
         } else if (key == "Entities") {
+            if (_stopAtEntities) {
+                return true;
+            }
+            if (_entitiesStartHandler && !_entitiesStartHandler(parsedEntities)) {
+                _errorString = "Entities start handler stopped the parsing";
+                return false;
+            }
             if (gotEntities) {
                 _errorString = "Duplicate Entities entries";
                 return false;
@@ -90,7 +137,9 @@ bool OctreeEntitiesFileParser::parseEntities(QVariantMap& parsedEntities) {
                 return false;
             }
 
-            parsedEntities["Entities"] = std::move(entitiesValue);
+            if (!_skipEntities && !_entityHandler) {
+                parsedEntities["Entities"] = std::move(entitiesValue);
+            }
             gotEntities = true;
         } else if (key == "Id") {
             if (gotId) {
@@ -173,7 +222,7 @@ bool OctreeEntitiesFileParser::parseEntities(QVariantMap& parsedEntities) {
 }
 
 int OctreeEntitiesFileParser::nextToken() {
-    while (_position < _entitiesLength) {
+    while (fill(_position)) {
         char c = _entitiesContents[_position++];
         if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
             return c;
@@ -188,7 +237,7 @@ int OctreeEntitiesFileParser::nextToken() {
 
 string OctreeEntitiesFileParser::readString() {
     string returnString;
-    while (_position < _entitiesLength) {
+    while (fill(_position)) {
         char c = _entitiesContents[_position++];
         if (c == '"') {
             break;
@@ -201,6 +250,7 @@ string OctreeEntitiesFileParser::readString() {
 }
 
 int OctreeEntitiesFileParser::readInteger() {
+    fill(_position + MAX_INTEGER_LENGTH);
     const char* currentPosition = _entitiesContents.constData() + _position;
     int i = std::atoi(currentPosition);
 
@@ -220,6 +270,7 @@ bool OctreeEntitiesFileParser::readEntitiesArray(QVariantList& entitiesArray) {
     }
 
     while (true) {
+        discardParsedContents();
         if (nextToken() != '{') {
             _errorString = "Entity array item is not an object";
             return false;
@@ -230,14 +281,25 @@ bool OctreeEntitiesFileParser::readEntitiesArray(QVariantList& entitiesArray) {
             return false;
         }
 
-        QByteArray jsonEntity = _entitiesContents.mid(_position - 1, matchingBrace - _position + 1);
-        QJsonDocument entity = QJsonDocument::fromJson(jsonEntity);
-        if (entity.isNull()) {
-            _errorString = "Ill-formed entity";
-            return false;
-        }
+        if (!_skipEntities) {
+            QByteArray jsonEntity = QByteArray::fromRawData(_entitiesContents.constData() + _position - 1,
+                                                            matchingBrace - _position + 1);
+            QJsonDocument entity = QJsonDocument::fromJson(jsonEntity);
+            if (entity.isNull()) {
+                _errorString = "Ill-formed entity";
+                return false;
+            }
 
-        entitiesArray.append(entity.object());
+            if (_entityHandler) {
+                QVariantMap entityMap = entity.object().toVariantMap();
+                if (!_entityHandler(entityMap)) {
+                    _errorString = "Entity handler stopped the parsing";
+                    return false;
+                }
+            } else {
+                entitiesArray.append(entity.object());
+            }
+        }
         _position = matchingBrace;
         char c = nextToken();
         if (c == ']') {
@@ -250,10 +312,10 @@ bool OctreeEntitiesFileParser::readEntitiesArray(QVariantList& entitiesArray) {
     return true;
 }
 
-int OctreeEntitiesFileParser::findMatchingBrace() const {
+int OctreeEntitiesFileParser::findMatchingBrace() {
     int index = _position;
     int nestCount = 1;
-    while (index < _entitiesLength && nestCount != 0) {
+    while (nestCount != 0 && fill(index)) {
         switch (_entitiesContents[index++]) {
         case '{':
             ++nestCount;
@@ -265,11 +327,11 @@ int OctreeEntitiesFileParser::findMatchingBrace() const {
 
         case '"':
             // Skip string
-            while (index < _entitiesLength) {
+            while (fill(index)) {
                 if (_entitiesContents[index] == '"') {
                     ++index;
                     break;
-                } else if (_entitiesContents[index] == '\\' && _entitiesContents[++index] == 'u') {
+                } else if (_entitiesContents[index] == '\\' && fill(index + 1) && _entitiesContents[++index] == 'u') {
                     index += 4;
                 }
                 ++index;
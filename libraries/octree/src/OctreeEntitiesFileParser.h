@@ -14,26 +14,54 @@
 #ifndef hifi_OctreeEntitiesFileParser_h
 #define hifi_OctreeEntitiesFileParser_h
 
+#include <functional>
+
 #include <QByteArray>
 #include <QVariant>
 
+class QIODevice;
+
 class OctreeEntitiesFileParser {
 public:
+    // returning false stops the parsing
+    using EntityHandler = std::function<bool(QVariantMap& entity)>;
+    using DocumentInfoHandler = std::function<bool(const QVariantMap& documentInfo)>;
+
     void setEntitiesString(const QByteArray& entitiesContents);
+    // The document is read from the device as the parsing goes, only the part of it being parsed stays in memory.
+    void setEntitiesDevice(QIODevice* device);
+
+    // Each entity is handed to the handler as soon as it is parsed instead of being added to the Entities list.
+    void setEntityHandler(EntityHandler entityHandler) { _entityHandler = entityHandler; }
+    // Only the top-level values get parsed, the entities are skipped over.
+    void setSkipEntities(bool skipEntities) { _skipEntities = skipEntities; }
+    // The parsing stops at the entities, only the top-level values listed before them get parsed.
+    void setStopAtEntities(bool stopAtEntities) { _stopAtEntities = stopAtEntities; }
+    // Gets the top-level values listed before the entities once they start, returning false stops the parsing.
+    void setEntitiesStartHandler(DocumentInfoHandler entitiesStartHandler) { _entitiesStartHandler = entitiesStartHandler; }
+
     bool parseEntities(QVariantMap& parsedEntities);
     std::string getErrorString() const;
 
 private:
+    bool fill(int index);
+    void discardParsedContents();
     int nextToken();
     std::string readString();
     int readInteger();
     bool readEntitiesArray(QVariantList& entitiesArray);
-    int findMatchingBrace() const;
+    int findMatchingBrace();
 
     QByteArray _entitiesContents;
+    QIODevice* _device { nullptr };
     int _position { 0 };
     int _line { 1 };
     int _entitiesLength { 0 };
+    qint64 _discardedLength { 0 };
+    EntityHandler _entityHandler;
+    DocumentInfoHandler _entitiesStartHandler;
+    bool _skipEntities { false };
+    bool _stopAtEntities { false };
     std::string _errorString;
 };
 
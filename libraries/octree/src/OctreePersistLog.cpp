@@ -0,0 +1,216 @@
+//
+//  OctreePersistLog.cpp
+//  libraries/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreePersistLog.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+
+#include "OctreeLogging.h"
+
+static const QByteArray SEGMENT_MAGIC { "HFOL" };
+static const quint32 SEGMENT_VERSION = 1;
+static const int SEGMENT_HEADER_SIZE = 8; // magic + version
+
+// size (quint32) and checksum (quint16) of the record body, which is the type, the id and the data
+static const int RECORD_HEADER_SIZE = sizeof(quint32) + sizeof(quint16);
+static const int RECORD_ID_SIZE = 16;
+static const quint32 MAX_RECORD_BODY_SIZE = 64 * 1024 * 1024;
+
+static const QString SEGMENT_INFIX { ".log." };
+
+OctreePersistLog::OctreePersistLog(const QString& persistFilename) :
+    _persistFilename(persistFilename)
+{
+}
+
+OctreePersistLog::~OctreePersistLog() {
+    flush();
+}
+
+QString OctreePersistLog::getSegmentFilename(int sequence) const {
+    return _persistFilename + SEGMENT_INFIX + QString::number(sequence);
+}
+
+QVector<int> OctreePersistLog::findSegments() const {
+    QFileInfo persistFile { _persistFilename };
+    QString prefix = persistFile.fileName() + SEGMENT_INFIX;
+
+    QVector<int> sequences;
+    QDir directory { persistFile.absolutePath() };
+    for (const auto& entry : directory.entryList({ prefix + "*" }, QDir::Files)) {
+        bool ok = false;
+        int sequence = entry.mid(prefix.length()).toInt(&ok);
+        if (ok) {
+            sequences.push_back(sequence);
+        }
+    }
+    std::sort(sequences.begin(), sequences.end());
+    return sequences;
+}
+
+QByteArray OctreePersistLog::encodeRecord(const OctreePersistLogRecord& record) {
+    QByteArray body;
+    body.reserve(1 + RECORD_ID_SIZE + record.data.size());
+    body.append((char)record.type);
+    body.append(record.id.toRfc4122());
+    body.append(record.data);
+
+    QByteArray encoded;
+    QDataStream stream(&encoded, QIODevice::WriteOnly);
+    stream << (quint32)body.size() << qChecksum(body.constData(), body.size());
+    encoded.append(body);
+    return encoded;
+}
+
+int OctreePersistLog::decodeRecord(const QByteArray& data, int offset, OctreePersistLogRecord& record) {
+    if (data.size() - offset < RECORD_HEADER_SIZE) {
+        return 0;
+    }
+
+    quint32 bodySize;
+    quint16 checksum;
+    QDataStream stream(QByteArray::fromRawData(data.constData() + offset, RECORD_HEADER_SIZE));
+    stream >> bodySize >> checksum;
+
+    if (bodySize < (quint32)(1 + RECORD_ID_SIZE) || bodySize > MAX_RECORD_BODY_SIZE ||
+        (qint64)data.size() - offset - RECORD_HEADER_SIZE < (qint64)bodySize) {
+        return 0;
+    }
+
+    const char* body = data.constData() + offset + RECORD_HEADER_SIZE;
+    if (qChecksum(body, bodySize) != checksum) {
+        return 0;
+    }
+
+    quint8 type = (quint8)body[0];
+    if (type != OctreePersistLogRecord::Upsert && type != OctreePersistLogRecord::Delete) {
+        return 0;
+    }
+    record.type = (OctreePersistLogRecord::Type)type;
+    record.id = QUuid::fromRfc4122(QByteArray::fromRawData(body + 1, RECORD_ID_SIZE));
+    record.data = QByteArray(body + 1 + RECORD_ID_SIZE, bodySize - 1 - RECORD_ID_SIZE);
+    return RECORD_HEADER_SIZE + bodySize;
+}
+
+int OctreePersistLog::replay(const RecordHandler& handler) {
+    int numRecords = 0;
+    _size = 0;
+    for (int sequence : findSegments()) {
+        QFile segment { getSegmentFilename(sequence) };
+        if (!segment.open(QIODevice::ReadOnly)) {
+            qCWarning(octree) << "Could not open octree log segment" << segment.fileName() << segment.errorString();
+            continue;
+        }
+        QByteArray data = segment.readAll();
+        segment.close();
+
+        if (data.size() < SEGMENT_HEADER_SIZE || !data.startsWith(SEGMENT_MAGIC)) {
+            qCWarning(octree) << "Skipping invalid octree log segment" << segment.fileName();
+            continue;
+        }
+
+        int offset = SEGMENT_HEADER_SIZE;
+        OctreePersistLogRecord record;
+        while (offset < data.size()) {
+            int recordSize = decodeRecord(data, offset, record);
+            if (recordSize == 0) {
+                qCWarning(octree) << "Octree log segment" << segment.fileName() << "ends with an incomplete record at"
+                    << offset << "of" << data.size() << "bytes, ignoring the rest of it";
+                break;
+            }
+            handler(record);
+            offset += recordSize;
+            ++numRecords;
+        }
+        _size += offset - SEGMENT_HEADER_SIZE;
+    }
+    return numRecords;
+}
+
+bool OctreePersistLog::open() {
+    flush();
+    if (_file) {
+        _file->close();
+    }
+
+    auto segments = findSegments();
+    _sequence = std::max(segments.empty() ? 0 : segments.back(), _sequence) + 1;
+
+    _file.reset(new QFile(getSegmentFilename(_sequence)));
+    if (!_file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(octree) << "Could not create octree log segment" << _file->fileName() << _file->errorString();
+        return false;
+    }
+
+    QByteArray header = SEGMENT_MAGIC;
+    QDataStream stream(&header, QIODevice::WriteOnly | QIODevice::Append);
+    stream << SEGMENT_VERSION;
+    _file->write(header);
+    _file->flush();
+    return true;
+}
+
+void OctreePersistLog::append(const OctreePersistLogRecord& record) {
+    _pendingRecords.append(encodeRecord(record));
+    ++_numRecordsWritten;
+}
+
+bool OctreePersistLog::flush() {
+    if (_pendingRecords.isEmpty()) {
+        return true;
+    }
+    if (!isOpen()) {
+        return false;
+    }
+
+    qint64 written = _file->write(_pendingRecords);
+    bool success = written == _pendingRecords.size() && _file->flush();
+    if (!success) {
+        qCWarning(octree) << "Failed to append to octree log segment" << _file->fileName() << _file->errorString();
+    }
+    _size += std::max(written, (qint64)0);
+    _pendingRecords.clear();
+    return success;
+}
+
+int OctreePersistLog::rotate() {
+    int closedSequence = _sequence;
+    open();
+    return closedSequence;
+}
+
+void OctreePersistLog::removeSegmentsUpTo(int sequence) {
+    qint64 size = 0;
+    for (int segmentSequence : findSegments()) {
+        QFile segment { getSegmentFilename(segmentSequence) };
+        if (segmentSequence <= sequence) {
+            if (!segment.remove()) {
+                qCWarning(octree) << "Could not remove octree log segment" << segment.fileName() << segment.errorString();
+            }
+        } else {
+            size += std::max(segment.size() - SEGMENT_HEADER_SIZE, (qint64)0);
+        }
+    }
+    _size = size;
+}
+
+void OctreePersistLog::removeAllSegments() {
+    if (_file) {
+        _file->close();
+        _file.reset();
+    }
+    _pendingRecords.clear();
+    removeSegmentsUpTo(std::numeric_limits<int>::max());
+}
@@ -0,0 +1,87 @@
+//
+//  OctreePersistLog.h
+//  libraries/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Append-only log of octree item changes, written between full saves of the tree
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreePersistLog_h
+#define hifi_OctreePersistLog_h
+
+#include <functional>
+#include <memory>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <QtCore/QUuid>
+#include <QtCore/QVector>
+
+class OctreePersistLogRecord {
+public:
+    enum Type : quint8 {
+        Upsert = 1, // data holds the complete state of the item
+        Delete = 2
+    };
+
+    Type type { Upsert };
+    QUuid id;
+    QByteArray data;
+};
+
+/// The log is split in numbered segment files next to the persist file (<persist file>.log.<sequence>).
+/// Records are only ever appended to the newest segment; when the tree gets saved in full the segments
+/// written before the save started are removed. Loading replays every remaining segment, in order, on
+/// top of the last full save. A record that was only partially written (crash, full disk) ends its segment.
+class OctreePersistLog {
+public:
+    using RecordHandler = std::function<void(const OctreePersistLogRecord& record)>;
+
+    OctreePersistLog(const QString& persistFilename);
+    ~OctreePersistLog();
+
+    /// Reads every existing segment in order, oldest first, returns the number of records read
+    int replay(const RecordHandler& handler);
+
+    /// Starts a new segment that the following records get appended to
+    bool open();
+    bool isOpen() const { return _file && _file->isOpen(); }
+
+    /// Buffers a record, it gets written to the current segment on the next flush()
+    void append(const OctreePersistLogRecord& record);
+    bool flush();
+
+    /// Closes the current segment and opens a new one, returns the sequence number of the closed segment
+    int rotate();
+
+    /// Removes the segments up to (and including) the given sequence number, they are covered by a full save
+    void removeSegmentsUpTo(int sequence);
+    void removeAllSegments();
+
+    /// Total size of the segments that would get replayed, including the pending records
+    qint64 getSize() const { return _size + _pendingRecords.size(); }
+    bool isEmpty() const { return getSize() == 0; }
+    int getNumRecordsWritten() const { return _numRecordsWritten; }
+
+    static QByteArray encodeRecord(const OctreePersistLogRecord& record);
+    /// Decodes the record at the start of data, returns the number of bytes it used or 0 if it is incomplete or corrupted
+    static int decodeRecord(const QByteArray& data, int offset, OctreePersistLogRecord& record);
+
+private:
+    QString getSegmentFilename(int sequence) const;
+    QVector<int> findSegments() const;
+
+    QString _persistFilename;
+    std::unique_ptr<QFile> _file;
+    int _sequence { 0 };
+    qint64 _size { 0 };
+    QByteArray _pendingRecords;
+    int _numRecordsWritten { 0 };
+};
+
+#endif // hifi_OctreePersistLog_h
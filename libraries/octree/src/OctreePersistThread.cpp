@@ -23,32 +23,45 @@
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QRegExp>
+#include <QSaveFile>
 
 #include <NumericalConstants.h>
 #include <PerfStat.h>
 #include <PathUtils.h>
+#include <GunzipDevice.h>
 #include <Gzip.h>
 
+#include "OctreeEntitiesFileParser.h"
 #include "OctreeLogging.h"
 #include "OctreeUtils.h"
 #include "OctreeDataUtils.h"
 
 constexpr std::chrono::seconds OctreePersistThread::DEFAULT_PERSIST_INTERVAL { 30 };
+constexpr std::chrono::seconds OctreePersistThread::DEFAULT_COMPACTION_INTERVAL { 10 * 60 };
 constexpr std::chrono::milliseconds TIME_BETWEEN_PROCESSING { 10 };
 
+// compact sooner than the compaction interval once the log is this large, it all gets replayed at startup
+constexpr qint64 MAX_PERSIST_LOG_SIZE_BYTES { 64 * 1000 * 1000 };
+
+static const QString BINARY_SNAPSHOT_SUFFIX { ".snapshot" };
+
 constexpr int MAX_OCTREE_REPLACEMENT_BACKUP_FILES_COUNT { 20 };
 constexpr int64_t MAX_OCTREE_REPLACEMENT_BACKUP_FILES_SIZE_BYTES { 50 * 1000 * 1000 };
 
 OctreePersistThread::OctreePersistThread(OctreePointer tree, const QString& filename, std::chrono::milliseconds persistInterval,
-                                         bool debugTimestampNow, QString persistAsFileType) :
+                                         std::chrono::milliseconds compactionInterval, bool debugTimestampNow,
+                                         QString persistAsFileType) :
     _tree(tree),
     _filename(filename),
     _persistInterval(persistInterval),
     _lastPersistCheck(std::chrono::steady_clock::now()),
+    _compactionInterval(compactionInterval),
+    _lastCompaction(std::chrono::steady_clock::now()),
     _initialLoadComplete(false),
     _loadTimeUSecs(0),
     _debugTimestampNow(debugTimestampNow),
@@ -58,6 +71,17 @@ OctreePersistThread::OctreePersistThread(OctreePointer tree, const QString& file
     // in case the persist filename has an extension that doesn't match the file type
     QString sansExt = fileNameWithoutExtension(_filename, PERSIST_EXTENSIONS);
     _filename = sansExt + "." + _persistAsFileType;
+
+    if (_tree->supportsPersistLog()) {
+        _persistLog.reset(new OctreePersistLog(_filename));
+    }
+    _snapshotFilename = _filename + BINARY_SNAPSHOT_SUFFIX;
+}
+
+OctreePersistThread::~OctreePersistThread() {
+    if (_compactionThread.joinable()) {
+        _compactionThread.join();
+    }
 }
 
 void OctreePersistThread::start() {
@@ -71,30 +95,44 @@ void OctreePersistThread::start() {
 
     auto packet = NLPacket::create(PacketType::OctreeDataFileRequest, -1, true, false);
 
-    OctreeUtils::RawOctreeData data;
-    qCDebug(octree) << "Reading octree data from" << _filename;
-    QFile file(_filename);
-    if (file.open(QIODevice::ReadOnly)) {
-        QByteArray jsonData(file.readAll());
-        file.close();
-        if (!gunzip(jsonData, _cachedJSONData)) {
-            _cachedJSONData = jsonData;
-        }
+    // both files are written from the same snapshot of the tree and get its data version, the binary snapshot
+    // is only loaded while it isn't older than the persist file, which could have been replaced since
+    _loadFromBinarySnapshot = QFile::exists(_snapshotFilename) &&
+        _tree->readBinarySnapshotInfo(_snapshotFilename, _snapshotID, _snapshotDataVersion) && !_snapshotID.isNull();
+    if (_loadFromBinarySnapshot && QFile::exists(_filename)) {
+        QUuid persistFileID;
+        int64_t persistFileDataVersion;
+        _loadFromBinarySnapshot = readPersistFileHead(persistFileID, persistFileDataVersion) &&
+            persistFileID == _snapshotID && _snapshotDataVersion >= persistFileDataVersion;
+    }
 
-        if (data.readOctreeDataInfoFromData(_cachedJSONData)) {
+    if (_loadFromBinarySnapshot) {
+        qCDebug(octree) << "Current octree data from" << _snapshotFilename << ": ID(" << _snapshotID << ") DataVersion("
+            << _snapshotDataVersion << ")";
+        packet->writePrimitive(true);
+        packet->write(_snapshotID.toRfc4122());
+        packet->writePrimitive(_snapshotDataVersion);
+    } else {
+        // the entities are only read once the DS says the file is current, straight from the file into the tree
+        OctreeUtils::RawOctreeData data;
+        qCDebug(octree) << "Reading octree data from" << _filename;
+        _hasPersistFileInfo = false;
+        if (!QFile::exists(_filename)) {
+            qCWarning(octree) << "Couldn't access file" << _filename;
+            packet->writePrimitive(false);
+        } else if (readPersistFileHead(data.id, data.dataVersion) || data.readOctreeDataInfoFromFile(_filename)) {
             qCDebug(octree) << "Current octree data: ID(" << data.id << ") DataVersion(" << data.dataVersion << ")";
+            _hasPersistFileInfo = true;
+            _persistFileID = data.id;
+            _persistFileDataVersion = data.dataVersion;
             packet->writePrimitive(true);
             auto id = data.id.toRfc4122();
             packet->write(id);
             packet->writePrimitive(data.dataVersion);
         } else {
-            _cachedJSONData.clear();
             qCWarning(octree) << "No octree data found";
             packet->writePrimitive(false);
         }
-    } else {
-        qCWarning(octree) << "Couldn't access file" << _filename << file.errorString();
-        packet->writePrimitive(false);
     }
 
     qCDebug(octree) << "Sending OctreeDataFileRequest to DS";
@@ -112,31 +150,38 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
     QByteArray replacementData;
     OctreeUtils::RawOctreeData data;
     bool hasValidOctreeData { false };
+    bool hasNewID { false };
     if (includesNewData) {
-        _cachedJSONData.clear();
+        _hasPersistFileInfo = false;
+        if (_persistLog) {
+            // the changes in the log were made on top of the data being replaced
+            _persistLog->removeAllSegments();
+        }
+        if (_loadFromBinarySnapshot || QFile::exists(_snapshotFilename)) {
+            _loadFromBinarySnapshot = false;
+            QFile::remove(_snapshotFilename);
+        }
         replacementData = message->readAll();
         replaceData(replacementData);
         hasValidOctreeData = data.readOctreeDataInfoFromFile(_filename);
         qDebug() << "Got OctreeDataFileReply, new data sent";
+    } else if (_loadFromBinarySnapshot) {
+        qDebug() << "Got OctreeDataFileReply, current entity data is sufficient";
+        data.id = _snapshotID;
+        data.dataVersion = _snapshotDataVersion;
+        hasValidOctreeData = true;
     } else {
         qDebug() << "Got OctreeDataFileReply, current entity data is sufficient";
-        
-        OctreeUtils::RawEntityData data;
-        qCDebug(octree) << "Reading octree data from" << _filename;
-        if (data.readOctreeDataInfoFromData(_cachedJSONData)) {
+
+        if (_hasPersistFileInfo) {
             hasValidOctreeData = true;
+            data.id = _persistFileID;
+            data.dataVersion = _persistFileDataVersion;
             if (data.id.isNull()) {
+                // the file gets saved with its new ID once it's loaded
                 qCDebug(octree) << "Current octree data has a null id, updating";
                 data.resetIdAndVersion();
-
-                QFile file(_filename);
-                if (file.open(QIODevice::WriteOnly)) {
-                    auto entityData = data.toGzippedByteArray();
-                    file.write(entityData);
-                    file.close();
-                } else {
-                    qCDebug(octree) << "Failed to update octree data";
-                }
+                hasNewID = true;
             }
         }
     }
@@ -149,20 +194,42 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
     }
 
     bool persistentFileRead;
-
-    _tree->withWriteLock([&] {
+    int numReplayedRecords = 0;
+
+    // both formats get converted before the tree gets locked, only adding the entities write locks it
+    if (_loadFromBinarySnapshot) {
+        PerformanceWarning warn(true, "Loading Octree Binary Snapshot", true);
+        persistentFileRead = _tree->readBinarySnapshot(_snapshotFilename);
+        if (!persistentFileRead) {
+            qCWarning(octree) << "Could not load" << _snapshotFilename << "- loading" << _filename << "instead";
+            _loadFromBinarySnapshot = false;
+        }
+    }
+    if (!_loadFromBinarySnapshot) {
+        // the file is decompressed and parsed as it is read, and its entities are added as they are parsed
         PerformanceWarning warn(true, "Loading Octree File", true);
+        persistentFileRead = _tree->readFromFile(_filename.toLocal8Bit().constData());
+    }
 
-        if (_cachedJSONData.isEmpty()) {
-            persistentFileRead = _tree->readFromFile(_filename.toLocal8Bit().constData());
-        } else {
-            QDataStream jsonStream(_cachedJSONData);
-            persistentFileRead = _tree->readFromStream(-1, jsonStream);
+    _tree->withWriteLock([&] {
+        if (_persistLog) {
+            // the log holds the changes made since the last time the whole tree was saved
+            numReplayedRecords = _persistLog->replay([&](const OctreePersistLogRecord& record) {
+                _tree->replayPersistLogRecord(record);
+            });
         }
+
         _tree->pruneTree();
     });
 
-    _cachedJSONData.clear();
+    if (_persistLog) {
+        if (numReplayedRecords > 0) {
+            qCDebug(octree) << "Replayed" << numReplayedRecords << "octree log records," << _persistLog->getSize() << "bytes";
+        }
+        _persistLog->open();
+        _tree->setTrackPersistChanges(true);
+    }
+
     quint64 loadDone = usecTimestampNow();
     _loadTimeUSecs = loadDone - loadStarted;
 
@@ -190,8 +257,12 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
 
     // Since we just loaded the persistent file, we can consider ourselves as having just persisted
     _lastPersistCheck = std::chrono::steady_clock::now();
+    _lastCompaction = _lastPersistCheck;
 
-    if (replacementData.isNull()) {
+    if (numReplayedRecords > 0 || (hasNewID && persistentFileRead)) {
+        // fold the replayed changes or the new ID into the persist file right away, this also sends the result to the DS
+        compact(false);
+    } else if (replacementData.isNull()) {
         sendLatestEntityDataToDS();
     }
 
@@ -245,6 +316,10 @@ void OctreePersistThread::process() {
     _tree->preUpdate();
     _tree->update();
 
+    if (_compactionDone) {
+        finishCompaction();
+    }
+
     auto now = std::chrono::steady_clock::now();
     auto timeSinceLastPersist = now - _lastPersistCheck;
 
@@ -258,7 +333,16 @@ void OctreePersistThread::process() {
 
 void OctreePersistThread::aboutToFinish() {
     qCDebug(octree) << "Persist thread about to finish...";
+    if (_isCompacting) {
+        finishCompaction();
+    }
     persist();
+    if (_isCompacting) {
+        finishCompaction();
+    } else if (_initialLoadComplete && _persistLog && !_persistLog->isEmpty()) {
+        // leave a complete persist file behind, it is also what the DS keeps as the latest entity data
+        compact(false);
+    }
     qCDebug(octree) << "Persist thread done with about to finish...";
 }
 
@@ -302,35 +386,155 @@ void OctreePersistThread::cleanupOldReplacementBackups() {
 }
 
 void OctreePersistThread::persist() {
-    if (_tree->isDirty() && _initialLoadComplete) {
+    if (!_initialLoadComplete) {
+        return;
+    }
+
+    if (_persistLog) {
+        // appending what changed since last time costs as much as the edits, not as much as the whole tree
+        _tree->writePersistChanges(*_persistLog);
+        _persistLog->flush();
 
-        _tree->withWriteLock([&] {
-            qCDebug(octree) << "pruning Octree before saving...";
-            _tree->pruneTree();
-            qCDebug(octree) << "DONE pruning Octree before saving...";
-        });
+        auto timeSinceLastCompaction = std::chrono::steady_clock::now() - _lastCompaction;
+        if (!_isCompacting && !_persistLog->isEmpty() &&
+            (_persistLog->getSize() > MAX_PERSIST_LOG_SIZE_BYTES || timeSinceLastCompaction > _compactionInterval)) {
+            compact(true);
+        }
+    } else if (_tree->isDirty() && !_isCompacting) {
+        compact(false);
+    }
+}
 
-        _tree->incrementPersistDataVersion();
+void OctreePersistThread::compact(bool inBackground) {
+    _tree->withWriteLock([&] {
+        qCDebug(octree) << "pruning Octree before saving...";
+        _tree->pruneTree();
+        qCDebug(octree) << "DONE pruning Octree before saving...";
+    });
 
+    _tree->incrementPersistDataVersion();
+
+    // the save starts after every change written so far, new changes go to the next log segment
+    int compactedSegment = _persistLog ? _persistLog->rotate() : 0;
+
+    _isCompacting = true;
+    _compactionDone = false;
+
+    // the tree is only read locked while it is copied, converting the copy happens off the tree entirely
+    auto snapshot = _tree->takePersistSnapshot(true);
+
+    auto saveTree = [this, compactedSegment, snapshot] {
         qCDebug(octree) << "Saving Octree data to:" << _filename;
-        if (_tree->writeToFile(_filename.toLocal8Bit().constData(), nullptr, _persistAsFileType)) {
-            _tree->clearDirtyBit(); // tree is clean after saving
-            qCDebug(octree) << "DONE persisting Octree data to" << _filename;
-        } else {
-            qCWarning(octree) << "Failed to persist Octree data to" << _filename;
+        QByteArray gzippedData;
+        bool converted = snapshot ? snapshot->toJSON(&gzippedData, true) : _tree->toJSON(&gzippedData, nullptr, true);
+        _compactionSucceeded = converted && writePersistFile(gzippedData);
+        // both files hold the same data version, so the snapshot is preferred at startup until the persist file changes
+        if (_compactionSucceeded) {
+            bool wroteSnapshot = snapshot ? snapshot->writeBinarySnapshot(_snapshotFilename) :
+                _tree->writeBinarySnapshot(_snapshotFilename);
+            if (!wroteSnapshot) {
+                QFile::remove(_snapshotFilename);
+            }
         }
+        _compactedSegment = compactedSegment;
+        _compactedData = gzippedData;
+        _compactionDone = true;
+    };
 
-        sendLatestEntityDataToDS();
+    if (inBackground) {
+        _compactionThread = std::thread(saveTree);
+    } else {
+        saveTree();
+        finishCompaction();
+    }
+}
+
+void OctreePersistThread::finishCompaction() {
+    if (_compactionThread.joinable()) {
+        _compactionThread.join();
+    }
+    _isCompacting = false;
+    _compactionDone = false;
+    _lastCompaction = std::chrono::steady_clock::now();
+
+    if (_compactionSucceeded) {
+        if (_persistLog) {
+            _persistLog->removeSegmentsUpTo(_compactedSegment);
+        }
+        _tree->clearDirtyBit(); // tree is clean after saving
+        qCDebug(octree) << "DONE persisting Octree data to" << _filename;
+
+        sendLatestEntityDataToDS(_compactedData);
+    } else {
+        // the log segments stay around, so nothing is lost until the next try
+        qCWarning(octree) << "Failed to persist Octree data to" << _filename;
+    }
+    _compactedData.clear();
+}
+
+bool OctreePersistThread::writePersistFile(const QByteArray& gzippedData) {
+    QByteArray fileData;
+    if (_persistAsFileType == "json.gz") {
+        fileData = gzippedData;
+    } else if (_persistAsFileType != "json" || !gunzip(gzippedData, fileData)) {
+        qCDebug(octree) << "unable to write octree to file of type" << _persistAsFileType;
+        return false;
+    }
+
+    // the previous file is only replaced once the new one is complete
+    QSaveFile file(_filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
     }
+    file.write(fileData);
+    return file.commit();
 }
 
-void OctreePersistThread::sendLatestEntityDataToDS() {
+// Reads the ID and data version from the start of the persist file, without going through its entities. False if the
+// document doesn't list them before its entities, like the ones that weren't written by this thread: reading them from
+// those takes RawOctreeData::readOctreeDataInfoFromFile, which skips over the entities.
+bool OctreePersistThread::readPersistFileHead(QUuid& id, int64_t& dataVersion) const {
+    QFile file(_filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    GunzipDevice gunzipDevice(&file);
+    OctreeEntitiesFileParser parser;
+    parser.setStopAtEntities(true);
+    if (GunzipDevice::isGzipped(file.peek(2))) {
+        if (!gunzipDevice.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        parser.setEntitiesDevice(&gunzipDevice);
+    } else {
+        parser.setEntitiesDevice(&file);
+    }
+
+    QVariantMap documentInfo;
+    if (!parser.parseEntities(documentInfo) || !documentInfo.contains("Id") || !documentInfo.contains("DataVersion")) {
+        return false;
+    }
+    id = documentInfo["Id"].toUuid();
+    dataVersion = documentInfo["DataVersion"].toLongLong();
+    return true;
+}
+
+void OctreePersistThread::sendLatestEntityDataToDS(QByteArray data) {
     qDebug() << "Sending latest entity data to DS";
     auto nodeList = DependencyManager::get<NodeList>();
     const DomainHandler& domainHandler = nodeList->getDomainHandler();
 
-    QByteArray data;
-    if (_tree->toJSON(&data, nullptr, true)) {
+    // callers that just saved the tree pass the gzipped data along instead of having it converted again
+    if (data.isEmpty()) {
+        auto snapshot = _tree->takePersistSnapshot();
+        if (snapshot) {
+            snapshot->toJSON(&data, true);
+        } else {
+            _tree->toJSON(&data, nullptr, true);
+        }
+    }
+    if (!data.isEmpty()) {
         auto message = NLPacketList::create(PacketType::OctreeDataPersist, QByteArray(), true, true);
         message->write(data);
         nodeList->sendPacketList(std::move(message), domainHandler.getSockAddr());
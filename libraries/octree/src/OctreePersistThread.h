@@ -14,9 +14,14 @@
 #ifndef hifi_OctreePersistThread_h
 #define hifi_OctreePersistThread_h
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include <QString>
 #include <GenericThread.h>
 #include "Octree.h"
+#include "OctreePersistLog.h"
 
 class OctreePersistThread : public QObject {
     Q_OBJECT
@@ -31,12 +36,18 @@ public:
     };
 
     static const std::chrono::seconds DEFAULT_PERSIST_INTERVAL;
+    static const std::chrono::seconds DEFAULT_COMPACTION_INTERVAL;
 
+    /// When the tree supports it, the changes get appended to a log every persistInterval and the whole
+    /// tree is only saved (compacting the log) in the background every compactionInterval, or sooner if
+    /// the log grows large. Otherwise the whole tree is saved every persistInterval, when it changed.
     OctreePersistThread(OctreePointer tree,
                         const QString& filename,
                         std::chrono::milliseconds persistInterval = DEFAULT_PERSIST_INTERVAL,
+                        std::chrono::milliseconds compactionInterval = DEFAULT_COMPACTION_INTERVAL,
                         bool debugTimestampNow = false,
                         QString persistAsFileType = "json.gz");
+    ~OctreePersistThread();
 
     bool isInitialLoadComplete() const { return _initialLoadComplete; }
     quint64 getLoadElapsedTime() const { return _loadTimeUSecs; }
@@ -59,17 +70,23 @@ protected slots:
 
 protected:
     void persist();
+    void compact(bool inBackground);
+    void finishCompaction();
+    bool writePersistFile(const QByteArray& gzippedData);
+    bool readPersistFileHead(QUuid& id, int64_t& dataVersion) const;
     bool backupCurrentFile();
     void cleanupOldReplacementBackups();
 
     void replaceData(QByteArray data);
-    void sendLatestEntityDataToDS();
+    void sendLatestEntityDataToDS(QByteArray data = QByteArray());
 
 private:
     OctreePointer _tree;
     QString _filename;
     std::chrono::milliseconds _persistInterval;
     std::chrono::steady_clock::time_point _lastPersistCheck;
+    std::chrono::milliseconds _compactionInterval;
+    std::chrono::steady_clock::time_point _lastCompaction;
     bool _initialLoadComplete;
 
     quint64 _loadTimeUSecs;
@@ -78,7 +95,27 @@ private:
     quint64 _lastTimeDebug;
 
     QString _persistAsFileType;
-    QByteArray _cachedJSONData;
+
+    // what the persist file held when the DS was asked whether it is current
+    bool _hasPersistFileInfo { false };
+    QUuid _persistFileID;
+    int64_t _persistFileDataVersion { 0 };
+
+    // binary snapshot of the tree, see Octree::writeBinarySnapshot
+    QString _snapshotFilename;
+    bool _loadFromBinarySnapshot { false };
+    QUuid _snapshotID;
+    int64_t _snapshotDataVersion { 0 };
+
+    std::unique_ptr<OctreePersistLog> _persistLog;
+
+    // compaction state, the results are only read by this thread once the compaction thread is joined
+    std::thread _compactionThread;
+    bool _isCompacting { false };
+    std::atomic<bool> _compactionDone { false };
+    bool _compactionSucceeded { false };
+    int _compactedSegment { 0 };
+    QByteArray _compactedData;
 };
 
 #endif // hifi_OctreePersistThread_h
@@ -12,6 +12,7 @@
 #ifndef hifi_OctreeQueryNode_h
 #define hifi_OctreeQueryNode_h
 
+#include <atomic>
 #include <iostream>
 
 #include <qqueue.h>
@@ -79,6 +80,8 @@ public:
     void parseNackPacket(ReceivedMessage& message);
     bool hasNextNackedPacket() const;
     const NLPacket* getNextNackedPacket();
+    /// Number of packets NACKed since the last call, the NACKs are parsed on another thread
+    int takeNumNackedPackets() { return _numNackedPackets.exchange(0); }
 
     // call only from OctreeSendThread for the given node
     bool haveJSONParametersChanged();
@@ -112,6 +115,7 @@ private:
 
     SentPacketHistory _sentPacketHistory;
     QQueue<OCTREE_PACKET_SEQUENCE> _nackedSequenceNumbers;
+    std::atomic<int> _numNackedPackets { 0 };
 
     std::array<char, udt::MAX_PACKET_SIZE> _lastOctreePayload;
 
@@ -0,0 +1,109 @@
+//
+//  OctreeSendBudget.cpp
+//  libraries/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeSendBudget.h"
+
+#include <algorithm>
+
+#include <NumericalConstants.h>
+
+const float OctreeSendBudget::DECREASE_RATIO = 0.75f;
+const float OctreeSendBudget::MAX_LOSS_RATIO = 0.02f;
+const float OctreeSendBudget::MAX_RTT_RATIO = 2.0f;
+const int OctreeSendBudget::MIN_RTT_INCREASE_MSECS = 20;
+const quint64 OctreeSendBudget::UPDATE_INTERVAL_USECS = USECS_PER_SECOND;
+
+// the lowest RTT is forgotten this often, so that a client whose route got longer isn't taken as always queueing
+static const int MIN_RTT_WINDOW_UPDATES = 30;
+// unused budget carried over to the next interval, in intervals
+static const float MAX_CREDIT_INTERVALS = 2.0f;
+
+OctreeSendBudget::OctreeSendBudget(int intervalsPerSecond) :
+    _intervalsPerSecond(intervalsPerSecond),
+    _minPacketsPerSecond(intervalsPerSecond),
+    _increasePacketsPerSecond(std::max(1, intervalsPerSecond / 2))
+{
+}
+
+int OctreeSendBudget::startInterval(int maxPacketsPerSecond, const udt::ConnectionStats::Stats& linkStats, int pingMs,
+                                    int numNackedPackets, quint64 now) {
+    _nackedPacketsSinceUpdate += numNackedPackets;
+
+    if (_packetsPerSecond < 0.0f) {
+        // nothing is known about the link yet, start where the fixed limit used to be
+        _packetsPerSecond = (float)maxPacketsPerSecond;
+        _lastUpdate = now;
+    } else if (now - _lastUpdate >= UPDATE_INTERVAL_USECS) {
+        update(linkStats, pingMs, now);
+    }
+
+    // the limits change with the settings of the client and the number of clients connected
+    _packetsPerSecond = std::min(std::max(_packetsPerSecond, (float)_minPacketsPerSecond), (float)maxPacketsPerSecond);
+    _reportedPacketsPerSecond = (int)_packetsPerSecond;
+
+    float packetsPerInterval = _packetsPerSecond / _intervalsPerSecond;
+    _credit = std::min(_credit + packetsPerInterval, MAX_CREDIT_INTERVALS * packetsPerInterval);
+    _packetsAllowed = std::max(1, (int)_credit);
+    return _packetsAllowed;
+}
+
+void OctreeSendBudget::endInterval(int packetsSent, int bytesSent) {
+    _credit = std::max(0.0f, _credit - packetsSent);
+    if (packetsSent >= _packetsAllowed) {
+        _wasBudgetUsedUp = true;
+    }
+    _packetsSinceUpdate += packetsSent;
+    _bytesSinceUpdate += bytesSent;
+}
+
+void OctreeSendBudget::update(const udt::ConnectionStats::Stats& linkStats, int pingMs, quint64 now) {
+    float elapsedSeconds = (float)(now - _lastUpdate) / USECS_PER_SECOND;
+    _effectivePacketsPerSecond = (int)(_packetsSinceUpdate / elapsedSeconds);
+    _effectiveBytesPerSecond = (int)(_bytesSinceUpdate / elapsedSeconds);
+    _nackedPacketsPerSecond = (int)(_nackedPacketsSinceUpdate / elapsedSeconds);
+
+    // the connection only measures the RTT while it carries reliable traffic, the pings are there either way
+    int rttMsecs = linkStats.rtt > 0 ? linkStats.rtt : pingMs;
+    bool isQueueing = false;
+    if (rttMsecs > 0) {
+        if (_nextMinRTTMsecs < 0 || rttMsecs < _nextMinRTTMsecs) {
+            _nextMinRTTMsecs = rttMsecs;
+        }
+        if (_minRTTMsecs < 0 || rttMsecs < _minRTTMsecs) {
+            _minRTTMsecs = rttMsecs;
+        }
+        if (++_updatesSinceMinRTTReset >= MIN_RTT_WINDOW_UPDATES) {
+            _minRTTMsecs = _nextMinRTTMsecs;
+            _nextMinRTTMsecs = -1;
+            _updatesSinceMinRTTReset = 0;
+        }
+        isQueueing = rttMsecs > _minRTTMsecs * MAX_RTT_RATIO && rttMsecs - _minRTTMsecs > MIN_RTT_INCREASE_MSECS;
+    }
+    _rttMsecs = rttMsecs;
+
+    float lossRatio = _packetsSinceUpdate > 0 ? (float)_nackedPacketsSinceUpdate / _packetsSinceUpdate : 0.0f;
+    if (lossRatio > MAX_LOSS_RATIO || isQueueing) {
+        _packetsPerSecond *= DECREASE_RATIO;
+    } else if (_wasBudgetUsedUp) {
+        _packetsPerSecond += _increasePacketsPerSecond;
+    }
+
+    int linkPacketsPerSecond = linkStats.estimatedBandwith;
+    if (linkPacketsPerSecond > 0) {
+        _packetsPerSecond = std::min(_packetsPerSecond, (float)linkPacketsPerSecond);
+    }
+    _linkPacketsPerSecond = linkPacketsPerSecond;
+
+    _lastUpdate = now;
+    _wasBudgetUsedUp = false;
+    _packetsSinceUpdate = 0;
+    _bytesSinceUpdate = 0;
+    _nackedPacketsSinceUpdate = 0;
+}
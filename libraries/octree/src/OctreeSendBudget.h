@@ -0,0 +1,88 @@
+//
+//  OctreeSendBudget.h
+//  libraries/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Number of octree packets per second we send a client, adjusted to what its link carries
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeSendBudget_h
+#define hifi_OctreeSendBudget_h
+
+#include <atomic>
+
+#include <QtCore/QtGlobal>
+
+#include <udt/ConnectionStats.h>
+
+/// Send budget of a single client, updated once per second from what we know about its link.
+///
+/// When the UDT connection to the client has a bandwidth estimate the budget doesn't go past it. The connection only
+/// has one while its reliable traffic fills the congestion window, which it rarely does for an octree server. Octree
+/// data is sent unreliably, which the congestion control of the connection never sees, so the budget mostly backs off by
+/// itself when the client NACKs more than a few percent of what we sent it or when its RTT climbs well above the
+/// lowest one we've seen (the link is queueing our packets), and grows again while we keep using all of it. It never
+/// goes past the packets per second the client asked for and the server allows.
+///
+/// Not thread safe, except for the stats getters which the stats page reads from another thread.
+class OctreeSendBudget {
+public:
+    static const float DECREASE_RATIO; // the budget is multiplied by this on loss or queueing
+    static const float MAX_LOSS_RATIO; // NACKed packets over sent packets
+    static const float MAX_RTT_RATIO; // RTT over the lowest RTT seen
+    static const int MIN_RTT_INCREASE_MSECS; // RTT changes smaller than this are jitter
+    static const quint64 UPDATE_INTERVAL_USECS;
+
+    /// The budget is handed out intervalsPerSecond times a second, never less than a packet per interval
+    explicit OctreeSendBudget(int intervalsPerSecond);
+
+    /// Returns the number of packets that can be sent during the interval that starts now. maxPacketsPerSecond is the
+    /// most the client and the server allow, linkStats, pingMs and numNackedPackets what we learned about the link since
+    /// the last interval.
+    int startInterval(int maxPacketsPerSecond, const udt::ConnectionStats::Stats& linkStats, int pingMs,
+                      int numNackedPackets, quint64 now);
+
+    /// Records what was sent during the interval returned by the last call to startInterval
+    void endInterval(int packetsSent, int bytesSent);
+
+    int getPacketsPerSecond() const { return _reportedPacketsPerSecond; }
+    int getEffectivePacketsPerSecond() const { return _effectivePacketsPerSecond; }
+    int getEffectiveBytesPerSecond() const { return _effectiveBytesPerSecond; }
+    int getLinkPacketsPerSecond() const { return _linkPacketsPerSecond; } // 0 when the connection has no estimate
+    int getRTTMsecs() const { return _rttMsecs; }
+    int getNackedPacketsPerSecond() const { return _nackedPacketsPerSecond; }
+
+private:
+    void update(const udt::ConnectionStats::Stats& linkStats, int pingMs, quint64 now);
+
+    const int _intervalsPerSecond;
+    const int _minPacketsPerSecond;
+    const int _increasePacketsPerSecond; // added every update while the budget is used up
+
+    float _packetsPerSecond { -1.0f }; // -1 until the first interval
+    float _credit { 0.0f }; // packets that can still go out, carried over from interval to interval
+    int _packetsAllowed { 0 };
+
+    quint64 _lastUpdate { 0 };
+    int _minRTTMsecs { -1 };
+    int _nextMinRTTMsecs { -1 };
+    int _updatesSinceMinRTTReset { 0 };
+    bool _wasBudgetUsedUp { false };
+
+    int _packetsSinceUpdate { 0 };
+    qint64 _bytesSinceUpdate { 0 };
+    int _nackedPacketsSinceUpdate { 0 };
+
+    std::atomic<int> _reportedPacketsPerSecond { 0 };
+    std::atomic<int> _effectivePacketsPerSecond { 0 };
+    std::atomic<int> _effectiveBytesPerSecond { 0 };
+    std::atomic<int> _linkPacketsPerSecond { 0 };
+    std::atomic<int> _rttMsecs { 0 };
+    std::atomic<int> _nackedPacketsPerSecond { 0 };
+};
+
+#endif // hifi_OctreeSendBudget_h
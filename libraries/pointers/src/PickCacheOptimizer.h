@@ -8,6 +8,9 @@
 #ifndef hifi_PickCacheOptimizer_h
 #define hifi_PickCacheOptimizer_h
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <unordered_map>
 
 #include "Pick.h"
@@ -37,14 +40,34 @@ template<typename T>
 class PickCacheOptimizer {
 
 public:
+    // Computes the entity intersections of a batch of picks at once, the result at index i being the intersection of
+    // picks[i] with mathPicks[i] (or null to let the pick compute it itself)
+    using EntityIntersectionsOperator = std::function<std::vector<PickResultPointer>(
+        const std::vector<std::shared_ptr<Pick<T>>>& picks, const std::vector<T>& mathPicks)>;
+
     QVector3D update(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks, uint32_t& nextToUpdate, uint64_t expiry, bool shouldPickHUD);
 
+    void setEntityIntersectionsOperator(EntityIntersectionsOperator entityIntersectionsOperator) { _entityIntersectionsOperator = entityIntersectionsOperator; }
+
 protected:
     typedef std::unordered_map<T, std::unordered_map<PickCacheKey, PickResultPointer>> PickCache;
 
+    static bool doesPickEntities(const std::shared_ptr<Pick<T>>& pick) {
+        return pick->getFilter().doesPickDomainEntities() || pick->getFilter().doesPickAvatarEntities() || pick->getFilter().doesPickLocalEntities();
+    }
+
+    // Computes the entity intersections of the next picks to update as one batch and puts them in the cache
+    QVector3D batchEntityIntersections(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks,
+        std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>::iterator itr, PickCache& cache,
+        std::unordered_map<uint32_t, T>& mathPicks);
+
     // Returns true if this pick exists in the cache, and if it does, update res if the cached result is closer
     bool checkAndCompareCachedResults(T& pick, PickCache& cache, PickResultPointer& res, const PickCacheKey& key);
     void cacheResult(const bool intersects, const PickResultPointer& resTemp, const PickCacheKey& key, PickResultPointer& res, T& mathPick, PickCache& cache, const std::shared_ptr<Pick<T>> pick);
+
+    EntityIntersectionsOperator _entityIntersectionsOperator;
+    // how many picks the last update got through before its time budget ran out, which bounds the next batch
+    size_t _maxBatchSize { std::numeric_limits<size_t>::max() };
 };
 
 template<typename T>
@@ -66,6 +89,56 @@ void PickCacheOptimizer<T>::cacheResult(const bool needToCompareResults, const P
     }
 }
 
+template<typename T>
+QVector3D PickCacheOptimizer<T>::batchEntityIntersections(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks,
+        std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>::iterator itr, PickCache& cache,
+        std::unordered_map<uint32_t, T>& mathPicks) {
+    QVector3D numIntersectionsComputed;
+    std::vector<std::shared_ptr<Pick<T>>> batchPicks;
+    std::vector<T> batchMathPicks;
+    std::vector<PickCacheKey> batchKeys;
+    PickCache batched;
+
+    size_t batchSize = std::min(_maxBatchSize, picks.size());
+    for (size_t i = 0; i < batchSize; ++i) {
+        std::shared_ptr<Pick<T>> pick = std::static_pointer_cast<Pick<T>>(itr->second);
+        T mathematicalPick = pick->getMathematicalPick();
+        mathPicks[itr->first] = mathematicalPick;
+
+        if (pick->isEnabled() && pick->getMaxDistance() >= 0.0f && mathematicalPick && doesPickEntities(pick)) {
+            PickCacheKey entityKey = { pick->getFilter().getEntityFlags(), pick->getIncludeItems(), pick->getIgnoreItems() };
+            // picks that are the same as another one of the batch share its result through the cache
+            auto& batchedKeys = batched[mathematicalPick];
+            if (batchedKeys.find(entityKey) == batchedKeys.end()) {
+                batchedKeys[entityKey] = PickResultPointer();
+                batchPicks.push_back(pick);
+                batchMathPicks.push_back(mathematicalPick);
+                batchKeys.push_back(entityKey);
+            }
+        }
+
+        ++itr;
+        if (itr == picks.end()) {
+            itr = picks.begin();
+        }
+    }
+
+    if (batchPicks.empty()) {
+        return numIntersectionsComputed;
+    }
+
+    auto entityResults = _entityIntersectionsOperator(batchPicks, batchMathPicks);
+    for (size_t i = 0; i < batchPicks.size() && i < entityResults.size(); ++i) {
+        const auto& entityRes = entityResults[i];
+        if (entityRes) {
+            numIntersectionsComputed[0]++;
+            cache[batchMathPicks[i]][batchKeys[i]] = entityRes->doesIntersect() ? entityRes :
+                batchPicks[i]->getDefaultResult(batchMathPicks[i].toVariantMap());
+        }
+    }
+    return numIntersectionsComputed;
+}
+
 template<typename T>
 QVector3D PickCacheOptimizer<T>::update(std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks,
         uint32_t& nextToUpdate, uint64_t expiry, bool shouldPickHUD) {
@@ -79,16 +152,24 @@ QVector3D PickCacheOptimizer<T>::update(std::unordered_map<uint32_t, std::shared
             itr = picks.begin();
         }
     }
+
+    std::unordered_map<uint32_t, T> mathPicks;
+    if (_entityIntersectionsOperator && !picks.empty()) {
+        numIntersectionsComputed += batchEntityIntersections(picks, itr, results, mathPicks);
+    }
+
     uint32_t numUpdates = 0;
     while(numUpdates < picks.size()) {
         std::shared_ptr<Pick<T>> pick = std::static_pointer_cast<Pick<T>>(itr->second);
-        T mathematicalPick = pick->getMathematicalPick();
+        // use the same pick the batch was computed with, its parent could have moved since
+        auto mathPickItr = mathPicks.find(itr->first);
+        T mathematicalPick = mathPickItr != mathPicks.end() ? mathPickItr->second : pick->getMathematicalPick();
         PickResultPointer res = pick->getDefaultResult(mathematicalPick.toVariantMap());
 
         if (!pick->isEnabled() || pick->getMaxDistance() < 0.0f || !mathematicalPick) {
             pick->setPickResult(res);
         } else {
-            if (pick->getFilter().doesPickDomainEntities() || pick->getFilter().doesPickAvatarEntities() || pick->getFilter().doesPickLocalEntities()) {
+            if (doesPickEntities(pick)) {
                 PickCacheKey entityKey = { pick->getFilter().getEntityFlags(), pick->getIncludeItems(), pick->getIgnoreItems() };
                 if (!checkAndCompareCachedResults(mathematicalPick, results, res, entityKey)) {
                     PickResultPointer entityRes = pick->getEntityIntersection(mathematicalPick);
@@ -139,6 +220,7 @@ QVector3D PickCacheOptimizer<T>::update(std::unordered_map<uint32_t, std::shared
             break;
         }
     }
+    _maxBatchSize = std::max((size_t)numUpdates, (size_t)1);
     return numIntersectionsComputed;
 }
 
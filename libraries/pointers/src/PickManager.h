@@ -60,6 +60,14 @@ public:
     void setCalculatePos2DFromHUDOperator(std::function<glm::vec2(const glm::vec3&)> calculatePos2DFromHUDOperator) { _calculatePos2DFromHUDOperator = calculatePos2DFromHUDOperator; }
     glm::vec2 calculatePos2DFromHUD(const glm::vec3& intersection) { return _calculatePos2DFromHUDOperator(intersection); }
 
+    // Let the ray and parabola picks compute their entity intersections in batches, see PickCacheOptimizer
+    void setRayEntityIntersectionsOperator(PickCacheOptimizer<PickRay>::EntityIntersectionsOperator entityIntersectionsOperator) {
+        _rayPickCacheOptimizer.setEntityIntersectionsOperator(entityIntersectionsOperator);
+    }
+    void setParabolaEntityIntersectionsOperator(PickCacheOptimizer<PickParabola>::EntityIntersectionsOperator entityIntersectionsOperator) {
+        _parabolaPickCacheOptimizer.setEntityIntersectionsOperator(entityIntersectionsOperator);
+    }
+
     static const unsigned int INVALID_PICK_ID { 0 };
 
     unsigned int getPerFrameTimeBudget() const { return _perFrameTimeBudget; }
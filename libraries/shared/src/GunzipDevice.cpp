@@ -0,0 +1,190 @@
+//
+//  GunzipDevice.cpp
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "GunzipDevice.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+const int GZIP_WINDOWS_BIT = 31;
+const int SOURCE_CHUNK_SIZE = 64 * 1024;
+const int BLOCK_SIZE = 256 * 1024;
+// how far ahead of the reader the inflating thread gets
+const size_t MAX_QUEUED_BLOCKS = 4;
+
+GunzipDevice::GunzipDevice(QIODevice* source, QObject* parent) :
+    QIODevice(parent),
+    _source(source)
+{
+}
+
+GunzipDevice::~GunzipDevice() {
+    stopInflating();
+}
+
+bool GunzipDevice::isGzipped(const QByteArray& header) {
+    return header.size() >= 2 && (uchar)header[0] == 0x1f && (uchar)header[1] == 0x8b;
+}
+
+bool GunzipDevice::open(OpenMode mode) {
+    if ((mode & ReadWrite) != ReadOnly || !_source || !_source->isReadable()) {
+        return false;
+    }
+    stopInflating();
+
+    _blocks.clear();
+    _queuedBytes = 0;
+    _finished = false;
+    _error = false;
+    _stopping = false;
+    _currentBlock.clear();
+    _currentOffset = 0;
+
+    if (!QIODevice::open(mode)) {
+        return false;
+    }
+    _inflateThread = std::thread([this] { inflateSource(); });
+    return true;
+}
+
+void GunzipDevice::close() {
+    stopInflating();
+    QIODevice::close();
+}
+
+void GunzipDevice::stopInflating() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _blockRemoved.notify_all();
+    if (_inflateThread.joinable()) {
+        _inflateThread.join();
+    }
+}
+
+bool GunzipDevice::atEnd() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return QIODevice::bytesAvailable() == 0 && _currentOffset == _currentBlock.size() && _blocks.empty() && _finished;
+}
+
+qint64 GunzipDevice::bytesAvailable() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return QIODevice::bytesAvailable() + (_currentBlock.size() - _currentOffset) + _queuedBytes;
+}
+
+bool GunzipDevice::hasError() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _error;
+}
+
+qint64 GunzipDevice::readData(char* data, qint64 maxSize) {
+    qint64 bytesRead = 0;
+    while (bytesRead < maxSize) {
+        if (_currentOffset == _currentBlock.size()) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (bytesRead > 0 && _blocks.empty()) {
+                // hand over what is there rather than waiting for more
+                break;
+            }
+            _blockAdded.wait(lock, [&] { return !_blocks.empty() || _finished; });
+            if (_blocks.empty()) {
+                lock.unlock();
+                if (bytesRead == 0 && hasError()) {
+                    return -1;
+                }
+                break;
+            }
+            _currentBlock = std::move(_blocks.front());
+            _blocks.pop_front();
+            _queuedBytes -= _currentBlock.size();
+            _currentOffset = 0;
+            lock.unlock();
+            _blockRemoved.notify_one();
+        }
+
+        qint64 size = std::min(maxSize - bytesRead, (qint64)(_currentBlock.size() - _currentOffset));
+        memcpy(data + bytesRead, _currentBlock.constData() + _currentOffset, size);
+        _currentOffset += size;
+        bytesRead += size;
+    }
+    return bytesRead;
+}
+
+void GunzipDevice::inflateSource() {
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.avail_in = 0;
+    strm.next_in = Z_NULL;
+
+    int status = inflateInit2(&strm, GZIP_WINDOWS_BIT);
+    QByteArray input;
+    QByteArray block;
+
+    auto pushBlock = [&] {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _blockRemoved.wait(lock, [&] { return _blocks.size() < MAX_QUEUED_BLOCKS || _stopping; });
+        if (_stopping) {
+            return false;
+        }
+        _queuedBytes += block.size();
+        _blocks.push_back(std::move(block));
+        lock.unlock();
+        _blockAdded.notify_one();
+        block = QByteArray();
+        return true;
+    };
+
+    bool stopped = false;
+    while (status == Z_OK && !stopped) {
+        if (strm.avail_in == 0) {
+            input = _source->read(SOURCE_CHUNK_SIZE);
+            if (input.isEmpty()) {
+                // the gzip stream isn't complete
+                break;
+            }
+            strm.next_in = (unsigned char*)input.data();
+            strm.avail_in = input.size();
+        }
+
+        if (block.isEmpty()) {
+            block.resize(BLOCK_SIZE);
+            strm.next_out = (unsigned char*)block.data();
+            strm.avail_out = BLOCK_SIZE;
+        }
+
+        status = inflate(&strm, Z_NO_FLUSH);
+        if (status == Z_NEED_DICT || status == Z_DATA_ERROR || status == Z_MEM_ERROR || status == Z_STREAM_ERROR) {
+            break;
+        }
+        if (status == Z_BUF_ERROR) {
+            // no progress possible with the current buffers, get more input
+            status = Z_OK;
+        }
+
+        if (strm.avail_out == 0 || status == Z_STREAM_END) {
+            block.resize(BLOCK_SIZE - strm.avail_out);
+            stopped = !block.isEmpty() && !pushBlock();
+            block = QByteArray();
+        }
+    }
+    inflateEnd(&strm);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished = true;
+        _error = status != Z_STREAM_END && !stopped;
+    }
+    _blockAdded.notify_all();
+}
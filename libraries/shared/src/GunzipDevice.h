@@ -0,0 +1,68 @@
+//
+//  GunzipDevice.h
+//  libraries/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_GunzipDevice_h
+#define hifi_GunzipDevice_h
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <QtCore/QIODevice>
+
+// Read-only device that decompresses gzipped data from a source device as it gets read, so that the decompressed
+// data never has to be in memory as a whole. The source is inflated on a separate thread a few blocks ahead of the
+// reader, reads block until the next block is ready. The source must stay open and untouched while this is open.
+class GunzipDevice : public QIODevice {
+    Q_OBJECT
+public:
+    GunzipDevice(QIODevice* source, QObject* parent = nullptr);
+    ~GunzipDevice();
+
+    // only ReadOnly is supported
+    bool open(OpenMode mode) override;
+    void close() override;
+
+    bool isSequential() const override { return true; }
+    bool atEnd() const override;
+    qint64 bytesAvailable() const override;
+
+    // the source wasn't valid gzip data, or ended before the end of the gzip stream
+    bool hasError() const;
+
+    static bool isGzipped(const QByteArray& header);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override { return -1; }
+
+private:
+    void inflateSource();
+    void stopInflating();
+
+    QIODevice* _source;
+    std::thread _inflateThread;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _blockAdded;
+    std::condition_variable _blockRemoved;
+    std::deque<QByteArray> _blocks;
+    qint64 _queuedBytes { 0 };
+    bool _finished { false };
+    bool _error { false };
+    bool _stopping { false };
+
+    // block being read, only touched by the reading thread
+    QByteArray _currentBlock;
+    int _currentOffset { 0 };
+};
+
+#endif // hifi_GunzipDevice_h
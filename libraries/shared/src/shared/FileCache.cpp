@@ -14,21 +14,20 @@
 
 #include <unordered_set>
 #include <queue>
+#include <vector>
 #include <cassert>
 
+#include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QRunnable>
 #include <QtCore/QSaveFile>
 #include <QtCore/QStorageInfo>
+#include <QtCore/QThreadPool>
 
 #include "../PathUtils.h"
 #include "../NumericalConstants.h"
-
-#ifdef Q_OS_WIN
-#include <sys/utime.h>
-#else
-#include <utime.h>
-#endif
+#include "../SharedUtil.h"
 
 #ifdef NDEBUG
 Q_LOGGING_CATEGORY(file_cache, "hifi.file_cache", QtWarningMsg)
@@ -44,6 +43,45 @@ const size_t FileCache::DEFAULT_MAX_SIZE { GB_TO_BYTES(5) };
 const size_t FileCache::MAX_MAX_SIZE { GB_TO_BYTES(100) };
 const size_t FileCache::DEFAULT_MIN_FREE_STORAGE_SPACE { GB_TO_BYTES(1) };
 
+static const char* INDEX_FILE_NAME = ".index";
+static const quint32 INDEX_VERSION = 1;
+// so that it's mostly up to date if the application doesn't get to shut down
+static const int64_t INDEX_SAVE_INTERVAL_MSECS = 60 * 1000;
+
+// each use of a file counts as this much more recent when it comes to evicting it, up to a point
+static const int64_t MSECS_PER_USE = 60 * 60 * 1000;
+static const uint32_t MAX_COUNTED_USES = 24;
+
+// file I/O is mostly waiting on the disk, a couple of threads keep it busy without competing with everything else
+static const int NUM_IO_THREADS = 2;
+
+namespace {
+    class IOTask : public QRunnable {
+    public:
+        IOTask(std::function<void()> function) : _function(function) {}
+        void run() override { _function(); }
+
+    private:
+        std::function<void()> _function;
+    };
+
+    struct IndexEntry {
+        quint64 length;
+        qint64 lastUsed;
+        quint32 numUses;
+    };
+}
+
+static QThreadPool& getIOThreadPool() {
+    // never destroyed, files can still be read while the application shuts down
+    static QThreadPool* threadPool = [] {
+        auto threadPool = new QThreadPool();
+        threadPool->setMaxThreadCount(NUM_IO_THREADS);
+        return threadPool;
+    }();
+    return *threadPool;
+}
+
 
 std::string getCacheName(const std::string& dirname_str) {
     QString dirname { dirname_str.c_str() };
@@ -79,7 +117,8 @@ FileCache::FileCache(const std::string& dirname, const std::string& ext, QObject
     QObject(parent),
     _ext(ext),
     _dirname(getCacheName(dirname)),
-    _dirpath(getCachePath(dirname)) {
+    _dirpath(getCachePath(dirname)),
+    _indexSaveIntervalMsecs(INDEX_SAVE_INTERVAL_MSECS) {
 }
 
 FileCache::~FileCache() {
@@ -96,17 +135,43 @@ void FileCache::initialize() {
     QDir dir(_dirpath.c_str());
 
     if (dir.exists()) {
+        // what the cache knew of its files when it last saved its index. Files are written whole and named after
+        // what's in them, so an entry is good for as long as its file is there: it's kept for the next start up.
+        std::unordered_map<Key, IndexEntry> index;
+        QFile indexFile(getIndexFilepath().c_str());
+        if (indexFile.open(QIODevice::ReadOnly)) {
+            QDataStream stream(&indexFile);
+            stream.setVersion(QDataStream::Qt_5_0);
+            quint32 version { 0 };
+            quint32 numEntries { 0 };
+            stream >> version >> numEntries;
+            for (quint32 i = 0; i < numEntries && version == INDEX_VERSION && stream.status() == QDataStream::Ok; ++i) {
+                QByteArray key;
+                IndexEntry entry;
+                stream >> key >> entry.length >> entry.lastUsed >> entry.numUses;
+                index[key.toStdString()] = entry;
+            }
+            if (stream.status() != QDataStream::Ok) {
+                index.clear();
+            }
+        }
+
         auto nameFilters = QStringList(("*." + _ext).c_str());
         auto filters = QDir::Filters(QDir::NoDotAndDotDot | QDir::Files);
-        auto sort = QDir::SortFlags(QDir::Time);
-        auto files = dir.entryList(nameFilters, filters, sort);
+        auto files = dir.entryList(nameFilters, filters, QDir::Unsorted);
 
-        // load persisted files
+        // load persisted files, only the ones the index doesn't know about need to be looked at
         foreach(QString filename, files) {
             const Key key = filename.section('.', 0, 0).toStdString();
             const std::string filepath = dir.filePath(filename).toStdString();
-            const size_t length = QFileInfo(filepath.c_str()).size();
-            addFile(Metadata(key, length), filepath);
+            auto indexed = index.find(key);
+            if (indexed != index.end()) {
+                const auto& entry = indexed->second;
+                addFile(Metadata(key, entry.length), filepath, entry.lastUsed, entry.numUses);
+            } else {
+                QFileInfo fileInfo(filepath.c_str());
+                addFile(Metadata(key, fileInfo.size()), filepath, fileInfo.lastModified().toMSecsSinceEpoch());
+            }
         }
 
         qCDebug(file_cache, "[%s] Initialized %s", _dirname.c_str(), _dirpath.c_str());
@@ -116,13 +181,14 @@ void FileCache::initialize() {
     }
 
     _initialized = true;
+    _lastIndexSaveTime = QDateTime::currentMSecsSinceEpoch();
 }
 
 std::unique_ptr<File> FileCache::createFile(Metadata&& metadata, const std::string& filepath) {
     return std::unique_ptr<File>(new cache::File(std::move(metadata), filepath));
 }
 
-FilePointer FileCache::addFile(Metadata&& metadata, const std::string& filepath) {
+FilePointer FileCache::addFile(Metadata&& metadata, const std::string& filepath, int64_t lastUsed, uint32_t numUses) {
     File* rawFile = createFile(std::move(metadata), filepath).release();
     FilePointer file(rawFile, std::bind(&File::deleter, rawFile));
     if (file) {
@@ -130,9 +196,13 @@ FilePointer FileCache::addFile(Metadata&& metadata, const std::string& filepath)
         _totalFilesSize += file->getLength();
         file->_parent = shared_from_this();
         file->_locked = true;
+        file->_modified = lastUsed != 0 ? lastUsed : QDateTime::currentMSecsSinceEpoch();
+        file->_numUses = numUses;
         emit dirty();
 
         _files[file->getKey()] = file;
+        _isIndexDirty = true;
+        maybeSaveIndex();
     }
     return file;
 }
@@ -156,7 +226,7 @@ FilePointer FileCache::writeFile(const char* data, File::Metadata&& metadata, bo
     std::string filepath = getFilepath(metadata.key);
 
     // if file already exists, return it
-    file = getFile(metadata.key);
+    file = findFile(metadata.key);
     if (file) {
         if (!overwrite) {
             qCWarning(file_cache, "[%s] Attempted to overwrite %s", _dirname.c_str(), metadata.key.c_str());
@@ -182,6 +252,55 @@ FilePointer FileCache::writeFile(const char* data, File::Metadata&& metadata, bo
 
 
 FilePointer FileCache::getFile(const Key& key) {
+    auto file = findFile(key);
+    if (file) {
+        ++_numHits;
+    } else {
+        ++_numMisses;
+    }
+    return file;
+}
+
+void FileCache::readFileAsync(const Key& key, ReadCallback callback) {
+    // holding on to the file keeps it from being evicted while it's read
+    auto file = getFile(key);
+    if (!file) {
+        callback(QByteArray());
+        return;
+    }
+
+    auto self = shared_from_this();
+    auto requestTime = usecTimestampNow();
+    getIOThreadPool().start(new IOTask([self, file, callback, requestTime] {
+        QByteArray data;
+        QFile qfile(file->getFilepath().c_str());
+        if (qfile.open(QIODevice::ReadOnly)) {
+            data = qfile.readAll();
+        }
+        if ((size_t)data.size() != file->getLength()) {
+            qCWarning(file_cache, "Failed to read %s", file->getFilepath().c_str());
+            data = QByteArray();
+        }
+
+        ++self->_numReads;
+        self->_readUsecs += usecTimestampNow() - requestTime;
+        callback(data);
+    }));
+}
+
+void FileCache::writeFileAsync(const QByteArray& data, Metadata&& metadata) {
+    auto self = shared_from_this();
+    getIOThreadPool().start(new IOTask([self, data, metadata]() mutable {
+        self->writeFile(data.constData(), std::move(metadata));
+    }));
+}
+
+uint64_t FileCache::getAverageReadUsecs() const {
+    uint64_t numReads = _numReads;
+    return numReads > 0 ? _readUsecs / numReads : 0;
+}
+
+FilePointer FileCache::findFile(const Key& key) {
     Lock lock(_mutex);
 
     FilePointer file;
@@ -206,6 +325,8 @@ FilePointer FileCache::getFile(const Key& key) {
                 assert(file->_locked);
             }
             qCDebug(file_cache, "[%s] Found %s", _dirname.c_str(), key.c_str());
+            _isIndexDirty = true;
+            maybeSaveIndex();
             emit dirty();
         } else {
             // if not, remove the weak_ptr
@@ -221,6 +342,10 @@ std::string FileCache::getFilepath(const Key& key) {
     return _dirpath + DIR_SEP + key + EXT_SEP + _ext;
 }
 
+std::string FileCache::getIndexFilepath() const {
+    return _dirpath + DIR_SEP + INDEX_FILE_NAME;
+}
+
 // This is a non-public function that uses the mutex because it's 
 // essentially a public function specifically to a File object
 void FileCache::addUnusedFile(const FilePointer& file) {
@@ -231,6 +356,7 @@ void FileCache::addUnusedFile(const FilePointer& file) {
     _numUnusedFiles += 1;
     _unusedFilesSize += file->getLength();
     clean();
+    maybeSaveIndex();
 
     emit dirty();
 }
@@ -253,7 +379,7 @@ size_t FileCache::getOverbudgetAmount() const {
 namespace cache {
     struct FilePointerComparator {
         bool operator()(const FilePointer& a, const FilePointer& b) {
-            return a->_modified > b->_modified;
+            return a->getEvictionTime() > b->getEvictionTime();
         }
     };
 }
@@ -267,6 +393,7 @@ void FileCache::eject(FilePointer file) {
     if (0 != _files.erase(key)) {
         _numTotalFiles -= 1;
         _totalFilesSize -= length;
+        _isIndexDirty = true;
     }
     if (0 != _unusedFiles.erase(file)) {
         _numUnusedFiles -= 1;
@@ -302,6 +429,7 @@ void FileCache::wipe() {
     while (!_unusedFiles.empty()) {
         eject(*_unusedFiles.begin());
     }
+    maybeSaveIndex();
 }
 
 void FileCache::clear() {
@@ -310,6 +438,10 @@ void FileCache::clear() {
     // Eliminate any overbudget files
     clean();
 
+    if (_initialized) {
+        saveIndex();
+    }
+
     // Mark everything remaining as persisted while effectively ejecting from the cache
     for (auto& file : _unusedFiles) {
         file->_shouldPersist = true;
@@ -319,6 +451,64 @@ void FileCache::clear() {
     _unusedFiles.clear();
 }
 
+void FileCache::saveIndex() {
+    writeIndex(serializeIndex(), ++_indexGeneration);
+}
+
+void FileCache::maybeSaveIndex() {
+    if (!_initialized || !_isIndexDirty) {
+        return;
+    }
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    if (now - _lastIndexSaveTime < _indexSaveIntervalMsecs) {
+        return;
+    }
+    _lastIndexSaveTime = now;
+
+    auto self = shared_from_this();
+    auto index = serializeIndex();
+    auto generation = ++_indexGeneration;
+    getIOThreadPool().start(new IOTask([self, index, generation] {
+        self->writeIndex(index, generation);
+    }));
+}
+
+QByteArray FileCache::serializeIndex() {
+    std::vector<FilePointer> files;
+    files.reserve(_files.size());
+    for (const auto& entry : _files) {
+        if (auto file = entry.second.lock()) {
+            files.push_back(file);
+        }
+    }
+
+    QByteArray index;
+    QDataStream stream(&index, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << INDEX_VERSION << (quint32)files.size();
+    for (const auto& file : files) {
+        stream << QByteArray::fromStdString(file->getKey()) << (quint64)file->getLength() << (qint64)file->_modified
+               << (quint32)file->_numUses;
+    }
+    _isIndexDirty = false;
+    return index;
+}
+
+void FileCache::writeIndex(const QByteArray& index, uint64_t generation) {
+    std::lock_guard<std::mutex> lock(_indexFileMutex);
+    if (generation < _savedIndexGeneration) {
+        // a later one got there first
+        return;
+    }
+
+    QSaveFile indexFile(getIndexFilepath().c_str());
+    if (indexFile.open(QIODevice::WriteOnly) && indexFile.write(index) == index.size() && indexFile.commit()) {
+        _savedIndexGeneration = generation;
+    } else {
+        qCWarning(file_cache, "[%s] Failed to save the index", _dirname.c_str());
+    }
+}
+
 void FileCache::releaseFile(File* file) {
     Lock lock(_mutex);
     if (file->_locked) {
@@ -344,8 +534,7 @@ void File::deleter(File* file) {
 File::File(Metadata&& metadata, const std::string& filepath) :
     _key(std::move(metadata.key)),
     _length(metadata.length),
-    _filepath(filepath),
-    _modified(QFileInfo(_filepath.c_str()).lastRead().toMSecsSinceEpoch()) {
+    _filepath(filepath) {
 }
 
 File::~File() {
@@ -357,7 +546,12 @@ File::~File() {
 }
 
 void File::touch() {
-    utime(_filepath.c_str(), nullptr);
-    _modified = std::max<int64_t>(QFileInfo(_filepath.c_str()).lastRead().toMSecsSinceEpoch(), _modified);
+    // kept in memory and in the index, the file itself isn't touched
+    _modified = std::max<int64_t>(QDateTime::currentMSecsSinceEpoch(), _modified);
+    ++_numUses;
+}
+
+int64_t File::getEvictionTime() const {
+    return _modified + std::min(_numUses, MAX_COUNTED_USES) * MSECS_PER_USE;
 }
 
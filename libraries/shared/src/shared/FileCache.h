@@ -11,6 +11,7 @@
 #define hifi_FileCache_h
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <cstddef>
 #include <map>
@@ -19,6 +20,7 @@
 #include <string>
 #include <unordered_map>
 
+#include <QByteArray>
 #include <QObject>
 #include <QLoggingCategory>
 
@@ -40,6 +42,8 @@ class FileCache : public QObject, public std::enable_shared_from_this<FileCache>
     Q_PROPERTY(size_t numCached READ getNumCachedFiles NOTIFY dirty)
     Q_PROPERTY(size_t sizeTotal READ getSizeTotalFiles NOTIFY dirty)
     Q_PROPERTY(size_t sizeCached READ getSizeCachedFiles NOTIFY dirty)
+    Q_PROPERTY(size_t numHits READ getNumHits NOTIFY dirty)
+    Q_PROPERTY(size_t numMisses READ getNumMisses NOTIFY dirty)
 
     static const size_t DEFAULT_MAX_SIZE;
     static const size_t MAX_MAX_SIZE;
@@ -60,6 +64,10 @@ public:
     size_t getNumCachedFiles() const { return _numUnusedFiles; }
     size_t getSizeTotalFiles() const { return _totalFilesSize; }
     size_t getSizeCachedFiles() const { return _unusedFilesSize; }
+    size_t getNumHits() const { return _numHits; }
+    size_t getNumMisses() const { return _numMisses; }
+    // Average time readFileAsync took to read a file once it got to it, in microseconds
+    uint64_t getAverageReadUsecs() const;
 
     // Set the maximum amount of disk space to use on disk
     void setMaxSize(size_t maxCacheSize);
@@ -99,6 +107,12 @@ public:
     FilePointer writeFile(const char* data, Metadata&& metadata, bool overwrite = false);
     FilePointer getFile(const Key& key);
 
+    // The same, with the file I/O done on the cache I/O threads rather than the calling one. readFileAsync calls back
+    // on an I/O thread with the contents of the file, or right away with a null array if it isn't cached.
+    using ReadCallback = std::function<void(const QByteArray& data)>;
+    void readFileAsync(const Key& key, ReadCallback callback);
+    void writeFileAsync(const QByteArray& data, Metadata&& metadata);
+
     /// create a file
     virtual std::unique_ptr<File> createFile(Metadata&& metadata, const std::string& filepath);
 
@@ -112,8 +126,10 @@ private:
     friend class File;
 
     std::string getFilepath(const Key& key);
+    std::string getIndexFilepath() const;
 
-    FilePointer addFile(Metadata&& metadata, const std::string& filepath);
+    FilePointer findFile(const Key& key);
+    FilePointer addFile(Metadata&& metadata, const std::string& filepath, int64_t lastUsed = 0, uint32_t numUses = 0);
     void addUnusedFile(const FilePointer& file);
     void releaseFile(File* file);
     void clean();
@@ -121,6 +137,14 @@ private:
     // Remove a file from the cache
     void eject(FilePointer file);
 
+    // The index of the files in the cache is saved every so often while the cache changes and when it shuts down, so
+    // that it doesn't have to look at each of them to start up again
+    void saveIndex();
+    // Saves it on the I/O threads if it changed and wasn't saved for a while, lock held
+    void maybeSaveIndex();
+    QByteArray serializeIndex();
+    void writeIndex(const QByteArray& index, uint64_t generation);
+
     size_t getOverbudgetAmount() const;
 
     // FIXME it might be desirable to have the min free space variable be static so it can be
@@ -131,6 +155,10 @@ private:
     std::atomic<size_t> _numUnusedFiles { 0 };
     std::atomic<size_t> _totalFilesSize { 0 };
     std::atomic<size_t> _unusedFilesSize { 0 };
+    std::atomic<size_t> _numHits { 0 };
+    std::atomic<size_t> _numMisses { 0 };
+    std::atomic<uint64_t> _numReads { 0 };
+    std::atomic<uint64_t> _readUsecs { 0 };
 
     const std::string _ext;
     const std::string _dirname;
@@ -140,6 +168,14 @@ private:
     Mutex _mutex;
     Map _files;
     Set _unusedFiles;
+
+    int64_t _indexSaveIntervalMsecs;
+    bool _isIndexDirty { false };
+    int64_t _lastIndexSaveTime { 0 };
+    uint64_t _indexGeneration { 0 };
+    // the latest index is the one that ends up saved, whichever thread gets to write it first
+    std::mutex _indexFileMutex;
+    uint64_t _savedIndexGeneration { 0 };
 };
 
 class File {
@@ -169,8 +205,12 @@ private:
     const std::string _filepath;
 
     void touch();
+    // files that have been used more often are kept a little longer
+    int64_t getEvictionTime() const;
+
     FileCacheWeakPointer _parent;
     int64_t _modified { 0 };
+    uint32_t _numUses { 0 };
     bool _locked { false };
 
     bool _shouldPersist { false };
@@ -12,6 +12,7 @@
 
 #include "FileUtils.h"
 
+#include <cstdio>
 #include <mutex>
 
 #include <QtCore/QDateTime>
@@ -24,6 +25,10 @@
 #include <QtCore/QFileSelector>
 #include <QtGui/QDesktopServices>
 
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
 
 #include "../SharedLogging.h"
 
@@ -189,3 +194,14 @@ bool FileUtils::exists(const QString& fileName) {
 bool FileUtils::isRelative(const QString& fileName) {
     return QFileInfo(fileName).isRelative();
 }
+
+bool FileUtils::replaceFile(const QString& sourcePath, const QString& targetPath) {
+#ifdef Q_OS_WIN
+    // QFile::rename won't rename over an existing file
+    return MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(sourcePath).utf16()),
+                       reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(targetPath).utf16()),
+                       MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(QFile::encodeName(sourcePath).constData(), QFile::encodeName(targetPath).constData()) == 0;
+#endif
+}
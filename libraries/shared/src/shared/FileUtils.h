@@ -29,6 +29,8 @@ public:
     static QString computeDocumentPath(const QString& path);
     static bool canCreateFile(const QString& fullPath);
     static QString getParentPath(const QString& fullPath);
+    // Renames the file over the target in one step, the target never goes missing
+    static bool replaceFile(const QString& sourcePath, const QString& targetPath);
 };
 
 #endif // hifi_FileUtils_h
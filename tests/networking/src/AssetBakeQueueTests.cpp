@@ -0,0 +1,114 @@
+//
+//  AssetBakeQueueTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetBakeQueueTests.h"
+
+#include <QtCore/QTemporaryDir>
+
+#include <AssetBakeQueue.h>
+
+QTEST_MAIN(AssetBakeQueueTests)
+
+static const QString QUEUE_FILE_NAME = "bake-queue.json";
+
+static AssetUtils::AssetHash testHash(int i) {
+    return QString(AssetUtils::hashData(QByteArray::number(i)).toHex());
+}
+
+static AssetUtils::AssetHash startNext(AssetBakeQueue& queue) {
+    auto entry = queue.peek();
+    if (!entry) {
+        return AssetUtils::AssetHash();
+    }
+    auto hash = entry->hash;
+    queue.start(hash);
+    return hash;
+}
+
+void AssetBakeQueueTests::priorityTest() {
+    AssetBakeQueue queue;
+    for (int i = 0; i < 4; ++i) {
+        queue.push(testHash(i), QString("/model%1.fbx").arg(i));
+    }
+    // already queued
+    queue.push(testHash(0), "/model0.fbx");
+    QCOMPARE(queue.size(), 4);
+
+    QVERIFY(queue.request(testHash(2)));
+    QVERIFY(queue.request(testHash(3)));
+    queue.push(testHash(4), "/skybox.png", true);
+    QVERIFY(!queue.request(testHash(5)));
+
+    QCOMPARE(startNext(queue), testHash(4));
+    QVERIFY(queue.isStarted(testHash(4)));
+    // being baked doesn't make it come back
+    QVERIFY(queue.request(testHash(4)));
+    QCOMPARE(startNext(queue), testHash(3));
+    QCOMPARE(startNext(queue), testHash(2));
+    QCOMPARE(startNext(queue), testHash(0));
+
+    // an interrupted bake gets its place back
+    queue.stop(testHash(2));
+    QCOMPARE(queue.getNumWaiting(), 2);
+    QCOMPARE(startNext(queue), testHash(2));
+
+    queue.remove(testHash(0));
+    QVERIFY(!queue.contains(testHash(0)));
+    QCOMPARE(startNext(queue), testHash(1));
+    QVERIFY(!queue.peek());
+    QCOMPARE(queue.size(), 4);
+}
+
+void AssetBakeQueueTests::persistenceTest() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto filePath = directory.filePath(QUEUE_FILE_NAME);
+
+    {
+        AssetBakeQueue queue;
+        QVERIFY(queue.load(filePath));
+        QCOMPARE(queue.size(), 0);
+        for (int i = 0; i < 4; ++i) {
+            queue.push(testHash(i), QString("/texture%1.png").arg(i));
+        }
+        QVERIFY(queue.request(testHash(2)));
+        queue.start(testHash(2));
+        queue.start(testHash(0));
+        queue.remove(testHash(0));
+        QVERIFY(queue.isDirty());
+        QVERIFY(queue.save());
+        QVERIFY(!queue.isDirty());
+
+        // a request made after the last save is lost, the bake isn't
+        QVERIFY(queue.request(testHash(3)));
+    }
+
+    AssetBakeQueue queue;
+    QVERIFY(queue.load(filePath));
+    QCOMPARE(queue.size(), 3);
+    QCOMPARE(queue.getNumWaiting(), 3);
+    QCOMPARE(queue.peek()->path, QString("/texture2.png"));
+    QCOMPARE(startNext(queue), testHash(2));
+    QCOMPARE(startNext(queue), testHash(1));
+    QCOMPARE(startNext(queue), testHash(3));
+
+    // requests keep coming after the ones that were saved
+    queue.push(testHash(4), "/texture4.png", true);
+    queue.stop(testHash(2));
+    QCOMPARE(startNext(queue), testHash(4));
+
+    // a corrupted queue is dropped rather than failing the asset server
+    QFile file { filePath };
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("{ \"version\": 1, \"assets\": [");
+    file.close();
+    QVERIFY(queue.load(filePath));
+    QCOMPARE(queue.size(), 0);
+}
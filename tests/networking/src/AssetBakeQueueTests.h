@@ -0,0 +1,25 @@
+//
+//  AssetBakeQueueTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetBakeQueueTests_h
+#define hifi_AssetBakeQueueTests_h
+
+#include <QtTest/QtTest>
+
+class AssetBakeQueueTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Requested assets first, most recent first, then the others in the order they were queued
+    void priorityTest();
+    // Waiting and interrupted bakes are there after a reload, in the same order
+    void persistenceTest();
+};
+
+#endif // hifi_AssetBakeQueueTests_h
@@ -0,0 +1,184 @@
+//
+//  AssetCacheTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetCacheTests.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <AssetCache.h>
+
+QTEST_MAIN(AssetCacheTests)
+
+static const qint64 TEST_RANGE_SIZE = 1024;
+// room for eight ranges
+static const qint64 TEST_CAPACITY = 8 * TEST_RANGE_SIZE;
+
+static QByteArray testHash(int i) {
+    return QByteArray::number(i).rightJustified(32, '0');
+}
+
+static QByteArray testData(int i, qint64 size = TEST_RANGE_SIZE) {
+    return QByteArray((int)size, (char)('a' + i % 26));
+}
+
+// gets the range, counting how many times it had to be read
+static QByteArray get(AssetCache& cache, int i, int& numLoads, qint64 size = TEST_RANGE_SIZE) {
+    return cache.get(testHash(i), 0, size, [&] {
+        ++numLoads;
+        return testData(i, size);
+    });
+}
+
+static bool isCached(AssetCache& cache, int i, qint64 size = TEST_RANGE_SIZE) {
+    int numLoads = 0;
+    get(cache, i, numLoads, size);
+    return numLoads == 0;
+}
+
+void AssetCacheTests::coalescingTest() {
+    const int NUM_GETTERS = 16;
+    AssetCache cache(TEST_CAPACITY);
+
+    std::atomic<int> numLoads { 0 };
+    auto loader = [&] {
+        ++numLoads;
+        // hold on until everyone asked for it
+        QElapsedTimer timer;
+        timer.start();
+        while (cache.getNumRequests() < (uint64_t)NUM_GETTERS && timer.elapsed() < 5000) {
+            std::this_thread::yield();
+        }
+        return testData(0);
+    };
+
+    std::vector<std::future<QByteArray>> results;
+    for (int i = 0; i < NUM_GETTERS; ++i) {
+        results.push_back(std::async(std::launch::async, [&] {
+            return cache.get(testHash(0), 0, TEST_RANGE_SIZE, loader);
+        }));
+    }
+    for (auto& result : results) {
+        QCOMPARE(result.get(), testData(0));
+    }
+
+    QCOMPARE(numLoads.load(), 1);
+    QCOMPARE(cache.getNumRequests(), (uint64_t)NUM_GETTERS);
+    // the late ones find it in memory
+    QCOMPARE(cache.getNumCoalescedRequests() + cache.getNumHits(), (uint64_t)NUM_GETTERS - 1);
+    QCOMPARE(cache.getNumRanges(), 1);
+}
+
+void AssetCacheTests::admissionTest() {
+    AssetCache cache(TEST_CAPACITY);
+    QCOMPARE(cache.getMaxRangeSize(), TEST_RANGE_SIZE);
+
+    // fill it up with ranges asked for three times each
+    int numLoads = 0;
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            QCOMPARE(get(cache, i, numLoads), testData(i));
+        }
+    }
+    QCOMPARE(numLoads, 8);
+    QCOMPARE(cache.getSize(), TEST_CAPACITY);
+
+    // a range asked for once doesn't get in
+    numLoads = 0;
+    QCOMPARE(get(cache, 8, numLoads), testData(8));
+    QCOMPARE(numLoads, 1);
+    QCOMPARE(cache.getNumRejected(), (uint64_t)1);
+
+    // nor once it's been asked for as often as the least recently used range
+    get(cache, 8, numLoads);
+    get(cache, 8, numLoads);
+    QCOMPARE(numLoads, 3);
+    QCOMPARE(cache.getNumRejected(), (uint64_t)3);
+
+    // it does once it's been asked for more often, and the least recently used range goes
+    get(cache, 8, numLoads);
+    QCOMPARE(numLoads, 4);
+    QCOMPARE(cache.getNumRejected(), (uint64_t)3);
+    QVERIFY(isCached(cache, 8));
+    QVERIFY(!isCached(cache, 0));
+    QCOMPARE(cache.getNumRanges(), 8);
+    QCOMPARE(cache.getSize(), TEST_CAPACITY);
+
+    // too large to ever be cached
+    numLoads = 0;
+    for (int j = 0; j < 10; ++j) {
+        get(cache, 9, numLoads, TEST_RANGE_SIZE + 1);
+    }
+    QCOMPARE(numLoads, 10);
+}
+
+void AssetCacheTests::evictionSizeTest() {
+    AssetCache cache(TEST_CAPACITY);
+
+    int numLoads = 0;
+    for (int i = 0; i < 8; ++i) {
+        get(cache, i, numLoads);
+    }
+    QCOMPARE(cache.getSize(), TEST_CAPACITY);
+
+    // half a range only needs the least recently used one gone
+    const qint64 HALF_RANGE_SIZE = TEST_RANGE_SIZE / 2;
+    get(cache, 8, numLoads, HALF_RANGE_SIZE);
+    get(cache, 8, numLoads, HALF_RANGE_SIZE);
+    QVERIFY(isCached(cache, 8, HALF_RANGE_SIZE));
+    QCOMPARE(cache.getNumRanges(), 8);
+    QCOMPARE(cache.getSize(), TEST_CAPACITY - HALF_RANGE_SIZE);
+
+    // a full one fits in the room that was left and the next least recently used one
+    get(cache, 9, numLoads);
+    get(cache, 9, numLoads);
+    QVERIFY(isCached(cache, 9));
+    QCOMPARE(cache.getNumRanges(), 8);
+    QCOMPARE(cache.getSize(), TEST_CAPACITY - HALF_RANGE_SIZE);
+
+    // another half fits in the room that's left without anything going
+    numLoads = 0;
+    get(cache, 10, numLoads, HALF_RANGE_SIZE);
+    QCOMPARE(numLoads, 1);
+    QVERIFY(isCached(cache, 10, HALF_RANGE_SIZE));
+    QCOMPARE(cache.getNumRanges(), 9);
+    QCOMPARE(cache.getSize(), TEST_CAPACITY);
+}
+
+void AssetCacheTests::failedReadTest() {
+    AssetCache cache(TEST_CAPACITY);
+
+    int numLoads = 0;
+    auto failedLoader = [&] {
+        ++numLoads;
+        return QByteArray();
+    };
+    QVERIFY(cache.get(testHash(0), 0, TEST_RANGE_SIZE, failedLoader).isNull());
+    QVERIFY(cache.get(testHash(0), 0, TEST_RANGE_SIZE, failedLoader).isNull());
+    QCOMPARE(numLoads, 2);
+
+    // the file was shorter than the range asked for
+    QByteArray shortData = testData(1, TEST_RANGE_SIZE - 1);
+    auto shortLoader = [&] {
+        ++numLoads;
+        return shortData;
+    };
+    QCOMPARE(cache.get(testHash(1), 0, TEST_RANGE_SIZE, shortLoader), shortData);
+    QCOMPARE(cache.get(testHash(1), 0, TEST_RANGE_SIZE, shortLoader), shortData);
+    QCOMPARE(numLoads, 4);
+
+    QCOMPARE(cache.getNumRanges(), 0);
+    QCOMPARE(cache.getSize(), (qint64)0);
+    // a full read of it is kept
+    QVERIFY(!isCached(cache, 1));
+    QVERIFY(isCached(cache, 1));
+}
@@ -0,0 +1,28 @@
+//
+//  AssetCacheTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetCacheTests_h
+#define hifi_AssetCacheTests_h
+
+#include <QtTest/QtTest>
+
+class AssetCacheTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Concurrent requests for a range that isn't in memory share one read
+    void coalescingTest();
+    // A range only evicts ranges that were asked for less often than it
+    void admissionTest();
+    void evictionSizeTest();
+    // Null results and short reads are handed back but not kept
+    void failedReadTest();
+};
+
+#endif // hifi_AssetCacheTests_h
@@ -0,0 +1,161 @@
+//
+//  AssetMappingStoreTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetMappingStoreTests.h"
+
+#include <QtCore/QTemporaryDir>
+
+#include <AssetMappingStore.h>
+
+QTEST_MAIN(AssetMappingStoreTests)
+
+static const QString LOG_FILE_NAME = "map.log";
+
+static AssetUtils::AssetHash testHash(int i) {
+    return QString(AssetUtils::hashData(QByteArray::number(i)).toHex());
+}
+
+static AssetUtils::Mappings toMappings(const AssetMappingStore& store) {
+    return AssetUtils::Mappings(store.begin(), store.end());
+}
+
+void AssetMappingStoreTests::folderOperationsTest() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    AssetMappingStore store;
+    QVERIFY(store.load(directory.filePath(LOG_FILE_NAME)));
+    QVERIFY(store.set("/a/one.fbx", testHash(1)));
+    QVERIFY(store.set("/a/b/two.fbx", testHash(2)));
+    QVERIFY(store.set("/a.fbx", testHash(3)));
+    QVERIFY(store.set("/c/three.fbx", testHash(3)));
+
+    // moving a folder into itself
+    QVERIFY(store.rename("/a/", "/a/a/"));
+    QCOMPARE(store.size(), (size_t)4);
+    QVERIFY(store.find("/a/a/one.fbx") != store.end());
+    QVERIFY(store.find("/a/a/b/two.fbx") != store.end());
+    QVERIFY(store.find("/a.fbx") != store.end());
+
+    QVERIFY(store.rename("/a.fbx", "/c/three.fbx"));
+    QVERIFY(!store.rename("/a.fbx", "/d.fbx"));
+    QVERIFY(store.rename("/empty/", "/still-empty/"));
+
+    AssetUtils::Mappings removedMappings;
+    QVERIFY(store.remove({ "/a/a/", "/missing.fbx" }, removedMappings));
+    QCOMPARE(removedMappings.size(), (size_t)2);
+    QCOMPARE(removedMappings["/a/a/b/two.fbx"], testHash(2));
+    QVERIFY(!store.isMapped(testHash(1)));
+    QVERIFY(!store.isMapped(testHash(2)));
+    QVERIFY(store.isMapped(testHash(3)));
+    QCOMPARE(store.size(), (size_t)1);
+}
+
+void AssetMappingStoreTests::persistenceTest() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto logFilePath = directory.filePath(LOG_FILE_NAME);
+
+    AssetUtils::Mappings oldMappings;
+    for (int i = 0; i < 10; ++i) {
+        oldMappings["/old/" + QString::number(i) + ".fbx"] = testHash(i);
+    }
+
+    AssetMappingStore store;
+    QVERIFY(store.reset(logFilePath, oldMappings));
+    QVERIFY(store.rename("/old/", "/new/"));
+    AssetUtils::Mappings removedMappings;
+    QVERIFY(store.remove({ "/new/0.fbx" }, removedMappings));
+
+    AssetMappingStore reloadedStore;
+    QVERIFY(reloadedStore.load(logFilePath));
+    QCOMPARE(toMappings(reloadedStore), toMappings(store));
+    QVERIFY(!reloadedStore.isMapped(testHash(0)));
+
+    // enough changes to compact the log a few times
+    const int NUM_CHANGES = 5000;
+    for (int i = 0; i < NUM_CHANGES; ++i) {
+        QVERIFY(store.set("/new/" + QString::number(i % 20) + ".fbx", testHash(i)));
+    }
+    QVERIFY(store.getNumLoggedOperations() < NUM_CHANGES);
+
+    QVERIFY(reloadedStore.load(logFilePath));
+    QCOMPARE(toMappings(reloadedStore), toMappings(store));
+    QCOMPARE(reloadedStore.getNumLoggedOperations(), store.getNumLoggedOperations());
+}
+
+void AssetMappingStoreTests::incompleteRecordTest() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    auto logFilePath = directory.filePath(LOG_FILE_NAME);
+
+    AssetMappingStore store;
+    QVERIFY(store.load(logFilePath));
+    QVERIFY(store.set("/kept.fbx", testHash(1)));
+    auto completeSize = QFileInfo(logFilePath).size();
+    QVERIFY(store.set("/torn.fbx", testHash(2)));
+
+    // the server went away half way through the last write
+    auto tornSize = completeSize + (QFileInfo(logFilePath).size() - completeSize) / 2;
+    QVERIFY(QFile::resize(logFilePath, tornSize));
+
+    AssetMappingStore reloadedStore;
+    QVERIFY(reloadedStore.load(logFilePath));
+    QCOMPARE(reloadedStore.size(), (size_t)1);
+    QVERIFY(reloadedStore.find("/kept.fbx") != reloadedStore.end());
+    QCOMPARE(QFileInfo(logFilePath).size(), completeSize);
+
+    // and changes carry on from there
+    QVERIFY(reloadedStore.set("/after.fbx", testHash(3)));
+    QVERIFY(store.load(logFilePath));
+    QCOMPARE(toMappings(store), toMappings(reloadedStore));
+}
+
+void AssetMappingStoreTests::mappingOperationsBenchmark() {
+    const int NUM_MAPPINGS = 100000;
+    const int NUM_FOLDERS = 100;
+    const int NUM_OPERATIONS = 1000;
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    AssetUtils::Mappings mappings;
+    for (int i = 0; i < NUM_MAPPINGS; ++i) {
+        mappings["/" + QString::number(i % NUM_FOLDERS) + "/" + QString::number(i) + ".fbx"] = testHash(i);
+    }
+
+    AssetMappingStore store;
+    QVERIFY(store.reset(directory.filePath(LOG_FILE_NAME), mappings));
+
+    QBENCHMARK {
+        for (int i = 0; i < NUM_OPERATIONS; ++i) {
+            // each folder in turn gets a new mapping that is renamed, moved with its folder and then deleted
+            auto folder = "/" + QString::number((i / 4) % NUM_FOLDERS) + "/";
+            switch (i % 4) {
+                case 0:
+                    QVERIFY(store.set(folder + "new.fbx", testHash(i)));
+                    break;
+                case 1:
+                    QVERIFY(store.rename(folder + "new.fbx", folder + "renamed.fbx"));
+                    break;
+                case 2:
+                    QVERIFY(store.rename(folder, folder + "moved/"));
+                    QVERIFY(store.rename(folder + "moved/", folder));
+                    break;
+                default: {
+                    AssetUtils::Mappings removedMappings;
+                    QVERIFY(store.remove({ folder + "renamed.fbx" }, removedMappings));
+                    break;
+                }
+            }
+        }
+    }
+    QCOMPARE(store.size(), (size_t)NUM_MAPPINGS);
+}
@@ -0,0 +1,28 @@
+//
+//  AssetMappingStoreTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetMappingStoreTests_h
+#define hifi_AssetMappingStoreTests_h
+
+#include <QtTest/QtTest>
+
+class AssetMappingStoreTests : public QObject {
+    Q_OBJECT
+private slots:
+    void folderOperationsTest();
+    // What was changed is there after a reload, whether or not the log was compacted in between
+    void persistenceTest();
+    void incompleteRecordTest();
+
+    // Setting, renaming and deleting mappings of a large asset server, one change at a time
+    void mappingOperationsBenchmark();
+};
+
+#endif // hifi_AssetMappingStoreTests_h
@@ -0,0 +1,87 @@
+//
+//  AssetUtilsTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetUtilsTests.h"
+
+#include <algorithm>
+
+#include <QtCore/QCryptographicHash>
+
+#include <AssetUtils.h>
+
+QTEST_MAIN(AssetUtilsTests)
+
+static QByteArray createTestData(int size) {
+    QByteArray data(size, 0);
+    for (int i = 0; i < size; ++i) {
+        data[i] = (char)(i * 31 + 7);
+    }
+    return data;
+}
+
+static QByteArray qtHash(const QByteArray& data) {
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+}
+
+void AssetUtilsTests::hasherTest_data() {
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("one byte") << 1;
+    QTest::newRow("one block") << 64;
+    QTest::newRow("odd size") << 1000003;
+    QTest::newRow("several chunks") << (int)(3 * AssetUtils::ASSET_CHUNK_SIZE + 17);
+}
+
+void AssetUtilsTests::hasherTest() {
+    QFETCH(int, size);
+    QByteArray data = createTestData(size);
+
+    AssetUtils::Hasher hasher;
+    hasher.addData(data);
+    auto hash = hasher.result();
+    QCOMPARE(hash.size(), (int)AssetUtils::SHA256_HASH_LENGTH);
+    QCOMPARE(hash, qtHash(data));
+    QCOMPARE(AssetUtils::hashData(data), qtHash(data));
+}
+
+void AssetUtilsTests::incrementalHasherTest() {
+    QByteArray data = createTestData(1024 * 1024 + 5);
+
+    // in pieces of every size, empty ones included
+    AssetUtils::Hasher hasher;
+    int offset = 0;
+    for (int pieceSize = 0; offset < data.size(); ++pieceSize) {
+        int size = std::min(pieceSize, data.size() - offset);
+        hasher.addData(data.constData() + offset, size);
+        offset += size;
+    }
+    QCOMPARE(hasher.result(), qtHash(data));
+
+    // a byte at a time
+    QByteArray smallData = createTestData(1000);
+    AssetUtils::Hasher byteHasher;
+    for (char byte : smallData) {
+        byteHasher.addData(&byte, 1);
+    }
+    QCOMPARE(byteHasher.result(), qtHash(smallData));
+}
+
+void AssetUtilsTests::emptyHasherTest() {
+    const QByteArray EMPTY_HASH = QByteArray::fromHex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+    AssetUtils::Hasher hasher;
+    QCOMPARE(hasher.result(), EMPTY_HASH);
+
+    AssetUtils::Hasher emptyDataHasher;
+    emptyDataHasher.addData(QByteArray());
+    emptyDataHasher.addData(nullptr, 0);
+    QCOMPARE(emptyDataHasher.result(), EMPTY_HASH);
+    QCOMPARE(AssetUtils::hashData(QByteArray()), EMPTY_HASH);
+}
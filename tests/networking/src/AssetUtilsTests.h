@@ -0,0 +1,26 @@
+//
+//  AssetUtilsTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetUtilsTests_h
+#define hifi_AssetUtilsTests_h
+
+#include <QtTest/QtTest>
+
+class AssetUtilsTests : public QObject {
+    Q_OBJECT
+private slots:
+    // The hasher gives the same SHA-256 as Qt, however the data is added
+    void hasherTest_data();
+    void hasherTest();
+    void incrementalHasherTest();
+    void emptyHasherTest();
+};
+
+#endif // hifi_AssetUtilsTests_h
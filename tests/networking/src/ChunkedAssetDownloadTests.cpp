@@ -0,0 +1,175 @@
+//
+//  ChunkedAssetDownloadTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ChunkedAssetDownloadTests.h"
+
+#include <algorithm>
+#include <random>
+
+#include <ChunkedAssetDownload.h>
+
+QTEST_MAIN(ChunkedAssetDownloadTests)
+
+static QByteArray createAsset(qint64 size) {
+    QByteArray asset(size, Qt::Uninitialized);
+    std::mt19937 generator;
+    for (auto& byte : asset) {
+        byte = (char)generator();
+    }
+    return asset;
+}
+
+static QByteArray hashChunks(const QByteArray& asset) {
+    QByteArray chunkHashes;
+    for (qint64 offset = 0; offset < asset.size(); offset += AssetUtils::ASSET_CHUNK_SIZE) {
+        chunkHashes.append(AssetUtils::hashData(asset.mid(offset, AssetUtils::ASSET_CHUNK_SIZE)));
+    }
+    return chunkHashes;
+}
+
+static QByteArray getRange(const QByteArray& asset, const ByteRange& range) {
+    return asset.mid(range.fromInclusive, range.size());
+}
+
+void ChunkedAssetDownloadTests::outOfOrderChunksTest() {
+    // the last chunk isn't a whole one
+    auto asset = createAsset(5 * AssetUtils::ASSET_CHUNK_SIZE + 123);
+    ChunkedAssetDownload download(AssetUtils::hashData(asset), asset.size(), hashChunks(asset));
+    QVERIFY(download.hasChunkHashes());
+
+    // the end of it comes with the asset info, which has all of the last chunk and some of the one before
+    download.addEnd(asset.right(AssetUtils::ASSET_CHUNK_SIZE));
+    QCOMPARE(download.getBytesReceived(), (AssetUtils::DataOffset)123);
+
+    std::vector<ByteRange> ranges;
+    ByteRange range;
+    while (download.takeRangeToRequest(range)) {
+        ranges.push_back(range);
+    }
+    QCOMPARE((int)ranges.size(), 5);
+
+    std::reverse(ranges.begin(), ranges.end());
+    for (const auto& range : ranges) {
+        QVERIFY(!download.isComplete());
+        QVERIFY(download.addChunk(range.fromInclusive, getRange(asset, range)));
+    }
+    QVERIFY(download.isComplete());
+    QCOMPARE(download.verify(), ChunkedAssetDownload::Verified);
+    QCOMPARE(download.takeData(), asset);
+}
+
+void ChunkedAssetDownloadTests::corruptChunkTest() {
+    auto asset = createAsset(3 * AssetUtils::ASSET_CHUNK_SIZE);
+    ChunkedAssetDownload download(AssetUtils::hashData(asset), asset.size(), hashChunks(asset));
+
+    ByteRange range;
+    ByteRange second;
+    while (download.takeRangeToRequest(range)) {
+        auto chunk = getRange(asset, range);
+        if (range.fromInclusive == AssetUtils::ASSET_CHUNK_SIZE) {
+            second = range;
+            chunk[10] = ~chunk[10];
+        }
+        QVERIFY(download.addChunk(range.fromInclusive, chunk));
+    }
+    QVERIFY(download.isComplete());
+
+    // the asset doesn't match its hash, the manifest tells which chunk to ask for again
+    QCOMPARE(download.verify(), ChunkedAssetDownload::Refetching);
+    QCOMPARE(download.getNumVerificationFailures(), 1);
+    QCOMPARE(download.getBytesReceived(), 2 * AssetUtils::ASSET_CHUNK_SIZE);
+    QVERIFY(download.takeRangeToRequest(range));
+    QCOMPARE(range.fromInclusive, second.fromInclusive);
+    QVERIFY(!download.takeRangeToRequest(range));
+
+    QVERIFY(download.addChunk(second.fromInclusive, getRange(asset, second)));
+    QVERIFY(download.isComplete());
+    QCOMPARE(download.verify(), ChunkedAssetDownload::Verified);
+    QCOMPARE(download.takeData(), asset);
+
+    // without a manifest the whole asset is bad
+    ChunkedAssetDownload unchecked(AssetUtils::hashData(asset), asset.size(), QByteArray());
+    while (unchecked.takeRangeToRequest(range)) {
+        auto chunk = getRange(asset, range);
+        if (range.fromInclusive == 0) {
+            chunk[0] = ~chunk[0];
+        }
+        QVERIFY(unchecked.addChunk(range.fromInclusive, chunk));
+    }
+    QCOMPARE(unchecked.verify(), ChunkedAssetDownload::Failed);
+
+    // nor is a chunk of the wrong size kept
+    ChunkedAssetDownload shortChunk(AssetUtils::hashData(asset), asset.size(), QByteArray());
+    QVERIFY(shortChunk.takeRangeToRequest(range));
+    QVERIFY(!shortChunk.addChunk(range.fromInclusive, getRange(asset, range).left(100)));
+    QCOMPARE(shortChunk.getBytesReceived(), (AssetUtils::DataOffset)0);
+    QCOMPARE(shortChunk.getNumVerificationFailures(), 1);
+}
+
+void ChunkedAssetDownloadTests::lostChunkTest() {
+    auto asset = createAsset(2 * AssetUtils::ASSET_CHUNK_SIZE);
+    // an asset uploaded before there were chunk manifests
+    ChunkedAssetDownload download(AssetUtils::hashData(asset), asset.size(), QByteArray());
+    QVERIFY(!download.hasChunkHashes());
+
+    ByteRange first, second;
+    QVERIFY(download.takeRangeToRequest(first));
+    QVERIFY(download.takeRangeToRequest(second));
+
+    // the connection went away while getting the first one
+    download.returnRange(first);
+    QVERIFY(download.addChunk(second.fromInclusive, getRange(asset, second)));
+
+    ByteRange range;
+    QVERIFY(download.takeRangeToRequest(range));
+    QCOMPARE(range.fromInclusive, first.fromInclusive);
+    QVERIFY(download.addChunk(range.fromInclusive, getRange(asset, range)));
+    QVERIFY(download.isComplete());
+    QCOMPARE(download.verify(), ChunkedAssetDownload::Verified);
+}
+
+void ChunkedAssetDownloadTests::downloadBenchmark_data() {
+    QTest::addColumn<bool>("hasChunkHashes");
+
+    QTest::newRow("asset hash") << false;
+    QTest::newRow("chunk hashes") << true;
+}
+
+void ChunkedAssetDownloadTests::downloadBenchmark() {
+    QFETCH(bool, hasChunkHashes);
+    const qint64 ASSET_SIZE = 64 * AssetUtils::ASSET_CHUNK_SIZE;
+
+    auto asset = createAsset(ASSET_SIZE);
+    auto assetHash = AssetUtils::hashData(asset);
+    auto chunkHashes = hasChunkHashes ? hashChunks(asset) : QByteArray();
+    std::mt19937 generator;
+
+    QBENCHMARK {
+        ChunkedAssetDownload download(assetHash, asset.size(), chunkHashes);
+
+        // a few requests in flight at once, coming back in any order
+        std::vector<ByteRange> pendingRanges;
+        ByteRange range;
+        while (download.takeRangeToRequest(range) || !pendingRanges.empty()) {
+            if (range.size() > 0) {
+                pendingRanges.push_back(range);
+                range = ByteRange();
+                if (pendingRanges.size() < 4) {
+                    continue;
+                }
+            }
+            std::swap(pendingRanges[generator() % pendingRanges.size()], pendingRanges.back());
+            QVERIFY(download.addChunk(pendingRanges.back().fromInclusive, getRange(asset, pendingRanges.back())));
+            pendingRanges.pop_back();
+        }
+        QVERIFY(download.isComplete());
+        QCOMPARE(download.verify(), ChunkedAssetDownload::Verified);
+    }
+}
@@ -0,0 +1,29 @@
+//
+//  ChunkedAssetDownloadTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ChunkedAssetDownloadTests_h
+#define hifi_ChunkedAssetDownloadTests_h
+
+#include <QtTest/QtTest>
+
+class ChunkedAssetDownloadTests : public QObject {
+    Q_OBJECT
+private slots:
+    void outOfOrderChunksTest();
+    // A bad chunk is asked for again, the good ones are kept
+    void corruptChunkTest();
+    void lostChunkTest();
+
+    // Putting together and checking a large asset from chunks arriving in any order
+    void downloadBenchmark_data();
+    void downloadBenchmark();
+};
+
+#endif // hifi_ChunkedAssetDownloadTests_h
@@ -0,0 +1,120 @@
+//
+//  CoalescedPacketsTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "CoalescedPacketsTests.h"
+
+#include <udt/ControlPacket.h>
+#include <udt/Packet.h>
+#include <udt/Socket.h>
+
+QTEST_MAIN(CoalescedPacketsTests)
+
+using namespace udt;
+
+static std::unique_ptr<Packet> createPacket(const QByteArray& payload, SequenceNumber sequenceNumber,
+                                            bool isReliable = false) {
+    auto packet = Packet::create(-1, isReliable);
+    packet->write(payload);
+    packet->writeSequenceNumber(sequenceNumber);
+    return packet;
+}
+
+// What the receiving socket sees of a datagram, cut to the given size
+static std::unique_ptr<ControlPacket> receive(const ControlPacket& coalescedPacket, qint64 size = -1) {
+    if (size < 0) {
+        size = coalescedPacket.getDataSize();
+    }
+    auto data = std::unique_ptr<char[]>(new char[size]);
+    memcpy(data.get(), coalescedPacket.getData(), size);
+    return ControlPacket::fromReceivedPacket(std::move(data), size, HifiSockAddr());
+}
+
+void CoalescedPacketsTests::roundTripTest() {
+    QList<QByteArray> payloads { "first", QByteArray(300, 'b'), "", "last" };
+
+    auto coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+    for (int i = 0; i < payloads.size(); ++i) {
+        auto packet = createPacket(payloads[i], SequenceNumber(i + 1));
+        QVERIFY(Socket::coalescePacket(*coalescedPacket, *packet));
+    }
+
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(Socket::splitCoalescedPackets(*receive(*coalescedPacket), packets));
+    QCOMPARE((int)packets.size(), payloads.size());
+    for (int i = 0; i < payloads.size(); ++i) {
+        QCOMPARE(packets[i]->getSequenceNumber(), SequenceNumber(i + 1));
+        QCOMPARE(packets[i]->isReliable(), false);
+        QCOMPARE(QByteArray(packets[i]->getPayload(), (int)packets[i]->getPayloadSize()), payloads[i]);
+    }
+}
+
+void CoalescedPacketsTests::emptyTest() {
+    auto coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(Socket::splitCoalescedPackets(*receive(*coalescedPacket), packets));
+    QVERIFY(packets.empty());
+}
+
+void CoalescedPacketsTests::fullDatagramTest() {
+    auto coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+    auto bigPacket = createPacket(QByteArray(ControlPacket::maxPayloadSize() / 2, 'a'), SequenceNumber(1));
+    QVERIFY(Socket::coalescePacket(*coalescedPacket, *bigPacket));
+
+    auto sizeBefore = coalescedPacket->getDataSize();
+    QVERIFY(!Socket::coalescePacket(*coalescedPacket, *bigPacket));
+    QCOMPARE(coalescedPacket->getDataSize(), sizeBefore);
+
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(Socket::splitCoalescedPackets(*receive(*coalescedPacket), packets));
+    QCOMPARE((int)packets.size(), 1);
+}
+
+void CoalescedPacketsTests::truncatedTest() {
+    auto coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+    QVERIFY(Socket::coalescePacket(*coalescedPacket, *createPacket("first", SequenceNumber(1))));
+    QVERIFY(Socket::coalescePacket(*coalescedPacket, *createPacket("second", SequenceNumber(2))));
+
+    // the first packet is whole, but it is dropped along with the second
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(!Socket::splitCoalescedPackets(*receive(*coalescedPacket, coalescedPacket->getDataSize() - 1), packets));
+    QVERIFY(packets.empty());
+}
+
+void CoalescedPacketsTests::truncatedSizeTest() {
+    auto coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+    QVERIFY(Socket::coalescePacket(*coalescedPacket, *createPacket("first", SequenceNumber(1))));
+    coalescedPacket->writePrimitive((uint8_t)0);
+
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(!Socket::splitCoalescedPackets(*receive(*coalescedPacket), packets));
+    QVERIFY(packets.empty());
+}
+
+void CoalescedPacketsTests::undersizedPacketTest() {
+    auto coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+    coalescedPacket->writePrimitive((uint16_t)(Packet::totalHeaderSize() - 1));
+    coalescedPacket->write(QByteArray(Packet::totalHeaderSize() - 1, '\0'));
+
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(!Socket::splitCoalescedPackets(*receive(*coalescedPacket), packets));
+    QVERIFY(packets.empty());
+}
+
+void CoalescedPacketsTests::reliablePacketTest() {
+    auto coalescedPacket = ControlPacket::create(ControlPacket::CoalescedPackets);
+    QVERIFY(Socket::coalescePacket(*coalescedPacket, *createPacket("unreliable", SequenceNumber(1))));
+    // coalescePacket doesn't check, writeCoalescedPacket never passes it a reliable packet
+    QVERIFY(Socket::coalescePacket(*coalescedPacket, *createPacket("reliable", SequenceNumber(2), true)));
+
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(!Socket::splitCoalescedPackets(*receive(*coalescedPacket), packets));
+    QVERIFY(packets.empty());
+}
@@ -0,0 +1,32 @@
+//
+//  CoalescedPacketsTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_CoalescedPacketsTests_h
+#define hifi_CoalescedPacketsTests_h
+
+#include <QtTest/QtTest>
+
+class CoalescedPacketsTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Packets coalesced into a datagram come back out of it unchanged and in order
+    void roundTripTest();
+    void emptyTest();
+    // A packet that doesn't fit leaves the datagram as it was
+    void fullDatagramTest();
+
+    // Datagrams that didn't come from coalescing are dropped whole
+    void truncatedTest();
+    void truncatedSizeTest();
+    void undersizedPacketTest();
+    void reliablePacketTest();
+};
+
+#endif // hifi_CoalescedPacketsTests_h
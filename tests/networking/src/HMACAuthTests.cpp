@@ -0,0 +1,110 @@
+//
+//  HMACAuthTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "HMACAuthTests.h"
+
+#include <HMACAuth.h>
+#include <NLPacket.h>
+
+QTEST_MAIN(HMACAuthTests)
+
+Q_DECLARE_METATYPE(HMACAuth::AuthMethod)
+
+// Typical sizes of a silent frame, a compressed mic frame and a full MTU packet
+static const int PACKET_PAYLOAD_SIZES[] = { 16, 160, 1400 };
+
+void HMACAuthTests::sipHashVectorTest() {
+    // reference vectors from the SipHash-2-4 128-bit output test suite: key 00..0f, message 00..(n-1)
+    char key[16];
+    char message[16];
+    for (int i = 0; i < 16; ++i) {
+        key[i] = (char)i;
+        message[i] = (char)i;
+    }
+
+    HMACAuth auth(HMACAuth::SIPHASH_2_4);
+    QVERIFY(auth.setKey(key, sizeof(key)));
+
+    HMACAuth::HMACHash hash;
+    QVERIFY(auth.calculateHash(hash, message, 0));
+    QCOMPARE(QByteArray((const char*)hash.data(), (int)hash.size()).toHex(),
+             QByteArray("a3817f04ba25a8e66df67214c7550293"));
+
+    QVERIFY(auth.calculateHash(hash, message, 1));
+    QCOMPARE(QByteArray((const char*)hash.data(), (int)hash.size()).toHex(),
+             QByteArray("da87c1d86b99af44347659119b22fc45"));
+
+    // the incremental interface must agree with the one-shot one
+    auth.addData(message, 7);
+    auth.addData(message + 7, 8);
+    HMACAuth::HMACHash incrementalHash = auth.result();
+    QVERIFY(auth.calculateHash(hash, message, 15));
+    QVERIFY(incrementalHash == hash);
+}
+
+void HMACAuthTests::packetVerificationTest() {
+    QUuid connectionSecret = QUuid::createUuid();
+
+    HMACAuth senderAuth(HMACAuth::SIPHASH_2_4);
+    HMACAuth receiverAuth(HMACAuth::SIPHASH_2_4);
+    senderAuth.setKey(connectionSecret);
+    receiverAuth.setKey(connectionSecret);
+
+    auto packet = NLPacket::create(PacketType::MicrophoneAudioNoEcho);
+    packet->write(QByteArray(160, 'x'));
+    packet->writeSourceID(1);
+    packet->writeVerificationHash(senderAuth);
+
+    QVERIFY(NLPacket::verificationHashMatches(*packet, receiverAuth));
+    QCOMPARE(NLPacket::verificationHashInHeader(*packet), NLPacket::hashForPacketAndHMAC(*packet, receiverAuth));
+
+    // a tampered payload must be rejected
+    packet->getPayload()[0] = 'y';
+    QVERIFY(!NLPacket::verificationHashMatches(*packet, receiverAuth));
+
+    // as must a packet signed with another secret
+    HMACAuth otherAuth(HMACAuth::SIPHASH_2_4);
+    otherAuth.setKey(QUuid::createUuid());
+    packet->writeVerificationHash(otherAuth);
+    QVERIFY(!NLPacket::verificationHashMatches(*packet, receiverAuth));
+}
+
+void HMACAuthTests::packetVerificationBenchmark_data() {
+    QTest::addColumn<HMACAuth::AuthMethod>("authMethod");
+    QTest::addColumn<int>("payloadSize");
+
+    for (int payloadSize : PACKET_PAYLOAD_SIZES) {
+        QTest::newRow(qPrintable(QString("HMAC-MD5 %1B").arg(payloadSize))) << HMACAuth::MD5 << payloadSize;
+        QTest::newRow(qPrintable(QString("SipHash-2-4 %1B").arg(payloadSize))) << HMACAuth::SIPHASH_2_4 << payloadSize;
+    }
+}
+
+// Signs and verifies one packet per iteration, i.e. the per-packet work done by a sender and a receiver
+void HMACAuthTests::packetVerificationBenchmark() {
+    QFETCH(HMACAuth::AuthMethod, authMethod);
+    QFETCH(int, payloadSize);
+
+    QUuid connectionSecret = QUuid::createUuid();
+    HMACAuth senderAuth(authMethod);
+    HMACAuth receiverAuth(authMethod);
+    senderAuth.setKey(connectionSecret);
+    receiverAuth.setKey(connectionSecret);
+
+    auto packet = NLPacket::create(PacketType::MicrophoneAudioNoEcho);
+    packet->write(QByteArray(payloadSize, 'x'));
+    packet->writeSourceID(1);
+
+    bool verified = true;
+    QBENCHMARK {
+        packet->writeVerificationHash(senderAuth);
+        verified &= NLPacket::verificationHashMatches(*packet, receiverAuth);
+    }
+    QVERIFY(verified);
+}
@@ -0,0 +1,25 @@
+//
+//  HMACAuthTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_HMACAuthTests_h
+#define hifi_HMACAuthTests_h
+
+#include <QtTest/QtTest>
+
+class HMACAuthTests : public QObject {
+    Q_OBJECT
+private slots:
+    void sipHashVectorTest();
+    void packetVerificationTest();
+    void packetVerificationBenchmark_data();
+    void packetVerificationBenchmark();
+};
+
+#endif // hifi_HMACAuthTests_h
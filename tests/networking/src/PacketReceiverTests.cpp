@@ -0,0 +1,123 @@
+//
+//  PacketReceiverTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketReceiverTests.h"
+
+#include <NumericalConstants.h>
+#include <PacketReceiver.h>
+
+QTEST_MAIN(PacketReceiverTests)
+
+// a non-sourced type, so that dispatch doesn't need a node list to look the sender up in
+static const PacketType TEST_PACKET_TYPE = PacketType::ReplicatedMicrophoneAudioNoEcho;
+
+static std::unique_ptr<udt::Packet> createTestPacket() {
+    auto packet = NLPacket::create(TEST_PACKET_TYPE);
+    packet->write(QByteArray(160, 'x'));
+    return std::move(packet);
+}
+
+void PacketReceiverTests::typedListenerTest() {
+    PacketReceiver packetReceiver;
+    PacketCountingListener listener;
+
+    int messagesReceived = 0;
+    QVERIFY(packetReceiver.registerListener(TEST_PACKET_TYPE, &listener,
+        [&](QSharedPointer<ReceivedMessage> message, QSharedPointer<Node> node) {
+            QCOMPARE(message->getType(), TEST_PACKET_TYPE);
+            QCOMPARE(message->getSize(), (qint64)160);
+            ++messagesReceived;
+        }, PacketReceiver::ListenerDelivery::Direct));
+
+    packetReceiver.handleVerifiedPacket(createTestPacket());
+    packetReceiver.handleVerifiedPacket(createTestPacket());
+    QCOMPARE(messagesReceived, 2);
+
+    // once the context is gone so is the listener
+    packetReceiver.unregisterListener(&listener);
+    packetReceiver.handleVerifiedPacket(createTestPacket());
+    QCOMPARE(messagesReceived, 2);
+}
+
+void PacketReceiverTests::queuedTypedListenerTest() {
+    PacketReceiver packetReceiver;
+    PacketCountingListener listener;
+
+    QVERIFY(packetReceiver.registerListener(TEST_PACKET_TYPE, &listener,
+        [&](QSharedPointer<ReceivedMessage> message, QSharedPointer<Node> node) {
+            listener.handleMessage(message);
+        }, PacketReceiver::ListenerDelivery::Queued));
+
+    packetReceiver.handleVerifiedPacket(createTestPacket());
+
+    // queued delivery waits for the context's event loop
+    QCOMPARE(listener.messagesReceived, 0);
+    QCoreApplication::processEvents();
+    QCOMPARE(listener.messagesReceived, 1);
+}
+
+void PacketReceiverTests::queuedHandlerTimeTest() {
+    static const unsigned long HANDLER_MSECS = 20;
+
+    PacketReceiver packetReceiver;
+    PacketCountingListener listener;
+
+    QVERIFY(packetReceiver.registerListener(TEST_PACKET_TYPE, &listener,
+        [&](QSharedPointer<ReceivedMessage> message, QSharedPointer<Node> node) {
+            QThread::msleep(HANDLER_MSECS);
+            listener.handleMessage(message);
+        }, PacketReceiver::ListenerDelivery::Queued));
+
+    packetReceiver.handleVerifiedPacket(createTestPacket());
+
+    auto& metaObject = PacketTypeEnum::staticMetaObject;
+    auto typeName = QString(metaObject.enumerator(metaObject.enumeratorOffset()).valueToKey((int)TEST_PACKET_TYPE));
+    auto typeStats = packetReceiver.takePacketTypeStats()[typeName].toObject();
+    QCOMPARE(typeStats["in_packets"].toInt(), 1);
+    QVERIFY(!typeStats.contains("handler_calls"));
+
+    QCoreApplication::processEvents();
+    QCOMPARE(listener.messagesReceived, 1);
+
+    typeStats = packetReceiver.takePacketTypeStats()[typeName].toObject();
+    QCOMPARE(typeStats["handler_calls"].toInt(), 1);
+    QVERIFY(typeStats["handler_usecs_max"].toDouble() >= HANDLER_MSECS * USECS_PER_MSEC);
+}
+
+void PacketReceiverTests::dispatchBenchmark_data() {
+    QTest::addColumn<bool>("typedListener");
+
+    QTest::newRow("QMetaMethod slot") << false;
+    QTest::newRow("typed direct callback") << true;
+}
+
+// Both listeners live on the receiving thread, so each iteration is one packet wrapped in a
+// ReceivedMessage and delivered synchronously - the difference is the dispatch mechanism
+void PacketReceiverTests::dispatchBenchmark() {
+    QFETCH(bool, typedListener);
+
+    PacketReceiver packetReceiver;
+    PacketCountingListener listener;
+
+    if (typedListener) {
+        packetReceiver.registerListener(TEST_PACKET_TYPE, &listener,
+            [&](QSharedPointer<ReceivedMessage> message, QSharedPointer<Node> node) {
+                listener.handleMessage(message);
+            }, PacketReceiver::ListenerDelivery::Direct);
+    } else {
+        packetReceiver.registerListener(TEST_PACKET_TYPE, &listener, "handleMessage");
+    }
+
+    QBENCHMARK {
+        packetReceiver.handleVerifiedPacket(createTestPacket());
+    }
+
+    QVERIFY(listener.messagesReceived > 0);
+}
@@ -0,0 +1,38 @@
+//
+//  PacketReceiverTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketReceiverTests_h
+#define hifi_PacketReceiverTests_h
+
+#include <QtTest/QtTest>
+
+#include <ReceivedMessage.h>
+
+class PacketCountingListener : public QObject {
+    Q_OBJECT
+public:
+    int messagesReceived { 0 };
+
+public slots:
+    void handleMessage(QSharedPointer<ReceivedMessage> message) { ++messagesReceived; }
+};
+
+class PacketReceiverTests : public QObject {
+    Q_OBJECT
+private slots:
+    void typedListenerTest();
+    void queuedTypedListenerTest();
+    // The handler time of a queued listener is the time it takes to handle the message, not to queue it
+    void queuedHandlerTimeTest();
+    void dispatchBenchmark_data();
+    void dispatchBenchmark();
+};
+
+#endif // hifi_PacketReceiverTests_h
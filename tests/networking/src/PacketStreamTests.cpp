@@ -0,0 +1,204 @@
+//
+//  PacketStreamTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketStreamTests.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+
+#include <QTemporaryFile>
+
+#include <udt/PacketList.h>
+#include <udt/PacketQueue.h>
+
+QTEST_MAIN(PacketStreamTests)
+
+static const QByteArray TEST_HEADER(40, 'h');
+
+static QByteArray createTestData(int size) {
+    QByteArray data(size, 0);
+    for (int i = 0; i < size; ++i) {
+        data[i] = (char)(i * 31 + 7);
+    }
+    return data;
+}
+
+// writes the data to the list as it asks for it, keeping track of how much it was asked for
+static udt::PacketList::Source createSource(const char* data, qint64 size, qint64& bytesWritten) {
+    return [data, size, &bytesWritten](udt::PacketList& packetList, qint64 maxSize) {
+        qint64 bytesToWrite = std::min(maxSize, size - bytesWritten);
+        if (bytesToWrite <= 0) {
+            return (qint64)0;
+        }
+        packetList.write(data + bytesWritten, bytesToWrite);
+        bytesWritten += bytesToWrite;
+        return bytesToWrite;
+    };
+}
+
+void PacketStreamTests::streamedMessageTest() {
+    const int PAYLOAD_SIZE = udt::Packet::maxPayloadSize(true);
+    QByteArray data = createTestData(100 * PAYLOAD_SIZE + 17);
+
+    auto packetList = udt::PacketList::create(PacketType::AssetGetReply, QByteArray(), true, true);
+    packetList->write(TEST_HEADER);
+    qint64 bytesWritten = 0;
+    packetList->setSource(createSource(data.constData(), data.size(), bytesWritten));
+    QVERIFY(packetList->isStreamed());
+
+    udt::PacketQueue packetQueue;
+    packetQueue.queuePacketList(std::move(packetList));
+    QCOMPARE(bytesWritten, (qint64)0);
+
+    QByteArray message;
+    udt::Packet::MessagePartNumber expectedPartNumber = 0;
+    udt::Packet::PacketPosition lastPosition = udt::Packet::PacketPosition::ONLY;
+    while (!packetQueue.isEmpty()) {
+        auto packet = packetQueue.takePacket();
+        QVERIFY(packet);
+        QVERIFY(packet->isPartOfMessage());
+        QCOMPARE(packet->getMessagePartNumber(), expectedPartNumber);
+        lastPosition = packet->getPacketPosition();
+        if (expectedPartNumber == 0) {
+            QCOMPARE(lastPosition, udt::Packet::PacketPosition::FIRST);
+        } else if (!packetQueue.isEmpty()) {
+            QCOMPARE(lastPosition, udt::Packet::PacketPosition::MIDDLE);
+        }
+        message.append(packet->getPayload(), (int)packet->getPayloadSize());
+        ++expectedPartNumber;
+
+        // only ever a couple of packets ahead of the queue
+        QVERIFY(bytesWritten + TEST_HEADER.size() <= message.size() + 2 * PAYLOAD_SIZE);
+    }
+    QCOMPARE(lastPosition, udt::Packet::PacketPosition::LAST);
+    QCOMPARE(message, TEST_HEADER + data);
+}
+
+void PacketStreamTests::singlePacketStreamTest() {
+    QByteArray data = createTestData(100);
+
+    auto packetList = udt::PacketList::create(PacketType::AssetGetReply, QByteArray(), true, true);
+    packetList->write(TEST_HEADER);
+    qint64 bytesWritten = 0;
+    packetList->setSource(createSource(data.constData(), data.size(), bytesWritten));
+
+    udt::PacketQueue packetQueue;
+    packetQueue.queuePacketList(std::move(packetList));
+
+    auto packet = packetQueue.takePacket();
+    QVERIFY(packet);
+    QCOMPARE(packet->getPacketPosition(), udt::Packet::PacketPosition::ONLY);
+    QCOMPARE(QByteArray(packet->getPayload(), (int)packet->getPayloadSize()), TEST_HEADER + data);
+    QVERIFY(packetQueue.isEmpty());
+}
+
+void PacketStreamTests::sourceOutsideLockTest() {
+    const int PAYLOAD_SIZE = udt::Packet::maxPayloadSize(true);
+    QByteArray data = createTestData(10 * PAYLOAD_SIZE);
+
+    udt::PacketQueue packetQueue;
+    auto packetList = udt::PacketList::create(PacketType::AssetGetReply, QByteArray(), true, true);
+    qint64 bytesWritten = 0;
+    auto source = createSource(data.constData(), data.size(), bytesWritten);
+    int numLockedWrites = 0;
+    packetList->setSource([&](udt::PacketList& list, qint64 maxSize) {
+        // as another thread would while the send queue is busy with the source
+        auto isLocked = std::async(std::launch::async, [&] {
+            std::unique_lock<std::recursive_mutex> lock(packetQueue.getLock(), std::try_to_lock);
+            return !lock.owns_lock();
+        });
+        if (isLocked.get()) {
+            ++numLockedWrites;
+        }
+        return source(list, maxSize);
+    });
+    packetQueue.queuePacketList(std::move(packetList));
+
+    int numPackets = 0;
+    while (!packetQueue.isEmpty()) {
+        QVERIFY(packetQueue.takePacket());
+        ++numPackets;
+    }
+    QVERIFY(numPackets >= 10);
+    QCOMPARE(bytesWritten, (qint64)data.size());
+    QCOMPARE(numLockedWrites, 0);
+}
+
+void PacketStreamTests::concurrentTransferBenchmark_data() {
+    QTest::addColumn<bool>("streamed");
+
+    QTest::newRow("written up front") << false;
+    QTest::newRow("streamed from mapped file") << true;
+}
+
+// Each iteration sends the asset to every client, one packet per client in turn, with each client acknowledging its
+// packets a flow window behind. Memory is what was read from the asset and not acknowledged yet, at its highest.
+void PacketStreamTests::concurrentTransferBenchmark() {
+    QFETCH(bool, streamed);
+    const int NUM_CLIENTS = 50;
+    const int ASSET_SIZE = 2 * 1024 * 1024;
+    const int FLOW_WINDOW_SIZE = 64;
+    const int PAYLOAD_SIZE = udt::Packet::maxPayloadSize(true);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(createTestData(ASSET_SIZE));
+    file.flush();
+    const uchar* mappedData = file.map(0, ASSET_SIZE);
+    QVERIFY(mappedData);
+
+    qint64 peakBytesInMemory = 0;
+    QBENCHMARK {
+        std::vector<std::unique_ptr<udt::PacketQueue>> packetQueues;
+        std::vector<qint64> bytesRead(NUM_CLIENTS, 0);
+        for (int i = 0; i < NUM_CLIENTS; ++i) {
+            auto packetList = udt::PacketList::create(PacketType::AssetGetReply, QByteArray(), true, true);
+            packetList->write(TEST_HEADER);
+            if (streamed) {
+                packetList->setSource(createSource(reinterpret_cast<const char*>(mappedData), ASSET_SIZE, bytesRead[i]));
+            } else {
+                file.seek(0);
+                packetList->write(file.read(ASSET_SIZE));
+                bytesRead[i] = ASSET_SIZE;
+                packetList->closeCurrentPacket();
+            }
+            packetQueues.emplace_back(new udt::PacketQueue());
+            packetQueues.back()->queuePacketList(std::move(packetList));
+        }
+
+        std::vector<std::deque<qint64>> inFlight(NUM_CLIENTS);
+        std::vector<qint64> bytesAcknowledged(NUM_CLIENTS, 0);
+        bool isSending = true;
+        while (isSending) {
+            isSending = false;
+            qint64 bytesInMemory = 0;
+            for (int i = 0; i < NUM_CLIENTS; ++i) {
+                bool isDone = packetQueues[i]->isEmpty();
+                if (!isDone) {
+                    inFlight[i].push_back(packetQueues[i]->takePacket()->getPayloadSize());
+                }
+                // once done sending, the client catches up on its acknowledgements
+                if (!inFlight[i].empty() && ((int)inFlight[i].size() > FLOW_WINDOW_SIZE || isDone)) {
+                    bytesAcknowledged[i] += inFlight[i].front();
+                    inFlight[i].pop_front();
+                }
+                isSending = isSending || !isDone || !inFlight[i].empty();
+                bytesInMemory += bytesRead[i] + TEST_HEADER.size() - bytesAcknowledged[i];
+            }
+            peakBytesInMemory = std::max(peakBytesInMemory, bytesInMemory);
+        }
+    }
+
+    qDebug() << "Peak asset bytes in memory for" << NUM_CLIENTS << "clients:" << peakBytesInMemory;
+    if (streamed) {
+        QVERIFY(peakBytesInMemory <= (qint64)NUM_CLIENTS * (FLOW_WINDOW_SIZE + 3) * PAYLOAD_SIZE);
+    }
+}
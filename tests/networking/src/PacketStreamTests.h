@@ -0,0 +1,30 @@
+//
+//  PacketStreamTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketStreamTests_h
+#define hifi_PacketStreamTests_h
+
+#include <QtTest/QtTest>
+
+class PacketStreamTests : public QObject {
+    Q_OBJECT
+private slots:
+    // A streamed packet list comes out of the queue as one ordered message, written as it's taken
+    void streamedMessageTest();
+    void singlePacketStreamTest();
+    // The queue can be added to while a streamed packet gets written
+    void sourceOutsideLockTest();
+
+    // Many transfers of the same large asset, as the asset server serves them
+    void concurrentTransferBenchmark_data();
+    void concurrentTransferBenchmark();
+};
+
+#endif // hifi_PacketStreamTests_h
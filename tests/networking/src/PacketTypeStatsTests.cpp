@@ -0,0 +1,141 @@
+//
+//  PacketTypeStatsTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketTypeStatsTests.h"
+
+#include <thread>
+
+#include <NumericalConstants.h>
+#include <PacketTypeStats.h>
+
+QTEST_MAIN(PacketTypeStatsTests)
+
+static QString nameOf(PacketType type) {
+    auto& metaObject = PacketTypeEnum::staticMetaObject;
+    return metaObject.enumerator(metaObject.enumeratorOffset()).valueToKey((int)type);
+}
+
+void PacketTypeStatsTests::countersTest() {
+    PacketTypeStats stats;
+    stats.recordInbound(PacketType::EntityEdit, 100);
+    stats.recordInbound(PacketType::EntityEdit, 50);
+    stats.recordOutbound(PacketType::EntityEdit, 20);
+    stats.recordOutbound(PacketType::Ping, 8);
+
+    auto statsObject = stats.takeStats();
+    QCOMPARE(statsObject.size(), 2);
+
+    auto editStats = statsObject[nameOf(PacketType::EntityEdit)].toObject();
+    QCOMPARE(editStats["in_packets"].toInt(), 2);
+    QCOMPARE(editStats["in_bytes"].toInt(), 150);
+    QCOMPARE(editStats["out_packets"].toInt(), 1);
+    QCOMPARE(editStats["out_bytes"].toInt(), 20);
+    QVERIFY(!editStats.contains("handler_calls"));
+
+    auto pingStats = statsObject[nameOf(PacketType::Ping)].toObject();
+    QCOMPARE(pingStats["in_packets"].toInt(), 0);
+    QCOMPARE(pingStats["out_packets"].toInt(), 1);
+    QCOMPARE(pingStats["out_bytes"].toInt(), 8);
+}
+
+void PacketTypeStatsTests::takeResetsTest() {
+    PacketTypeStats stats;
+    stats.recordInbound(PacketType::EntityEdit, 100);
+    stats.recordHandlerTime(PacketType::EntityEdit, 10);
+    QCOMPARE(stats.takeStats().size(), 1);
+
+    QVERIFY(stats.takeStats().isEmpty());
+
+    stats.recordInbound(PacketType::EntityEdit, 30);
+    auto editStats = stats.takeStats()[nameOf(PacketType::EntityEdit)].toObject();
+    QCOMPARE(editStats["in_packets"].toInt(), 1);
+    QCOMPARE(editStats["in_bytes"].toInt(), 30);
+    QVERIFY(!editStats.contains("handler_calls"));
+}
+
+void PacketTypeStatsTests::handlerTimeTest() {
+    PacketTypeStats stats;
+    stats.recordHandlerTime(PacketType::AvatarData, 10);
+    stats.recordHandlerTime(PacketType::AvatarData, 30);
+    stats.recordHandlerTime(PacketType::AvatarData, 20);
+
+    auto avatarStats = stats.takeStats()[nameOf(PacketType::AvatarData)].toObject();
+    QCOMPARE(avatarStats["handler_calls"].toInt(), 3);
+    QCOMPARE(avatarStats["handler_usecs_total"].toInt(), 60);
+    QCOMPARE(avatarStats["handler_usecs_avg"].toDouble(), 20.0);
+    QCOMPARE(avatarStats["handler_usecs_max"].toInt(), 30);
+
+    // the max starts over too
+    stats.recordHandlerTime(PacketType::AvatarData, 5);
+    avatarStats = stats.takeStats()[nameOf(PacketType::AvatarData)].toObject();
+    QCOMPARE(avatarStats["handler_usecs_max"].toInt(), 5);
+}
+
+void PacketTypeStatsTests::handlerTimeHistogramTest() {
+    PacketTypeStats stats;
+    stats.recordHandlerTime(PacketType::AvatarData, 0);
+    stats.recordHandlerTime(PacketType::AvatarData, 1);
+    stats.recordHandlerTime(PacketType::AvatarData, 3);
+    stats.recordHandlerTime(PacketType::AvatarData, 3);
+    stats.recordHandlerTime(PacketType::AvatarData, 4);
+    // way past the last bucket
+    stats.recordHandlerTime(PacketType::AvatarData, USECS_PER_SECOND);
+
+    auto histogram = stats.takeStats()[nameOf(PacketType::AvatarData)].toObject()["handler_usecs_histogram"].toObject();
+    QCOMPARE(histogram["<1"].toInt(), 1);
+    QCOMPARE(histogram["<2"].toInt(), 1);
+    QCOMPARE(histogram["<4"].toInt(), 2);
+    QCOMPARE(histogram["<8"].toInt(), 1);
+    const int lastBucket = PacketTypeStats::NUM_HANDLER_TIME_BUCKETS - 1;
+    QCOMPARE(histogram[QString(">=%1").arg(1 << (lastBucket - 1))].toInt(), 1);
+    QCOMPARE(histogram.size(), 5);
+}
+
+void PacketTypeStatsTests::listenerNameTest() {
+    PacketTypeStats stats;
+    stats.recordInbound(PacketType::EntityEdit, 100);
+    stats.recordInbound(PacketType::Ping, 8);
+
+    QHash<PacketType, QString> listenerNames;
+    listenerNames[PacketType::EntityEdit] = "EntityServer::handleEntityPacket";
+    // no traffic, no entry
+    listenerNames[PacketType::AvatarData] = "AvatarMixer::handleAvatarDataPacket";
+
+    auto statsObject = stats.takeStats(listenerNames);
+    QCOMPARE(statsObject.size(), 2);
+    QCOMPARE(statsObject[nameOf(PacketType::EntityEdit)].toObject()["listener"].toString(),
+             QString("EntityServer::handleEntityPacket"));
+    QVERIFY(!statsObject[nameOf(PacketType::Ping)].toObject().contains("listener"));
+}
+
+void PacketTypeStatsTests::concurrentRecordTest() {
+    static const int NUM_THREADS = 4;
+    static const int NUM_RECORDS = 10000;
+
+    PacketTypeStats stats;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads.emplace_back([&stats] {
+            for (int j = 0; j < NUM_RECORDS; ++j) {
+                stats.recordInbound(PacketType::AvatarData, 2);
+                stats.recordHandlerTime(PacketType::AvatarData, 1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto avatarStats = stats.takeStats()[nameOf(PacketType::AvatarData)].toObject();
+    QCOMPARE(avatarStats["in_packets"].toInt(), NUM_THREADS * NUM_RECORDS);
+    QCOMPARE(avatarStats["in_bytes"].toInt(), 2 * NUM_THREADS * NUM_RECORDS);
+    QCOMPARE(avatarStats["handler_calls"].toInt(), NUM_THREADS * NUM_RECORDS);
+    QCOMPARE(avatarStats["handler_usecs_histogram"].toObject()["<2"].toInt(), NUM_THREADS * NUM_RECORDS);
+}
@@ -0,0 +1,29 @@
+//
+//  PacketTypeStatsTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketTypeStatsTests_h
+#define hifi_PacketTypeStatsTests_h
+
+#include <QtTest/QtTest>
+
+class PacketTypeStatsTests : public QObject {
+    Q_OBJECT
+private slots:
+    void countersTest();
+    // Taking the stats resets them, and types without traffic are left out
+    void takeResetsTest();
+    void handlerTimeTest();
+    void handlerTimeHistogramTest();
+    void listenerNameTest();
+    // Counts from several threads at once all add up
+    void concurrentRecordTest();
+};
+
+#endif // hifi_PacketTypeStatsTests_h
@@ -0,0 +1,79 @@
+//
+//  ResourceProcessingPoolTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ResourceProcessingPoolTests.h"
+
+#include <atomic>
+#include <mutex>
+
+#include <ResourceProcessingPool.h>
+
+QTEST_MAIN(ResourceProcessingPoolTests)
+
+void ResourceProcessingPoolTests::typeTurnsTest() {
+    auto& pool = ResourceProcessingPool::getInstance();
+    pool.setMaxThreadCount(1);
+
+    // hold the only thread while the tasks are queued
+    std::atomic<bool> isBlocked { true };
+    pool.start("Blocker", [&] {
+        while (isBlocked) {
+            QThread::msleep(1);
+        }
+    }, 0);
+
+    std::mutex mutex;
+    QStringList order;
+    auto queue = [&](const QString& type) {
+        pool.start(type, [&, type] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.append(type);
+        }, 0);
+    };
+    for (int i = 0; i < 3; ++i) {
+        queue("Texture");
+    }
+    queue("Model");
+    queue("Sound");
+    QCOMPARE(pool.getNumQueuedTasks(), 5);
+
+    isBlocked = false;
+    QTRY_COMPARE(pool.getNumQueuedTasks(), 0);
+    pool.clear();
+    QCOMPARE(order, QStringList({ "Texture", "Model", "Sound", "Texture", "Texture" }));
+}
+
+void ResourceProcessingPoolTests::memoryBudgetTest() {
+    auto& pool = ResourceProcessingPool::getInstance();
+    pool.setMaxThreadCount(4);
+    pool.setMemoryBudget(100);
+
+    std::atomic<bool> isBlocked { true };
+    std::atomic<int> numStarted { 0 };
+    auto task = [&] {
+        ++numStarted;
+        while (isBlocked) {
+            QThread::msleep(1);
+        }
+    };
+    // the first runs even though it's over budget, the others wait for it
+    pool.start("Texture", task, 150);
+    pool.start("Texture", task, 60);
+    pool.start("Model", task, 30);
+    QTRY_COMPARE(numStarted.load(), 1);
+    QTest::qWait(50);
+    QCOMPARE(numStarted.load(), 1);
+    QCOMPARE(pool.getNumBytesInFlight(), (qint64)150);
+
+    isBlocked = false;
+    QTRY_COMPARE(numStarted.load(), 3);
+    pool.clear();
+    QCOMPARE(pool.getNumBytesInFlight(), (qint64)0);
+}
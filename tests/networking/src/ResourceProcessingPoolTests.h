@@ -0,0 +1,25 @@
+//
+//  ResourceProcessingPoolTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ResourceProcessingPoolTests_h
+#define hifi_ResourceProcessingPoolTests_h
+
+#include <QtTest/QtTest>
+
+class ResourceProcessingPoolTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Types take turns, whatever order their tasks were queued in
+    void typeTurnsTest();
+    // Tasks wait while the memory of the running ones is over budget
+    void memoryBudgetTest();
+};
+
+#endif // hifi_ResourceProcessingPoolTests_h
@@ -0,0 +1,206 @@
+//
+//  ResourceSchedulingTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ResourceSchedulingTests.h"
+
+#include <QtCore/QTemporaryDir>
+
+#include <DependencyManager.h>
+#include <LimitedNodeList.h>
+#include <NodeList.h>
+#include <ResourceCache.h>
+#include <ResourceRequestObserver.h>
+#include <StatTracker.h>
+
+QTEST_MAIN(ResourceSchedulingTests)
+
+static const QString TEST_TEXTURE_TYPE = "TestTexture";
+static const QString TEST_MODEL_TYPE = "TestModel";
+
+class TestResource : public Resource {
+public:
+    TestResource(const QUrl& url, const QString& type) : Resource(url), _type(type) {}
+
+    QString getType() const override { return _type; }
+
+private:
+    QString _type;
+};
+
+static QSharedPointer<Resource> createResource(const QString& type, const QUrl& url = QUrl("file:///test")) {
+    auto resource = QSharedPointer<TestResource>::create(url, type);
+    resource->setSelf(resource);
+    return resource;
+}
+
+void ResourceSchedulingTests::initTestCase() {
+    DependencyManager::set<StatTracker>();
+    DependencyManager::set<ResourceRequestObserver>();
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<NodeList>(NodeType::Agent, INVALID_PORT);
+    DependencyManager::set<ResourceManager>();
+}
+
+void ResourceSchedulingTests::init() {
+    DependencyManager::set<ResourceCacheSharedItems>();
+}
+
+void ResourceSchedulingTests::cleanupTestCase() {
+    DependencyManager::get<ResourceManager>()->cleanup();
+}
+
+void ResourceSchedulingTests::priorityOrderTest() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    sharedItems->setRequestLimit(1);
+    QObject owner;
+
+    auto loading = createResource(TEST_MODEL_TYPE);
+    QVERIFY(sharedItems->appendRequest(loading));
+
+    auto low = createResource(TEST_MODEL_TYPE);
+    low->setLoadPriority(&owner, 1.0f);
+    auto high = createResource(TEST_MODEL_TYPE);
+    high->setLoadPriority(&owner, 3.0f);
+    auto middle = createResource(TEST_MODEL_TYPE);
+    middle->setLoadPriority(&owner, 2.0f);
+    auto freed = createResource(TEST_MODEL_TYPE);
+    freed->setLoadPriority(&owner, 4.0f);
+    for (auto& resource : { low, high, middle, freed }) {
+        QVERIFY(!sharedItems->appendRequest(resource));
+    }
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)4);
+
+    // nothing is taken while the requests are all in use
+    QVERIFY(!sharedItems->getHighestPendingRequest());
+    sharedItems->removeRequest(loading);
+
+    // the queue follows priorities that change while waiting
+    high->setLoadPriority(&owner, 0.0f);
+    freed.clear();
+    QCOMPARE(sharedItems->getHighestPendingRequest(), middle);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), low);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), high);
+    QVERIFY(!sharedItems->getHighestPendingRequest());
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)0);
+}
+
+void ResourceSchedulingTests::requestBudgetTest() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    sharedItems->setRequestLimit(4);
+    sharedItems->setRequestBudget(TEST_TEXTURE_TYPE, 0.5f);
+
+    // with nothing else to load, textures get more than their budget
+    QList<QSharedPointer<Resource>> textures;
+    int numLoading = 0;
+    for (int i = 0; i < 6; ++i) {
+        textures.append(createResource(TEST_TEXTURE_TYPE));
+        numLoading += sharedItems->appendRequest(textures.last()) ? 1 : 0;
+    }
+    QCOMPARE(numLoading, 4);
+
+    // they give the requests back to the other types as they finish
+    auto model = createResource(TEST_MODEL_TYPE);
+    QVERIFY(!sharedItems->appendRequest(model));
+    sharedItems->removeRequest(textures[0]);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), model);
+    QVERIFY(sharedItems->appendRequest(model));
+
+    // and go over their budget again once no other type is waiting
+    sharedItems->removeRequest(textures[1]);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), textures[4]);
+    QVERIFY(sharedItems->appendRequest(textures[4]));
+    QVERIFY(!sharedItems->getHighestPendingRequest());
+    QCOMPARE(sharedItems->getLoadingRequestsCount(), (uint32_t)4);
+}
+
+void ResourceSchedulingTests::priorityAgingTest() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    sharedItems->setRequestLimit(1);
+    sharedItems->setPriorityAging(100.0f);
+    QObject owner;
+
+    auto loading = createResource(TEST_MODEL_TYPE);
+    QVERIFY(sharedItems->appendRequest(loading));
+
+    auto waiting = createResource(TEST_MODEL_TYPE);
+    waiting->setLoadPriority(&owner, 0.0f);
+    QVERIFY(!sharedItems->appendRequest(waiting));
+
+    // 50 ms of waiting is worth 5 of priority at this rate
+    QTest::qSleep(50);
+    auto recent = createResource(TEST_MODEL_TYPE);
+    recent->setLoadPriority(&owner, 2.0f);
+    QVERIFY(!sharedItems->appendRequest(recent));
+
+    sharedItems->removeRequest(loading);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), waiting);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), recent);
+}
+
+void ResourceSchedulingTests::firstUsableSceneBenchmark_data() {
+    QTest::addColumn<float>("textureBudget");
+
+    QTest::newRow("one limit for all types") << 1.0f;
+    QTest::newRow("per type budgets") << 0.75f;
+}
+
+void ResourceSchedulingTests::firstUsableSceneBenchmark() {
+    QFETCH(float, textureBudget);
+    const int NUM_TEXTURES = 64;
+    const int TEXTURE_SIZE = 4 * 1024 * 1024;
+    const int NUM_MODELS = 16;
+    const int MODEL_SIZE = 4 * 1024;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto writeFiles = [&](const QString& prefix, int numFiles, int size) {
+        QList<QUrl> urls;
+        QByteArray data(size, 'x');
+        for (int i = 0; i < numFiles; ++i) {
+            QFile file(dir.filePath(prefix + QString::number(i)));
+            if (file.open(QIODevice::WriteOnly) && file.write(data) == size) {
+                urls.append(QUrl::fromLocalFile(file.fileName()));
+            }
+        }
+        return urls;
+    };
+    auto textureURLs = writeFiles("texture", NUM_TEXTURES, TEXTURE_SIZE);
+    auto modelURLs = writeFiles("model", NUM_MODELS, MODEL_SIZE);
+    QCOMPARE(textureURLs.size(), NUM_TEXTURES);
+    QCOMPARE(modelURLs.size(), NUM_MODELS);
+
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    sharedItems->setRequestLimit(4);
+    sharedItems->setRequestBudget(TEST_TEXTURE_TYPE, textureBudget);
+
+    QBENCHMARK {
+        // the textures of the scene were asked for first, the scene can be shown once its models are in
+        QList<QSharedPointer<Resource>> resources;
+        int numModelsLoaded = 0;
+        for (const auto& url : textureURLs) {
+            resources.append(createResource(TEST_TEXTURE_TYPE, url));
+        }
+        for (const auto& url : modelURLs) {
+            resources.append(createResource(TEST_MODEL_TYPE, url));
+            connect(resources.last().data(), &Resource::finished, [&](bool success) {
+                QVERIFY(success);
+                ++numModelsLoaded;
+            });
+        }
+        for (auto& resource : resources) {
+            resource->ensureLoading();
+        }
+        QTRY_COMPARE_WITH_TIMEOUT(numModelsLoaded, NUM_MODELS, 60000);
+
+        // let the textures finish before the next round
+        QTRY_COMPARE_WITH_TIMEOUT(sharedItems->getLoadingRequestsCount() + sharedItems->getPendingRequestsCount(),
+                                  (uint32_t)0, 60000);
+    }
+}
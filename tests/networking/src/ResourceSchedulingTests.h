@@ -0,0 +1,32 @@
+//
+//  ResourceSchedulingTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ResourceSchedulingTests_h
+#define hifi_ResourceSchedulingTests_h
+
+#include <QtTest/QtTest>
+
+class ResourceSchedulingTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void init();
+    void priorityOrderTest();
+    void requestBudgetTest();
+    void priorityAgingTest();
+
+    // Time until the small resources of a scene have loaded from local files, queued behind its large textures
+    void firstUsableSceneBenchmark_data();
+    void firstUsableSceneBenchmark();
+
+    void cleanupTestCase();
+};
+
+#endif // hifi_ResourceSchedulingTests_h
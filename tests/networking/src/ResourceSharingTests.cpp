@@ -0,0 +1,117 @@
+//
+//  ResourceSharingTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ResourceSharingTests.h"
+
+#include <QtCore/QTemporaryDir>
+
+#include <DependencyManager.h>
+#include <LimitedNodeList.h>
+#include <NodeList.h>
+#include <ResourceCache.h>
+#include <ResourceRequestObserver.h>
+#include <StatTracker.h>
+
+QTEST_MAIN(ResourceSharingTests)
+
+class SharingResource : public Resource {
+public:
+    SharingResource(const QUrl& url) : Resource(url) {}
+
+    int getNumProcessed() const { return _numProcessed; }
+    bool isAdopted() const { return _isAdopted; }
+
+protected:
+    void downloadFinished(const QByteArray& data) override {
+        ++_numProcessed;
+        finishedLoading(true);
+    }
+
+    bool canShareContent() const override { return true; }
+
+    bool adoptContent(const Resource& original) override {
+        _isAdopted = true;
+        finishedLoading(true);
+        return true;
+    }
+
+private:
+    int _numProcessed { 0 };
+    bool _isAdopted { false };
+};
+
+class SharingResourceCache : public ResourceCache {
+public:
+    QSharedPointer<SharingResource> get(const QUrl& url) { return getResource(url).staticCast<SharingResource>(); }
+
+protected:
+    QSharedPointer<Resource> createResource(const QUrl& url) override {
+        return QSharedPointer<Resource>(new SharingResource(url), &Resource::deleter);
+    }
+
+    QSharedPointer<Resource> createResourceCopy(const QSharedPointer<Resource>& resource) override {
+        return QSharedPointer<Resource>(new SharingResource(resource->getURL()), &Resource::deleter);
+    }
+};
+
+void ResourceSharingTests::initTestCase() {
+    DependencyManager::set<StatTracker>();
+    DependencyManager::set<ResourceRequestObserver>();
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<NodeList>(NodeType::Agent, INVALID_PORT);
+    DependencyManager::set<ResourceCacheSharedItems>();
+    DependencyManager::set<ResourceManager>();
+}
+
+void ResourceSharingTests::cleanupTestCase() {
+    DependencyManager::get<ResourceManager>()->cleanup();
+}
+
+void ResourceSharingTests::sameContentTest() {
+    const QByteArray DATA(1024, 'x');
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QList<QUrl> urls;
+    for (const QString& fileName : { "original.dat", "mirror/original.dat", "copy.dat", "other.bin", "different.dat" }) {
+        QDir().mkpath(QFileInfo(dir.filePath(fileName)).path());
+        QFile file(dir.filePath(fileName));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(fileName == "different.dat" ? QByteArray(1024, 'y') : DATA);
+        urls.append(QUrl::fromLocalFile(file.fileName()));
+    }
+
+    auto cache = QSharedPointer<SharingResourceCache>::create();
+    auto original = cache->get(urls[0]);
+    QTRY_VERIFY(original->isLoaded());
+    QCOMPARE(original->getNumProcessed(), 1);
+
+    QList<QSharedPointer<SharingResource>> resources;
+    for (int i = 1; i < urls.size(); ++i) {
+        resources.append(cache->get(urls[i]));
+        QTRY_VERIFY(resources.last()->isLoaded());
+    }
+
+    // the same data under the same kind of name
+    QVERIFY(resources[0]->isAdopted());
+    QVERIFY(resources[1]->isAdopted());
+    QCOMPARE(resources[1]->getNumProcessed(), 0);
+    // a different kind of file could be parsed differently
+    QVERIFY(!resources[2]->isAdopted());
+    QVERIFY(!resources[3]->isAdopted());
+
+    QCOMPARE(cache->getNumSharedResources(), (size_t)2);
+    QCOMPARE(cache->getSizeSharedResources(), (size_t)(2 * DATA.size()));
+
+    resources.clear();
+    cache->clearUnusedResources();
+    QCOMPARE(cache->getNumSharedResources(), (size_t)0);
+    QCOMPARE(cache->getSizeSharedResources(), (size_t)0);
+}
@@ -0,0 +1,25 @@
+//
+//  ResourceSharingTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ResourceSharingTests_h
+#define hifi_ResourceSharingTests_h
+
+#include <QtTest/QtTest>
+
+class ResourceSharingTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    // Resources with the same data at different URLs share its content once it has been processed
+    void sameContentTest();
+    void cleanupTestCase();
+};
+
+#endif // hifi_ResourceSharingTests_h
@@ -0,0 +1,209 @@
+//
+//  EntityAABBTreeTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityAABBTreeTests.h"
+
+#include <algorithm>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityAABBTreeTests)
+
+static const int NUM_TEST_ENTITIES = 5000;
+static const int NUM_MOVES_PER_TICK = 500;
+static const float TEST_DOMAIN_SIZE = 500.0f;
+static const float TEST_QUERY_RADIUS = 25.0f;
+static const PickFilter TEST_FILTER { PickFilter::getBitMask(PickFilter::FlagBit::DOMAIN_ENTITIES) |
+                                      PickFilter::getBitMask(PickFilter::FlagBit::VISIBLE) |
+                                      PickFilter::getBitMask(PickFilter::FlagBit::INVISIBLE) |
+                                      PickFilter::getBitMask(PickFilter::FlagBit::COLLIDABLE) |
+                                      PickFilter::getBitMask(PickFilter::FlagBit::NONCOLLIDABLE) };
+
+using namespace EntityTreeTestUtils;
+
+// moves some of the entities a little, like a physics simulation step would
+static void moveEntities(EntityTreePointer tree, const QVector<EntityItemID>& entityIDs, int numMoves) {
+    tree->withWriteLock([&] {
+        for (int i = 0; i < numMoves; ++i) {
+            const auto& entityID = entityIDs[randIntInRange(0, entityIDs.size() - 1)];
+            auto entity = tree->findEntityByEntityItemID(entityID);
+            if (!entity) {
+                continue;
+            }
+            EntityItemProperties properties;
+            properties.setPosition(entity->getWorldPosition() + glm::vec3(randFloatInRange(-1.0f, 1.0f)));
+            tree->updateEntity(entityID, properties);
+        }
+    });
+}
+
+static QVector<QUuid> findEntitiesInSphere(EntityTreePointer tree, const glm::vec3& center, float radius) {
+    QVector<QUuid> entities;
+    tree->withReadLock([&] {
+        tree->evalEntitiesInSphere(center, radius, TEST_FILTER, entities);
+    });
+    std::sort(entities.begin(), entities.end());
+    return entities;
+}
+
+static EntityItemID findRayIntersection(EntityTreePointer tree, const glm::vec3& origin, const glm::vec3& direction,
+                                        float& distance) {
+    OctreeElementPointer element;
+    BoxFace face;
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+    return tree->evalRayIntersection(origin, direction, QVector<EntityItemID>(), QVector<EntityItemID>(), TEST_FILTER,
+                                     element, distance, face, surfaceNormal, extraInfo, Octree::Lock);
+}
+
+void EntityAABBTreeTests::initTestCase() {
+    EntityTreeTestUtils::setUpNodeList();
+}
+
+// both indexes must give the same answers, including after entities moved and got deleted
+void EntityAABBTreeTests::queryConsistencyTest() {
+    auto tree = createTree(false);
+    auto entityIDs = populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+
+    const int NUM_QUERIES = 100;
+    auto compareQueries = [&] {
+        for (int i = 0; i < NUM_QUERIES; ++i) {
+            glm::vec3 center = randomPosition(TEST_DOMAIN_SIZE);
+            glm::vec3 direction = glm::normalize(glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f),
+                                                           randFloatInRange(-1.0f, 1.0f)));
+
+            tree->setUseAABBTree(false);
+            auto octreeEntities = findEntitiesInSphere(tree, center, TEST_QUERY_RADIUS);
+            float octreeDistance;
+            auto octreeHit = findRayIntersection(tree, center, direction, octreeDistance);
+
+            tree->setUseAABBTree(true);
+            auto indexEntities = findEntitiesInSphere(tree, center, TEST_QUERY_RADIUS);
+            float indexDistance;
+            auto indexHit = findRayIntersection(tree, center, direction, indexDistance);
+
+            QCOMPARE(indexEntities, octreeEntities);
+            // the octree stops at the first element with a hit, which isn't always the closest hit, the index is exact
+            QCOMPARE(indexHit.isNull(), octreeHit.isNull());
+            if (!octreeHit.isNull()) {
+                const float EPSILON = 0.001f;
+                QVERIFY(indexDistance <= octreeDistance + EPSILON);
+            }
+        }
+    };
+
+    compareQueries();
+
+    tree->setUseAABBTree(true);
+    moveEntities(tree, entityIDs, NUM_TEST_ENTITIES);
+    tree->withWriteLock([&] {
+        for (int i = 0; i < NUM_TEST_ENTITIES / 10; ++i) {
+            tree->deleteEntity(entityIDs[i], true);
+        }
+    });
+    compareQueries();
+    QVERIFY(tree->getAABBTreeHeight() > 0);
+}
+
+void EntityAABBTreeTests::movingEntitiesBenchmark_data() {
+    QTest::addColumn<bool>("useAABBTree");
+    QTest::addColumn<bool>("indexOnly");
+
+    QTest::newRow("octree") << false << false;
+    QTest::newRow("octree and aabb tree") << true << false;
+    QTest::newRow("aabb tree only") << true << true;
+}
+
+// Each iteration is one simulation tick moving a tenth of the entities. The index is kept on top of the octree, so
+// with it the moves cost what they cost in the octree plus updating the index. The last row is what the moves would
+// cost if they only went through the index, which they can't while sending and persistence walk the octree.
+void EntityAABBTreeTests::movingEntitiesBenchmark() {
+    QFETCH(bool, useAABBTree);
+    QFETCH(bool, indexOnly);
+
+    auto tree = createTree(false);
+    auto entityIDs = populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+
+    if (indexOnly) {
+        EntityAABBTree index;
+        QVector<EntityItemPointer> entities;
+        QVector<AABox> bounds;
+        for (const auto& entityID : entityIDs) {
+            auto entity = tree->findEntityByEntityItemID(entityID);
+            bool success;
+            AACube cube = entity->getMaximumAACube(success);
+            if (success) {
+                entities.push_back(entity);
+                bounds.push_back(AABox(cube));
+                index.insert(entity, bounds.last());
+            }
+        }
+
+        QBENCHMARK {
+            for (int i = 0; i < NUM_MOVES_PER_TICK; ++i) {
+                int entityIndex = randIntInRange(0, entities.size() - 1);
+                AABox& entityBounds = bounds[entityIndex];
+                entityBounds.setBox(entityBounds.getCorner() + glm::vec3(randFloatInRange(-1.0f, 1.0f)),
+                                    entityBounds.getScale());
+                index.update(entities[entityIndex], entityBounds);
+            }
+        }
+        return;
+    }
+
+    tree->setUseAABBTree(useAABBTree);
+    // a query outside of the domain brings the index up to date with the moves without finding anything
+    const glm::vec3 EMPTY_QUERY_CENTER { 2.0f * TEST_DOMAIN_SIZE };
+    findEntitiesInSphere(tree, EMPTY_QUERY_CENTER, 1.0f);
+    QBENCHMARK {
+        moveEntities(tree, entityIDs, NUM_MOVES_PER_TICK);
+        findEntitiesInSphere(tree, EMPTY_QUERY_CENTER, 1.0f);
+    }
+}
+
+void EntityAABBTreeTests::sphereQueryBenchmark_data() {
+    QTest::addColumn<bool>("useAABBTree");
+
+    QTest::newRow("octree") << false;
+    QTest::newRow("aabb tree") << true;
+}
+
+void EntityAABBTreeTests::sphereQueryBenchmark() {
+    QFETCH(bool, useAABBTree);
+
+    auto tree = createTree(useAABBTree);
+    populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+
+    size_t numEntitiesFound = 0;
+    QBENCHMARK {
+        numEntitiesFound += findEntitiesInSphere(tree, randomPosition(TEST_DOMAIN_SIZE), TEST_QUERY_RADIUS).size();
+    }
+    qDebug() << "entities found:" << numEntitiesFound;
+}
+
+void EntityAABBTreeTests::rayQueryBenchmark_data() {
+    sphereQueryBenchmark_data();
+}
+
+void EntityAABBTreeTests::rayQueryBenchmark() {
+    QFETCH(bool, useAABBTree);
+
+    auto tree = createTree(useAABBTree);
+    populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+
+    int numHits = 0;
+    QBENCHMARK {
+        glm::vec3 direction = glm::normalize(glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f),
+                                                       randFloatInRange(-1.0f, 1.0f)));
+        float distance;
+        numHits += findRayIntersection(tree, randomPosition(TEST_DOMAIN_SIZE), direction, distance).isNull() ? 0 : 1;
+    }
+    qDebug() << "ray hits:" << numHits;
+}
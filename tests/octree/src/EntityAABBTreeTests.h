@@ -0,0 +1,29 @@
+//
+//  EntityAABBTreeTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityAABBTreeTests_h
+#define hifi_EntityAABBTreeTests_h
+
+#include <QtTest/QtTest>
+
+class EntityAABBTreeTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void queryConsistencyTest();
+    void movingEntitiesBenchmark_data();
+    void movingEntitiesBenchmark();
+    void sphereQueryBenchmark_data();
+    void sphereQueryBenchmark();
+    void rayQueryBenchmark_data();
+    void rayQueryBenchmark();
+};
+
+#endif // hifi_EntityAABBTreeTests_h
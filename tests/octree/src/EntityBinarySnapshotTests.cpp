@@ -0,0 +1,145 @@
+//
+//  EntityBinarySnapshotTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityBinarySnapshotTests.h"
+
+#include <QtCore/QTemporaryDir>
+
+#include <EntityBinarySnapshot.h>
+#include <EntityItem.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityBinarySnapshotTests)
+
+static const int NUM_TEST_ENTITIES = 2000;
+static const float TEST_DOMAIN_SIZE = 1000.0f;
+
+using namespace EntityTreeTestUtils;
+
+static QVector<EntityItemID> populateTree(EntityTreePointer tree, int numEntities) {
+    auto setProperties = [](int i, EntityItemProperties& properties) {
+        properties.setType(i % 2 ? EntityTypes::Box : EntityTypes::Text);
+        properties.setName(QString("entity %1").arg(i));
+        properties.setUserData(QString("{\"index\":%1}").arg(i));
+        properties.setIsVisibleInSecondaryCamera(i % 3 != 0);
+    };
+    return EntityTreeTestUtils::populateTree(tree, numEntities, TEST_DOMAIN_SIZE, setProperties);
+}
+
+void EntityBinarySnapshotTests::initTestCase() {
+    EntityTreeTestUtils::setUpNodeList();
+}
+
+void EntityBinarySnapshotTests::roundTripTest() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    QString filename = directory.filePath("models." + EntityBinarySnapshot::FILE_EXTENSION);
+
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, NUM_TEST_ENTITIES);
+    QCOMPARE(entityIDs.size(), NUM_TEST_ENTITIES);
+    QUuid persistID = QUuid::createUuid();
+    tree->setOctreeVersionInfo(persistID, 42);
+
+    // small chunks so that the entities are spread over many of them
+    QVERIFY(EntityBinarySnapshot::write(tree, filename, 4, 64));
+
+    QUuid id;
+    qint64 dataVersion;
+    QVERIFY(EntityBinarySnapshot::readInfo(filename, id, dataVersion));
+    QCOMPARE(id, persistID);
+    QCOMPARE(dataVersion, (qint64)42);
+
+    auto loadedTree = createTree();
+    QVERIFY(EntityBinarySnapshot::read(loadedTree, filename, 4));
+    QCOMPARE(loadedTree->getPersistID(), persistID);
+    QCOMPARE(loadedTree->getPersistDataVersion(), (int64_t)42);
+
+    for (const auto& entityID : entityIDs) {
+        auto entity = tree->findEntityByEntityItemID(entityID);
+        auto loadedEntity = loadedTree->findEntityByEntityItemID(entityID);
+        QVERIFY(loadedEntity);
+        QCOMPARE(loadedEntity->getType(), entity->getType());
+        QCOMPARE(loadedEntity->getName(), entity->getName());
+        QCOMPARE(loadedEntity->getWorldPosition(), entity->getWorldPosition());
+        QCOMPARE(loadedEntity->getScaledDimensions(), entity->getScaledDimensions());
+        QCOMPARE(loadedEntity->getUserData(), entity->getUserData());
+        QCOMPARE(loadedEntity->getCreated(), entity->getCreated());
+        QCOMPARE(loadedEntity->isVisibleInSecondaryCamera(), entity->isVisibleInSecondaryCamera());
+    }
+}
+
+void EntityBinarySnapshotTests::invalidSnapshotTest() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    QString filename = directory.filePath("models." + EntityBinarySnapshot::FILE_EXTENSION);
+
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, 100);
+    QVERIFY(EntityBinarySnapshot::write(tree, filename, 1, 10));
+
+    // cut the last chunk and the index off, nothing of it should get loaded
+    QFile file(filename);
+    QVERIFY(file.resize(file.size() / 2));
+
+    QUuid id;
+    qint64 dataVersion;
+    QVERIFY(!EntityBinarySnapshot::readInfo(filename, id, dataVersion));
+
+    auto loadedTree = createTree();
+    QVERIFY(!EntityBinarySnapshot::read(loadedTree, filename));
+    for (const auto& entityID : entityIDs) {
+        QVERIFY(!loadedTree->findEntityByEntityItemID(entityID));
+    }
+}
+
+void EntityBinarySnapshotTests::loadBenchmark_data() {
+    QTest::addColumn<bool>("binary");
+    QTest::addColumn<int>("numEntities");
+
+    QTest::newRow("json 10000") << false << 10000;
+    QTest::newRow("binary 10000") << true << 10000;
+    QTest::newRow("json 50000") << false << 50000;
+    QTest::newRow("binary 50000") << true << 50000;
+}
+
+void EntityBinarySnapshotTests::loadBenchmark() {
+    QFETCH(bool, binary);
+    QFETCH(int, numEntities);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    auto tree = createTree();
+    populateTree(tree, numEntities);
+
+    QString filename;
+    if (binary) {
+        filename = directory.filePath("models." + EntityBinarySnapshot::FILE_EXTENSION);
+        QVERIFY(EntityBinarySnapshot::write(tree, filename));
+    } else {
+        filename = directory.filePath("models.json.gz");
+        QVERIFY(tree->writeToFile(filename.toLocal8Bit().constData()));
+    }
+
+    QBENCHMARK {
+        auto loadedTree = createTree();
+        if (binary) {
+            QVERIFY(EntityBinarySnapshot::read(loadedTree, filename));
+        } else {
+            bool success = false;
+            loadedTree->withWriteLock([&] {
+                success = loadedTree->readFromFile(filename.toLocal8Bit().constData());
+            });
+            QVERIFY(success);
+        }
+    }
+}
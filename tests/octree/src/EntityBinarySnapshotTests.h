@@ -0,0 +1,26 @@
+//
+//  EntityBinarySnapshotTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityBinarySnapshotTests_h
+#define hifi_EntityBinarySnapshotTests_h
+
+#include <QtTest/QtTest>
+
+class EntityBinarySnapshotTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void roundTripTest();
+    void invalidSnapshotTest();
+    void loadBenchmark_data();
+    void loadBenchmark();
+};
+
+#endif // hifi_EntityBinarySnapshotTests_h
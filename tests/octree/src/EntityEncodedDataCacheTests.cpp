@@ -0,0 +1,154 @@
+//
+//  EntityEncodedDataCacheTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEncodedDataCacheTests.h"
+
+#include <EntityItem.h>
+#include <OctreePacketData.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityEncodedDataCacheTests)
+
+using namespace EntityTreeTestUtils;
+
+static EntityItemPointer addEntity(EntityTreePointer tree, const QString& userData = QString()) {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setName("cached");
+    properties.setDimensions(glm::vec3(1.0f));
+    properties.setUserData(userData);
+    EntityItemPointer entity;
+    tree->withWriteLock([&] {
+        entity = tree->addEntity(EntityItemID(QUuid::createUuid()), properties);
+    });
+    return entity;
+}
+
+static QByteArray encode(const EntityItemPointer& entity, bool useEncodedDataCache = true,
+                         bool canGetPrivateUserData = false, OctreeElement::AppendState* appendState = nullptr) {
+    OctreePacketData packetData;
+    EncodeBitstreamParams params;
+    params.useEncodedDataCache = useEncodedDataCache;
+    auto state = entity->appendEntityData(&packetData, params, nullptr, canGetPrivateUserData);
+    if (appendState) {
+        *appendState = state;
+    }
+    return QByteArray((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+}
+
+static void rename(EntityTreePointer tree, const EntityItemPointer& entity, const QString& name) {
+    EntityItemProperties properties;
+    properties.setName(name);
+    tree->withWriteLock([&] {
+        tree->updateEntity(entity->getEntityItemID(), properties);
+    });
+}
+
+void EntityEncodedDataCacheTests::initTestCase() {
+    setUpNodeList();
+}
+
+void EntityEncodedDataCacheTests::cacheHitTest() {
+    auto tree = createTree();
+    auto entity = addEntity(tree);
+    QVERIFY(entity);
+
+    QVERIFY(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()).isEmpty());
+
+    QByteArray encoded = encode(entity);
+    QVERIFY(!encoded.isEmpty());
+    QCOMPARE(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()), encoded);
+
+    // the next viewer gets the same bytes
+    QCOMPARE(encode(entity), encoded);
+    QCOMPARE(encode(entity, false), encoded);
+}
+
+void EntityEncodedDataCacheTests::disabledTest() {
+    auto tree = createTree();
+    auto entity = addEntity(tree);
+
+    encode(entity, false);
+    QVERIFY(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()).isEmpty());
+}
+
+void EntityEncodedDataCacheTests::editInvalidatesTest() {
+    auto tree = createTree();
+    auto entity = addEntity(tree);
+    QByteArray encoded = encode(entity);
+
+    rename(tree, entity, "renamed");
+    QVERIFY(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()).isEmpty());
+
+    QByteArray reencoded = encode(entity);
+    QVERIFY(reencoded != encoded);
+    QVERIFY(reencoded.contains("renamed"));
+    QCOMPARE(reencoded, encode(entity, false));
+    QCOMPARE(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()), reencoded);
+}
+
+void EntityEncodedDataCacheTests::invalidateTest() {
+    auto tree = createTree();
+    auto entity = addEntity(tree);
+    encode(entity);
+
+    auto key = entity->getEncodedDataCacheKey();
+    entity->invalidateEncodedDataCache();
+    QVERIFY(!(entity->getEncodedDataCacheKey() == key));
+    QVERIFY(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()).isEmpty());
+}
+
+void EntityEncodedDataCacheTests::staleInsertTest() {
+    auto tree = createTree();
+    auto entity = addEntity(tree);
+
+    // an encode takes its key, then an edit lands before it is done
+    auto key = entity->getEncodedDataCacheKey();
+    QByteArray staleData = encode(entity, false);
+    rename(tree, entity, "renamed");
+
+    entity->setCachedEncodedData(false, key, staleData);
+    QVERIFY(entity->getCachedEncodedData(false, key).isEmpty());
+    QVERIFY(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()).isEmpty());
+    QVERIFY(encode(entity).contains("renamed"));
+}
+
+void EntityEncodedDataCacheTests::privateUserDataTest() {
+    auto tree = createTree();
+    auto entity = addEntity(tree);
+    EntityItemProperties properties;
+    properties.setPrivateUserData("secret");
+    tree->withWriteLock([&] {
+        tree->updateEntity(entity->getEntityItemID(), properties);
+    });
+
+    QByteArray publicData = encode(entity, true, false);
+    QByteArray privateData = encode(entity, true, true);
+    QVERIFY(!publicData.contains("secret"));
+    QVERIFY(privateData.contains("secret"));
+
+    // each kind of viewer has its own slot
+    auto key = entity->getEncodedDataCacheKey();
+    QCOMPARE(entity->getCachedEncodedData(false, key), publicData);
+    QCOMPARE(entity->getCachedEncodedData(true, key), privateData);
+    QCOMPARE(encode(entity, true, false), publicData);
+    QCOMPARE(encode(entity, true, true), privateData);
+}
+
+void EntityEncodedDataCacheTests::partialEncodeTest() {
+    auto tree = createTree();
+    auto entity = addEntity(tree, QString((int)MAX_OCTREE_PACKET_DATA_SIZE, 'x'));
+
+    OctreeElement::AppendState appendState;
+    encode(entity, true, false, &appendState);
+    QVERIFY(appendState != OctreeElement::COMPLETED);
+    QVERIFY(entity->getCachedEncodedData(false, entity->getEncodedDataCacheKey()).isEmpty());
+}
@@ -0,0 +1,33 @@
+//
+//  EntityEncodedDataCacheTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityEncodedDataCacheTests_h
+#define hifi_EntityEncodedDataCacheTests_h
+
+#include <QtTest/QtTest>
+
+class EntityEncodedDataCacheTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    // A complete encode is cached, and served as is to the next viewer
+    void cacheHitTest();
+    void disabledTest();
+    void editInvalidatesTest();
+    void invalidateTest();
+    // Bytes encoded before an edit aren't cached under the generation the edit left
+    void staleInsertTest();
+    void privateUserDataTest();
+    // An encode that doesn't fit in the packet isn't cached
+    void partialEncodeTest();
+};
+
+#endif // hifi_EntityEncodedDataCacheTests_h
@@ -0,0 +1,179 @@
+//
+//  EntityInterestSetsTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityInterestSetsTests.h"
+
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <DiffTraversal.h>
+#include <EntityInterestSets.h>
+#include <EntityPriorityQueue.h>
+#include <GLMHelpers.h>
+#include <ViewFrustum.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityInterestSetsTests)
+
+static const int NUM_TEST_ENTITIES = 5000;
+static const float TEST_DOMAIN_SIZE = 200.0f;
+static const float CROWD_SIZE = 10.0f; // meters across
+static const int NUM_TEST_VIEWS = 50;
+
+using namespace EntityTreeTestUtils;
+
+static void populateTree(EntityTreePointer tree, int numEntities) {
+    EntityTreeTestUtils::populateTree(tree, numEntities, TEST_DOMAIN_SIZE, [](int, EntityItemProperties& properties) {
+        properties.setDimensions(glm::vec3(randFloatInRange(0.01f, 5.0f)));
+    });
+}
+
+static DiffTraversal::View createView(const glm::vec3& position, const glm::quat& orientation) {
+    ViewFrustum viewFrustum;
+    viewFrustum.setProjection(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f));
+    viewFrustum.setPosition(position);
+    viewFrustum.setOrientation(orientation);
+    viewFrustum.setCenterRadius(3.0f);
+    viewFrustum.calculate();
+
+    ConicalViewFrustum conicalViewFrustum(viewFrustum);
+    conicalViewFrustum.calculate();
+
+    DiffTraversal::View view;
+    view.viewFrustums.push_back(conicalViewFrustum);
+    return view;
+}
+
+static glm::vec3 randomCrowdPosition() {
+    return glm::vec3(randFloatInRange(-CROWD_SIZE, CROWD_SIZE) * 0.5f, 1.7f, randFloatInRange(-CROWD_SIZE, CROWD_SIZE) * 0.5f);
+}
+
+// looking roughly at the same stage
+static glm::quat randomCrowdOrientation() {
+    return glm::angleAxis(randFloatInRange(-0.2f, 0.2f), Vectors::UNIT_Y) *
+           glm::angleAxis(randFloatInRange(-0.1f, 0.1f), Vectors::UNIT_X);
+}
+
+void EntityInterestSetsTests::initTestCase() {
+    EntityTreeTestUtils::setUpNodeList();
+}
+
+// A viewer using the sets of its bucket must get everything its own view would have, at no lower priority
+void EntityInterestSetsTests::conservativeVisibilityTest() {
+    auto tree = createTree();
+    populateTree(tree, NUM_TEST_ENTITIES);
+    auto snapshot = tree->getSnapshot(0);
+
+    EntityInterestManager interestManager;
+    for (int i = 0; i < NUM_TEST_VIEWS; ++i) {
+        glm::vec3 axis = glm::normalize(glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f), 1.0f));
+        glm::quat orientation = glm::angleAxis(randFloatInRange(0.0f, TWO_PI), axis);
+        DiffTraversal::View view = createView(glm::vec3(randFloatInRange(-TEST_DOMAIN_SIZE, TEST_DOMAIN_SIZE)), orientation);
+        view.lodScaleFactor = powf(2.0f, (float)randIntInRange(-2, 2));
+
+        DiffTraversal::View sharedView = view;
+        sharedView.interestSets = interestManager.getInterestSets(snapshot, view);
+        QVERIFY(sharedView.interestSets);
+
+        for (int32_t index = 0; index < (int32_t)snapshot->getNumElements(); ++index) {
+            const auto& element = snapshot->getElement(index);
+            if (view.shouldTraverseElement(element)) {
+                QVERIFY(sharedView.shouldTraverseElement(*snapshot, index));
+            }
+            snapshot->forEachEntity(element, [&](const EntityTreeSnapshot::Entity& entity) {
+                float priority = view.computePriority(*snapshot, entity);
+                if (priority != PrioritizedEntity::DO_NOT_SEND) {
+                    QVERIFY(sharedView.computePriority(*snapshot, entity) >= priority);
+                }
+            });
+        }
+    }
+}
+
+void EntityInterestSetsTests::bucketSharingTest() {
+    auto tree = createTree();
+    populateTree(tree, 100);
+    auto snapshot = tree->getSnapshot(0);
+
+    EntityInterestManager interestManager;
+    glm::vec3 cellCenter = glm::vec3(0.5f * EntityInterestSets::POSITION_CELL_SIZE);
+    // looking forward through the middle of a direction cell
+    float cellMiddle = 1.0f / EntityInterestSets::DIRECTION_CELLS_PER_FACE;
+    glm::quat orientation = rotationBetween(Vectors::FRONT, glm::vec3(cellMiddle, cellMiddle, -1.0f));
+    auto interestSets = interestManager.getInterestSets(snapshot, createView(cellCenter, orientation));
+
+    // a little further in the same cell, looking about the same way
+    glm::quat turned = rotationBetween(Vectors::FRONT, glm::vec3(1.1f * cellMiddle, 0.9f * cellMiddle, -1.0f));
+    glm::vec3 moved = cellCenter + glm::vec3(0.1f * EntityInterestSets::POSITION_CELL_SIZE);
+    QCOMPARE(interestManager.getInterestSets(snapshot, createView(moved, turned)), interestSets);
+    QCOMPARE(interestManager.getNumSharedRequests(), (uint64_t)1);
+
+    // elsewhere, or looking the other way
+    glm::vec3 farAway = cellCenter + glm::vec3(10.0f * EntityInterestSets::POSITION_CELL_SIZE);
+    QVERIFY(interestManager.getInterestSets(snapshot, createView(farAway, orientation)) != interestSets);
+    glm::quat turnedAround = glm::angleAxis(PI, Vectors::UNIT_Y) * orientation;
+    QVERIFY(interestManager.getInterestSets(snapshot, createView(cellCenter, turnedAround)) != interestSets);
+    QCOMPARE(interestManager.getNumBuckets(), 3);
+
+    // views without frustums aren't culled at all
+    QVERIFY(!interestManager.getInterestSets(snapshot, DiffTraversal::View()));
+
+    // a new snapshot starts over
+    populateTree(tree, 1);
+    auto newSnapshot = tree->getSnapshot(0);
+    QVERIFY(interestSets->isFor(*snapshot));
+    QVERIFY(!interestSets->isFor(*newSnapshot));
+    QVERIFY(interestManager.getInterestSets(newSnapshot, createView(cellCenter, orientation)) != interestSets);
+    QCOMPARE(interestManager.getNumBuckets(), 1);
+}
+
+void EntityInterestSetsTests::crowdTraversalBenchmark_data() {
+    QTest::addColumn<bool>("shareInterestSets");
+
+    QTest::newRow("per viewer") << false;
+    QTest::newRow("shared interest sets") << true;
+}
+
+// Each iteration is a first traversal of the same snapshot by each viewer of a crowd gathered in front of a stage
+void EntityInterestSetsTests::crowdTraversalBenchmark() {
+    QFETCH(bool, shareInterestSets);
+    const int NUM_VIEWERS = 200;
+
+    auto tree = createTree();
+    populateTree(tree, NUM_TEST_ENTITIES);
+    auto snapshot = tree->getSnapshot(0);
+
+    std::vector<DiffTraversal::View> views;
+    for (int i = 0; i < NUM_VIEWERS; ++i) {
+        views.push_back(createView(randomCrowdPosition(), randomCrowdOrientation()));
+    }
+
+    size_t numQueued = 0;
+    QBENCHMARK {
+        auto interestManager = shareInterestSets ? std::make_shared<EntityInterestManager>() : nullptr;
+        for (const auto& view : views) {
+            DiffTraversal traversal;
+            traversal.setInterestManager(interestManager);
+            traversal.prepareNewTraversal(view, snapshot, true);
+            traversal.setScanCallback([&](DiffTraversal::VisibleElement& next) {
+                snapshot->forEachEntity(*next.element, [&](const EntityTreeSnapshot::Entity& entity) {
+                    if (traversal.getCurrentView().computePriority(*snapshot, entity) != PrioritizedEntity::DO_NOT_SEND) {
+                        ++numQueued;
+                    }
+                });
+            });
+            traversal.traverse(std::numeric_limits<uint64_t>::max() / 2);
+            QVERIFY(traversal.finished());
+        }
+    }
+    QVERIFY(numQueued > 0);
+}
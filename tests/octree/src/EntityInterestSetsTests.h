@@ -0,0 +1,26 @@
+//
+//  EntityInterestSetsTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityInterestSetsTests_h
+#define hifi_EntityInterestSetsTests_h
+
+#include <QtTest/QtTest>
+
+class EntityInterestSetsTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void conservativeVisibilityTest();
+    void bucketSharingTest();
+    void crowdTraversalBenchmark_data();
+    void crowdTraversalBenchmark();
+};
+
+#endif // hifi_EntityInterestSetsTests_h
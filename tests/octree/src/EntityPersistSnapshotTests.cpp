@@ -0,0 +1,130 @@
+//
+//  EntityPersistSnapshotTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPersistSnapshotTests.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+
+#include <EntityBinarySnapshot.h>
+#include <EntityPersistSnapshot.h>
+#include <Gzip.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityPersistSnapshotTests)
+
+static const int NUM_TEST_ENTITIES = 500;
+static const float TEST_DOMAIN_SIZE = 1000.0f;
+
+using namespace EntityTreeTestUtils;
+
+// the entities of a persist document by ID, the tree and the snapshot don't list them in the same order
+static QHash<QString, QJsonObject> entitiesByID(const QJsonDocument& document) {
+    QHash<QString, QJsonObject> entities;
+    for (const auto& entity : document.object()["Entities"].toArray()) {
+        entities.insert(entity.toObject()["id"].toString(), entity.toObject());
+    }
+    return entities;
+}
+
+void EntityPersistSnapshotTests::initTestCase() {
+    setUpNodeList();
+}
+
+void EntityPersistSnapshotTests::matchesTreeJSONTest() {
+    auto tree = createTree();
+    populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE, [](int i, EntityItemProperties& properties) {
+        properties.setName(QString("entity %1").arg(i));
+    });
+    tree->setOctreeVersionInfo(QUuid::createUuid(), 7);
+
+    QByteArray treeData;
+    QVERIFY(tree->toJSON(&treeData));
+    auto snapshot = EntityPersistSnapshot::take(tree);
+    QCOMPARE((int)snapshot->getNumEntities(), NUM_TEST_ENTITIES);
+    QByteArray snapshotData;
+    QVERIFY(snapshot->toJSON(&snapshotData));
+
+    auto treeDocument = QJsonDocument::fromJson(treeData);
+    auto snapshotDocument = QJsonDocument::fromJson(snapshotData);
+    QVERIFY(snapshotDocument.isObject());
+    for (const auto& key : { "DataVersion", "Id", "Version" }) {
+        QCOMPARE(snapshotDocument.object()[key], treeDocument.object()[key]);
+    }
+    QCOMPARE(entitiesByID(snapshotDocument), entitiesByID(treeDocument));
+
+    // gzipped the same way the persist file is
+    QByteArray gzippedData;
+    QVERIFY(snapshot->toJSON(&gzippedData, true));
+    QByteArray gunzippedData;
+    QVERIFY(gunzip(gzippedData, gunzippedData));
+    QCOMPARE(gunzippedData, snapshotData);
+}
+
+void EntityPersistSnapshotTests::binarySnapshotTest() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    QString filename = directory.filePath("models." + EntityBinarySnapshot::FILE_EXTENSION);
+
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+    QUuid persistID = QUuid::createUuid();
+    tree->setOctreeVersionInfo(persistID, 12);
+
+    QVERIFY(!EntityPersistSnapshot::take(tree)->writeBinarySnapshot(filename));
+    auto snapshot = EntityPersistSnapshot::take(tree, true);
+    // the tree moving on doesn't change what gets written
+    tree->incrementPersistDataVersion();
+    tree->withWriteLock([&] {
+        tree->deleteEntity(entityIDs[0], true);
+    });
+    QVERIFY(snapshot->writeBinarySnapshot(filename));
+
+    // both files of the snapshot have the same data version
+    QUuid id;
+    qint64 dataVersion;
+    QVERIFY(EntityBinarySnapshot::readInfo(filename, id, dataVersion));
+    QCOMPARE(id, persistID);
+    QCOMPARE(dataVersion, (qint64)12);
+    QByteArray data;
+    QVERIFY(snapshot->toJSON(&data));
+    QCOMPARE(QJsonDocument::fromJson(data).object()["DataVersion"].toInt(), 12);
+
+    auto loadedTree = createTree();
+    QVERIFY(EntityBinarySnapshot::read(loadedTree, filename));
+    for (const auto& entityID : entityIDs) {
+        QVERIFY(loadedTree->findEntityByEntityItemID(entityID));
+    }
+}
+
+void EntityPersistSnapshotTests::laterEditsTest() {
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, 2, TEST_DOMAIN_SIZE);
+    QCOMPARE(entityIDs.size(), 2);
+    auto snapshot = EntityPersistSnapshot::take(tree);
+
+    // what happens to the tree once the snapshot was taken doesn't show up in it
+    tree->withWriteLock([&] {
+        EntityItemProperties properties;
+        properties.setName("renamed");
+        tree->updateEntity(entityIDs[0], properties);
+        tree->deleteEntity(entityIDs[1], true);
+    });
+
+    QByteArray data;
+    QVERIFY(snapshot->toJSON(&data));
+    auto entities = entitiesByID(QJsonDocument::fromJson(data));
+    QCOMPARE(entities.size(), 2);
+    QVERIFY(!entities.value(entityIDs[0].toString())["name"].toString().startsWith("renamed"));
+    QVERIFY(entities.contains(entityIDs[1].toString()));
+}
@@ -0,0 +1,25 @@
+//
+//  EntityPersistSnapshotTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPersistSnapshotTests_h
+#define hifi_EntityPersistSnapshotTests_h
+
+#include <QtTest/QtTest>
+
+class EntityPersistSnapshotTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void matchesTreeJSONTest();
+    void binarySnapshotTest();
+    void laterEditsTest();
+};
+
+#endif // hifi_EntityPersistSnapshotTests_h
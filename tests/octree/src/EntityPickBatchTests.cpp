@@ -0,0 +1,363 @@
+//
+//  EntityPickBatchTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPickBatchTests.h"
+
+#include "EntityTreeTestUtils.h"
+
+#include <PickCacheOptimizer.h>
+
+QTEST_MAIN(EntityPickBatchTests)
+
+static const int NUM_TEST_ENTITIES = 2000;
+static const float TEST_DOMAIN_SIZE = 100.0f;
+// well above what EntityTree needs before it splits a batch between threads
+static const int NUM_TEST_PICKS = 64;
+static const int NUM_INCLUDED_ENTITIES = 50;
+static const PickFilter ALL_ENTITIES_FILTER { PickFilter::getBitMask(PickFilter::FlagBit::DOMAIN_ENTITIES) |
+                                              PickFilter::getBitMask(PickFilter::FlagBit::VISIBLE) |
+                                              PickFilter::getBitMask(PickFilter::FlagBit::INVISIBLE) |
+                                              PickFilter::getBitMask(PickFilter::FlagBit::COLLIDABLE) |
+                                              PickFilter::getBitMask(PickFilter::FlagBit::NONCOLLIDABLE) };
+static const PickFilter COLLIDABLE_FILTER { PickFilter::getBitMask(PickFilter::FlagBit::DOMAIN_ENTITIES) |
+                                            PickFilter::getBitMask(PickFilter::FlagBit::VISIBLE) |
+                                            PickFilter::getBitMask(PickFilter::FlagBit::INVISIBLE) |
+                                            PickFilter::getBitMask(PickFilter::FlagBit::COLLIDABLE) };
+
+using namespace EntityTreeTestUtils;
+
+// half of the entities are collisionless, so the collidable picks skip them
+static QVector<EntityItemID> populatePickTree(EntityTreePointer tree) {
+    return populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE, [](int i, EntityItemProperties& properties) {
+        properties.setCollisionless(i % 2 == 1);
+    });
+}
+
+// somewhere above the domain, where nothing is
+static glm::vec3 randomPositionAboveDomain() {
+    return glm::vec3(randFloatInRange(-TEST_DOMAIN_SIZE, TEST_DOMAIN_SIZE), 2.0f * TEST_DOMAIN_SIZE,
+                     randFloatInRange(-TEST_DOMAIN_SIZE, TEST_DOMAIN_SIZE));
+}
+
+static glm::vec3 randomDirection() {
+    return glm::normalize(glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f),
+                                    randFloatInRange(-1.0f, 1.0f)));
+}
+
+static EntityItemID evalRayIntersection(EntityTreePointer tree, const EntityRayQuery& query, float& distance) {
+    OctreeElementPointer element;
+    BoxFace face;
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+    return tree->evalRayIntersection(query.ray.origin, query.ray.direction, query.entityIdsToInclude,
+                                     query.entityIdsToDiscard, query.searchFilter, element, distance, face, surfaceNormal,
+                                     extraInfo, Octree::Lock);
+}
+
+static EntityItemID evalParabolaIntersection(EntityTreePointer tree, const EntityParabolaQuery& query, float& distance,
+                                             float& parabolicDistance) {
+    OctreeElementPointer element;
+    glm::vec3 intersection;
+    BoxFace face;
+    glm::vec3 surfaceNormal;
+    QVariantMap extraInfo;
+    return tree->evalParabolaIntersection(query.parabola, query.entityIdsToInclude, query.entityIdsToDiscard,
+                                          query.searchFilter, element, intersection, distance, parabolicDistance, face,
+                                          surfaceNormal, extraInfo, Octree::Lock);
+}
+
+// Every fourth pick points away from the domain and misses, the others alternate between both filters. Some only look at
+// a few entities and some ignore the entity they would hit otherwise.
+template <typename Q, typename F>
+static QVector<Q> makeQueries(const QVector<EntityItemID>& entityIDs, F setMissOrRandomPick,
+                              std::function<EntityItemID(const Q&)> evalQuery) {
+    QVector<Q> queries;
+    for (int i = 0; i < NUM_TEST_PICKS; ++i) {
+        Q query;
+        setMissOrRandomPick(query, i % 4 == 3);
+        query.searchFilter = i % 2 == 0 ? ALL_ENTITIES_FILTER : COLLIDABLE_FILTER;
+        if (i % 8 == 2) {
+            for (int j = 0; j < NUM_INCLUDED_ENTITIES; ++j) {
+                query.entityIdsToInclude.push_back(entityIDs[randIntInRange(0, entityIDs.size() - 1)]);
+            }
+        } else if (i % 8 == 6) {
+            EntityItemID entityID = evalQuery(query);
+            if (!entityID.isNull()) {
+                query.entityIdsToDiscard.push_back(entityID);
+            }
+        }
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+static QVector<EntityRayQuery> makeRayQueries(EntityTreePointer tree, const QVector<EntityItemID>& entityIDs) {
+    return makeQueries<EntityRayQuery>(entityIDs, [](EntityRayQuery& query, bool miss) {
+        if (miss) {
+            query.ray = PickRay(randomPositionAboveDomain(), Vectors::UNIT_Y);
+        } else {
+            query.ray = PickRay(randomPosition(TEST_DOMAIN_SIZE), randomDirection());
+        }
+    }, [&](const EntityRayQuery& query) {
+        float distance;
+        return evalRayIntersection(tree, query, distance);
+    });
+}
+
+static QVector<EntityParabolaQuery> makeParabolaQueries(EntityTreePointer tree, const QVector<EntityItemID>& entityIDs) {
+    const glm::vec3 GRAVITY(0.0f, -9.8f, 0.0f);
+    return makeQueries<EntityParabolaQuery>(entityIDs, [&](EntityParabolaQuery& query, bool miss) {
+        if (miss) {
+            query.parabola = PickParabola(randomPositionAboveDomain(), Vectors::UNIT_Y, -GRAVITY);
+        } else {
+            const float PICK_SPEED = 20.0f;
+            query.parabola = PickParabola(randomPosition(TEST_DOMAIN_SIZE), PICK_SPEED * randomDirection(), GRAVITY);
+        }
+    }, [&](const EntityParabolaQuery& query) {
+        float distance;
+        float parabolicDistance;
+        return evalParabolaIntersection(tree, query, distance, parabolicDistance);
+    });
+}
+
+static void verifyFilterAndCoverage(EntityTreePointer tree, const PickFilter& searchFilter, const EntityItemID& entityID,
+                                    int& numHits, int& numMisses) {
+    if (entityID.isNull()) {
+        numMisses++;
+        return;
+    }
+    numHits++;
+    if (!searchFilter.doesPickNonCollidable()) {
+        auto entity = tree->findEntityByEntityItemID(entityID);
+        QVERIFY(entity);
+        QVERIFY(!entity->getCollisionless());
+    }
+}
+
+// The result of a pick as seen through PickCacheOptimizer, the closest entity hit
+class TestPickResult : public PickResult {
+public:
+    TestPickResult(const QVariantMap& pickVariant) : PickResult(pickVariant) {}
+    TestPickResult(const EntityItemID& entityID, float distance, const QVariantMap& pickVariant) :
+        PickResult(pickVariant), entityID(entityID), distance(distance) {}
+
+    bool doesIntersect() const override { return !entityID.isNull(); }
+
+    PickResultPointer compareAndProcessNewResult(const PickResultPointer& newRes) override {
+        auto newTestRes = std::static_pointer_cast<TestPickResult>(newRes);
+        if (newTestRes->doesIntersect() && (!doesIntersect() || newTestRes->distance < distance)) {
+            return std::make_shared<TestPickResult>(*newTestRes);
+        }
+        return std::make_shared<TestPickResult>(*this);
+    }
+
+    bool checkOrFilterAgainstMaxDistance(float maxDistance) override { return distance < maxDistance; }
+
+    EntityItemID entityID;
+    float distance { FLT_MAX };
+};
+
+static int numSingleEntityIntersections = 0;
+
+// A ray pick that only picks the entities of a tree, like RayPick does through EntityScriptingInterface
+class TestRayPick : public Pick<PickRay> {
+public:
+    TestRayPick(EntityTreePointer tree, const EntityRayQuery& query) :
+        Pick(query.ray, query.searchFilter, 0.0f, true), _tree(tree) {
+        QVector<QUuid> includeItems;
+        for (const auto& entityID : query.entityIdsToInclude) {
+            includeItems.push_back(entityID);
+        }
+        setIncludeItems(includeItems);
+        QVector<QUuid> ignoreItems;
+        for (const auto& entityID : query.entityIdsToDiscard) {
+            ignoreItems.push_back(entityID);
+        }
+        setIgnoreItems(ignoreItems);
+    }
+
+    PickType getType() const override { return PickQuery::Ray; }
+    Transform getResultTransform() const override { return Transform(); }
+    PickRay getMathematicalPick() const override { return _mathPick; }
+    PickResultPointer getDefaultResult(const QVariantMap& pickVariant) const override {
+        return std::make_shared<TestPickResult>(pickVariant);
+    }
+
+    PickResultPointer getEntityIntersection(const PickRay& pick) override {
+        numSingleEntityIntersections++;
+        float distance;
+        EntityItemID entityID = evalRayIntersection(_tree, toQuery(pick, *this), distance);
+        return std::make_shared<TestPickResult>(entityID, distance, pick.toVariantMap());
+    }
+    PickResultPointer getAvatarIntersection(const PickRay&) override { return nullptr; }
+    PickResultPointer getHUDIntersection(const PickRay&) override { return nullptr; }
+
+    static EntityRayQuery toQuery(const PickRay& pick, const Pick<PickRay>& rayPick) {
+        EntityRayQuery query;
+        query.ray = pick;
+        query.searchFilter = rayPick.getFilter();
+        query.entityIdsToInclude = rayPick.getIncludeItemsAs<EntityItemID>();
+        query.entityIdsToDiscard = rayPick.getIgnoreItemsAs<EntityItemID>();
+        return query;
+    }
+
+private:
+    EntityTreePointer _tree;
+};
+
+static std::unordered_map<uint32_t, std::shared_ptr<TestPickResult>> updatePicks(PickCacheOptimizer<PickRay>& optimizer,
+        std::unordered_map<uint32_t, std::shared_ptr<PickQuery>>& picks) {
+    const uint64_t NO_TIME_BUDGET = 60 * USECS_PER_SECOND;
+    const uint32_t INVALID_PICK_ID = 0;
+    uint32_t nextToUpdate = INVALID_PICK_ID;
+    optimizer.update(picks, nextToUpdate, usecTimestampNow() + NO_TIME_BUDGET, false);
+
+    std::unordered_map<uint32_t, std::shared_ptr<TestPickResult>> results;
+    for (const auto& pick : picks) {
+        results[pick.first] = std::static_pointer_cast<TestPickResult>(pick.second->getPrevPickResult());
+    }
+    return results;
+}
+
+void EntityPickBatchTests::initTestCase() {
+    EntityTreeTestUtils::setUpNodeList();
+}
+
+void EntityPickBatchTests::rayBatchTest_data() {
+    QTest::addColumn<bool>("useAABBTree");
+    QTest::newRow("octree") << false;
+    QTest::newRow("aabb tree") << true;
+}
+
+// a batch must find what each of its picks finds on its own
+void EntityPickBatchTests::rayBatchTest() {
+    QFETCH(bool, useAABBTree);
+    auto tree = createTree(useAABBTree);
+    auto entityIDs = populatePickTree(tree);
+
+    auto queries = makeRayQueries(tree, entityIDs);
+    tree->evalRayIntersections(queries);
+
+    int numHits = 0;
+    int numMisses = 0;
+    for (const auto& query : queries) {
+        float distance;
+        EntityItemID entityID = evalRayIntersection(tree, query, distance);
+        QCOMPARE(query.entityID, entityID);
+        if (!entityID.isNull()) {
+            QCOMPARE(query.distance, distance);
+            QVERIFY(query.element == tree->findEntityByEntityItemID(entityID)->getElement());
+        }
+        verifyFilterAndCoverage(tree, query.searchFilter, query.entityID, numHits, numMisses);
+        QVERIFY(!query.entityIdsToDiscard.contains(query.entityID));
+        QVERIFY(query.entityIdsToInclude.isEmpty() || query.entityID.isNull() ||
+                query.entityIdsToInclude.contains(query.entityID));
+    }
+    QVERIFY(numHits > 0);
+    QVERIFY(numMisses >= NUM_TEST_PICKS / 4);
+}
+
+void EntityPickBatchTests::parabolaBatchTest_data() {
+    rayBatchTest_data();
+}
+
+void EntityPickBatchTests::parabolaBatchTest() {
+    QFETCH(bool, useAABBTree);
+    auto tree = createTree(useAABBTree);
+    auto entityIDs = populatePickTree(tree);
+
+    auto queries = makeParabolaQueries(tree, entityIDs);
+    tree->evalParabolaIntersections(queries);
+
+    int numHits = 0;
+    int numMisses = 0;
+    for (const auto& query : queries) {
+        float distance;
+        float parabolicDistance;
+        EntityItemID entityID = evalParabolaIntersection(tree, query, distance, parabolicDistance);
+        QCOMPARE(query.entityID, entityID);
+        if (!entityID.isNull()) {
+            QCOMPARE(query.parabolicDistance, parabolicDistance);
+            QCOMPARE(query.distance, distance);
+        }
+        verifyFilterAndCoverage(tree, query.searchFilter, query.entityID, numHits, numMisses);
+        QVERIFY(!query.entityIdsToDiscard.contains(query.entityID));
+        QVERIFY(query.entityIdsToInclude.isEmpty() || query.entityID.isNull() ||
+                query.entityIdsToInclude.contains(query.entityID));
+    }
+    QVERIFY(numHits > 0);
+    QVERIFY(numMisses >= NUM_TEST_PICKS / 4);
+}
+
+void EntityPickBatchTests::pickCacheOptimizerBatchTest_data() {
+    rayBatchTest_data();
+}
+
+// with a batch operator the picks get the same results without computing any entity intersection one by one, and the
+// picks that are the same as another one are only computed once
+void EntityPickBatchTests::pickCacheOptimizerBatchTest() {
+    QFETCH(bool, useAABBTree);
+    auto tree = createTree(useAABBTree);
+    auto entityIDs = populatePickTree(tree);
+
+    auto queries = makeRayQueries(tree, entityIDs);
+    std::unordered_map<uint32_t, std::shared_ptr<PickQuery>> picks;
+    uint32_t pickID = 1;
+    for (const auto& query : queries) {
+        picks[pickID++] = std::make_shared<TestRayPick>(tree, query);
+    }
+    const int NUM_DUPLICATE_PICKS = 8;
+    for (int i = 0; i < NUM_DUPLICATE_PICKS; ++i) {
+        picks[pickID++] = std::make_shared<TestRayPick>(tree, queries[i]);
+    }
+
+    numSingleEntityIntersections = 0;
+    PickCacheOptimizer<PickRay> singleOptimizer;
+    auto singleResults = updatePicks(singleOptimizer, picks);
+    QCOMPARE(numSingleEntityIntersections, NUM_TEST_PICKS);
+
+    numSingleEntityIntersections = 0;
+    size_t numBatchedPicks = 0;
+    PickCacheOptimizer<PickRay> batchOptimizer;
+    batchOptimizer.setEntityIntersectionsOperator([&](const std::vector<std::shared_ptr<Pick<PickRay>>>& batchPicks,
+                                                      const std::vector<PickRay>& mathPicks) {
+        QVector<EntityRayQuery> batchQueries;
+        for (size_t i = 0; i < batchPicks.size(); ++i) {
+            batchQueries.push_back(TestRayPick::toQuery(mathPicks[i], *batchPicks[i]));
+        }
+        tree->evalRayIntersections(batchQueries);
+        numBatchedPicks += batchPicks.size();
+
+        std::vector<PickResultPointer> results;
+        for (size_t i = 0; i < batchPicks.size(); ++i) {
+            const auto& query = batchQueries[(int)i];
+            results.push_back(std::make_shared<TestPickResult>(query.entityID, query.distance, mathPicks[i].toVariantMap()));
+        }
+        return results;
+    });
+    auto batchResults = updatePicks(batchOptimizer, picks);
+    QCOMPARE(numSingleEntityIntersections, 0);
+    QCOMPARE(numBatchedPicks, (size_t)NUM_TEST_PICKS);
+
+    int numHits = 0;
+    int numMisses = 0;
+    for (const auto& pick : picks) {
+        const auto& singleResult = singleResults[pick.first];
+        const auto& batchResult = batchResults[pick.first];
+        QVERIFY(singleResult && batchResult);
+        QCOMPARE(batchResult->entityID, singleResult->entityID);
+        if (singleResult->doesIntersect()) {
+            QCOMPARE(batchResult->distance, singleResult->distance);
+        }
+        verifyFilterAndCoverage(tree, pick.second->getFilter(), batchResult->entityID, numHits, numMisses);
+    }
+    QVERIFY(numHits > 0);
+    QVERIFY(numMisses > 0);
+}
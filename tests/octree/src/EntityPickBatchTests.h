@@ -0,0 +1,28 @@
+//
+//  EntityPickBatchTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPickBatchTests_h
+#define hifi_EntityPickBatchTests_h
+
+#include <QtTest/QtTest>
+
+class EntityPickBatchTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void rayBatchTest_data();
+    void rayBatchTest();
+    void parabolaBatchTest_data();
+    void parabolaBatchTest();
+    void pickCacheOptimizerBatchTest_data();
+    void pickCacheOptimizerBatchTest();
+};
+
+#endif // hifi_EntityPickBatchTests_h
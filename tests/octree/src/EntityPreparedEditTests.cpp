@@ -0,0 +1,178 @@
+//
+//  EntityPreparedEditTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPreparedEditTests.h"
+
+#include <vector>
+
+#include <EntityItem.h>
+#include <Node.h>
+#include <ReceivedMessage.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityPreparedEditTests)
+
+using namespace EntityTreeTestUtils;
+
+namespace {
+
+// prepares edits the way OctreeInboundPacketProcessor does, then applies them all with the tree write locked
+class EditBatch {
+public:
+    EditBatch(EntityTreePointer tree, SharedNodePointer senderNode) : _tree(tree), _senderNode(senderNode) {}
+
+    void add(PacketType type, const EntityItemID& entityID, EntityItemProperties properties) {
+        // every edit is newer than the one before it
+        properties.setLastEdited(usecTimestampNow() + _edits.size());
+
+        QByteArray buffer(NLPacket::maxPayloadSize(type) * 10, 0);
+        EntityPropertyFlags didntFitProperties;
+        EntityItemProperties::encodeEntityEditPacket(type, entityID, properties, buffer, properties.getChangedProperties(),
+                                                     didntFitProperties);
+        auto message = QSharedPointer<ReceivedMessage>::create(buffer, type, versionForPacketType(type), HifiSockAddr());
+        _messages.push_back(message);
+
+        int bytesRead = 0;
+        auto edit = _tree->prepareEditPacketData(*message, reinterpret_cast<const unsigned char*>(message->getRawMessage()),
+                                                 message->getSize(), _senderNode, bytesRead);
+        QVERIFY(edit);
+        QVERIFY(bytesRead > 0);
+        _edits.push_back(std::move(edit));
+    }
+
+    void apply() {
+        _tree->withWriteLock([&] {
+            for (auto& edit : _edits) {
+                _tree->applyPreparedEdit(*edit, _senderNode);
+            }
+        });
+        _edits.clear();
+        _messages.clear();
+    }
+
+private:
+    EntityTreePointer _tree;
+    SharedNodePointer _senderNode;
+    std::vector<QSharedPointer<ReceivedMessage>> _messages;
+    std::vector<PreparedOctreeEditPointer> _edits;
+};
+
+SharedNodePointer createSenderNode(bool canRez = true) {
+    SharedNodePointer node { new Node(QUuid::createUuid(), NodeType::Agent, HifiSockAddr(), HifiSockAddr()) };
+    NodePermissions permissions;
+    permissions.set(NodePermissions::Permission::canConnectToDomain);
+    if (canRez) {
+        permissions.set(NodePermissions::Permission::canRezPermanentEntities);
+    }
+    node->setPermissions(permissions);
+    return node;
+}
+
+EntityItemProperties boxProperties() {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+    properties.setDimensions(glm::vec3(1.0f));
+    return properties;
+}
+
+EntityItemProperties nameProperties(const QString& name) {
+    EntityItemProperties properties;
+    properties.setName(name);
+    return properties;
+}
+
+int countRecentlyDeleted(const EntityTreePointer& tree, const EntityItemID& entityID) {
+    return tree->getRecentlyDeletedEntityIDs().keys(entityID).size();
+}
+
+}
+
+void EntityPreparedEditTests::initTestCase() {
+    setUpNodeList();
+}
+
+void EntityPreparedEditTests::batchOrderTest() {
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, 2, 100.0f);
+    QCOMPARE(entityIDs.size(), 2);
+
+    // edits to different entities interleaved, each entity ends up with its last one
+    EditBatch batch(tree, createSenderNode());
+    batch.add(PacketType::EntityEdit, entityIDs[0], nameProperties("first a"));
+    batch.add(PacketType::EntityEdit, entityIDs[1], nameProperties("second a"));
+    batch.add(PacketType::EntityEdit, entityIDs[0], nameProperties("first b"));
+    batch.add(PacketType::EntityEdit, entityIDs[1], nameProperties("second b"));
+    batch.apply();
+
+    QCOMPARE(tree->findEntityByEntityItemID(entityIDs[0])->getName(), QString("first b"));
+    QCOMPARE(tree->findEntityByEntityItemID(entityIDs[1])->getName(), QString("second b"));
+}
+
+void EntityPreparedEditTests::repeatedEditTest() {
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, 1, 100.0f);
+    QCOMPARE(entityIDs.size(), 1);
+    const EntityItemID& entityID = entityIDs[0];
+
+    // the second edit gets validated once the first one was applied, from the properties it was sent with
+    EditBatch batch(tree, createSenderNode());
+    EntityItemProperties properties = nameProperties("a");
+    properties.setUserData("{\"edit\":1}");
+    batch.add(PacketType::EntityEdit, entityID, properties);
+    batch.add(PacketType::EntityEdit, entityID, nameProperties("b"));
+    batch.apply();
+
+    auto entity = tree->findEntityByEntityItemID(entityID);
+    QCOMPARE(entity->getName(), QString("b"));
+    QCOMPARE(entity->getUserData(), QString("{\"edit\":1}"));
+
+    // and nothing is left pending, a later edit is validated on its own
+    EditBatch nextBatch(tree, createSenderNode());
+    nextBatch.add(PacketType::EntityEdit, entityID, nameProperties("c"));
+    nextBatch.apply();
+    QCOMPARE(entity->getName(), QString("c"));
+}
+
+void EntityPreparedEditTests::deferredAddTest() {
+    auto tree = createTree();
+    EntityItemID entityID(QUuid::createUuid());
+
+    // the edit is prepared before the entity it refers to was added
+    EditBatch batch(tree, createSenderNode());
+    EntityItemProperties properties = boxProperties();
+    properties.setName("added");
+    batch.add(PacketType::EntityAdd, entityID, properties);
+    batch.add(PacketType::EntityEdit, entityID, nameProperties("edited"));
+    QVERIFY(!tree->findEntityByEntityItemID(entityID));
+    batch.apply();
+
+    auto entity = tree->findEntityByEntityItemID(entityID);
+    QVERIFY(entity);
+    QCOMPARE(entity->getName(), QString("edited"));
+}
+
+void EntityPreparedEditTests::rejectedAddTest() {
+    auto tree = createTree();
+    EntityItemID entityID(QUuid::createUuid());
+
+    // a sender that can't set private user data gets told once that its add was rejected, even when the add had to be
+    // validated again while the batch was applied
+    EditBatch batch(tree, createSenderNode());
+    EntityItemProperties properties = boxProperties();
+    properties.setPrivateUserData("{\"secret\":true}");
+    batch.add(PacketType::EntityAdd, entityID, properties);
+    batch.add(PacketType::EntityAdd, entityID, properties);
+    batch.apply();
+
+    QVERIFY(!tree->findEntityByEntityItemID(entityID));
+    QCOMPARE(countRecentlyDeleted(tree, entityID), 2);
+}
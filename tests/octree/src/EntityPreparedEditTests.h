@@ -0,0 +1,26 @@
+//
+//  EntityPreparedEditTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPreparedEditTests_h
+#define hifi_EntityPreparedEditTests_h
+
+#include <QtTest/QtTest>
+
+class EntityPreparedEditTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void batchOrderTest();
+    void repeatedEditTest();
+    void deferredAddTest();
+    void rejectedAddTest();
+};
+
+#endif // hifi_EntityPreparedEditTests_h
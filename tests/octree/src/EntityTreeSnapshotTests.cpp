@@ -0,0 +1,144 @@
+//
+//  EntityTreeSnapshotTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityTreeSnapshotTests.h"
+
+#include <atomic>
+#include <thread>
+
+#include <EntityItem.h>
+#include <EntityTreeElement.h>
+#include <EntityTreeSnapshot.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(EntityTreeSnapshotTests)
+
+static const int NUM_TEST_ENTITIES = 2000;
+static const float TEST_DOMAIN_SIZE = 1000.0f;
+
+using namespace EntityTreeTestUtils;
+
+static size_t countSnapshotEntities(const EntityTreeSnapshot& snapshot, int32_t index) {
+    const auto& element = snapshot.getElement(index);
+    size_t count = 0;
+    snapshot.forEachEntity(element, [&](const EntityTreeSnapshot::Entity& entity) {
+        if (auto entityItem = entity.entity.lock()) {
+            count += entityItem->isDead() ? 0 : 1;
+        }
+    });
+    for (int i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+        if (element.children[i] != EntityTreeSnapshot::INVALID_INDEX) {
+            count += countSnapshotEntities(snapshot, element.children[i]);
+        }
+    }
+    return count;
+}
+
+static size_t countTreeEntities(const EntityTreeElementPointer& element) {
+    size_t count = element->size();
+    for (int i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+        if (auto child = element->getChildAtIndex(i)) {
+            count += countTreeEntities(child);
+        }
+    }
+    return count;
+}
+
+void EntityTreeSnapshotTests::initTestCase() {
+    EntityTreeTestUtils::setUpNodeList();
+}
+
+void EntityTreeSnapshotTests::snapshotContentsTest() {
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+
+    auto snapshot = tree->getSnapshot(0);
+    QVERIFY(snapshot);
+    QCOMPARE(snapshot->getRootIndex(), 0);
+    QCOMPARE(snapshot->getNumEntities(), (size_t)entityIDs.size());
+    QCOMPARE(countSnapshotEntities(*snapshot, snapshot->getRootIndex()), (size_t)entityIDs.size());
+
+    // deleting an entity leaves it in the snapshot, but readers can tell it's gone
+    tree->withWriteLock([&] {
+        tree->deleteEntity(entityIDs.front(), true);
+    });
+    QCOMPARE(snapshot->getNumEntities(), (size_t)entityIDs.size());
+    QCOMPARE(countSnapshotEntities(*snapshot, snapshot->getRootIndex()), (size_t)entityIDs.size() - 1);
+}
+
+void EntityTreeSnapshotTests::snapshotRebuildTest() {
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+
+    auto snapshot = tree->getSnapshot(0);
+
+    // an unchanged tree keeps its snapshot
+    QCOMPARE(tree->getSnapshot(0), snapshot);
+
+    // and any change publishes a new one, unless it was checked within the rebuild interval
+    populateTree(tree, 1, TEST_DOMAIN_SIZE);
+    const uint64_t LONG_INTERVAL = 60 * USECS_PER_SECOND;
+    QCOMPARE(tree->getSnapshot(LONG_INTERVAL), snapshot);
+    auto newSnapshot = tree->getSnapshot(0);
+    QVERIFY(newSnapshot != snapshot);
+    QCOMPARE(newSnapshot->getNumEntities(), snapshot->getNumEntities() + 1);
+    QVERIFY(newSnapshot->getTimestamp() > snapshot->getTimestamp());
+}
+
+void EntityTreeSnapshotTests::traversalBenchmark_data() {
+    QTest::addColumn<bool>("useSnapshot");
+
+    QTest::newRow("tree under read lock") << false;
+    QTest::newRow("shared snapshot") << true;
+}
+
+// Each iteration is one full scan of the entities, the way a send thread's first pass does it,
+// while another thread keeps moving entities around like a stream of inbound edits would
+void EntityTreeSnapshotTests::traversalBenchmark() {
+    QFETCH(bool, useSnapshot);
+
+    auto tree = createTree();
+    auto entityIDs = populateTree(tree, NUM_TEST_ENTITIES, TEST_DOMAIN_SIZE);
+
+    std::atomic<bool> stopEdits { false };
+    std::atomic<int> numEdits { 0 };
+    std::thread editThread([&] {
+        while (!stopEdits) {
+            EntityItemProperties properties;
+            properties.setPosition(glm::vec3(randFloatInRange(-TEST_DOMAIN_SIZE, TEST_DOMAIN_SIZE)));
+            const auto& entityID = entityIDs[randIntInRange(0, entityIDs.size() - 1)];
+            tree->withWriteLock([&] {
+                tree->updateEntity(entityID, properties);
+            });
+            ++numEdits;
+        }
+    });
+
+    size_t numEntitiesVisited = 0;
+    QBENCHMARK {
+        if (useSnapshot) {
+            // the send threads refresh their snapshot at most once per send interval
+            const uint64_t SEND_INTERVAL_USECS = USECS_PER_SECOND / 60;
+            auto snapshot = tree->getSnapshot(SEND_INTERVAL_USECS);
+            numEntitiesVisited += countSnapshotEntities(*snapshot, snapshot->getRootIndex());
+        } else {
+            tree->withReadLock([&] {
+                numEntitiesVisited += countTreeEntities(tree->getRoot());
+            });
+        }
+    }
+
+    stopEdits = true;
+    editThread.join();
+
+    QVERIFY(numEntitiesVisited > 0);
+    qDebug() << "edits applied during the benchmark:" << numEdits;
+}
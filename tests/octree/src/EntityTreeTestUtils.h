@@ -0,0 +1,75 @@
+//
+//  EntityTreeTestUtils.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityTreeTestUtils_h
+#define hifi_EntityTreeTestUtils_h
+
+#include <functional>
+
+#include <QtCore/QVector>
+
+#include <AccountManager.h>
+#include <AddressManager.h>
+#include <DependencyManager.h>
+#include <EntityItemProperties.h>
+#include <EntityTree.h>
+#include <NodeList.h>
+#include <SharedUtil.h>
+
+// Shared by the entity tree tests. Only the test class .cpp files get compiled, so everything here is inline.
+namespace EntityTreeTestUtils {
+
+// EntityTree::addEntity needs a node list, call this from initTestCase
+inline void setUpNodeList() {
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<AccountManager>();
+    DependencyManager::set<AddressManager>();
+    DependencyManager::set<NodeList>(NodeType::EntityServer, INVALID_PORT);
+}
+
+inline EntityTreePointer createTree(bool useAABBTree = false) {
+    auto tree = std::make_shared<EntityTree>();
+    tree->setIsServer(true);
+    tree->setUseAABBTree(useAABBTree);
+    return tree;
+}
+
+inline glm::vec3 randomPosition(float domainSize) {
+    return glm::vec3(randFloatInRange(-domainSize, domainSize),
+                     randFloatInRange(-domainSize, domainSize),
+                     randFloatInRange(-domainSize, domainSize));
+}
+
+// Adds boxes of random sizes at random places within domainSize of the origin, setProperties can change the
+// properties of each one before it is added. Returns the IDs of the entities that got added.
+inline QVector<EntityItemID> populateTree(EntityTreePointer tree, int numEntities, float domainSize,
+                                          std::function<void(int, EntityItemProperties&)> setProperties = nullptr) {
+    QVector<EntityItemID> entityIDs;
+    tree->withWriteLock([&] {
+        for (int i = 0; i < numEntities; ++i) {
+            EntityItemProperties properties;
+            properties.setType(EntityTypes::Box);
+            properties.setPosition(randomPosition(domainSize));
+            properties.setDimensions(glm::vec3(randFloatInRange(0.1f, 10.0f)));
+            if (setProperties) {
+                setProperties(i, properties);
+            }
+            EntityItemID entityID(QUuid::createUuid());
+            if (tree->addEntity(entityID, properties)) {
+                entityIDs.push_back(entityID);
+            }
+        }
+    });
+    return entityIDs;
+}
+
+}
+
+#endif // hifi_EntityTreeTestUtils_h
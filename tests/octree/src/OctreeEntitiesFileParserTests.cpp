@@ -0,0 +1,222 @@
+//
+//  OctreeEntitiesFileParserTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeEntitiesFileParserTests.h"
+
+#include <QtCore/QBuffer>
+
+#include <EntityTreeElement.h>
+#include <GunzipDevice.h>
+#include <Gzip.h>
+#include <OctreeEntitiesFileParser.h>
+
+#include "EntityTreeTestUtils.h"
+
+QTEST_MAIN(OctreeEntitiesFileParserTests)
+
+// enough entities for the document to span several of the blocks the parser reads at a time
+static const int NUM_TEST_ENTITIES = 10000;
+static const QUuid TEST_ID { "{5d3b5a2e-8d1e-4c5b-9f7a-3c2e1d0b9a87}" };
+
+static QByteArray createDocument(int numEntities) {
+    QByteArray document = "{\n  \"DataVersion\": 7,\n  \"Entities\": [";
+    for (int i = 0; i < numEntities; ++i) {
+        document += i == 0 ? "\n    " : ",\n    ";
+        document += QString("{ \"id\": \"%1\", \"name\": \"entity \\\"%2\\\" {\", \"type\": \"Box\", "
+                            "\"position\": { \"x\": %2, \"y\": 0, \"z\": 0 } }")
+            .arg(QUuid::createUuid().toString()).arg(i).toUtf8();
+    }
+    document += QString("\n    ],\n  \"Id\": \"%1\",\n  \"Version\": 120\n}\n").arg(TEST_ID.toString()).toUtf8();
+    return document;
+}
+
+static void checkDocumentInfo(const QVariantMap& parsed) {
+    QCOMPARE(parsed["DataVersion"].toInt(), 7);
+    QCOMPARE(parsed["Id"].toUuid(), TEST_ID);
+    QCOMPARE(parsed["Version"].toInt(), 120);
+}
+
+void OctreeEntitiesFileParserTests::initTestCase() {
+    EntityTreeTestUtils::setUpNodeList();
+}
+
+void OctreeEntitiesFileParserTests::streamedParseTest() {
+    QByteArray document = createDocument(NUM_TEST_ENTITIES);
+
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesString(document);
+    QVariantMap parsed;
+    QVERIFY(parser.parseEntities(parsed));
+    checkDocumentInfo(parsed);
+    QVariantList entities = parsed["Entities"].toList();
+    QCOMPARE(entities.size(), NUM_TEST_ENTITIES);
+
+    // the streamed entities are the same, and in the same order
+    QBuffer buffer(&document);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    OctreeEntitiesFileParser streamedParser;
+    streamedParser.setEntitiesDevice(&buffer);
+    int numEntities = 0;
+    streamedParser.setEntityHandler([&](QVariantMap& entity) {
+        if (numEntities >= entities.size() || entity != entities[numEntities].toMap()) {
+            return false;
+        }
+        ++numEntities;
+        return true;
+    });
+    QVariantMap streamed;
+    QVERIFY2(streamedParser.parseEntities(streamed), streamedParser.getErrorString().c_str());
+    checkDocumentInfo(streamed);
+    QVERIFY(!streamed.contains("Entities"));
+    QCOMPARE(numEntities, NUM_TEST_ENTITIES);
+}
+
+void OctreeEntitiesFileParserTests::gzippedParseTest() {
+    QByteArray compressed;
+    QVERIFY(gzip(createDocument(NUM_TEST_ENTITIES), compressed));
+
+    QBuffer buffer(&compressed);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QVERIFY(GunzipDevice::isGzipped(buffer.peek(2)));
+    GunzipDevice gunzipDevice(&buffer);
+    QVERIFY(gunzipDevice.open(QIODevice::ReadOnly));
+
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesDevice(&gunzipDevice);
+    int numEntities = 0;
+    parser.setEntityHandler([&](QVariantMap& entity) {
+        ++numEntities;
+        return true;
+    });
+    QVariantMap parsed;
+    QVERIFY2(parser.parseEntities(parsed), parser.getErrorString().c_str());
+    checkDocumentInfo(parsed);
+    QCOMPARE(numEntities, NUM_TEST_ENTITIES);
+    QVERIFY(!gunzipDevice.hasError());
+
+    // a truncated file fails instead of yielding part of the document
+    QByteArray truncated = compressed.left(compressed.size() / 2);
+    QBuffer truncatedBuffer(&truncated);
+    QVERIFY(truncatedBuffer.open(QIODevice::ReadOnly));
+    GunzipDevice truncatedDevice(&truncatedBuffer);
+    QVERIFY(truncatedDevice.open(QIODevice::ReadOnly));
+    OctreeEntitiesFileParser truncatedParser;
+    truncatedParser.setEntitiesDevice(&truncatedDevice);
+    QVariantMap truncatedParsed;
+    QVERIFY(!truncatedParser.parseEntities(truncatedParsed));
+    QVERIFY(truncatedDevice.hasError());
+}
+
+void OctreeEntitiesFileParserTests::skipEntitiesTest() {
+    QByteArray document = createDocument(NUM_TEST_ENTITIES);
+
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesString(document);
+    parser.setSkipEntities(true);
+    QVariantMap parsed;
+    QVERIFY(parser.parseEntities(parsed));
+    checkDocumentInfo(parsed);
+    QVERIFY(!parsed.contains("Entities"));
+}
+
+void OctreeEntitiesFileParserTests::stopAtEntitiesTest() {
+    // the top-level values before the entities are all that gets parsed
+    QByteArray document = QString("{\n  \"DataVersion\": 7,\n  \"Id\": \"%1\",\n  \"Version\": 120,\n  \"Entities\": [")
+        .arg(TEST_ID.toString()).toUtf8() + "\n    { \"type\": ";
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesString(document);
+    parser.setStopAtEntities(true);
+    QVariantMap parsed;
+    QVERIFY2(parser.parseEntities(parsed), parser.getErrorString().c_str());
+    checkDocumentInfo(parsed);
+    QVERIFY(!parsed.contains("Entities"));
+
+    // the values after them are left out
+    OctreeEntitiesFileParser entitiesFirstParser;
+    entitiesFirstParser.setEntitiesString(createDocument(NUM_TEST_ENTITIES));
+    entitiesFirstParser.setStopAtEntities(true);
+    QVariantMap entitiesFirstParsed;
+    QVERIFY(entitiesFirstParser.parseEntities(entitiesFirstParsed));
+    QCOMPARE(entitiesFirstParsed["DataVersion"].toInt(), 7);
+    QVERIFY(!entitiesFirstParsed.contains("Id"));
+}
+
+void OctreeEntitiesFileParserTests::streamedImportTest() {
+    auto tree = EntityTreeTestUtils::createTree();
+    QVector<EntityItemID> entityIDs;
+    tree->withWriteLock([&] {
+        for (int i = 0; i < NUM_TEST_ENTITIES; ++i) {
+            EntityItemProperties properties;
+            properties.setType(EntityTypes::Box);
+            properties.setName(QString("entity %1").arg(i));
+            properties.setPosition(glm::vec3(randFloatInRange(-1000.0f, 1000.0f), 0.0f, randFloatInRange(-1000.0f, 1000.0f)));
+            EntityItemID entityID(QUuid::createUuid());
+            if (tree->addEntity(entityID, properties)) {
+                entityIDs.push_back(entityID);
+            }
+        }
+    });
+    QCOMPARE(entityIDs.size(), NUM_TEST_ENTITIES);
+
+    QByteArray compressed;
+    QVERIFY(tree->toJSON(&compressed, nullptr, true));
+    QBuffer buffer(&compressed);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    auto importedTree = EntityTreeTestUtils::createTree();
+    QVERIFY(importedTree->readJSONFromDevice(buffer));
+    QCOMPARE(importedTree->getPersistID(), tree->getPersistID());
+
+    for (const auto& entityID : entityIDs) {
+        auto entity = tree->findEntityByEntityItemID(entityID);
+        auto importedEntity = importedTree->findEntityByEntityItemID(entityID);
+        QVERIFY(importedEntity);
+        QCOMPARE(importedEntity->getName(), entity->getName());
+        QCOMPARE(importedEntity->getWorldPosition(), entity->getWorldPosition());
+    }
+}
+
+void OctreeEntitiesFileParserTests::entitiesFirstImportTest() {
+    // documents that list their version after the entities still get read in one pass
+    QByteArray document = createDocument(NUM_TEST_ENTITIES);
+    QBuffer buffer(&document);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    auto tree = EntityTreeTestUtils::createTree();
+    QVERIFY(tree->readJSONFromDevice(buffer));
+    QCOMPARE(tree->getPersistID(), TEST_ID);
+    QCOMPARE(tree->getPersistDataVersion(), (int64_t)7);
+    int numEntities = 0;
+    tree->recurseTreeWithOperation([&](const OctreeElementPointer& element, void*) {
+        numEntities += std::static_pointer_cast<EntityTreeElement>(element)->size();
+        return true;
+    });
+    QCOMPARE(numEntities, NUM_TEST_ENTITIES);
+}
+
+void OctreeEntitiesFileParserTests::truncatedImportTest() {
+    auto tree = EntityTreeTestUtils::createTree();
+    EntityTreeTestUtils::populateTree(tree, NUM_TEST_ENTITIES, 1000.0f);
+    QByteArray compressed;
+    QVERIFY(tree->toJSON(&compressed, nullptr, true));
+
+    // the entities read before the end of the data don't stay in the tree
+    QByteArray truncated = compressed.left(compressed.size() * 3 / 4);
+    QBuffer buffer(&truncated);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    auto importedTree = EntityTreeTestUtils::createTree();
+    QVERIFY(!importedTree->readJSONFromDevice(buffer));
+    int numEntities = 0;
+    importedTree->recurseTreeWithOperation([&](const OctreeElementPointer& element, void*) {
+        numEntities += std::static_pointer_cast<EntityTreeElement>(element)->size();
+        return true;
+    });
+    QCOMPARE(numEntities, 0);
+}
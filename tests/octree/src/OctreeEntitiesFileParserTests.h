@@ -0,0 +1,29 @@
+//
+//  OctreeEntitiesFileParserTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeEntitiesFileParserTests_h
+#define hifi_OctreeEntitiesFileParserTests_h
+
+#include <QtTest/QtTest>
+
+class OctreeEntitiesFileParserTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void streamedParseTest();
+    void gzippedParseTest();
+    void skipEntitiesTest();
+    void stopAtEntitiesTest();
+    void streamedImportTest();
+    void entitiesFirstImportTest();
+    void truncatedImportTest();
+};
+
+#endif // hifi_OctreeEntitiesFileParserTests_h
@@ -0,0 +1,116 @@
+//
+//  OctreePersistLogTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreePersistLogTests.h"
+
+#include <QTemporaryDir>
+
+#include <OctreePersistLog.h>
+
+QTEST_MAIN(OctreePersistLogTests)
+
+static OctreePersistLogRecord createRecord(OctreePersistLogRecord::Type type, const QByteArray& data = QByteArray()) {
+    OctreePersistLogRecord record;
+    record.type = type;
+    record.id = QUuid::createUuid();
+    record.data = data;
+    return record;
+}
+
+static QVector<OctreePersistLogRecord> replayAll(OctreePersistLog& log) {
+    QVector<OctreePersistLogRecord> records;
+    log.replay([&](const OctreePersistLogRecord& record) {
+        records.push_back(record);
+    });
+    return records;
+}
+
+void OctreePersistLogTests::replayTest() {
+    QTemporaryDir directory;
+    QString persistFilename = directory.filePath("models.json.gz");
+
+    auto upsert = createRecord(OctreePersistLogRecord::Upsert, "{\"type\":\"Box\"}");
+    auto erase = createRecord(OctreePersistLogRecord::Delete);
+    {
+        OctreePersistLog log(persistFilename);
+        QVERIFY(log.isEmpty());
+        QVERIFY(log.open());
+        log.append(upsert);
+        log.append(erase);
+        QVERIFY(log.flush());
+        QVERIFY(!log.isEmpty());
+    }
+
+    // records come back in order, across restarts
+    OctreePersistLog log(persistFilename);
+    auto records = replayAll(log);
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records[0].type, OctreePersistLogRecord::Upsert);
+    QCOMPARE(records[0].id, upsert.id);
+    QCOMPARE(records[0].data, upsert.data);
+    QCOMPARE(records[1].type, OctreePersistLogRecord::Delete);
+    QCOMPARE(records[1].id, erase.id);
+    QVERIFY(records[1].data.isEmpty());
+}
+
+void OctreePersistLogTests::incompleteRecordTest() {
+    QTemporaryDir directory;
+    QString persistFilename = directory.filePath("models.json.gz");
+
+    {
+        OctreePersistLog log(persistFilename);
+        QVERIFY(log.open());
+        log.append(createRecord(OctreePersistLogRecord::Upsert, "{\"name\":\"complete\"}"));
+        log.append(createRecord(OctreePersistLogRecord::Upsert, "{\"name\":\"torn\"}"));
+        QVERIFY(log.flush());
+    }
+
+    // cut the last record short, the way a crash in the middle of a write would
+    QFile segment(persistFilename + ".log.1");
+    QVERIFY(segment.exists());
+    QVERIFY(segment.resize(segment.size() - 4));
+
+    OctreePersistLog log(persistFilename);
+    auto records = replayAll(log);
+    QCOMPARE(records.size(), 1);
+    QCOMPARE(records[0].data, QByteArray("{\"name\":\"complete\"}"));
+
+    // a corrupted record is rejected as well
+    auto encoded = OctreePersistLog::encodeRecord(createRecord(OctreePersistLogRecord::Upsert, "{}"));
+    OctreePersistLogRecord decoded;
+    QCOMPARE(OctreePersistLog::decodeRecord(encoded, 0, decoded), encoded.size());
+    encoded[encoded.size() - 1] = '!';
+    QCOMPARE(OctreePersistLog::decodeRecord(encoded, 0, decoded), 0);
+}
+
+void OctreePersistLogTests::compactionTest() {
+    QTemporaryDir directory;
+    QString persistFilename = directory.filePath("models.json.gz");
+
+    OctreePersistLog log(persistFilename);
+    QVERIFY(log.open());
+    log.append(createRecord(OctreePersistLogRecord::Upsert, "{\"name\":\"saved\"}"));
+    QVERIFY(log.flush());
+
+    // a full save starts: what comes next goes to a new segment
+    int compactedSegment = log.rotate();
+    log.append(createRecord(OctreePersistLogRecord::Upsert, "{\"name\":\"after save\"}"));
+    QVERIFY(log.flush());
+
+    // and once it is done, only the changes made since it started are left
+    log.removeSegmentsUpTo(compactedSegment);
+    auto records = replayAll(log);
+    QCOMPARE(records.size(), 1);
+    QCOMPARE(records[0].data, QByteArray("{\"name\":\"after save\"}"));
+
+    log.removeAllSegments();
+    QVERIFY(log.isEmpty());
+    QCOMPARE(replayAll(log).size(), 0);
+}
@@ -0,0 +1,215 @@
+//
+//  OctreeSendBudgetTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeSendBudgetTests.h"
+
+#include <NumericalConstants.h>
+#include <OctreeSendBudget.h>
+#include <udt/Constants.h>
+
+QTEST_MAIN(OctreeSendBudgetTests)
+
+static const int TEST_INTERVALS_PER_SECOND = 10;
+static const int TEST_MAX_PACKETS_PER_SECOND = 1000;
+static const quint64 TEST_INTERVAL_USECS = USECS_PER_SECOND / TEST_INTERVALS_PER_SECOND;
+
+// what the client's link looks like during a second
+struct TestLink {
+    int rttMsecs { 0 }; // as measured by the connection
+    int pingMs { 0 };
+    int estimatedPacketsPerSecond { 0 };
+    float lossRatio { 0.0f };
+    bool isBudgetUsedUp { true };
+};
+
+// Sends for a second over the link. The budget is updated at the start of each second from the RTT of that second
+// and the losses of the second before it, the NACKs of a second come in at its end.
+static void sendSecond(OctreeSendBudget& budget, quint64& now, const TestLink& link) {
+    udt::ConnectionStats::Stats linkStats;
+    linkStats.rtt = link.rttMsecs;
+    linkStats.estimatedBandwith = link.estimatedPacketsPerSecond;
+
+    int packetsSent = 0;
+    for (int i = 0; i < TEST_INTERVALS_PER_SECOND; ++i) {
+        bool isLastInterval = i == TEST_INTERVALS_PER_SECOND - 1;
+        int nackedPackets = isLastInterval ? (int)(packetsSent * link.lossRatio) : 0;
+        int packetsAllowed = budget.startInterval(TEST_MAX_PACKETS_PER_SECOND, linkStats, link.pingMs, nackedPackets, now);
+        int packetsToSend = link.isBudgetUsedUp ? packetsAllowed : packetsAllowed / 2;
+        budget.endInterval(packetsToSend, packetsToSend * udt::MAX_PACKET_SIZE);
+        packetsSent += packetsToSend;
+        now += TEST_INTERVAL_USECS;
+    }
+}
+
+void OctreeSendBudgetTests::additiveIncreaseTest() {
+    OctreeSendBudget budget(TEST_INTERVALS_PER_SECOND);
+    quint64 now = USECS_PER_SECOND;
+
+    TestLink lossy;
+    lossy.lossRatio = 0.1f;
+    sendSecond(budget, now, lossy);
+    sendSecond(budget, now, TestLink());
+    QCOMPARE(budget.getPacketsPerSecond(), 750);
+
+    // grows by half a packet per interval every second the budget is used up
+    sendSecond(budget, now, TestLink());
+    QCOMPARE(budget.getPacketsPerSecond(), 755);
+    sendSecond(budget, now, TestLink());
+    QCOMPARE(budget.getPacketsPerSecond(), 760);
+
+    // and stays put while it isn't
+    TestLink idle;
+    idle.isBudgetUsedUp = false;
+    sendSecond(budget, now, idle);
+    sendSecond(budget, now, idle);
+    QCOMPARE(budget.getPacketsPerSecond(), 765);
+    sendSecond(budget, now, idle);
+    QCOMPARE(budget.getPacketsPerSecond(), 765);
+
+    // never past what the client and the server allow
+    for (int i = 0; i < 100; ++i) {
+        sendSecond(budget, now, TestLink());
+    }
+    QCOMPARE(budget.getPacketsPerSecond(), TEST_MAX_PACKETS_PER_SECOND);
+}
+
+void OctreeSendBudgetTests::lossBackOffTest() {
+    OctreeSendBudget budget(TEST_INTERVALS_PER_SECOND);
+    quint64 now = USECS_PER_SECOND;
+
+    sendSecond(budget, now, TestLink());
+    QCOMPARE(budget.getPacketsPerSecond(), TEST_MAX_PACKETS_PER_SECOND);
+
+    // a little loss is left alone
+    TestLink slightlyLossy;
+    slightlyLossy.lossRatio = OctreeSendBudget::MAX_LOSS_RATIO / 2.0f;
+    sendSecond(budget, now, slightlyLossy);
+    sendSecond(budget, now, TestLink());
+    QCOMPARE(budget.getPacketsPerSecond(), TEST_MAX_PACKETS_PER_SECOND);
+
+    TestLink lossy;
+    lossy.lossRatio = 0.1f;
+    sendSecond(budget, now, lossy);
+    sendSecond(budget, now, lossy);
+    QCOMPARE(budget.getPacketsPerSecond(), 750);
+    QVERIFY(budget.getNackedPacketsPerSecond() > 0);
+    sendSecond(budget, now, TestLink());
+    QCOMPARE(budget.getPacketsPerSecond(), 562);
+
+    // bottoms out at a packet per interval
+    TestLink veryLossy;
+    veryLossy.lossRatio = 0.5f;
+    for (int i = 0; i < 50; ++i) {
+        sendSecond(budget, now, veryLossy);
+    }
+    QCOMPARE(budget.getPacketsPerSecond(), TEST_INTERVALS_PER_SECOND);
+}
+
+void OctreeSendBudgetTests::rttBackOffTest() {
+    OctreeSendBudget budget(TEST_INTERVALS_PER_SECOND);
+    quint64 now = USECS_PER_SECOND;
+
+    TestLink link;
+    link.rttMsecs = 50;
+    sendSecond(budget, now, link);
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getRTTMsecs(), 50);
+
+    // not yet twice the lowest RTT
+    link.rttMsecs = 90;
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getPacketsPerSecond(), TEST_MAX_PACKETS_PER_SECOND);
+
+    // the link is queueing our packets
+    link.rttMsecs = 200;
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getRTTMsecs(), 200);
+    QCOMPARE(budget.getPacketsPerSecond(), 750);
+
+    // the pings stand in when the connection has no RTT
+    TestLink pingedLink;
+    pingedLink.pingMs = 200;
+    sendSecond(budget, now, pingedLink);
+    QCOMPARE(budget.getRTTMsecs(), 200);
+    QCOMPARE(budget.getPacketsPerSecond(), 562);
+
+    link.rttMsecs = 50;
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getPacketsPerSecond(), 567);
+}
+
+void OctreeSendBudgetTests::rttJitterTest() {
+    OctreeSendBudget budget(TEST_INTERVALS_PER_SECOND);
+    quint64 now = USECS_PER_SECOND;
+
+    TestLink link;
+    link.rttMsecs = 5;
+    sendSecond(budget, now, link);
+    sendSecond(budget, now, link);
+
+    // three times the lowest RTT, but too little more to be anything but jitter
+    link.rttMsecs = 5 + OctreeSendBudget::MIN_RTT_INCREASE_MSECS / 2;
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getPacketsPerSecond(), TEST_MAX_PACKETS_PER_SECOND);
+
+    link.rttMsecs = 10 + OctreeSendBudget::MIN_RTT_INCREASE_MSECS;
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getPacketsPerSecond(), 750);
+}
+
+void OctreeSendBudgetTests::linkEstimateTest() {
+    OctreeSendBudget budget(TEST_INTERVALS_PER_SECOND);
+    quint64 now = USECS_PER_SECOND;
+
+    TestLink link;
+    link.estimatedPacketsPerSecond = 300;
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getLinkPacketsPerSecond(), 0);
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getLinkPacketsPerSecond(), 300);
+    QCOMPARE(budget.getPacketsPerSecond(), 300);
+
+    // the budget doesn't grow past the estimate while it is used up
+    sendSecond(budget, now, link);
+    QCOMPARE(budget.getPacketsPerSecond(), 300);
+
+    // and grows again once the estimate goes away
+    sendSecond(budget, now, TestLink());
+    QCOMPARE(budget.getLinkPacketsPerSecond(), 0);
+    QCOMPARE(budget.getPacketsPerSecond(), 305);
+}
+
+void OctreeSendBudgetTests::minRTTWindowTest() {
+    OctreeSendBudget budget(TEST_INTERVALS_PER_SECOND);
+    quint64 now = USECS_PER_SECOND;
+
+    TestLink shortRoute;
+    shortRoute.pingMs = 50;
+    sendSecond(budget, now, shortRoute);
+    sendSecond(budget, now, shortRoute);
+
+    // the client moved to a route three times as long, which looks like queueing until the lowest RTT is forgotten
+    TestLink longRoute;
+    longRoute.pingMs = 150;
+    for (int i = 0; i < 40; ++i) {
+        sendSecond(budget, now, longRoute);
+    }
+    QCOMPARE(budget.getRTTMsecs(), 150);
+    QCOMPARE(budget.getPacketsPerSecond(), TEST_INTERVALS_PER_SECOND);
+
+    // once the short route is out of the window the budget grows again
+    for (int i = 0; i < 30; ++i) {
+        sendSecond(budget, now, longRoute);
+    }
+    QVERIFY(budget.getPacketsPerSecond() > TEST_INTERVALS_PER_SECOND);
+    int packetsPerSecond = budget.getPacketsPerSecond();
+    sendSecond(budget, now, longRoute);
+    QCOMPARE(budget.getPacketsPerSecond(), packetsPerSecond + TEST_INTERVALS_PER_SECOND / 2);
+}
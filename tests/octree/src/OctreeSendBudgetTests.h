@@ -0,0 +1,27 @@
+//
+//  OctreeSendBudgetTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeSendBudgetTests_h
+#define hifi_OctreeSendBudgetTests_h
+
+#include <QtTest/QtTest>
+
+class OctreeSendBudgetTests : public QObject {
+    Q_OBJECT
+private slots:
+    void additiveIncreaseTest();
+    void lossBackOffTest();
+    void rttBackOffTest();
+    void rttJitterTest();
+    void linkEstimateTest();
+    void minRTTWindowTest();
+};
+
+#endif // hifi_OctreeSendBudgetTests_h
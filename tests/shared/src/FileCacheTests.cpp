@@ -10,6 +10,8 @@
 
 #include "FileCacheTests.h"
 
+#include <mutex>
+
 #include <shared/FileCache.h>
 
 QTEST_GUILESS_MAIN(FileCacheTests)
@@ -156,6 +158,57 @@ void FileCacheTests::testWipe() {
     QCOMPARE(getCacheDirectorySize(), (size_t)0);
 }
 
+void FileCacheTests::testAsyncAccess() {
+    QTemporaryDir testDir;
+    auto cache = makeFileCache(testDir.path());
+    std::string key = getFileKey(1);
+
+    cache->writeFileAsync(TEST_DATA, FileCache::Metadata(key, TEST_DATA.size()));
+    QTRY_COMPARE(cache->getNumTotalFiles(), (size_t)1);
+
+    std::mutex mutex;
+    QByteArray readData;
+    bool isMissing { false };
+    cache->readFileAsync(key, [&](const QByteArray& data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        readData = data;
+    });
+    cache->readFileAsync(getFileKey(2), [&](const QByteArray& data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        isMissing = data.isNull();
+    });
+    QTRY_VERIFY([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return readData == TEST_DATA && isMissing;
+    }());
+    QCOMPARE(cache->getNumHits(), (size_t)1);
+    QCOMPARE(cache->getNumMisses(), (size_t)1);
+
+    // what's known about the files is kept when the cache goes away
+    cache.reset();
+    QTRY_VERIFY(QFile::exists(QDir(testDir.path()).filePath(".index")));
+    cache = makeFileCache(testDir.path());
+    QCOMPARE(cache->getNumTotalFiles(), (size_t)1);
+    QVERIFY(cache->getFile(key));
+}
+
+void FileCacheTests::testIndexSaving() {
+    QTemporaryDir testDir;
+    auto indexPath = QDir(testDir.path()).filePath(".index");
+    auto cache = makeFileCache(testDir.path());
+    cache->_indexSaveIntervalMsecs = 0;
+    std::string key = getFileKey(1);
+
+    // it's saved while the cache is still up, in case it doesn't get to shut down
+    auto file = cache->writeFile(TEST_DATA.data(), FileCache::Metadata(key, TEST_DATA.size()));
+    QVERIFY(file);
+    QTRY_VERIFY(QFile::exists(indexPath));
+
+    // and it's still there for the next time after it's been loaded
+    auto otherCache = makeFileCache(testDir.path());
+    QCOMPARE(otherCache->getNumTotalFiles(), (size_t)1);
+    QVERIFY(QFile::exists(indexPath));
+}
 
 void FileCacheTests::cleanupTestCase() {
 }
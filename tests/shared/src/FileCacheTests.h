@@ -21,6 +21,8 @@ private slots:
     void testFreeSpacePreservation();
     void cleanupTestCase();
     void testWipe();
+    void testAsyncAccess();
+    void testIndexSaving();
 
 private:
     size_t getFreeSpace() const;
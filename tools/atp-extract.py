@@ -7,13 +7,117 @@
 # run 'python2 atp-extract.py -x file' to extract that particular file to the current directory.
 # run 'python2 atp-extract.py -a' to extract all files.
 #
+# The mappings are read from map.log, the log the asset server keeps them in. Asset servers that predate it kept them
+# in map.json, which they rename to map.json.migrated once they've moved them to the log.
+#
+
+import os, json, sys, shutil, struct
+
+MAP_LOG_FILENAME = "map.log"
+MAP_JSON_FILENAMES = [ "map.json", "map.json.migrated" ]
+
+# see AssetMappingStore.cpp
+LOG_MAGIC = "HFAM"
+LOG_VERSION = 1
+LOG_HEADER_SIZE = 8
+RECORD_HEADER_SIZE = 6
+OPERATION_SET, OPERATION_REMOVE, OPERATION_REMOVE_FOLDER, OPERATION_RENAME, OPERATION_RENAME_FOLDER = range(5)
+
+# qChecksum
+def checksum(data):
+    crc = 0xffff
+    for c in data:
+        crc ^= ord(c)
+        for i in range(8):
+            if crc & 1:
+                crc = (crc >> 1) ^ 0x8408
+            else:
+                crc >>= 1
+    return ~crc & 0xffff
+
+# a QString written by a QDataStream, returns the string and the offset after it
+def readString(data, offset):
+    (size,) = struct.unpack_from(">I", data, offset)
+    offset += 4
+    if size == 0xffffffff:
+        return "", offset
+    if offset + size > len(data):
+        raise ValueError("truncated string")
+    return data[offset:offset + size].decode("utf-16-be"), offset + size
 
-import os, json, sys, shutil
+def readOperations(payload):
+    (numOperations,) = struct.unpack_from(">I", payload, 0)
+    offset = 4
+    operations = []
+    for i in range(numOperations):
+        (type,) = struct.unpack_from(">B", payload, offset)
+        first, offset = readString(payload, offset + 1)
+        second, offset = readString(payload, offset)
+        operations.append((type, first, second))
+    return operations
+
+def applyOperation(assetMap, operation):
+    type, first, second = operation
+    if type == OPERATION_SET:
+        assetMap[first] = second
+    elif type == OPERATION_REMOVE:
+        assetMap.pop(first, None)
+    elif type == OPERATION_REMOVE_FOLDER:
+        for path in [ path for path in assetMap if path.startswith(first) ]:
+            del assetMap[path]
+    elif type == OPERATION_RENAME:
+        if first in assetMap:
+            assetMap[second] = assetMap.pop(first)
+    elif type == OPERATION_RENAME_FOLDER:
+        renamed = {}
+        for path in [ path for path in assetMap if path.startswith(first) ]:
+            renamed[second + path[len(first):]] = assetMap.pop(path)
+        assetMap.update(renamed)
+
+def loadMapLog(filename):
+    with open(filename, 'rb') as f:
+        data = f.read()
+    if len(data) < LOG_HEADER_SIZE or not data.startswith(LOG_MAGIC) or \
+            struct.unpack_from(">I", data, len(LOG_MAGIC))[0] > LOG_VERSION:
+        print("Error \"" + filename + "\" is not an asset mapping log we can read")
+        sys.exit(1)
+
+    assetMap = {}
+    offset = LOG_HEADER_SIZE
+    while offset + RECORD_HEADER_SIZE <= len(data):
+        payloadSize, payloadChecksum = struct.unpack_from(">IH", data, offset)
+        payload = data[offset + RECORD_HEADER_SIZE:offset + RECORD_HEADER_SIZE + payloadSize]
+        if len(payload) < payloadSize or checksum(payload) != payloadChecksum:
+            break
+        try:
+            operations = readOperations(payload)
+        except (struct.error, ValueError):
+            break
+        for operation in operations:
+            applyOperation(assetMap, operation)
+        offset += RECORD_HEADER_SIZE + payloadSize
+
+    if offset < len(data):
+        # the asset server drops it too
+        print("Warning ignoring an incomplete record at the end of \"" + filename + "\"")
+    return assetMap
 
 def loadMapFile(filename):
     with open(filename, 'r') as f:
         return json.load(f)
 
+def loadAssetMap():
+    if os.path.exists(MAP_LOG_FILENAME):
+        return loadMapLog(MAP_LOG_FILENAME)
+    for filename in MAP_JSON_FILENAMES:
+        if os.path.exists(filename):
+            if filename != MAP_JSON_FILENAMES[0]:
+                print("Warning no \"" + MAP_LOG_FILENAME + "\", reading the mappings from \"" + filename +
+                      "\", which can be older than the asset server's")
+            return loadMapFile(filename)
+    print("Error could not find \"" + MAP_LOG_FILENAME + "\" or \"" + MAP_JSON_FILENAMES[0] + "\"")
+    sys.exit(1)
+
 def extractFile(assetMap, filename):
     if filename != None:
         assetFilename = assetMap.get("/" + filename)
@@ -27,16 +131,16 @@ def extractFile(assetMap, filename):
 
 option = sys.argv[1]
 if option == '-l':
-    assetMap = loadMapFile("map.json")
+    assetMap = loadAssetMap()
     for key, value in assetMap.iteritems():
         print key[1:]
 elif option == '-x':
-    assetMap = loadMapFile("map.json")
+    assetMap = loadAssetMap()
     outputFilename = sys.argv[2]
     if not extractFile(assetMap, outputFilename):
         print("Error could not extract file: \"" + outputFilename + "\"")
 elif option == '-a':
-    assetMap = loadMapFile("map.json")
+    assetMap = loadAssetMap()
     for key, value in assetMap.iteritems():
         print("Extracting " + key[1:])
         extractFile(assetMap, key[1:])
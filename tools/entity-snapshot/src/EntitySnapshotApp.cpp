@@ -0,0 +1,111 @@
+//
+//  EntitySnapshotApp.cpp
+//  tools/entity-snapshot/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySnapshotApp.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+#include <AccountManager.h>
+#include <AddressManager.h>
+#include <DependencyManager.h>
+#include <EntityBinarySnapshot.h>
+#include <EntityTree.h>
+#include <NodeList.h>
+
+EntitySnapshotApp::EntitySnapshotApp(int argc, char* argv[]) : QCoreApplication(argc, argv) {
+
+    // parse command-line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity Entity Snapshot Converter\n"
+        "Converts a persist file to a binary snapshot, or a binary snapshot (." + EntityBinarySnapshot::FILE_EXTENSION +
+        ") back to a persist file.");
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    const QCommandLineOption inputFilenameOption("i", "input file", "models.json.gz");
+    parser.addOption(inputFilenameOption);
+
+    const QCommandLineOption outputFilenameOption("o", "output file", "models.json.gz." + EntityBinarySnapshot::FILE_EXTENSION);
+    parser.addOption(outputFilenameOption);
+
+    const QCommandLineOption threadsOption("t", "number of threads used to encode or decode the snapshot (default one per core)",
+                                           "threads", "0");
+    parser.addOption(threadsOption);
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+        qCritical() << parser.errorText() << endl;
+        parser.showHelp();
+        _returnCode = 1;
+        return;
+    }
+
+    if (parser.isSet(helpOption)) {
+        parser.showHelp();
+        return;
+    }
+
+    if (!parser.isSet(inputFilenameOption) || !parser.isSet(outputFilenameOption)) {
+        qCritical() << "Both an input and an output file are needed";
+        parser.showHelp();
+        _returnCode = 1;
+        return;
+    }
+
+    QString inputFilename = parser.value(inputFilenameOption);
+    QString outputFilename = parser.value(outputFilenameOption);
+    int numThreads = parser.value(threadsOption).toInt();
+    bool toSnapshot = !inputFilename.endsWith("." + EntityBinarySnapshot::FILE_EXTENSION);
+
+    // EntityTree::addEntity needs a node list
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<AccountManager>();
+    DependencyManager::set<AddressManager>();
+    DependencyManager::set<NodeList>(NodeType::EntityServer, INVALID_PORT);
+
+    auto tree = std::make_shared<EntityTree>();
+    tree->setIsServer(true);
+
+    QElapsedTimer timer;
+    timer.start();
+    bool success = false;
+    if (toSnapshot) {
+        tree->withWriteLock([&] {
+            success = tree->readFromFile(inputFilename.toLocal8Bit().constData());
+        });
+    } else {
+        success = EntityBinarySnapshot::read(tree, inputFilename, numThreads);
+    }
+    if (!success) {
+        qCritical() << "Failed to read" << inputFilename;
+        _returnCode = 2;
+        return;
+    }
+    qInfo() << "Read" << inputFilename << "in" << timer.elapsed() << "ms";
+
+    timer.restart();
+    if (toSnapshot) {
+        success = EntityBinarySnapshot::write(tree, outputFilename, numThreads);
+    } else {
+        QString fileType = outputFilename.endsWith(".json") ? "json" : "json.gz";
+        success = tree->writeToFile(outputFilename.toLocal8Bit().constData(), nullptr, fileType);
+    }
+    if (!success) {
+        qCritical() << "Failed to write" << outputFilename;
+        _returnCode = 3;
+        return;
+    }
+    qInfo() << "Wrote" << outputFilename << "in" << timer.elapsed() << "ms";
+}
+
+EntitySnapshotApp::~EntitySnapshotApp() {
+    DependencyManager::destroy<NodeList>();
+    DependencyManager::destroy<AddressManager>();
+    DependencyManager::destroy<AccountManager>();
+}
@@ -16,6 +16,9 @@
 #include <QtCore/QDebug>
 #include <QFile>
 
+#include <iostream>
+#include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "OvenCLIApplication.h"
@@ -29,6 +32,42 @@ BakerCLI::BakerCLI(OvenCLIApplication* parent) : QObject(parent) {
     
 }
 
+void BakerCLI::serve() {
+    _isServing = true;
+
+    // reading the standard input blocks, and can't be watched for on every platform
+    std::thread([this] {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            QMetaObject::invokeMethod(this, "bakeJob", Qt::QueuedConnection,
+                                      Q_ARG(QString, QString::fromStdString(line).trimmed()));
+        }
+        QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+    }).detach();
+}
+
+void BakerCLI::bakeJob(const QString& job) {
+    auto arguments = job.split('\t');
+    if (arguments.size() != 3) {
+        qCDebug(model_baking) << "Invalid bake job:" << job;
+        finishBake(OVEN_STATUS_CODE_FAIL);
+        return;
+    }
+    bakeFile(QDir::fromNativeSeparators(arguments[0]), QDir::fromNativeSeparators(arguments[1]), arguments[2]);
+}
+
+void BakerCLI::finishBake(int statusCode) {
+    if (_isServing) {
+        std::cout << OVEN_STATUS_PREFIX.toStdString() << statusCode << std::endl;
+        if (_baker) {
+            // the baker lives on one of the worker threads
+            _baker.release()->deleteLater();
+        }
+    } else {
+        QCoreApplication::exit(statusCode);
+    }
+}
+
 void BakerCLI::bakeFile(QUrl inputUrl, const QString& outputPath, const QString& type) {
 
     // if the URL doesn't have a scheme, assume it is a local file
@@ -91,7 +130,8 @@ void BakerCLI::bakeFile(QUrl inputUrl, const QString& outputPath, const QString&
             auto it = STRING_TO_TEXTURE_USAGE_TYPE_MAP.find(type);
             if (it == STRING_TO_TEXTURE_USAGE_TYPE_MAP.end()) {
                 qCDebug(model_baking) << "Unknown texture usage type:" << type;
-                QCoreApplication::exit(OVEN_STATUS_CODE_FAIL);
+                finishBake(OVEN_STATUS_CODE_FAIL);
+                return;
             }
             _baker = std::unique_ptr<Baker> { new TextureBaker(inputUrl, it->second, outputPath) };
             _baker->moveToThread(Oven::instance().getNextWorkerThread());
@@ -100,7 +140,7 @@ void BakerCLI::bakeFile(QUrl inputUrl, const QString& outputPath, const QString&
 
     if (!_baker) {
         qCDebug(model_baking) << "Failed to determine baker type for file" << inputUrl;
-        QCoreApplication::exit(OVEN_STATUS_CODE_FAIL);
+        finishBake(OVEN_STATUS_CODE_FAIL);
         return;
     }
 
@@ -125,5 +165,5 @@ void BakerCLI::handleFinishedBaker() {
             errorFile.close();
         }
     }
-    QCoreApplication::exit(exitCode);
+    finishBake(exitCode);
 }
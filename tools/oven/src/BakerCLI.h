@@ -27,19 +27,29 @@ static const int OVEN_STATUS_CODE_ABORT { 2 };
 
 static const QString OVEN_ERROR_FILENAME = "errors.txt";
 
+// prefix of the lines giving the status code of each bake when serving
+static const QString OVEN_STATUS_PREFIX = "OVEN_STATUS ";
+
 class BakerCLI : public QObject {
     Q_OBJECT
 
 public:
     BakerCLI(OvenCLIApplication* parent);
 
+    /// Keeps baking the files given on the standard input until it is closed, so that the same process can bake many
+    void serve();
+
 public slots:
     void bakeFile(QUrl inputUrl, const QString& outputPath, const QString& type = QString::null);
 
 private slots:
     void handleFinishedBaker();  
+    void bakeJob(const QString& job);
 
 private:
+    void finishBake(int statusCode);
+
+    bool _isServing { false };
     QDir _outputPath;
     std::unique_ptr<Baker> _baker;
 };